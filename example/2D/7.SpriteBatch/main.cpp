@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <Walnut/Application.h>
+#include <Walnut/EntryPoint.h>
+#include <Walnut/Timer.h>
+
+#include <RenderSys/Renderer2D.h>
+#include <RenderSys/SpriteAtlas.h>
+#include <RenderSys/SpriteBatch.h>
+#include <imgui.h>
+
+// Draws quads, rotating sprites and lines with RenderSys::SpriteBatch, all of them with one draw call per batch.
+// The two sprite images are generated into the atlas, the quads and lines sample its white block.
+
+static constexpr uint32_t ATLAS_SIZE = 256;
+static constexpr uint32_t IMAGE_SIZE = 32;
+static constexpr uint32_t GRID_SIZE = 16;
+
+// a checkerboard and a disc on a transparent background
+std::vector<uint8_t> CreateImage(bool disc)
+{
+	std::vector<uint8_t> pixels(IMAGE_SIZE * IMAGE_SIZE * 4);
+	for (uint32_t y = 0; y < IMAGE_SIZE; ++y)
+	{
+		for (uint32_t x = 0; x < IMAGE_SIZE; ++x)
+		{
+			uint8_t* texel = &pixels[(y * IMAGE_SIZE + x) * 4];
+			const float dx = static_cast<float>(x) + 0.5f - IMAGE_SIZE * 0.5f;
+			const float dy = static_cast<float>(y) + 0.5f - IMAGE_SIZE * 0.5f;
+			const bool inside = disc ? dx * dx + dy * dy < IMAGE_SIZE * IMAGE_SIZE * 0.25f : true;
+			const bool dark = ((x / 8) + (y / 8)) % 2 == 0;
+			texel[0] = disc ? 255 : (dark ? 64 : 255);
+			texel[1] = disc ? 255 : (dark ? 64 : 255);
+			texel[2] = disc ? 255 : (dark ? 64 : 255);
+			texel[3] = inside ? 255 : 0;
+		}
+	}
+	return pixels;
+}
+
+class Renderer2DLayer : public Walnut::Layer
+{
+public:
+	virtual void OnAttach() override
+	{
+		m_renderer = std::make_shared<RenderSys::Renderer2D>();
+
+		RenderSys::SpriteAtlas atlas(ATLAS_SIZE, ATLAS_SIZE);
+		const auto checker = CreateImage(false);
+		const auto disc = CreateImage(true);
+		if (!atlas.Add(checker.data(), IMAGE_SIZE, IMAGE_SIZE, m_checkerRegion) || 
+			!atlas.Add(disc.data(), IMAGE_SIZE, IMAGE_SIZE, m_discRegion))
+		{
+			std::cerr << "The images do not fit into the atlas!" << std::endl;
+			return;
+		}
+		m_renderer->Init();
+		m_renderer->SetSpriteAtlas(atlas);
+	}
+
+	virtual void OnDetach() override
+	{
+		m_renderer->Destroy();
+	}
+
+	virtual void OnUpdate(float ts) override
+	{
+		Walnut::Timer timer;
+		if (m_viewportWidth == 0 || m_viewportHeight == 0)
+			return;
+
+		if (m_viewportWidth != m_renderer->GetWidth() ||
+			m_viewportHeight != m_renderer->GetHeight())
+		{
+			m_renderer->OnResize(m_viewportWidth, m_viewportHeight);
+		}
+		m_time += ts;
+
+		const float width = static_cast<float>(m_viewportWidth);
+		const float height = static_cast<float>(m_viewportHeight);
+		const glm::mat4 viewProjection = glm::ortho(0.0f, width, 0.0f, height);
+		const glm::vec2 cell(width / GRID_SIZE, height / GRID_SIZE);
+
+		m_renderer->BeginRenderPass();
+
+		// the background quads and the rotating sprites on top, one draw
+		auto& batch = m_renderer->BeginSprites(viewProjection);
+		for (uint32_t y = 0; y < GRID_SIZE; ++y)
+		{
+			for (uint32_t x = 0; x < GRID_SIZE; ++x)
+			{
+				const glm::vec2 center = (glm::vec2(x, y) + 0.5f) * cell;
+				const glm::vec4 color(static_cast<float>(x) / GRID_SIZE, static_cast<float>(y) / GRID_SIZE, 0.5f, 1.0f);
+				batch.DrawQuad(center, cell * 0.9f, RenderSys::SpriteBatch::PackColor(color * 0.5f + glm::vec4(0.0f, 0.0f, 0.0f, 0.5f)));
+				const auto& region = (x + y) % 2 == 0 ? m_checkerRegion : m_discRegion;
+				const float rotation = m_time + static_cast<float>(x + y) * 0.25f;
+				batch.DrawSprite(center, cell * 0.6f, rotation, region, RenderSys::SpriteBatch::PackColor(color));
+			}
+		}
+		m_renderer->EndSprites();
+
+		// a second batch in the same render pass, the lines of a rotating star
+		auto& lines = m_renderer->BeginSprites(viewProjection);
+		const glm::vec2 center(width * 0.5f, height * 0.5f);
+		const float radius = std::min(width, height) * 0.4f;
+		for (uint32_t i = 0; i < 12; ++i)
+		{
+			const float angle = m_time * 0.5f + glm::two_pi<float>() * i / 12.0f;
+			lines.DrawLine(center, center + radius * glm::vec2(std::cos(angle), std::sin(angle)), 3.0f, RenderSys::SpriteBatch::WHITE);
+		}
+		m_renderer->EndSprites();
+
+		m_renderer->EndRenderPass();
+
+		m_lastRenderTime = timer.ElapsedMillis();
+	}
+
+	virtual void OnUIRender() override
+	{
+		ImGui::Begin("Settings");
+		ImGui::Text("Last render: %.3fms", m_lastRenderTime);
+		const auto& stats = m_renderer->GetSpriteStats();
+		ImGui::Text("Sprites: %u, draws: %u, dropped: %u", stats.m_Sprites, stats.m_Draws, stats.m_DroppedSprites);
+		ImGui::End();
+
+		ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0.0f, 0.0f));
+		ImGui::Begin("Viewport");
+		m_viewportWidth = ImGui::GetContentRegionAvail().x;
+		m_viewportHeight = ImGui::GetContentRegionAvail().y;
+		if (m_renderer->GetWidth() > 0)
+			ImGui::Image(m_renderer->GetDescriptorSet(), {(float)m_renderer->GetWidth(),(float)m_renderer->GetHeight()});
+		ImGui::End();
+		ImGui::PopStyleVar();
+	}
+
+private:
+	std::shared_ptr<RenderSys::Renderer2D> m_renderer;
+	uint32_t m_viewportWidth = 0;
+	uint32_t m_viewportHeight = 0;
+	float m_lastRenderTime = 0.0f;
+	float m_time = 0.0f;
+
+	RenderSys::SpriteRegion m_checkerRegion;
+	RenderSys::SpriteRegion m_discRegion;
+};
+
+Walnut::Application* Walnut::CreateApplication(int argc, char** argv)
+{
+	Walnut::ApplicationSpecification spec;
+	spec.Name = "SpriteBatch Example";
+
+	Walnut::Application* app = new Walnut::Application(spec);
+	app->PushLayer<Renderer2DLayer>();
+	return app;
+}
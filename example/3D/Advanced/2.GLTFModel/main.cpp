@@ -6,6 +6,7 @@
 #include <Walnut/RenderingBackend.h>
 
 #include <RenderSys/Renderer3D.h>
+#include <RenderSys/RenderQueue.h>
 #include <RenderSys/Camera/PerspectiveCamera.h>
 #include <RenderSys/Camera/EditorCameraController.h>
 #include <RenderSys/Scene/Model.h>
@@ -224,15 +225,20 @@ public:
 			auto view = m_scene->m_Registry.view<RenderSys::MeshComponent, 
 												RenderSys::TransformComponent, 
 												RenderSys::InstanceTagComponent>();
+			m_renderQueue.Clear();
 			for (auto entity : view)
 			{
 				auto& meshComponent = view.get<RenderSys::MeshComponent>(entity);
+				auto& transformComponent = view.get<RenderSys::TransformComponent>(entity);
 				auto& instanceTagComponent = view.get<RenderSys::InstanceTagComponent>(entity);
 				instanceTagComponent.GetInstanceBuffer()->Update();
 				auto mesh = meshComponent.m_Mesh;
 				mesh->subMeshes[0].m_InstanceCount = instanceTagComponent.GetInstanceCount();
-				m_renderer->RenderMesh(*mesh);
+				const float depth = glm::distance(camera->GetPosition(), glm::vec3(transformComponent.GetMat4Global()[3]));
+				m_renderQueue.Submit(*mesh, depth);
 			}
+			m_renderQueue.Sort();
+			m_renderer->SubmitRenderQueue(m_renderQueue);
 
 			m_renderer->EndRenderPass();
 			m_renderer->EndFrame();
@@ -245,6 +251,10 @@ public:
 	{
 		ImGui::Begin("Settings");
         ImGui::Text("Last render: %.3fms", m_lastRenderTime);
+		const auto& renderQueueStats = m_renderer->GetRenderQueueStats();
+		ImGui::Text("Draws: %u, binds: pipeline %u, descriptor sets %u, vertex buffers %u, push constants %u", renderQueueStats.m_Draws, 
+						renderQueueStats.m_PipelineBinds, renderQueueStats.m_DescriptorSetBinds, renderQueueStats.m_VertexBufferBinds, 
+						renderQueueStats.m_PushConstantUpdates);
 		static ImVec4 newClearColorImgui = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
 		ImGui::ColorEdit3("Clear Color", (float*)&newClearColorImgui); 
 		glm::vec4 newClearColor = {newClearColorImgui.x, newClearColorImgui.y, newClearColorImgui.z, newClearColorImgui.w};
@@ -288,6 +298,7 @@ private:
 	}
 
     std::unique_ptr<RenderSys::Renderer3D> m_renderer;
+	RenderSys::RenderQueue m_renderQueue;
     uint32_t m_viewportWidth = 0;
     uint32_t m_viewportHeight = 0;
     float m_lastRenderTime = 0.0f;
@@ -6,14 +6,17 @@
 #include <Walnut/RenderingBackend.h>
 
 #include <RenderSys/Renderer3D.h>
+#include <RenderSys/RenderQueue.h>
 #include <RenderSys/Camera/PerspectiveCamera.h>
 #include <RenderSys/Camera/EditorCameraController.h>
 #include <RenderSys/Scene/Model.h>
 #include <RenderSys/Components/TransformComponent.h>
 #include <RenderSys/Components/MeshComponent.h>
 #include <RenderSys/Components/TagAndIDComponents.h>
+#include <RenderSys/Components/AnimationComponents.h>
 #include <RenderSys/Scene/Scene.h>
 #include <RenderSys/Scene/SceneHierarchyPanel.h>
+#include <RenderSys/Scene/AnimationSystem.h>
 #include <imgui.h>
 
 struct alignas(16) MyUniforms {
@@ -49,8 +52,16 @@ public:
 
 		if (Walnut::RenderingBackend::GetBackend() == Walnut::RenderingBackend::BACKEND::Vulkan)
 		{
+			// with bindless materials every material is read from one bind group, multi-draw indirect builds on it
+			m_bindlessMaterials = m_renderer->SupportsBindlessMaterials();
+			m_renderer->SetBindlessMaterials(m_bindlessMaterials);
+			m_multiDrawIndirect = m_bindlessMaterials && m_renderer->SupportsMultiDrawIndirect();
+			m_renderer->SetMultiDrawIndirect(m_multiDrawIndirect);
+
 			{
-				std::ifstream file(shaderDir + "/anim-vertex.glsl", std::ios::binary);
+				const std::string vertexShaderPath = m_multiDrawIndirect ? std::string(RESOURCE_DIR) + "/Shaders/pbr-indirect-vertex.glsl"
+																			: shaderDir + "/anim-vertex.glsl";
+				std::ifstream file(vertexShaderPath, std::ios::binary);
 				std::vector<char> content((std::istreambuf_iterator<char>(file)),
 											std::istreambuf_iterator<char>());
 
@@ -66,7 +77,12 @@ public:
 			}
 
 			{
-				std::ifstream file(shaderDir + "/anim-fragment.glsl", std::ios::binary);
+				std::string fragmentShaderPath = shaderDir + "/anim-fragment.glsl";
+				if (m_multiDrawIndirect)
+					fragmentShaderPath = std::string(RESOURCE_DIR) + "/Shaders/pbr-indirect-fragment.glsl";
+				else if (m_bindlessMaterials)
+					fragmentShaderPath = std::string(RESOURCE_DIR) + "/Shaders/pbr-bindless-fragment.glsl";
+				std::ifstream file(fragmentShaderPath, std::ios::binary);
 				std::vector<char> content((std::istreambuf_iterator<char>(file)),
 											std::istreambuf_iterator<char>());
 
@@ -137,18 +153,31 @@ public:
 		vertexBufferLayout.arrayStride = sizeof(RenderSys::Vertex);
 		vertexBufferLayout.stepMode = RenderSys::VertexStepMode::Vertex;
 
+		// the skinning method sizes the joint buffers, so it has to be set before the instances are created
+		auto skeletonView = m_scene->m_Registry.view<RenderSys::SkeletonComponent>();
+		for (auto entity : skeletonView)
+		{
+			skeletonView.get<RenderSys::SkeletonComponent>(entity).m_Skeleton->m_SkinningMethod = m_skinningMethod;
+		}
+
 		auto view = m_scene->m_Registry.view<RenderSys::MeshComponent, RenderSys::TransformComponent>();
 		for (auto entity : view)
 		{
 			auto& meshComponent = view.get<RenderSys::MeshComponent>(entity);
-			auto vertexBuffer = meshComponent.m_Mesh->m_meshData->getVertexBufferForRenderer();
-			if (vertexBuffer.size() == 5718) // woman model
-				m_models[1].applyVertexSkinningOnCPU(vertexBuffer);
-			assert(vertexBuffer.size() > 0);
-			const auto vertexBufID = m_renderer->SetVertexBufferData(vertexBuffer, vertexBufferLayout);
+			assert(meshComponent.m_Mesh->m_meshData->vertices.size() > 0);
+			const auto vertexBufID = m_renderer->SetVertexBufferData(*meshComponent.m_Mesh->m_meshData, vertexBufferLayout);
 			meshComponent.m_Mesh->vertexBufferID = vertexBufID;
 			assert(meshComponent.m_Mesh->m_meshData->indices.size() > 0);
 			m_renderer->SetIndexBufferData(vertexBufID, meshComponent.m_Mesh->m_meshData->indices);
+			if (meshComponent.m_Mesh->m_meshData->hasSkinning && m_scene->m_Registry.all_of<RenderSys::SkeletonComponent>(entity))
+			{
+				// skinned on the GPU every frame by SkinningPass()
+				m_renderer->SetSkinningData(vertexBufID, meshComponent.m_Mesh->m_meshData->getSkinningDataForRenderer());
+			}
+			if (m_multiDrawIndirect && !meshComponent.m_Mesh->m_meshData->meshlets.empty())
+			{
+				m_renderer->SetMeshletData(vertexBufID, meshComponent.m_Mesh->m_meshData->meshlets);
+			}
 		}
 		
 		m_scene->AddInstanceOfSubTree(0, glm::vec3(0.0f, 0.0f, 0.0f), m_scene->m_rootNodeIndex, m_scene->m_instancedRootNodeIndex);		
@@ -203,9 +232,15 @@ public:
 		{
 			m_cameraController->OnUpdate();
 			m_scene->Update();
+			m_animationSystem.Update(m_scene->m_Registry, ts, *m_cameraController->GetCamera());
 
 			m_renderer->BeginFrame();
-			m_renderer->BeginRenderPass();
+			m_renderer->SkinningPass(m_scene->m_Registry);
+			// the culled submissions record the render passes themselves
+			const bool occlusionCulled = m_multiDrawIndirect && m_drawIndirect && m_occlusionCulling;
+			const bool meshletCulled = m_multiDrawIndirect && m_drawIndirect && m_meshletCulling && !occlusionCulled;
+			if (!occlusionCulled && !meshletCulled)
+				m_renderer->BeginRenderPass();
 
 			auto camera = m_cameraController->GetCamera();
 			m_myUniformData.viewMatrix = camera->GetViewMatrix();
@@ -220,19 +255,25 @@ public:
 			m_renderer->SetUniformBufferData(1, &m_lightingUniformData, 0);
 			m_renderer->BindResources();
 
-			auto view = m_scene->m_Registry.view<RenderSys::MeshComponent, 
-												RenderSys::TransformComponent, 
-												RenderSys::InstanceTagComponent>();
-			for (auto entity : view)
+			m_renderQueue.Clear();
+			m_renderQueue.SubmitRegistry(m_scene->m_Registry, camera->GetPosition());
+			m_renderQueue.Sort();
+			if (occlusionCulled)
 			{
-				auto& meshComponent = view.get<RenderSys::MeshComponent>(entity);
-				auto& instanceTagComponent = view.get<RenderSys::InstanceTagComponent>(entity);
-				instanceTagComponent.GetInstanceBuffer()->Update();
-				auto mesh = meshComponent.m_Mesh;
-				m_renderer->RenderMesh(*mesh);
+				m_renderer->SubmitRenderQueueOcclusionCulled(m_renderQueue, camera->GetProjectionMatrix() * camera->GetViewMatrix());
+			}
+			else if (meshletCulled)
+			{
+				m_renderer->SubmitRenderQueueMeshletCulled(m_renderQueue, camera->GetProjectionMatrix() * camera->GetViewMatrix(), camera->GetPosition());
+			}
+			else
+			{
+				if (m_multiDrawIndirect && m_drawIndirect)
+					m_renderer->SubmitRenderQueueIndirect(m_renderQueue);
+				else
+					m_renderer->SubmitRenderQueue(m_renderQueue);
+				m_renderer->EndRenderPass();
 			}
-
-			m_renderer->EndRenderPass();
 			m_renderer->EndFrame();
 		}
 
@@ -243,6 +284,35 @@ public:
 	{
 		ImGui::Begin("Settings");
         ImGui::Text("Last render: %.3fms", m_lastRenderTime);
+		const auto& renderQueueStats = m_renderer->GetRenderQueueStats();
+		ImGui::Text("Draws: %u, binds: pipeline %u, descriptor sets %u, vertex buffers %u, push constants %u", renderQueueStats.m_Draws, 
+						renderQueueStats.m_PipelineBinds, renderQueueStats.m_DescriptorSetBinds, renderQueueStats.m_VertexBufferBinds, 
+						renderQueueStats.m_PushConstantUpdates);
+		ImGui::Text("Indirect draws: %u, recording: %.3fms", renderQueueStats.m_IndirectDraws, renderQueueStats.m_RecordTimeMs);
+		if (m_multiDrawIndirect)
+		{
+			// same pipeline either way, only the recording of the draws differs
+			ImGui::Checkbox("Multi-draw indirect", &m_drawIndirect);
+			if (m_drawIndirect && m_renderer->SupportsOcclusionCulling())
+			{
+				ImGui::Checkbox("Occlusion culling", &m_occlusionCulling);
+				ImGui::Text("Visible: %u, occluded: %u, outside of the frustum: %u", renderQueueStats.m_VisibleDraws, 
+								renderQueueStats.m_OccludedDraws, renderQueueStats.m_FrustumCulledDraws);
+			}
+			if (m_drawIndirect && !m_occlusionCulling && m_renderer->SupportsMeshletCulling())
+			{
+				ImGui::Checkbox("Meshlet culling", &m_meshletCulling);
+				ImGui::Text("Meshlets visible: %u, outside of the frustum: %u, back facing: %u", renderQueueStats.m_VisibleMeshlets, 
+								renderQueueStats.m_FrustumCulledMeshlets, renderQueueStats.m_ConeCulledMeshlets);
+			}
+		}
+		const auto& animationStats = m_animationSystem.GetStats();
+		ImGui::Text("Animated characters: %u (%.3fms)", animationStats.m_AnimatedCharacters, animationStats.m_UpdateTimeMs);
+		ImGui::Text("Animation LOD: %u / %u / %u, frozen %u, sampled %u", animationStats.m_CharactersPerLod[0], animationStats.m_CharactersPerLod[1],
+						animationStats.m_CharactersPerLod[2], animationStats.m_FrozenCharacters, animationStats.m_SampledCharacters);
+		ImGui::Text("Animation CPU time: %.3fms (saved %.3fms)", animationStats.m_CpuTimeMs, animationStats.m_SavedCpuTimeMs);
+		ImGui::Text("Materials: %s", m_bindlessMaterials ? "Bindless" : "Bind group per material");
+		ImGui::Text("Skinning: %s", m_skinningMethod == RenderSys::SkinningMethod::DUAL_QUATERNION ? "Dual quaternion" : "Linear blend");
 		static ImVec4 newClearColorImgui = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
 		ImGui::ColorEdit3("Clear Color", (float*)&newClearColorImgui); 
 		glm::vec4 newClearColor = {newClearColorImgui.x, newClearColorImgui.y, newClearColorImgui.z, newClearColorImgui.w};
@@ -272,6 +342,8 @@ private:
 		m_scene = std::make_shared<RenderSys::Scene>();
 		m_models.reserve(2);
 		auto& model1 = m_models.emplace_back(*m_scene);
+		// static geometry, culled per meshlet when the meshlet culling is enabled
+		model1.setGenerateMeshlets(true);
 		if (!model1.load(RESOURCE_DIR "/Models/Sponza/glTF/Sponza.gltf"))
 		{
 			std::cout << "Error loading GLTF model!" << std::endl;
@@ -292,6 +364,7 @@ private:
 	}
 
     std::unique_ptr<RenderSys::Renderer3D> m_renderer;
+	RenderSys::RenderQueue m_renderQueue;
     uint32_t m_viewportWidth = 0;
     uint32_t m_viewportHeight = 0;
     float m_lastRenderTime = 0.0f;
@@ -303,6 +376,13 @@ private:
 	std::shared_ptr<RenderSys::Scene> m_scene;
 	std::vector<RenderSys::Model> m_models;
 	std::unique_ptr<RenderSys::SceneHierarchyPanel> m_sceneHierarchyPanel;
+	RenderSys::AnimationSystem m_animationSystem;
+	RenderSys::SkinningMethod m_skinningMethod = RenderSys::SkinningMethod::DUAL_QUATERNION;
+	bool m_bindlessMaterials = false;
+	bool m_multiDrawIndirect = false;
+	bool m_drawIndirect = true;
+	bool m_occlusionCulling = false;
+	bool m_meshletCulling = false;
 };
 
 Walnut::Application* Walnut::CreateApplication(int argc, char** argv)
@@ -1,21 +1,28 @@
 #version 460
 
+#include "ShaderResource.h"
 #include "ShaderMaterial.h"
 #include "metallic-roughness.glsl"
 
 layout(set = 0, binding = 0) uniform UniformBufferObject {
     mat4 projectionMatrix;
     mat4 viewMatrix;
-    mat4 modelMatrix;
+    vec3 cameraWorldPosition;
     float time;
 } ubo;
 
 layout(set = 0, binding = 1) uniform LightingUniforms {
     vec4 directions[1];
     vec4 colors[1];
-    mat4 viewProjection[1];
+    mat4 viewProjection[MAX_SHADOW_CASCADES];
+    // view space depth where each cascade ends
+    vec4 cascadeSplits;
+    uint cascadeCount;
 } lightingUbo;
 
+// one layer per cascade, written by the shadow pass of the frame
+layout(set = 0, binding = 2) uniform sampler2DArrayShadow shadowMap;
+
 layout(set = 1, binding = 0) uniform sampler2D baseColorTexture;
 layout(set = 1, binding = 1) uniform sampler2D normalTexture;
 layout(set = 1, binding = 2) uniform sampler2D metallicTexture;
@@ -31,9 +38,43 @@ layout (location = 0) in vec3 in_viewDirection;
 layout (location = 1) in vec2 in_uv;
 layout (location = 2) in vec3 in_normal;
 layout (location = 3) in vec3 in_tangent;
+layout (location = 4) in vec3 in_worldPosition;
 
 layout (location = 0) out vec4 out_color;
 
+// 1 where the fragment sees the light
+float shadowFactor(vec3 N, vec3 L)
+{
+    float viewDepth = abs((ubo.viewMatrix * vec4(in_worldPosition, 1.0)).z);
+    uint cascade = 0;
+    while (cascade + 1 < lightingUbo.cascadeCount && viewDepth > lightingUbo.cascadeSplits[cascade])
+    {
+        ++cascade;
+    }
+
+    vec4 lightPosition = lightingUbo.viewProjection[cascade] * vec4(in_worldPosition, 1.0);
+    vec3 ndc = lightPosition.xyz / lightPosition.w;
+    vec2 uv = ndc.xy * 0.5 + 0.5;
+    if (ndc.z > 1.0)
+    {
+        return 1.0;
+    }
+    // against acne on the surfaces at a grazing angle to the light
+    float bias = max(0.002 * (1.0 - dot(N, L)), 0.0005);
+
+    // 3x3 PCF, the comparison sampler filters each tap
+    vec2 texelSize = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+    float lit = 0.0;
+    for (int x = -1; x <= 1; ++x)
+    {
+        for (int y = -1; y <= 1; ++y)
+        {
+            lit += texture(shadowMap, vec4(uv + vec2(x, y) * texelSize, float(cascade), ndc.z - bias));
+        }
+    }
+    return lit / 9.0;
+}
+
 void main()
 {
     vec3 N = normalize(in_normal);
@@ -83,7 +124,7 @@ void main()
 
     vec3 total_diffuse = vec3(0.0);
     vec3 total_specular = vec3(0.0);
-    for (int i = 0; i < 2; ++i) 
+    for (int i = 0; i < 1; ++i) 
     {
         vec3 L = normalize(lightingUbo.directions[i].xyz);
         vec3 H = normalize(V + L);
@@ -104,7 +145,8 @@ void main()
         vec3 kD = vec3(1.0) - kS;
         kD *= 1.0 - metallic;	  
  
-        vec3 radiance = lightingUbo.colors[i].rgb;
+        // the cascades are rendered for the first light
+        vec3 radiance = lightingUbo.colors[i].rgb * (i == 0 ? shadowFactor(N, L) : 1.0);
         total_diffuse += kD * radiance * albedo * NdotL;  // Use kD here
         total_specular += radiance * specular * NdotL;             
     }
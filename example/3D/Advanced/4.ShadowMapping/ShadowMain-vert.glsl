@@ -29,6 +29,8 @@ layout (location = 0) out vec3 out_viewDirection;
 layout (location = 1) out vec2 out_uv;
 layout (location = 2) out vec3 out_normal;
 layout (location = 3) out vec3 out_tangent;
+// selects and samples the shadow cascade
+layout (location = 4) out vec3 out_worldPosition;
 
 void main() 
 {
@@ -37,6 +39,7 @@ void main()
     vec4 worldPosition = modelMatrix * vec4(aPos, 1.0);
     gl_Position = ubo.projectionMatrix * ubo.viewMatrix * worldPosition;
     out_viewDirection = ubo.cameraWorldPosition - worldPosition.xyz;
+    out_worldPosition = worldPosition.xyz;
     out_uv = in_uv;
 	out_normal = (modelMatrix * vec4(in_normal, 0.0)).xyz;
     out_tangent = (modelMatrix * vec4(in_tangent, 0.0)).xyz;
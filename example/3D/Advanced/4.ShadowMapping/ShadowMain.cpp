@@ -6,6 +6,9 @@
 #include <Walnut/RenderingBackend.h>
 
 #include <RenderSys/Renderer3D.h>
+#include <RenderSys/VertexPacking.h>
+#include <RenderSys/RenderQueue.h>
+#include <RenderSys/ShadowCascades.h>
 #include <RenderSys/Camera/PerspectiveCamera.h>
 #include <RenderSys/Camera/EditorCameraController.h>
 #include <RenderSys/Scene/Model.h>
@@ -25,12 +28,20 @@ struct alignas(16) MyUniforms {
 };
 static_assert(sizeof(MyUniforms) % 16 == 0);
 
+// std140 LightingUniforms of ShadowMain-frag.glsl
 struct LightingUniforms {
     std::array<glm::vec4, 1> lightDirections;
     std::array<glm::vec4, 1> lightColors;
-	std::array<glm::mat4x4, 1> lightViewProjections;
+	std::array<glm::mat4x4, RenderSys::ShadowCascades::MAX_CASCADES> lightViewProjections;
+	glm::vec4 cascadeSplits;
+	uint32_t cascadeCount;
+	uint32_t padding[3];
 };
 static_assert(sizeof(LightingUniforms) % 16 == 0);
+static_assert(RenderSys::ShadowCascades::MAX_CASCADES == 4, "cascadeSplits holds one split per cascade");
+
+// --trace file writes the GPU profile of the last frames as a Chrome trace when the window is closed
+static std::string s_traceFile;
 
 class Renderer3DLayer : public Walnut::Layer
 {
@@ -51,8 +62,10 @@ public:
 
 		if (Walnut::RenderingBackend::GetBackend() == Walnut::RenderingBackend::BACKEND::Vulkan)
 		{
+			// the packed vertex shader decodes the octahedral normals and tangents
+			m_packedVertices = true;
 			{
-				std::ifstream file(shaderDir + "/ShadowMain-vert.glsl", std::ios::binary);
+				std::ifstream file(shaderDir + (m_packedVertices ? "/ShadowMain-packed-vert.glsl" : "/ShadowMain-vert.glsl"), std::ios::binary);
 				std::vector<char> content((std::istreambuf_iterator<char>(file)),
 											std::istreambuf_iterator<char>());
 
@@ -63,7 +76,7 @@ public:
 				RenderSys::Shader vertexShader("Vertex", std::string(content.data(), content.size()));
 				vertexShader.type = RenderSys::ShaderType::SPIRV;
 				vertexShader.stage = RenderSys::ShaderStage::Vertex;
-				vertexShader.SetIncludeDirectory(shaderDir + "/../../../Resources/Shaders");
+				vertexShader.SetIncludeDirectory(RENDERSYS_SHADER_DIR);
 				m_renderer->SetShader(vertexShader);
 			}
 
@@ -80,7 +93,7 @@ public:
 				RenderSys::Shader fragmentShader("Fragment", std::string(content.data(), content.size()));
 				fragmentShader.type = RenderSys::ShaderType::SPIRV;
 				fragmentShader.stage = RenderSys::ShaderStage::Fragment;
-				fragmentShader.SetIncludeDirectory(shaderDir + "/../../../Resources/Shaders");
+				fragmentShader.SetIncludeDirectory(RENDERSYS_SHADER_DIR);
 				m_renderer->SetShader(fragmentShader);
 			}
 		}
@@ -135,21 +148,48 @@ public:
 		vertexAttribs[4].format = RenderSys::VertexFormat::Float32x3;
 		vertexAttribs[4].offset = offsetof(RenderSys::Vertex, tangent);
 
+		// Sponza repeats its textures, the texture coordinates need the range of half floats
+		const auto packedUvFormat = RenderSys::PackedUvFormat::Float16;
+		if (m_packedVertices)
+		{
+			vertexAttribs = RenderSys::VertexPacking::GetVertexAttributes(packedUvFormat);
+		}
+
 		RenderSys::VertexBufferLayout vertexBufferLayout;
 		vertexBufferLayout.attributeCount = (uint32_t)vertexAttribs.size();
 		vertexBufferLayout.attributes = vertexAttribs.data();
-		vertexBufferLayout.arrayStride = sizeof(RenderSys::Vertex);
+		vertexBufferLayout.arrayStride = m_packedVertices ? sizeof(RenderSys::PackedVertex) : sizeof(RenderSys::Vertex);
 		vertexBufferLayout.stepMode = RenderSys::VertexStepMode::Vertex;
 
 		auto view = m_scene->m_Registry.view<RenderSys::MeshComponent, RenderSys::TransformComponent>();
 		for (auto entity : view)
 		{
 			auto& meshComponent = view.get<RenderSys::MeshComponent>(entity);
-			auto vertexBuffer = meshComponent.m_Mesh->m_meshData->getVertexBufferForRenderer();
-			if (vertexBuffer.size() == 5718) // woman model
+			const auto& meshData = *meshComponent.m_Mesh->m_meshData;
+			assert(meshData.vertices.size() > 0);
+			uint32_t vertexBufID = 0;
+			if (meshData.vertices.size() == 5718) // woman model, skinned on the CPU first
+			{
+				auto vertexBuffer = meshData.getVertexBufferForRenderer();
 				m_models[1].applyVertexSkinningOnCPU(vertexBuffer);
-			assert(vertexBuffer.size() > 0);
-			const auto vertexBufID = m_renderer->SetVertexBufferData(vertexBuffer, vertexBufferLayout);
+				if (m_packedVertices)
+				{
+					RenderSys::PackedVertexBuffer packedVertexBuffer;
+					packedVertexBuffer.uvFormat = packedUvFormat;
+					RenderSys::VertexPacking::Pack(vertexBuffer, packedVertexBuffer);
+					vertexBufID = m_renderer->SetVertexBufferData(packedVertexBuffer, vertexBufferLayout);
+				}
+				else
+				{
+					vertexBufID = m_renderer->SetVertexBufferData(vertexBuffer, vertexBufferLayout);
+				}
+			}
+			else
+			{
+				// written straight into the vertex buffer in the layout of vertexBufferLayout
+				vertexBufID = m_renderer->SetVertexBufferData(meshData, vertexBufferLayout);
+			}
+			m_vertexBufferBytes += meshData.vertices.size() * vertexBufferLayout.arrayStride;
 			meshComponent.m_Mesh->vertexBufferID = vertexBufID;
 			assert(meshComponent.m_Mesh->m_meshData->indices.size() > 0);
 			m_renderer->SetIndexBufferData(vertexBufID, meshComponent.m_Mesh->m_meshData->indices);
@@ -158,7 +198,9 @@ public:
 		m_scene->AddInstanceOfSubTree(0, glm::vec3(0.0f, 0.0f, 0.0f), m_scene->m_rootNodeIndex, m_scene->m_instancedRootNodeIndex);
 		createLights();
 
-		std::vector<RenderSys::BindGroupLayoutEntry> bindingLayoutEntries(2);
+		// only the Vulkan renderer writes the shadow map into the bind group
+		const bool sampleShadowMap = Walnut::RenderingBackend::GetBackend() == Walnut::RenderingBackend::BACKEND::Vulkan;
+		std::vector<RenderSys::BindGroupLayoutEntry> bindingLayoutEntries(sampleShadowMap ? 3 : 2);
 		// The uniform buffer binding that we already had
 		RenderSys::BindGroupLayoutEntry& uniformBindingLayout = bindingLayoutEntries[0];
 		uniformBindingLayout.setDefault();
@@ -174,6 +216,16 @@ public:
 		lightingUniformLayout.visibility = RenderSys::ShaderStage::Fragment; // only Fragment is needed
 		lightingUniformLayout.buffer.type = RenderSys::BufferBindingType::Uniform;
 		lightingUniformLayout.buffer.minBindingSize = sizeof(LightingUniforms);
+		if (sampleShadowMap)
+		{
+			// the cascades of ShadowPass(), bound by the renderer
+			RenderSys::BindGroupLayoutEntry& shadowMapLayout = bindingLayoutEntries[2];
+			shadowMapLayout.setDefault();
+			shadowMapLayout.binding = 2;
+			shadowMapLayout.visibility = RenderSys::ShaderStage::Fragment;
+			shadowMapLayout.texture.sampleType = RenderSys::TextureSampleType::Depth;
+			shadowMapLayout.texture.viewDimension = RenderSys::TextureViewDimension::_2DArray;
+		}
 
 		m_renderer->CreateUniformBuffer(uniformBindingLayout.binding, sizeof(MyUniforms), 1);
 		m_renderer->CreateUniformBuffer(lightingUniformLayout.binding, sizeof(LightingUniforms), 1);
@@ -184,6 +236,11 @@ public:
 
 	virtual void OnDetach() override
 	{
+		auto* profiler = m_renderer->GetGpuProfiler();
+		if (!s_traceFile.empty() && profiler)
+		{
+			std::cout << (profiler->WriteChromeTrace(s_traceFile) ? "Chrome trace written to " : "error: could not write ") << s_traceFile << std::endl;
+		}
 		m_models.clear();
 		m_sceneHierarchyPanel.reset();
 		m_scene.reset();
@@ -223,26 +280,28 @@ public:
 				auto& lightComponent = lightView.get<RenderSys::DirectionalLightComponent>(entity);
 				m_lightingUniformData.lightDirections[0] = { lightComponent.m_Direction, 0.0f };
 				m_lightingUniformData.lightColors[0] = { lightComponent.m_Color, 1.0f };
+				m_shadowCascades.Update(*camera, lightComponent.m_Direction);
+				m_lightingUniformData.cascadeCount = m_shadowCascades.GetCascadeCount();
+				for (uint32_t cascade = 0; cascade < m_lightingUniformData.cascadeCount; ++cascade)
+				{
+					m_lightingUniformData.lightViewProjections[cascade] = m_shadowCascades.GetCascade(cascade).m_ViewProjection;
+					m_lightingUniformData.cascadeSplits[cascade] = m_shadowCascades.GetCascade(cascade).m_SplitDepth;
+				}
 			}
 			m_renderer->SetUniformBufferData(1, &m_lightingUniformData, 0);
 
 			m_renderer->BeginFrame();
 
-			m_renderer->ShadowPass(m_scene->m_Registry);
+			m_renderer->ShadowPass(m_scene->m_Registry, m_shadowCascades);
 
 			m_renderer->BeginRenderPass();
 			m_renderer->BindResources();
-			auto meshView = m_scene->m_Registry.view<RenderSys::MeshComponent, 
-												RenderSys::TransformComponent, 
-												RenderSys::InstanceTagComponent>();
-			for (auto entity : meshView)
-			{
-				auto& meshComponent = meshView.get<RenderSys::MeshComponent>(entity);
-				auto& instanceTagComponent = meshView.get<RenderSys::InstanceTagComponent>(entity);
-				instanceTagComponent.GetInstanceBuffer()->Update();
-				auto mesh = meshComponent.m_Mesh;
-				m_renderer->RenderMesh(*mesh);
-			}
+			m_renderQueue.Clear();
+			m_lodSettings.m_ProjectionScale = m_lodEnabled ? RenderSys::RenderQueue::MakeLodProjectionScale(camera->GetFOV(), m_viewportHeight) : 0.0f;
+			m_renderQueue.SetLodSettings(m_lodSettings);
+			m_renderQueue.SubmitRegistry(m_scene->m_Registry, camera->GetPosition());
+			m_renderQueue.Sort();
+			m_renderer->SubmitRenderQueue(m_renderQueue);
 			m_renderer->EndRenderPass();
 			
 			m_renderer->EndFrame();
@@ -255,6 +314,26 @@ public:
 	{
 		ImGui::Begin("Settings");
         ImGui::Text("Last render: %.3fms", m_lastRenderTime);
+		const auto& renderQueueStats = m_renderer->GetRenderQueueStats();
+		ImGui::Text("Draws: %u, binds: pipeline %u, descriptor sets %u, vertex buffers %u, push constants %u", renderQueueStats.m_Draws, 
+						renderQueueStats.m_PipelineBinds, renderQueueStats.m_DescriptorSetBinds, renderQueueStats.m_VertexBufferBinds, 
+						renderQueueStats.m_PushConstantUpdates);
+		ImGui::Text("Triangles: %u", renderQueueStats.m_Triangles);
+		ImGui::Text("Vertex buffers: %.1f MB (%s vertices)", m_vertexBufferBytes / (1024.0f * 1024.0f), m_packedVertices ? "packed" : "full");
+		ImGui::Checkbox("Levels of detail", &m_lodEnabled);
+		ImGui::SliderFloat("LOD max error (pixels)", &m_lodSettings.m_MaxErrorPixels, 0.1f, 16.0f);
+		ImGui::Text("Shadow casters culled by the cascades: %u, cached cascades: %u", renderQueueStats.m_CulledShadowCasters, 
+						renderQueueStats.m_CachedShadowCascades);
+		auto shadowSettings = m_shadowCascades.GetSettings();
+		int cascadeCount = static_cast<int>(shadowSettings.m_CascadeCount);
+		bool shadowSettingsChanged = ImGui::SliderInt("Shadow cascades", &cascadeCount, 1, RenderSys::ShadowCascades::MAX_CASCADES);
+		shadowSettingsChanged |= ImGui::SliderFloat("Cascade split lambda", &shadowSettings.m_SplitLambda, 0.0f, 1.0f);
+		shadowSettingsChanged |= ImGui::SliderFloat("Min caster texels", &shadowSettings.m_MinCasterTexels, 0.0f, 16.0f);
+		if (shadowSettingsChanged)
+		{
+			shadowSettings.m_CascadeCount = static_cast<uint32_t>(cascadeCount);
+			m_shadowCascades.SetSettings(shadowSettings);
+		}
 		static ImVec4 newClearColorImgui = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
 		ImGui::ColorEdit3("Clear Color", (float*)&newClearColorImgui); 
 		glm::vec4 newClearColor = {newClearColorImgui.x, newClearColorImgui.y, newClearColorImgui.z, newClearColorImgui.w};
@@ -278,6 +357,10 @@ public:
         ImGui::PopStyleVar();
 
 		m_sceneHierarchyPanel->OnImGuiRender();
+		if (auto* profiler = m_renderer->GetGpuProfiler())
+		{
+			profiler->OnImGuiRender();
+		}
 	}
 
 private:
@@ -291,7 +374,7 @@ private:
 		m_scene = std::make_shared<RenderSys::Scene>();
 		m_models.reserve(2);
 		auto& model1 = m_models.emplace_back(*m_scene);
-		if (!model1.load(RESOURCE_DIR "/Models/Sponza/glTF/Sponza.gltf"))
+		if (!model1.load(RESOURCE_DIR "/Models/Sponza/glTF/Sponza.gltf", RenderSys::MeshSimplifierSettings{}))
 		{
 			std::cout << "Error loading GLTF model!" << std::endl;
 			return false;
@@ -311,13 +394,19 @@ private:
 	}
 
     std::unique_ptr<RenderSys::Renderer3D> m_renderer;
+	RenderSys::RenderQueue m_renderQueue;
+	RenderSys::ShadowCascades m_shadowCascades;
+	RenderSys::LodSettings m_lodSettings;
+	bool m_lodEnabled = true;
+	bool m_packedVertices = false;
+	size_t m_vertexBufferBytes = 0;
     uint32_t m_viewportWidth = 0;
     uint32_t m_viewportHeight = 0;
     float m_lastRenderTime = 0.0f;
 	glm::vec4 m_clearColor = glm::vec4(0.45f, 0.55f, 0.60f, 1.00f);
 
 	MyUniforms m_myUniformData;
-	LightingUniforms m_lightingUniformData;
+	LightingUniforms m_lightingUniformData{};
 	std::unique_ptr<RenderSys::EditorCameraController> m_cameraController;
 	std::shared_ptr<RenderSys::Scene> m_scene;
 	std::vector<RenderSys::Model> m_models;
@@ -326,6 +415,12 @@ private:
 
 Walnut::Application* Walnut::CreateApplication(int argc, char** argv)
 {
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		if (std::string(argv[i]) == "--trace")
+			s_traceFile = argv[i + 1];
+	}
+
 	Walnut::ApplicationSpecification spec;
 	spec.Name = "Renderer3D Example";
 
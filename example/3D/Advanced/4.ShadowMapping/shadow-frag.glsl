@@ -1,6 +0,0 @@
-#version 460
-
-void main()
-{
-
-}
\ No newline at end of file
@@ -0,0 +1,734 @@
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <Walnut/Timer.h>
+#include <Walnut/RenderingBackend.h>
+
+#include <RenderSys/Renderer3D.h>
+#include <RenderSys/HeadlessDevice.h>
+#include <RenderSys/RenderQueue.h>
+#include <RenderSys/ShadowCascades.h>
+#include <RenderSys/FrameSequenceWriter.h>
+#include <RenderSys/Camera/PerspectiveCamera.h>
+#include <RenderSys/Scene/Model.h>
+#include <RenderSys/Components/TransformComponent.h>
+#include <RenderSys/Components/MeshComponent.h>
+#include <RenderSys/Components/LightComponents.h>
+#include <RenderSys/Scene/Scene.h>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// Renders a camera path through the scene of the shadow mapping example into an image sequence.
+// The images are rendered at a fixed size on a headless device, without a window, and the progress goes to stdout.
+// Use --icd to run on a software Vulkan driver like lavapipe, e.g. --icd /usr/share/vulkan/icd.d/lvp_icd.x86_64.json
+// Use --model and --upload to compare the load time and peak memory of the vertex upload paths on large models,
+// --upload accessors keeps no CPU copy of the vertices of the meshes without skinning.
+// Use --draw indirect to draw with bindless materials and multi draw indirect, the headless device enables the
+// features they need when the driver supports them. That path shades with the bindless PBR shaders, without shadows.
+// --draw occlusion also culls the draws against the depth pyramid of the frame, the run fails when it culled nothing
+// and drew nothing, the counts are printed at the end. --draw meshlet splits the meshes into meshlets when loading
+// and draws only the meshlets which survive the frustum and normal cone culling, checked the same way.
+
+struct alignas(16) MyUniforms {
+    glm::mat4x4 projectionMatrix;
+    glm::mat4x4 viewMatrix;
+	glm::vec3 cameraWorldPosition;
+    float time;
+};
+static_assert(sizeof(MyUniforms) % 16 == 0);
+
+// std140 LightingUniforms of ShadowMain-frag.glsl
+struct LightingUniforms {
+    std::array<glm::vec4, 1> lightDirections;
+    std::array<glm::vec4, 1> lightColors;
+	std::array<glm::mat4x4, RenderSys::ShadowCascades::MAX_CASCADES> lightViewProjections;
+	glm::vec4 cascadeSplits;
+	uint32_t cascadeCount;
+	uint32_t padding[3];
+};
+static_assert(sizeof(LightingUniforms) % 16 == 0);
+static_assert(RenderSys::ShadowCascades::MAX_CASCADES == 4, "cascadeSplits holds one split per cascade");
+
+// std140 LightingUniforms of pbr-bindless.glsl, the second light stays black
+struct alignas(16) IndirectLightingUniforms {
+    std::array<glm::vec4, 2> directions;
+    std::array<glm::vec4, 2> colors;
+};
+static_assert(sizeof(IndirectLightingUniforms) % 16 == 0);
+
+struct CameraKey
+{
+	glm::vec3 position;
+	glm::vec3 target;
+};
+
+struct BatchSettings
+{
+	uint32_t frameCount = 120;
+	uint32_t width = 1280;
+	uint32_t height = 720;
+	std::string outputDirectory = "frames";
+	RenderSys::FrameSequenceWriter::Format format = RenderSys::FrameSequenceWriter::Format::PNG;
+	// "x y z targetX targetY targetZ" per line, the frames are spread evenly over the keys
+	std::string pathFile;
+	std::string icdFile;
+	RenderSys::HeadlessDeviceSpecification device;
+	// the GPU profile of the last frames as a Chrome trace, written after the last frame
+	std::string traceFile;
+	// the progress is printed every that many frames
+	uint32_t progressInterval = 30;
+	std::string modelFile = RESOURCE_DIR "/Models/Sponza/glTF/Sponza.gltf";
+	enum class Upload
+	{
+		// the ModelVertex copy of the meshes is converted into the mapped vertex buffers
+		Direct,
+		// through a VertexBuffer per mesh, which is copied into the vertex buffer
+		Copy,
+		// the glTF accessors are converted into the mapped vertex buffers, the meshes keep no ModelVertex copy
+		Accessors
+	};
+	Upload upload = Upload::Direct;
+	enum class Draw
+	{
+		// a draw call per submesh, SubmitRenderQueue()
+		Direct,
+		// bindless materials and a few multi draw indirect calls, SubmitRenderQueueIndirect()
+		Indirect,
+		// the indirect draws culled by the two phase occlusion culling, SubmitRenderQueueOcclusionCulled()
+		Occlusion,
+		// the indirect draws of the meshlets which pass the culling, SubmitRenderQueueMeshletCulled()
+		Meshlet
+	};
+	Draw draw = Draw::Direct;
+};
+
+static BatchSettings s_batchSettings;
+
+// the largest resident memory of the process so far
+static size_t getPeakMemoryBytes()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters{};
+	GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+	return counters.PeakWorkingSetSize;
+#else
+	rusage usage{};
+	getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+	return static_cast<size_t>(usage.ru_maxrss);
+#else
+	return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+class BatchRenderer
+{
+public:
+	bool Init()
+	{
+		m_renderer = std::make_unique<RenderSys::Renderer3D>();
+		m_renderer->Init();
+
+		Walnut::Timer loadTimer;
+		if (!loadScene() || !loadCameraPath())
+		{
+			return false;
+		}
+		const float loadTimeMs = loadTimer.ElapsedMillis();
+		const size_t loadPeakBytes = getPeakMemoryBytes();
+
+		const auto shaderDir = std::filesystem::path(SHADER_DIR).string();
+		assert(!shaderDir.empty());
+
+		if (Walnut::RenderingBackend::GetBackend() != Walnut::RenderingBackend::BACKEND::Vulkan)
+		{
+			std::cout << "error: batch rendering needs the Vulkan backend" << std::endl;
+			return false;
+		}
+
+		const bool drawIndirect = s_batchSettings.draw != BatchSettings::Draw::Direct;
+		if (drawIndirect)
+		{
+			// GetEnabledDeviceFeatures(), not just what the driver supports
+			if (!m_renderer->SupportsBindlessMaterials() || !m_renderer->SupportsMultiDrawIndirect())
+			{
+				std::cout << "error: the device has no bindless materials and multi draw indirect enabled" << std::endl;
+				return false;
+			}
+			m_renderer->SetBindlessMaterials(true);
+			m_renderer->SetMultiDrawIndirect(true);
+			if (s_batchSettings.draw == BatchSettings::Draw::Occlusion && !m_renderer->SupportsOcclusionCulling())
+			{
+				std::cout << "error: the device cannot sample the depth format for the occlusion culling" << std::endl;
+				return false;
+			}
+			if (s_batchSettings.draw == BatchSettings::Draw::Meshlet && !m_renderer->SupportsMeshletCulling())
+			{
+				std::cout << "error: the device cannot cull meshlets" << std::endl;
+				return false;
+			}
+		}
+
+		const std::string vertexShaderPath = drawIndirect ? std::string(RENDERSYS_SHADER_DIR) + "/pbr-indirect-vertex.glsl"
+															: shaderDir + "/ShadowMain-vert.glsl";
+		const std::string fragmentShaderPath = drawIndirect ? std::string(RENDERSYS_SHADER_DIR) + "/pbr-indirect-fragment.glsl"
+															: shaderDir + "/ShadowMain-frag.glsl";
+		for (const auto& [shaderPath, stage] : {std::make_pair(vertexShaderPath, RenderSys::ShaderStage::Vertex),
+												std::make_pair(fragmentShaderPath, RenderSys::ShaderStage::Fragment)})
+		{
+			std::ifstream file(shaderPath, std::ios::binary);
+			std::vector<char> content((std::istreambuf_iterator<char>(file)),
+										std::istreambuf_iterator<char>());
+
+			if (!file.is_open()) {
+				std::cerr << "Unable to open file." << std::endl;
+				return false;
+			}
+			RenderSys::Shader shader(stage == RenderSys::ShaderStage::Vertex ? "Vertex" : "Fragment", std::string(content.data(), content.size()));
+			shader.type = RenderSys::ShaderType::SPIRV;
+			shader.stage = stage;
+			shader.SetIncludeDirectory(RENDERSYS_SHADER_DIR);
+			m_renderer->SetShader(shader);
+		}
+
+		m_camera = std::make_shared<RenderSys::PerspectiveCamera>(30.0f, 0.01f, 500.0f);
+		m_camera->SetAspectRatio(static_cast<float>(s_batchSettings.width) / static_cast<float>(s_batchSettings.height));
+
+		std::vector<RenderSys::VertexAttribute> vertexAttribs(5);
+
+		// Position attribute
+		vertexAttribs[0].location = 0;
+		vertexAttribs[0].format = RenderSys::VertexFormat::Float32x3;
+		vertexAttribs[0].offset = 0;
+
+		// Normal attribute
+		vertexAttribs[1].location = 1;
+		vertexAttribs[1].format = RenderSys::VertexFormat::Float32x3;
+		vertexAttribs[1].offset = offsetof(RenderSys::Vertex, normal);
+
+		// UV attribute
+		vertexAttribs[2].location = 2;
+		vertexAttribs[2].format = RenderSys::VertexFormat::Float32x2;
+		vertexAttribs[2].offset = offsetof(RenderSys::Vertex, texcoord0);
+
+		// Color attribute
+		vertexAttribs[3].location = 3;
+		vertexAttribs[3].format = RenderSys::VertexFormat::Float32x3;
+		vertexAttribs[3].offset = offsetof(RenderSys::Vertex, color);
+
+		// Tangent attribute
+		vertexAttribs[4].location = 4;
+		vertexAttribs[4].format = RenderSys::VertexFormat::Float32x3;
+		vertexAttribs[4].offset = offsetof(RenderSys::Vertex, tangent);
+
+		RenderSys::VertexBufferLayout vertexBufferLayout;
+		vertexBufferLayout.attributeCount = (uint32_t)vertexAttribs.size();
+		vertexBufferLayout.attributes = vertexAttribs.data();
+		vertexBufferLayout.arrayStride = sizeof(RenderSys::Vertex);
+		vertexBufferLayout.stepMode = RenderSys::VertexStepMode::Vertex;
+
+		Walnut::Timer uploadTimer;
+		size_t vertexCount = 0;
+		size_t meshletCount = 0;
+		// the temporaries of the copy path, the peak memory can hide them when the loader freed more before
+		size_t largestTemporaryBytes = 0;
+		auto view = m_scene->m_Registry.view<RenderSys::MeshComponent, RenderSys::TransformComponent>();
+		for (auto entity : view)
+		{
+			auto& meshComponent = view.get<RenderSys::MeshComponent>(entity);
+			const auto& meshData = *meshComponent.m_Mesh->m_meshData;
+			assert(meshData.getVertexCount() > 0);
+			uint32_t vertexBufID = 0;
+			if (s_batchSettings.upload == BatchSettings::Upload::Copy)
+			{
+				const auto vertexBuffer = meshData.getVertexBufferForRenderer();
+				vertexBufID = m_renderer->SetVertexBufferData(vertexBuffer, vertexBufferLayout);
+				largestTemporaryBytes = std::max(largestTemporaryBytes, vertexBuffer.size() * sizeof(RenderSys::Vertex));
+			}
+			else
+			{
+				vertexBufID = m_renderer->SetVertexBufferData(meshData, vertexBufferLayout);
+			}
+			meshComponent.m_Mesh->m_meshData->releaseVertexAccessors();
+			vertexCount += meshData.getVertexCount();
+			meshComponent.m_Mesh->vertexBufferID = vertexBufID;
+			assert(meshData.indices.size() > 0);
+			m_renderer->SetIndexBufferData(vertexBufID, meshData.indices);
+			if (s_batchSettings.draw == BatchSettings::Draw::Meshlet && !meshData.meshlets.empty())
+			{
+				m_renderer->SetMeshletData(vertexBufID, meshData.meshlets);
+				meshletCount += meshData.meshlets.size();
+			}
+		}
+		const float uploadTimeMs = uploadTimer.ElapsedMillis();
+		const char* uploadNames[] = { "direct", "copy", "accessors" };
+		const size_t uploadPeakBytes = getPeakMemoryBytes();
+		std::cout << "Loaded " << s_batchSettings.modelFile << " in " << loadTimeMs << "ms, peak memory " << loadPeakBytes / (1024 * 1024) << "MB" << std::endl;
+		std::cout << "Uploaded " << vertexCount << " vertices (" << vertexCount * sizeof(RenderSys::Vertex) / (1024 * 1024) << "MB) with the "
+					<< uploadNames[static_cast<int>(s_batchSettings.upload)] << " path in " << uploadTimeMs << "ms, peak memory "
+					<< uploadPeakBytes / (1024 * 1024) << "MB, largest temporary vertex buffer " << largestTemporaryBytes / 1024 << "KB" << std::endl;
+
+		if (s_batchSettings.draw == BatchSettings::Draw::Meshlet)
+		{
+			std::cout << "Uploaded " << meshletCount << " meshlets" << std::endl;
+		}
+
+		m_scene->AddInstanceOfSubTree(0, glm::vec3(0.0f, 0.0f, 0.0f), m_scene->m_rootNodeIndex, m_scene->m_instancedRootNodeIndex);
+		m_scene->AddDirectionalLight(glm::vec3( 0.5f, 0.5f, 0.5f), glm::vec3( 1.0f, 1.0f, 1.0f));
+
+		std::vector<RenderSys::BindGroupLayoutEntry> bindingLayoutEntries(3);
+		RenderSys::BindGroupLayoutEntry& uniformBindingLayout = bindingLayoutEntries[0];
+		uniformBindingLayout.setDefault();
+		uniformBindingLayout.binding = 0;
+		uniformBindingLayout.visibility = RenderSys::ShaderStage::VertexAndFragment;
+		uniformBindingLayout.buffer.type = RenderSys::BufferBindingType::Uniform;
+		uniformBindingLayout.buffer.minBindingSize = sizeof(MyUniforms);
+		uniformBindingLayout.buffer.hasDynamicOffset = false;
+		RenderSys::BindGroupLayoutEntry& lightingUniformLayout = bindingLayoutEntries[1];
+		lightingUniformLayout.setDefault();
+		lightingUniformLayout.binding = 1;
+		lightingUniformLayout.visibility = RenderSys::ShaderStage::Fragment;
+		lightingUniformLayout.buffer.type = RenderSys::BufferBindingType::Uniform;
+		lightingUniformLayout.buffer.minBindingSize = drawIndirect ? sizeof(IndirectLightingUniforms) : sizeof(LightingUniforms);
+		// the cascades of ShadowPass(), bound by the renderer
+		RenderSys::BindGroupLayoutEntry& shadowMapLayout = bindingLayoutEntries[2];
+		shadowMapLayout.setDefault();
+		shadowMapLayout.binding = 2;
+		shadowMapLayout.visibility = RenderSys::ShaderStage::Fragment;
+		shadowMapLayout.texture.sampleType = RenderSys::TextureSampleType::Depth;
+		shadowMapLayout.texture.viewDimension = RenderSys::TextureViewDimension::_2DArray;
+
+		m_renderer->CreateUniformBuffer(uniformBindingLayout.binding, sizeof(MyUniforms), 1);
+		m_renderer->CreateUniformBuffer(lightingUniformLayout.binding, static_cast<uint32_t>(lightingUniformLayout.buffer.minBindingSize), 1);
+
+		m_renderer->CreateBindGroup(bindingLayoutEntries);
+		m_renderer->CreatePipeline();
+		m_renderer->OnResize(s_batchSettings.width, s_batchSettings.height);
+
+		m_writer = std::make_unique<RenderSys::FrameSequenceWriter>(s_batchSettings.outputDirectory, "frame", s_batchSettings.format);
+		m_ready = true;
+		return true;
+	}
+
+	// also destroys the memory allocator, before the headless device goes
+	void Destroy()
+	{
+		if (m_ready && !m_finished)
+		{
+			finish();
+		}
+		m_writer.reset();
+		m_models.clear();
+		m_scene.reset();
+
+		if (m_renderer)
+		{
+			m_renderer->Destroy();
+		}
+	}
+
+	// after the last frame, false when the run did not do what it was asked for
+	bool Succeeded() const { return m_finished && !m_failed; }
+
+	// false once all frames are rendered
+	bool RenderFrame()
+	{
+		if (!m_ready || m_finished)
+			return false;
+
+		if (m_frame == s_batchSettings.frameCount)
+		{
+			finish();
+			return false;
+		}
+
+		updateCamera(m_frame);
+		m_scene->Update();
+
+		m_myUniformData.viewMatrix = m_camera->GetViewMatrix();
+		m_myUniformData.projectionMatrix = m_camera->GetProjectionMatrix();
+		m_myUniformData.cameraWorldPosition = m_camera->GetPosition();
+		m_myUniformData.time = 0.0f;
+		m_renderer->SetUniformBufferData(0, &m_myUniformData, 0);
+
+		auto lightView = m_scene->m_Registry.view<RenderSys::DirectionalLightComponent,
+											RenderSys::TransformComponent>();
+		for (auto entity : lightView)
+		{
+			auto& lightComponent = lightView.get<RenderSys::DirectionalLightComponent>(entity);
+			m_lightingUniformData.lightDirections[0] = { lightComponent.m_Direction, 0.0f };
+			m_lightingUniformData.lightColors[0] = { lightComponent.m_Color, 1.0f };
+			m_shadowCascades.Update(*m_camera, lightComponent.m_Direction);
+			m_lightingUniformData.cascadeCount = m_shadowCascades.GetCascadeCount();
+			for (uint32_t cascade = 0; cascade < m_lightingUniformData.cascadeCount; ++cascade)
+			{
+				m_lightingUniformData.lightViewProjections[cascade] = m_shadowCascades.GetCascade(cascade).m_ViewProjection;
+				m_lightingUniformData.cascadeSplits[cascade] = m_shadowCascades.GetCascade(cascade).m_SplitDepth;
+			}
+		}
+		if (s_batchSettings.draw == BatchSettings::Draw::Direct)
+		{
+			m_renderer->SetUniformBufferData(1, &m_lightingUniformData, 0);
+		}
+		else
+		{
+			m_indirectLightingUniformData.directions[0] = m_lightingUniformData.lightDirections[0];
+			m_indirectLightingUniformData.colors[0] = m_lightingUniformData.lightColors[0];
+			m_renderer->SetUniformBufferData(1, &m_indirectLightingUniformData, 0);
+		}
+
+		// delivers the images of earlier frames, the time is accounted to the readback
+		Walnut::Timer readbackTimer;
+		m_renderer->BeginFrame();
+		m_readbackTimeMs += readbackTimer.ElapsedMillis();
+
+		Walnut::Timer renderTimer;
+		m_renderer->ShadowPass(m_scene->m_Registry, m_shadowCascades);
+
+		// the culled submissions record the render passes themselves
+		const bool culled = s_batchSettings.draw == BatchSettings::Draw::Occlusion || s_batchSettings.draw == BatchSettings::Draw::Meshlet;
+		if (!culled)
+			m_renderer->BeginRenderPass();
+		m_renderer->BindResources();
+		m_renderQueue.Clear();
+		m_renderQueue.SubmitRegistry(m_scene->m_Registry, m_camera->GetPosition());
+		m_renderQueue.Sort();
+		if (s_batchSettings.draw == BatchSettings::Draw::Occlusion)
+		{
+			m_renderer->SubmitRenderQueueOcclusionCulled(m_renderQueue, m_camera->GetProjectionMatrix() * m_camera->GetViewMatrix());
+		}
+		else if (s_batchSettings.draw == BatchSettings::Draw::Meshlet)
+		{
+			m_renderer->SubmitRenderQueueMeshletCulled(m_renderQueue, m_camera->GetProjectionMatrix() * m_camera->GetViewMatrix(),
+														m_camera->GetPosition());
+		}
+		else
+		{
+			if (s_batchSettings.draw == BatchSettings::Draw::Indirect)
+				m_renderer->SubmitRenderQueueIndirect(m_renderQueue);
+			else
+				m_renderer->SubmitRenderQueue(m_renderQueue);
+			m_renderer->EndRenderPass();
+		}
+
+		// of the shadow and the main pass
+		const auto& queueStats = m_renderer->GetRenderQueueStats();
+		m_draws += queueStats.m_Draws;
+		m_indirectDraws += queueStats.m_IndirectDraws;
+		// of the frame before
+		m_visibleDraws += queueStats.m_VisibleDraws;
+		m_occludedDraws += queueStats.m_OccludedDraws;
+		m_frustumCulledDraws += queueStats.m_FrustumCulledDraws;
+		m_visibleMeshlets += queueStats.m_VisibleMeshlets;
+		m_frustumCulledMeshlets += queueStats.m_FrustumCulledMeshlets;
+		m_coneCulledMeshlets += queueStats.m_ConeCulledMeshlets;
+
+		const uint32_t frameIndex = m_frame;
+		const auto requestTime = std::chrono::high_resolution_clock::now();
+		m_renderer->RequestRenderedImage([this, frameIndex, requestTime](const RenderSys::RenderedImageView& image)
+		{
+			m_readbackLatencyMs += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - requestTime).count();
+			m_writer->Write(frameIndex, image);
+			m_framesDelivered++;
+		});
+
+		m_renderer->EndFrame();
+		m_renderTimeMs += renderTimer.ElapsedMillis();
+		m_frame++;
+
+		if (m_frame % s_batchSettings.progressInterval == 0 || m_frame == s_batchSettings.frameCount)
+		{
+			std::cout << "Frame " << m_frame << " of " << s_batchSettings.frameCount << ", " << m_framesDelivered << " read back, "
+						<< m_renderTimeMs / static_cast<float>(m_frame) << "ms per frame" << std::endl;
+		}
+		return true;
+	}
+
+private:
+	void finish()
+	{
+		Walnut::Timer readbackTimer;
+		m_renderer->WaitRenderedImages();
+		m_readbackTimeMs += readbackTimer.ElapsedMillis();
+		m_writer->Finish();
+		m_finished = true;
+
+		auto* profiler = m_renderer->GetGpuProfiler();
+		if (!s_batchSettings.traceFile.empty() && profiler)
+		{
+			if (profiler->WriteChromeTrace(s_batchSettings.traceFile))
+			{
+				std::cout << "Chrome trace of " << profiler->GetFrames().size() << " frames written to " << s_batchSettings.traceFile << std::endl;
+			}
+			else
+			{
+				std::cout << "error: could not write " << s_batchSettings.traceFile << std::endl;
+				m_failed = true;
+			}
+		}
+
+		const auto stats = m_writer->GetStats();
+		const float frames = static_cast<float>(std::max(m_frame, 1u));
+		std::cout << "Rendered " << m_frame << " frames, " << stats.m_FramesWritten << " written, "
+					<< stats.m_FramesFailed << " failed" << std::endl;
+		std::cout << "  render:   " << m_renderTimeMs / frames << "ms per frame" << std::endl;
+		std::cout << "  readback: " << m_readbackTimeMs / frames << "ms per frame, "
+					<< m_readbackLatencyMs / static_cast<float>(std::max(m_framesDelivered, 1u)) << "ms latency" << std::endl;
+		std::cout << "  queue:    " << stats.m_CopyTimeMs / frames << "ms copy, "
+					<< stats.m_StallTimeMs / frames << "ms stall per frame" << std::endl;
+		const char* drawNames[] = { "direct", "indirect", "occlusion culled", "meshlet culled" };
+		std::cout << "  draws:    " << static_cast<float>(m_draws) / frames << " submeshes, " << static_cast<float>(m_indirectDraws) / frames
+					<< " indirect draw calls per frame, " << drawNames[static_cast<int>(s_batchSettings.draw)] << std::endl;
+		if (s_batchSettings.draw == BatchSettings::Draw::Occlusion)
+		{
+			std::cout << "  culling:  " << m_visibleDraws << " visible, " << m_occludedDraws << " occluded, "
+						<< m_frustumCulledDraws << " outside of the frustum" << std::endl;
+			// the first frame reports nothing, every later one reports all draws of the main pass
+			if (m_frame > 1 && m_visibleDraws + m_occludedDraws + m_frustumCulledDraws == 0)
+			{
+				std::cout << "error: the occlusion culling reported no draws" << std::endl;
+				m_failed = true;
+			}
+		}
+		if (s_batchSettings.draw == BatchSettings::Draw::Meshlet)
+		{
+			std::cout << "  culling:  " << m_visibleMeshlets << " meshlets visible, " << m_frustumCulledMeshlets << " outside of the frustum, "
+						<< m_coneCulledMeshlets << " back facing" << std::endl;
+			if (m_frame > 1 && m_visibleMeshlets + m_frustumCulledMeshlets + m_coneCulledMeshlets == 0)
+			{
+				std::cout << "error: the meshlet culling reported no meshlets" << std::endl;
+				m_failed = true;
+			}
+		}
+		std::cout << "  encode:   " << stats.m_EncodeTimeMs / static_cast<float>(std::max(stats.m_FramesWritten, 1u))
+					<< "ms per frame on the encoder thread" << std::endl;
+	}
+
+	void updateCamera(const uint32_t frame)
+	{
+		// position along the path, the last frame ends on the last key
+		const float pathPosition = s_batchSettings.frameCount > 1 ?
+					static_cast<float>(frame) / static_cast<float>(s_batchSettings.frameCount - 1) * static_cast<float>(m_cameraPath.size() - 1) : 0.0f;
+		const size_t key = std::min(static_cast<size_t>(pathPosition), m_cameraPath.size() - 1);
+		const size_t nextKey = std::min(key + 1, m_cameraPath.size() - 1);
+		const float blend = pathPosition - static_cast<float>(key);
+		const glm::vec3 position = glm::mix(m_cameraPath[key].position, m_cameraPath[nextKey].position, blend);
+		const glm::vec3 target = glm::mix(m_cameraPath[key].target, m_cameraPath[nextKey].target, blend);
+
+		// the camera looks along +z rotated by its euler angles
+		const glm::vec3 direction = glm::normalize(target - position);
+		const float pitch = std::asin(-glm::clamp(direction.y, -1.0f, 1.0f));
+		const float yaw = std::atan2(direction.x, direction.z);
+		m_camera->SetPosition(position);
+		m_camera->SetOrientation(glm::vec3(pitch, yaw, 0.0f));
+	}
+
+	bool loadCameraPath()
+	{
+		m_cameraPath.clear();
+		if (s_batchSettings.pathFile.empty())
+		{
+			// one elliptic orbit around the center of the long atrium
+			constexpr uint32_t keyCount = 32;
+			for (uint32_t key = 0; key <= keyCount; ++key)
+			{
+				const float angle = glm::two_pi<float>() * static_cast<float>(key) / static_cast<float>(keyCount);
+				m_cameraPath.push_back({ glm::vec3(std::sin(angle) * 6.0f, 3.0f, std::cos(angle) * 2.0f), glm::vec3(0.0f, 2.0f, 0.0f) });
+			}
+			return true;
+		}
+
+		std::ifstream file(s_batchSettings.pathFile);
+		if (!file.is_open())
+		{
+			std::cout << "error: could not open the camera path " << s_batchSettings.pathFile << std::endl;
+			return false;
+		}
+		std::string line;
+		while (std::getline(file, line))
+		{
+			if (line.empty() || line[0] == '#')
+				continue;
+			std::istringstream lineStream(line);
+			CameraKey key;
+			if (lineStream >> key.position.x >> key.position.y >> key.position.z >> key.target.x >> key.target.y >> key.target.z)
+			{
+				m_cameraPath.push_back(key);
+			}
+		}
+		if (m_cameraPath.empty())
+		{
+			std::cout << "error: the camera path " << s_batchSettings.pathFile << " has no keys" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	bool loadScene()
+	{
+		m_scene = std::make_shared<RenderSys::Scene>();
+		auto& model = m_models.emplace_back(*m_scene);
+		model.setDirectVertices(s_batchSettings.upload == BatchSettings::Upload::Accessors);
+		model.setGenerateMeshlets(s_batchSettings.draw == BatchSettings::Draw::Meshlet);
+		if (!model.load(s_batchSettings.modelFile))
+		{
+			std::cout << "Error loading GLTF model!" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+    std::unique_ptr<RenderSys::Renderer3D> m_renderer;
+	std::unique_ptr<RenderSys::FrameSequenceWriter> m_writer;
+	RenderSys::RenderQueue m_renderQueue;
+	RenderSys::ShadowCascades m_shadowCascades;
+	std::shared_ptr<RenderSys::PerspectiveCamera> m_camera;
+	std::vector<CameraKey> m_cameraPath;
+	uint32_t m_frame = 0;
+	uint32_t m_framesDelivered = 0;
+	bool m_ready = false;
+	bool m_finished = false;
+	bool m_failed = false;
+
+	// summed over all frames
+	float m_renderTimeMs = 0.0f;
+	float m_readbackTimeMs = 0.0f;
+	float m_readbackLatencyMs = 0.0f;
+	uint64_t m_draws = 0;
+	uint64_t m_indirectDraws = 0;
+	uint64_t m_visibleDraws = 0;
+	uint64_t m_occludedDraws = 0;
+	uint64_t m_frustumCulledDraws = 0;
+	uint64_t m_visibleMeshlets = 0;
+	uint64_t m_frustumCulledMeshlets = 0;
+	uint64_t m_coneCulledMeshlets = 0;
+
+	MyUniforms m_myUniformData;
+	LightingUniforms m_lightingUniformData{};
+	IndirectLightingUniforms m_indirectLightingUniformData{};
+	std::shared_ptr<RenderSys::Scene> m_scene;
+	std::vector<RenderSys::Model> m_models;
+};
+
+static void setEnvironmentVariable(const char* name, const std::string& value)
+{
+#ifdef _WIN32
+	_putenv_s(name, value.c_str());
+#else
+	setenv(name, value.c_str(), 1);
+#endif
+}
+
+static bool parseArguments(int argc, char** argv)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string argument = argv[i];
+		if (i + 1 >= argc)
+		{
+			std::cout << "error: " << argument << " needs a value" << std::endl;
+			return false;
+		}
+		const std::string value = argv[++i];
+		if (argument == "--frames")
+			s_batchSettings.frameCount = static_cast<uint32_t>(std::max(std::atoi(value.c_str()), 1));
+		else if (argument == "--width")
+			s_batchSettings.width = static_cast<uint32_t>(std::max(std::atoi(value.c_str()), 1));
+		else if (argument == "--height")
+			s_batchSettings.height = static_cast<uint32_t>(std::max(std::atoi(value.c_str()), 1));
+		else if (argument == "--output")
+			s_batchSettings.outputDirectory = value;
+		else if (argument == "--format")
+			s_batchSettings.format = value == "ppm" ? RenderSys::FrameSequenceWriter::Format::PPM : RenderSys::FrameSequenceWriter::Format::PNG;
+		else if (argument == "--path")
+			s_batchSettings.pathFile = value;
+		else if (argument == "--icd")
+			s_batchSettings.icdFile = value;
+		else if (argument == "--model")
+			s_batchSettings.modelFile = value;
+		else if (argument == "--draw")
+		{
+			if (value == "meshlet")
+				s_batchSettings.draw = BatchSettings::Draw::Meshlet;
+			else if (value == "occlusion")
+				s_batchSettings.draw = BatchSettings::Draw::Occlusion;
+			else
+				s_batchSettings.draw = value == "indirect" ? BatchSettings::Draw::Indirect : BatchSettings::Draw::Direct;
+		}
+		else if (argument == "--trace")
+			s_batchSettings.traceFile = value;
+		else if (argument == "--validation")
+		{
+			s_batchSettings.device.m_Validation = value != "off";
+			s_batchSettings.device.m_SynchronizationValidation = value == "sync";
+		}
+		else if (argument == "--upload")
+			s_batchSettings.upload = value == "copy" ? BatchSettings::Upload::Copy :
+										(value == "accessors" ? BatchSettings::Upload::Accessors : BatchSettings::Upload::Direct);
+		else
+		{
+			std::cout << "error: unknown argument " << argument << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	if (!parseArguments(argc, argv))
+	{
+		std::cout << "usage: BatchRender [--frames n] [--width w] [--height h] [--output dir] [--format png|ppm] [--path file] [--icd file]"
+					<< " [--model file] [--upload direct|copy|accessors] [--draw direct|indirect|occlusion|meshlet]"
+					<< " [--validation off|on|sync] [--trace file]" << std::endl;
+		return 1;
+	}
+
+	// the loader picks the driver when the Vulkan instance is created
+	if (!s_batchSettings.icdFile.empty())
+	{
+		setEnvironmentVariable("VK_DRIVER_FILES", s_batchSettings.icdFile);
+		setEnvironmentVariable("VK_ICD_FILENAMES", s_batchSettings.icdFile);
+	}
+
+	s_batchSettings.device.m_ApplicationName = "Renderer3D Batch Render";
+	if (!RenderSys::CreateHeadlessDevice(s_batchSettings.device))
+	{
+		return 1;
+	}
+
+	int result = 0;
+	{
+		BatchRenderer batchRenderer;
+		if (batchRenderer.Init())
+		{
+			while (batchRenderer.RenderFrame())
+			{
+			}
+			result = batchRenderer.Succeeded() ? 0 : 1;
+		}
+		else
+		{
+			result = 1;
+		}
+		batchRenderer.Destroy();
+	}
+
+	RenderSys::DestroyHeadlessDevice();
+	if (s_batchSettings.device.m_Validation)
+	{
+		std::cout << "Validation: " << RenderSys::GetValidationErrorCount() << " errors, "
+					<< RenderSys::GetValidationWarningCount() << " warnings" << std::endl;
+	}
+	return result;
+}
@@ -179,7 +179,8 @@ public:
 		}
 
 		RenderSys::VertexBuffer vertexData;
-		bool success = Geometry::loadGeometryFromObj(RESOURCE_DIR "/mammoth.obj", vertexData);
+		std::vector<uint32_t> indexData;
+		bool success = Geometry::loadGeometryFromObj(RESOURCE_DIR "/mammoth.obj", vertexData, indexData);
 		if (!success) 
 		{
 			std::cerr << "Could not load geometry!" << std::endl;
@@ -209,7 +210,8 @@ public:
 		vertexBufferLayout.arrayStride = sizeof(RenderSys::Vertex);
 		vertexBufferLayout.stepMode = RenderSys::VertexStepMode::Vertex;
 
-		m_renderer->SetVertexBufferData(vertexData, vertexBufferLayout);
+		const auto vertexBufID = m_renderer->SetVertexBufferData(vertexData, vertexBufferLayout);
+		m_renderer->SetIndexBufferData(vertexBufID, indexData);
 
 		// Create binding layout (don't forget to = Default)
 		std::vector<RenderSys::BindGroupLayoutEntry> bindingLayoutEntries(1);
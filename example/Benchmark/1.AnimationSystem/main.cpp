@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glm/ext.hpp>
+#include <glm/gtx/quaternion.hpp>
+#include <entt/entt.hpp>
+
+#include <RenderSys/JobSystem.h>
+#include <RenderSys/Camera/PerspectiveCamera.h>
+#include <RenderSys/Components/TransformComponent.h>
+#include <RenderSys/Scene/Skeleton.h>
+#include <RenderSys/Scene/Animation.h>
+#include <RenderSys/Scene/AnimationSystem.h>
+#include <RenderSys/Components/AnimationComponents.h>
+
+// Measures RenderSys::AnimationSystem for a growing number of characters and worker threads,
+// and a crowd spread in front of and behind a camera with and without animation LOD.
+// The skeleton and clip are synthetic so no model files are needed.
+
+static constexpr int JOINT_COUNT = 64;
+static constexpr int KEY_FRAME_COUNT = 30;
+static constexpr int WARMUP_FRAMES = 10;
+static constexpr int MEASURED_FRAMES = 100;
+static constexpr float FRAME_TIME = 1.0f / 60.0f;
+
+// binary tree of joints, joint i is also gltf node i
+std::shared_ptr<RenderSys::Skeleton> CreateSkeleton()
+{
+    auto skeleton = std::make_shared<RenderSys::Skeleton>();
+    skeleton->m_Name = "BenchmarkSkeleton";
+    skeleton->m_Joints.resize(JOINT_COUNT);
+    skeleton->m_ShaderData.m_FinalJointsMatrices.resize(JOINT_COUNT);
+    for (int jointIndex = 0; jointIndex < JOINT_COUNT; ++jointIndex)
+    {
+        auto& joint = skeleton->m_Joints[jointIndex];
+        joint.m_Name = "Joint" + std::to_string(jointIndex);
+        joint.m_InverseBindMatrix = glm::mat4(1.0f);
+        joint.m_DeformedNodeTranslation = glm::vec3(0.0f, 0.1f, 0.0f);
+        joint.m_ParentJoint = jointIndex == RenderSys::ROOT_JOINT ? RenderSys::NO_PARENT : (jointIndex - 1) / 2;
+        for (int child = 2 * jointIndex + 1; child <= 2 * jointIndex + 2 && child < JOINT_COUNT; ++child)
+        {
+            joint.m_Children.push_back(child);
+        }
+        skeleton->m_GlobalNodeToJointIndex[jointIndex] = jointIndex;
+    }
+    return skeleton;
+}
+
+// one rotation channel per joint
+std::shared_ptr<RenderSys::SkeletalAnimation> CreateAnimation()
+{
+    auto animation = std::make_shared<RenderSys::SkeletalAnimation>("BenchmarkAnimation");
+    animation->m_Samplers.resize(JOINT_COUNT);
+    animation->m_Channels.resize(JOINT_COUNT);
+    for (int jointIndex = 0; jointIndex < JOINT_COUNT; ++jointIndex)
+    {
+        auto& sampler = animation->m_Samplers[jointIndex];
+        sampler.m_Interpolation = RenderSys::SkeletalAnimation::InterpolationMethod::LINEAR;
+        for (int key = 0; key < KEY_FRAME_COUNT; ++key)
+        {
+            const float time = key / 30.0f;
+            const glm::quat rotation = glm::angleAxis(glm::sin(time * 6.0f + jointIndex) * 0.5f, glm::vec3(0.0f, 0.0f, 1.0f));
+            sampler.m_Timestamps.push_back(time);
+            sampler.m_TRSoutputValuesToBeInterpolated.push_back(glm::vec4(rotation.x, rotation.y, rotation.z, rotation.w));
+        }
+
+        auto& channel = animation->m_Channels[jointIndex];
+        channel.m_Path = RenderSys::SkeletalAnimation::Path::ROTATION;
+        channel.m_SamplerIndex = jointIndex;
+        channel.m_Node = jointIndex;
+    }
+    animation->SetFirstKeyFrameTime(0.0f);
+    animation->SetLastKeyFrameTime((KEY_FRAME_COUNT - 1) / 30.0f);
+    return animation;
+}
+
+void CreateCharacters(entt::registry& registry, uint32_t characterCount)
+{
+    const auto skeleton = CreateSkeleton();
+    const std::shared_ptr<const RenderSys::SkeletalAnimation> animation = CreateAnimation();
+    for (uint32_t i = 0; i < characterCount; ++i)
+    {
+        const auto entity = registry.create();
+        registry.emplace<RenderSys::SkeletonComponent>(entity, std::make_shared<RenderSys::Skeleton>(*skeleton));
+        auto& animationComponent = registry.emplace<RenderSys::AnimationComponent>(entity);
+        animationComponent.m_Animations.push_back(animation);
+        animationComponent.m_CurrentTime = (i % KEY_FRAME_COUNT) / 30.0f; // desynchronize the characters
+    }
+}
+
+float MeasureFrameTime(uint32_t characterCount, uint32_t threadCount)
+{
+    entt::registry registry;
+    CreateCharacters(registry, characterCount);
+
+    RenderSys::JobSystem jobSystem(threadCount - 1);
+    RenderSys::AnimationSystem animationSystem(jobSystem);
+    for (int frame = 0; frame < WARMUP_FRAMES; ++frame)
+    {
+        animationSystem.Update(registry, FRAME_TIME);
+    }
+
+    const auto startTime = std::chrono::high_resolution_clock::now();
+    for (int frame = 0; frame < MEASURED_FRAMES; ++frame)
+    {
+        animationSystem.Update(registry, FRAME_TIME);
+    }
+    const auto endTime = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<float, std::milli>(endTime - startTime).count() / MEASURED_FRAMES;
+}
+
+// characters on a grid around a camera at the origin looking down +z, about a third of them behind it
+void MeasureLod(uint32_t characterCount, bool useLod)
+{
+    entt::registry registry;
+    CreateCharacters(registry, characterCount);
+    const uint32_t gridWidth = 32;
+    uint32_t i = 0;
+    for (auto entity : registry.view<RenderSys::SkeletonComponent>())
+    {
+        auto& transform = registry.emplace<RenderSys::TransformComponent>(entity);
+        transform.SetTranslation(glm::vec3((static_cast<float>(i % gridWidth) - gridWidth / 2) * 2.0f, 0.0f, 
+                                            static_cast<float>(i / gridWidth) * 3.0f - 30.0f));
+        transform.SetMat4Global();
+        i++;
+    }
+
+    RenderSys::PerspectiveCamera camera(45.0f, 0.1f, 500.0f);
+    camera.SetAspectRatio(16.0f / 9.0f);
+    camera.SetPosition(glm::vec3(0.0f, 2.0f, 0.0f));
+    camera.SetOrientation(glm::vec3(0.0f));
+
+    RenderSys::JobSystem jobSystem(0);
+    RenderSys::AnimationSystem animationSystem(jobSystem);
+    auto update = [&]()
+    {
+        if (useLod)
+            animationSystem.Update(registry, FRAME_TIME, camera);
+        else
+            animationSystem.Update(registry, FRAME_TIME);
+    };
+
+    for (int frame = 0; frame < WARMUP_FRAMES; ++frame)
+    {
+        update();
+    }
+
+    float cpuTimeMs = 0.0f;
+    float savedCpuTimeMs = 0.0f;
+    const auto startTime = std::chrono::high_resolution_clock::now();
+    for (int frame = 0; frame < MEASURED_FRAMES; ++frame)
+    {
+        update();
+        cpuTimeMs += animationSystem.GetStats().m_CpuTimeMs;
+        savedCpuTimeMs += animationSystem.GetStats().m_SavedCpuTimeMs;
+    }
+    const auto endTime = std::chrono::high_resolution_clock::now();
+    const auto& stats = animationSystem.GetStats();
+    std::cout << (useLod ? "on" : "off") << "\t" << std::chrono::duration<float, std::milli>(endTime - startTime).count() / MEASURED_FRAMES 
+                << "\t\t" << cpuTimeMs / MEASURED_FRAMES << "\t\t" << savedCpuTimeMs / MEASURED_FRAMES 
+                << "\t\t" << stats.m_CharactersPerLod[0] << "/" << stats.m_CharactersPerLod[1] << "/" << stats.m_CharactersPerLod[2] 
+                << "\t\t" << stats.m_FrozenCharacters << std::endl;
+}
+
+int main()
+{
+    const std::vector<uint32_t> characterCounts = {1, 10, 100, 250, 500, 1000};
+    const uint32_t maxThreadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << "AnimationSystem benchmark: " << JOINT_COUNT << " joints, " << KEY_FRAME_COUNT << " key frames per channel" << std::endl;
+    std::cout << "characters\tthreads\tms/frame\tspeedup" << std::endl;
+    for (auto characterCount : characterCounts)
+    {
+        float singleThreadedTime = 0.0f;
+        for (uint32_t threadCount = 1; threadCount <= maxThreadCount; threadCount *= 2)
+        {
+            const float frameTime = MeasureFrameTime(characterCount, threadCount);
+            if (threadCount == 1)
+            {
+                singleThreadedTime = frameTime;
+            }
+            std::cout << characterCount << "\t\t" << threadCount << "\t" << frameTime << "\t\t" << singleThreadedTime / frameTime << "x" << std::endl;
+        }
+    }
+
+    const uint32_t lodCharacterCount = 1000;
+    std::cout << std::endl << "Animation LOD, " << lodCharacterCount << " characters, 1 thread" << std::endl;
+    std::cout << "LOD\tms/frame\tcpu ms\t\tsaved cpu ms\tLOD 0/1/2\tfrozen" << std::endl;
+    MeasureLod(lodCharacterCount, false);
+    MeasureLod(lodCharacterCount, true);
+
+    return 0;
+}
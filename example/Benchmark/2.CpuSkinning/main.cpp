@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <glm/ext.hpp>
+
+#include <RenderSys/JobSystem.h>
+#include <RenderSys/Scene/CpuSkinning.h>
+#include <RenderSys/Scene/Skeleton.h>
+
+// Measures RenderSys::CpuSkinning (linear blend and dual quaternion) in vertices per second and checks the
+// vectorized and threaded paths against the scalar reference. The mesh and joint palette are synthetic so no model files are needed.
+
+static constexpr uint32_t VERTEX_COUNT = 1 << 18;
+static constexpr uint32_t JOINT_COUNT = 64;
+static constexpr int WARMUP_RUNS = 3;
+static constexpr int MEASURED_RUNS = 20;
+static constexpr float MAX_ALLOWED_ERROR = 1e-4f;
+
+void CreateMesh(RenderSys::SkinningStreams& bindPose, RenderSys::SkinningInfluences& influences)
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> position(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> weight(0.0f, 1.0f);
+    std::uniform_int_distribution<uint32_t> joint(0, JOINT_COUNT - 1);
+
+    bindPose.Resize(VERTEX_COUNT);
+    influences.Resize(VERTEX_COUNT);
+    for (uint32_t i = 0; i < VERTEX_COUNT; ++i)
+    {
+        const glm::vec3 normal = glm::normalize(glm::vec3(position(generator), position(generator), position(generator)) + glm::vec3(0.0f, 0.0f, 2.0f));
+        const glm::vec3 tangent = glm::normalize(glm::cross(normal, glm::vec3(0.0f, 1.0f, 0.0f)));
+        glm::vec4 weights(weight(generator), weight(generator), weight(generator), weight(generator));
+        weights /= weights.x + weights.y + weights.z + weights.w;
+        for (int component = 0; component < 3; ++component)
+        {
+            bindPose.m_Position[component][i] = position(generator);
+            bindPose.m_Normal[component][i] = normal[component];
+            bindPose.m_Tangent[component][i] = tangent[component];
+        }
+        for (int influence = 0; influence < 4; ++influence)
+        {
+            influences.m_Joints[influence][i] = joint(generator);
+            influences.m_Weights[influence][i] = weights[influence];
+        }
+    }
+
+    // a few vertices without any influence have to keep their bind pose
+    for (uint32_t i = 0; i < VERTEX_COUNT; i += 1021)
+    {
+        for (int influence = 0; influence < 4; ++influence)
+        {
+            influences.m_Weights[influence][i] = 0.0f;
+        }
+    }
+}
+
+std::vector<glm::mat4> CreateJointMatrices()
+{
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<float> angle(-3.14f, 3.14f);
+    std::uniform_real_distribution<float> offset(-0.5f, 0.5f);
+    std::vector<glm::mat4> jointMatrices(JOINT_COUNT);
+    for (auto& jointMatrix : jointMatrices)
+    {
+        const glm::vec3 axis = glm::normalize(glm::vec3(offset(generator), offset(generator), offset(generator)) + glm::vec3(0.0f, 1.0f, 0.0f));
+        jointMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(offset(generator), offset(generator), offset(generator))) *
+                        glm::rotate(glm::mat4(1.0f), angle(generator), axis) *
+                        glm::scale(glm::mat4(1.0f), glm::vec3(1.0f + offset(generator) * 0.2f));
+    }
+    return jointMatrices;
+}
+
+float MaxError(const RenderSys::SkinningStreams& expected, const RenderSys::SkinningStreams& actual)
+{
+    float maxError = 0.0f;
+    for (int component = 0; component < 3; ++component)
+    {
+        for (size_t i = 0; i < expected.Size(); ++i)
+        {
+            maxError = std::max(maxError, std::abs(expected.m_Position[component][i] - actual.m_Position[component][i]));
+            maxError = std::max(maxError, std::abs(expected.m_Normal[component][i] - actual.m_Normal[component][i]));
+            maxError = std::max(maxError, std::abs(expected.m_Tangent[component][i] - actual.m_Tangent[component][i]));
+        }
+    }
+    return maxError;
+}
+
+float MeasureVerticesPerSecond(const std::function<void()>& skin)
+{
+    for (int run = 0; run < WARMUP_RUNS; ++run)
+    {
+        skin();
+    }
+
+    const auto startTime = std::chrono::high_resolution_clock::now();
+    for (int run = 0; run < MEASURED_RUNS; ++run)
+    {
+        skin();
+    }
+    const auto endTime = std::chrono::high_resolution_clock::now();
+    const float seconds = std::chrono::duration<float>(endTime - startTime).count();
+    return static_cast<float>(VERTEX_COUNT) * MEASURED_RUNS / seconds;
+}
+
+// runs the reference, the vectorized and the threaded kernel on one joint palette, returns false on a mismatch
+template <typename Palette>
+bool RunBenchmark(const char* method, const RenderSys::SkinningStreams& bindPose, const RenderSys::SkinningInfluences& influences, 
+                    const std::vector<Palette>& palette)
+{
+    RenderSys::SkinningStreams reference, vectorized, threaded;
+    reference.Resize(VERTEX_COUNT);
+    vectorized.Resize(VERTEX_COUNT);
+
+    std::cout << method << " (" << palette.size() * sizeof(Palette) << " byte palette)" << std::endl;
+    std::cout << "variant\t\t\tthreads\tMvertices/s\tspeedup\tmax error" << std::endl;
+
+    const float referenceRate = MeasureVerticesPerSecond([&]()
+    {
+        RenderSys::CpuSkinning::SkinRangeReference(bindPose, influences, palette, reference, 0, VERTEX_COUNT);
+    });
+    std::cout << "scalar reference\t1\t" << referenceRate * 1e-6f << "\t\t1x" << std::endl;
+
+    const float vectorizedRate = MeasureVerticesPerSecond([&]()
+    {
+        RenderSys::CpuSkinning::SkinRange(bindPose, influences, palette, vectorized, 0, VERTEX_COUNT);
+    });
+    const float vectorizedError = MaxError(reference, vectorized);
+    std::cout << "vectorized\t\t1\t" << vectorizedRate * 1e-6f << "\t\t" << vectorizedRate / referenceRate << "x\t" << vectorizedError << std::endl;
+
+    bool passed = vectorizedError < MAX_ALLOWED_ERROR;
+    const uint32_t maxThreadCount = std::max(1u, std::thread::hardware_concurrency());
+    for (uint32_t threadCount = 2; threadCount <= maxThreadCount; threadCount *= 2)
+    {
+        RenderSys::JobSystem jobSystem(threadCount - 1);
+        const float threadedRate = MeasureVerticesPerSecond([&]()
+        {
+            RenderSys::CpuSkinning::Skin(bindPose, influences, palette, threaded, jobSystem);
+        });
+        const float threadedError = MaxError(reference, threaded);
+        std::cout << "vectorized threaded\t" << threadCount << "\t" << threadedRate * 1e-6f << "\t\t" << threadedRate / referenceRate << "x\t" << threadedError << std::endl;
+        passed = passed && threadedError < MAX_ALLOWED_ERROR;
+    }
+
+    if (!passed)
+    {
+        std::cout << "Skinned vertices differ from the scalar reference by more than " << MAX_ALLOWED_ERROR << std::endl;
+    }
+    return passed;
+}
+
+int main()
+{
+    RenderSys::SkinningStreams bindPose;
+    RenderSys::SkinningInfluences influences;
+    CreateMesh(bindPose, influences);
+    const auto jointMatrices = CreateJointMatrices();
+    std::vector<RenderSys::DualQuaternion> jointDualQuaternions;
+    for (const auto& jointMatrix : jointMatrices)
+    {
+        jointDualQuaternions.push_back(RenderSys::DualQuaternion::FromMatrix(jointMatrix));
+    }
+
+    std::cout << "CpuSkinning benchmark: " << VERTEX_COUNT << " vertices, " << JOINT_COUNT << " joints, 4 influences per vertex, "
+                << RenderSys::CpuSkinning::GetInstructionSet() << " (" << RenderSys::CpuSkinning::GetSimdWidth() << " wide)" << std::endl;
+
+    bool passed = RunBenchmark("Linear blend", bindPose, influences, jointMatrices);
+    passed = RunBenchmark("Dual quaternion", bindPose, influences, jointDualQuaternions) && passed;
+
+    return passed ? 0 : 1;
+}
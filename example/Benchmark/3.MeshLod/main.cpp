@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include <glm/ext.hpp>
+
+#include <RenderSys/RenderQueue.h>
+#include <RenderSys/Scene/Mesh.h>
+#include <RenderSys/Scene/MeshSimplifier.h>
+
+// Builds the level of detail chain of RenderSys::MeshSimplifier for a synthetic bumpy torus and reports, per level,
+// the triangle count, the error bound and the measured distance of sampled original vertices to the simplified surface.
+// Then sweeps the viewing distance and shows the triangles RenderSys::RenderQueue::SelectLod draws against the projected error.
+
+static constexpr uint32_t RING_SEGMENTS = 256;
+static constexpr uint32_t TUBE_SEGMENTS = 128;
+static constexpr float RING_RADIUS = 2.0f;
+static constexpr float TUBE_RADIUS = 0.75f;
+static constexpr uint32_t VERTEX_SAMPLE_STEP = 37;
+static constexpr float FOV_Y = 30.0f;
+static constexpr uint32_t VIEWPORT_HEIGHT = 1080;
+
+void CreateMesh(RenderSys::MeshData& meshData, RenderSys::SubMesh& subMesh)
+{
+    meshData.vertices.resize(RING_SEGMENTS * TUBE_SEGMENTS);
+    for (uint32_t ring = 0; ring < RING_SEGMENTS; ++ring)
+    {
+        for (uint32_t tube = 0; tube < TUBE_SEGMENTS; ++tube)
+        {
+            const float u = glm::two_pi<float>() * static_cast<float>(ring) / static_cast<float>(RING_SEGMENTS);
+            const float v = glm::two_pi<float>() * static_cast<float>(tube) / static_cast<float>(TUBE_SEGMENTS);
+            // low frequency bumps survive the first levels, the flat parts are simplified first
+            const float radius = TUBE_RADIUS * (1.0f + 0.08f * std::sin(6.0f * u) * std::cos(3.0f * v));
+            auto& vertex = meshData.vertices[ring * TUBE_SEGMENTS + tube];
+            vertex.pos = glm::vec3((RING_RADIUS + radius * std::cos(v)) * std::cos(u), radius * std::sin(v), (RING_RADIUS + radius * std::cos(v)) * std::sin(u));
+        }
+    }
+
+    for (uint32_t ring = 0; ring < RING_SEGMENTS; ++ring)
+    {
+        for (uint32_t tube = 0; tube < TUBE_SEGMENTS; ++tube)
+        {
+            const uint32_t nextRing = (ring + 1) % RING_SEGMENTS;
+            const uint32_t nextTube = (tube + 1) % TUBE_SEGMENTS;
+            const uint32_t a = ring * TUBE_SEGMENTS + tube;
+            const uint32_t b = nextRing * TUBE_SEGMENTS + tube;
+            const uint32_t c = nextRing * TUBE_SEGMENTS + nextTube;
+            const uint32_t d = ring * TUBE_SEGMENTS + nextTube;
+            meshData.indices.insert(meshData.indices.end(), { a, b, c, a, c, d });
+        }
+    }
+
+    subMesh.m_FirstIndex = 0;
+    subMesh.m_IndexCount = static_cast<uint32_t>(meshData.indices.size());
+    subMesh.m_VertexCount = static_cast<uint32_t>(meshData.vertices.size());
+    subMesh.m_BoundsMin = glm::vec3(std::numeric_limits<float>::max());
+    subMesh.m_BoundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+    for (const auto& vertex : meshData.vertices)
+    {
+        subMesh.m_BoundsMin = glm::min(subMesh.m_BoundsMin, vertex.pos);
+        subMesh.m_BoundsMax = glm::max(subMesh.m_BoundsMax, vertex.pos);
+    }
+    subMesh.m_HasBounds = true;
+}
+
+float DistanceToTriangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+{
+    // closest point on the triangle by its Voronoi regions (Ericson, Real-Time Collision Detection 5.1.5)
+    const glm::vec3 ab = b - a;
+    const glm::vec3 ac = c - a;
+    const glm::vec3 ap = p - a;
+    const float d1 = glm::dot(ab, ap);
+    const float d2 = glm::dot(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f) return glm::distance(p, a);
+    const glm::vec3 bp = p - b;
+    const float d3 = glm::dot(ab, bp);
+    const float d4 = glm::dot(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3) return glm::distance(p, b);
+    const float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) return glm::distance(p, a + ab * (d1 / (d1 - d3)));
+    const glm::vec3 cp = p - c;
+    const float d5 = glm::dot(ab, cp);
+    const float d6 = glm::dot(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6) return glm::distance(p, c);
+    const float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) return glm::distance(p, a + ac * (d2 / (d2 - d6)));
+    const float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) return glm::distance(p, b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6))));
+    const float denominator = 1.0f / (va + vb + vc);
+    return glm::distance(p, a + ab * (vb * denominator) + ac * (vc * denominator));
+}
+
+// largest distance of every VERTEX_SAMPLE_STEP-th original vertex to the simplified triangles
+float MeasureError(const RenderSys::MeshData& meshData, const RenderSys::SubMeshLod& lod)
+{
+    float maxDistance = 0.0f;
+    for (size_t vertex = 0; vertex < meshData.vertices.size(); vertex += VERTEX_SAMPLE_STEP)
+    {
+        const glm::vec3& position = meshData.vertices[vertex].pos;
+        float distance = std::numeric_limits<float>::max();
+        for (uint32_t i = 0; i < lod.m_IndexCount; i += 3)
+        {
+            const uint32_t* triangle = &meshData.indices[lod.m_FirstIndex + i];
+            distance = std::min(distance, DistanceToTriangle(position, meshData.vertices[triangle[0]].pos,
+                                                            meshData.vertices[triangle[1]].pos, meshData.vertices[triangle[2]].pos));
+        }
+        maxDistance = std::max(maxDistance, distance);
+    }
+    return maxDistance;
+}
+
+int main()
+{
+    RenderSys::MeshData meshData;
+    RenderSys::SubMesh subMesh;
+    CreateMesh(meshData, subMesh);
+    const uint32_t triangleCount = subMesh.m_IndexCount / 3;
+    std::cout << "MeshLod benchmark: torus with " << triangleCount << " triangles, " << meshData.vertices.size() << " vertices" << std::endl;
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    RenderSys::MeshSimplifier::BuildLodChain(meshData, subMesh);
+    const float buildTimeMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    std::cout << "Level of detail chain built in " << buildTimeMs << "ms" << std::endl;
+
+    std::cout << "\nlevel\ttriangles\tratio\terror bound\tmeasured error" << std::endl;
+    std::cout << "0\t" << triangleCount << "\t\t1\t0\t\t0" << std::endl;
+    bool passed = !subMesh.m_Lods.empty();
+    float previousError = 0.0f;
+    for (size_t level = 0; level < subMesh.m_Lods.size(); ++level)
+    {
+        const auto& lod = subMesh.m_Lods[level];
+        const float measuredError = MeasureError(meshData, lod);
+        std::cout << level + 1 << "\t" << lod.m_IndexCount / 3 << "\t\t" << static_cast<float>(lod.m_IndexCount / 3) / static_cast<float>(triangleCount)
+                    << "\t" << lod.m_Error << "\t" << measuredError << std::endl;
+        // the selection relies on errors which grow with the level
+        passed = passed && lod.m_Error >= previousError;
+        previousError = lod.m_Error;
+    }
+
+    RenderSys::LodSettings lodSettings;
+    lodSettings.m_ProjectionScale = RenderSys::RenderQueue::MakeLodProjectionScale(FOV_Y, VIEWPORT_HEIGHT);
+    std::cout << "\nSelection at " << VIEWPORT_HEIGHT << "p, " << FOV_Y << " degrees vertical field of view" << std::endl;
+    for (const float maxErrorPixels : { 0.5f, 1.0f, 4.0f })
+    {
+        lodSettings.m_MaxErrorPixels = maxErrorPixels;
+        std::cout << "\nmax error " << maxErrorPixels << " pixels\ndistance\tlevel\ttriangles\tratio\terror (pixels)" << std::endl;
+        for (float distance = 2.0f; distance <= 512.0f; distance *= 2.0f)
+        {
+            const uint32_t lod = RenderSys::RenderQueue::SelectLod(subMesh, distance, 1.0f, lodSettings);
+            const uint32_t drawnTriangles = lod == 0 ? triangleCount : subMesh.m_Lods[lod - 1].m_IndexCount / 3;
+            const float error = lod == 0 ? 0.0f : subMesh.m_Lods[lod - 1].m_Error;
+            const float errorPixels = error * lodSettings.m_ProjectionScale / distance;
+            std::cout << distance << "\t\t" << lod << "\t" << drawnTriangles << "\t\t" << static_cast<float>(drawnTriangles) / static_cast<float>(triangleCount)
+                        << "\t" << errorPixels << std::endl;
+            passed = passed && errorPixels <= maxErrorPixels;
+        }
+    }
+
+    if (!passed)
+    {
+        std::cout << "The level of detail chain is empty, its errors do not grow or a selected level exceeds the pixel error" << std::endl;
+    }
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <glm/ext.hpp>
+
+#include <RenderSys/Buffer.h>
+#include <RenderSys/Scene/Mesh.h>
+#include <RenderSys/VertexPacking.h>
+
+// Packs the vertices of a finely tessellated sphere with RenderSys::VertexPacking and compares the decoded attributes
+// with the full RenderSys::Vertex: the vertex memory, the angular error of the normals and tangents, the texture coordinate
+// error in texels and the difference of the diffuse and specular shading in 8 bit color levels, for both uv formats.
+
+static constexpr uint32_t LONGITUDE_SEGMENTS = 1024;
+static constexpr uint32_t LATITUDE_SEGMENTS = 512;
+static constexpr float TEXTURE_SIZE = 2048.0f;
+static constexpr float SHININESS = 64.0f;
+// the parity limits, within half a texel and one color level
+static constexpr float MAX_TEXEL_ERROR = 0.5f;
+static constexpr float MAX_COLOR_LEVELS = 1.0f;
+
+void CreateSphere(RenderSys::MeshData& meshData)
+{
+    meshData.vertices.resize((LONGITUDE_SEGMENTS + 1) * (LATITUDE_SEGMENTS + 1));
+    for (uint32_t latitude = 0; latitude <= LATITUDE_SEGMENTS; ++latitude)
+    {
+        for (uint32_t longitude = 0; longitude <= LONGITUDE_SEGMENTS; ++longitude)
+        {
+            const float u = static_cast<float>(longitude) / static_cast<float>(LONGITUDE_SEGMENTS);
+            const float v = static_cast<float>(latitude) / static_cast<float>(LATITUDE_SEGMENTS);
+            const float phi = glm::two_pi<float>() * u;
+            const float theta = glm::pi<float>() * v;
+            auto& vertex = meshData.vertices[latitude * (LONGITUDE_SEGMENTS + 1) + longitude];
+            vertex.normal = glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+            vertex.pos = vertex.normal * 3.0f;
+            vertex.uv0 = glm::vec2(u, v);
+            vertex.tangent = glm::vec3(-std::sin(phi), 0.0f, std::cos(phi));
+            vertex.color = glm::vec4(u, v, 1.0f - u, 1.0f);
+        }
+    }
+}
+
+float AngleDegrees(const glm::vec3& a, const glm::vec3& b)
+{
+    // acos of the dot product loses the small angles to float rounding
+    return glm::degrees(std::atan2(glm::length(glm::cross(a, b)), glm::dot(a, b)));
+}
+
+// diffuse and Blinn-Phong specular of a white light in 8 bit levels, the normal is bent by a fixed normal map texel
+float Shade(const RenderSys::Vertex& vertex, const glm::vec3& lightDirection, const glm::vec3& viewDirection)
+{
+    const glm::vec3 normal = glm::normalize(vertex.normal);
+    const glm::vec3 tangent = glm::normalize(vertex.tangent - normal * glm::dot(normal, vertex.tangent));
+    const glm::vec3 bitangent = glm::cross(normal, tangent);
+    const glm::vec3 mappedNormal = glm::normalize(0.3f * tangent - 0.2f * bitangent + normal);
+    const float diffuse = std::max(glm::dot(mappedNormal, lightDirection), 0.0f);
+    const glm::vec3 halfVector = glm::normalize(lightDirection + viewDirection);
+    const float specular = std::pow(std::max(glm::dot(mappedNormal, halfVector), 0.0f), SHININESS);
+    return 255.0f * std::min(0.8f * diffuse + 0.2f * specular, 1.0f);
+}
+
+bool Compare(const RenderSys::VertexBuffer& vertices, const RenderSys::PackedVertexBuffer& packedVertices)
+{
+    const glm::vec3 lightDirection = glm::normalize(glm::vec3(0.5f, 0.8f, -0.3f));
+    const glm::vec3 viewDirection = glm::normalize(glm::vec3(-0.2f, 0.4f, 1.0f));
+    float maxNormalError = 0.0f;
+    float maxTangentError = 0.0f;
+    float maxTexelError = 0.0f;
+    float maxColorLevels = 0.0f;
+    float maxShadingLevels = 0.0f;
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        const RenderSys::Vertex decoded = RenderSys::VertexPacking::Unpack(packedVertices[i], packedVertices.uvFormat);
+        maxNormalError = std::max(maxNormalError, AngleDegrees(vertices[i].normal, decoded.normal));
+        maxTangentError = std::max(maxTangentError, AngleDegrees(vertices[i].tangent, decoded.tangent));
+        const glm::vec2 texelError = glm::abs(vertices[i].texcoord0 - decoded.texcoord0) * TEXTURE_SIZE;
+        maxTexelError = std::max({ maxTexelError, texelError.x, texelError.y });
+        const glm::vec3 colorLevels = glm::abs(vertices[i].color - decoded.color) * 255.0f;
+        maxColorLevels = std::max({ maxColorLevels, colorLevels.r, colorLevels.g, colorLevels.b });
+        const float shadingLevels = std::abs(Shade(vertices[i], lightDirection, viewDirection) - Shade(decoded, lightDirection, viewDirection));
+        maxShadingLevels = std::max(maxShadingLevels, shadingLevels);
+    }
+    std::cout << "normal " << maxNormalError << " degrees, tangent " << maxTangentError << " degrees, texcoord " << maxTexelError
+                << " texels of " << TEXTURE_SIZE << ", color " << maxColorLevels << " levels, shading " << maxShadingLevels << " levels" << std::endl;
+    return maxTexelError <= MAX_TEXEL_ERROR && maxColorLevels <= MAX_COLOR_LEVELS && maxShadingLevels <= MAX_COLOR_LEVELS;
+}
+
+int main()
+{
+    RenderSys::MeshData meshData;
+    CreateSphere(meshData);
+    std::cout << "VertexPacking benchmark: sphere with " << meshData.vertices.size() << " vertices" << std::endl;
+
+    // the full vertices with the colors of the mesh, getVertexBufferForRenderer() leaves them out
+    auto vertices = meshData.getVertexBufferForRenderer();
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        vertices[i].color = glm::vec3(meshData.vertices[i].color);
+    }
+
+    const size_t modelBytes = meshData.vertices.size() * sizeof(RenderSys::ModelVertex);
+    const size_t fullBytes = vertices.size() * sizeof(RenderSys::Vertex);
+    const size_t packedBytes = vertices.size() * sizeof(RenderSys::PackedVertex);
+    std::cout << "ModelVertex " << sizeof(RenderSys::ModelVertex) << " bytes, Vertex " << sizeof(RenderSys::Vertex) << " bytes, PackedVertex "
+                << sizeof(RenderSys::PackedVertex) << " bytes" << std::endl;
+    std::cout << "Vertex memory: model " << modelBytes / 1024 << "KB, full " << fullBytes / 1024 << "KB, packed " << packedBytes / 1024
+                << "KB, " << static_cast<float>(fullBytes) / static_cast<float>(packedBytes) << "x less to fetch" << std::endl;
+    bool passed = fullBytes >= 2 * packedBytes;
+
+    for (const auto uvFormat : { RenderSys::PackedUvFormat::Float16, RenderSys::PackedUvFormat::Unorm16 })
+    {
+        const auto start = std::chrono::high_resolution_clock::now();
+        const auto packedVertices = meshData.getPackedVertexBufferForRenderer(uvFormat);
+        const float packTimeMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        std::cout << "\n" << (uvFormat == RenderSys::PackedUvFormat::Float16 ? "Float16" : "Unorm16") << " texture coordinates, packed in "
+                    << packTimeMs << "ms" << std::endl;
+        passed = Compare(vertices, packedVertices) && passed;
+    }
+
+    if (!passed)
+    {
+        std::cout << "The packed vertices are not 2 times smaller or their decoded attributes do not shade like the full vertices" << std::endl;
+    }
+    return passed ? 0 : 1;
+}
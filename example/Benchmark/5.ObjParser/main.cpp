@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <glm/ext.hpp>
+
+#include <RenderSys/Geometry.h>
+#include <RenderSys/GeometryParser.h>
+#include <RenderSys/JobSystem.h>
+#include <RenderSys/MeshOptimizer.h>
+
+// Compares the throughput of RenderSys::GeometryParser with the previous loaders: TinyObjLoader followed by
+// RenderSys::MeshOptimizer::WeldVertices for an OBJ file and the std::getline / std::istringstream loop of
+// Geometry::load3DGeometry for a [points] / [indices] file, and checks that both produce the same triangles.
+// Without arguments a scanned mesh like OBJ is generated, ObjParserBenchmark <file.obj> parses an existing one.
+
+static constexpr uint32_t LONGITUDE_SEGMENTS = 1536;
+static constexpr uint32_t LATITUDE_SEGMENTS = 768;
+static constexpr uint32_t TEXT_POINTS = 1000000;
+static constexpr float MAX_DIFFERENCE = 1e-5f;
+
+using Clock = std::chrono::high_resolution_clock;
+
+float SecondsSince(const Clock::time_point& start)
+{
+    return std::chrono::duration<float>(Clock::now() - start).count();
+}
+
+float Throughput(const std::filesystem::path& path, const float seconds)
+{
+    return static_cast<float>(std::filesystem::file_size(path)) / (1024.0f * 1024.0f) / seconds;
+}
+
+// a bumpy sphere with positions, texture coordinates and normals, written like the exports of scanning software
+void WriteObj(const std::filesystem::path& path)
+{
+    std::ofstream file(path);
+    file << "# generated by ObjParserBenchmark\no scan\n";
+    for (uint32_t latitude = 0; latitude <= LATITUDE_SEGMENTS; ++latitude)
+    {
+        for (uint32_t longitude = 0; longitude <= LONGITUDE_SEGMENTS; ++longitude)
+        {
+            const float u = static_cast<float>(longitude) / static_cast<float>(LONGITUDE_SEGMENTS);
+            const float v = static_cast<float>(latitude) / static_cast<float>(LATITUDE_SEGMENTS);
+            const float phi = glm::two_pi<float>() * u;
+            const float theta = glm::pi<float>() * v;
+            const glm::vec3 normal(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+            const float radius = 1.0f + 0.02f * std::sin(40.0f * phi) * std::sin(30.0f * theta);
+            const glm::vec3 position = normal * radius;
+            file << "v " << position.x << " " << position.y << " " << position.z << "\n";
+            file << "vt " << u << " " << v << "\n";
+            file << "vn " << normal.x << " " << normal.y << " " << normal.z << "\n";
+        }
+    }
+    for (uint32_t latitude = 0; latitude < LATITUDE_SEGMENTS; ++latitude)
+    {
+        for (uint32_t longitude = 0; longitude < LONGITUDE_SEGMENTS; ++longitude)
+        {
+            const uint32_t a = latitude * (LONGITUDE_SEGMENTS + 1) + longitude + 1;
+            const uint32_t b = a + LONGITUDE_SEGMENTS + 1;
+            file << "f " << a << "/" << a << "/" << a << " " << b << "/" << b << "/" << b << " " << b + 1 << "/" << b + 1 << "/" << b + 1 << "\n";
+            file << "f " << a << "/" << a << "/" << a << " " << b + 1 << "/" << b + 1 << "/" << b + 1 << " " << a + 1 << "/" << a + 1 << "/" << a + 1 << "\n";
+        }
+    }
+}
+
+void WriteText(const std::filesystem::path& path)
+{
+    std::ofstream file(path);
+    file << "# generated by ObjParserBenchmark\n[points]\n";
+    for (uint32_t point = 0; point < TEXT_POINTS; ++point)
+    {
+        const float angle = static_cast<float>(point) * 0.001f;
+        file << std::cos(angle) << " " << std::sin(angle) << " " << angle * 0.0001f << " 0.5 0.25 " << (point % 256) / 255.0f << "\n";
+    }
+    file << "\n[indices]\n";
+    for (uint32_t point = 0; point + 2 < TEXT_POINTS; ++point)
+    {
+        file << point << " " << point + 1 << " " << point + 2 << "\n";
+    }
+}
+
+// the loop Geometry::load3DGeometry used before GeometryParser, for the comparison
+bool LoadTextWithStreams(const std::filesystem::path& path, RenderSys::VertexBuffer& vertexData, std::vector<uint32_t>& indexData)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    bool points = false;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line == "[points]" || line == "[indices]")
+        {
+            points = line == "[points]";
+        }
+        else if (!line.empty() && line[0] != '#')
+        {
+            std::istringstream iss(line);
+            if (points)
+            {
+                RenderSys::Vertex vertex{};
+                iss >> vertex.position.x >> vertex.position.y >> vertex.position.z >> vertex.color.r >> vertex.color.g >> vertex.color.b;
+                vertexData.vertices.push_back(vertex);
+            }
+            else
+            {
+                uint32_t index[3];
+                iss >> index[0] >> index[1] >> index[2];
+                indexData.insert(indexData.end(), index, index + 3);
+            }
+        }
+    }
+    return true;
+}
+
+bool Near(const glm::vec3& a, const glm::vec3& b)
+{
+    return glm::all(glm::lessThanEqual(glm::abs(a - b), glm::vec3(MAX_DIFFERENCE)));
+}
+
+bool CompareObj(const std::filesystem::path& path)
+{
+    auto start = Clock::now();
+    Geometry::TinyObjLoader loader;
+    if (!loader.load(path.string()))
+    {
+        return false;
+    }
+    const float tinyObjSeconds = SecondsSince(start);
+    RenderSys::VertexBuffer soup;
+    if (!Geometry::loadGeometryFromObj(path, soup))
+    {
+        return false;
+    }
+    start = Clock::now();
+    RenderSys::VertexBuffer weldedVertices;
+    std::vector<uint32_t> weldedIndices;
+    RenderSys::MeshOptimizer::WeldVertices(soup, weldedVertices, weldedIndices);
+    const float weldSeconds = SecondsSince(start);
+
+    start = Clock::now();
+    RenderSys::VertexBuffer vertices;
+    std::vector<uint32_t> indices;
+    if (!RenderSys::GeometryParser::ParseObj(path, vertices, indices))
+    {
+        return false;
+    }
+    const float parserSeconds = SecondsSince(start);
+
+    std::cout << "OBJ " << path.filename().string() << ", " << std::filesystem::file_size(path) / (1024 * 1024) << "MB, "
+                << indices.size() / 3 << " triangles, " << vertices.size() << " vertices (" << weldedVertices.size() << " after WeldVertices)" << std::endl;
+    std::cout << "  TinyObjLoader " << tinyObjSeconds * 1000.0f << "ms, " << Throughput(path, tinyObjSeconds) << "MB/s, with WeldVertices "
+                << (tinyObjSeconds + weldSeconds) * 1000.0f << "ms, " << Throughput(path, tinyObjSeconds + weldSeconds) << "MB/s" << std::endl;
+    std::cout << "  GeometryParser " << parserSeconds * 1000.0f << "ms, " << Throughput(path, parserSeconds) << "MB/s, "
+                << (tinyObjSeconds + weldSeconds) / parserSeconds << "x faster" << std::endl;
+
+    // both keep the triangles in file order
+    if (indices.size() != soup.size())
+    {
+        std::cout << "  GeometryParser read " << indices.size() << " corners, TinyObjLoader " << soup.size() << std::endl;
+        return false;
+    }
+    for (size_t corner = 0; corner < indices.size(); ++corner)
+    {
+        const auto& vertex = vertices[indices[corner]];
+        if (!Near(vertex.position, soup[corner].position) || !Near(vertex.normal, soup[corner].normal) || !Near(vertex.color, soup[corner].color))
+        {
+            std::cout << "  corner " << corner << " differs from TinyObjLoader" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CompareText(const std::filesystem::path& path)
+{
+    auto start = Clock::now();
+    RenderSys::VertexBuffer streamVertices;
+    std::vector<uint32_t> streamIndices;
+    if (!LoadTextWithStreams(path, streamVertices, streamIndices))
+    {
+        return false;
+    }
+    const float streamSeconds = SecondsSince(start);
+
+    start = Clock::now();
+    RenderSys::VertexBuffer vertices;
+    std::vector<uint32_t> indices;
+    if (!Geometry::load3DGeometry(path, vertices, indices, 3, true))
+    {
+        return false;
+    }
+    const float parserSeconds = SecondsSince(start);
+
+    std::cout << "Text " << path.filename().string() << ", " << std::filesystem::file_size(path) / (1024 * 1024) << "MB, "
+                << vertices.size() << " points, " << indices.size() / 3 << " triangles" << std::endl;
+    std::cout << "  getline and istringstream " << streamSeconds * 1000.0f << "ms, " << Throughput(path, streamSeconds) << "MB/s" << std::endl;
+    std::cout << "  GeometryParser " << parserSeconds * 1000.0f << "ms, " << Throughput(path, parserSeconds) << "MB/s, "
+                << streamSeconds / parserSeconds << "x faster" << std::endl;
+
+    if (indices != streamIndices || vertices.size() != streamVertices.size())
+    {
+        std::cout << "  the parsed points or indices differ from the istringstream loop" << std::endl;
+        return false;
+    }
+    for (size_t point = 0; point < vertices.size(); ++point)
+    {
+        if (!Near(vertices[point].position, streamVertices[point].position) || !Near(vertices[point].color, streamVertices[point].color))
+        {
+            std::cout << "  point " << point << " differs from the istringstream loop" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "ObjParser benchmark: " << RenderSys::JobSystem::Get().GetThreadCount() << " threads, chunks of "
+                << RenderSys::GeometryParser::CHUNK_SIZE / 1024 << "KB" << std::endl;
+
+    const std::filesystem::path directory = std::filesystem::temp_directory_path();
+    const std::filesystem::path objPath = argc > 1 ? std::filesystem::path(argv[1]) : directory / "ObjParserBenchmark.obj";
+    const std::filesystem::path textPath = directory / "ObjParserBenchmark.txt";
+    if (argc <= 1)
+    {
+        WriteObj(objPath);
+    }
+    WriteText(textPath);
+
+    const bool objPassed = CompareObj(objPath);
+    const bool textPassed = CompareText(textPath);
+    if (argc <= 1)
+    {
+        std::filesystem::remove(objPath);
+    }
+    std::filesystem::remove(textPath);
+
+    if (!objPassed || !textPassed)
+    {
+        std::cout << "GeometryParser does not read the same geometry as the previous loaders" << std::endl;
+    }
+    return objPassed && textPassed ? 0 : 1;
+}
@@ -0,0 +1,365 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <glm/ext.hpp>
+#include <glm/gtc/packing.hpp>
+#include <Walnut/Application.h>
+#include <Walnut/EntryPoint.h>
+
+#include <RenderSys/Renderer2D.h>
+#include <RenderSys/SpriteAtlas.h>
+#include <RenderSys/SpriteBatch.h>
+#include <imgui.h>
+
+// Fills one frame of a million quads, sprites and lines with RenderSys::SpriteBatch and with the vertex and 16 bit
+// index buffers Renderer2D::SetVertexBufferData() and SetIndexBufferData() took before: four vertices and six indices
+// per quad, and a draw for every 16384 quads the indices can address. Reports the CPU time, the bytes and the draw
+// calls per frame and checks that the corners expanded by sprite-batch-vertex.glsl match the vertices.
+// Then draws the same million quads through Renderer2D every frame and reports the CPU time of filling the mapped
+// instance buffer and submitting the frame, averaged over FRAME_COUNT frames.
+
+static constexpr uint32_t SPRITE_COUNT = 1000000;
+static constexpr uint32_t FRAME_COUNT = 20;
+static constexpr uint32_t ATLAS_SIZE = 1024;
+static constexpr uint32_t IMAGE_COUNT = 64;
+static constexpr uint32_t IMAGE_SIZE = 32;
+// quads of four vertices which 16 bit indices can address in one draw
+static constexpr uint32_t MAX_INDEXED_QUADS = 65536 / 4;
+static constexpr float MAX_DIFFERENCE = 1e-3f;
+
+using Clock = std::chrono::high_resolution_clock;
+
+// the kinds of draws a frame mixes
+enum class SpriteKind
+{
+    QUAD = 0,
+    SPRITE,
+    ROTATED_SPRITE,
+    LINE
+};
+
+struct SpriteInput
+{
+    SpriteKind m_Kind;
+    glm::vec2 m_Center;
+    glm::vec2 m_Size;
+    float m_Rotation;
+    uint32_t m_Image;
+    uint32_t m_Color;
+};
+
+// the vertex of the previous path
+struct QuadVertex
+{
+    glm::vec2 m_Position;
+    glm::vec2 m_Uv;
+    glm::vec4 m_Color;
+};
+
+float MillisecondsSince(const Clock::time_point& start)
+{
+    return std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+}
+
+std::vector<SpriteInput> CreateInputs()
+{
+    std::vector<SpriteInput> inputs(SPRITE_COUNT);
+    uint32_t random = 12345;
+    const auto next = [&random]()
+    {
+        random = random * 1664525u + 1013904223u;
+        return static_cast<float>(random >> 8) / static_cast<float>(1 << 24);
+    };
+    for (uint32_t i = 0; i < SPRITE_COUNT; ++i)
+    {
+        auto& input = inputs[i];
+        const float kind = next();
+        // mostly axis aligned sprites, like particles and tiles
+        input.m_Kind = kind < 0.2f ? SpriteKind::QUAD : kind < 0.8f ? SpriteKind::SPRITE : kind < 0.95f ? SpriteKind::ROTATED_SPRITE : SpriteKind::LINE;
+        input.m_Center = glm::vec2(next() * 1920.0f, next() * 1080.0f);
+        input.m_Size = glm::vec2(4.0f + next() * 28.0f, 4.0f + next() * 28.0f);
+        input.m_Rotation = next() * glm::two_pi<float>();
+        input.m_Image = static_cast<uint32_t>(next() * IMAGE_COUNT) % IMAGE_COUNT;
+        input.m_Color = RenderSys::SpriteBatch::PackColor(glm::vec4(next(), next(), next(), 1.0f));
+    }
+    return inputs;
+}
+
+void FillBatch(RenderSys::SpriteBatch& batch, const std::vector<SpriteInput>& inputs, const std::vector<RenderSys::SpriteRegion>& regions)
+{
+    for (const auto& input : inputs)
+    {
+        switch (input.m_Kind)
+        {
+        case SpriteKind::QUAD:
+            batch.DrawQuad(input.m_Center, input.m_Size, input.m_Color);
+            break;
+        case SpriteKind::SPRITE:
+            batch.DrawSprite(input.m_Center, input.m_Size, regions[input.m_Image], input.m_Color);
+            break;
+        case SpriteKind::ROTATED_SPRITE:
+            batch.DrawSprite(input.m_Center, input.m_Size, input.m_Rotation, regions[input.m_Image], input.m_Color);
+            break;
+        case SpriteKind::LINE:
+            batch.DrawLine(input.m_Center, input.m_Center + input.m_Size, 2.0f, input.m_Color);
+            break;
+        }
+    }
+}
+
+glm::vec2 ToUv(const uint16_t u, const uint16_t v)
+{
+    return glm::vec2(u, v) / 65535.0f;
+}
+
+// the corners of a quad in the order of sprite-batch-vertex.glsl, with their uv
+void GetCorners(const SpriteInput& input, const RenderSys::SpriteRegion& region, glm::vec2 positions[4], glm::vec2 uvs[4])
+{
+    glm::vec2 center = input.m_Center;
+    glm::vec2 axisX(input.m_Size.x * 0.5f, 0.0f);
+    glm::vec2 axisY(0.0f, input.m_Size.y * 0.5f);
+    if (input.m_Kind == SpriteKind::ROTATED_SPRITE)
+    {
+        axisX = glm::vec2(std::cos(input.m_Rotation), std::sin(input.m_Rotation)) * (input.m_Size.x * 0.5f);
+        axisY = glm::vec2(-std::sin(input.m_Rotation), std::cos(input.m_Rotation)) * (input.m_Size.y * 0.5f);
+    }
+    else if (input.m_Kind == SpriteKind::LINE)
+    {
+        center = input.m_Center + input.m_Size * 0.5f;
+        axisX = input.m_Size * 0.5f;
+        axisY = glm::normalize(glm::vec2(-axisX.y, axisX.x));
+    }
+    const glm::vec2 corners[4] = { glm::vec2(-1.0f, -1.0f), glm::vec2(1.0f, -1.0f), glm::vec2(1.0f, 1.0f), glm::vec2(-1.0f, 1.0f) };
+    const glm::vec2 uvMin = ToUv(region.m_UvRect[0], region.m_UvRect[1]);
+    const glm::vec2 uvMax = ToUv(region.m_UvRect[2], region.m_UvRect[3]);
+    for (uint32_t corner = 0; corner < 4; ++corner)
+    {
+        positions[corner] = center + corners[corner].x * axisX + corners[corner].y * axisY;
+        uvs[corner] = glm::mix(uvMin, uvMax, corners[corner] * 0.5f + 0.5f);
+    }
+}
+
+// what the application built for the previous Renderer2D, one draw per 16384 quads
+uint32_t FillIndexedQuads(const std::vector<SpriteInput>& inputs, const std::vector<RenderSys::SpriteRegion>& regions, const RenderSys::SpriteRegion& whiteRegion,
+                            std::vector<QuadVertex>& vertices, std::vector<uint16_t>& indices)
+{
+    vertices.clear();
+    indices.clear();
+    uint32_t draws = 0;
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        const auto& input = inputs[i];
+        const auto& region = input.m_Kind == SpriteKind::QUAD || input.m_Kind == SpriteKind::LINE ? whiteRegion : regions[input.m_Image];
+        glm::vec2 positions[4];
+        glm::vec2 uvs[4];
+        GetCorners(input, region, positions, uvs);
+        const glm::vec4 color = glm::unpackUnorm4x8(input.m_Color);
+        const uint16_t firstVertex = static_cast<uint16_t>((i % MAX_INDEXED_QUADS) * 4);
+        for (uint32_t corner = 0; corner < 4; ++corner)
+        {
+            vertices.push_back(QuadVertex{positions[corner], uvs[corner], color});
+        }
+        const uint16_t quadIndices[6] = { 0, 1, 2, 2, 3, 0 };
+        for (const uint16_t index : quadIndices)
+        {
+            indices.push_back(firstVertex + index);
+        }
+        if (i % MAX_INDEXED_QUADS == 0)
+        {
+            draws++;
+        }
+    }
+    return draws;
+}
+
+bool Compare(const std::vector<RenderSys::SpriteInstance>& instances, const std::vector<QuadVertex>& vertices)
+{
+    const glm::vec2 corners[4] = { glm::vec2(-1.0f, -1.0f), glm::vec2(1.0f, -1.0f), glm::vec2(1.0f, 1.0f), glm::vec2(-1.0f, 1.0f) };
+    for (uint32_t i = 0; i < SPRITE_COUNT; ++i)
+    {
+        const auto& instance = instances[i];
+        const glm::vec2 uvMin = ToUv(instance.m_Region.m_UvRect[0], instance.m_Region.m_UvRect[1]);
+        const glm::vec2 uvMax = ToUv(instance.m_Region.m_UvRect[2], instance.m_Region.m_UvRect[3]);
+        const glm::vec4 color = glm::unpackUnorm4x8(instance.m_Color);
+        for (uint32_t corner = 0; corner < 4; ++corner)
+        {
+            // sprite-batch-vertex.glsl
+            const glm::vec2 position = instance.m_Center + corners[corner].x * instance.m_AxisX + corners[corner].y * instance.m_AxisY;
+            const glm::vec2 uv = glm::mix(uvMin, uvMax, corners[corner] * 0.5f + 0.5f);
+            const auto& vertex = vertices[i * 4 + corner];
+            if (glm::any(glm::greaterThan(glm::abs(position - vertex.m_Position), glm::vec2(MAX_DIFFERENCE))) || 
+                glm::any(glm::greaterThan(glm::abs(uv - vertex.m_Uv), glm::vec2(MAX_DIFFERENCE))) || 
+                glm::any(glm::greaterThan(glm::abs(color - vertex.m_Color), glm::vec4(MAX_DIFFERENCE))))
+            {
+                std::cout << "  corner " << corner << " of quad " << i << " differs from the vertex buffer" << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// the batch into a CPU buffer against the vertex and index buffers, returns false when they differ
+bool RunCpuComparison(const RenderSys::SpriteAtlas& atlas, const std::vector<RenderSys::SpriteRegion>& regions, const std::vector<SpriteInput>& inputs)
+{
+    // stands in for the persistently mapped instance buffer of the renderer
+    std::vector<RenderSys::SpriteInstance> instances(RenderSys::SpriteBatch::MAX_SPRITES);
+    RenderSys::SpriteBatch batch;
+    float batchMs = 0.0f;
+    for (uint32_t frame = 0; frame < FRAME_COUNT; ++frame)
+    {
+        const auto start = Clock::now();
+        batch.Begin(instances.data(), static_cast<uint32_t>(instances.size()), atlas.GetWhiteRegion());
+        FillBatch(batch, inputs, regions);
+        batch.End();
+        batchMs += MillisecondsSince(start);
+    }
+    batchMs /= FRAME_COUNT;
+
+    std::vector<QuadVertex> vertices;
+    std::vector<uint16_t> indices;
+    vertices.reserve(static_cast<size_t>(SPRITE_COUNT) * 4);
+    indices.reserve(static_cast<size_t>(SPRITE_COUNT) * 6);
+    float indexedMs = 0.0f;
+    uint32_t indexedDraws = 0;
+    for (uint32_t frame = 0; frame < FRAME_COUNT; ++frame)
+    {
+        const auto start = Clock::now();
+        indexedDraws = FillIndexedQuads(inputs, regions, atlas.GetWhiteRegion(), vertices, indices);
+        indexedMs += MillisecondsSince(start);
+    }
+    indexedMs /= FRAME_COUNT;
+
+    const float batchMegabytes = static_cast<float>(SPRITE_COUNT * sizeof(RenderSys::SpriteInstance)) / (1024.0f * 1024.0f);
+    const float indexedMegabytes = static_cast<float>(vertices.size() * sizeof(QuadVertex) + indices.size() * sizeof(uint16_t)) / (1024.0f * 1024.0f);
+    std::cout << "SpriteBatch benchmark: " << SPRITE_COUNT << " quads, sprites and lines per frame, average of " << FRAME_COUNT << " frames" << std::endl;
+    std::cout << "  vertex and 16 bit index buffers " << indexedMs << "ms, " << indexedMegabytes << "MB, " << indexedDraws << " draws" << std::endl;
+    std::cout << "  SpriteBatch " << batchMs << "ms, " << batchMegabytes << "MB, 1 draw, "
+                << SPRITE_COUNT / (batchMs * 1000.0f) << "M sprites/s, " << indexedMs / batchMs << "x faster" << std::endl;
+
+    if (!Compare(instances, vertices))
+    {
+        std::cout << "SpriteBatch does not expand into the same quads as the vertex buffer" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+class SpriteBatchBenchmarkLayer : public Walnut::Layer
+{
+public:
+    virtual void OnAttach() override
+    {
+        RenderSys::SpriteAtlas atlas(ATLAS_SIZE, ATLAS_SIZE);
+        m_regions.resize(IMAGE_COUNT);
+        std::vector<uint8_t> image(IMAGE_SIZE * IMAGE_SIZE * 4);
+        for (uint32_t i = 0; i < IMAGE_COUNT; ++i)
+        {
+            std::fill(image.begin(), image.end(), static_cast<uint8_t>(i * 4));
+            if (!atlas.Add(image.data(), IMAGE_SIZE, IMAGE_SIZE, m_regions[i]))
+            {
+                std::cout << "the images do not fit into the atlas" << std::endl;
+                return;
+            }
+        }
+        m_inputs = CreateInputs();
+        if (!RunCpuComparison(atlas, m_regions, m_inputs))
+        {
+            m_inputs.clear();
+            return;
+        }
+
+        m_renderer = std::make_unique<RenderSys::Renderer2D>();
+        m_renderer->Init();
+        m_renderer->SetSpriteAtlas(atlas);
+    }
+
+    virtual void OnDetach() override
+    {
+        if (m_renderer)
+        {
+            m_renderer->Destroy();
+        }
+    }
+
+    virtual void OnUpdate(float ts) override
+    {
+        if (!m_renderer || m_viewportWidth == 0 || m_viewportHeight == 0)
+            return;
+
+        if (m_viewportWidth != m_renderer->GetWidth() ||
+            m_viewportHeight != m_renderer->GetHeight())
+        {
+            m_renderer->OnResize(m_viewportWidth, m_viewportHeight);
+        }
+
+        // the inputs cover 1920x1080, stretched over the viewport
+        const glm::mat4 viewProjection = glm::ortho(0.0f, 1920.0f, 0.0f, 1080.0f);
+        const auto start = Clock::now();
+        m_renderer->BeginRenderPass();
+        auto& batch = m_renderer->BeginSprites(viewProjection);
+        FillBatch(batch, m_inputs, m_regions);
+        m_renderer->EndSprites();
+        m_renderer->EndRenderPass();
+        m_frameMs += MillisecondsSince(start);
+
+        if (++m_frameCount == FRAME_COUNT)
+        {
+            const auto& stats = m_renderer->GetSpriteStats();
+            m_lastFrameMs = m_frameMs / FRAME_COUNT;
+            std::cout << "  Renderer2D " << m_lastFrameMs << "ms to fill and submit " << stats.m_Sprites << " sprites with "
+                        << stats.m_Draws << " draw, " << stats.m_DroppedSprites << " dropped, average of " << FRAME_COUNT << " frames" << std::endl;
+            m_frameMs = 0.0f;
+            m_frameCount = 0;
+        }
+    }
+
+    virtual void OnUIRender() override
+    {
+        ImGui::Begin("Settings");
+        if (m_renderer)
+        {
+            const auto& stats = m_renderer->GetSpriteStats();
+            ImGui::Text("Fill and submit: %.3fms", m_lastFrameMs);
+            ImGui::Text("Sprites: %u, draws: %u, dropped: %u", stats.m_Sprites, stats.m_Draws, stats.m_DroppedSprites);
+        }
+        else
+        {
+            ImGui::Text("SpriteBatch does not match the vertex buffer, see the console");
+        }
+        ImGui::End();
+
+        ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0.0f, 0.0f));
+        ImGui::Begin("Viewport");
+        m_viewportWidth = ImGui::GetContentRegionAvail().x;
+        m_viewportHeight = ImGui::GetContentRegionAvail().y;
+        if (m_renderer && m_renderer->GetWidth() > 0)
+            ImGui::Image(m_renderer->GetDescriptorSet(), {(float)m_renderer->GetWidth(),(float)m_renderer->GetHeight()});
+        ImGui::End();
+        ImGui::PopStyleVar();
+    }
+
+private:
+    std::unique_ptr<RenderSys::Renderer2D> m_renderer;
+    std::vector<RenderSys::SpriteRegion> m_regions;
+    std::vector<SpriteInput> m_inputs;
+    uint32_t m_viewportWidth = 0;
+    uint32_t m_viewportHeight = 0;
+    uint32_t m_frameCount = 0;
+    float m_frameMs = 0.0f;
+    float m_lastFrameMs = 0.0f;
+};
+
+Walnut::Application* Walnut::CreateApplication(int argc, char** argv)
+{
+    Walnut::ApplicationSpecification spec;
+    spec.Name = "SpriteBatch Benchmark";
+
+    Walnut::Application* app = new Walnut::Application(spec);
+    app->PushLayer<SpriteBatchBenchmarkLayer>();
+    return app;
+}
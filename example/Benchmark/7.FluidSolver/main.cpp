@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#include <RenderSys/JobSystem.h>
+
+#include "Compute/3.Fluid2D/FluidSolver2D.h"
+
+// Measures FluidSolver2D in simulation steps per second for each linear solver, single threaded and on job systems
+// of growing size. A threaded run has to match the single threaded run of the same solver exactly, the row tiles
+// only change which thread updates a cell, not the order of the updates.
+
+static constexpr int GRID_SIZES[] = {128, 512, 2048};
+// the steps of a measurement scale down with the grid, so that every grid size takes a similar time
+static constexpr uint64_t CELL_STEPS_PER_RUN = uint64_t(1) << 26;
+static constexpr int WARMUP_STEPS = 1;
+
+// a dense blob in the center that is pushed diagonally, like the interaction of the Fluid2D example
+void SeedFluid(FluidSolver2D& solver, int size)
+{
+    const int center = size / 2;
+    const int radius = std::max(2, size / 32);
+    for (int y = -radius; y <= radius; y++)
+    {
+        for (int x = -radius; x <= radius; x++)
+        {
+            solver.FluidPlaneAddDensity(center + x, center + y, 100.0f);
+            solver.FluidPlaneAddVelocity(center + x, center + y, 0.5f, 0.25f);
+        }
+    }
+}
+
+struct RunResult
+{
+    float m_StepsPerSecond = 0.0f;
+    std::unique_ptr<FluidPlane> m_Fluid;
+};
+
+RunResult Run(int size, LinearSolver linearSolver, RenderSys::JobSystem* jobSystem)
+{
+    RunResult result;
+    result.m_Fluid = std::make_unique<FluidPlane>(size);
+    FluidSolver2D solver(*result.m_Fluid, linearSolver, jobSystem);
+    SeedFluid(solver, size);
+
+    for (int step = 0; step < WARMUP_STEPS; step++)
+    {
+        solver.FluidSolveStep();
+    }
+
+    const int steps = static_cast<int>(std::max<uint64_t>(2, CELL_STEPS_PER_RUN / (uint64_t(size) * size)));
+    const auto startTime = std::chrono::high_resolution_clock::now();
+    for (int step = 0; step < steps; step++)
+    {
+        solver.FluidSolveStep();
+    }
+    const auto endTime = std::chrono::high_resolution_clock::now();
+    result.m_StepsPerSecond = steps / std::chrono::duration<float>(endTime - startTime).count();
+    return result;
+}
+
+float MaxDifference(const FluidPlane& expected, const FluidPlane& actual)
+{
+    float maxDifference = 0.0f;
+    for (size_t i = 0; i < expected.density.size(); i++)
+    {
+        maxDifference = std::max(maxDifference, std::abs(expected.density[i] - actual.density[i]));
+        maxDifference = std::max(maxDifference, std::abs(expected.Vx[i] - actual.Vx[i]));
+        maxDifference = std::max(maxDifference, std::abs(expected.Vy[i] - actual.Vy[i]));
+    }
+    return maxDifference;
+}
+
+// returns false when a threaded run differs from the single threaded one
+bool RunBenchmark(int size)
+{
+    std::cout << size << " x " << size << " grid" << std::endl;
+    std::cout << "solver\t\t\tthreads\tsteps/s\t\tspeedup\tdifference to 1 thread" << std::endl;
+
+    const float referenceRate = Run(size, LinearSolver::GaussSeidel, nullptr).m_StepsPerSecond;
+    std::cout << "Gauss-Seidel\t\t1\t" << referenceRate << "\t\t1x" << std::endl;
+
+    bool passed = true;
+    const struct { LinearSolver m_Solver; const char* m_Name; } solvers[] = {
+        { LinearSolver::RedBlackGaussSeidel, "red-black Gauss-Seidel" },
+        { LinearSolver::Jacobi, "Jacobi\t\t" },
+    };
+    const uint32_t maxThreadCount = std::max(1u, std::thread::hardware_concurrency());
+    for (const auto& solver : solvers)
+    {
+        const RunResult serial = Run(size, solver.m_Solver, nullptr);
+        std::cout << solver.m_Name << "\t1\t" << serial.m_StepsPerSecond << "\t\t" << serial.m_StepsPerSecond / referenceRate << "x" << std::endl;
+        for (uint32_t threadCount = 2; threadCount <= maxThreadCount; threadCount *= 2)
+        {
+            RenderSys::JobSystem jobSystem(threadCount - 1);
+            const RunResult threaded = Run(size, solver.m_Solver, &jobSystem);
+            const float difference = MaxDifference(*serial.m_Fluid, *threaded.m_Fluid);
+            std::cout << solver.m_Name << "\t" << threadCount << "\t" << threaded.m_StepsPerSecond << "\t\t" 
+                        << threaded.m_StepsPerSecond / referenceRate << "x\t" << difference << std::endl;
+            passed = passed && difference == 0.0f;
+        }
+    }
+
+    if (!passed)
+    {
+        std::cout << "Threaded steps differ from the single threaded steps of the same solver" << std::endl;
+    }
+    return passed;
+}
+
+int main()
+{
+#if defined(__AVX2__)
+    const char* instructionSet = "AVX2";
+#else
+    const char* instructionSet = "scalar";
+#endif
+    std::cout << "FluidSolver2D benchmark: " << instructionSet << " row kernels, up to " << std::thread::hardware_concurrency() << " threads" << std::endl;
+
+    bool passed = true;
+    for (const int size : GRID_SIZES)
+    {
+        passed = RunBenchmark(size) && passed;
+    }
+    return passed ? 0 : 1;
+}
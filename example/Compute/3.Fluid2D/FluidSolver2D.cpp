@@ -1,9 +1,20 @@
 #include "FluidSolver2D.h"
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+
+#include <RenderSys/JobSystem.h>
+
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#include <immintrin.h>
+#define FLUID_SOLVER_AVX2
+#endif
 
 #define IX(x, y) ((x) + (y) * N)
 
 constexpr uint32_t linearSolveIterations = 4;
+// a row tile of the job system covers about this many cells, small grids stay on one thread
+constexpr int cellsPerTile = 16384;
 
 // Check of Nan propagation
 // if(std::isnan(x[IX(0, 0)]))
@@ -49,35 +60,148 @@ static void lin_solve_gauss_seidel(int boundaryCondition, std::vector<float>& x,
     }
 }
 
-static void lin_solve_jacobi_iteration(int boundaryCondition, std::vector<float>& x, std::vector<float>& x0, float a, float c, int N)
+// One Jacobi sweep over the inner cells of row y, reads x and writes out
+static void jacobi_row(float* out, const float* x, const float* x0, float a, float cRecip, int y, int N)
 {
-    float cRecip = 1.0 / c;
-    std::vector<float> x_new(x.size(), 0.0f); // Create a new vector to store updated values
-    
-    for (int k = 0; k < linearSolveIterations; k++) {
-        for (int i = 1; i < N - 1; i++) {
-            for (int j = 1; j < N - 1; j++) {
-                x_new[IX(i, j)] =
-                    (x0[IX(i, j)]
-                        + a*(    x[IX(i+1, j  )]
-                                + x[IX(i-1, j  )]
-                                + x[IX(i  , j+1)]
-                                + x[IX(i  , j-1)]
-                        )) * cRecip;
-            }
-        }
-        
-        // Update the x vector after each iteration
-        x = x_new;
-        
-        set_bnd(boundaryCondition, x, N);
+    const int row = y * N;
+    int i = 1;
+#if defined(FLUID_SOLVER_AVX2)
+    const __m256 aVec = _mm256_set1_ps(a);
+    const __m256 cRecipVec = _mm256_set1_ps(cRecip);
+    for (; i + 8 <= N - 1; i += 8) {
+        const float* center = x + row + i;
+        const __m256 neighbours = _mm256_add_ps(_mm256_add_ps(_mm256_loadu_ps(center + 1), _mm256_loadu_ps(center - 1)),
+                                                _mm256_add_ps(_mm256_loadu_ps(center + N), _mm256_loadu_ps(center - N)));
+        _mm256_storeu_ps(out + row + i, _mm256_mul_ps(_mm256_fmadd_ps(aVec, neighbours, _mm256_loadu_ps(x0 + row + i)), cRecipVec));
+    }
+#endif
+    for (; i < N - 1; i++) {
+        const int index = row + i;
+        out[index] = (x0[index] + a * ((x[index + 1] + x[index - 1]) + (x[index + N] + x[index - N]))) * cRecip;
+    }
+}
+
+#if defined(FLUID_SOLVER_AVX2)
+// the cells at even or odd offsets of the 16 floats at p, in the lane order of _mm256_shuffle_ps: 0 2 8 10 4 6 12 14
+static inline __m256 load_even(const float* p)
+{
+    return _mm256_shuffle_ps(_mm256_loadu_ps(p), _mm256_loadu_ps(p + 8), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+static inline __m256 load_odd(const float* p)
+{
+    return _mm256_shuffle_ps(_mm256_loadu_ps(p), _mm256_loadu_ps(p + 8), _MM_SHUFFLE(3, 1, 3, 1));
+}
+#endif
+
+// Updates the inner cells of row y with (x + y) % 2 == color in place. Their neighbours all have the other color,
+// so the rows of one color can be updated in any order. The vectorized loop reads and writes whole runs of 16
+// cells of both colors, so neighbouring rows must not be updated at the same time on another thread
+static void red_black_row(float* x, const float* x0, float a, float cRecip, int y, int N, int color)
+{
+    const int row = y * N;
+    // the first inner cell of the color
+    int i = 1 + ((1 + y + color) & 1);
+#if defined(FLUID_SOLVER_AVX2)
+    // 8 cells of the color out of 16, deinterleaved so that no lane is spent on the other color
+    const __m256 aVec = _mm256_set1_ps(a);
+    const __m256 cRecipVec = _mm256_set1_ps(cRecip);
+    for (; i + 16 <= N; i += 16) {
+        float* center = x + row + i;
+        const __m256 neighbours = _mm256_add_ps(_mm256_add_ps(load_even(center + 1), load_even(center - 1)),
+                                                _mm256_add_ps(load_even(center + N), load_even(center - N)));
+        const __m256 result = _mm256_mul_ps(_mm256_fmadd_ps(aVec, neighbours, load_even(x0 + row + i)), cRecipVec);
+        // interleaved with the unchanged cells of the other color, back to offsets 0..7 and 8..15
+        const __m256 otherColor = load_odd(center);
+        _mm256_storeu_ps(center, _mm256_unpacklo_ps(result, otherColor));
+        _mm256_storeu_ps(center + 8, _mm256_unpackhi_ps(result, otherColor));
+    }
+#endif
+    for (; i < N - 1; i += 2) {
+        const int index = row + i;
+        x[index] = (x0[index] + a * ((x[index + 1] + x[index - 1]) + (x[index + N] + x[index - N]))) * cRecip;
     }
 }
 
-FluidSolver2D::FluidSolver2D(FluidPlane& fluid)
+FluidSolver2D::FluidSolver2D(FluidPlane& fluid, LinearSolver linearSolver, RenderSys::JobSystem* jobSystem)
     : m_fluid(fluid)
+    , m_linearSolver(linearSolver)
+    , m_jobSystem(jobSystem)
 {}
 
+template<typename RowJob>
+void FluidSolver2D::ForEachRowTile(const RowJob& rowJob, int tileParity)
+{
+    const int N = m_fluid.size;
+    const int rowCount = N - 2;
+    if (!m_jobSystem) {
+        // a single tile
+        if (tileParity <= 0) {
+            rowJob(1, N - 1);
+        }
+        return;
+    }
+    const int tileRows = std::max(1, cellsPerTile / N);
+    if (tileParity < 0) {
+        m_jobSystem->ParallelFor(rowCount, tileRows, [&rowJob](uint32_t rowBegin, uint32_t rowEnd) {
+            rowJob(int(rowBegin) + 1, int(rowEnd) + 1);
+        });
+        return;
+    }
+    const int tileCount = (rowCount + tileRows - 1) / tileRows;
+    const int parityTileCount = (tileCount - tileParity + 1) / 2;
+    m_jobSystem->ParallelFor(parityTileCount, 1, [&rowJob, tileRows, tileParity, rowCount](uint32_t begin, uint32_t end) {
+        for (uint32_t parityTile = begin; parityTile < end; parityTile++) {
+            const int rowBegin = (2 * int(parityTile) + tileParity) * tileRows;
+            rowJob(rowBegin + 1, std::min(rowBegin + tileRows, rowCount) + 1);
+        }
+    });
+}
+
+void FluidSolver2D::LinearSolve(int b, std::vector<float>& x, std::vector<float>& x0, float a, float c)
+{
+    const int N = m_fluid.size;
+    const float cRecip = 1.0f / c;
+    switch (m_linearSolver) {
+    case LinearSolver::GaussSeidel:
+        lin_solve_gauss_seidel(b, x, x0, a, c, N);
+        break;
+    case LinearSolver::RedBlackGaussSeidel:
+        for (uint32_t k = 0; k < linearSolveIterations; k++) {
+            for (int color = 0; color < 2; color++) {
+                float* xData = x.data();
+                const float* x0Data = x0.data();
+                // the even tiles, then the odd ones, so that no two neighbouring rows are updated at once
+                for (int tileParity = 0; tileParity < 2; tileParity++) {
+                    ForEachRowTile([=](int rowBegin, int rowEnd) {
+                        for (int y = rowBegin; y < rowEnd; y++) {
+                            red_black_row(xData, x0Data, a, cRecip, y, N, color);
+                        }
+                    }, tileParity);
+                }
+            }
+            set_bnd(b, x, N);
+        }
+        break;
+    case LinearSolver::Jacobi:
+        m_scratch.resize(x.size());
+        for (uint32_t k = 0; k < linearSolveIterations; k++) {
+            float* outData = m_scratch.data();
+            const float* xData = x.data();
+            const float* x0Data = x0.data();
+            ForEachRowTile([=](int rowBegin, int rowEnd) {
+                for (int y = rowBegin; y < rowEnd; y++) {
+                    jacobi_row(outData, xData, x0Data, a, cRecip, y, N);
+                }
+            });
+            // ping-pong, the boundary of the new plane is rewritten by set_bnd
+            x.swap(m_scratch);
+            set_bnd(b, x, N);
+        }
+        break;
+    }
+}
+
 void FluidSolver2D::FluidSolveStep()
 {
     const float dt = 0.01f;
@@ -130,41 +254,48 @@ void FluidSolver2D::Advect(int b, std::vector<float> &d, std::vector<float> &d0,
 {
     const int N = m_fluid.size;    
     const float dt0 = dt * N;
-    const float Nfloat = N;    
+    // the inner cells, so that the bilinear footprint i0..i1 of a clamped position stays on the grid
+    const float Nfloat = N - 2;
+    float* dData = d.data();
+    const float* d0Data = d0.data();
+    const float* velocXData = velocX.data();
+    const float* velocYData = velocY.data();
 
-    for(int i = 1; i < N - 1; i++) {
-        for(int j = 1; j < N - 1; j++) { 
-            float x = float(i) - (dt0 * velocX[IX(i, j)]); 
-            float y = float(j) - (dt0 * velocY[IX(i, j)]);
-            
-            if(x < 0.5f) 
-                x = 0.5f; 
-            if(x > Nfloat + 0.5f) 
-                x = Nfloat + 0.5f; 
-            if(y < 0.5f) 
-                y = 0.5f; 
-            if(y > Nfloat + 0.5f) 
-                y = Nfloat + 0.5f; 
-            
-            float i0 = floorf(x); 
-            float i1 = i0 + 1.0f;  
-            float j0 = floorf(y);
-            float j1 = j0 + 1.0f; 
-            
-            float s1 = x - i0; 
-            float s0 = 1.0f - s1; 
-            float t1 = y - j0; 
-            float t0 = 1.0f - t1;
-            
-            int i0i = i0;
-            int i1i = i1;
-            int j0i = j0;
-            int j1i = j1;
-            
-            d[IX(i, j)] =   s0 * ( t0 * d0[IX(i0i, j0i)]  +  t1 * d0[IX(i0i, j1i)])
-                          + s1 * ( t0 * d0[IX(i1i, j0i)]  +  t1 * d0[IX(i1i, j1i)]);
+    ForEachRowTile([=](int rowBegin, int rowEnd) {
+        for(int j = rowBegin; j < rowEnd; j++) {
+            for(int i = 1; i < N - 1; i++) { 
+                float x = float(i) - (dt0 * velocXData[IX(i, j)]); 
+                float y = float(j) - (dt0 * velocYData[IX(i, j)]);
+                
+                if(x < 0.5f) 
+                    x = 0.5f; 
+                if(x > Nfloat + 0.5f) 
+                    x = Nfloat + 0.5f; 
+                if(y < 0.5f) 
+                    y = 0.5f; 
+                if(y > Nfloat + 0.5f) 
+                    y = Nfloat + 0.5f; 
+                
+                float i0 = floorf(x); 
+                float i1 = i0 + 1.0f;  
+                float j0 = floorf(y);
+                float j1 = j0 + 1.0f; 
+                
+                float s1 = x - i0; 
+                float s0 = 1.0f - s1; 
+                float t1 = y - j0; 
+                float t0 = 1.0f - t1;
+                
+                int i0i = i0;
+                int i1i = i1;
+                int j0i = j0;
+                int j1i = j1;
+                
+                dData[IX(i, j)] =   s0 * ( t0 * d0Data[IX(i0i, j0i)]  +  t1 * d0Data[IX(i0i, j1i)])
+                                  + s1 * ( t0 * d0Data[IX(i1i, j0i)]  +  t1 * d0Data[IX(i1i, j1i)]);
+            }
         }
-    }
+    });
     set_bnd(b, d, N);
 }
 
@@ -172,36 +303,48 @@ void FluidSolver2D::Diffuse(int b, std::vector<float>& x, std::vector<float>& x0
 {
     const int N = m_fluid.size;
     float a = dt * diff * (N - 2) * (N - 2);
-    lin_solve_gauss_seidel(b, x, x0, a, 1 + 4 * a, N);
+    LinearSolve(b, x, x0, a, 1 + 4 * a);
 }
 
 void FluidSolver2D::Project(std::vector<float>& velocX, std::vector<float>& velocY, std::vector<float>& p, std::vector<float>& div)
 {
     const int N = m_fluid.size;
     float h = 1.0/N;
-    for (int i = 1; i < N - 1; i++) {
-        for (int j = 1; j < N - 1; j++) {
-            div[IX(i, j)] = -0.5f * h *(
-                     velocX[IX(i+1, j  )]
-                    -velocX[IX(i-1, j  )]
-                    +velocY[IX(i  , j+1)]
-                    -velocY[IX(i  , j-1)]
-                );
-            p[IX(i, j)] = 0;
+    float* velocXData = velocX.data();
+    float* velocYData = velocY.data();
+    float* pData = p.data();
+    float* divData = div.data();
+
+    // rows outside, IX(i, j) is contiguous along i
+    ForEachRowTile([=](int rowBegin, int rowEnd) {
+        for (int j = rowBegin; j < rowEnd; j++) {
+            for (int i = 1; i < N - 1; i++) {
+                divData[IX(i, j)] = -0.5f * h *(
+                         velocXData[IX(i+1, j  )]
+                        -velocXData[IX(i-1, j  )]
+                        +velocYData[IX(i  , j+1)]
+                        -velocYData[IX(i  , j-1)]
+                    );
+                pData[IX(i, j)] = 0;
+            }
         }
-    }
+    });
     set_bnd(0, div, N); 
     set_bnd(0, p, N);
-    lin_solve_gauss_seidel(0, p, div, 1, 4, N);
+    LinearSolve(0, p, div, 1, 4);
+    // the Jacobi solver swaps the plane of p
+    pData = p.data();
     
-    for (int i = 1; i < N - 1; i++) {
-        for (int j = 1; j < N - 1; j++) {
-            velocX[IX(i, j)] -= 0.5f * (  p[IX(i+1, j)]
-                                         -p[IX(i-1, j)]) * N;
-            velocY[IX(i, j)] -= 0.5f * (  p[IX(i, j+1)]
-                                         -p[IX(i, j-1)]) * N;
+    ForEachRowTile([=](int rowBegin, int rowEnd) {
+        for (int j = rowBegin; j < rowEnd; j++) {
+            for (int i = 1; i < N - 1; i++) {
+                velocXData[IX(i, j)] -= 0.5f * (  pData[IX(i+1, j)]
+                                                 -pData[IX(i-1, j)]) * N;
+                velocYData[IX(i, j)] -= 0.5f * (  pData[IX(i, j+1)]
+                                                 -pData[IX(i, j-1)]) * N;
+            }
         }
-    }
+    });
     set_bnd(1, velocX, N);
     set_bnd(2, velocY, N);
 }
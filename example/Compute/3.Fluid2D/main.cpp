@@ -4,6 +4,7 @@
 #include <Walnut/Timer.h>
 #include <Walnut/Image.h>
 #include <RenderSys/Renderer2D.h>
+#include <RenderSys/JobSystem.h>
 #include <imgui.h>
 
 #include "FluidSolver2D.h"
@@ -99,7 +100,7 @@ public:
 
 		m_finalImage = std::make_shared<Walnut::Image>(1, 1, Walnut::ImageFormat::RGBA);
 		m_fluid = std::make_unique<FluidPlane>(simulationDimension);
-		m_solver = std::make_unique<FluidSolver2D>(*m_fluid);
+		m_solver = std::make_unique<FluidSolver2D>(*m_fluid, LinearSolver::RedBlackGaussSeidel, &RenderSys::JobSystem::Get());
 	}
 
 	virtual void OnDetach() override
@@ -300,6 +301,12 @@ public:
 
 
 		ImGui::Checkbox("HW", &m_hWSolver);
+		const char* linearSolvers[] = { "Gauss-Seidel", "Red-black Gauss-Seidel", "Jacobi" };
+		int linearSolver = static_cast<int>(m_solver->GetLinearSolver());
+		if (ImGui::Combo("Linear solver", &linearSolver, linearSolvers, IM_ARRAYSIZE(linearSolvers)))
+		{
+			m_solver->SetLinearSolver(static_cast<LinearSolver>(linearSolver));
+		}
 
 		ImGui::End();
 
@@ -0,0 +1,378 @@
+#include "Walnut/Application.h"
+#include "Walnut/EntryPoint.h"
+#include <Walnut/Timer.h>
+#include <Walnut/Image.h>
+
+#include <RenderSys/GpuFluidSolver.h>
+#include <RenderSys/HeadlessDevice.h>
+#include <imgui.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../3.Fluid2D/FluidSolver2D.h"
+
+// the largest error of the GPU fields against the CPU reference, relative to the largest CPU value
+constexpr float g_validationTolerance = 1e-3f;
+
+struct FluidGpuSettings
+{
+	uint32_t size = 256;
+	bool is3D = false;
+	// steps of a --validate run on a headless device, 0 opens the viewer
+	uint32_t validationSteps = 0;
+	std::string icdFile;
+	RenderSys::HeadlessDeviceSpecification device;
+	// the GPU profile of the steps as a Chrome trace, written at the end of a --validate run
+	std::string traceFile;
+};
+
+static FluidGpuSettings s_settings;
+
+class FluidGpuLayer : public Walnut::Layer
+{
+public:
+	virtual void OnAttach() override
+	{
+		Reset();
+	}
+
+	virtual void OnDetach() override
+	{
+		m_gpuSolver.reset();
+		m_cpuSolver.reset();
+		m_cpuFluid.reset();
+		m_image.reset();
+	}
+
+	// without the layer being attached, on the headless device. Returns false when the error is above the tolerance
+	bool RunValidation()
+	{
+		Reset();
+		for (uint32_t step = 0; step < s_settings.validationSteps; ++step)
+		{
+			StepSolvers();
+		}
+		const float error = Validate();
+		bool passed = error <= g_validationTolerance;
+		std::cout << "FluidGpu " << m_gpuSolver->GetSize() << (s_settings.is3D ? "^3" : "^2") << ", " << s_settings.validationSteps
+					<< " steps against FluidSolver2D with RedBlackGaussSeidel, max relative error " << error
+					<< " (tolerance " << g_validationTolerance << "): " << (passed ? "PASSED" : "FAILED") << std::endl;
+		auto* profiler = m_gpuSolver->GetGpuProfiler();
+		if (!s_settings.traceFile.empty() && profiler)
+		{
+			if (profiler->WriteChromeTrace(s_settings.traceFile))
+			{
+				std::cout << "Chrome trace of " << profiler->GetFrames().size() << " steps written to " << s_settings.traceFile << std::endl;
+			}
+			else
+			{
+				std::cout << "error: could not write " << s_settings.traceFile << std::endl;
+				passed = false;
+			}
+		}
+		OnDetach();
+		return passed;
+	}
+
+	virtual void OnUpdate(float ts) override
+	{
+		if (!m_running)
+			return;
+
+		// the density of this step is copied back while the next one runs, the preview shows the step before
+		if (m_preview)
+			m_gpuSolver->RequestReadback(RenderSys::GpuFluidSolver::Field::Density);
+		const RenderSys::ComputeTicket previewTicket = m_previewTicket;
+		StepSolvers();
+		m_previewTicket = m_preview ? m_ticket : 0;
+		if (previewTicket != 0)
+		{
+			Walnut::Timer timer;
+			UpdatePreview(previewTicket);
+			m_lastReadbackTime = timer.ElapsedMillis();
+		}
+	}
+
+	virtual void OnUIRender() override
+	{
+		ImGui::Begin("Settings");
+		ImGui::Text("Grid: %u%s, %u dispatches per step", m_gpuSolver->GetSize(), s_settings.is3D ? "^3" : "^2", m_gpuSolver->GetDispatchCount());
+		ImGui::Text("GPU step (record and submit): %.3fms", m_lastGpuStepTime);
+		ImGui::Text("CPU step: %.3fms", m_lastCpuStepTime);
+		ImGui::Text("Density readback (one step late): %.3fms", m_lastReadbackTime);
+		ImGui::Text("Steps: %u", m_frame);
+
+		ImGui::Checkbox("Run", &m_running);
+		ImGui::Checkbox("Preview density", &m_preview);
+		if (!s_settings.is3D)
+		{
+			ImGui::Checkbox("Run CPU reference", &m_runCpuReference);
+		}
+		if (ImGui::Checkbox("3D", &s_settings.is3D))
+		{
+			s_settings.size = s_settings.is3D ? 64 : 256;
+			Reset();
+		}
+		if (ImGui::Button("Reset"))
+		{
+			Reset();
+		}
+		if (m_cpuSolver && m_runCpuReference && ImGui::Button("Validate"))
+		{
+			m_lastError = Validate();
+		}
+		if (m_lastError >= 0.0f)
+		{
+			ImGui::Text("Relative error: %g (%s)", m_lastError, m_lastError <= g_validationTolerance ? "passed" : "failed");
+		}
+		ImGui::End();
+
+		if (auto* profiler = m_gpuSolver->GetGpuProfiler())
+		{
+			profiler->OnImGuiRender();
+		}
+
+		ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0.0f, 0.0f));
+		ImGui::Begin("Viewport");
+		if (m_preview && m_image)
+		{
+			const float viewSize = std::min(ImGui::GetContentRegionAvail().x, ImGui::GetContentRegionAvail().y);
+			ImGui::Image((void*)m_image->GetDescriptorSet(), { viewSize, viewSize });
+		}
+		ImGui::End();
+		ImGui::PopStyleVar();
+	}
+
+private:
+	void Reset()
+	{
+		const uint32_t size = s_settings.size;
+		m_gpuSolver = std::make_unique<RenderSys::GpuFluidSolver>(size, s_settings.is3D ? size : 1);
+		// the CPU solver is 2D only, serial and with the same linear solver
+		m_cpuSolver.reset();
+		m_cpuFluid.reset();
+		if (!s_settings.is3D)
+		{
+			m_cpuFluid = std::make_unique<FluidPlane>(size);
+			m_cpuSolver = std::make_unique<FluidSolver2D>(*m_cpuFluid, LinearSolver::RedBlackGaussSeidel);
+		}
+		// the preview needs the device of the application, there is no image on the headless device
+		m_image = s_settings.validationSteps == 0 ? std::make_shared<Walnut::Image>(size, size, Walnut::ImageFormat::RGBA) : nullptr;
+		m_pixels.assign(size * size, 0);
+		m_frame = 0;
+		m_ticket = 0;
+		m_previewTicket = 0;
+		m_lastError = -1.0f;
+	}
+
+	// the same deterministic sources for both solvers, a density splat in the center and a turning jet
+	void StepSolvers()
+	{
+		const uint32_t size = m_gpuSolver->GetSize();
+		const uint32_t center = size / 2;
+		const uint32_t centerZ = s_settings.is3D ? size / 2 : 0;
+		const bool runCpu = m_cpuSolver && m_runCpuReference;
+		for (int i = -1; i <= 1; i++)
+		{
+			for (int j = -1; j <= 1; j++)
+			{
+				const float amount = float((m_frame * 37 + (i + 1) * 3 + (j + 1)) % 500) + 100.0f;
+				m_gpuSolver->AddDensity(center + i, center + j, centerZ, amount);
+				if (runCpu)
+					m_cpuSolver->FluidPlaneAddDensity(center + i, center + j, amount);
+			}
+		}
+
+		const float angle = 0.02f * m_frame;
+		const float velocityX = 20.0f * std::cos(angle);
+		const float velocityY = 20.0f * std::sin(angle);
+		for (int i = 0; i < 2; i++)
+		{
+			m_gpuSolver->AddVelocity(center, center, centerZ, velocityX, velocityY, s_settings.is3D ? 5.0f : 0.0f);
+			if (runCpu)
+				m_cpuSolver->FluidPlaneAddVelocity(center, center, velocityX, velocityY);
+		}
+
+		Walnut::Timer gpuTimer;
+		m_ticket = m_gpuSolver->Step();
+		m_lastGpuStepTime = gpuTimer.ElapsedMillis();
+
+		if (runCpu)
+		{
+			Walnut::Timer cpuTimer;
+			m_cpuSolver->FluidSolveStep();
+			m_lastCpuStepTime = cpuTimer.ElapsedMillis();
+		}
+		m_frame++;
+	}
+
+	// reads the density and the velocity back and returns the largest relative error against the CPU solver
+	float Validate()
+	{
+		if (!m_cpuSolver)
+		{
+			std::cout << "the CPU reference is 2D only, nothing to validate" << std::endl;
+			return 0.0f;
+		}
+		const std::tuple<RenderSys::GpuFluidSolver::Field, const char*, const std::vector<float>*> fields[] = {
+			{ RenderSys::GpuFluidSolver::Field::Density, "density", &m_cpuFluid->density },
+			{ RenderSys::GpuFluidSolver::Field::VelocityX, "velocity x", &m_cpuFluid->Vx },
+			{ RenderSys::GpuFluidSolver::Field::VelocityY, "velocity y", &m_cpuFluid->Vy },
+		};
+		float maxError = 0.0f;
+		std::vector<float> gpuValues;
+		for (const auto& [field, fieldName, cpuValues] : fields)
+		{
+			m_gpuSolver->ReadField(field, gpuValues);
+			float fieldError = 0.0f;
+			float fieldMax = 0.0f;
+			for (size_t i = 0; i < gpuValues.size(); ++i)
+			{
+				fieldError = std::max(fieldError, std::abs(gpuValues[i] - (*cpuValues)[i]));
+				fieldMax = std::max(fieldMax, std::abs((*cpuValues)[i]));
+			}
+			maxError = std::max(maxError, fieldError / std::max(fieldMax, 1.0f));
+			std::cout << "  " << fieldName << ": max absolute error " << fieldError << ", largest CPU value " << fieldMax
+						<< ", relative error " << fieldError / std::max(fieldMax, 1.0f) << std::endl;
+		}
+		return maxError;
+	}
+
+	// the middle slice of a 3D grid, the readback of the step before has usually completed by now
+	void UpdatePreview(const RenderSys::ComputeTicket ticket)
+	{
+		const float* density = m_gpuSolver->GetReadback(ticket);
+		if (!density || !m_image)
+			return;
+		const uint32_t size = m_gpuSolver->GetSize();
+		const size_t slice = s_settings.is3D ? size_t(size / 2) * size * size : 0;
+		float maxDensity = 1.0f;
+		for (size_t i = 0; i < m_pixels.size(); ++i)
+		{
+			maxDensity = std::max(maxDensity, density[slice + i]);
+		}
+		for (size_t i = 0; i < m_pixels.size(); ++i)
+		{
+			const uint8_t value = static_cast<uint8_t>(255.0f * std::sqrt(std::max(density[slice + i], 0.0f) / maxDensity));
+			constexpr uint32_t alpha = 255;
+			m_pixels[i] = (alpha << 24) | (value << 16) | (value << 8) | value;
+		}
+		m_image->SetData(m_pixels.data());
+	}
+
+	std::unique_ptr<RenderSys::GpuFluidSolver> m_gpuSolver;
+	std::unique_ptr<FluidPlane> m_cpuFluid;
+	std::unique_ptr<FluidSolver2D> m_cpuSolver;
+	std::shared_ptr<Walnut::Image> m_image;
+	std::vector<uint32_t> m_pixels;
+
+	uint32_t m_frame = 0;
+	// of the last step, 0 before the first
+	RenderSys::ComputeTicket m_ticket = 0;
+	// of the last step with a density readback
+	RenderSys::ComputeTicket m_previewTicket = 0;
+	bool m_running = true;
+	bool m_preview = true;
+	bool m_runCpuReference = true;
+	float m_lastGpuStepTime = 0.0f;
+	float m_lastCpuStepTime = 0.0f;
+	float m_lastReadbackTime = 0.0f;
+	float m_lastError = -1.0f;
+};
+
+static void setEnvironmentVariable(const char* name, const std::string& value)
+{
+#ifdef _WIN32
+	_putenv_s(name, value.c_str());
+#else
+	setenv(name, value.c_str(), 1);
+#endif
+}
+
+static bool parseArguments(int argc, char** argv)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string argument = argv[i];
+		if (i + 1 >= argc)
+		{
+			std::cout << "error: " << argument << " needs a value" << std::endl;
+			return false;
+		}
+		const std::string value = argv[++i];
+		if (argument == "--validate")
+			s_settings.validationSteps = static_cast<uint32_t>(std::max(std::atoi(value.c_str()), 1));
+		else if (argument == "--size")
+			s_settings.size = static_cast<uint32_t>(std::max(std::atoi(value.c_str()), 3));
+		else if (argument == "--grid")
+			s_settings.is3D = value == "3d";
+		else if (argument == "--icd")
+			s_settings.icdFile = value;
+		else if (argument == "--trace")
+			s_settings.traceFile = value;
+		else if (argument == "--validation")
+		{
+			s_settings.device.m_Validation = value != "off";
+			s_settings.device.m_SynchronizationValidation = value == "sync";
+		}
+		else
+		{
+			std::cout << "error: unknown argument " << argument << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+Walnut::Application* Walnut::CreateApplication(int argc, char** argv)
+{
+	if (!parseArguments(argc, argv))
+	{
+		std::cout << "usage: FluidGpu [--validate steps] [--size n] [--grid 2d|3d] [--icd file] [--validation off|on|sync] [--trace file]" << std::endl;
+	}
+
+	// e.g. the lavapipe ICD, the loader picks the driver when the application creates the Vulkan instance
+	if (!s_settings.icdFile.empty())
+	{
+		setEnvironmentVariable("VK_DRIVER_FILES", s_settings.icdFile);
+		setEnvironmentVariable("VK_ICD_FILENAMES", s_settings.icdFile);
+	}
+
+	// no window, no surface: a --validate run creates its own device, e.g. on lavapipe in CI. Walnut's entry point
+	// always returns 0 and has no way to skip the application, so the run exits from here with its result
+	if (s_settings.validationSteps > 0)
+	{
+		s_settings.device.m_ApplicationName = "GPU Fluid Solver";
+		if (!RenderSys::CreateHeadlessDevice(s_settings.device))
+		{
+			std::exit(EXIT_FAILURE);
+		}
+		bool passed = false;
+		{
+			FluidGpuLayer layer;
+			passed = layer.RunValidation();
+		}
+		RenderSys::DestroyHeadlessDevice();
+		if (s_settings.device.m_Validation)
+		{
+			std::cout << "Validation: " << RenderSys::GetValidationErrorCount() << " errors, "
+						<< RenderSys::GetValidationWarningCount() << " warnings" << std::endl;
+			passed = passed && RenderSys::GetValidationErrorCount() == 0;
+		}
+		std::exit(passed ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	Walnut::ApplicationSpecification spec;
+	spec.Name = "GPU Fluid Solver";
+
+	Walnut::Application* app = new Walnut::Application(spec);
+	app->PushLayer<FluidGpuLayer>();
+	return app;
+}
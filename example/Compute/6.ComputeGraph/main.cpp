@@ -0,0 +1,367 @@
+#include "Walnut/Application.h"
+#include "Walnut/EntryPoint.h"
+#include "Walnut/Random.h"
+#include <Walnut/Timer.h>
+#include <Walnut/Image.h>
+
+#include <RenderSys/ComputeGraph.h>
+#include <RenderSys/HeadlessDevice.h>
+#include <RenderSys/Shader.h>
+#include <imgui.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+constexpr uint32_t g_particleCount = 1 << 18;
+constexpr uint32_t g_trailSize = 512;
+constexpr uint32_t g_particleWorkgroupSize = 64;
+constexpr uint32_t g_trailWorkgroupSize = 8;
+
+// the push constants of every kernel
+struct Parameters
+{
+	float attractor[2];
+	float dt;
+	uint32_t particleCount;
+	uint32_t trailSize;
+};
+static_assert(sizeof(Parameters) == 20);
+
+struct ComputeGraphSettings
+{
+	// frames of a run on a headless device, 0 opens the viewer
+	uint32_t frameCount = 0;
+	std::string icdFile;
+	RenderSys::HeadlessDeviceSpecification device;
+};
+
+static ComputeGraphSettings s_settings;
+
+// the bindings in the order of ComputeGraph::AddBuffer()
+static const char* s_kernelHeader = R"(
+#version 460
+
+layout(std430, binding = 0) buffer Positions { vec4 positions[]; };
+layout(std430, binding = 1) buffer Velocities { vec4 velocities[]; };
+layout(std430, binding = 2) buffer Trail { uint trail[]; };
+
+layout(push_constant) uniform Parameters
+{
+	vec2 attractor;
+	float dt;
+	uint particleCount;
+	uint trailSize;
+} params;
+)";
+
+static const char* s_forcesKernel = R"(
+layout(local_size_x = 64) in;
+
+void main()
+{
+	const uint id = gl_GlobalInvocationID.x;
+	if (id >= params.particleCount)
+		return;
+	const vec2 toAttractor = params.attractor - positions[id].xy;
+	vec2 velocity = velocities[id].xy + params.dt * toAttractor / (dot(toAttractor, toAttractor) + 0.05);
+	velocity *= 1.0 - 0.5 * params.dt;
+	velocities[id] = vec4(velocity, 0.0, 0.0);
+}
+)";
+
+static const char* s_integrateKernel = R"(
+layout(local_size_x = 64) in;
+
+void main()
+{
+	const uint id = gl_GlobalInvocationID.x;
+	if (id >= params.particleCount)
+		return;
+	// wraps around the edges of [-1, 1]
+	const vec2 position = positions[id].xy + params.dt * velocities[id].xy;
+	positions[id] = vec4(mod(position + 1.0, 2.0) - 1.0, 0.0, 1.0);
+}
+)";
+
+static const char* s_decayKernel = R"(
+layout(local_size_x = 8, local_size_y = 8) in;
+
+void main()
+{
+	const uvec2 cell = gl_GlobalInvocationID.xy;
+	if (cell.x >= params.trailSize || cell.y >= params.trailSize)
+		return;
+	const uint index = cell.x + cell.y * params.trailSize;
+	trail[index] = trail[index] * 15u / 16u;
+}
+)";
+
+static const char* s_splatKernel = R"(
+layout(local_size_x = 64) in;
+
+void main()
+{
+	const uint id = gl_GlobalInvocationID.x;
+	if (id >= params.particleCount)
+		return;
+	const ivec2 cell = clamp(ivec2((positions[id].xy * 0.5 + 0.5) * float(params.trailSize)), ivec2(0), ivec2(params.trailSize - 1));
+	atomicAdd(trail[cell.x + cell.y * params.trailSize], 16u);
+}
+)";
+
+class ComputeGraphLayer : public Walnut::Layer
+{
+public:
+	virtual void OnAttach() override
+	{
+		m_graph = std::make_unique<RenderSys::ComputeGraph>();
+		m_graph->AddBuffer("positions", g_particleCount * 4 * sizeof(float));
+		m_graph->AddBuffer("velocities", g_particleCount * 4 * sizeof(float));
+		m_graph->AddBuffer("trail", g_trailSize * g_trailSize * sizeof(uint32_t));
+
+		m_forces = m_graph->AddKernel(*CreateShader("Forces", s_forcesKernel), {"positions"}, {"velocities"});
+		m_integrate = m_graph->AddKernel(*CreateShader("Integrate", s_integrateKernel), {"velocities"}, {"positions"});
+		// depends on none of the particle kernels, so it runs without a barrier after them
+		m_decay = m_graph->AddKernel(*CreateShader("Decay", s_decayKernel), {}, {"trail"});
+		m_splat = m_graph->AddKernel(*CreateShader("Splat", s_splatKernel), {"positions"}, {"trail"});
+		m_graph->Build();
+
+		// the only upload, everything after it stays on the GPU
+		std::vector<float> positions(g_particleCount * 4);
+		for (uint32_t i = 0; i < g_particleCount; ++i)
+		{
+			positions[i * 4 + 0] = Walnut::Random::Float() * 2.0f - 1.0f;
+			positions[i * 4 + 1] = Walnut::Random::Float() * 2.0f - 1.0f;
+			positions[i * 4 + 2] = 0.0f;
+			positions[i * 4 + 3] = 1.0f;
+		}
+		m_graph->Write("positions", positions.data(), 0, static_cast<uint32_t>(positions.size() * sizeof(float)));
+
+		// the preview needs the device of the application, the headless run only reads the trail back
+		if (s_settings.frameCount == 0)
+			m_image = std::make_shared<Walnut::Image>(g_trailSize, g_trailSize, Walnut::ImageFormat::RGBA);
+		m_pixels.resize(g_trailSize * g_trailSize);
+	}
+
+	virtual void OnDetach() override
+	{
+		m_graph.reset();
+	}
+
+	virtual void OnUpdate(float ts) override
+	{
+		Walnut::Timer timer;
+
+		m_time += ts;
+		Parameters params{};
+		params.attractor[0] = 0.6f * std::cos(m_time);
+		params.attractor[1] = 0.6f * std::sin(1.3f * m_time);
+		params.dt = 0.004f;
+		params.particleCount = g_particleCount;
+		params.trailSize = g_trailSize;
+
+		const uint32_t particleGroups = (g_particleCount + g_particleWorkgroupSize - 1) / g_particleWorkgroupSize;
+		const uint32_t trailGroups = (g_trailSize + g_trailWorkgroupSize - 1) / g_trailWorkgroupSize;
+		m_graph->Begin();
+		{
+			RenderSys::ScopedGpuMarker<RenderSys::ComputeGraph> marker(*m_graph, "Particles");
+			for (int substep = 0; substep < m_substeps; ++substep)
+			{
+				m_graph->Dispatch(m_forces, particleGroups, 1, 1, params);
+				m_graph->Dispatch(m_integrate, particleGroups, 1, 1, params);
+			}
+		}
+		{
+			RenderSys::ScopedGpuMarker<RenderSys::ComputeGraph> marker(*m_graph, "Trail");
+			m_graph->Dispatch(m_decay, trailGroups, trailGroups, 1, params);
+			m_graph->Dispatch(m_splat, particleGroups, 1, 1, params);
+		}
+		// copied back while the next frame runs, the preview shows the frame before
+		if (m_preview)
+			m_graph->RequestRead("trail", 0, g_trailSize * g_trailSize * sizeof(uint32_t));
+		const RenderSys::ComputeTicket previewTicket = m_previewTicket;
+		const RenderSys::ComputeTicket ticket = m_graph->End();
+		m_previewTicket = m_preview ? ticket : 0;
+		m_lastRecordTime = timer.ElapsedMillis();
+
+		if (previewTicket != 0)
+		{
+			Walnut::Timer readbackTimer;
+			m_previewReady = m_graph->IsComplete(previewTicket);
+			const uint32_t* trail = static_cast<const uint32_t*>(m_graph->GetReadback(previewTicket, 0));
+			for (size_t i = 0; i < m_pixels.size(); ++i)
+			{
+				const uint32_t value = std::min(trail[i], 255u);
+				m_pixels[i] = (255u << 24) | (value << 16) | ((value / 2) << 8) | (value / 4);
+			}
+			if (m_image)
+				m_image->SetData(m_pixels.data());
+			m_lastReadbackTime = readbackTimer.ElapsedMillis();
+		}
+	}
+
+	virtual void OnUIRender() override
+	{
+		ImGui::Begin("Settings");
+		ImGui::Text("Particles: %u", g_particleCount);
+		ImGui::Text("Dispatches: %u, barriers: %u", m_graph->GetDispatchCount(), m_graph->GetBarrierCount());
+		ImGui::Text("Record and submit: %.3fms", m_lastRecordTime);
+		ImGui::Text("Readback (one frame late, %s): %.3fms", m_previewReady ? "ready" : "waited", m_lastReadbackTime);
+		ImGui::SliderInt("Substeps", &m_substeps, 1, 32);
+		ImGui::Checkbox("Read back the trail", &m_preview);
+		ImGui::End();
+
+		if (auto* profiler = m_graph->GetGpuProfiler())
+			profiler->OnImGuiRender();
+
+		ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0.0f, 0.0f));
+		ImGui::Begin("Viewport");
+		if (m_preview && m_image)
+		{
+			const float viewSize = std::min(ImGui::GetContentRegionAvail().x, ImGui::GetContentRegionAvail().y);
+			ImGui::Image((void*)m_image->GetDescriptorSet(), { viewSize, viewSize });
+		}
+		ImGui::End();
+		ImGui::PopStyleVar();
+	}
+
+	// without the layer being attached, on the headless device, at a fixed time step.
+	// Returns false when the graph recorded other dispatches or barriers than the kernels need
+	bool RunHeadless()
+	{
+		OnAttach();
+		for (uint32_t frame = 0; frame < s_settings.frameCount; ++frame)
+		{
+			OnUpdate(1.0f / 60.0f);
+		}
+		// the counts are of the last frame, every frame records the same graph
+		std::cout << "ComputeGraph: " << s_settings.frameCount << " frames, " << m_substeps << " substeps, "
+					<< m_graph->GetDispatchCount() << " dispatches and " << m_graph->GetBarrierCount() << " barriers per frame, "
+					<< m_lastRecordTime << "ms record and submit" << std::endl;
+		// forces and integrate depend on each other, so every one of them but the first waits for the one before.
+		// Decay touches no particle buffer and runs without a barrier, splat reads the positions and writes the trail.
+		// The next frame starts with forces, which only reads what splat read, so no barrier between the frames
+		const uint32_t expectedDispatches = 2 * m_substeps + 2;
+		const uint32_t expectedBarriers = 2 * m_substeps;
+		const bool passed = m_graph->GetDispatchCount() == expectedDispatches && m_graph->GetBarrierCount() == expectedBarriers;
+		if (!passed)
+		{
+			std::cout << "error: expected " << expectedDispatches << " dispatches and " << expectedBarriers << " barriers" << std::endl;
+		}
+		OnDetach();
+		return passed;
+	}
+
+private:
+	std::unique_ptr<RenderSys::Shader> CreateShader(const char* name, const char* kernelSource)
+	{
+		auto shader = std::make_unique<RenderSys::Shader>(name, std::string(s_kernelHeader) + kernelSource);
+		shader->type = RenderSys::ShaderType::SPIRV;
+		shader->stage = RenderSys::ShaderStage::Compute;
+		return shader;
+	}
+
+	std::unique_ptr<RenderSys::ComputeGraph> m_graph;
+	uint32_t m_forces = 0;
+	uint32_t m_integrate = 0;
+	uint32_t m_decay = 0;
+	uint32_t m_splat = 0;
+
+	std::shared_ptr<Walnut::Image> m_image;
+	// of the last frame with a trail readback
+	RenderSys::ComputeTicket m_previewTicket = 0;
+	bool m_previewReady = false;
+	std::vector<uint32_t> m_pixels;
+	float m_time = 0.0f;
+	int m_substeps = 8;
+	bool m_preview = true;
+	float m_lastRecordTime = 0.0f;
+	float m_lastReadbackTime = 0.0f;
+};
+
+static void setEnvironmentVariable(const char* name, const std::string& value)
+{
+#ifdef _WIN32
+	_putenv_s(name, value.c_str());
+#else
+	setenv(name, value.c_str(), 1);
+#endif
+}
+
+static bool parseArguments(int argc, char** argv)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string argument = argv[i];
+		if (i + 1 >= argc)
+		{
+			std::cout << "error: " << argument << " needs a value" << std::endl;
+			return false;
+		}
+		const std::string value = argv[++i];
+		if (argument == "--frames")
+			s_settings.frameCount = static_cast<uint32_t>(std::max(std::atoi(value.c_str()), 1));
+		else if (argument == "--icd")
+			s_settings.icdFile = value;
+		else if (argument == "--validation")
+		{
+			s_settings.device.m_Validation = value != "off";
+			s_settings.device.m_SynchronizationValidation = value == "sync";
+		}
+		else
+		{
+			std::cout << "error: unknown argument " << argument << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+Walnut::Application* Walnut::CreateApplication(int argc, char** argv)
+{
+	if (!parseArguments(argc, argv))
+	{
+		std::cout << "usage: ComputeGraph [--frames n] [--icd file] [--validation off|on|sync]" << std::endl;
+	}
+
+	// e.g. the lavapipe ICD, the loader picks the driver when the Vulkan instance is created
+	if (!s_settings.icdFile.empty())
+	{
+		setEnvironmentVariable("VK_DRIVER_FILES", s_settings.icdFile);
+		setEnvironmentVariable("VK_ICD_FILENAMES", s_settings.icdFile);
+	}
+
+	// no window, no surface. Walnut's entry point always returns 0, so the run exits from here with its result
+	if (s_settings.frameCount > 0)
+	{
+		s_settings.device.m_ApplicationName = "Compute Graph Example";
+		if (!RenderSys::CreateHeadlessDevice(s_settings.device))
+		{
+			std::exit(EXIT_FAILURE);
+		}
+		bool passed = false;
+		{
+			ComputeGraphLayer layer;
+			passed = layer.RunHeadless();
+		}
+		RenderSys::DestroyHeadlessDevice();
+		if (s_settings.device.m_Validation)
+		{
+			// with --validation sync a missing barrier of the graph shows up here as a hazard
+			std::cout << "Validation: " << RenderSys::GetValidationErrorCount() << " errors, "
+						<< RenderSys::GetValidationWarningCount() << " warnings" << std::endl;
+			passed = passed && RenderSys::GetValidationErrorCount() == 0;
+		}
+		std::exit(passed ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	Walnut::ApplicationSpecification spec;
+	spec.Name = "Compute Graph Example";
+
+	Walnut::Application* app = new Walnut::Application(spec);
+	app->PushLayer<ComputeGraphLayer>();
+	return app;
+}
@@ -42,6 +42,37 @@ struct VertexBuffer
     const Vertex& operator[](size_t index) const { return vertices[index]; }
 };
 
+// compact layout of Vertex, 28 instead of 64 bytes, written by VertexPacking
+// the shaders decode the octahedral normal and tangent (vertex-packing.glsl)
+struct PackedVertex {
+    glm::vec3 position;
+    glm::i16vec2 normal;    // octahedral, snorm16
+    glm::i16vec2 tangent;   // octahedral, snorm16
+    glm::u16vec2 texcoord0; // half float or unorm16, see PackedUvFormat
+    glm::u8vec4 color;      // unorm8, alpha is 255
+};
+
+static_assert(sizeof(PackedVertex) == 28);
+
+enum class PackedUvFormat
+{
+    // any range, 11 significant bits, steps of 1/2048 up to 1 and of 1/256 up to 8
+    Float16 = 0,
+    // 1/65535 steps in [0, 1], coordinates outside the range are clamped
+    Unorm16
+};
+
+struct PackedVertexBuffer
+{
+    std::vector<PackedVertex> vertices;
+    PackedUvFormat uvFormat = PackedUvFormat::Float16;
+    void resize(size_t size) { vertices.resize(size); }
+    size_t size() const { return vertices.size(); }
+    void clear() { vertices.clear(); }
+    PackedVertex& operator[](size_t index) { return vertices[index]; }
+    const PackedVertex& operator[](size_t index) const { return vertices[index]; }
+};
+
 namespace ComputeBuf
 {
 
@@ -49,7 +80,9 @@ enum class BufferType
 {
     Input = 0,
     Output,
-    Uniform
+    Uniform,
+    // stays on the GPU across passes, zero filled on creation and only copied back by Compute::ReadBuffer()
+    Storage
 };
     
 } // namespace Compute
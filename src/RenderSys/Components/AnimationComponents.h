@@ -0,0 +1,92 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <vector>
+#include <RenderSys/Buffer.h>
+#include <RenderSys/Scene/Skeleton.h>
+#include <RenderSys/Scene/Animation.h>
+
+namespace RenderSys
+{
+
+// The joint palette of a skeleton on the GPU. The CPU never writes m_Buffer while a frame may read it: every pose
+// goes into the next of m_Uploads and the renderer copies it into m_Buffer in the command buffer of its frame.
+struct JointMatricesBuffer
+{
+    // Renderer3D has one frame in flight, its WaitForFrame() waits for the frame before at BeginFrame(). A pose is
+    // written before that wait, while the frame before may still copy from its upload, so that needs two.
+    // The third keeps the palette valid should the renderer ever keep a second frame in flight
+    static constexpr uint32_t UPLOAD_COUNT = 3;
+
+    explicit JointMatricesBuffer(const size_t byteSize)
+        : m_Buffer(std::make_shared<Buffer>(byteSize, BufferUsage::STORAGE_BUFFER_VISIBLE_TO_CPU))
+    {
+        m_Buffer->MapBuffer();
+        for (auto& upload : m_Uploads)
+        {
+            upload = std::make_shared<Buffer>(byteSize, BufferUsage::TRANSFER_SRC_VISIBLE_TO_GPU);
+            upload->MapBuffer();
+        }
+    }
+
+    // before the first frame, nothing reads the buffer yet
+    void WriteInitial(const void* data) { m_Buffer->WriteToBuffer(data); }
+    // the renderer copies it with the next frame
+    void Write(const void* data)
+    {
+        m_CurrentUpload = (m_CurrentUpload + 1) % UPLOAD_COUNT;
+        m_Uploads[m_CurrentUpload]->WriteToBuffer(data);
+        m_UploadPending = true;
+    }
+
+    // bound at Resource::SKELETAL_ANIMATION_BUFFER_INDEX
+    std::shared_ptr<Buffer> m_Buffer;
+    std::array<std::shared_ptr<Buffer>, UPLOAD_COUNT> m_Uploads;
+    uint32_t m_CurrentUpload = 0;
+    bool m_UploadPending = false;
+};
+
+// every animated character owns its skeleton, so poses can be evaluated independently (and in parallel).
+// The skinned meshes of one character share the skeleton and its joint buffer, it is posed once per frame.
+struct SkeletonComponent
+{
+    std::shared_ptr<Skeleton> m_Skeleton;
+    // GPU copy of Skeleton::GetJointPaletteData()
+    std::shared_ptr<JointMatricesBuffer> m_JointMatricesBuffer;
+};
+
+// playback state lives here and not in the clip, so one loaded clip can drive any number of characters
+struct AnimationComponent
+{
+    std::vector<std::shared_ptr<const SkeletalAnimation>> m_Animations;
+    int m_CurrentAnimation{0};
+    float m_CurrentTime{0.0f}; // relative to the first key frame of the current animation
+    float m_Speed{1.0f};
+    bool m_Repeat{true};
+    bool m_Playing{true};
+};
+
+// local transform of one joint, the sparse samples of distant characters are interpolated in this form
+struct JointPose
+{
+    glm::vec3 m_Translation{0.0f};
+    glm::quat m_Rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    glm::vec3 m_Scale{1.0f};
+};
+
+// level of detail state of an animated character, added by the AnimationSystem when it runs with a camera
+struct AnimationLodComponent
+{
+    float m_BoundingRadius{2.0f}; // around the origin of the entity, used for the visibility test
+
+    // written by the AnimationSystem
+    uint32_t m_Lod{0};
+    bool m_Visible{true};
+    uint32_t m_SampleInterval{1};
+    uint32_t m_FramesSinceSample{0};
+    std::vector<JointPose> m_SourcePose;
+    std::vector<JointPose> m_TargetPose;
+};
+
+}
@@ -1,5 +1,7 @@
 #include "Compute.h"
 
+#include <cassert>
+
 #if (RENDERER_BACKEND == 1)
 static_assert(false);
 #elif (RENDERER_BACKEND == 2)
@@ -44,9 +46,9 @@ void Compute::CreateBuffer(uint32_t binding, const uint32_t bufferLength, Comput
     m_computeBackend->CreateBuffer(binding, bufferLength, type);
 }
 
-void Compute::SetBufferData(uint32_t binding, const void *bufferData, uint32_t bufferLength)
+void Compute::SetBufferData(uint32_t binding, const void *bufferData, uint32_t bufferLength, uint32_t offset)
 {
-    m_computeBackend->SetBufferData(binding, bufferData, bufferLength);
+    m_computeBackend->SetBufferData(binding, bufferData, bufferLength, offset);
 }
 
 void Compute::BeginComputePass()
@@ -59,16 +61,73 @@ void Compute::DoCompute(const uint32_t workgroupCountX, const uint32_t workgroup
     m_computeBackend->Compute(workgroupCountX, workgroupCountY);
 }
 
+void Compute::DoCompute(const uint32_t kernel, const uint32_t workgroupCountX, const uint32_t workgroupCountY, const uint32_t workgroupCountZ,
+                        const void* pushConstants, const uint32_t pushConstantSize, const bool waitForPrevious)
+{
+    assert(pushConstantSize <= MAX_PUSH_CONSTANT_SIZE);
+    m_computeBackend->Compute(kernel, workgroupCountX, workgroupCountY, workgroupCountZ, pushConstants, pushConstantSize, waitForPrevious);
+}
+
+uint32_t Compute::RequestReadback(const uint32_t binding, const uint32_t offset, const uint32_t size)
+{
+    return m_computeBackend->RequestReadback(binding, offset, size);
+}
+
+ComputeTicket Compute::Submit()
+{
+    return m_computeBackend->Submit();
+}
+
 void Compute::EndComputePass()
 {
     m_computeBackend->EndComputePass();
 }
 
+bool Compute::IsComplete(const ComputeTicket ticket)
+{
+    return m_computeBackend->IsComplete(ticket);
+}
+
+void Compute::Wait(const ComputeTicket ticket)
+{
+    m_computeBackend->Wait(ticket);
+}
+
+const void* Compute::GetReadback(const ComputeTicket ticket, const uint32_t readback)
+{
+    return m_computeBackend->GetReadback(ticket, readback);
+}
+
 std::vector<uint8_t> &Compute::GetMappedResult(const uint32_t binding)
 {
     return m_computeBackend->GetMappedResult(binding);
 }
 
+void Compute::ReadBuffer(const uint32_t binding, void* data, const uint32_t offset, const uint32_t size)
+{
+    m_computeBackend->ReadBuffer(binding, data, offset, size);
+}
+
+void Compute::WriteBuffer(const uint32_t binding, const void* data, const uint32_t offset, const uint32_t size)
+{
+    m_computeBackend->WriteBuffer(binding, data, offset, size);
+}
+
+void Compute::BeginProfileScope(const std::string& name)
+{
+    m_computeBackend->BeginProfileScope(name);
+}
+
+void Compute::EndProfileScope()
+{
+    m_computeBackend->EndProfileScope();
+}
+
+RenderSys::GpuProfiler* Compute::GetGpuProfiler()
+{
+    return m_computeBackend->GetGpuProfiler();
+}
+
 void Compute::Destroy()
 {
     m_computeBackend->Destroy();
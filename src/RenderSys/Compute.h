@@ -5,6 +5,7 @@
 #include <stdint.h>
 
 #include "Buffer.h"
+#include "GpuProfiler.h"
 #include "RenderUtil.h"
 #include "Shader.h"
 
@@ -25,10 +26,20 @@ static_assert(false);
 
 namespace RenderSys
 {
+
+// identifies a submitted pass, see Compute::Submit()
+using ComputeTicket = uint64_t;
     
+// One bind group shared by one or more kernels. Every SetShader() call adds a kernel, numbered in call order,
+// and CreatePipeline() creates a pipeline per kernel. Dispatches of a pass run in the order they were recorded.
 class Compute
 {
 public:
+    // the push constant range of every kernel
+    static constexpr uint32_t MAX_PUSH_CONSTANT_SIZE = 128;
+    // BeginComputePass() waits for the pass this many passes before it, the ones after may still run
+    static constexpr uint32_t MAX_PASSES_IN_FLIGHT = 2;
+
     Compute();
     ~Compute();
 
@@ -42,11 +53,37 @@ public:
     void CreatePipeline();
     void CreateBindGroup(const std::vector<RenderSys::BindGroupLayoutEntry>& bindGroupLayoutEntries);
     void CreateBuffer(uint32_t binding, const uint32_t bufferLength, ComputeBuf::BufferType type);
-    void SetBufferData(uint32_t binding, const void *bufferData, uint32_t bufferLength);
+    // writes bufferLength bytes at offset of an Input buffer, which the passes in flight must not read there
+    void SetBufferData(uint32_t binding, const void *bufferData, uint32_t bufferLength, uint32_t offset = 0);
     void BeginComputePass();
     void DoCompute(const uint32_t workgroupCountX, const uint32_t workgroupCountY);
+    // dispatches a kernel. With waitForPrevious it waits for the writes of the dispatches recorded and submitted before,
+    // without it the dispatch may overlap them, for kernels that touch none of their buffers
+    void DoCompute(const uint32_t kernel, const uint32_t workgroupCountX, const uint32_t workgroupCountY, const uint32_t workgroupCountZ,
+                    const void* pushConstants = nullptr, const uint32_t pushConstantSize = 0, const bool waitForPrevious = true);
+    // copies a range of a Storage buffer into a staging buffer of the pass once its dispatches are done,
+    // returns the index of the readback for GetReadback()
+    uint32_t RequestReadback(const uint32_t binding, const uint32_t offset, const uint32_t size);
+    // submits the pass without waiting for it. The staging buffers are double buffered with the passes in flight,
+    // so the host reads the results of one pass while the GPU runs the next
+    ComputeTicket Submit();
+    // Submit() without the ticket
     void EndComputePass();
+    bool IsComplete(const ComputeTicket ticket);
+    void Wait(const ComputeTicket ticket);
+    // waits for the pass, the data stays valid until MAX_PASSES_IN_FLIGHT more passes have begun
+    const void* GetReadback(const ComputeTicket ticket, const uint32_t readback);
+    // copies an Output buffer back, waits for the queue
     std::vector<uint8_t>& GetMappedResult(const uint32_t binding);
+    // copies a range of a Storage buffer back, waits for the passes submitted so far
+    void ReadBuffer(const uint32_t binding, void* data, const uint32_t offset, const uint32_t size);
+    // uploads a range of a Storage buffer, outside of a pass. The passes submitted before are done with it first
+    void WriteBuffer(const uint32_t binding, const void* data, const uint32_t offset, const uint32_t size);
+    // a named scope of dispatches inside a pass, every pass is a frame of the profiler with a scope of its own
+    void BeginProfileScope(const std::string& name);
+    void EndProfileScope();
+    // nullptr when the backend has no timestamp queries
+    RenderSys::GpuProfiler* GetGpuProfiler();
     void Destroy();
 private:
     std::unique_ptr<GraphicsAPI::ComputeType> m_computeBackend;
@@ -0,0 +1,168 @@
+#include "ComputeGraph.h"
+
+#include <cassert>
+#include <iostream>
+
+namespace RenderSys
+{
+
+ComputeGraph::ComputeGraph()
+    : m_compute(std::make_unique<Compute>())
+{
+    m_compute->Init();
+}
+
+ComputeGraph::~ComputeGraph()
+{
+    m_compute->Destroy();
+}
+
+uint32_t ComputeGraph::AddBuffer(const std::string& name, const uint32_t size)
+{
+    assert(!m_built);
+    assert(m_buffers.size() < MAX_BUFFERS);
+    const uint32_t binding = static_cast<uint32_t>(m_buffers.size());
+    const bool inserted = m_buffers.emplace(name, binding).second;
+    if (!inserted)
+    {
+        std::cout << "Error: compute graph buffer " << name << " is already added!" << std::endl;
+        assert(false);
+        return m_buffers[name];
+    }
+    m_compute->CreateBuffer(binding, size, ComputeBuf::BufferType::Storage);
+    return binding;
+}
+
+uint32_t ComputeGraph::AddKernel(Shader& shader, const std::vector<std::string>& reads, const std::vector<std::string>& writes)
+{
+    assert(!m_built);
+    Kernel kernel;
+    kernel.m_Writes = BufferMask(writes);
+    kernel.m_Reads = BufferMask(reads) & ~kernel.m_Writes;
+    m_kernels.push_back(kernel);
+    m_compute->SetShader(shader);
+    return static_cast<uint32_t>(m_kernels.size() - 1);
+}
+
+void ComputeGraph::Build()
+{
+    assert(!m_built && !m_buffers.empty() && !m_kernels.empty());
+    std::vector<BindGroupLayoutEntry> bindingLayoutEntries(m_buffers.size());
+    for (const auto& [name, binding] : m_buffers)
+    {
+        BindGroupLayoutEntry& entry = bindingLayoutEntries[binding];
+        entry.setDefault();
+        entry.binding = binding;
+        entry.buffer.type = BufferBindingType::Storage;
+        entry.buffer.bufferName = name;
+        entry.visibility = ShaderStage::Compute;
+    }
+    m_compute->CreateBindGroup(bindingLayoutEntries);
+    m_compute->CreatePipeline();
+    m_built = true;
+}
+
+uint32_t ComputeGraph::GetBuffer(const std::string& name) const
+{
+    const auto found = m_buffers.find(name);
+    if (found == m_buffers.end())
+    {
+        std::cout << "Error: compute graph has no buffer " << name << "!" << std::endl;
+        assert(false);
+        return 0;
+    }
+    return found->second;
+}
+
+void ComputeGraph::Write(const std::string& name, const void* data, const uint32_t offset, const uint32_t size)
+{
+    assert(m_built && !m_inPass);
+    m_compute->WriteBuffer(GetBuffer(name), data, offset, size);
+}
+
+void ComputeGraph::Read(const std::string& name, void* data, const uint32_t offset, const uint32_t size)
+{
+    assert(m_built && !m_inPass);
+    m_compute->ReadBuffer(GetBuffer(name), data, offset, size);
+}
+
+void ComputeGraph::Begin()
+{
+    assert(m_built && !m_inPass);
+    m_compute->BeginComputePass();
+    m_inPass = true;
+    m_dispatchCount = 0;
+    m_barrierCount = 0;
+}
+
+void ComputeGraph::Dispatch(const uint32_t kernel, const uint32_t workgroupCountX, const uint32_t workgroupCountY, const uint32_t workgroupCountZ,
+                            const void* pushConstants, const uint32_t pushConstantSize)
+{
+    assert(m_inPass && kernel < m_kernels.size());
+    const Kernel& dispatched = m_kernels[kernel];
+    // read after write, write after write and write after read
+    const bool dependent = ((dispatched.m_Reads | dispatched.m_Writes) & m_pendingWrites) != 0
+                        || (dispatched.m_Writes & m_pendingReads) != 0;
+    if (dependent)
+    {
+        m_pendingReads = 0;
+        m_pendingWrites = 0;
+        m_barrierCount++;
+    }
+    m_pendingReads |= dispatched.m_Reads;
+    m_pendingWrites |= dispatched.m_Writes;
+    m_compute->DoCompute(kernel, workgroupCountX, workgroupCountY, workgroupCountZ, pushConstants, pushConstantSize, dependent);
+    m_dispatchCount++;
+}
+
+void ComputeGraph::BeginProfileScope(const std::string& name)
+{
+    assert(m_inPass);
+    m_compute->BeginProfileScope(name);
+}
+
+void ComputeGraph::EndProfileScope()
+{
+    assert(m_inPass);
+    m_compute->EndProfileScope();
+}
+
+uint32_t ComputeGraph::RequestRead(const std::string& name, const uint32_t offset, const uint32_t size)
+{
+    assert(m_inPass);
+    return m_compute->RequestReadback(GetBuffer(name), offset, size);
+}
+
+ComputeTicket ComputeGraph::End()
+{
+    assert(m_inPass);
+    m_inPass = false;
+    return m_compute->Submit();
+}
+
+bool ComputeGraph::IsComplete(const ComputeTicket ticket) const
+{
+    return m_compute->IsComplete(ticket);
+}
+
+void ComputeGraph::Wait(const ComputeTicket ticket)
+{
+    m_compute->Wait(ticket);
+}
+
+const void* ComputeGraph::GetReadback(const ComputeTicket ticket, const uint32_t readback)
+{
+    return m_compute->GetReadback(ticket, readback);
+}
+
+uint64_t ComputeGraph::BufferMask(const std::vector<std::string>& names) const
+{
+    uint64_t mask = 0;
+    for (const std::string& name : names)
+    {
+        mask |= uint64_t(1) << GetBuffer(name);
+    }
+    return mask;
+}
+
+} // namespace RenderSys
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Compute.h"
+
+namespace RenderSys
+{
+
+// Kernels that share named Storage buffers, which persist on the GPU from pass to pass. Every kernel declares the
+// buffers it reads and writes, so a dispatch waits only when it reads a buffer that a dispatch before it wrote or
+// writes one that a dispatch before it used, independent dispatches overlap. Nothing is copied back unless Read()
+// or RequestRead() asks for it, so an iterative simulation records N dispatches per frame without a round trip to
+// the host.
+//
+//     ComputeGraph graph;
+//     graph.AddBuffer("positions", size);
+//     graph.AddBuffer("velocities", size);
+//     const uint32_t integrate = graph.AddKernel(shader, {"velocities"}, {"positions"});
+//     graph.Build();
+//     graph.Begin();
+//     graph.Dispatch(integrate, groupCount, 1, 1);
+//     graph.End();
+class ComputeGraph
+{
+public:
+    // the dependencies of a dispatch are one bit per buffer
+    static constexpr uint32_t MAX_BUFFERS = 64;
+
+    ComputeGraph();
+    ~ComputeGraph();
+
+    ComputeGraph(const ComputeGraph&) = delete;
+    ComputeGraph& operator=(const ComputeGraph&) = delete;
+    ComputeGraph(ComputeGraph&&) = delete;
+    ComputeGraph& operator=(ComputeGraph&&) = delete;
+
+    // zero filled, bound at layout(set = 0, binding = n) where n is the returned index, in the order of the calls
+    uint32_t AddBuffer(const std::string& name, const uint32_t size);
+    // a buffer that a kernel writes and reads goes into writes only. Returns the index of the kernel
+    uint32_t AddKernel(Shader& shader, const std::vector<std::string>& reads, const std::vector<std::string>& writes);
+    // creates the bind group and the pipelines, after the last AddBuffer() and AddKernel()
+    void Build();
+
+    uint32_t GetBuffer(const std::string& name) const;
+    // outside of a pass, both wait for the passes submitted so far
+    void Write(const std::string& name, const void* data, const uint32_t offset, const uint32_t size);
+    void Read(const std::string& name, void* data, const uint32_t offset, const uint32_t size);
+
+    void Begin();
+    void Dispatch(const uint32_t kernel, const uint32_t workgroupCountX, const uint32_t workgroupCountY, const uint32_t workgroupCountZ,
+                    const void* pushConstants = nullptr, const uint32_t pushConstantSize = 0);
+    template<typename PushConstants>
+    void Dispatch(const uint32_t kernel, const uint32_t workgroupCountX, const uint32_t workgroupCountY, const uint32_t workgroupCountZ,
+                    const PushConstants& pushConstants)
+    {
+        Dispatch(kernel, workgroupCountX, workgroupCountY, workgroupCountZ, &pushConstants, sizeof(PushConstants));
+    }
+    // copies a range of a buffer back at the end of the pass, GetReadback() with the ticket of End() returns it
+    uint32_t RequestRead(const std::string& name, const uint32_t offset, const uint32_t size);
+    // submits the pass, does not wait for it
+    ComputeTicket End();
+    bool IsComplete(const ComputeTicket ticket) const;
+    void Wait(const ComputeTicket ticket);
+    // waits for the pass, valid until Compute::MAX_PASSES_IN_FLIGHT more passes have begun
+    const void* GetReadback(const ComputeTicket ticket, const uint32_t readback);
+
+    // groups the dispatches of a pass in the profiler, every pass is a frame of it
+    void BeginProfileScope(const std::string& name);
+    void EndProfileScope();
+    // nullptr when the backend has no timestamp queries
+    GpuProfiler* GetGpuProfiler() { return m_compute->GetGpuProfiler(); }
+
+    // of the last pass
+    uint32_t GetDispatchCount() const { return m_dispatchCount; }
+    uint32_t GetBarrierCount() const { return m_barrierCount; }
+
+private:
+    struct Kernel
+    {
+        uint64_t m_Reads = 0;
+        uint64_t m_Writes = 0;
+    };
+
+    uint64_t BufferMask(const std::vector<std::string>& names) const;
+
+    std::unique_ptr<Compute> m_compute;
+    std::unordered_map<std::string, uint32_t> m_buffers;
+    std::vector<Kernel> m_kernels;
+    bool m_built = false;
+    bool m_inPass = false;
+    // what the dispatches since the last barrier read and wrote, carried over into the next pass
+    uint64_t m_pendingReads = 0;
+    uint64_t m_pendingWrites = 0;
+    uint32_t m_dispatchCount = 0;
+    uint32_t m_barrierCount = 0;
+};
+
+} // namespace RenderSys
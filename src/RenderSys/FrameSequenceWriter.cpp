@@ -0,0 +1,175 @@
+#include "FrameSequenceWriter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stb_image_write.h>
+
+namespace RenderSys
+{
+
+FrameSequenceWriter::FrameSequenceWriter(const std::string& directory, const std::string& baseName, const Format format, const uint32_t maxQueuedFrames)
+    : m_directory(directory)
+    , m_baseName(baseName)
+    , m_format(format)
+    , m_maxQueuedFrames(std::max(maxQueuedFrames, 1u))
+{
+    std::error_code error;
+    std::filesystem::create_directories(m_directory, error);
+    if (error)
+    {
+        std::cout << "error: could not create the directory " << m_directory << ": " << error.message() << std::endl;
+    }
+    m_encoder = std::thread([this]() { EncoderLoop(); });
+}
+
+FrameSequenceWriter::~FrameSequenceWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_frameQueued.notify_all();
+    m_encoder.join();
+}
+
+void FrameSequenceWriter::Write(const uint32_t frameIndex, const RenderedImageView& image)
+{
+    const size_t size = static_cast<size_t>(image.width) * image.height * 4;
+    if (!image.pixels || image.size < size)
+    {
+        std::cout << "error: frame " << frameIndex << " has no pixels" << std::endl;
+        return;
+    }
+
+    const auto stallStart = std::chrono::high_resolution_clock::now();
+    Frame frame;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_frameTaken.wait(lock, [this]() { return m_queue.size() < m_maxQueuedFrames; });
+        if (!m_freeBuffers.empty())
+        {
+            frame.m_Pixels = std::move(m_freeBuffers.back());
+            m_freeBuffers.pop_back();
+        }
+    }
+    const auto copyStart = std::chrono::high_resolution_clock::now();
+
+    frame.m_Index = frameIndex;
+    frame.m_Width = image.width;
+    frame.m_Height = image.height;
+    frame.m_Pixels.resize(size);
+    std::memcpy(frame.m_Pixels.data(), image.pixels, size);
+    const auto copyEnd = std::chrono::high_resolution_clock::now();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(std::move(frame));
+        m_stats.m_StallTimeMs += std::chrono::duration<float, std::milli>(copyStart - stallStart).count();
+        m_stats.m_CopyTimeMs += std::chrono::duration<float, std::milli>(copyEnd - copyStart).count();
+    }
+    m_frameQueued.notify_one();
+}
+
+void FrameSequenceWriter::Finish()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_framesWritten.wait(lock, [this]() { return m_queue.empty() && m_encodingFrames == 0; });
+}
+
+FrameSequenceWriter::Stats FrameSequenceWriter::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+const char* FrameSequenceWriter::GetExtension(const Format format)
+{
+    return format == Format::PPM ? "ppm" : "png";
+}
+
+void FrameSequenceWriter::EncoderLoop()
+{
+    while (true)
+    {
+        Frame frame;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_frameQueued.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+            if (m_stop && m_queue.empty())
+            {
+                return;
+            }
+            frame = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_encodingFrames++;
+        }
+        m_frameTaken.notify_one();
+
+        const auto encodeStart = std::chrono::high_resolution_clock::now();
+        const bool written = Encode(frame);
+        const auto encodeEnd = std::chrono::high_resolution_clock::now();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.m_EncodeTimeMs += std::chrono::duration<float, std::milli>(encodeEnd - encodeStart).count();
+            if (written)
+                m_stats.m_FramesWritten++;
+            else
+                m_stats.m_FramesFailed++;
+            m_freeBuffers.push_back(std::move(frame.m_Pixels));
+            m_encodingFrames--;
+        }
+        m_framesWritten.notify_all();
+    }
+}
+
+bool FrameSequenceWriter::Encode(const Frame& frame) const
+{
+    const auto fileName = GetFileName(frame.m_Index);
+    if (m_format == Format::PNG)
+    {
+        const int rowStride = static_cast<int>(frame.m_Width) * 4;
+        if (!stbi_write_png(fileName.c_str(), static_cast<int>(frame.m_Width), static_cast<int>(frame.m_Height), 4, frame.m_Pixels.data(), rowStride))
+        {
+            std::cout << "error: could not write " << fileName << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    std::ofstream file(fileName, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "error: could not write " << fileName << std::endl;
+        return false;
+    }
+    file << "P6\n" << frame.m_Width << " " << frame.m_Height << "\n255\n";
+    // drop the alpha channel, one row at a time
+    std::vector<uint8_t> row(static_cast<size_t>(frame.m_Width) * 3);
+    for (uint32_t y = 0; y < frame.m_Height; ++y)
+    {
+        const uint8_t* source = frame.m_Pixels.data() + static_cast<size_t>(y) * frame.m_Width * 4;
+        for (uint32_t x = 0; x < frame.m_Width; ++x)
+        {
+            row[x * 3 + 0] = source[x * 4 + 0];
+            row[x * 3 + 1] = source[x * 4 + 1];
+            row[x * 3 + 2] = source[x * 4 + 2];
+        }
+        file.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(row.size()));
+    }
+    return file.good();
+}
+
+std::string FrameSequenceWriter::GetFileName(const uint32_t frameIndex) const
+{
+    char index[16];
+    std::snprintf(index, sizeof(index), "%05u", frameIndex);
+    return (std::filesystem::path(m_directory) / (m_baseName + "_" + index + "." + GetExtension(m_format))).string();
+}
+
+} // namespace RenderSys
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stdint.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <RenderSys/RenderUtil.h>
+
+namespace RenderSys
+{
+
+// Writes rendered frames to numbered image files on its own encoder thread, the render loop only copies
+// the pixels of a readback into a queue. When maxQueuedFrames frames wait for the encoder, Write() blocks,
+// so a slow disk or encoder throttles the rendering instead of growing the queue.
+class FrameSequenceWriter
+{
+public:
+    enum class Format
+    {
+        PNG = 0,
+        // binary portable pixmap, RGB without compression, much cheaper to encode than PNG
+        PPM
+    };
+
+    // summed over all written frames
+    struct Stats
+    {
+        uint32_t m_FramesWritten = 0;
+        uint32_t m_FramesFailed = 0;
+        // render thread, copying the pixels into the queue
+        float m_CopyTimeMs = 0.0f;
+        // render thread, waiting for a queued frame to be taken by the encoder
+        float m_StallTimeMs = 0.0f;
+        // encoder thread, encoding and writing the files
+        float m_EncodeTimeMs = 0.0f;
+    };
+
+    // files are named <directory>/<baseName>_<frame index>.<png|ppm>, the directory is created when missing
+    FrameSequenceWriter(const std::string& directory, const std::string& baseName, const Format format, const uint32_t maxQueuedFrames = 4);
+    // writes the queued frames before it returns
+    ~FrameSequenceWriter();
+
+    FrameSequenceWriter(const FrameSequenceWriter&) = delete;
+    FrameSequenceWriter& operator=(const FrameSequenceWriter&) = delete;
+    FrameSequenceWriter(FrameSequenceWriter&&) = delete;
+    FrameSequenceWriter& operator=(FrameSequenceWriter&&) = delete;
+
+    // copies the RGBA8 pixels of the image, they only have to stay valid during the call
+    void Write(const uint32_t frameIndex, const RenderedImageView& image);
+    // blocks until every queued frame is written
+    void Finish();
+    Stats GetStats() const;
+    static const char* GetExtension(const Format format);
+
+private:
+    struct Frame
+    {
+        uint32_t m_Index = 0;
+        uint32_t m_Width = 0;
+        uint32_t m_Height = 0;
+        std::vector<uint8_t> m_Pixels;
+    };
+
+    void EncoderLoop();
+    bool Encode(const Frame& frame) const;
+    std::string GetFileName(const uint32_t frameIndex) const;
+
+    std::string m_directory;
+    std::string m_baseName;
+    Format m_format = Format::PNG;
+    uint32_t m_maxQueuedFrames = 4;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_frameQueued;
+    std::condition_variable m_frameTaken;
+    std::condition_variable m_framesWritten;
+    std::deque<Frame> m_queue;
+    // pixel buffers of written frames, reused so that a sequence of equally sized frames allocates only once
+    std::vector<std::vector<uint8_t>> m_freeBuffers;
+    uint32_t m_encodingFrames = 0;
+    bool m_stop = false;
+    Stats m_stats;
+    std::thread m_encoder;
+};
+
+} // namespace RenderSys
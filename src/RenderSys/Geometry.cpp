@@ -1,10 +1,9 @@
 #include "Geometry.h"
 
-#include <fstream>
-#include <sstream>
 #include <iostream>
 #include <string>
-#include <array>
+#include "MeshOptimizer.h"
+#include "GeometryParser.h"
 
 #define TINYOBJLOADER_IMPLEMENTATION // add this to exactly 1 of your C++ files
 #include <tiny_obj_loader.h>
@@ -57,131 +56,59 @@ bool loadGeometryFromObj(const fs::path& path, RenderSys::VertexBuffer& vertexDa
 	return true;
 }
 
-bool load2DGeometry(const fs::path& path, std::vector<float>& vertexData, std::vector<uint16_t>& indexData) 
+namespace
 {
-    std::ifstream file(path);
-    if (!file.is_open()) {
-        return false;
-    }
 
-    vertexData.clear();
-    indexData.clear();
-
-    enum class Section {
-        None,
-        Points,
-        Indices,
-    };
-    Section currentSection = Section::None;
-
-    float value;
-    uint16_t index;
-    std::string line;
-    while (!file.eof()) {
-        getline(file, line);
-        
-        // overcome the `CRLF` problem
-            if (!line.empty() && line.back() == '\r') {
-              line.pop_back();
-            }
-        
-        if (line == "[points]") {
-            currentSection = Section::Points;
-        }
-        else if (line == "[indices]") {
-            currentSection = Section::Indices;
-        }
-        else if (line[0] == '#' || line.empty()) {
-            // Do nothing, this is a comment
-        }
-        else if (currentSection == Section::Points) {
-            std::istringstream iss(line);
-            // Get x, y, r, g, b
-            for (int i = 0; i < 5; ++i) {
-                iss >> value;
-                vertexData.push_back(value);
-            }
-        }
-        else if (currentSection == Section::Indices) {
-            std::istringstream iss(line);
-            // Get corners #0 #1 and #2
-            for (int i = 0; i < 3; ++i) {
-                iss >> index;
-                indexData.push_back(index);
-            }
-        }
-    }
-    return true;
+void optimizeIndexedGeometry(RenderSys::VertexBuffer& vertexData, std::vector<uint32_t>& indexData)
+{
+	const auto before = RenderSys::MeshOptimizer::AnalyzeVertexCache(indexData.data(), indexData.size());
+	RenderSys::MeshOptimizer::OptimizeOverdraw(indexData.data(), indexData.size(), &vertexData[0].position, sizeof(RenderSys::Vertex));
+	RenderSys::MeshOptimizer::OptimizeVertexFetch(vertexData.vertices, indexData.data(), indexData.size());
+	const auto after = RenderSys::MeshOptimizer::AnalyzeVertexCache(indexData.data(), indexData.size());
+	std::cout << "Geometry: optimized " << vertexData.size() << " vertices, [ACMR=" << before.m_Acmr << " -> " << after.m_Acmr
+				<< "], [ATVR=" << before.m_Atvr << " -> " << after.m_Atvr << "]" << std::endl;
 }
 
-bool load3DGeometry(const fs::path& path, RenderSys::VertexBuffer& vertexData, std::vector<uint32_t>& indexData
-						, int dimensions, bool useColor) 
+}
+
+bool loadGeometryFromObj(const fs::path& path, RenderSys::VertexBuffer& vertexData, std::vector<uint32_t>& indexData)
 {
-	std::ifstream file(path);
-	if (!file.is_open()) {
+	// the parallel parser welds the corners itself, only the order is left to optimize
+	if (!RenderSys::GeometryParser::ParseObj(path, vertexData, indexData))
+	{
 		return false;
 	}
-
-	vertexData.clear();
-	indexData.clear();
-
-	enum class Section {
-		None,
-		Points,
-		Indices,
-	};
-	Section currentSection = Section::None;
-
-	float value;
-	uint16_t index;
-	std::string line;
-	while (!file.eof()) {
-		getline(file, line);
-		if (line == "[points]") {
-			currentSection = Section::Points;
-		}
-		else if (line == "[indices]") {
-			currentSection = Section::Indices;
-		}
-		else if (line[0] == '#' || line.empty()) {
-			// Do nothing, this is a comment
-		}
-		else if (currentSection == Section::Points) {
-			std::istringstream iss(line);
-			// Get x, y, z
-			std::array<float, 3> pos;
-			for (int i = 0; i < dimensions; ++i) {
-				iss >> value;
-				pos[i] = value;
-			}
-
-			RenderSys::Vertex vert;
-			vert.position = glm::make_vec3(pos.data());
-			if (useColor)
-			{
-				// Get r, g, b
-				std::array<float, 3> color;
-				for (int i = 0; i < 3; ++i) {
-					iss >> value;
-					color[i] = value;
-				}
-				vert.color = glm::make_vec3(color.data());
-			}
-			
-			vertexData.vertices.push_back(vert);
-		}
-		else if (currentSection == Section::Indices) {
-			std::istringstream iss(line);
-			// Get corners #0 #1 and #2
-			for (int i = 0; i < 3; ++i) {
-				iss >> index;
-				indexData.push_back(index);
-			}
-		}
+	if (!indexData.empty())
+	{
+		optimizeIndexedGeometry(vertexData, indexData);
 	}
 	return true;
 }
 
+void optimizeGeometry(RenderSys::VertexBuffer& vertexData, std::vector<uint32_t>& indexData)
+{
+	RenderSys::VertexBuffer soup;
+	std::swap(soup.vertices, vertexData.vertices);
+	RenderSys::MeshOptimizer::WeldVertices(soup, vertexData, indexData);
+	if (indexData.empty())
+	{
+		return;
+	}
+	std::cout << "Geometry: welded " << soup.size() << " vertices into " << vertexData.size() << std::endl;
+	optimizeIndexedGeometry(vertexData, indexData);
+}
+
+bool load2DGeometry(const fs::path& path, std::vector<float>& vertexData, std::vector<uint16_t>& indexData) 
+{
+	return RenderSys::GeometryParser::ParseText2D(path, vertexData, indexData);
+}
+
+bool load3DGeometry(const fs::path& path, RenderSys::VertexBuffer& vertexData, std::vector<uint32_t>& indexData
+						, int dimensions, bool useColor) 
+{
+	return RenderSys::GeometryParser::ParseText3D(path, vertexData, indexData, static_cast<uint32_t>(dimensions), useColor);
+}
+
 bool TinyObjLoader::load(const std::string &path)
 {
     tinyobj::attrib_t attrib;
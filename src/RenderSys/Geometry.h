@@ -8,6 +8,7 @@ namespace Geometry
 {
 namespace fs = std::filesystem;
 
+// [points] and [indices] text files, read by RenderSys::GeometryParser
 bool load2DGeometry(const fs::path& path, std::vector<float>& vertexData, std::vector<uint16_t>& indexData);
 bool load3DGeometry(const fs::path& path, RenderSys::VertexBuffer& vertexData, std::vector<uint32_t>& indexData,
 						 int dimensions, bool useColor);
@@ -24,6 +25,11 @@ public:
 };
 
 bool loadGeometryFromObj(const fs::path& path, RenderSys::VertexBuffer& vertexData);
+// parsed in parallel by RenderSys::GeometryParser::ParseObj() into an indexed mesh, reordered like optimizeGeometry()
+bool loadGeometryFromObj(const fs::path& path, RenderSys::VertexBuffer& vertexData, std::vector<uint32_t>& indexData);
+// welds the equal vertices of a triangle soup, e.g. after populateTextureFrameAttributes(), and reorders
+// the triangles and vertices for the vertex cache, overdraw and vertex fetch, see RenderSys::MeshOptimizer
+void optimizeGeometry(RenderSys::VertexBuffer& vertexData, std::vector<uint32_t>& indexData);
 
 template<typename T>
 glm::mat3x3 computeTBN(const T corners[3], const glm::vec3& expectedN)
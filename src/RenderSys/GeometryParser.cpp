@@ -0,0 +1,691 @@
+#include "GeometryParser.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string_view>
+#include "MappedFile.h"
+
+namespace RenderSys
+{
+
+namespace
+{
+
+// Absolute OBJ indices are stored zero based. A relative (negative) index is stored as the element of its chunk it
+// points to, biased by RELATIVE_BIAS as it may point into a previous chunk and marked with RELATIVE_FLAG, until
+// the chunks know how many elements the chunks before them have read.
+constexpr uint32_t NO_INDEX = std::numeric_limits<uint32_t>::max();
+constexpr uint32_t RELATIVE_FLAG = 1u << 31;
+constexpr int64_t RELATIVE_BIAS = int64_t(1) << 30;
+
+constexpr uint32_t VERTEX_GROUP_SIZE = 16384;
+
+struct ObjChunk
+{
+    const char* m_begin = nullptr;
+    const char* m_end = nullptr;
+
+    std::vector<float> m_positions;
+    // empty while no position of the chunk has a color, one per position after that
+    std::vector<float> m_colors;
+    std::vector<float> m_texcoords;
+    std::vector<float> m_normals;
+    // position, texcoord and normal index of every triangle corner
+    std::vector<uint32_t> m_corners;
+    bool m_hasTexcoordIndices = false;
+    bool m_hasNormalIndices = false;
+
+    // the elements of the chunks before this one
+    size_t m_positionBase = 0;
+    size_t m_texcoordBase = 0;
+    size_t m_normalBase = 0;
+    size_t m_cornerBase = 0;
+
+    const char* m_errorLine = nullptr;
+    bool m_indexOutOfRange = false;
+};
+
+bool IsSpace(const char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+const char* SkipSpaces(const char* p, const char* end)
+{
+    while (p < end && IsSpace(*p))
+    {
+        ++p;
+    }
+    return p;
+}
+
+const char* FindLineEnd(const char* p, const char* end)
+{
+    const void* lineEnd = std::memchr(p, '\n', static_cast<size_t>(end - p));
+    return lineEnd ? static_cast<const char*>(lineEnd) : end;
+}
+
+// the Parse functions skip the leading spaces and return the end of the number, nullptr if there is none
+const char* ParseFloat(const char* p, const char* end, float& value)
+{
+    p = SkipSpaces(p, end);
+    if (p < end && *p == '+')
+    {
+        ++p;
+    }
+#if defined(__cpp_lib_to_chars)
+    const auto [next, error] = std::from_chars(p, end, value);
+    return error == std::errc() ? next : nullptr;
+#else
+    // the standard library has no floating point from_chars yet, strtof needs a terminated copy of the token
+    char token[64];
+    size_t length = 0;
+    while (p + length < end && length + 1 < sizeof(token) && !IsSpace(p[length]))
+    {
+        ++length;
+    }
+    std::memcpy(token, p, length);
+    token[length] = '\0';
+    char* tokenEnd = nullptr;
+    value = std::strtof(token, &tokenEnd);
+    return tokenEnd != token ? p + (tokenEnd - token) : nullptr;
+#endif
+}
+
+template<typename T>
+const char* ParseInteger(const char* p, const char* end, T& value)
+{
+    p = SkipSpaces(p, end);
+    if (p < end && *p == '+')
+    {
+        ++p;
+    }
+    const auto [next, error] = std::from_chars(p, end, value);
+    return error == std::errc() ? next : nullptr;
+}
+
+// reads up to maxCount numbers, returns how many there were or -1 if something else follows them
+int ParseFloats(const char* p, const char* end, float* values, const int maxCount)
+{
+    int count = 0;
+    while (count < maxCount)
+    {
+        const char* next = ParseFloat(p, end, values[count]);
+        if (!next)
+        {
+            break;
+        }
+        p = next;
+        ++count;
+    }
+    return SkipSpaces(p, end) == end ? count : -1;
+}
+
+bool EncodeIndex(const int64_t index, const size_t chunkElements, uint32_t& encoded)
+{
+    if (index > 0 && index <= RELATIVE_FLAG)
+    {
+        encoded = static_cast<uint32_t>(index - 1);
+        return true;
+    }
+    const int64_t element = static_cast<int64_t>(chunkElements) + index + RELATIVE_BIAS;
+    if (index < 0 && element >= 0 && element < 2 * RELATIVE_BIAS - 1)
+    {
+        encoded = RELATIVE_FLAG | static_cast<uint32_t>(element);
+        return true;
+    }
+    return false;
+}
+
+bool ResolveIndex(uint32_t& index, const size_t chunkBase, const size_t count)
+{
+    if (index == NO_INDEX)
+    {
+        return true;
+    }
+    const int64_t resolved = (index & RELATIVE_FLAG) ? static_cast<int64_t>(chunkBase + (index & ~RELATIVE_FLAG)) - RELATIVE_BIAS
+                                                     : static_cast<int64_t>(index);
+    if (resolved < 0 || resolved >= static_cast<int64_t>(count))
+    {
+        return false;
+    }
+    index = static_cast<uint32_t>(resolved);
+    return true;
+}
+
+// v, v/vt, v//vn or v/vt/vn corners, triangulated as a fan around the first one
+bool ParseFace(const char* p, const char* end, ObjChunk& chunk)
+{
+    const size_t positionCount = chunk.m_positions.size() / 3;
+    const size_t texcoordCount = chunk.m_texcoords.size() / 2;
+    const size_t normalCount = chunk.m_normals.size() / 3;
+
+    uint32_t first[3];
+    uint32_t previous[3];
+    uint32_t corner[3];
+    uint32_t cornerCount = 0;
+    p = SkipSpaces(p, end);
+    while (p < end)
+    {
+        int64_t index = 0;
+        p = ParseInteger(p, end, index);
+        if (!p || !EncodeIndex(index, positionCount, corner[0]))
+        {
+            return false;
+        }
+        corner[1] = NO_INDEX;
+        corner[2] = NO_INDEX;
+        if (p < end && *p == '/')
+        {
+            ++p;
+            if (p < end && *p != '/')
+            {
+                p = ParseInteger(p, end, index);
+                if (!p || !EncodeIndex(index, texcoordCount, corner[1]))
+                {
+                    return false;
+                }
+                chunk.m_hasTexcoordIndices = true;
+            }
+            if (p < end && *p == '/')
+            {
+                p = ParseInteger(p + 1, end, index);
+                if (!p || !EncodeIndex(index, normalCount, corner[2]))
+                {
+                    return false;
+                }
+                chunk.m_hasNormalIndices = true;
+            }
+        }
+        if (p < end && !IsSpace(*p))
+        {
+            return false;
+        }
+
+        if (cornerCount == 0)
+        {
+            std::copy(corner, corner + 3, first);
+        }
+        else if (cornerCount >= 2)
+        {
+            chunk.m_corners.insert(chunk.m_corners.end(), first, first + 3);
+            chunk.m_corners.insert(chunk.m_corners.end(), previous, previous + 3);
+            chunk.m_corners.insert(chunk.m_corners.end(), corner, corner + 3);
+        }
+        std::copy(corner, corner + 3, previous);
+        ++cornerCount;
+        p = SkipSpaces(p, end);
+    }
+    return cornerCount >= 3;
+}
+
+bool ParseObjLine(const char* p, const char* end, ObjChunk& chunk)
+{
+    const char* keywordEnd = p;
+    while (keywordEnd < end && !IsSpace(*keywordEnd))
+    {
+        ++keywordEnd;
+    }
+    const std::string_view keyword(p, static_cast<size_t>(keywordEnd - p));
+
+    float values[6];
+    if (keyword == "v")
+    {
+        // x y z, x y z w or x y z r g b
+        const int count = ParseFloats(keywordEnd, end, values, 6);
+        if (count != 3 && count != 4 && count != 6)
+        {
+            return false;
+        }
+        if (count == 6 && chunk.m_colors.empty())
+        {
+            chunk.m_colors.assign(chunk.m_positions.size(), 1.0f);
+        }
+        chunk.m_positions.insert(chunk.m_positions.end(), values, values + 3);
+        if (count == 6)
+        {
+            chunk.m_colors.insert(chunk.m_colors.end(), values + 3, values + 6);
+        }
+        else if (!chunk.m_colors.empty())
+        {
+            chunk.m_colors.insert(chunk.m_colors.end(), 3, 1.0f);
+        }
+    }
+    else if (keyword == "vt")
+    {
+        const int count = ParseFloats(keywordEnd, end, values, 3);
+        if (count < 1)
+        {
+            return false;
+        }
+        chunk.m_texcoords.push_back(values[0]);
+        chunk.m_texcoords.push_back(count > 1 ? values[1] : 0.0f);
+    }
+    else if (keyword == "vn")
+    {
+        if (ParseFloats(keywordEnd, end, values, 3) != 3)
+        {
+            return false;
+        }
+        chunk.m_normals.insert(chunk.m_normals.end(), values, values + 3);
+    }
+    else if (keyword == "f")
+    {
+        return ParseFace(keywordEnd, end, chunk);
+    }
+    return true;
+}
+
+void ParseObjChunk(ObjChunk& chunk)
+{
+    const char* p = chunk.m_begin;
+    while (p < chunk.m_end)
+    {
+        const char* lineEnd = FindLineEnd(p, chunk.m_end);
+        if (!ParseObjLine(SkipSpaces(p, lineEnd), lineEnd, chunk))
+        {
+            chunk.m_errorLine = p;
+            return;
+        }
+        p = lineEnd < chunk.m_end ? lineEnd + 1 : chunk.m_end;
+    }
+}
+
+uint32_t HashCorner(const uint32_t* corner)
+{
+    uint32_t hash = corner[0] * 0x9E3779B1u ^ corner[1] * 0x85EBCA77u ^ corner[2] * 0xC2B2AE3Du;
+    return hash ^ (hash >> 15);
+}
+
+size_t CountLines(const char* begin, const char* end)
+{
+    return 1 + static_cast<size_t>(std::count(begin, end, '\n'));
+}
+
+// calls parsePoint or parseIndices with every line of the [points] or [indices] section, without the leading
+// and trailing spaces, empty lines and # comments are skipped
+template<typename PointParser, typename IndexParser>
+bool ParseSections(const std::filesystem::path& path, PointParser&& parsePoint, IndexParser&& parseIndices)
+{
+    MappedFile file;
+    if (!file.Open(path))
+    {
+        return false;
+    }
+
+    enum class Section
+    {
+        None,
+        Points,
+        Indices,
+    };
+    Section currentSection = Section::None;
+
+    const char* p = file.GetData();
+    const char* end = p + file.GetSize();
+    while (p < end)
+    {
+        const char* lineEnd = FindLineEnd(p, end);
+        const char* line = SkipSpaces(p, lineEnd);
+        const char* contentEnd = lineEnd;
+        while (contentEnd > line && IsSpace(contentEnd[-1]))
+        {
+            --contentEnd;
+        }
+        const std::string_view content(line, static_cast<size_t>(contentEnd - line));
+
+        bool parsed = true;
+        if (content == "[points]")
+        {
+            currentSection = Section::Points;
+        }
+        else if (content == "[indices]")
+        {
+            currentSection = Section::Indices;
+        }
+        else if (content.empty() || content[0] == '#')
+        {
+            // Do nothing, this is a comment
+        }
+        else if (currentSection == Section::Points)
+        {
+            parsed = parsePoint(line, contentEnd);
+        }
+        else if (currentSection == Section::Indices)
+        {
+            parsed = parseIndices(line, contentEnd);
+        }
+
+        if (!parsed)
+        {
+            std::cout << "GeometryParser: malformed line " << CountLines(file.GetData(), p) << " of " << path.string() << std::endl;
+            return false;
+        }
+        p = lineEnd < end ? lineEnd + 1 : end;
+    }
+    return true;
+}
+
+template<typename T>
+bool ParseTriangle(const char* p, const char* end, std::vector<T>& indices)
+{
+    // Get corners #0 #1 and #2
+    for (int i = 0; i < 3; ++i)
+    {
+        T index = 0;
+        p = ParseInteger(p, end, index);
+        if (!p)
+        {
+            return false;
+        }
+        indices.push_back(index);
+    }
+    return true;
+}
+
+} // namespace
+
+bool GeometryParser::ParseObj(const std::filesystem::path& path, VertexBuffer& vertices, std::vector<uint32_t>& indices,
+                              JobSystem& jobSystem)
+{
+    MappedFile file;
+    if (!file.Open(path))
+    {
+        return false;
+    }
+    vertices.clear();
+    indices.clear();
+
+    // every chunk ends with the line that crosses its CHUNK_SIZE bytes
+    const char* data = file.GetData();
+    const size_t size = file.GetSize();
+    std::vector<ObjChunk> chunks;
+    chunks.reserve(size / CHUNK_SIZE + 1);
+    for (size_t begin = 0; begin < size;)
+    {
+        size_t end = std::min(begin + CHUNK_SIZE, size);
+        if (end < size)
+        {
+            end = std::min(static_cast<size_t>(FindLineEnd(data + end - 1, data + size) - data) + 1, size);
+        }
+        auto& chunk = chunks.emplace_back();
+        chunk.m_begin = data + begin;
+        chunk.m_end = data + end;
+        begin = end;
+    }
+    const uint32_t chunkCount = static_cast<uint32_t>(chunks.size());
+
+    jobSystem.ParallelFor(chunkCount, 1, [&chunks](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            ParseObjChunk(chunks[i]);
+        }
+    });
+
+    size_t positionCount = 0;
+    size_t texcoordCount = 0;
+    size_t normalCount = 0;
+    size_t cornerCount = 0;
+    bool hasColors = false;
+    bool hasTexcoordIndices = false;
+    bool hasNormalIndices = false;
+    for (auto& chunk : chunks)
+    {
+        if (chunk.m_errorLine)
+        {
+            std::cout << "GeometryParser: malformed line " << CountLines(data, chunk.m_errorLine) << " of " << path.string() << std::endl;
+            return false;
+        }
+        chunk.m_positionBase = positionCount;
+        chunk.m_texcoordBase = texcoordCount;
+        chunk.m_normalBase = normalCount;
+        chunk.m_cornerBase = cornerCount;
+        positionCount += chunk.m_positions.size() / 3;
+        texcoordCount += chunk.m_texcoords.size() / 2;
+        normalCount += chunk.m_normals.size() / 3;
+        cornerCount += chunk.m_corners.size() / 3;
+        hasColors = hasColors || !chunk.m_colors.empty();
+        hasTexcoordIndices = hasTexcoordIndices || chunk.m_hasTexcoordIndices;
+        hasNormalIndices = hasNormalIndices || chunk.m_hasNormalIndices;
+    }
+    if (positionCount >= NO_INDEX || cornerCount >= NO_INDEX)
+    {
+        std::cout << "GeometryParser: " << path.string() << " has too many vertices for 32 bit indices" << std::endl;
+        return false;
+    }
+
+    // resolve the indices and gather the elements of all chunks
+    std::vector<float> positions(3 * positionCount);
+    std::vector<float> colors(hasColors ? 3 * positionCount : 0);
+    std::vector<float> texcoords(2 * texcoordCount);
+    std::vector<float> normals(3 * normalCount);
+    jobSystem.ParallelFor(chunkCount, 1, [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            auto& chunk = chunks[i];
+            for (size_t corner = 0; corner < chunk.m_corners.size(); corner += 3)
+            {
+                if (!ResolveIndex(chunk.m_corners[corner], chunk.m_positionBase, positionCount) ||
+                    !ResolveIndex(chunk.m_corners[corner + 1], chunk.m_texcoordBase, texcoordCount) ||
+                    !ResolveIndex(chunk.m_corners[corner + 2], chunk.m_normalBase, normalCount))
+                {
+                    chunk.m_indexOutOfRange = true;
+                    break;
+                }
+            }
+
+            std::copy(chunk.m_positions.begin(), chunk.m_positions.end(), positions.begin() + 3 * chunk.m_positionBase);
+            std::copy(chunk.m_texcoords.begin(), chunk.m_texcoords.end(), texcoords.begin() + 2 * chunk.m_texcoordBase);
+            std::copy(chunk.m_normals.begin(), chunk.m_normals.end(), normals.begin() + 3 * chunk.m_normalBase);
+            if (hasColors && chunk.m_colors.empty())
+            {
+                std::fill_n(colors.begin() + 3 * chunk.m_positionBase, chunk.m_positions.size(), 1.0f);
+            }
+            else
+            {
+                std::copy(chunk.m_colors.begin(), chunk.m_colors.end(), colors.begin() + 3 * chunk.m_positionBase);
+            }
+            chunk.m_positions = std::vector<float>();
+            chunk.m_colors = std::vector<float>();
+            chunk.m_texcoords = std::vector<float>();
+            chunk.m_normals = std::vector<float>();
+        }
+    });
+    for (const auto& chunk : chunks)
+    {
+        if (chunk.m_indexOutOfRange)
+        {
+            std::cout << "GeometryParser: a face of " << path.string() << " refers to a missing vertex" << std::endl;
+            return false;
+        }
+    }
+
+    // position, texcoord and normal index of every vertex
+    std::vector<uint32_t> vertexCorners;
+    uint32_t vertexCount = 0;
+    indices.resize(cornerCount);
+    if (!hasTexcoordIndices && !hasNormalIndices)
+    {
+        // only positions, they are the vertices
+        vertexCount = static_cast<uint32_t>(positionCount);
+        vertexCorners.resize(3 * positionCount, NO_INDEX);
+        for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+        {
+            vertexCorners[3 * vertex] = vertex;
+        }
+        jobSystem.ParallelFor(chunkCount, 1, [&chunks, &indices](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                const auto& chunk = chunks[i];
+                for (size_t corner = 0; corner < chunk.m_corners.size() / 3; ++corner)
+                {
+                    indices[chunk.m_cornerBase + corner] = chunk.m_corners[3 * corner];
+                }
+            }
+        });
+    }
+    else
+    {
+        // open addressing on the corner triplets, kept below half full
+        size_t capacity = 1024;
+        while (capacity < 2 * positionCount)
+        {
+            capacity *= 2;
+        }
+        std::vector<uint32_t> table(capacity, NO_INDEX);
+        vertexCorners.reserve(3 * positionCount);
+        for (const auto& chunk : chunks)
+        {
+            for (size_t corner = 0; corner < chunk.m_corners.size(); corner += 3)
+            {
+                const uint32_t* key = &chunk.m_corners[corner];
+                size_t slot = HashCorner(key) & (capacity - 1);
+                while (table[slot] != NO_INDEX && !std::equal(key, key + 3, &vertexCorners[3 * table[slot]]))
+                {
+                    slot = (slot + 1) & (capacity - 1);
+                }
+                if (table[slot] == NO_INDEX)
+                {
+                    table[slot] = vertexCount++;
+                    vertexCorners.insert(vertexCorners.end(), key, key + 3);
+                }
+                indices[chunk.m_cornerBase + corner / 3] = table[slot];
+
+                if (2 * static_cast<size_t>(vertexCount) > capacity)
+                {
+                    capacity *= 2;
+                    table.assign(capacity, NO_INDEX);
+                    for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+                    {
+                        size_t vertexSlot = HashCorner(&vertexCorners[3 * vertex]) & (capacity - 1);
+                        while (table[vertexSlot] != NO_INDEX)
+                        {
+                            vertexSlot = (vertexSlot + 1) & (capacity - 1);
+                        }
+                        table[vertexSlot] = vertex;
+                    }
+                }
+            }
+        }
+    }
+    chunks.clear();
+
+    vertices.resize(vertexCount);
+    jobSystem.ParallelFor(vertexCount, VERTEX_GROUP_SIZE, [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t vertex = begin; vertex < end; ++vertex)
+        {
+            const uint32_t position = vertexCorners[3 * vertex];
+            const uint32_t texcoord = vertexCorners[3 * vertex + 1];
+            const uint32_t normal = vertexCorners[3 * vertex + 2];
+            Vertex& target = vertices[vertex];
+            target.position = glm::vec3(positions[3 * position], -positions[3 * position + 2], positions[3 * position + 1]);
+            target.normal = normal != NO_INDEX ? glm::vec3(normals[3 * normal], -normals[3 * normal + 2], normals[3 * normal + 1])
+                                               : glm::vec3(0.0f);
+            target.texcoord0 = texcoord != NO_INDEX ? glm::vec2(texcoords[2 * texcoord], 1.0f - texcoords[2 * texcoord + 1])
+                                                    : glm::vec2(0.0f);
+            target.color = hasColors ? glm::make_vec3(&colors[3 * position]) : glm::vec3(1.0f);
+            target.tangent = glm::vec3(0.0f);
+        }
+    });
+
+    // the conversion is a rotation, so the normals of the converted triangles point the same way as the file normals
+    bool missingNormals = false;
+    for (uint32_t vertex = 0; vertex < vertexCount && !missingNormals; ++vertex)
+    {
+        missingNormals = vertexCorners[3 * vertex + 2] == NO_INDEX;
+    }
+    if (missingNormals)
+    {
+        for (size_t corner = 0; corner < indices.size(); corner += 3)
+        {
+            const uint32_t* triangle = &indices[corner];
+            const glm::vec3 faceNormal = glm::cross(vertices[triangle[1]].position - vertices[triangle[0]].position,
+                                                    vertices[triangle[2]].position - vertices[triangle[0]].position);
+            for (int i = 0; i < 3; ++i)
+            {
+                if (vertexCorners[3 * triangle[i] + 2] == NO_INDEX)
+                {
+                    vertices[triangle[i]].normal += faceNormal;
+                }
+            }
+        }
+        for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+        {
+            const float length = glm::length(vertices[vertex].normal);
+            if (vertexCorners[3 * vertex + 2] == NO_INDEX && length > 0.0f)
+            {
+                vertices[vertex].normal /= length;
+            }
+        }
+    }
+    return true;
+}
+
+bool GeometryParser::ParseText2D(const std::filesystem::path& path, std::vector<float>& vertices, std::vector<uint16_t>& indices)
+{
+    vertices.clear();
+    indices.clear();
+    return ParseSections(path,
+        [&vertices](const char* p, const char* end)
+        {
+            // Get x, y, r, g, b
+            for (int i = 0; i < 5; ++i)
+            {
+                float value = 0.0f;
+                p = ParseFloat(p, end, value);
+                if (!p)
+                {
+                    return false;
+                }
+                vertices.push_back(value);
+            }
+            return true;
+        },
+        [&indices](const char* p, const char* end) { return ParseTriangle(p, end, indices); });
+}
+
+bool GeometryParser::ParseText3D(const std::filesystem::path& path, VertexBuffer& vertices, std::vector<uint32_t>& indices,
+                                 const uint32_t dimensions, const bool useColor)
+{
+    if (dimensions < 1 || dimensions > 3)
+    {
+        std::cout << "GeometryParser: points with " << dimensions << " dimensions are not supported" << std::endl;
+        return false;
+    }
+    vertices.clear();
+    indices.clear();
+    return ParseSections(path,
+        [&vertices, dimensions, useColor](const char* p, const char* end)
+        {
+            // Get x, y, z and r, g, b
+            float values[6] = {};
+            const uint32_t count = useColor ? dimensions + 3 : dimensions;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                p = ParseFloat(p, end, values[i < dimensions ? i : i - dimensions + 3]);
+                if (!p)
+                {
+                    return false;
+                }
+            }
+            Vertex vertex{};
+            vertex.position = glm::make_vec3(values);
+            if (useColor)
+            {
+                vertex.color = glm::make_vec3(values + 3);
+            }
+            vertices.vertices.push_back(vertex);
+            return true;
+        },
+        [&indices](const char* p, const char* end) { return ParseTriangle(p, end, indices); });
+}
+
+} // namespace RenderSys
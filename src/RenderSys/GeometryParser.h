@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+#include <filesystem>
+#include <vector>
+#include "Buffer.h"
+#include "JobSystem.h"
+
+namespace RenderSys
+{
+
+// Load time parsers of the text geometry formats, they read a MappedFile and convert the numbers with std::from_chars
+// instead of going through iostreams. ParseObj() splits the file at line boundaries into chunks of CHUNK_SIZE bytes
+// and parses them in parallel on the JobSystem, then merges the chunks into one indexed mesh.
+class GeometryParser
+{
+public:
+    // a file of one chunk is parsed on the calling thread
+    static constexpr size_t CHUNK_SIZE = 1 << 20;
+
+    // Reads the v, vt, vn and f lines of all objects and groups, polygons are triangulated as fans and the corners with
+    // the same position, texcoord and normal become one vertex. Positions and normals are converted like
+    // Geometry::loadGeometryFromObj(), (x, y, z) -> (x, -z, y), the v texture coordinate is flipped and the colors of
+    // "v x y z r g b" lines are read, white otherwise. Vertices without a normal get the area weighted normal of
+    // their triangles. Materials, lines and points are ignored.
+    static bool ParseObj(const std::filesystem::path& path, VertexBuffer& vertices, std::vector<uint32_t>& indices,
+                         JobSystem& jobSystem = JobSystem::Get());
+
+    // the [points] and [indices] sections of Geometry::load2DGeometry(), x y r g b per point
+    static bool ParseText2D(const std::filesystem::path& path, std::vector<float>& vertices, std::vector<uint16_t>& indices);
+    // the sections of Geometry::load3DGeometry(), dimensions coordinates and, with useColor, r g b per point
+    static bool ParseText3D(const std::filesystem::path& path, VertexBuffer& vertices, std::vector<uint32_t>& indices,
+                            const uint32_t dimensions, const bool useColor);
+};
+
+} // namespace RenderSys
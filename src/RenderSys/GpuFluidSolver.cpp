@@ -0,0 +1,395 @@
+#include "GpuFluidSolver.h"
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+#include <resources/Shaders/ShaderResource.h>
+
+namespace RenderSys
+{
+
+namespace
+{
+
+// the kernels in the order of LoadKernel()
+enum Kernel : uint32_t
+{
+    KERNEL_SPLAT,
+    KERNEL_LINEAR_SOLVE,
+    KERNEL_BOUNDARY,
+    KERNEL_ADVECT,
+    KERNEL_DIVERGENCE,
+    KERNEL_GRADIENT,
+};
+
+// the same iterations as FluidSolver2D
+constexpr uint32_t LINEAR_SOLVE_ITERATIONS = 4;
+
+// the push constants of the fluid-*-compute.glsl kernels
+
+struct SplatParameters
+{
+    uint32_t m_First;
+    uint32_t m_Count;
+};
+static_assert(sizeof(SplatParameters) == 8);
+
+struct LinearSolveParameters
+{
+    int32_t m_Size[3];
+    int32_t m_Color;
+    uint32_t m_X;
+    uint32_t m_X0;
+    float m_A;
+    float m_CRecip;
+};
+static_assert(sizeof(LinearSolveParameters) == 32);
+
+struct BoundaryParameters
+{
+    int32_t m_Size[3];
+    int32_t m_Boundary;
+    uint32_t m_X;
+    int32_t m_BoundaryAxes;
+};
+static_assert(sizeof(BoundaryParameters) == 24);
+
+struct AdvectParameters
+{
+    int32_t m_Size[3];
+    float m_Dt0;
+    uint32_t m_D;
+    uint32_t m_D0;
+    uint32_t m_VelocityX;
+    uint32_t m_VelocityY;
+    uint32_t m_VelocityZ;
+};
+static_assert(sizeof(AdvectParameters) == 36);
+
+struct DivergenceParameters
+{
+    int32_t m_Size[3];
+    float m_H;
+    uint32_t m_VelocityX;
+    uint32_t m_VelocityY;
+    uint32_t m_VelocityZ;
+    uint32_t m_P;
+    uint32_t m_Div;
+};
+static_assert(sizeof(DivergenceParameters) == 36);
+
+struct GradientParameters
+{
+    int32_t m_Size[3];
+    uint32_t m_P;
+    uint32_t m_VelocityX;
+    uint32_t m_VelocityY;
+    uint32_t m_VelocityZ;
+};
+static_assert(sizeof(GradientParameters) == 28);
+
+void LoadKernel(Compute& compute, const std::string& fileName)
+{
+    const auto shaderDir = std::string(RENDERSYS_SHADER_DIR);
+    std::ifstream file(shaderDir + "/" + fileName, std::ios::binary);
+    std::vector<char> content((std::istreambuf_iterator<char>(file)),
+                                std::istreambuf_iterator<char>());
+    if (!file.is_open())
+    {
+        std::cout << "Error: unable to open file - " << fileName << std::endl;
+        assert(false);
+        return;
+    }
+
+    Shader shader(fileName, std::string(content.data(), content.size()));
+    shader.type = ShaderType::SPIRV;
+    shader.stage = ShaderStage::Compute;
+    shader.SetIncludeDirectory(shaderDir);
+    compute.SetShader(shader);
+}
+
+uint32_t WorkgroupCount(const uint32_t invocations)
+{
+    return (invocations + FLUID_WORKGROUP_SIZE - 1) / FLUID_WORKGROUP_SIZE;
+}
+
+// the sources buffer has a part of MAX_SOURCES for every pass in flight
+constexpr uint32_t SOURCE_BUFFER_PARTS = Compute::MAX_PASSES_IN_FLIGHT;
+
+} // namespace
+
+GpuFluidSolver::GpuFluidSolver(const uint32_t size, const uint32_t depth, const float diffusion, const float viscosity)
+    : m_size(size)
+    , m_depth(depth)
+    , m_diffusion(diffusion)
+    , m_viscosity(viscosity)
+    , m_compute(std::make_unique<Compute>())
+{
+    assert(size >= 3);
+    assert(depth == 1 || depth == size);
+
+    m_compute->Init();
+    LoadKernel(*m_compute, "fluid-splat-compute.glsl");
+    LoadKernel(*m_compute, "fluid-lin-solve-compute.glsl");
+    LoadKernel(*m_compute, "fluid-set-bnd-compute.glsl");
+    LoadKernel(*m_compute, "fluid-advect-compute.glsl");
+    LoadKernel(*m_compute, "fluid-divergence-compute.glsl");
+    LoadKernel(*m_compute, "fluid-gradient-compute.glsl");
+
+    const uint32_t fieldCount = Is3D() ? 8 : 6;
+    m_compute->CreateBuffer(0, fieldCount * GetCellCount() * sizeof(float), ComputeBuf::BufferType::Storage);
+    m_compute->CreateBuffer(1, SOURCE_BUFFER_PARTS * MAX_SOURCES * sizeof(Source), ComputeBuf::BufferType::Input);
+
+    std::vector<BindGroupLayoutEntry> bindingLayoutEntries(2);
+    bindingLayoutEntries[0].setDefault();
+    bindingLayoutEntries[0].binding = 0;
+    bindingLayoutEntries[0].buffer.type = BufferBindingType::Storage;
+    bindingLayoutEntries[0].buffer.bufferName = "FLUID_FIELDS";
+    bindingLayoutEntries[0].visibility = ShaderStage::Compute;
+    bindingLayoutEntries[1].setDefault();
+    bindingLayoutEntries[1].binding = 1;
+    bindingLayoutEntries[1].buffer.type = BufferBindingType::ReadOnlyStorage;
+    bindingLayoutEntries[1].buffer.bufferName = "FLUID_SOURCES";
+    bindingLayoutEntries[1].visibility = ShaderStage::Compute;
+    m_compute->CreateBindGroup(bindingLayoutEntries);
+    m_compute->CreatePipeline();
+}
+
+GpuFluidSolver::~GpuFluidSolver()
+{
+    m_compute->Destroy();
+}
+
+void GpuFluidSolver::AddDensity(const uint32_t x, const uint32_t y, const uint32_t z, const float amount)
+{
+    assert(x < m_size && y < m_size && z < m_depth);
+    const uint32_t index = x + m_size * (y + m_size * z);
+    m_sources.push_back({FieldOffset(Field::Density) + index, amount});
+}
+
+void GpuFluidSolver::AddVelocity(const uint32_t x, const uint32_t y, const uint32_t z, const float amountX, const float amountY, const float amountZ)
+{
+    assert(x < m_size && y < m_size && z < m_depth);
+    const uint32_t index = x + m_size * (y + m_size * z);
+    m_sources.push_back({FieldOffset(Field::VelocityX) + index, amountX});
+    m_sources.push_back({FieldOffset(Field::VelocityY) + index, amountY});
+    if (Is3D())
+    {
+        m_sources.push_back({FieldOffset(Field::VelocityZ) + index, amountZ});
+    }
+}
+
+ComputeTicket GpuFluidSolver::Step(const float dt)
+{
+    m_dispatchCount = 0;
+    m_compute->BeginComputePass();
+
+    m_compute->BeginProfileScope("Sources");
+    if (!m_sources.empty())
+    {
+        // the sources of a cell summed up, so that no two invocations of the dispatch add to the same value
+        std::sort(m_sources.begin(), m_sources.end(), [](const Source& a, const Source& b) { return a.m_Index < b.m_Index; });
+        size_t count = 0;
+        for (const Source& source : m_sources)
+        {
+            if (count > 0 && m_sources[count - 1].m_Index == source.m_Index)
+            {
+                m_sources[count - 1].m_Amount += source.m_Amount;
+            }
+            else
+            {
+                m_sources[count++] = source;
+            }
+        }
+        if (count > MAX_SOURCES)
+        {
+            std::cout << "Error: " << count - MAX_SOURCES << " fluid sources beyond " << MAX_SOURCES << " are dropped!" << std::endl;
+            count = MAX_SOURCES;
+        }
+
+        // BeginComputePass() waited for the pass that read this part of the buffer
+        const uint32_t first = static_cast<uint32_t>(m_stepCount % SOURCE_BUFFER_PARTS) * MAX_SOURCES;
+        m_compute->SetBufferData(1, m_sources.data(), static_cast<uint32_t>(count * sizeof(Source)), first * sizeof(Source));
+        const SplatParameters params{first, static_cast<uint32_t>(count)};
+        const uint32_t workgroupCount = static_cast<uint32_t>((count + FLUID_SPLAT_WORKGROUP_SIZE - 1) / FLUID_SPLAT_WORKGROUP_SIZE);
+        Dispatch(KERNEL_SPLAT, workgroupCount, 1, 1, &params, sizeof(params));
+        m_sources.clear();
+    }
+    m_compute->EndProfileScope();
+    m_stepCount++;
+
+    // the velocity step of FluidSolver2D, Vx0/Vy0/Vz0 diffused and projected, advected into Vx/Vy/Vz and projected
+    m_compute->BeginProfileScope("Velocity");
+    Diffuse(1, Field::VelocityX0, Field::VelocityX, m_viscosity, dt);
+    Diffuse(2, Field::VelocityY0, Field::VelocityY, m_viscosity, dt);
+    if (Is3D())
+    {
+        Diffuse(3, Field::VelocityZ0, Field::VelocityZ, m_viscosity, dt);
+    }
+    Project(Field::VelocityX0, Field::VelocityY0, Field::VelocityZ0, Field::VelocityX, Field::VelocityY);
+    Advect(1, Field::VelocityX, Field::VelocityX0, Field::VelocityX0, Field::VelocityY0, Field::VelocityZ0, dt);
+    Advect(2, Field::VelocityY, Field::VelocityY0, Field::VelocityX0, Field::VelocityY0, Field::VelocityZ0, dt);
+    if (Is3D())
+    {
+        Advect(3, Field::VelocityZ, Field::VelocityZ0, Field::VelocityX0, Field::VelocityY0, Field::VelocityZ0, dt);
+    }
+    Project(Field::VelocityX, Field::VelocityY, Field::VelocityZ, Field::VelocityX0, Field::VelocityY0);
+    m_compute->EndProfileScope();
+
+    // the density step
+    m_compute->BeginProfileScope("Density");
+    Diffuse(0, Field::Density0, Field::Density, m_diffusion, dt);
+    Advect(0, Field::Density, Field::Density0, Field::VelocityX, Field::VelocityY, Field::VelocityZ, dt);
+    m_compute->EndProfileScope();
+
+    if (m_readbackRequested)
+    {
+        // the only readback of the step, so its index is 0
+        m_compute->RequestReadback(0, FieldOffset(m_readbackField) * sizeof(float), GetCellCount() * sizeof(float));
+        m_readbackRequested = false;
+    }
+    return m_compute->Submit();
+}
+
+void GpuFluidSolver::ReadField(const Field field, std::vector<float>& values)
+{
+    values.resize(GetCellCount());
+    m_compute->ReadBuffer(0, values.data(), FieldOffset(field) * sizeof(float), GetCellCount() * sizeof(float));
+}
+
+void GpuFluidSolver::RequestReadback(const Field field)
+{
+    m_readbackField = field;
+    m_readbackRequested = true;
+}
+
+const float* GpuFluidSolver::GetReadback(const ComputeTicket ticket)
+{
+    return static_cast<const float*>(m_compute->GetReadback(ticket, 0));
+}
+
+uint32_t GpuFluidSolver::FieldOffset(const Field field) const
+{
+    const uint32_t fieldIndex = static_cast<uint32_t>(field);
+    if (!Is3D() && fieldIndex >= static_cast<uint32_t>(Field::VelocityZ))
+    {
+        // the kernels never read it on a 2D grid
+        return 0;
+    }
+    return fieldIndex * GetCellCount();
+}
+
+void GpuFluidSolver::Diffuse(const int b, const Field x, const Field x0, const float diff, const float dt)
+{
+    const int N = m_size;
+    const float a = dt * diff * (N - 2) * (N - 2);
+    LinearSolve(b, x, x0, a, 1 + (Is3D() ? 6 : 4) * a);
+}
+
+void GpuFluidSolver::LinearSolve(const int b, const Field x, const Field x0, const float a, const float c)
+{
+    LinearSolveParameters params{};
+    params.m_Size[0] = m_size;
+    params.m_Size[1] = m_size;
+    params.m_Size[2] = m_depth;
+    params.m_X = FieldOffset(x);
+    params.m_X0 = FieldOffset(x0);
+    params.m_A = a;
+    params.m_CRecip = 1.0f / c;
+    // every second inner cell of a row
+    const uint32_t cellsX = (m_size - 2 + 1) / 2;
+    for (uint32_t k = 0; k < LINEAR_SOLVE_ITERATIONS; k++)
+    {
+        for (int color = 0; color < 2; color++)
+        {
+            params.m_Color = color;
+            DispatchInner(KERNEL_LINEAR_SOLVE, cellsX, &params, sizeof(params));
+        }
+        SetBoundary(b, x);
+    }
+}
+
+void GpuFluidSolver::SetBoundary(const int b, const Field x)
+{
+    BoundaryParameters params{};
+    params.m_Size[0] = m_size;
+    params.m_Size[1] = m_size;
+    params.m_Size[2] = m_depth;
+    params.m_Boundary = b;
+    params.m_X = FieldOffset(x);
+    // the walls, then the edges and the corners, each averages cells of the dispatch before
+    const int dimensions = Is3D() ? 3 : 2;
+    for (int boundaryAxes = 1; boundaryAxes <= dimensions; boundaryAxes++)
+    {
+        params.m_BoundaryAxes = boundaryAxes;
+        Dispatch(KERNEL_BOUNDARY, WorkgroupCount(m_size), WorkgroupCount(Is3D() ? m_size : 1), 2 * dimensions, &params, sizeof(params));
+    }
+}
+
+void GpuFluidSolver::Advect(const int b, const Field d, const Field d0, const Field velocityX, const Field velocityY, const Field velocityZ, const float dt)
+{
+    AdvectParameters params{};
+    params.m_Size[0] = m_size;
+    params.m_Size[1] = m_size;
+    params.m_Size[2] = m_depth;
+    params.m_Dt0 = dt * m_size;
+    params.m_D = FieldOffset(d);
+    params.m_D0 = FieldOffset(d0);
+    params.m_VelocityX = FieldOffset(velocityX);
+    params.m_VelocityY = FieldOffset(velocityY);
+    params.m_VelocityZ = FieldOffset(velocityZ);
+    DispatchInner(KERNEL_ADVECT, m_size - 2, &params, sizeof(params));
+    SetBoundary(b, d);
+}
+
+void GpuFluidSolver::Project(const Field velocityX, const Field velocityY, const Field velocityZ, const Field p, const Field div)
+{
+    DivergenceParameters divergenceParams{};
+    divergenceParams.m_Size[0] = m_size;
+    divergenceParams.m_Size[1] = m_size;
+    divergenceParams.m_Size[2] = m_depth;
+    divergenceParams.m_H = 1.0 / m_size;
+    divergenceParams.m_VelocityX = FieldOffset(velocityX);
+    divergenceParams.m_VelocityY = FieldOffset(velocityY);
+    divergenceParams.m_VelocityZ = FieldOffset(velocityZ);
+    divergenceParams.m_P = FieldOffset(p);
+    divergenceParams.m_Div = FieldOffset(div);
+    DispatchInner(KERNEL_DIVERGENCE, m_size - 2, &divergenceParams, sizeof(divergenceParams));
+    SetBoundary(0, div);
+    SetBoundary(0, p);
+    LinearSolve(0, p, div, 1, Is3D() ? 6 : 4);
+
+    GradientParameters gradientParams{};
+    gradientParams.m_Size[0] = m_size;
+    gradientParams.m_Size[1] = m_size;
+    gradientParams.m_Size[2] = m_depth;
+    gradientParams.m_P = FieldOffset(p);
+    gradientParams.m_VelocityX = FieldOffset(velocityX);
+    gradientParams.m_VelocityY = FieldOffset(velocityY);
+    gradientParams.m_VelocityZ = FieldOffset(velocityZ);
+    DispatchInner(KERNEL_GRADIENT, m_size - 2, &gradientParams, sizeof(gradientParams));
+    SetBoundary(1, velocityX);
+    SetBoundary(2, velocityY);
+    if (Is3D())
+    {
+        SetBoundary(3, velocityZ);
+    }
+}
+
+void GpuFluidSolver::DispatchInner(const uint32_t kernel, const uint32_t cellsX, const void* pushConstants, const uint32_t pushConstantSize)
+{
+    const uint32_t innerDepth = Is3D() ? m_depth - 2 : 1;
+    Dispatch(kernel, WorkgroupCount(cellsX), WorkgroupCount(m_size - 2), innerDepth, pushConstants, pushConstantSize);
+}
+
+void GpuFluidSolver::Dispatch(const uint32_t kernel, const uint32_t x, const uint32_t y, const uint32_t z, const void* pushConstants, const uint32_t pushConstantSize)
+{
+    m_compute->DoCompute(kernel, x, y, z, pushConstants, pushConstantSize);
+    m_dispatchCount++;
+}
+
+} // namespace RenderSys
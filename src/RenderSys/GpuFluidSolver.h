@@ -0,0 +1,98 @@
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+#include "Compute.h"
+
+namespace RenderSys
+{
+
+// The velocity and density steps of the Stam solver of the Fluid2D example ("Real-Time Fluid Dynamics for Games",
+// GDC-2003) as compute kernels, on a square 2D or a cubic 3D grid. All fields stay resident in one Storage buffer,
+// a Step() records its dispatches into one compute pass and nothing is copied back unless ReadField() asks for it.
+// The linear systems are relaxed with red-black Gauss-Seidel, so a 2D grid follows FluidSolver2D with
+// LinearSolver::RedBlackGaussSeidel step by step. Vulkan only, the kernels are GLSL.
+class GpuFluidSolver
+{
+public:
+    // the fields of the grid in the order of the Storage buffer, a 2D grid has no z velocity
+    enum class Field : uint32_t
+    {
+        Density,
+        Density0,
+        VelocityX,
+        VelocityY,
+        VelocityX0,
+        VelocityY0,
+        VelocityZ,
+        VelocityZ0,
+    };
+
+    // size cells along every axis including the boundary, a depth of 1 makes a 2D grid, otherwise it has to be size
+    GpuFluidSolver(const uint32_t size, const uint32_t depth = 1, const float diffusion = 0.0f, const float viscosity = 0.0f);
+    ~GpuFluidSolver();
+
+    GpuFluidSolver(const GpuFluidSolver&) = delete;
+    GpuFluidSolver& operator=(const GpuFluidSolver&) = delete;
+    GpuFluidSolver(GpuFluidSolver&&) = delete;
+    GpuFluidSolver& operator=(GpuFluidSolver&&) = delete;
+
+    // sources added to every cell and field of one step, the ones beyond are dropped and reported
+    static constexpr uint32_t MAX_SOURCES = 1 << 16;
+
+    // the sources are queued and added at the beginning of the next Step() with one dispatch, z is 0 on a 2D grid
+    void AddDensity(const uint32_t x, const uint32_t y, const uint32_t z, const float amount);
+    void AddVelocity(const uint32_t x, const uint32_t y, const uint32_t z, const float amountX, const float amountY, const float amountZ = 0.0f);
+    // submits the dispatches of one step, does not wait for them
+    ComputeTicket Step(const float dt = 0.01f);
+    // copies one field back, cell (x, y, z) at x + size * (y + size * z). Waits for the submitted steps
+    void ReadField(const Field field, std::vector<float>& values);
+    // copies a field back at the end of the next Step() without stalling it, GetReadback() with its ticket
+    // returns the cells once the step has completed, while the steps after it run
+    void RequestReadback(const Field field);
+    const float* GetReadback(const ComputeTicket ticket);
+
+    uint32_t GetSize() const { return m_size; }
+    uint32_t GetDepth() const { return m_depth; }
+    uint32_t GetCellCount() const { return m_size * m_size * m_depth; }
+    // dispatches recorded by the last Step()
+    uint32_t GetDispatchCount() const { return m_dispatchCount; }
+    // a frame per Step(), with the sources, the velocity and the density step as scopes
+    GpuProfiler* GetGpuProfiler() { return m_compute->GetGpuProfiler(); }
+
+private:
+    struct Source
+    {
+        uint32_t m_Index;
+        float m_Amount;
+    };
+
+    bool Is3D() const { return m_depth > 1; }
+    // the offset of a field in the Storage buffer in floats, the z velocity of a 2D grid aliases the density
+    uint32_t FieldOffset(const Field field) const;
+    void Diffuse(const int b, const Field x, const Field x0, const float diff, const float dt);
+    void LinearSolve(const int b, const Field x, const Field x0, const float a, const float c);
+    void SetBoundary(const int b, const Field x);
+    void Advect(const int b, const Field d, const Field d0, const Field velocityX, const Field velocityY, const Field velocityZ, const float dt);
+    void Project(const Field velocityX, const Field velocityY, const Field velocityZ, const Field p, const Field div);
+    // the inner cells, FLUID_WORKGROUP_SIZE x FLUID_WORKGROUP_SIZE x 1 per workgroup
+    void DispatchInner(const uint32_t kernel, const uint32_t cellsX, const void* pushConstants, const uint32_t pushConstantSize);
+    void Dispatch(const uint32_t kernel, const uint32_t x, const uint32_t y, const uint32_t z, const void* pushConstants, const uint32_t pushConstantSize);
+
+    const uint32_t m_size;
+    const uint32_t m_depth;
+    const float m_diffusion;
+    const float m_viscosity;
+    std::unique_ptr<Compute> m_compute;
+    std::vector<Source> m_sources;
+    // Step() calls so far, selects the part of the sources buffer that no pass in flight reads
+    uint64_t m_stepCount = 0;
+    // the field that RequestReadback() asked for, copied back by the next Step()
+    Field m_readbackField = Field::Density;
+    bool m_readbackRequested = false;
+    uint32_t m_dispatchCount = 0;
+};
+
+} // namespace RenderSys
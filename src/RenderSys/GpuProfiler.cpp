@@ -0,0 +1,213 @@
+#include "GpuProfiler.h"
+
+#include <imgui.h>
+
+#include <cfloat>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <unordered_map>
+
+namespace RenderSys
+{
+
+namespace
+{
+
+std::string EscapeJson(const std::string& text)
+{
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (const char character : text)
+    {
+        if (character == '"' || character == '\\')
+        {
+            escaped += '\\';
+            escaped += character;
+        }
+        else if (static_cast<unsigned char>(character) < 0x20)
+        {
+            escaped += ' ';
+        }
+        else
+        {
+            escaped += character;
+        }
+    }
+    return escaped;
+}
+
+void WriteTraceEvent(std::ofstream& file, bool& firstEvent, const std::string& name, const char* category, const size_t process,
+                        const uint32_t thread, const double beginMs, const double durationMs, const uint64_t frame, const GpuProfileCounters& counters)
+{
+    file << (firstEvent ? "\n" : ",\n");
+    firstEvent = false;
+    // microseconds
+    file << "{\"name\":\"" << EscapeJson(name) << "\",\"cat\":\"" << category << "\",\"ph\":\"X\",\"pid\":" << process
+            << ",\"tid\":" << thread << ",\"ts\":" << beginMs * 1000.0 << ",\"dur\":" << durationMs * 1000.0
+            << ",\"args\":{\"frame\":" << frame << ",\"draws\":" << counters.m_Draws << ",\"triangles\":" << counters.m_Triangles
+            << ",\"dispatches\":" << counters.m_Dispatches << "}}";
+}
+
+void WriteTraceName(std::ofstream& file, bool& firstEvent, const char* type, const size_t process, const uint32_t thread, const std::string& name)
+{
+    file << (firstEvent ? "\n" : ",\n");
+    firstEvent = false;
+    file << "{\"name\":\"" << type << "\",\"ph\":\"M\",\"pid\":" << process << ",\"tid\":" << thread
+            << ",\"args\":{\"name\":\"" << EscapeJson(name) << "\"}}";
+}
+
+} // namespace
+
+GpuProfiler::GpuProfiler(const std::string& name)
+    : m_name(name)
+    , m_traceFileName(name + "-trace.json")
+{
+}
+
+void GpuProfiler::AddFrame(GpuProfileFrame&& frame)
+{
+    if (m_paused)
+    {
+        return;
+    }
+    if (m_frames.size() == HISTORY_SIZE)
+    {
+        m_frames.pop_front();
+    }
+    m_frames.push_back(std::move(frame));
+}
+
+void GpuProfiler::OnImGuiRender()
+{
+    ImGui::Begin(("GPU Profiler: " + m_name).c_str());
+    bool paused = m_paused;
+    if (ImGui::Checkbox("Pause", &paused))
+    {
+        m_paused = paused;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Write Chrome trace"))
+    {
+        m_traceStatus = WriteChromeTrace(m_traceFileName) ? "written to " + m_traceFileName : "could not write " + m_traceFileName;
+    }
+    if (!m_traceStatus.empty())
+    {
+        ImGui::SameLine();
+        ImGui::TextUnformatted(m_traceStatus.c_str());
+    }
+
+    if (m_frames.empty())
+    {
+        ImGui::Text("No frame resolved yet");
+        ImGui::End();
+        return;
+    }
+
+    // averages of the history, a scope is matched by its name
+    std::unordered_map<std::string, std::pair<double, uint32_t>> scopeGpuTimes;
+    std::vector<float> frameGpuTimes;
+    frameGpuTimes.reserve(m_frames.size());
+    double gpuTimeSum = 0.0;
+    double cpuTimeSum = 0.0;
+    for (const GpuProfileFrame& frame : m_frames)
+    {
+        frameGpuTimes.push_back(frame.m_GpuTimeMs);
+        gpuTimeSum += frame.m_GpuTimeMs;
+        cpuTimeSum += frame.m_CpuTimeMs;
+        for (const GpuProfileScope& scope : frame.m_Scopes)
+        {
+            auto& [timeSum, count] = scopeGpuTimes[scope.m_Name];
+            timeSum += scope.m_GpuTimeMs;
+            count++;
+        }
+    }
+    const float frameCount = static_cast<float>(m_frames.size());
+
+    const GpuProfileFrame& last = m_frames.back();
+    ImGui::Text("Frame %llu: GPU %.3fms, CPU record %.3fms", static_cast<unsigned long long>(last.m_Frame), last.m_GpuTimeMs, last.m_CpuTimeMs);
+    ImGui::Text("Average of %u frames: GPU %.3fms, CPU record %.3fms, %u dropped", static_cast<uint32_t>(m_frames.size()),
+                    static_cast<float>(gpuTimeSum / frameCount), static_cast<float>(cpuTimeSum / frameCount), m_droppedFrames);
+    if (!last.m_HasGpuTimes)
+    {
+        ImGui::Text("The queue has no timestamps, only CPU times are recorded");
+    }
+    ImGui::PlotLines("GPU ms", frameGpuTimes.data(), static_cast<int>(frameGpuTimes.size()), 0, nullptr, 0.0f, FLT_MAX, ImVec2(0.0f, 60.0f));
+
+    if (ImGui::BeginTable("Scopes", 7, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable))
+    {
+        ImGui::TableSetupColumn("Scope");
+        ImGui::TableSetupColumn("GPU ms");
+        ImGui::TableSetupColumn("Average GPU ms");
+        ImGui::TableSetupColumn("CPU ms");
+        ImGui::TableSetupColumn("Draws");
+        ImGui::TableSetupColumn("Triangles");
+        ImGui::TableSetupColumn("Dispatches");
+        ImGui::TableHeadersRow();
+        for (const GpuProfileScope& scope : last.m_Scopes)
+        {
+            const auto& [timeSum, count] = scopeGpuTimes[scope.m_Name];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%*s%s", static_cast<int>(scope.m_Depth * 2), "", scope.m_Name.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", scope.m_GpuTimeMs);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", static_cast<float>(timeSum / count));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", scope.m_CpuTimeMs);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", scope.m_Counters.m_Draws);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", scope.m_Counters.m_Triangles);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", scope.m_Counters.m_Dispatches);
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+
+bool GpuProfiler::WriteChromeTrace(const std::string& fileName) const
+{
+    return WriteChromeTrace(fileName, {this});
+}
+
+bool GpuProfiler::WriteChromeTrace(const std::string& fileName, const std::vector<const GpuProfiler*>& profilers)
+{
+    std::ofstream file(fileName);
+    if (!file.is_open())
+    {
+        std::cout << "Error: could not write the trace " << fileName << std::endl;
+        return false;
+    }
+
+    // the thread 0 of a profiler records the commands, the thread 1 is its GPU queue
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool firstEvent = true;
+    for (size_t process = 0; process < profilers.size(); ++process)
+    {
+        const GpuProfiler& profiler = *profilers[process];
+        WriteTraceName(file, firstEvent, "process_name", process, 0, profiler.GetName());
+        WriteTraceName(file, firstEvent, "thread_name", process, 0, "CPU record");
+        WriteTraceName(file, firstEvent, "thread_name", process, 1, "GPU");
+        for (const GpuProfileFrame& frame : profiler.GetFrames())
+        {
+            for (const GpuProfileScope& scope : frame.m_Scopes)
+            {
+                WriteTraceEvent(file, firstEvent, scope.m_Name, "cpu", process, 0, frame.m_CpuBeginMs + scope.m_CpuBeginMs,
+                                scope.m_CpuTimeMs, frame.m_Frame, scope.m_Counters);
+                if (frame.m_HasGpuTimes)
+                {
+                    WriteTraceEvent(file, firstEvent, scope.m_Name, "gpu", process, 1, frame.m_CpuBeginMs + scope.m_GpuBeginMs,
+                                    scope.m_GpuTimeMs, frame.m_Frame, scope.m_Counters);
+                }
+            }
+        }
+    }
+    file << "\n]}\n";
+    return file.good();
+}
+
+} // namespace RenderSys
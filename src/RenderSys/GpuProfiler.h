@@ -0,0 +1,108 @@
+#pragma once
+
+#include <stdint.h>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace RenderSys
+{
+
+// what was recorded between the begin and the end of a scope
+struct GpuProfileCounters
+{
+    uint32_t m_Draws = 0;
+    // of all instances, at the selected level of detail
+    uint32_t m_Triangles = 0;
+    uint32_t m_Dispatches = 0;
+};
+
+struct GpuProfileScope
+{
+    std::string m_Name;
+    // 0 for the outermost scopes of a frame
+    uint32_t m_Depth = 0;
+    // from the begin of the frame, in the order the scopes began
+    double m_CpuBeginMs = 0.0;
+    float m_CpuTimeMs = 0.0f;
+    double m_GpuBeginMs = 0.0;
+    float m_GpuTimeMs = 0.0f;
+    GpuProfileCounters m_Counters;
+};
+
+// one command buffer, the GPU times are read a few frames after it was submitted
+struct GpuProfileFrame
+{
+    uint64_t m_Frame = 0;
+    // std::chrono::steady_clock, the same for all profilers
+    double m_CpuBeginMs = 0.0;
+    // from the begin of the frame to its submit
+    float m_CpuTimeMs = 0.0f;
+    // from the first timestamp of the frame to the last one
+    float m_GpuTimeMs = 0.0f;
+    // false without timestamp support, the scopes then have CPU times and counters only
+    bool m_HasGpuTimes = false;
+    std::vector<GpuProfileScope> m_Scopes;
+};
+
+// The resolved frames of one timeline, e.g. the render passes of Renderer3D or the passes of a Compute.
+// The backends record the scopes with timestamp queries and add a frame here once its results are available,
+// a frame whose queries are not complete when they are needed again is dropped instead of waiting for it.
+// The GPU scopes of a trace start at the CPU begin of their frame, the two clocks are not calibrated.
+class GpuProfiler
+{
+public:
+    // the frames kept for the panel and the trace
+    static constexpr uint32_t HISTORY_SIZE = 300;
+
+    explicit GpuProfiler(const std::string& name);
+
+    const std::string& GetName() const { return m_name; }
+    void AddFrame(GpuProfileFrame&& frame);
+    void DropFrame() { m_droppedFrames++; }
+    uint32_t GetDroppedFrames() const { return m_droppedFrames; }
+    // the oldest first, empty until the first frame is resolved
+    const std::deque<GpuProfileFrame>& GetFrames() const { return m_frames; }
+    // keeps the frames shown and traced, new ones are dropped
+    void SetPaused(const bool paused) { m_paused = paused; }
+    bool IsPaused() const { return m_paused; }
+
+    // the scopes of the last frame with the average times of the history, and the trace export
+    void OnImGuiRender();
+    // the frames of the history as complete events, for chrome://tracing or Perfetto
+    bool WriteChromeTrace(const std::string& fileName) const;
+    // one process per profiler in the same file, e.g. the renderer next to a compute pass
+    static bool WriteChromeTrace(const std::string& fileName, const std::vector<const GpuProfiler*>& profilers);
+
+private:
+    std::string m_name;
+    std::deque<GpuProfileFrame> m_frames;
+    uint32_t m_droppedFrames = 0;
+    bool m_paused = false;
+    std::string m_traceFileName;
+    std::string m_traceStatus;
+};
+
+// ends the scope of a Renderer3D, a Compute or anything else with BeginProfileScope() and EndProfileScope()
+template<typename Profiled>
+class ScopedGpuMarker
+{
+public:
+    ScopedGpuMarker(Profiled& profiled, const std::string& name)
+        : m_profiled(profiled)
+    {
+        m_profiled.BeginProfileScope(name);
+    }
+    ~ScopedGpuMarker()
+    {
+        m_profiled.EndProfileScope();
+    }
+
+    ScopedGpuMarker(const ScopedGpuMarker&) = delete;
+    ScopedGpuMarker& operator=(const ScopedGpuMarker&) = delete;
+
+private:
+    Profiled& m_profiled;
+};
+
+} // namespace RenderSys
@@ -0,0 +1,52 @@
+#include "HeadlessDevice.h"
+
+#include <iostream>
+
+#if (RENDERER_BACKEND == 1)
+static_assert(false);
+#elif (RENDERER_BACKEND == 2)
+#include "Vulkan/VulkanDevice.h"
+#elif (RENDERER_BACKEND == 3)
+#else
+static_assert(false);
+#endif
+
+namespace RenderSys
+{
+
+bool CreateHeadlessDevice(const HeadlessDeviceSpecification& spec)
+{
+#if (RENDERER_BACKEND == 2)
+    return Vulkan::CreateHeadlessDevice(spec);
+#else
+    std::cout << "Error: a headless device needs the Vulkan backend" << std::endl;
+    return false;
+#endif
+}
+
+void DestroyHeadlessDevice()
+{
+#if (RENDERER_BACKEND == 2)
+    Vulkan::DestroyHeadlessDevice();
+#endif
+}
+
+uint32_t GetValidationErrorCount()
+{
+#if (RENDERER_BACKEND == 2)
+    return Vulkan::GetValidationErrorCount();
+#else
+    return 0;
+#endif
+}
+
+uint32_t GetValidationWarningCount()
+{
+#if (RENDERER_BACKEND == 2)
+    return Vulkan::GetValidationWarningCount();
+#else
+    return 0;
+#endif
+}
+
+} // namespace RenderSys
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace RenderSys
+{
+
+struct HeadlessDeviceSpecification
+{
+    std::string m_ApplicationName = "RenderSys";
+    // the Khronos validation layer, its messages are printed and counted
+    bool m_Validation = false;
+    // also the synchronization validation of the layer, which checks the barriers between the commands
+    bool m_SynchronizationValidation = false;
+};
+
+// Creates the instance and the device without a window, a surface or a Walnut application, e.g. for batch rendering
+// and tests on a software driver. Call it before the first renderer or compute is created, the renderers then use
+// this device instead of the one of the application. Returns false when no device could be created
+bool CreateHeadlessDevice(const HeadlessDeviceSpecification& spec);
+// after the renderers, computes and the memory allocator are destroyed
+void DestroyHeadlessDevice();
+// errors and warnings reported by the validation layer to the headless device
+uint32_t GetValidationErrorCount();
+uint32_t GetValidationWarningCount();
+
+} // namespace RenderSys
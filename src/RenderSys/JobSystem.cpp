@@ -0,0 +1,151 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <memory>
+
+namespace RenderSys
+{
+
+JobSystem::JobSystem(uint32_t workerCount)
+{
+    if (workerCount == DEFAULT_WORKER_COUNT)
+    {
+        const uint32_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+        workerCount = hardwareThreads - 1;
+    }
+
+    m_workers.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; i++)
+    {
+        m_workers.emplace_back([this]() { WorkerLoop(); });
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_jobAvailable.notify_all();
+
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+JobSystem& JobSystem::Get()
+{
+    static JobSystem s_jobSystem;
+    return s_jobSystem;
+}
+
+void JobSystem::Execute(Job job)
+{
+    if (m_workers.empty())
+    {
+        job();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(std::move(job));
+        m_pendingJobs++;
+    }
+    m_jobAvailable.notify_one();
+}
+
+void JobSystem::Wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_jobsDone.wait(lock, [this]() { return m_pendingJobs == 0; });
+}
+
+void JobSystem::ParallelFor(uint32_t count, uint32_t groupSize, const RangeJob& job)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    groupSize = std::max(1u, groupSize);
+    const uint32_t groupCount = (count + groupSize - 1) / groupSize;
+    if (groupCount == 1 || m_workers.empty())
+    {
+        job(0, count);
+        return;
+    }
+
+    // helpers may get scheduled after all groups are done, so the shared state outlives this call
+    struct ParallelForContext
+    {
+        std::atomic<uint32_t> m_nextGroup{0};
+        std::atomic<uint32_t> m_remainingGroups{0};
+        std::mutex m_mutex;
+        std::condition_variable m_done;
+    };
+    auto context = std::make_shared<ParallelForContext>();
+    context->m_remainingGroups = groupCount;
+
+    auto runGroups = [context, count, groupSize, groupCount, &job]()
+    {
+        uint32_t group = context->m_nextGroup.fetch_add(1);
+        while (group < groupCount)
+        {
+            const uint32_t begin = group * groupSize;
+            const uint32_t end = std::min(begin + groupSize, count);
+            job(begin, end);
+
+            if (context->m_remainingGroups.fetch_sub(1) == 1)
+            {
+                std::lock_guard<std::mutex> lock(context->m_mutex);
+                context->m_done.notify_all();
+            }
+            group = context->m_nextGroup.fetch_add(1);
+        }
+    };
+
+    const uint32_t helperCount = std::min(groupCount - 1, GetWorkerCount());
+    for (uint32_t i = 0; i < helperCount; i++)
+    {
+        Execute(runGroups);
+    }
+
+    runGroups();
+
+    std::unique_lock<std::mutex> lock(context->m_mutex);
+    context->m_done.wait(lock, [&context]() { return context->m_remainingGroups.load() == 0; });
+}
+
+void JobSystem::WorkerLoop()
+{
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_jobAvailable.wait(lock, [this]() { return m_stop || !m_jobs.empty(); });
+            if (m_stop && m_jobs.empty())
+            {
+                return;
+            }
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        job();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pendingJobs--;
+            if (m_pendingJobs == 0)
+            {
+                m_jobsDone.notify_all();
+            }
+        }
+    }
+}
+
+} // namespace RenderSys
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace RenderSys
+{
+
+// A small pool of worker threads for data-parallel CPU work (animation, skinning, parsing, ...).
+// The thread calling ParallelFor() takes part in the work, so a pool with zero workers runs serially.
+class JobSystem
+{
+public:
+    using Job = std::function<void()>;
+    using RangeJob = std::function<void(uint32_t begin, uint32_t end)>;
+
+    static constexpr uint32_t DEFAULT_WORKER_COUNT = ~0u; // (hardware threads - 1) workers
+
+    explicit JobSystem(uint32_t workerCount = DEFAULT_WORKER_COUNT);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+    JobSystem(JobSystem&&) = delete;
+    JobSystem& operator=(JobSystem&&) = delete;
+
+    static JobSystem& Get();
+
+    uint32_t GetWorkerCount() const { return static_cast<uint32_t>(m_workers.size()); }
+    uint32_t GetThreadCount() const { return GetWorkerCount() + 1; }
+
+    // fire and forget, use Wait() to block until all queued jobs have finished
+    void Execute(Job job);
+    void Wait();
+
+    // splits [0, count) into groups of groupSize and blocks until every group has been processed
+    void ParallelFor(uint32_t count, uint32_t groupSize, const RangeJob& job);
+
+private:
+    void WorkerLoop();
+
+    std::vector<std::thread> m_workers;
+    std::deque<Job> m_jobs;
+    std::mutex m_mutex;
+    std::condition_variable m_jobAvailable;
+    std::condition_variable m_jobsDone;
+    uint32_t m_pendingJobs = 0;
+    bool m_stop = false;
+};
+
+} // namespace RenderSys
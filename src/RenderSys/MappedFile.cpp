@@ -0,0 +1,129 @@
+#include "MappedFile.h"
+
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace RenderSys
+{
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const std::filesystem::path& path)
+{
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        std::cout << "MappedFile: failed to open " << path.string() << std::endl;
+        return false;
+    }
+    m_file = file;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize))
+    {
+        std::cout << "MappedFile: failed to get the size of " << path.string() << std::endl;
+        Close();
+        return false;
+    }
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+
+    if (m_size > 0)
+    {
+        m_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (m_mapping)
+        {
+            m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        }
+        if (!m_data)
+        {
+            std::cout << "MappedFile: failed to map " << path.string() << std::endl;
+            Close();
+            return false;
+        }
+    }
+#else
+    m_file = open(path.c_str(), O_RDONLY);
+    if (m_file < 0)
+    {
+        std::cout << "MappedFile: failed to open " << path.string() << std::endl;
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(m_file, &fileStat) != 0)
+    {
+        std::cout << "MappedFile: failed to get the size of " << path.string() << std::endl;
+        Close();
+        return false;
+    }
+    m_size = static_cast<size_t>(fileStat.st_size);
+
+    if (m_size > 0)
+    {
+        void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+        if (data == MAP_FAILED)
+        {
+            std::cout << "MappedFile: failed to map " << path.string() << std::endl;
+            Close();
+            return false;
+        }
+        // the whole file is read right away, start loading all pages instead of faulting them in one by one
+        madvise(data, m_size, MADV_WILLNEED);
+        m_data = static_cast<const char*>(data);
+    }
+#endif
+
+    m_isOpen = true;
+    return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+    if (m_data)
+    {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+    if (m_file)
+    {
+        CloseHandle(m_file);
+        m_file = nullptr;
+    }
+#else
+    if (m_data)
+    {
+        munmap(const_cast<char*>(m_data), m_size);
+    }
+    if (m_file >= 0)
+    {
+        close(m_file);
+        m_file = -1;
+    }
+#endif
+    m_data = nullptr;
+    m_size = 0;
+    m_isOpen = false;
+}
+
+} // namespace RenderSys
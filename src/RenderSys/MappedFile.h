@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stddef.h>
+#include <filesystem>
+
+namespace RenderSys
+{
+
+// Read-only memory mapping of a whole file, the pages are loaded on first access and can be read by several threads.
+// An empty file opens successfully with a null GetData().
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&&) = delete;
+    MappedFile& operator=(MappedFile&&) = delete;
+
+    bool Open(const std::filesystem::path& path);
+    void Close();
+
+    bool IsOpen() const { return m_isOpen; }
+    const char* GetData() const { return m_data; }
+    size_t GetSize() const { return m_size; }
+
+private:
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#else
+    int m_file = -1;
+#endif
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+    bool m_isOpen = false;
+};
+
+} // namespace RenderSys
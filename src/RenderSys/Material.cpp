@@ -19,9 +19,17 @@ MaterialDescriptor::MaterialDescriptor()
 {
 }
 
-void MaterialDescriptor::Init(MaterialTextures& textures)
+void MaterialDescriptor::Init(MaterialTextures& textures, const MaterialProperties& properties)
 {
-    m_platformDescriptor = std::make_unique<MaterialDescriptorType>(textures);
+    m_platformDescriptor = std::make_unique<MaterialDescriptorType>(textures, properties);
+}
+
+void MaterialDescriptor::SetMaterialProperties(const MaterialProperties& properties)
+{
+    if (m_platformDescriptor)
+    {
+        m_platformDescriptor->SetMaterialProperties(properties);
+    }
 }
 
 void MaterialDescriptor::Destroy()
@@ -51,11 +59,12 @@ Material::~Material()
 
 void Material::Init()
 {
-    m_MaterialDescriptor->Init(m_materialTextures);
+    m_MaterialDescriptor->Init(m_materialTextures, *m_materialProperties);
 }
 
 void Material::SetMaterialProperties(std::unique_ptr<MaterialProperties> matProps) {
   m_materialProperties = std::move(matProps);
+  m_MaterialDescriptor->SetMaterialProperties(*m_materialProperties);
 }
 
 void Material::SetMaterialTexture(const TextureIndices textureIndex,
@@ -43,6 +43,8 @@ enum class ShaderWorkflow : int32_t
 };
 static_assert(sizeof(ShaderWorkflow) == 4);
 
+class MaterialProperties;
+
 class MaterialDescriptor
 {
 public:
@@ -54,7 +56,8 @@ public:
     MaterialDescriptor(MaterialDescriptor&&) = delete;
     MaterialDescriptor& operator=(MaterialDescriptor&&) = delete;
 
-    void Init(MaterialTextures& textures);
+    void Init(MaterialTextures& textures, const MaterialProperties& properties);
+    void SetMaterialProperties(const MaterialProperties& properties);
     void Destroy();
 
     MaterialDescriptorType* GetPlatformDescriptor() const { return m_platformDescriptor.get(); }
@@ -63,8 +66,6 @@ private:
     ShaderWorkflow m_shaderWorkflow{ShaderWorkflow::PBR_WORKFLOW_METALLIC_ROUGHNESS};
 };
 
-class MaterialProperties;
-
 class Material
 {
 public:
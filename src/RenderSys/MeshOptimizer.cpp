@@ -0,0 +1,390 @@
+#include "MeshOptimizer.h"
+
+#include <cstring>
+#include <unordered_map>
+
+namespace RenderSys
+{
+
+namespace
+{
+
+// the vertex range [m_First, m_First + m_Count) an index range refers to
+struct VertexRange
+{
+    uint32_t m_First = 0;
+    uint32_t m_Count = 0;
+};
+
+VertexRange GetVertexRange(const uint32_t* indices, const size_t indexCount)
+{
+    if (indexCount == 0)
+    {
+        return {};
+    }
+    const auto [minIndex, maxIndex] = std::minmax_element(indices, indices + indexCount);
+    return { *minIndex, *maxIndex - *minIndex + 1 };
+}
+
+// a vertex is in the FIFO cache while fewer than cacheSize misses happened after it was loaded
+class FifoCache
+{
+public:
+    FifoCache(const uint32_t vertexCount, const uint32_t cacheSize)
+        : m_timestamps(vertexCount, 0)
+        , m_time(cacheSize + 1)
+        , m_cacheSize(cacheSize)
+    {}
+
+    // true on a miss
+    bool Access(const uint32_t vertex)
+    {
+        if (m_time - m_timestamps[vertex] > m_cacheSize)
+        {
+            m_timestamps[vertex] = m_time++;
+            return true;
+        }
+        return false;
+    }
+
+    void Reset()
+    {
+        // every vertex falls out of the cache
+        m_time += m_cacheSize + 1;
+    }
+
+private:
+    std::vector<uint32_t> m_timestamps;
+    uint32_t m_time = 0;
+    uint32_t m_cacheSize = 0;
+};
+
+// triangles around each vertex, compressed rows
+struct VertexTriangles
+{
+    std::vector<uint32_t> m_Offsets;
+    std::vector<uint32_t> m_Triangles;
+
+    VertexTriangles(const uint32_t* indices, const size_t indexCount, const VertexRange& range)
+        : m_Offsets(range.m_Count + 1, 0)
+        , m_Triangles(indexCount)
+    {
+        for (size_t i = 0; i < indexCount; ++i)
+        {
+            m_Offsets[indices[i] - range.m_First + 1]++;
+        }
+        for (uint32_t vertex = 0; vertex < range.m_Count; ++vertex)
+        {
+            m_Offsets[vertex + 1] += m_Offsets[vertex];
+        }
+        std::vector<uint32_t> fill(m_Offsets.begin(), m_Offsets.end() - 1);
+        for (size_t i = 0; i < indexCount; ++i)
+        {
+            m_Triangles[fill[indices[i] - range.m_First]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+};
+
+glm::vec3 GetPosition(const void* positions, const size_t positionStride, const uint32_t vertex)
+{
+    glm::vec3 position;
+    std::memcpy(&position, static_cast<const uint8_t*>(positions) + positionStride * vertex, sizeof(position));
+    return position;
+}
+
+struct VertexHash
+{
+    const VertexBuffer& m_Soup;
+
+    size_t operator()(const uint32_t vertex) const
+    {
+        const auto& v = m_Soup[vertex];
+        const float values[] = { v.position.x, v.position.y, v.position.z, v.normal.x, v.normal.y, v.normal.z,
+                                v.texcoord0.x, v.texcoord0.y, v.color.x, v.color.y, v.color.z, v.tangent.x, v.tangent.y, v.tangent.z };
+        size_t hash = 0;
+        for (const float value : values)
+        {
+            // -0 and 0 compare equal, they have to hash equal too
+            uint32_t bits = 0;
+            if (value != 0.0f)
+            {
+                std::memcpy(&bits, &value, sizeof(bits));
+            }
+            hash ^= bits + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        }
+        return hash;
+    }
+};
+
+struct VertexEqual
+{
+    const VertexBuffer& m_Soup;
+
+    bool operator()(const uint32_t a, const uint32_t b) const
+    {
+        const auto& va = m_Soup[a];
+        const auto& vb = m_Soup[b];
+        return va.position == vb.position && va.normal == vb.normal && va.texcoord0 == vb.texcoord0 &&
+                va.color == vb.color && va.tangent == vb.tangent;
+    }
+};
+
+} // namespace
+
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const uint32_t* indices, const size_t indexCount, const uint32_t cacheSize)
+{
+    VertexCacheStats stats;
+    if (indexCount < 3)
+    {
+        return stats;
+    }
+    const auto range = GetVertexRange(indices, indexCount);
+    FifoCache cache(range.m_Count, cacheSize);
+    std::vector<uint8_t> referenced(range.m_Count, 0);
+    uint32_t misses = 0;
+    uint32_t referencedVertices = 0;
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        const uint32_t vertex = indices[i] - range.m_First;
+        misses += cache.Access(vertex) ? 1 : 0;
+        if (!referenced[vertex])
+        {
+            referenced[vertex] = 1;
+            referencedVertices++;
+        }
+    }
+    stats.m_Acmr = static_cast<float>(misses) / static_cast<float>(indexCount / 3);
+    stats.m_Atvr = static_cast<float>(misses) / static_cast<float>(referencedVertices);
+    return stats;
+}
+
+void MeshOptimizer::WeldVertices(const VertexBuffer& soup, VertexBuffer& vertices, std::vector<uint32_t>& indices)
+{
+    vertices.clear();
+    indices.resize(soup.size());
+    std::unordered_map<uint32_t, uint32_t, VertexHash, VertexEqual> uniqueVertices(soup.size(), VertexHash{ soup }, VertexEqual{ soup });
+    for (uint32_t vertex = 0; vertex < soup.size(); ++vertex)
+    {
+        const auto [vertexIter, inserted] = uniqueVertices.try_emplace(vertex, static_cast<uint32_t>(vertices.size()));
+        if (inserted)
+        {
+            vertices.vertices.push_back(soup[vertex]);
+        }
+        indices[vertex] = vertexIter->second;
+    }
+}
+
+void MeshOptimizer::OptimizeVertexCache(uint32_t* indices, const size_t indexCount, const uint32_t cacheSize, std::vector<uint32_t>* clusterStarts)
+{
+    if (clusterStarts)
+    {
+        clusterStarts->clear();
+    }
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    const auto range = GetVertexRange(indices, indexCount);
+    const VertexTriangles vertexTriangles(indices, indexCount, range);
+    // triangles around each vertex which are not emitted yet
+    std::vector<uint32_t> liveTriangles(range.m_Count);
+    for (uint32_t vertex = 0; vertex < range.m_Count; ++vertex)
+    {
+        liveTriangles[vertex] = vertexTriangles.m_Offsets[vertex + 1] - vertexTriangles.m_Offsets[vertex];
+    }
+    std::vector<uint32_t> cacheTimestamps(range.m_Count, 0);
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<uint32_t> deadEndStack;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> output;
+    output.reserve(triangleCount * 3);
+    uint32_t time = cacheSize + 1;
+    uint32_t inputCursor = 0;
+
+    auto local = [&](const size_t i) { return indices[i] - range.m_First; };
+
+    // fans around one vertex at a time, the next one is the candidate which is still in the cache
+    // after its remaining triangles are emitted, or else the most recently used one with triangles left
+    int64_t fanningVertex = local(0);
+    if (clusterStarts)
+    {
+        clusterStarts->push_back(0);
+    }
+    while (fanningVertex >= 0)
+    {
+        candidates.clear();
+        const uint32_t fan = static_cast<uint32_t>(fanningVertex);
+        for (uint32_t offset = vertexTriangles.m_Offsets[fan]; offset < vertexTriangles.m_Offsets[fan + 1]; ++offset)
+        {
+            const uint32_t triangle = vertexTriangles.m_Triangles[offset];
+            if (emitted[triangle])
+            {
+                continue;
+            }
+            for (uint32_t corner = 0; corner < 3; ++corner)
+            {
+                const uint32_t vertex = local(triangle * 3 + corner);
+                output.push_back(indices[triangle * 3 + corner]);
+                deadEndStack.push_back(vertex);
+                candidates.push_back(vertex);
+                liveTriangles[vertex]--;
+                if (time - cacheTimestamps[vertex] > cacheSize)
+                {
+                    cacheTimestamps[vertex] = time++;
+                }
+            }
+            emitted[triangle] = 1;
+        }
+
+        int64_t nextVertex = -1;
+        int64_t bestPriority = -1;
+        for (const uint32_t candidate : candidates)
+        {
+            if (liveTriangles[candidate] == 0)
+            {
+                continue;
+            }
+            int64_t priority = 0;
+            // still in the cache after its triangles are fanned, the oldest one first
+            if (time - cacheTimestamps[candidate] + 2 * liveTriangles[candidate] <= cacheSize)
+            {
+                priority = time - cacheTimestamps[candidate];
+            }
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                nextVertex = candidate;
+            }
+        }
+
+        if (nextVertex < 0)
+        {
+            // dead end, continue at a recently used vertex or the next one in the input order
+            while (!deadEndStack.empty() && nextVertex < 0)
+            {
+                const uint32_t vertex = deadEndStack.back();
+                deadEndStack.pop_back();
+                if (liveTriangles[vertex] > 0)
+                {
+                    nextVertex = vertex;
+                }
+            }
+            while (nextVertex < 0 && inputCursor < indexCount)
+            {
+                const uint32_t vertex = local(inputCursor++);
+                if (liveTriangles[vertex] > 0)
+                {
+                    nextVertex = vertex;
+                    // nothing of the new fan is in the cache
+                    if (clusterStarts && output.size() / 3 < triangleCount)
+                    {
+                        clusterStarts->push_back(static_cast<uint32_t>(output.size() / 3));
+                    }
+                }
+            }
+        }
+        fanningVertex = nextVertex;
+    }
+
+    std::copy(output.begin(), output.end(), indices);
+}
+
+void MeshOptimizer::OptimizeOverdraw(uint32_t* indices, const size_t indexCount, const void* positions, const size_t positionStride, const float threshold)
+{
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount < 2)
+    {
+        return;
+    }
+
+    std::vector<uint32_t> hardClusters;
+    OptimizeVertexCache(indices, indexCount, CACHE_SIZE, &hardClusters);
+    hardClusters.push_back(static_cast<uint32_t>(triangleCount));
+
+    // soft boundaries inside the hard clusters, where starting with a cold cache costs little
+    const auto range = GetVertexRange(indices, indexCount);
+    FifoCache cache(range.m_Count, CACHE_SIZE);
+    std::vector<uint32_t> clusters;
+    for (size_t hardCluster = 0; hardCluster + 1 < hardClusters.size(); ++hardCluster)
+    {
+        const uint32_t begin = hardClusters[hardCluster];
+        const uint32_t end = hardClusters[hardCluster + 1];
+        cache.Reset();
+        uint32_t clusterMisses = 0;
+        for (uint32_t i = begin * 3; i < end * 3; ++i)
+        {
+            clusterMisses += cache.Access(indices[i] - range.m_First) ? 1 : 0;
+        }
+        const float maxAcmr = static_cast<float>(clusterMisses) / static_cast<float>(end - begin) * threshold;
+
+        cache.Reset();
+        clusters.push_back(begin);
+        uint32_t clusterStart = begin;
+        uint32_t misses = 0;
+        for (uint32_t triangle = begin; triangle < end; ++triangle)
+        {
+            for (uint32_t corner = 0; corner < 3; ++corner)
+            {
+                misses += cache.Access(indices[triangle * 3 + corner] - range.m_First) ? 1 : 0;
+            }
+            if (triangle + 1 < end && static_cast<float>(misses) / static_cast<float>(triangle + 1 - clusterStart) <= maxAcmr)
+            {
+                clusterStart = triangle + 1;
+                clusters.push_back(clusterStart);
+                misses = 0;
+                cache.Reset();
+            }
+        }
+    }
+    clusters.push_back(static_cast<uint32_t>(triangleCount));
+
+    // area weighted centroid of the mesh and of each cluster
+    const size_t clusterCount = clusters.size() - 1;
+    std::vector<glm::vec3> clusterCentroids(clusterCount, glm::vec3(0.0f));
+    std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3(0.0f));
+    std::vector<float> clusterAreas(clusterCount, 0.0f);
+    glm::vec3 meshCentroid(0.0f);
+    float meshArea = 0.0f;
+    for (size_t cluster = 0; cluster < clusterCount; ++cluster)
+    {
+        for (uint32_t triangle = clusters[cluster]; triangle < clusters[cluster + 1]; ++triangle)
+        {
+            const glm::vec3 p0 = GetPosition(positions, positionStride, indices[triangle * 3 + 0]);
+            const glm::vec3 p1 = GetPosition(positions, positionStride, indices[triangle * 3 + 1]);
+            const glm::vec3 p2 = GetPosition(positions, positionStride, indices[triangle * 3 + 2]);
+            const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+            const float area = glm::length(normal);
+            const glm::vec3 centroid = (p0 + p1 + p2) / 3.0f;
+            clusterCentroids[cluster] += centroid * area;
+            clusterNormals[cluster] += normal;
+            clusterAreas[cluster] += area;
+        }
+        meshCentroid += clusterCentroids[cluster];
+        meshArea += clusterAreas[cluster];
+    }
+    meshCentroid /= std::max(meshArea, std::numeric_limits<float>::min());
+
+    std::vector<float> sortKeys(clusterCount);
+    std::vector<uint32_t> clusterOrder(clusterCount);
+    for (uint32_t cluster = 0; cluster < clusterCount; ++cluster)
+    {
+        const glm::vec3 centroid = clusterCentroids[cluster] / std::max(clusterAreas[cluster], std::numeric_limits<float>::min());
+        const float normalLength = glm::length(clusterNormals[cluster]);
+        const glm::vec3 normal = normalLength > 0.0f ? clusterNormals[cluster] / normalLength : glm::vec3(0.0f);
+        sortKeys[cluster] = glm::dot(centroid - meshCentroid, normal);
+        clusterOrder[cluster] = cluster;
+    }
+    std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&](const uint32_t a, const uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+    std::vector<uint32_t> output;
+    output.reserve(indexCount);
+    for (const uint32_t cluster : clusterOrder)
+    {
+        output.insert(output.end(), indices + clusters[cluster] * 3, indices + clusters[cluster + 1] * 3);
+    }
+    std::copy(output.begin(), output.end(), indices);
+}
+
+} // namespace RenderSys
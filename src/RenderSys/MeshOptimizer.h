@@ -0,0 +1,92 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include "Buffer.h"
+
+namespace RenderSys
+{
+
+// post-transform cache efficiency of an index buffer
+struct VertexCacheStats
+{
+    // average cache miss ratio, transformed vertices per triangle, between 0.5 and 3
+    float m_Acmr = 0.0f;
+    // average transform to vertex ratio, transformed vertices per referenced vertex, 1 is ideal
+    float m_Atvr = 0.0f;
+};
+
+// Load time optimization of indexed triangle lists, in the order it should run:
+// WeldVertices() for triangle soups, OptimizeOverdraw() (which includes the vertex cache optimization)
+// and OptimizeVertexFetch(). Index ranges may address any part of a larger vertex array.
+class MeshOptimizer
+{
+public:
+    // FIFO cache size of the analysis and optimization, small enough to fit the caches of current GPUs
+    static constexpr uint32_t CACHE_SIZE = 16;
+    // how much the ACMR may grow when the triangles are split into clusters for the overdraw ordering
+    static constexpr float OVERDRAW_THRESHOLD = 1.05f;
+
+    // simulates a FIFO cache of cacheSize vertices
+    static VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, const size_t indexCount, const uint32_t cacheSize = CACHE_SIZE);
+
+    // merges the vertices with equal attributes of a triangle soup, three vertices per triangle
+    static void WeldVertices(const VertexBuffer& soup, VertexBuffer& vertices, std::vector<uint32_t>& indices);
+
+    // Tipsify (Sander, Nehab and Barczak, Fast Triangle Reordering for Vertex Locality and Reduced Overdraw),
+    // clusterStarts receives the first triangle of every cluster that begins with a cold cache
+    static void OptimizeVertexCache(uint32_t* indices, const size_t indexCount, const uint32_t cacheSize = CACHE_SIZE,
+                                    std::vector<uint32_t>* clusterStarts = nullptr);
+    // optimizes the vertex cache, splits the result into clusters while their ACMR stays within threshold
+    // and draws the clusters facing away from the center of the mesh first, they tend to occlude the others
+    // positions points to the position of vertex 0, positionStride is the size of a vertex in bytes
+    static void OptimizeOverdraw(uint32_t* indices, const size_t indexCount, const void* positions, const size_t positionStride,
+                                const float threshold = OVERDRAW_THRESHOLD);
+
+    // sorts the referenced vertices by their first use and rewrites the indices, vertices the indices
+    // do not reference move behind the used ones of the same range, returns the number of used vertices
+    template<typename T>
+    static uint32_t OptimizeVertexFetch(std::vector<T>& vertices, uint32_t* indices, const size_t indexCount)
+    {
+        if (indexCount == 0)
+        {
+            return 0;
+        }
+        const auto [minIndex, maxIndex] = std::minmax_element(indices, indices + indexCount);
+        const uint32_t firstVertex = *minIndex;
+        const uint32_t vertexCount = *maxIndex - firstVertex + 1;
+
+        constexpr uint32_t UNUSED = std::numeric_limits<uint32_t>::max();
+        std::vector<uint32_t> remap(vertexCount, UNUSED);
+        uint32_t nextVertex = 0;
+        for (size_t i = 0; i < indexCount; ++i)
+        {
+            auto& newVertex = remap[indices[i] - firstVertex];
+            if (newVertex == UNUSED)
+            {
+                newVertex = nextVertex++;
+            }
+            indices[i] = firstVertex + newVertex;
+        }
+        const uint32_t usedVertices = nextVertex;
+        for (auto& newVertex : remap)
+        {
+            if (newVertex == UNUSED)
+            {
+                newVertex = nextVertex++;
+            }
+        }
+
+        std::vector<T> reordered(vertexCount);
+        for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+        {
+            reordered[remap[vertex]] = vertices[firstVertex + vertex];
+        }
+        std::copy(reordered.begin(), reordered.end(), vertices.begin() + firstVertex);
+        return usedVertices;
+    }
+};
+
+} // namespace RenderSys
@@ -0,0 +1,255 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <resources/Shaders/ShaderResource.h>
+#include <RenderSys/Components/MeshComponent.h>
+#include <RenderSys/Components/TransformComponent.h>
+#include <RenderSys/Components/TagAndIDComponents.h>
+
+namespace RenderSys
+{
+
+namespace
+{
+
+constexpr uint32_t RADIX_BITS = 8;
+constexpr uint32_t RADIX_BUCKETS = 1u << RADIX_BITS;
+constexpr uint32_t RADIX_PASSES = 64 / RADIX_BITS;
+
+constexpr uint64_t Mask(const uint32_t bits)
+{
+    return (uint64_t(1) << bits) - 1;
+}
+
+// bounds of the box transformed by the matrix, from the extents along each axis of the matrix
+void TransformBounds(const glm::mat4& matrix, const glm::vec3& boundsMin, const glm::vec3& boundsMax, glm::vec3& outMin, glm::vec3& outMax)
+{
+    const glm::vec3 center = glm::vec3(matrix * glm::vec4((boundsMin + boundsMax) * 0.5f, 1.0f));
+    const glm::vec3 halfExtent = (boundsMax - boundsMin) * 0.5f;
+    const glm::mat3 absMatrix(glm::abs(glm::vec3(matrix[0])), glm::abs(glm::vec3(matrix[1])), glm::abs(glm::vec3(matrix[2])));
+    const glm::vec3 worldHalfExtent = absMatrix * halfExtent;
+    outMin = glm::min(outMin, center - worldHalfExtent);
+    outMax = glm::max(outMax, center + worldHalfExtent);
+}
+
+// distance from the point to the box, zero inside
+float DistanceToBounds(const glm::vec3& point, const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+    const glm::vec3 closest = glm::clamp(point, boundsMin, boundsMax);
+    return glm::distance(point, closest);
+}
+
+} // namespace
+
+float RenderQueue::MakeLodProjectionScale(const float fovYDegrees, const uint32_t viewportHeight)
+{
+    return static_cast<float>(viewportHeight) / (2.0f * std::tan(glm::radians(fovYDegrees) * 0.5f));
+}
+
+uint32_t RenderQueue::SelectLod(const SubMesh& subMesh, const float distance, const float meshScale, const LodSettings& settings)
+{
+    if (settings.m_ProjectionScale <= 0.0f || subMesh.m_Lods.empty())
+    {
+        return 0;
+    }
+    // the error in pixels is error * meshScale * projectionScale / distance
+    const float maxError = settings.m_MaxErrorPixels * std::max(distance, 1e-4f) / (std::max(meshScale, 1e-6f) * settings.m_ProjectionScale);
+    uint32_t lod = 0;
+    for (uint32_t level = 0; level < subMesh.m_Lods.size(); ++level)
+    {
+        if (subMesh.m_Lods[level].m_Error > maxError)
+        {
+            break;
+        }
+        lod = level + 1;
+    }
+    return lod;
+}
+
+uint64_t RenderQueue::MakeSortKey(const RenderPipeline pipeline, const uint32_t materialID, const uint32_t meshID, const float depth)
+{
+    // the bit pattern of a positive float grows with its value, its upper bits are a logarithmic depth
+    uint32_t depthBits = 0;
+    if (depth > 0.0f)
+    {
+        std::memcpy(&depthBits, &depth, sizeof(depthBits));
+        depthBits >>= 31 - DEPTH_BITS;
+    }
+
+    uint64_t key = static_cast<uint64_t>(pipeline) & Mask(PIPELINE_BITS);
+    key = (key << MATERIAL_BITS) | (materialID & Mask(MATERIAL_BITS));
+    key = (key << MESH_BITS) | (meshID & Mask(MESH_BITS));
+    key = (key << DEPTH_BITS) | (depthBits & Mask(DEPTH_BITS));
+    return key;
+}
+
+void RenderQueue::Clear()
+{
+    m_packets.clear();
+}
+
+void RenderQueue::Submit(const Mesh& mesh, const float depth, const RenderPipeline pipeline)
+{
+    for (const auto& subMesh : mesh.subMeshes)
+    {
+        assert(subMesh.m_Material);
+        DrawPacket packet;
+        packet.m_SortKey = MakeSortKey(pipeline, GetMaterialID(subMesh.m_Material.get()), mesh.vertexBufferID, depth);
+        packet.m_Pipeline = pipeline;
+        packet.m_Mesh = &mesh;
+        packet.m_SubMesh = &subMesh;
+        packet.m_FirstIndex = subMesh.m_FirstIndex;
+        packet.m_IndexCount = subMesh.m_IndexCount;
+        m_packets.push_back(packet);
+    }
+}
+
+void RenderQueue::Submit(const Mesh& mesh, const float depth, const InstanceBuffer& instanceBuffer, const RenderPipeline pipeline)
+{
+    const size_t firstPacket = m_packets.size();
+    Submit(mesh, depth, pipeline);
+    // skinned vertices leave the bind pose bounds
+    if (mesh.m_meshData && mesh.m_meshData->hasSkinning)
+    {
+        return;
+    }
+
+    for (size_t packetIndex = firstPacket; packetIndex < m_packets.size(); ++packetIndex)
+    {
+        auto& packet = m_packets[packetIndex];
+        const auto& subMesh = *packet.m_SubMesh;
+        packet.m_InstanceBuffer = &instanceBuffer;
+        if (!subMesh.m_HasBounds)
+        {
+            continue;
+        }
+
+        packet.m_BoundsMin = glm::vec3(std::numeric_limits<float>::max());
+        packet.m_BoundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+        const uint32_t instanceCount = std::min<uint32_t>(std::max(subMesh.m_InstanceCount, 1u), MAX_INSTANCE);
+        for (uint32_t instance = 0; instance < instanceCount; ++instance)
+        {
+            TransformBounds(instanceBuffer.GetModelMatrix(instance), subMesh.m_BoundsMin, subMesh.m_BoundsMax, packet.m_BoundsMin, packet.m_BoundsMax);
+        }
+        packet.m_HasBounds = true;
+    }
+}
+
+void RenderQueue::Submit(const DrawPacket& packet)
+{
+    m_packets.push_back(packet);
+}
+
+void RenderQueue::SubmitRegistry(entt::registry& registry, const glm::vec3& viewPosition, const RenderPipeline pipeline)
+{
+    auto view = registry.view<MeshComponent, TransformComponent, InstanceTagComponent>();
+    for (auto entity : view)
+    {
+        auto& meshComponent = view.get<MeshComponent>(entity);
+        auto& transformComponent = view.get<TransformComponent>(entity);
+        auto& instanceTagComponent = view.get<InstanceTagComponent>(entity);
+        instanceTagComponent.GetInstanceBuffer()->Update();
+        const float depth = glm::distance(viewPosition, glm::vec3(transformComponent.GetMat4Global()[3]));
+        const size_t firstPacket = m_packets.size();
+        Submit(*meshComponent.m_Mesh, depth, *instanceTagComponent.GetInstanceBuffer(), pipeline);
+        if (m_lodSettings.m_ProjectionScale > 0.0f)
+        {
+            SelectLods(firstPacket, *instanceTagComponent.GetInstanceBuffer(), viewPosition);
+        }
+    }
+}
+
+void RenderQueue::SelectLods(const size_t firstPacket, const InstanceBuffer& instanceBuffer, const glm::vec3& viewPosition)
+{
+    for (size_t packetIndex = firstPacket; packetIndex < m_packets.size(); ++packetIndex)
+    {
+        auto& packet = m_packets[packetIndex];
+        const auto& subMesh = *packet.m_SubMesh;
+        // without world bounds (skinned) the distance is unknown
+        if (!packet.m_HasBounds || subMesh.m_Lods.empty())
+        {
+            continue;
+        }
+
+        // all instances share the level, it has to be fine enough for the nearest and largest one
+        float meshScale = 0.0f;
+        const uint32_t instanceCount = std::min<uint32_t>(std::max(subMesh.m_InstanceCount, 1u), MAX_INSTANCE);
+        for (uint32_t instance = 0; instance < instanceCount; ++instance)
+        {
+            const glm::mat4& modelMatrix = instanceBuffer.GetModelMatrix(instance);
+            meshScale = std::max({ meshScale, glm::length(glm::vec3(modelMatrix[0])), glm::length(glm::vec3(modelMatrix[1])),
+                                    glm::length(glm::vec3(modelMatrix[2])) });
+        }
+        const float distance = DistanceToBounds(viewPosition, packet.m_BoundsMin, packet.m_BoundsMax);
+        packet.m_Lod = SelectLod(subMesh, distance, meshScale, m_lodSettings);
+        if (packet.m_Lod > 0)
+        {
+            const auto& lod = subMesh.m_Lods[packet.m_Lod - 1];
+            packet.m_FirstIndex = lod.m_FirstIndex;
+            packet.m_IndexCount = lod.m_IndexCount;
+        }
+    }
+}
+
+void RenderQueue::Sort()
+{
+    const size_t packetCount = m_packets.size();
+    if (packetCount < 2)
+    {
+        return;
+    }
+
+    // one read for the histograms of all digits
+    std::array<std::array<uint32_t, RADIX_BUCKETS>, RADIX_PASSES> histograms{};
+    for (const auto& packet : m_packets)
+    {
+        for (uint32_t pass = 0; pass < RADIX_PASSES; ++pass)
+        {
+            histograms[pass][(packet.m_SortKey >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++;
+        }
+    }
+
+    m_sortBuffer.resize(packetCount);
+    for (uint32_t pass = 0; pass < RADIX_PASSES; ++pass)
+    {
+        auto& histogram = histograms[pass];
+        const uint32_t shift = pass * RADIX_BITS;
+        // a digit which is the same for every key does not change the order, unused key bits cost nothing
+        if (histogram[(m_packets[0].m_SortKey >> shift) & (RADIX_BUCKETS - 1)] == packetCount)
+        {
+            continue;
+        }
+
+        uint32_t offset = 0;
+        for (auto& count : histogram)
+        {
+            const uint32_t bucketSize = count;
+            count = offset;
+            offset += bucketSize;
+        }
+        for (const auto& packet : m_packets)
+        {
+            m_sortBuffer[histogram[(packet.m_SortKey >> shift) & (RADIX_BUCKETS - 1)]++] = packet;
+        }
+        m_packets.swap(m_sortBuffer);
+    }
+}
+
+uint32_t RenderQueue::GetMaterialID(const Material* material)
+{
+    auto materialIter = m_materialIDs.find(material);
+    if (materialIter != m_materialIDs.end())
+    {
+        return materialIter->second;
+    }
+    const uint32_t materialID = static_cast<uint32_t>(m_materialIDs.size());
+    m_materialIDs.emplace(material, materialID);
+    return materialID;
+}
+
+} // namespace RenderSys
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+#include <glm/ext.hpp>
+#include <entt/entt.hpp>
+#include <RenderSys/Scene/Mesh.h>
+#include <RenderSys/InstanceBuffer.h>
+
+namespace RenderSys
+{
+
+enum class RenderPipeline
+{
+    PBR = 0,
+    SHADOW
+};
+
+// one draw call of a submesh, the backend binds only the state which differs from the previous packet
+struct DrawPacket
+{
+    uint64_t m_SortKey = 0;
+    RenderPipeline m_Pipeline = RenderPipeline::PBR;
+    const Mesh* m_Mesh = nullptr;
+    const SubMesh* m_SubMesh = nullptr;
+    // index range of the selected level of detail, level 0 is the submesh itself
+    uint32_t m_FirstIndex = 0;
+    uint32_t m_IndexCount = 0;
+    uint32_t m_Lod = 0;
+    // world space bounds of all instances, packets without bounds are never culled
+    glm::vec3 m_BoundsMin{0.0f};
+    glm::vec3 m_BoundsMax{0.0f};
+    bool m_HasBounds = false;
+    // model matrices of the instances, only set for meshes which are not skinned
+    const InstanceBuffer* m_InstanceBuffer = nullptr;
+};
+
+// what the backend recorded for the render queues of one frame, reset by BeginFrame()
+struct RenderQueueStats
+{
+    uint32_t m_Draws = 0;
+    // of all instances, at the selected level of detail
+    uint32_t m_Triangles = 0;
+    uint32_t m_PipelineBinds = 0;
+    uint32_t m_DescriptorSetBinds = 0;
+    uint32_t m_VertexBufferBinds = 0;
+    uint32_t m_PushConstantUpdates = 0;
+    // indirect draw calls, each of them draws several of the m_Draws submeshes
+    uint32_t m_IndirectDraws = 0;
+    // compute dispatches of the skinning and culling passes
+    uint32_t m_Dispatches = 0;
+    // CPU time spent recording the queues into the command buffer
+    float m_RecordTimeMs = 0.0f;
+    // occlusion culled draws of the previous frame, the GPU results are read one frame late
+    uint32_t m_VisibleDraws = 0;
+    uint32_t m_OccludedDraws = 0;
+    uint32_t m_FrustumCulledDraws = 0;
+    // meshlets of the meshlet culled draws of the previous frame, the GPU results are read one frame late
+    uint32_t m_VisibleMeshlets = 0;
+    uint32_t m_FrustumCulledMeshlets = 0;
+    uint32_t m_ConeCulledMeshlets = 0;
+    // shadow caster packets left out of a cascade, counted once per cascade
+    uint32_t m_CulledShadowCasters = 0;
+    // cascades whose static casters were not drawn again
+    uint32_t m_CachedShadowCascades = 0;
+};
+
+// level of detail selection from the projected size of the simplification error
+struct LodSettings
+{
+    // pixels per world unit at distance one, the viewport height / (2 tan(fovY / 2)), zero draws every submesh at full detail
+    float m_ProjectionScale = 0.0f;
+    // the coarsest level whose error covers at most this many pixels is drawn
+    float m_MaxErrorPixels = 1.0f;
+};
+
+// Collects the draws of one pass and sorts them by the state they need, so that consecutive
+// draws share their pipeline, material and vertex buffer instead of following the registry order.
+// Sort key, most significant bits first: pipeline (4) | material (20) | mesh (20) | depth (20)
+class RenderQueue
+{
+public:
+    static constexpr uint32_t PIPELINE_BITS = 4;
+    static constexpr uint32_t MATERIAL_BITS = 20;
+    static constexpr uint32_t MESH_BITS = 20;
+    static constexpr uint32_t DEPTH_BITS = 20;
+
+    RenderQueue() = default;
+    ~RenderQueue() = default;
+    RenderQueue(const RenderQueue&) = delete;
+    RenderQueue& operator=(const RenderQueue&) = delete;
+    RenderQueue(RenderQueue&&) = delete;
+    RenderQueue& operator=(RenderQueue&&) = delete;
+
+    // depth is the distance to the viewer, equal state is drawn front to back
+    static uint64_t MakeSortKey(const RenderPipeline pipeline, const uint32_t materialID, const uint32_t meshID, const float depth);
+
+    static float MakeLodProjectionScale(const float fovYDegrees, const uint32_t viewportHeight);
+    // level of the submesh for an error in the space of the mesh, scaled by meshScale to world space and seen from distance
+    static uint32_t SelectLod(const SubMesh& subMesh, const float distance, const float meshScale, const LodSettings& settings);
+
+    void SetLodSettings(const LodSettings& settings) { m_lodSettings = settings; }
+    const LodSettings& GetLodSettings() const { return m_lodSettings; }
+
+    void Clear();
+    // adds one packet for each submesh of the mesh
+    void Submit(const Mesh& mesh, const float depth, const RenderPipeline pipeline = RenderPipeline::PBR);
+    // same, with the model matrices of the instances to give the packets world space bounds
+    void Submit(const Mesh& mesh, const float depth, const InstanceBuffer& instanceBuffer, const RenderPipeline pipeline = RenderPipeline::PBR);
+    // a packet of another queue, the order of the queue is kept when it was sorted and the packets are added in order
+    void Submit(const DrawPacket& packet);
+    // every entity with a mesh, transform and instance tag, also uploads their instance buffers,
+    // the levels of detail are selected for the view position
+    void SubmitRegistry(entt::registry& registry, const glm::vec3& viewPosition, const RenderPipeline pipeline = RenderPipeline::PBR);
+    // stable radix sort of the packets by their key
+    void Sort();
+
+    const std::vector<DrawPacket>& GetPackets() const { return m_packets; }
+    size_t GetPacketCount() const { return m_packets.size(); }
+
+private:
+    uint32_t GetMaterialID(const Material* material);
+    void SelectLods(const size_t firstPacket, const InstanceBuffer& instanceBuffer, const glm::vec3& viewPosition);
+
+    std::vector<DrawPacket> m_packets;
+    std::vector<DrawPacket> m_sortBuffer;
+    // dense ids keep the material bits of the key small, they stay valid over frames
+    std::unordered_map<const Material*, uint32_t> m_materialIDs;
+    LodSettings m_lodSettings;
+};
+
+} // namespace RenderSys
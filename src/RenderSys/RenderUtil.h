@@ -1,5 +1,8 @@
 #pragma once
 
+#include <stdint.h>
+#include <stddef.h>
+#include <functional>
 #include <string>
 
 namespace RenderSys
@@ -284,6 +287,19 @@ namespace RenderSys
             storageTexture.access = StorageTextureAccess::Undefined;
         }
     };
+
+    // rendered image of an asynchronous readback, RGBA8 rows without padding
+    // the pixels point into mapped staging memory, they are only valid inside the callback
+    struct RenderedImageView
+    {
+        const uint8_t* pixels = nullptr;
+        size_t size = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        // returned by the request of the readback
+        uint64_t ticket = 0;
+    };
+    using RenderedImageCallback = std::function<void(const RenderedImageView&)>;
     
     
 } // namespace RenderSys
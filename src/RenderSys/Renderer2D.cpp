@@ -101,9 +101,38 @@ void Renderer2D::RenderIndexed(uint32_t uniformIndex, uint32_t dynamicOffsetCoun
 void Renderer2D::BeginRenderPass()
 {
     m_rendererBackend->BeginRenderPass();
+    m_spriteStats = {};
 }
 
 void Renderer2D::EndRenderPass()
 {
     m_rendererBackend->EndRenderPass();
 }
+
+void Renderer2D::SetSpriteAtlas(const RenderSys::SpriteAtlas& atlas)
+{
+    m_rendererBackend->CreateSpriteAtlas(atlas.GetPixels().data(), atlas.GetWidth(), atlas.GetHeight());
+    m_spriteWhiteRegion = atlas.GetWhiteRegion();
+}
+
+RenderSys::SpriteBatch& Renderer2D::BeginSprites(const glm::mat4& viewProjection)
+{
+    uint32_t capacity = 0;
+    RenderSys::SpriteInstance* instances = m_rendererBackend->MapSprites(capacity);
+    m_spriteBatch.Begin(instances, capacity, m_spriteWhiteRegion);
+    m_spriteViewProjection = viewProjection;
+    return m_spriteBatch;
+}
+
+void Renderer2D::EndSprites()
+{
+    m_spriteStats.m_DroppedSprites += m_spriteBatch.GetDroppedSpriteCount();
+    const uint32_t spriteCount = m_spriteBatch.End();
+    if (spriteCount == 0)
+    {
+        return;
+    }
+    m_rendererBackend->DrawSprites(spriteCount, m_spriteViewProjection);
+    m_spriteStats.m_Sprites += spriteCount;
+    m_spriteStats.m_Draws++;
+}
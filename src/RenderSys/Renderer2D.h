@@ -8,6 +8,8 @@
 
 #include "RenderUtil.h"
 #include "Shader.h"
+#include "SpriteAtlas.h"
+#include "SpriteBatch.h"
 
 namespace GraphicsAPI
 {
@@ -27,6 +29,14 @@ static_assert(false);
 
 namespace RenderSys
 {
+
+// what the sprite batches drew since BeginRenderPass()
+struct SpriteStats
+{
+    uint32_t m_Sprites = 0;
+    uint32_t m_Draws = 0;
+    uint32_t m_DroppedSprites = 0;
+};
     
 class Renderer2D
 {
@@ -58,10 +68,23 @@ public:
     void BeginRenderPass();
     void EndRenderPass();
 
+    // uploads the atlas the sprites sample, once after Init()
+    void SetSpriteAtlas(const RenderSys::SpriteAtlas& atlas);
+    // the batch writes quads, sprites and lines straight into the persistently mapped instance buffer of the renderer,
+    // EndSprites() draws all of them with one draw call. Call both inside the render pass, several batches per frame
+    // share the buffer of SpriteBatch::MAX_SPRITES instances
+    RenderSys::SpriteBatch& BeginSprites(const glm::mat4& viewProjection);
+    void EndSprites();
+    const SpriteStats& GetSpriteStats() const { return m_spriteStats; }
+
     void* GetDescriptorSet() const;
     void Destroy();
 private:
     uint32_t m_Width = 0, m_Height = 0;
+    RenderSys::SpriteBatch m_spriteBatch;
+    RenderSys::SpriteRegion m_spriteWhiteRegion;
+    glm::mat4 m_spriteViewProjection{1.0f};
+    SpriteStats m_spriteStats;
     std::unique_ptr<GraphicsAPI::RendererType> m_rendererBackend;
 };
 
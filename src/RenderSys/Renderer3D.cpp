@@ -48,11 +48,52 @@ uint32_t Renderer3D::SetVertexBufferData(const VertexBuffer& bufferData, RenderS
     return m_rendererBackend->CreateVertexBuffer(bufferData, bufferLayout);
 }
 
+uint32_t Renderer3D::SetVertexBufferData(const PackedVertexBuffer& bufferData, RenderSys::VertexBufferLayout bufferLayout)
+{
+    return m_rendererBackend->CreateVertexBuffer(bufferData.vertices.data(), bufferData.size() * sizeof(RenderSys::PackedVertex), bufferLayout);
+}
+
+uint32_t Renderer3D::SetVertexBufferData(const MeshData& meshData, RenderSys::VertexBufferLayout bufferLayout)
+{
+    const size_t vertexCount = meshData.getVertexCount();
+    if (bufferLayout.arrayStride == sizeof(RenderSys::PackedVertex))
+    {
+        PackedUvFormat uvFormat = PackedUvFormat::Float16;
+        for (uint32_t i = 0; i < bufferLayout.attributeCount; i++)
+        {
+            if (bufferLayout.attributes[i].location == 2 && bufferLayout.attributes[i].format == VertexFormat::Unorm16x2)
+            {
+                uvFormat = PackedUvFormat::Unorm16;
+            }
+        }
+        return m_rendererBackend->CreateVertexBuffer(vertexCount * sizeof(RenderSys::PackedVertex), bufferLayout, [&meshData, uvFormat](void* mappedVertices)
+        {
+            meshData.writePackedVertexBufferForRenderer(static_cast<RenderSys::PackedVertex*>(mappedVertices), uvFormat);
+        });
+    }
+
+    assert(bufferLayout.arrayStride == sizeof(RenderSys::Vertex));
+    return m_rendererBackend->CreateVertexBuffer(vertexCount * sizeof(RenderSys::Vertex), bufferLayout, [&meshData](void* mappedVertices)
+    {
+        meshData.writeVertexBufferForRenderer(static_cast<RenderSys::Vertex*>(mappedVertices));
+    });
+}
+
 void Renderer3D::SetIndexBufferData(uint32_t vertexBufferID, const std::vector<uint32_t>& bufferData)
 {
     m_rendererBackend->CreateIndexBuffer(vertexBufferID, bufferData);
 }
 
+void Renderer3D::SetSkinningData(uint32_t vertexBufferID, const std::vector<RenderSys::SkinningVertex>& skinningData)
+{
+    m_rendererBackend->CreateSkinningBuffer(vertexBufferID, skinningData);
+}
+
+void Renderer3D::SetMeshletData(uint32_t vertexBufferID, const std::vector<RenderSys::Meshlet>& meshlets)
+{
+    m_rendererBackend->CreateMeshletBuffer(vertexBufferID, meshlets);
+}
+
 void Renderer3D::CreatePipeline()
 {
     m_rendererBackend->CreatePipeline();
@@ -123,6 +164,61 @@ void Renderer3D::RenderMesh(const RenderSys::Mesh& mesh)
     m_rendererBackend->RenderMesh(mesh);
 }
 
+void Renderer3D::SubmitRenderQueue(const RenderSys::RenderQueue& renderQueue)
+{
+    m_rendererBackend->SubmitRenderQueue(renderQueue);
+}
+
+const RenderSys::RenderQueueStats& Renderer3D::GetRenderQueueStats() const
+{
+    return m_rendererBackend->GetRenderQueueStats();
+}
+
+bool Renderer3D::SupportsBindlessMaterials() const
+{
+    return m_rendererBackend->SupportsBindlessMaterials();
+}
+
+void Renderer3D::SetBindlessMaterials(bool bindlessMaterials)
+{
+    m_rendererBackend->SetBindlessMaterials(bindlessMaterials);
+}
+
+bool Renderer3D::SupportsMultiDrawIndirect() const
+{
+    return m_rendererBackend->SupportsMultiDrawIndirect();
+}
+
+void Renderer3D::SetMultiDrawIndirect(bool multiDrawIndirect)
+{
+    m_rendererBackend->SetMultiDrawIndirect(multiDrawIndirect);
+}
+
+void Renderer3D::SubmitRenderQueueIndirect(const RenderSys::RenderQueue& renderQueue)
+{
+    m_rendererBackend->SubmitRenderQueueIndirect(renderQueue);
+}
+
+bool Renderer3D::SupportsOcclusionCulling() const
+{
+    return m_rendererBackend->SupportsOcclusionCulling();
+}
+
+void Renderer3D::SubmitRenderQueueOcclusionCulled(const RenderSys::RenderQueue& renderQueue, const glm::mat4& viewProjection)
+{
+    m_rendererBackend->SubmitRenderQueueOcclusionCulled(renderQueue, viewProjection);
+}
+
+bool Renderer3D::SupportsMeshletCulling() const
+{
+    return m_rendererBackend->SupportsMeshletCulling();
+}
+
+void Renderer3D::SubmitRenderQueueMeshletCulled(const RenderSys::RenderQueue& renderQueue, const glm::mat4& viewProjection, const glm::vec3& viewPosition)
+{
+    m_rendererBackend->SubmitRenderQueueMeshletCulled(renderQueue, viewProjection, viewPosition);
+}
+
 void Renderer3D::BeginRenderPass()
 {
     m_rendererBackend->BeginRenderPass();
@@ -133,11 +229,14 @@ void Renderer3D::EndRenderPass()
     m_rendererBackend->EndRenderPass();
 }
 
-void Renderer3D::ShadowPass(entt::registry& entityRegistry)
+void Renderer3D::ShadowPass(entt::registry& entityRegistry, const RenderSys::ShadowCascades& shadowCascades)
+{
+    m_rendererBackend->RenderShadowMap(entityRegistry, shadowCascades);
+}
+
+void Renderer3D::SkinningPass(entt::registry& entityRegistry)
 {
-    m_rendererBackend->BeginShadowMapPass();
-    m_rendererBackend->RenderShadowMap(entityRegistry);
-    m_rendererBackend->EndShadowMapPass();
+    m_rendererBackend->RenderSkinning(entityRegistry);
 }
 
 void Renderer3D::OnImGuiRender()
@@ -149,3 +248,33 @@ std::vector<uint8_t>& Renderer3D::GetRenderedImageData()
 {
     return m_rendererBackend->GetRenderedImageDataToCPUSide();
 }
+
+uint64_t Renderer3D::RequestRenderedImage(RenderSys::RenderedImageCallback callback)
+{
+    return m_rendererBackend->RequestRenderedImage(std::move(callback));
+}
+
+void Renderer3D::PollRenderedImages()
+{
+    m_rendererBackend->PollRenderedImages();
+}
+
+void Renderer3D::WaitRenderedImages()
+{
+    m_rendererBackend->WaitRenderedImages();
+}
+
+void Renderer3D::BeginProfileScope(const std::string& name)
+{
+    m_rendererBackend->BeginProfileScope(name);
+}
+
+void Renderer3D::EndProfileScope()
+{
+    m_rendererBackend->EndProfileScope();
+}
+
+RenderSys::GpuProfiler* Renderer3D::GetGpuProfiler()
+{
+    return m_rendererBackend->GetGpuProfiler();
+}
@@ -9,6 +9,9 @@
 #include "Shader.h"
 #include <RenderSys/Texture.h>
 #include <RenderSys/Scene/Mesh.h>
+#include <RenderSys/RenderQueue.h>
+#include <RenderSys/ShadowCascades.h>
+#include <RenderSys/GpuProfiler.h>
 #include <entt/entt.hpp>
 
 namespace RenderSys
@@ -43,8 +46,18 @@ public:
     void OnResize(uint32_t width, uint32_t height);
     void SetShader(RenderSys::Shader& shader);
     uint32_t SetVertexBufferData(const VertexBuffer& bufferData, RenderSys::VertexBufferLayout bufferLayout);
+    // the layout points to VertexPacking::GetVertexAttributes(), the shaders decode the normal and tangent, not for skinned meshes
+    uint32_t SetVertexBufferData(const PackedVertexBuffer& bufferData, RenderSys::VertexBufferLayout bufferLayout);
+    // converts the mesh vertices straight into the vertex buffer, without a VertexBuffer in between
+    // a layout with the stride of PackedVertex packs them, the format of location 2 selects the PackedUvFormat
+    uint32_t SetVertexBufferData(const MeshData& meshData, RenderSys::VertexBufferLayout bufferLayout);
     void SetIndexBufferData(uint32_t vertexBufferID, const std::vector<uint32_t>& bufferData);
+    void SetSkinningData(uint32_t vertexBufferID, const std::vector<RenderSys::SkinningVertex>& skinningData);
+    // the meshlets of MeshData::meshlets, call it after SetIndexBufferData() with multi-draw indirect enabled
+    void SetMeshletData(uint32_t vertexBufferID, const std::vector<RenderSys::Meshlet>& meshlets);
     void CreatePipeline();
+    // a texture entry with the Depth sample type and the _2DArray view dimension binds the layered shadow map of
+    // ShadowPass(), with a comparison sampler. It is written by the first ShadowPass(), before the main pass samples it
     void CreateBindGroup(const std::vector<RenderSys::BindGroupLayoutEntry>& bindGroupLayoutEntries);
     void CreateTexture(uint32_t binding, const std::shared_ptr<RenderSys::Texture> texture);
     void SetClearColor(glm::vec4 clearColor);
@@ -56,13 +69,52 @@ public:
     void BeginFrame();
     void EndFrame();
     void RenderMesh(const RenderSys::Mesh& mesh);
+    // draws a sorted queue inside the current render pass
+    void SubmitRenderQueue(const RenderSys::RenderQueue& renderQueue);
+    // draws and state changes of the queues submitted since BeginFrame(), the shadow pass included
+    const RenderSys::RenderQueueStats& GetRenderQueueStats() const;
+    bool SupportsBindlessMaterials() const;
+    // one bind group with the textures and properties of all materials, indexed per draw
+    // call it before CreatePipeline(), the pipeline shaders have to read the materials this way
+    void SetBindlessMaterials(bool bindlessMaterials);
+    bool SupportsMultiDrawIndirect() const;
+    // needs bindless materials, call it before CreatePipeline() with the pbr-indirect shaders set
+    void SetMultiDrawIndirect(bool multiDrawIndirect);
+    // draws a sorted PBR queue with a few indirect draw calls, needs SetMultiDrawIndirect()
+    void SubmitRenderQueueIndirect(const RenderSys::RenderQueue& renderQueue);
+    bool SupportsOcclusionCulling() const;
+    // indirect draws with two phase occlusion culling against a depth pyramid, records the main render pass itself
+    // so it replaces BeginRenderPass() and EndRenderPass(), the culling counts are reported in the next frame
+    void SubmitRenderQueueOcclusionCulled(const RenderSys::RenderQueue& renderQueue, const glm::mat4& viewProjection);
+    bool SupportsMeshletCulling() const;
+    // indirect draws of the visible meshlets only, culled by their bounding spheres and normal cones in a compute pass,
+    // records the main render pass itself like SubmitRenderQueueOcclusionCulled(), once per frame
+    void SubmitRenderQueueMeshletCulled(const RenderSys::RenderQueue& renderQueue, const glm::mat4& viewProjection, const glm::vec3& viewPosition);
     void BeginRenderPass();
     void EndRenderPass();
-    void ShadowPass(entt::registry& entityRegistry);
+    // renders every cascade into its layer of the shadow map, call it after shadowCascades.Update() and outside of any render pass
+    void ShadowPass(entt::registry& entityRegistry, const RenderSys::ShadowCascades& shadowCascades);
+    // skins every animated mesh once per frame, call it after BeginFrame() and before the first pass
+    void SkinningPass(entt::registry& entityRegistry);
     void* GetDescriptorSet() const;
     void Destroy();
     void OnImGuiRender();
+    // blocks until the image is copied, prefer RequestRenderedImage() when called every frame
     std::vector<uint8_t>& GetRenderedImageData();
+    // asynchronous readback, call it between the last render pass and EndFrame(). The callback gets a view of
+    // the image once the frame has completed, at one of the next BeginFrame() or the calls below, in request order.
+    // A few staging buffers are in flight, a request waits for the oldest one when all of them are.
+    uint64_t RequestRenderedImage(RenderSys::RenderedImageCallback callback);
+    void PollRenderedImages();
+    void WaitRenderedImages();
+    // GPU and CPU time of a named scope between BeginFrame() and EndFrame(), the shadow, skinning and render passes
+    // have their own. Scopes nest, ScopedGpuMarker<Renderer3D> ends one at the end of a block
+    void BeginProfileScope(const std::string& name);
+    void EndProfileScope();
+    // the scopes of the frames with their draw, triangle and dispatch counts, resolved a few frames late without
+    // waiting for the GPU. OnImGuiRender() of the profiler shows them, WriteChromeTrace() exports them.
+    // nullptr when the backend has no timestamp queries
+    RenderSys::GpuProfiler* GetGpuProfiler();
 
 private:
     uint32_t m_Width = 0, m_Height = 0;
@@ -52,10 +52,10 @@ void Resource::SetBuffer(BufferIndices index, const std::shared_ptr<Buffer> &buf
     {
         m_ResourceDescriptor->AttachBuffer(0, buffer);
     }
-    // else if (index == SKELETAL_ANIMATION_BUFFER_INDEX)
-    // {
-    //     m_ResourceDescriptor->AttachBuffer(1, buffer);
-    // }
+    else if (index == SKELETAL_ANIMATION_BUFFER_INDEX)
+    {
+        m_ResourceDescriptor->AttachBuffer(1, buffer);
+    }
     // else if (index == HEIGHTMAP)
     // {
     //     m_ResourceDescriptor->AttachBuffer(2, buffer);
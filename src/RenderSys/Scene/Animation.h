@@ -46,6 +46,9 @@ public:
     std::string const &GetName() const { return m_Name; }
     void SetRepeat(bool repeat) { m_Repeat = repeat; }
     void Update(const float &timestep, Skeleton &skeleton);
+    // writes the joint TRS values at the given absolute key frame time, does not touch the playback state.
+    // Leaf joints can be skipped for distant characters, they keep their last pose relative to the parent.
+    void Sample(const float keyFrameTime, Skeleton &skeleton, const bool skipLeafJoints = false) const;
     float GetDuration() const { return m_LastKeyFrameTime - m_FirstKeyFrameTime; }
     float GetCurrentTime() const { return m_CurrentKeyFrameTime - m_FirstKeyFrameTime; }
 
@@ -54,14 +57,16 @@ public:
 
     void SetFirstKeyFrameTime(float firstKeyFrameTime) { m_FirstKeyFrameTime = firstKeyFrameTime; }
     void SetLastKeyFrameTime(float lastKeyFrameTime) { m_LastKeyFrameTime = lastKeyFrameTime; }
+    float GetFirstKeyFrameTime() const { return m_FirstKeyFrameTime; }
+    float GetLastKeyFrameTime() const { return m_LastKeyFrameTime; }
 
 private:
     std::string m_Name;
     bool m_Repeat;
 
     // relative animation time
-    float m_FirstKeyFrameTime;
-    float m_LastKeyFrameTime;
+    float m_FirstKeyFrameTime = 0.0f;
+    float m_LastKeyFrameTime = 0.0f;
     float m_CurrentKeyFrameTime = 0.0f;
 };
 
@@ -0,0 +1,276 @@
+#include "AnimationSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <RenderSys/Camera/PerspectiveCamera.h>
+#include <RenderSys/Components/AnimationComponents.h>
+#include <RenderSys/Components/TransformComponent.h>
+
+namespace RenderSys
+{
+
+namespace
+{
+
+// planes of the view frustum (pointing inwards), extracted from the view projection matrix
+struct Frustum
+{
+    explicit Frustum(const glm::mat4& viewProjection)
+    {
+        const glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+        const glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+        const glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+        const glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+        m_Planes = {row3 + row0, row3 - row0, row3 + row1, row3 - row1, row3 + row2, row3 - row2};
+        for (auto& plane : m_Planes)
+        {
+            plane /= glm::length(glm::vec3(plane));
+        }
+    }
+
+    bool IsSphereVisible(const glm::vec3& center, const float radius) const
+    {
+        for (const auto& plane : m_Planes)
+        {
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::array<glm::vec4, 6> m_Planes;
+};
+
+void StorePose(const Skeleton& skeleton, std::vector<JointPose>& pose)
+{
+    pose.resize(skeleton.m_Joints.size());
+    for (size_t jointIndex = 0; jointIndex < pose.size(); ++jointIndex)
+    {
+        const auto& joint = skeleton.m_Joints[jointIndex];
+        pose[jointIndex] = {joint.m_DeformedNodeTranslation, joint.m_DeformedNodeRotation, joint.m_DeformedNodeScale};
+    }
+}
+
+void BlendPose(const std::vector<JointPose>& source, const std::vector<JointPose>& target, const float factor, Skeleton& skeleton)
+{
+    for (size_t jointIndex = 0; jointIndex < skeleton.m_Joints.size(); ++jointIndex)
+    {
+        auto& joint = skeleton.m_Joints[jointIndex];
+        joint.m_DeformedNodeTranslation = glm::mix(source[jointIndex].m_Translation, target[jointIndex].m_Translation, factor);
+        joint.m_DeformedNodeRotation = glm::slerp(source[jointIndex].m_Rotation, target[jointIndex].m_Rotation, factor);
+        joint.m_DeformedNodeScale = glm::mix(source[jointIndex].m_Scale, target[jointIndex].m_Scale, factor);
+    }
+}
+
+// playback time of the animation after timestep, wrapped or clamped like the playback state itself
+float AdvanceTime(const AnimationComponent& animation, const float duration, const float timestep)
+{
+    if (!animation.m_Playing)
+    {
+        return animation.m_CurrentTime;
+    }
+
+    const float time = animation.m_CurrentTime + timestep * animation.m_Speed;
+    if (time <= duration)
+    {
+        return time;
+    }
+    return animation.m_Repeat && duration > 0.0f ? std::fmod(time, duration) : duration;
+}
+
+} // namespace
+
+AnimationSystem::AnimationSystem(JobSystem& jobSystem)
+    : m_jobSystem(jobSystem)
+{
+}
+
+void AnimationSystem::Update(entt::registry& registry, const float timestep)
+{
+    UpdateCharacters(registry, timestep, nullptr);
+}
+
+void AnimationSystem::Update(entt::registry& registry, const float timestep, const PerspectiveCamera& camera)
+{
+    UpdateCharacters(registry, timestep, &camera);
+}
+
+void AnimationSystem::UpdateLods(entt::registry& registry, const PerspectiveCamera& camera)
+{
+    const Frustum frustum(camera.GetProjectionMatrix() * camera.GetViewMatrix());
+    for (auto entity : m_animatedEntities)
+    {
+        // emplacing is fine here, the jobs which hold references into the pools have not started yet
+        auto& lod = registry.get_or_emplace<AnimationLodComponent>(entity);
+        const auto* transform = registry.try_get<TransformComponent>(entity);
+        const glm::vec3 position = transform ? glm::vec3(transform->GetMat4Global()[3]) : glm::vec3(0.0f);
+
+        const float distance = glm::distance(position, camera.GetPosition());
+        lod.m_Lod = 0;
+        while (lod.m_Lod < LOD_COUNT - 1 && distance > m_lodSettings.m_Distances[lod.m_Lod])
+        {
+            lod.m_Lod++;
+        }
+        lod.m_SampleInterval = std::max(1u, m_lodSettings.m_SampleIntervals[lod.m_Lod]);
+        lod.m_Visible = !m_lodSettings.m_FreezeOffscreen || frustum.IsSphereVisible(position, lod.m_BoundingRadius);
+
+        if (lod.m_Visible)
+        {
+            m_stats.m_CharactersPerLod[lod.m_Lod]++;
+        }
+        else
+        {
+            m_stats.m_FrozenCharacters++;
+        }
+    }
+}
+
+void AnimationSystem::UpdateCharacters(entt::registry& registry, const float timestep, const PerspectiveCamera* camera)
+{
+    const auto startTime = std::chrono::high_resolution_clock::now();
+
+    // the view is not random access, so gather the entities once and split the flat list
+    m_animatedEntities.clear();
+    m_posedSkeletons.clear();
+    auto view = registry.view<SkeletonComponent, AnimationComponent>();
+    for (auto entity : view)
+    {
+        // two jobs must never pose the same skeleton
+        const auto& skeleton = view.get<SkeletonComponent>(entity).m_Skeleton;
+        if (skeleton && !m_posedSkeletons.insert(skeleton.get()).second)
+        {
+            continue;
+        }
+        m_animatedEntities.push_back(entity);
+    }
+
+    m_stats.m_CharactersPerLod = {};
+    m_stats.m_FrozenCharacters = 0;
+    if (camera)
+    {
+        UpdateLods(registry, *camera);
+    }
+    else
+    {
+        m_stats.m_CharactersPerLod[0] = static_cast<uint32_t>(m_animatedEntities.size());
+    }
+
+    std::atomic<uint32_t> sampledCharacters{0};
+    std::atomic<uint64_t> cpuTimeNs{0};
+    std::atomic<uint64_t> fullRateTimeNs{0};
+    std::atomic<uint32_t> fullRateCharacters{0};
+
+    // components are only read and written in place here, no pool is resized while the jobs run
+    m_jobSystem.ParallelFor(static_cast<uint32_t>(m_animatedEntities.size()), m_charactersPerJob,
+        [&](uint32_t begin, uint32_t end)
+        {
+            uint32_t groupSampled = 0;
+            uint64_t groupTimeNs = 0;
+            uint64_t groupFullRateTimeNs = 0;
+            uint32_t groupFullRateCharacters = 0;
+            for (uint32_t i = begin; i < end; i++)
+            {
+                const auto characterStartTime = std::chrono::high_resolution_clock::now();
+                const auto entity = m_animatedEntities[i];
+                auto& skeletonComponent = view.get<SkeletonComponent>(entity);
+                auto& skeleton = skeletonComponent.m_Skeleton;
+                auto& animation = view.get<AnimationComponent>(entity);
+                if (!skeleton || animation.m_Animations.empty())
+                {
+                    continue;
+                }
+
+                const auto& clip = animation.m_Animations[animation.m_CurrentAnimation];
+                const float duration = clip->GetDuration();
+                if (animation.m_Playing)
+                {
+                    animation.m_CurrentTime += timestep * animation.m_Speed;
+                    if (animation.m_CurrentTime > duration)
+                    {
+                        if (animation.m_Repeat && duration > 0.0f)
+                        {
+                            animation.m_CurrentTime = std::fmod(animation.m_CurrentTime, duration);
+                        }
+                        else
+                        {
+                            animation.m_CurrentTime = duration;
+                            animation.m_Playing = false;
+                        }
+                    }
+                }
+
+                AnimationLodComponent* lod = camera ? &registry.get<AnimationLodComponent>(entity) : nullptr;
+                const bool fullRate = !lod || (lod->m_Visible && lod->m_SampleInterval == 1 && lod->m_Lod < m_lodSettings.m_SkipLeafJointsFromLod);
+                if (lod && !lod->m_Visible)
+                {
+                    // sample again as soon as the character is back on screen
+                    lod->m_FramesSinceSample = lod->m_SampleInterval;
+                }
+                else
+                {
+                    const bool skipLeafJoints = lod && lod->m_Lod >= m_lodSettings.m_SkipLeafJointsFromLod;
+                    if (!lod || lod->m_SampleInterval == 1)
+                    {
+                        clip->Sample(clip->GetFirstKeyFrameTime() + animation.m_CurrentTime, *skeleton, skipLeafJoints);
+                        groupSampled++;
+                    }
+                    else
+                    {
+                        // sample the pose of the last frame of the interval, the frames up to it interpolate towards it
+                        if (lod->m_FramesSinceSample >= lod->m_SampleInterval || lod->m_TargetPose.size() != skeleton->m_Joints.size())
+                        {
+                            StorePose(*skeleton, lod->m_SourcePose);
+                            const float targetTime = AdvanceTime(animation, duration, timestep * (lod->m_SampleInterval - 1));
+                            clip->Sample(clip->GetFirstKeyFrameTime() + targetTime, *skeleton, skipLeafJoints);
+                            StorePose(*skeleton, lod->m_TargetPose);
+                            lod->m_FramesSinceSample = 0;
+                            groupSampled++;
+                        }
+                        lod->m_FramesSinceSample++;
+                        BlendPose(lod->m_SourcePose, lod->m_TargetPose,
+                                    static_cast<float>(lod->m_FramesSinceSample) / lod->m_SampleInterval, *skeleton);
+                    }
+
+                    skeleton->Update();
+                    if (skeletonComponent.m_JointMatricesBuffer)
+                    {
+                        skeletonComponent.m_JointMatricesBuffer->Write(skeleton->GetJointPaletteData());
+                    }
+                }
+
+                const auto characterEndTime = std::chrono::high_resolution_clock::now();
+                const uint64_t characterTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(characterEndTime - characterStartTime).count();
+                groupTimeNs += characterTimeNs;
+                if (fullRate)
+                {
+                    groupFullRateTimeNs += characterTimeNs;
+                    groupFullRateCharacters++;
+                }
+            }
+
+            sampledCharacters += groupSampled;
+            cpuTimeNs += groupTimeNs;
+            fullRateTimeNs += groupFullRateTimeNs;
+            fullRateCharacters += groupFullRateCharacters;
+        });
+
+    if (fullRateCharacters > 0)
+    {
+        const float averageCostNs = static_cast<float>(fullRateTimeNs.load()) / fullRateCharacters.load();
+        m_fullRateCostNs = m_fullRateCostNs > 0.0f ? glm::mix(m_fullRateCostNs, averageCostNs, 0.1f) : averageCostNs;
+    }
+
+    const auto endTime = std::chrono::high_resolution_clock::now();
+    m_stats.m_AnimatedCharacters = static_cast<uint32_t>(m_animatedEntities.size());
+    m_stats.m_UpdateTimeMs = std::chrono::duration<float, std::milli>(endTime - startTime).count();
+    m_stats.m_SampledCharacters = sampledCharacters;
+    m_stats.m_CpuTimeMs = cpuTimeNs.load() * 1e-6f;
+    m_stats.m_FullRateCpuTimeMs = std::max(m_stats.m_CpuTimeMs, m_fullRateCostNs * m_stats.m_AnimatedCharacters * 1e-6f);
+    m_stats.m_SavedCpuTimeMs = m_stats.m_FullRateCpuTimeMs - m_stats.m_CpuTimeMs;
+}
+
+} // namespace RenderSys
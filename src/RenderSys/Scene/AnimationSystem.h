@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <stdint.h>
+#include <unordered_set>
+#include <entt/entt.hpp>
+#include <RenderSys/JobSystem.h>
+
+namespace RenderSys
+{
+
+class PerspectiveCamera;
+struct Skeleton;
+
+// Advances the playback state of every entity with a SkeletonComponent and an AnimationComponent,
+// samples its current clip and recomputes the final joint matrices. Characters are independent,
+// so they are spread over the job system in groups. Entities sharing a skeleton are posed once, by the first of them.
+// With a camera, distant characters are sampled at a lower rate (the frames in between interpolate
+// the joint poses), their leaf joints are skipped, and characters outside of the frustum are frozen.
+class AnimationSystem
+{
+public:
+    static constexpr uint32_t LOD_COUNT = 3;
+
+    struct LodSettings
+    {
+        // a character switches to LOD n + 1 when it is further than m_Distances[n] away from the camera
+        std::array<float, LOD_COUNT - 1> m_Distances{15.0f, 40.0f};
+        // a character is sampled every m_SampleIntervals[lod] frames
+        std::array<uint32_t, LOD_COUNT> m_SampleIntervals{1, 2, 4};
+        // leaf joints (fingers, toes, ...) are not sampled from this LOD on
+        uint32_t m_SkipLeafJointsFromLod = 2;
+        // off-screen characters keep their last pose, only their playback time advances
+        bool m_FreezeOffscreen = true;
+    };
+
+    struct Stats
+    {
+        uint32_t m_AnimatedCharacters = 0;
+        float m_UpdateTimeMs = 0.0f;
+
+        std::array<uint32_t, LOD_COUNT> m_CharactersPerLod{};
+        uint32_t m_FrozenCharacters = 0;
+        uint32_t m_SampledCharacters = 0;
+        // summed over all threads, the full rate time is estimated from the characters updated at LOD 0
+        float m_CpuTimeMs = 0.0f;
+        float m_FullRateCpuTimeMs = 0.0f;
+        float m_SavedCpuTimeMs = 0.0f;
+    };
+
+    explicit AnimationSystem(JobSystem& jobSystem = JobSystem::Get());
+    ~AnimationSystem() = default;
+    AnimationSystem(const AnimationSystem&) = delete;
+    AnimationSystem& operator=(const AnimationSystem&) = delete;
+    AnimationSystem(AnimationSystem&&) = delete;
+    AnimationSystem& operator=(AnimationSystem&&) = delete;
+
+    // every character at full rate
+    void Update(entt::registry& registry, const float timestep);
+    // animation LOD from the distance to the camera and its view frustum
+    void Update(entt::registry& registry, const float timestep, const PerspectiveCamera& camera);
+
+    void SetCharactersPerJob(uint32_t charactersPerJob) { m_charactersPerJob = charactersPerJob; }
+    void SetLodSettings(const LodSettings& lodSettings) { m_lodSettings = lodSettings; }
+    const LodSettings& GetLodSettings() const { return m_lodSettings; }
+    const Stats& GetStats() const { return m_stats; }
+
+private:
+    void UpdateCharacters(entt::registry& registry, const float timestep, const PerspectiveCamera* camera);
+    void UpdateLods(entt::registry& registry, const PerspectiveCamera& camera);
+
+    JobSystem& m_jobSystem;
+    uint32_t m_charactersPerJob = 8;
+    std::vector<entt::entity> m_animatedEntities;
+    std::unordered_set<const Skeleton*> m_posedSkeletons;
+    LodSettings m_lodSettings;
+    float m_fullRateCostNs = 0.0f; // running average cost of one character at LOD 0
+    Stats m_stats;
+};
+
+} // namespace RenderSys
@@ -0,0 +1,702 @@
+#include "CpuSkinning.h"
+
+#include <cmath>
+#include <assert.h>
+
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#include <immintrin.h>
+#define RENDERSYS_SKINNING_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RENDERSYS_SKINNING_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define RENDERSYS_SKINNING_NEON
+#endif
+
+namespace RenderSys
+{
+
+void SkinningStreams::Resize(size_t vertexCount)
+{
+    for (int component = 0; component < 3; component++)
+    {
+        m_Position[component].resize(vertexCount);
+        m_Normal[component].resize(vertexCount);
+        m_Tangent[component].resize(vertexCount);
+    }
+}
+
+void SkinningStreams::Load(const VertexBuffer& vertexBuffer)
+{
+    Resize(vertexBuffer.size());
+    for (size_t i = 0; i < vertexBuffer.size(); i++)
+    {
+        const Vertex& vertex = vertexBuffer[i];
+        for (int component = 0; component < 3; component++)
+        {
+            m_Position[component][i] = vertex.position[component];
+            m_Normal[component][i] = vertex.normal[component];
+            m_Tangent[component][i] = vertex.tangent[component];
+        }
+    }
+}
+
+void SkinningStreams::Store(VertexBuffer& vertexBuffer) const
+{
+    assert(vertexBuffer.size() == Size());
+    for (size_t i = 0; i < vertexBuffer.size(); i++)
+    {
+        Vertex& vertex = vertexBuffer[i];
+        for (int component = 0; component < 3; component++)
+        {
+            vertex.position[component] = m_Position[component][i];
+            vertex.normal[component] = m_Normal[component][i];
+            vertex.tangent[component] = m_Tangent[component][i];
+        }
+    }
+}
+
+void SkinningInfluences::Resize(size_t vertexCount)
+{
+    for (int influence = 0; influence < 4; influence++)
+    {
+        m_Joints[influence].resize(vertexCount);
+        m_Weights[influence].resize(vertexCount);
+    }
+}
+
+void SkinningInfluences::Load(const std::vector<SkinningVertex>& skinningData)
+{
+    Resize(skinningData.size());
+    for (size_t i = 0; i < skinningData.size(); i++)
+    {
+        for (int influence = 0; influence < 4; influence++)
+        {
+            m_Joints[influence][i] = skinningData[i].joints[influence];
+            m_Weights[influence][i] = skinningData[i].weights[influence];
+        }
+    }
+}
+
+namespace
+{
+
+// a joint matrix is column major, only the upper 3x4 part is needed for affine transforms
+constexpr int MATRIX_STRIDE = 16;
+constexpr int AFFINE_ELEMENTS = 12;
+inline constexpr int ElementOffset(int column, int row) { return column * 4 + row; }
+inline constexpr int AffineIndex(int column, int row) { return column * 3 + row; }
+
+// a dual quaternion is its real part (x, y, z, w) followed by its dual part
+constexpr int DUAL_QUATERNION_STRIDE = 8;
+constexpr int DUAL_PART_OFFSET = 4;
+
+#if defined(RENDERSYS_SKINNING_AVX2)
+
+struct SimdOps
+{
+    static constexpr uint32_t WIDTH = 8;
+    static constexpr const char* NAME = "AVX2";
+    using Vec = __m256;
+    using Mask = __m256;
+    using Index = __m256i;
+
+    static Vec Zero() { return _mm256_setzero_ps(); }
+    static Vec Set1(float value) { return _mm256_set1_ps(value); }
+    static Vec Load(const float* ptr) { return _mm256_loadu_ps(ptr); }
+    static void Store(float* ptr, Vec v) { _mm256_storeu_ps(ptr, v); }
+    static Vec Add(Vec a, Vec b) { return _mm256_add_ps(a, b); }
+    static Vec Sub(Vec a, Vec b) { return _mm256_sub_ps(a, b); }
+    static Vec Mul(Vec a, Vec b) { return _mm256_mul_ps(a, b); }
+    static Vec MulAdd(Vec a, Vec b, Vec c) { return _mm256_fmadd_ps(a, b, c); }
+    static Vec Sqrt(Vec v) { return _mm256_sqrt_ps(v); }
+    static Vec Div(Vec a, Vec b) { return _mm256_div_ps(a, b); }
+    static Mask GreaterThan(Vec a, Vec b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static Vec Select(Mask mask, Vec a, Vec b) { return _mm256_blendv_ps(b, a, mask); }
+
+    static Index LoadJoints(const uint32_t* joints, int stride)
+    {
+        const __m256i indices = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(joints));
+        return _mm256_mullo_epi32(indices, _mm256_set1_epi32(stride));
+    }
+    static Vec Gather(const float* palette, Index offsets, int elementOffset)
+    {
+        return _mm256_i32gather_ps(palette + elementOffset, offsets, 4);
+    }
+};
+
+#elif defined(RENDERSYS_SKINNING_SSE2)
+
+struct SimdOps
+{
+    static constexpr uint32_t WIDTH = 4;
+    static constexpr const char* NAME = "SSE2";
+    using Vec = __m128;
+    using Mask = __m128;
+    struct Index { uint32_t m_Offsets[4]; };
+
+    static Vec Zero() { return _mm_setzero_ps(); }
+    static Vec Set1(float value) { return _mm_set1_ps(value); }
+    static Vec Load(const float* ptr) { return _mm_loadu_ps(ptr); }
+    static void Store(float* ptr, Vec v) { _mm_storeu_ps(ptr, v); }
+    static Vec Add(Vec a, Vec b) { return _mm_add_ps(a, b); }
+    static Vec Sub(Vec a, Vec b) { return _mm_sub_ps(a, b); }
+    static Vec Mul(Vec a, Vec b) { return _mm_mul_ps(a, b); }
+    static Vec MulAdd(Vec a, Vec b, Vec c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    static Vec Sqrt(Vec v) { return _mm_sqrt_ps(v); }
+    static Vec Div(Vec a, Vec b) { return _mm_div_ps(a, b); }
+    static Mask GreaterThan(Vec a, Vec b) { return _mm_cmpgt_ps(a, b); }
+    static Vec Select(Mask mask, Vec a, Vec b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+
+    static Index LoadJoints(const uint32_t* joints, uint32_t stride)
+    {
+        return Index{{joints[0] * stride, joints[1] * stride, joints[2] * stride, joints[3] * stride}};
+    }
+    static Vec Gather(const float* palette, const Index& index, int elementOffset)
+    {
+        return _mm_set_ps(palette[index.m_Offsets[3] + elementOffset],
+                        palette[index.m_Offsets[2] + elementOffset],
+                        palette[index.m_Offsets[1] + elementOffset],
+                        palette[index.m_Offsets[0] + elementOffset]);
+    }
+};
+
+#elif defined(RENDERSYS_SKINNING_NEON)
+
+struct SimdOps
+{
+    static constexpr uint32_t WIDTH = 4;
+    static constexpr const char* NAME = "NEON";
+    using Vec = float32x4_t;
+    using Mask = uint32x4_t;
+    struct Index { uint32_t m_Offsets[4]; };
+
+    static Vec Zero() { return vdupq_n_f32(0.0f); }
+    static Vec Set1(float value) { return vdupq_n_f32(value); }
+    static Vec Load(const float* ptr) { return vld1q_f32(ptr); }
+    static void Store(float* ptr, Vec v) { vst1q_f32(ptr, v); }
+    static Vec Add(Vec a, Vec b) { return vaddq_f32(a, b); }
+    static Vec Sub(Vec a, Vec b) { return vsubq_f32(a, b); }
+    static Vec Mul(Vec a, Vec b) { return vmulq_f32(a, b); }
+    static Vec MulAdd(Vec a, Vec b, Vec c) { return vmlaq_f32(c, a, b); }
+    static Vec Sqrt(Vec v)
+    {
+        // vsqrtq_f32 is AArch64 only
+        float lanes[4];
+        vst1q_f32(lanes, v);
+        for (float& lane : lanes)
+        {
+            lane = std::sqrt(lane);
+        }
+        return vld1q_f32(lanes);
+    }
+    static Vec Div(Vec a, Vec b)
+    {
+        // two Newton-Raphson steps on the reciprocal estimate are enough for unit vectors
+        float32x4_t reciprocal = vrecpeq_f32(b);
+        reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+        reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+        return vmulq_f32(a, reciprocal);
+    }
+    static Mask GreaterThan(Vec a, Vec b) { return vcgtq_f32(a, b); }
+    static Vec Select(Mask mask, Vec a, Vec b) { return vbslq_f32(mask, a, b); }
+
+    static Index LoadJoints(const uint32_t* joints, uint32_t stride)
+    {
+        return Index{{joints[0] * stride, joints[1] * stride, joints[2] * stride, joints[3] * stride}};
+    }
+    static Vec Gather(const float* palette, const Index& index, int elementOffset)
+    {
+        const float lanes[4] = {palette[index.m_Offsets[0] + elementOffset],
+                                palette[index.m_Offsets[1] + elementOffset],
+                                palette[index.m_Offsets[2] + elementOffset],
+                                palette[index.m_Offsets[3] + elementOffset]};
+        return vld1q_f32(lanes);
+    }
+};
+
+#endif
+
+void SkinRangeScalar(const SkinningStreams& bindPose, const SkinningInfluences& influences,
+                    const float* palette, SkinningStreams& skinned, uint32_t begin, uint32_t end)
+{
+    for (uint32_t i = begin; i < end; i++)
+    {
+        float skinMatrix[AFFINE_ELEMENTS] = {};
+        float weightSum = 0.0f;
+        for (int influence = 0; influence < 4; influence++)
+        {
+            const float weight = influences.m_Weights[influence][i];
+            const float* jointMatrix = palette + influences.m_Joints[influence][i] * MATRIX_STRIDE;
+            weightSum += weight;
+            for (int column = 0; column < 4; column++)
+            {
+                for (int row = 0; row < 3; row++)
+                {
+                    skinMatrix[AffineIndex(column, row)] += weight * jointMatrix[ElementOffset(column, row)];
+                }
+            }
+        }
+
+        // vertices which are not influenced by any joint keep their bind pose
+        if (!(weightSum > 0.0f))
+        {
+            for (int column = 0; column < 4; column++)
+            {
+                for (int row = 0; row < 3; row++)
+                {
+                    skinMatrix[AffineIndex(column, row)] = column == row ? 1.0f : 0.0f;
+                }
+            }
+        }
+
+        for (int row = 0; row < 3; row++)
+        {
+            skinned.m_Position[row][i] = skinMatrix[AffineIndex(0, row)] * bindPose.m_Position[0][i] +
+                                        skinMatrix[AffineIndex(1, row)] * bindPose.m_Position[1][i] +
+                                        skinMatrix[AffineIndex(2, row)] * bindPose.m_Position[2][i] +
+                                        skinMatrix[AffineIndex(3, row)];
+        }
+
+        auto transformDirection = [&skinMatrix, i](const std::array<std::vector<float>, 3>& in, std::array<std::vector<float>, 3>& out)
+        {
+            float direction[3];
+            for (int row = 0; row < 3; row++)
+            {
+                direction[row] = skinMatrix[AffineIndex(0, row)] * in[0][i] +
+                                skinMatrix[AffineIndex(1, row)] * in[1][i] +
+                                skinMatrix[AffineIndex(2, row)] * in[2][i];
+            }
+            const float length = std::sqrt(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+            const float invLength = length > 0.0f ? 1.0f / length : 1.0f;
+            for (int row = 0; row < 3; row++)
+            {
+                out[row][i] = direction[row] * invLength;
+            }
+        };
+        transformDirection(bindPose.m_Normal, skinned.m_Normal);
+        transformDirection(bindPose.m_Tangent, skinned.m_Tangent);
+    }
+}
+
+void RotateScalar(const float* real, const float* in, float* out)
+{
+    // v + 2 * r.xyz x (r.xyz x v + r.w * v)
+    const float t[3] = {real[1] * in[2] - real[2] * in[1] + real[3] * in[0],
+                        real[2] * in[0] - real[0] * in[2] + real[3] * in[1],
+                        real[0] * in[1] - real[1] * in[0] + real[3] * in[2]};
+    out[0] = in[0] + 2.0f * (real[1] * t[2] - real[2] * t[1]);
+    out[1] = in[1] + 2.0f * (real[2] * t[0] - real[0] * t[2]);
+    out[2] = in[2] + 2.0f * (real[0] * t[1] - real[1] * t[0]);
+}
+
+void SkinRangeDualQuaternionScalar(const SkinningStreams& bindPose, const SkinningInfluences& influences,
+                                    const float* palette, SkinningStreams& skinned, uint32_t begin, uint32_t end)
+{
+    for (uint32_t i = begin; i < end; i++)
+    {
+        float real[4] = {};
+        float dual[4] = {};
+        float weightSum = 0.0f;
+        const float* pivot = palette + influences.m_Joints[0][i] * DUAL_QUATERNION_STRIDE;
+        for (int influence = 0; influence < 4; influence++)
+        {
+            const float* jointDualQuaternion = palette + influences.m_Joints[influence][i] * DUAL_QUATERNION_STRIDE;
+            float weight = influences.m_Weights[influence][i];
+            weightSum += weight;
+            // q and -q are the same rotation, blend every influence in the hemisphere of the first one
+            const float hemisphere = jointDualQuaternion[0] * pivot[0] + jointDualQuaternion[1] * pivot[1] + 
+                                    jointDualQuaternion[2] * pivot[2] + jointDualQuaternion[3] * pivot[3];
+            if (hemisphere < 0.0f)
+            {
+                weight = -weight;
+            }
+            for (int element = 0; element < 4; element++)
+            {
+                real[element] += weight * jointDualQuaternion[element];
+                dual[element] += weight * jointDualQuaternion[DUAL_PART_OFFSET + element];
+            }
+        }
+
+        const float length = std::sqrt(real[0] * real[0] + real[1] * real[1] + real[2] * real[2] + real[3] * real[3]);
+        if (weightSum > 0.0f && length > 0.0f)
+        {
+            for (int element = 0; element < 4; element++)
+            {
+                real[element] /= length;
+                dual[element] /= length;
+            }
+        }
+        else
+        {
+            // vertices which are not influenced by any joint keep their bind pose
+            for (int element = 0; element < 4; element++)
+            {
+                real[element] = element == 3 ? 1.0f : 0.0f;
+                dual[element] = 0.0f;
+            }
+        }
+
+        // translation = 2 * (r.w * d.xyz - d.w * r.xyz + r.xyz x d.xyz)
+        const float translation[3] = {2.0f * (real[3] * dual[0] - dual[3] * real[0] + real[1] * dual[2] - real[2] * dual[1]),
+                                    2.0f * (real[3] * dual[1] - dual[3] * real[1] + real[2] * dual[0] - real[0] * dual[2]),
+                                    2.0f * (real[3] * dual[2] - dual[3] * real[2] + real[0] * dual[1] - real[1] * dual[0])};
+
+        float in[3], out[3];
+        for (int component = 0; component < 3; component++)
+        {
+            in[component] = bindPose.m_Position[component][i];
+        }
+        RotateScalar(real, in, out);
+        for (int component = 0; component < 3; component++)
+        {
+            skinned.m_Position[component][i] = out[component] + translation[component];
+        }
+
+        auto rotateDirection = [&real, i](const std::array<std::vector<float>, 3>& inStream, std::array<std::vector<float>, 3>& outStream)
+        {
+            float direction[3], rotated[3];
+            for (int component = 0; component < 3; component++)
+            {
+                direction[component] = inStream[component][i];
+            }
+            RotateScalar(real, direction, rotated);
+            const float length = std::sqrt(rotated[0] * rotated[0] + rotated[1] * rotated[1] + rotated[2] * rotated[2]);
+            const float invLength = length > 0.0f ? 1.0f / length : 1.0f;
+            for (int component = 0; component < 3; component++)
+            {
+                outStream[component][i] = rotated[component] * invLength;
+            }
+        };
+        rotateDirection(bindPose.m_Normal, skinned.m_Normal);
+        rotateDirection(bindPose.m_Tangent, skinned.m_Tangent);
+    }
+}
+
+#if defined(RENDERSYS_SKINNING_AVX2) || defined(RENDERSYS_SKINNING_SSE2) || defined(RENDERSYS_SKINNING_NEON)
+
+template <typename Simd>
+void Normalize(typename Simd::Vec* direction)
+{
+    using Vec = typename Simd::Vec;
+    const Vec lengthSquared = Simd::MulAdd(direction[0], direction[0],
+                                Simd::MulAdd(direction[1], direction[1],
+                                    Simd::Mul(direction[2], direction[2])));
+    const Vec length = Simd::Sqrt(lengthSquared);
+    const Vec one = Simd::Set1(1.0f);
+    const Vec invLength = Simd::Select(Simd::GreaterThan(length, Simd::Zero()), Simd::Div(one, length), one);
+    for (int component = 0; component < 3; component++)
+    {
+        direction[component] = Simd::Mul(direction[component], invLength);
+    }
+}
+
+template <typename Simd>
+void TransformDirection(const typename Simd::Vec* skinMatrix,
+                        const std::array<std::vector<float>, 3>& in, std::array<std::vector<float>, 3>& out, uint32_t i)
+{
+    using Vec = typename Simd::Vec;
+    const Vec x = Simd::Load(&in[0][i]);
+    const Vec y = Simd::Load(&in[1][i]);
+    const Vec z = Simd::Load(&in[2][i]);
+
+    Vec direction[3];
+    for (int row = 0; row < 3; row++)
+    {
+        direction[row] = Simd::MulAdd(skinMatrix[AffineIndex(0, row)], x,
+                            Simd::MulAdd(skinMatrix[AffineIndex(1, row)], y,
+                                Simd::Mul(skinMatrix[AffineIndex(2, row)], z)));
+    }
+
+    Normalize<Simd>(direction);
+    for (int row = 0; row < 3; row++)
+    {
+        Simd::Store(&out[row][i], direction[row]);
+    }
+}
+
+template <typename Simd>
+void SkinRangeSimd(const SkinningStreams& bindPose, const SkinningInfluences& influences,
+                    const float* palette, SkinningStreams& skinned, uint32_t begin, uint32_t end)
+{
+    using Vec = typename Simd::Vec;
+    uint32_t i = begin;
+    for (; i + Simd::WIDTH <= end; i += Simd::WIDTH)
+    {
+        // blend the four joint matrices of every lane
+        Vec skinMatrix[AFFINE_ELEMENTS];
+        for (auto& element : skinMatrix)
+        {
+            element = Simd::Zero();
+        }
+        Vec weightSum = Simd::Zero();
+        for (int influence = 0; influence < 4; influence++)
+        {
+            const Vec weight = Simd::Load(&influences.m_Weights[influence][i]);
+            const auto matrixOffsets = Simd::LoadJoints(&influences.m_Joints[influence][i], MATRIX_STRIDE);
+            weightSum = Simd::Add(weightSum, weight);
+            for (int column = 0; column < 4; column++)
+            {
+                for (int row = 0; row < 3; row++)
+                {
+                    Vec& element = skinMatrix[AffineIndex(column, row)];
+                    element = Simd::MulAdd(weight, Simd::Gather(palette, matrixOffsets, ElementOffset(column, row)), element);
+                }
+            }
+        }
+
+        // vertices which are not influenced by any joint keep their bind pose
+        const auto influenced = Simd::GreaterThan(weightSum, Simd::Zero());
+        for (int column = 0; column < 4; column++)
+        {
+            for (int row = 0; row < 3; row++)
+            {
+                Vec& element = skinMatrix[AffineIndex(column, row)];
+                element = Simd::Select(influenced, element, Simd::Set1(column == row ? 1.0f : 0.0f));
+            }
+        }
+
+        const Vec x = Simd::Load(&bindPose.m_Position[0][i]);
+        const Vec y = Simd::Load(&bindPose.m_Position[1][i]);
+        const Vec z = Simd::Load(&bindPose.m_Position[2][i]);
+        for (int row = 0; row < 3; row++)
+        {
+            const Vec position = Simd::MulAdd(skinMatrix[AffineIndex(0, row)], x,
+                                    Simd::MulAdd(skinMatrix[AffineIndex(1, row)], y,
+                                        Simd::MulAdd(skinMatrix[AffineIndex(2, row)], z, skinMatrix[AffineIndex(3, row)])));
+            Simd::Store(&skinned.m_Position[row][i], position);
+        }
+
+        TransformDirection<Simd>(skinMatrix, bindPose.m_Normal, skinned.m_Normal, i);
+        TransformDirection<Simd>(skinMatrix, bindPose.m_Tangent, skinned.m_Tangent, i);
+    }
+
+    SkinRangeScalar(bindPose, influences, palette, skinned, i, end);
+}
+
+template <typename Simd>
+void Rotate(const typename Simd::Vec* real, const typename Simd::Vec* in, typename Simd::Vec* out)
+{
+    using Vec = typename Simd::Vec;
+    // v + 2 * r.xyz x (r.xyz x v + r.w * v)
+    const Vec t[3] = {Simd::MulAdd(real[3], in[0], Simd::Sub(Simd::Mul(real[1], in[2]), Simd::Mul(real[2], in[1]))),
+                    Simd::MulAdd(real[3], in[1], Simd::Sub(Simd::Mul(real[2], in[0]), Simd::Mul(real[0], in[2]))),
+                    Simd::MulAdd(real[3], in[2], Simd::Sub(Simd::Mul(real[0], in[1]), Simd::Mul(real[1], in[0])))};
+    const Vec two = Simd::Set1(2.0f);
+    out[0] = Simd::MulAdd(two, Simd::Sub(Simd::Mul(real[1], t[2]), Simd::Mul(real[2], t[1])), in[0]);
+    out[1] = Simd::MulAdd(two, Simd::Sub(Simd::Mul(real[2], t[0]), Simd::Mul(real[0], t[2])), in[1]);
+    out[2] = Simd::MulAdd(two, Simd::Sub(Simd::Mul(real[0], t[1]), Simd::Mul(real[1], t[0])), in[2]);
+}
+
+template <typename Simd>
+void RotateDirection(const typename Simd::Vec* real,
+                    const std::array<std::vector<float>, 3>& in, std::array<std::vector<float>, 3>& out, uint32_t i)
+{
+    using Vec = typename Simd::Vec;
+    const Vec direction[3] = {Simd::Load(&in[0][i]), Simd::Load(&in[1][i]), Simd::Load(&in[2][i])};
+    Vec rotated[3];
+    Rotate<Simd>(real, direction, rotated);
+    Normalize<Simd>(rotated);
+    for (int component = 0; component < 3; component++)
+    {
+        Simd::Store(&out[component][i], rotated[component]);
+    }
+}
+
+template <typename Simd>
+void SkinRangeDualQuaternionSimd(const SkinningStreams& bindPose, const SkinningInfluences& influences,
+                                const float* palette, SkinningStreams& skinned, uint32_t begin, uint32_t end)
+{
+    using Vec = typename Simd::Vec;
+    uint32_t i = begin;
+    for (; i + Simd::WIDTH <= end; i += Simd::WIDTH)
+    {
+        Vec real[4], dual[4], pivot[4];
+        for (int element = 0; element < 4; element++)
+        {
+            real[element] = Simd::Zero();
+            dual[element] = Simd::Zero();
+        }
+        Vec weightSum = Simd::Zero();
+        for (int influence = 0; influence < 4; influence++)
+        {
+            Vec weight = Simd::Load(&influences.m_Weights[influence][i]);
+            const auto offsets = Simd::LoadJoints(&influences.m_Joints[influence][i], DUAL_QUATERNION_STRIDE);
+            weightSum = Simd::Add(weightSum, weight);
+
+            Vec jointReal[4];
+            for (int element = 0; element < 4; element++)
+            {
+                jointReal[element] = Simd::Gather(palette, offsets, element);
+            }
+            if (influence == 0)
+            {
+                for (int element = 0; element < 4; element++)
+                {
+                    pivot[element] = jointReal[element];
+                }
+            }
+
+            // q and -q are the same rotation, blend every influence in the hemisphere of the first one
+            const Vec hemisphere = Simd::MulAdd(jointReal[0], pivot[0],
+                                    Simd::MulAdd(jointReal[1], pivot[1],
+                                        Simd::MulAdd(jointReal[2], pivot[2], Simd::Mul(jointReal[3], pivot[3]))));
+            weight = Simd::Select(Simd::GreaterThan(Simd::Zero(), hemisphere), Simd::Sub(Simd::Zero(), weight), weight);
+            for (int element = 0; element < 4; element++)
+            {
+                real[element] = Simd::MulAdd(weight, jointReal[element], real[element]);
+                dual[element] = Simd::MulAdd(weight, Simd::Gather(palette, offsets, DUAL_PART_OFFSET + element), dual[element]);
+            }
+        }
+
+        const Vec lengthSquared = Simd::MulAdd(real[0], real[0],
+                                    Simd::MulAdd(real[1], real[1],
+                                        Simd::MulAdd(real[2], real[2], Simd::Mul(real[3], real[3]))));
+        const Vec length = Simd::Sqrt(lengthSquared);
+        const Vec invLength = Simd::Div(Simd::Set1(1.0f), length);
+        // vertices which are not influenced by any joint keep their bind pose
+        const auto influenced = Simd::GreaterThan(weightSum, Simd::Zero());
+        const auto valid = Simd::GreaterThan(length, Simd::Zero());
+        for (int element = 0; element < 4; element++)
+        {
+            const Vec identityReal = Simd::Set1(element == 3 ? 1.0f : 0.0f);
+            real[element] = Simd::Select(valid, Simd::Mul(real[element], invLength), identityReal);
+            real[element] = Simd::Select(influenced, real[element], identityReal);
+            dual[element] = Simd::Select(valid, Simd::Mul(dual[element], invLength), Simd::Zero());
+            dual[element] = Simd::Select(influenced, dual[element], Simd::Zero());
+        }
+
+        // translation = 2 * (r.w * d.xyz - d.w * r.xyz + r.xyz x d.xyz)
+        const Vec two = Simd::Set1(2.0f);
+        const Vec translation[3] = {
+            Simd::Mul(two, Simd::Add(Simd::Sub(Simd::Mul(real[3], dual[0]), Simd::Mul(dual[3], real[0])), 
+                                    Simd::Sub(Simd::Mul(real[1], dual[2]), Simd::Mul(real[2], dual[1])))),
+            Simd::Mul(two, Simd::Add(Simd::Sub(Simd::Mul(real[3], dual[1]), Simd::Mul(dual[3], real[1])), 
+                                    Simd::Sub(Simd::Mul(real[2], dual[0]), Simd::Mul(real[0], dual[2])))),
+            Simd::Mul(two, Simd::Add(Simd::Sub(Simd::Mul(real[3], dual[2]), Simd::Mul(dual[3], real[2])), 
+                                    Simd::Sub(Simd::Mul(real[0], dual[1]), Simd::Mul(real[1], dual[0]))))};
+
+        const Vec position[3] = {Simd::Load(&bindPose.m_Position[0][i]), 
+                                Simd::Load(&bindPose.m_Position[1][i]), 
+                                Simd::Load(&bindPose.m_Position[2][i])};
+        Vec rotated[3];
+        Rotate<Simd>(real, position, rotated);
+        for (int component = 0; component < 3; component++)
+        {
+            Simd::Store(&skinned.m_Position[component][i], Simd::Add(rotated[component], translation[component]));
+        }
+
+        RotateDirection<Simd>(real, bindPose.m_Normal, skinned.m_Normal, i);
+        RotateDirection<Simd>(real, bindPose.m_Tangent, skinned.m_Tangent, i);
+    }
+
+    SkinRangeDualQuaternionScalar(bindPose, influences, palette, skinned, i, end);
+}
+
+#endif
+
+} // namespace
+
+void CpuSkinning::Skin(const SkinningStreams& bindPose, const SkinningInfluences& influences,
+                        const std::vector<glm::mat4>& jointMatrices, SkinningStreams& skinned, JobSystem& jobSystem)
+{
+    assert(bindPose.Size() == influences.Size());
+    skinned.Resize(bindPose.Size());
+    jobSystem.ParallelFor(static_cast<uint32_t>(bindPose.Size()), VERTICES_PER_JOB,
+        [&](uint32_t begin, uint32_t end)
+        {
+            SkinRange(bindPose, influences, jointMatrices, skinned, begin, end);
+        });
+}
+
+void CpuSkinning::SkinRange(const SkinningStreams& bindPose, const SkinningInfluences& influences,
+                            const std::vector<glm::mat4>& jointMatrices, SkinningStreams& skinned,
+                            uint32_t begin, uint32_t end)
+{
+    assert(!jointMatrices.empty());
+    assert(end <= skinned.Size());
+    const float* palette = glm::value_ptr(jointMatrices[0]);
+#if defined(RENDERSYS_SKINNING_AVX2) || defined(RENDERSYS_SKINNING_SSE2) || defined(RENDERSYS_SKINNING_NEON)
+    SkinRangeSimd<SimdOps>(bindPose, influences, palette, skinned, begin, end);
+#else
+    SkinRangeScalar(bindPose, influences, palette, skinned, begin, end);
+#endif
+}
+
+void CpuSkinning::SkinRangeReference(const SkinningStreams& bindPose, const SkinningInfluences& influences,
+                                    const std::vector<glm::mat4>& jointMatrices, SkinningStreams& skinned,
+                                    uint32_t begin, uint32_t end)
+{
+    assert(!jointMatrices.empty());
+    assert(end <= skinned.Size());
+    SkinRangeScalar(bindPose, influences, glm::value_ptr(jointMatrices[0]), skinned, begin, end);
+}
+
+void CpuSkinning::Skin(const SkinningStreams& bindPose, const SkinningInfluences& influences,
+                        const std::vector<DualQuaternion>& jointDualQuaternions, SkinningStreams& skinned, JobSystem& jobSystem)
+{
+    assert(bindPose.Size() == influences.Size());
+    skinned.Resize(bindPose.Size());
+    jobSystem.ParallelFor(static_cast<uint32_t>(bindPose.Size()), VERTICES_PER_JOB,
+        [&](uint32_t begin, uint32_t end)
+        {
+            SkinRange(bindPose, influences, jointDualQuaternions, skinned, begin, end);
+        });
+}
+
+void CpuSkinning::Skin(const SkinningStreams& bindPose, const SkinningInfluences& influences,
+                        const Skeleton& skeleton, SkinningStreams& skinned, JobSystem& jobSystem)
+{
+    if (skeleton.m_SkinningMethod == SkinningMethod::DUAL_QUATERNION)
+    {
+        Skin(bindPose, influences, skeleton.m_ShaderData.m_FinalJointsDualQuaternions, skinned, jobSystem);
+    }
+    else
+    {
+        Skin(bindPose, influences, skeleton.m_ShaderData.m_FinalJointsMatrices, skinned, jobSystem);
+    }
+}
+
+void CpuSkinning::SkinRange(const SkinningStreams& bindPose, const SkinningInfluences& influences,
+                            const std::vector<DualQuaternion>& jointDualQuaternions, SkinningStreams& skinned,
+                            uint32_t begin, uint32_t end)
+{
+    assert(!jointDualQuaternions.empty());
+    assert(end <= skinned.Size());
+    const float* palette = glm::value_ptr(jointDualQuaternions[0].m_Real);
+#if defined(RENDERSYS_SKINNING_AVX2) || defined(RENDERSYS_SKINNING_SSE2) || defined(RENDERSYS_SKINNING_NEON)
+    SkinRangeDualQuaternionSimd<SimdOps>(bindPose, influences, palette, skinned, begin, end);
+#else
+    SkinRangeDualQuaternionScalar(bindPose, influences, palette, skinned, begin, end);
+#endif
+}
+
+void CpuSkinning::SkinRangeReference(const SkinningStreams& bindPose, const SkinningInfluences& influences,
+                                    const std::vector<DualQuaternion>& jointDualQuaternions, SkinningStreams& skinned,
+                                    uint32_t begin, uint32_t end)
+{
+    assert(!jointDualQuaternions.empty());
+    assert(end <= skinned.Size());
+    SkinRangeDualQuaternionScalar(bindPose, influences, glm::value_ptr(jointDualQuaternions[0].m_Real), skinned, begin, end);
+}
+
+const char* CpuSkinning::GetInstructionSet()
+{
+#if defined(RENDERSYS_SKINNING_AVX2) || defined(RENDERSYS_SKINNING_SSE2) || defined(RENDERSYS_SKINNING_NEON)
+    return SimdOps::NAME;
+#else
+    return "Scalar";
+#endif
+}
+
+uint32_t CpuSkinning::GetSimdWidth()
+{
+#if defined(RENDERSYS_SKINNING_AVX2) || defined(RENDERSYS_SKINNING_SSE2) || defined(RENDERSYS_SKINNING_NEON)
+    return SimdOps::WIDTH;
+#else
+    return 1;
+#endif
+}
+
+} // namespace RenderSys
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <stdint.h>
+#include <glm/ext.hpp>
+#include <RenderSys/Buffer.h>
+#include <RenderSys/JobSystem.h>
+#include <RenderSys/Scene/Mesh.h>
+#include <RenderSys/Scene/Skeleton.h>
+
+namespace RenderSys
+{
+
+// Structure of arrays copy of the skinned vertex attributes, one stream per component.
+struct SkinningStreams
+{
+    void Resize(size_t vertexCount);
+    size_t Size() const { return m_Position[0].size(); }
+    void Load(const VertexBuffer& vertexBuffer);
+    void Store(VertexBuffer& vertexBuffer) const; // only position, normal and tangent are written
+
+    std::array<std::vector<float>, 3> m_Position;
+    std::array<std::vector<float>, 3> m_Normal;
+    std::array<std::vector<float>, 3> m_Tangent;
+};
+
+// four joint influences per vertex, stream k holds the k-th joint (and weight) of every vertex
+struct SkinningInfluences
+{
+    void Resize(size_t vertexCount);
+    size_t Size() const { return m_Weights[0].size(); }
+    void Load(const std::vector<SkinningVertex>& skinningData);
+
+    std::array<std::vector<uint32_t>, 4> m_Joints;
+    std::array<std::vector<float>, 4> m_Weights;
+};
+
+// Linear blend or dual quaternion skinning on the CPU, for runs without a GPU (headless, software rasterized).
+// The vectorized kernel handles SIMD_WIDTH vertices per iteration with AVX2 (when the library is built
+// with RENDERSYS_ENABLE_AVX2), SSE2 or NEON, and falls back to the scalar reference for the remainder.
+class CpuSkinning
+{
+public:
+    static constexpr uint32_t VERTICES_PER_JOB = 4096;
+
+    // splits the vertices over the job system, the output streams are resized to match the input
+    static void Skin(const SkinningStreams& bindPose, const SkinningInfluences& influences, 
+                    const std::vector<glm::mat4>& jointMatrices, SkinningStreams& skinned, 
+                    JobSystem& jobSystem = JobSystem::Get());
+    static void Skin(const SkinningStreams& bindPose, const SkinningInfluences& influences, 
+                    const std::vector<DualQuaternion>& jointDualQuaternions, SkinningStreams& skinned, 
+                    JobSystem& jobSystem = JobSystem::Get());
+    // uses the palette of skeleton.m_SkinningMethod
+    static void Skin(const SkinningStreams& bindPose, const SkinningInfluences& influences, 
+                    const Skeleton& skeleton, SkinningStreams& skinned, 
+                    JobSystem& jobSystem = JobSystem::Get());
+
+    // single threaded kernels over [begin, end), the output streams have to be sized already
+    static void SkinRange(const SkinningStreams& bindPose, const SkinningInfluences& influences, 
+                        const std::vector<glm::mat4>& jointMatrices, SkinningStreams& skinned, 
+                        uint32_t begin, uint32_t end);
+    static void SkinRangeReference(const SkinningStreams& bindPose, const SkinningInfluences& influences, 
+                                const std::vector<glm::mat4>& jointMatrices, SkinningStreams& skinned, 
+                                uint32_t begin, uint32_t end);
+    static void SkinRange(const SkinningStreams& bindPose, const SkinningInfluences& influences, 
+                        const std::vector<DualQuaternion>& jointDualQuaternions, SkinningStreams& skinned, 
+                        uint32_t begin, uint32_t end);
+    static void SkinRangeReference(const SkinningStreams& bindPose, const SkinningInfluences& influences, 
+                                const std::vector<DualQuaternion>& jointDualQuaternions, SkinningStreams& skinned, 
+                                uint32_t begin, uint32_t end);
+
+    static const char* GetInstructionSet();
+    static uint32_t GetSimdWidth();
+};
+
+} // namespace RenderSys
@@ -1,6 +1,8 @@
 #include "GLTFModel.h"
 
 #include <iostream>
+#include <algorithm>
+#include <limits>
 
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #define TINYGLTF_IMPLEMENTATION
@@ -8,8 +10,10 @@
 
 #include <RenderSys/Components/TransformComponent.h>
 #include <RenderSys/Components/MeshComponent.h>
+#include <RenderSys/Components/AnimationComponents.h>
 #include <RenderSys/Scene/Scene.h>
 #include <RenderSys/MaterialFeatures.h>
+#include <RenderSys/MeshOptimizer.h>
 #include "Skeleton.h"
 #include "Animation.h"
 
@@ -19,6 +23,7 @@ namespace RenderSys
 GLTFModel::GLTFModel(Scene& scene)
     : m_sceneRef(scene)
     , m_gltfModel(std::make_unique<tinygltf::Model>())
+    , m_skeleton(std::make_shared<Skeleton>())
 {
 }
 
@@ -91,27 +96,65 @@ void GLTFModel::computeProps()
     s_indexCount = 0;
 }
 
-RenderSys::SubMesh GLTFModel::loadPrimitive(const tinygltf::Primitive &primitive, std::shared_ptr<MeshData> modelData, const uint32_t indexCount)
+RenderSys::SubMesh GLTFModel::loadPrimitive(const tinygltf::Primitive &primitive, std::shared_ptr<MeshData> modelData, const uint32_t indexCount,
+                                             const bool directVertices)
 {
     assert(primitive.attributes.find("POSITION") != primitive.attributes.end()); // position is mandatory
     const tinygltf::Accessor &posAccessor = m_gltfModel->accessors[primitive.attributes.find("POSITION")->second];
     const auto vertexCount = static_cast<uint32_t>(posAccessor.count);
     assert(vertexCount > 0);
-    const uint32_t vertexStart = modelData->vertices.size();
-    modelData->vertices.resize(vertexStart + vertexCount);
+    const auto vertexStart = static_cast<uint32_t>(modelData->getVertexCount());
+    if (!directVertices)
+    {
+        modelData->vertices.resize(vertexStart + vertexCount);
+    }
 
     const tinygltf::BufferView &positionBufferView = m_gltfModel->bufferViews[posAccessor.bufferView];
     const auto* positionBuffer = reinterpret_cast<const float *>(&(m_gltfModel->buffers[positionBufferView.buffer].data[posAccessor.byteOffset + positionBufferView.byteOffset]));
     const auto posByteStride = posAccessor.ByteStride(positionBufferView) ? 
                                 (posAccessor.ByteStride(positionBufferView) / sizeof(float)) : tinygltf::GetNumComponentsInType(TINYGLTF_TYPE_VEC3);
 
+    glm::vec3 boundsMin(std::numeric_limits<float>::max());
+    glm::vec3 boundsMax(std::numeric_limits<float>::lowest());
     for (size_t v = 0; v < vertexCount; v++) 
     {
-        ModelVertex& vert = modelData->vertices[v + vertexStart];
-        vert.pos = glm::vec4(glm::make_vec3(&positionBuffer[v * posByteStride]), 1.0f);
+        const glm::vec3 position = glm::make_vec3(&positionBuffer[v * posByteStride]);
+        boundsMin = glm::min(boundsMin, position);
+        boundsMax = glm::max(boundsMax, position);
+        if (!directVertices)
+        {
+            modelData->vertices[v + vertexStart].pos = position;
+        }
     }
 
-    if (primitive.attributes.find("TEXCOORD_0") != primitive.attributes.end())
+    if (directVertices)
+    {
+        VertexAccessorRange range;
+        range.firstVertex = vertexStart;
+        range.vertexCount = vertexCount;
+        range.positions = positionBuffer;
+        range.positionStride = posByteStride;
+        const auto findStream = [&](const char* attribute, const float*& stream, size_t& stride)
+        {
+            const auto attributeIter = primitive.attributes.find(attribute);
+            if (attributeIter == primitive.attributes.end())
+            {
+                return;
+            }
+            const tinygltf::Accessor &accessor = m_gltfModel->accessors[attributeIter->second];
+            assert(accessor.componentType == TINYGLTF_PARAMETER_TYPE_FLOAT);
+            const tinygltf::BufferView &bufferView = m_gltfModel->bufferViews[accessor.bufferView];
+            stream = reinterpret_cast<const float *>(&(m_gltfModel->buffers[bufferView.buffer].data[accessor.byteOffset + bufferView.byteOffset]));
+            stride = accessor.ByteStride(bufferView) ? (accessor.ByteStride(bufferView) / sizeof(float)) : tinygltf::GetNumComponentsInType(accessor.type);
+        };
+        findStream("NORMAL", range.normals, range.normalStride);
+        findStream("TEXCOORD_0", range.uv0, range.uv0Stride);
+        findStream("TANGENT", range.tangents, range.tangentStride);
+        modelData->accessorRanges.push_back(range);
+        modelData->accessorVertexCount += vertexCount;
+    }
+
+    if (!directVertices && primitive.attributes.find("TEXCOORD_0") != primitive.attributes.end())
     {
         const tinygltf::Accessor &accessor = m_gltfModel->accessors[primitive.attributes.find("TEXCOORD_0")->second];
         const tinygltf::BufferView &bufferView = m_gltfModel->bufferViews[accessor.bufferView];
@@ -125,7 +168,7 @@ RenderSys::SubMesh GLTFModel::loadPrimitive(const tinygltf::Primitive &primitive
         }
     }
 
-    if (primitive.attributes.find("NORMAL") != primitive.attributes.end())
+    if (!directVertices && primitive.attributes.find("NORMAL") != primitive.attributes.end())
     {
         const tinygltf::Accessor &accessor = m_gltfModel->accessors[primitive.attributes.find("NORMAL")->second];
         const tinygltf::BufferView &bufferView = m_gltfModel->bufferViews[accessor.bufferView];
@@ -139,7 +182,7 @@ RenderSys::SubMesh GLTFModel::loadPrimitive(const tinygltf::Primitive &primitive
         }
     }
 
-    if (primitive.attributes.find("TANGENT") != primitive.attributes.end())
+    if (!directVertices && primitive.attributes.find("TANGENT") != primitive.attributes.end())
     {
         const tinygltf::Accessor &accessor = m_gltfModel->accessors[primitive.attributes.find("TANGENT")->second];
         const tinygltf::BufferView &bufferView = m_gltfModel->bufferViews[accessor.bufferView];
@@ -153,8 +196,50 @@ RenderSys::SubMesh GLTFModel::loadPrimitive(const tinygltf::Primitive &primitive
         }
     }
 
+    if (!directVertices && primitive.attributes.find("JOINTS_0") != primitive.attributes.end() &&
+        primitive.attributes.find("WEIGHTS_0") != primitive.attributes.end())
+    {
+        const tinygltf::Accessor &jointAccessor = m_gltfModel->accessors[primitive.attributes.find("JOINTS_0")->second];
+        const tinygltf::BufferView &jointBufferView = m_gltfModel->bufferViews[jointAccessor.bufferView];
+        const auto* jointBuffer = &(m_gltfModel->buffers[jointBufferView.buffer].data[jointAccessor.byteOffset + jointBufferView.byteOffset]);
+        const auto jointComponentSize = tinygltf::GetComponentSizeInBytes(jointAccessor.componentType);
+        const auto jointByteStride = jointAccessor.ByteStride(jointBufferView) ? jointAccessor.ByteStride(jointBufferView) : 4 * jointComponentSize;
+
+        const tinygltf::Accessor &weightAccessor = m_gltfModel->accessors[primitive.attributes.find("WEIGHTS_0")->second];
+        const tinygltf::BufferView &weightBufferView = m_gltfModel->bufferViews[weightAccessor.bufferView];
+        const auto* weightBuffer = reinterpret_cast<const float *>(&(m_gltfModel->buffers[weightBufferView.buffer].data[weightAccessor.byteOffset + weightBufferView.byteOffset]));
+        const auto weightByteStride = weightAccessor.ByteStride(weightBufferView) ? 
+                                        (weightAccessor.ByteStride(weightBufferView) / sizeof(float)) : tinygltf::GetNumComponentsInType(TINYGLTF_TYPE_VEC4);
+        assert(weightAccessor.componentType == TINYGLTF_PARAMETER_TYPE_FLOAT);
+
+        for (size_t v = 0; v < vertexCount; v++) 
+        {
+            ModelVertex& vert = modelData->vertices[v + vertexStart];
+            const auto* joints = jointBuffer + v * jointByteStride;
+            switch (jointAccessor.componentType) {
+            case TINYGLTF_PARAMETER_TYPE_UNSIGNED_SHORT: {
+                const uint16_t *buf = reinterpret_cast<const uint16_t*>(joints);
+                vert.joint0 = glm::uvec4(buf[0], buf[1], buf[2], buf[3]);
+                break;
+            }
+            case TINYGLTF_PARAMETER_TYPE_UNSIGNED_BYTE: {
+                vert.joint0 = glm::uvec4(joints[0], joints[1], joints[2], joints[3]);
+                break;
+            }
+            default:
+                std::cerr << "Joint component type " << jointAccessor.componentType << " not supported!" << std::endl;
+                assert(false);
+            }
+            vert.weight0 = glm::make_vec4(&weightBuffer[v * weightByteStride]);
+        }
+        modelData->hasSkinning = true;
+    }
+
     RenderSys::SubMesh prim;
     prim.m_VertexCount = vertexCount;
+    prim.m_BoundsMin = boundsMin;
+    prim.m_BoundsMax = boundsMax;
+    prim.m_HasBounds = true;
     if (primitive.indices > -1)
     {
         const uint32_t indexStart = modelData->indices.size();
@@ -207,11 +292,112 @@ void GLTFModel::loadMesh(const tinygltf::Mesh& gltfMesh, entt::entity& nodeEntit
 {
     const std::string meshName = gltfMesh.name.empty() ? "Mesh" : gltfMesh.name;
     MeshComponent& meshComponent{m_sceneRef.m_Registry.emplace<MeshComponent>(nodeEntity, meshName, std::make_shared<Mesh>(std::make_shared<MeshData>()))};
+    // the simplifier, the meshlet builder and the skinning read the ModelVertex copy
+    bool directVertices = m_directVertices && !m_generateLods && !m_generateMeshlets;
+    for (const auto &gltfPrimitive : gltfMesh.primitives)
+    {
+        directVertices &= gltfPrimitive.attributes.find("JOINTS_0") == gltfPrimitive.attributes.end();
+    }
     uint32_t localIndexCount = 0;
     for (const auto &gltfPrimitive : gltfMesh.primitives)
     {
-        meshComponent.m_Mesh->subMeshes.push_back(loadPrimitive(gltfPrimitive, meshComponent.m_Mesh->m_meshData, localIndexCount));
+        meshComponent.m_Mesh->subMeshes.push_back(loadPrimitive(gltfPrimitive, meshComponent.m_Mesh->m_meshData, localIndexCount, directVertices));
+    }
+    if (directVertices)
+    {
+        m_directMeshData.push_back(meshComponent.m_Mesh->m_meshData);
+    }
+    optimizeMesh(meshName, *meshComponent.m_Mesh);
+    // reorders the optimized triangles of the submeshes, the levels of detail are appended behind them
+    if (m_generateMeshlets)
+    {
+        MeshletBuilder::BuildMeshlets(*meshComponent.m_Mesh);
+    }
+    if (m_generateLods)
+    {
+        MeshSimplifier::BuildLodChains(*meshComponent.m_Mesh, m_lodSettings);
+    }
+}
+
+void GLTFModel::optimizeMesh(const std::string& meshName, Mesh& mesh)
+{
+    auto& meshData = *mesh.m_meshData;
+    VertexCacheStats before;
+    VertexCacheStats after;
+    float triangleCount = 0.0f;
+    for (const auto& subMesh : mesh.subMeshes)
+    {
+        if (subMesh.m_IndexCount < 3)
+        {
+            continue;
+        }
+        uint32_t* indices = meshData.indices.data() + subMesh.m_FirstIndex;
+        // the analysis costs as much as a pass over the indices, it only runs for the statistics
+        VertexCacheStats subMeshBefore;
+        if (m_printOptimizationStats)
+        {
+            subMeshBefore = MeshOptimizer::AnalyzeVertexCache(indices, subMesh.m_IndexCount);
+        }
+        // without the ModelVertex copy the overdraw order has no positions and the vertices stay in the order of the file
+        if (meshData.vertices.empty())
+        {
+            MeshOptimizer::OptimizeVertexCache(indices, subMesh.m_IndexCount);
+        }
+        else
+        {
+            MeshOptimizer::OptimizeOverdraw(indices, subMesh.m_IndexCount, &meshData.vertices[0].pos, sizeof(ModelVertex));
+        }
+        // the skinning data of the model is kept in the order of the file
+        if (!meshData.hasSkinning && !meshData.vertices.empty())
+        {
+            MeshOptimizer::OptimizeVertexFetch(meshData.vertices, indices, subMesh.m_IndexCount);
+        }
+        if (!m_printOptimizationStats)
+        {
+            continue;
+        }
+        const auto subMeshAfter = MeshOptimizer::AnalyzeVertexCache(indices, subMesh.m_IndexCount);
+        // weighted by the triangles of the submesh
+        const float triangles = static_cast<float>(subMesh.m_IndexCount / 3);
+        before.m_Acmr += subMeshBefore.m_Acmr * triangles;
+        before.m_Atvr += subMeshBefore.m_Atvr * triangles;
+        after.m_Acmr += subMeshAfter.m_Acmr * triangles;
+        after.m_Atvr += subMeshAfter.m_Atvr * triangles;
+        triangleCount += triangles;
+    }
+
+    if (triangleCount > 0.0f)
+    {
+        std::cout << "GLTFModel: optimized " << meshName << " [ACMR=" << before.m_Acmr / triangleCount << " -> " << after.m_Acmr / triangleCount
+                    << "], [ATVR=" << before.m_Atvr / triangleCount << " -> " << after.m_Atvr / triangleCount << "]" << std::endl;
+    }
+}
+
+void GLTFModel::releaseSourceData()
+{
+    size_t releasedBytes = 0;
+    // moving the buffers keeps their data where the accessor ranges point
+    if (!m_directMeshData.empty())
+    {
+        auto buffers = std::make_shared<std::vector<tinygltf::Buffer>>(std::move(m_gltfModel->buffers));
+        for (auto& meshData : m_directMeshData)
+        {
+            meshData->accessorSource = buffers;
+        }
+        m_directMeshData.clear();
+        m_gltfModel->buffers.clear();
+    }
+    for (auto& buffer : m_gltfModel->buffers)
+    {
+        releasedBytes += buffer.data.capacity();
+        std::vector<unsigned char>().swap(buffer.data);
+    }
+    for (auto& image : m_gltfModel->images)
+    {
+        releasedBytes += image.image.capacity();
+        std::vector<unsigned char>().swap(image.image);
     }
+    std::cout << "GLTFModel: released " << releasedBytes / (1024 * 1024) << "MB of buffers and images" << std::endl;
 }
 
 void GLTFModel::loadJointData()
@@ -270,8 +456,6 @@ void GLTFModel::loadInverseBindMatrices()
     std::memcpy(m_inverseBindMatrices.data(), &buffer.data.at(0) + bufferView.byteOffset, bufferView.byteLength);
 }
 
-auto g_Skeleton = std::make_shared<Skeleton>();
-std::vector<std::shared_ptr<SkeletalAnimation>> g_animations;
 void GLTFModel::loadjointMatrices()
 {
     // traverse through the graph again and compute JointMatrices
@@ -282,27 +466,27 @@ void GLTFModel::loadjointMatrices()
     //         rootNode->calculateJointMatrices(m_inverseBindMatrices, m_nodeToJoint, m_jointMatrices, m_registryRef);
     // }
 
-    g_Skeleton->Update();
+    m_skeleton->Update();
 
 }
 
 // recursive function via global gltf nodes (which have children)
 // tree structure links (local) skeleton joints
-void LoadJoint(int globalGltfNodeIndex, int parentJoint, std::unique_ptr<tinygltf::Model>& gltfModel)
+void LoadJoint(Skeleton& skeleton, int globalGltfNodeIndex, int parentJoint, std::unique_ptr<tinygltf::Model>& gltfModel)
 {
-    int currentJoint = g_Skeleton->m_GlobalNodeToJointIndex[globalGltfNodeIndex];
-    g_Skeleton->m_Joints[currentJoint].m_ParentJoint = parentJoint;
+    int currentJoint = skeleton.m_GlobalNodeToJointIndex[globalGltfNodeIndex];
+    skeleton.m_Joints[currentJoint].m_ParentJoint = parentJoint;
 
     // process children (if any)
     size_t numberOfChildren = gltfModel->nodes[globalGltfNodeIndex].children.size();
     if (numberOfChildren > 0)
     {
-        g_Skeleton->m_Joints[currentJoint].m_Children.resize(numberOfChildren);
+        skeleton.m_Joints[currentJoint].m_Children.resize(numberOfChildren);
         for (size_t childIndex = 0; childIndex < numberOfChildren; ++childIndex)
         {
             uint32_t globalGltfNodeIndexForChild = gltfModel->nodes[globalGltfNodeIndex].children[childIndex];
-            g_Skeleton->m_Joints[currentJoint].m_Children[childIndex] = g_Skeleton->m_GlobalNodeToJointIndex[globalGltfNodeIndexForChild];
-            LoadJoint(globalGltfNodeIndexForChild, currentJoint, gltfModel);
+            skeleton.m_Joints[currentJoint].m_Children[childIndex] = skeleton.m_GlobalNodeToJointIndex[globalGltfNodeIndexForChild];
+            LoadJoint(skeleton, globalGltfNodeIndexForChild, currentJoint, gltfModel);
         }
     }
 }
@@ -322,27 +506,27 @@ void GLTFModel::loadSkeletons()
     // set up number of joints
     size_t numberOfJoints = glTFSkin.joints.size();
     // resize the joints vector of the skeleton object (to be filled)
-    g_Skeleton->m_Joints.resize(numberOfJoints);
-    g_Skeleton->m_ShaderData.m_FinalJointsMatrices.resize(numberOfJoints);
+    m_skeleton->m_Joints.resize(numberOfJoints);
+    m_skeleton->m_ShaderData.m_FinalJointsMatrices.resize(numberOfJoints);
 
     // set up name of skeleton
-    g_Skeleton->m_Name = glTFSkin.name;
+    m_skeleton->m_Name = glTFSkin.name;
 
     // loop over all joints from gltf model and fill the skeleton with joints
     for (size_t jointIndex = 0; jointIndex < numberOfJoints; ++jointIndex)
     {
         int globalGltfNodeIndex = glTFSkin.joints[jointIndex];
-        auto& joint = g_Skeleton->m_Joints[jointIndex]; // just a reference for easier code
+        auto& joint = m_skeleton->m_Joints[jointIndex]; // just a reference for easier code
         joint.m_InverseBindMatrix = m_inverseBindMatrices[jointIndex];
         joint.m_Name = m_gltfModel->nodes[globalGltfNodeIndex].name;
 
         // set up map "global node" to "joint index"
-        g_Skeleton->m_GlobalNodeToJointIndex[globalGltfNodeIndex] = jointIndex;
+        m_skeleton->m_GlobalNodeToJointIndex[globalGltfNodeIndex] = jointIndex;
     }
 
     int rootJoint = glTFSkin.joints[0]; // the here always works but the gltf field skins.skeleton can be ignored
 
-    LoadJoint(rootJoint, NO_PARENT, m_gltfModel); // recursive function to fill the skeleton with joints and their children
+    LoadJoint(*m_skeleton, rootJoint, NO_PARENT, m_gltfModel); // recursive function to fill the skeleton with joints and their children
 }
 
 void GLTFModel::loadAnimations()
@@ -469,18 +653,34 @@ void GLTFModel::loadAnimations()
                 //LOG_CORE_CRITICAL("path not supported");
             }
         }
-        g_animations.push_back(animation);
+        m_animations.push_back(animation);
     }
 
     // testing begin
-    if (g_animations.size() > 0)
+    if (m_animations.size() > 0)
     {
-        g_animations[0]->Start();
-        g_animations[0]->Update(0.1f, *g_Skeleton);
+        m_animations[0]->Start();
+        m_animations[0]->Update(0.1f, *m_skeleton);
     }
     // testing end
 }
 
+void GLTFModel::loadAnimationComponents()
+{
+    if (m_skeleton->m_Joints.empty() || m_animations.empty() || m_skinnedEntities.empty())
+    {
+        return;
+    }
+
+    // the skinned meshes of the model are one character, they share its skeleton and the first of them plays the clips
+    for (auto entity : m_skinnedEntities)
+    {
+        m_sceneRef.m_Registry.emplace_or_replace<SkeletonComponent>(entity, m_skeleton);
+    }
+    auto& animationComponent = m_sceneRef.m_Registry.emplace_or_replace<AnimationComponent>(m_skinnedEntities.front());
+    animationComponent.m_Animations.assign(m_animations.begin(), m_animations.end());
+}
+
 void GLTFModel::applyVertexSkinning(RenderSys::VertexBuffer& vertexBuffer)
 {
     if (m_jointVec.size() == 0 || m_weightVec.size() == 0)
@@ -488,20 +688,30 @@ void GLTFModel::applyVertexSkinning(RenderSys::VertexBuffer& vertexBuffer)
         return;
     }
 
-    for (int jointIndex = 0; jointIndex < m_jointVec.size(); ++jointIndex) 
+    if (m_skinningInfluences.Size() != vertexBuffer.size())
     {
-        auto jointMatrix = g_Skeleton->m_ShaderData.m_FinalJointsMatrices[m_jointVec[jointIndex].x];
-        glm::vec4 weightIndex = glm::make_vec4(m_weightVec.at(jointIndex));
-        glm::mat4 skinMat =
-            weightIndex.x * jointMatrix +
-            weightIndex.y * jointMatrix +
-            weightIndex.z * jointMatrix +
-            weightIndex.w * jointMatrix;
-        // Apply the skinning matrix to the vertex position
-        vertexBuffer.vertices.at(jointIndex).position = jointMatrix * glm::vec4(vertexBuffer.vertices.at(jointIndex).position, 1.0f);
-        // Apply the skinning matrix to the vertex normal
-        vertexBuffer.vertices.at(jointIndex).normal = jointMatrix * glm::vec4(vertexBuffer.vertices.at(jointIndex).normal, 0.0f);
+        // the skinning attributes are only read for the first primitive, the remaining vertices keep their bind pose
+        const size_t vertexCount = std::min({vertexBuffer.size(), m_jointVec.size(), m_weightVec.size()});
+        if (vertexCount != vertexBuffer.size())
+        {
+            std::cout << "Skinning attributes do not cover the whole vertex buffer, skinning " << vertexCount 
+                        << " of " << vertexBuffer.size() << " vertices" << std::endl;
+        }
+
+        m_skinningInfluences.Resize(vertexBuffer.size());
+        for (size_t i = 0; i < vertexCount; ++i)
+        {
+            for (int influence = 0; influence < 4; ++influence)
+            {
+                m_skinningInfluences.m_Joints[influence][i] = m_jointVec[i][influence];
+                m_skinningInfluences.m_Weights[influence][i] = m_weightVec[i][influence];
+            }
+        }
     }
+
+    m_bindPoseStreams.Load(vertexBuffer);
+    CpuSkinning::Skin(m_bindPoseStreams, m_skinningInfluences, *m_skeleton, m_skinnedStreams);
+    m_skinnedStreams.Store(vertexBuffer);
 }
 
 void GLTFModel::loadTextures()
@@ -716,6 +926,11 @@ void GLTFModel::traverse(const uint32_t parent, uint32_t nodeIndex)
         
     }
 
+    if (node.skin > -1)
+    {
+        m_skinnedEntities.push_back(nodeEntity);
+    }
+
     loadTransform(nodeEntity, node, parent);
 
     size_t childNodeCount = node.children.size();
@@ -8,6 +8,9 @@
 #include <RenderSys/Texture.h>
 #include <RenderSys/Material.h>
 #include <RenderSys/Scene/Mesh.h>
+#include <RenderSys/Scene/CpuSkinning.h>
+#include <RenderSys/Scene/MeshSimplifier.h>
+#include <RenderSys/Scene/MeshletBuilder.h>
 #include <entt/entt.hpp>
 
 namespace tinygltf
@@ -22,6 +25,8 @@ namespace RenderSys
 {
 class MeshData;
 class Scene;
+struct Skeleton;
+class SkeletalAnimation;
 class GLTFModel
 {
 public:
@@ -32,6 +37,16 @@ public:
     GLTFModel(GLTFModel&&) = delete;
     GLTFModel &operator=(GLTFModel&&) = delete;
     bool load(const std::filesystem::path &filePath);
+    // the meshes loaded afterwards get a level of detail chain per submesh
+    void setGenerateLods(const bool generateLods, const MeshSimplifierSettings& settings) { m_generateLods = generateLods; m_lodSettings = settings; }
+    // the meshes loaded afterwards are split into meshlets for the GPU culling, see MeshletBuilder
+    void setGenerateMeshlets(const bool generateMeshlets) { m_generateMeshlets = generateMeshlets; }
+    // prints the vertex cache statistics of every mesh before and after its optimization
+    void setPrintOptimizationStats(const bool printOptimizationStats) { m_printOptimizationStats = printOptimizationStats; }
+    // the meshes loaded afterwards keep no ModelVertex copy when nothing on the CPU reads it, that is without
+    // skinning, levels of detail and meshlets. Their vertices are converted from the accessors when the vertex
+    // buffer is written, only the vertex cache order of their indices is optimized
+    void setDirectVertices(const bool directVertices) { m_directVertices = directVertices; }
     void computeProps();
     
     void loadTextures();
@@ -41,16 +56,22 @@ public:
     void loadjointMatrices();
     void loadSkeletons();
     void loadAnimations();
+    void loadAnimationComponents();
     void applyVertexSkinning(RenderSys::VertexBuffer& vertexBuffer);
     void getNodeGraphs();
+    // frees the buffers and decoded images of the file once the model is loaded, the meshes and textures keep their own copies
+    void releaseSourceData();
     void printNodeGraph() const;
     const std::vector<std::shared_ptr<RenderSys::Texture>>& GetTextures() const { return m_textures; }
     const std::vector<std::shared_ptr<RenderSys::Material>>& GetMaterials() const { return m_materials; }
 private:
     void loadTransform(entt::entity& nodeEntity, const tinygltf::Node &gltfNode, const uint32_t parent);
     std::vector<TextureSampler> loadTextureSamplers();
-    RenderSys::SubMesh loadPrimitive(const tinygltf::Primitive &primitive, std::shared_ptr<MeshData> modelData, const uint32_t indexCount);
+    RenderSys::SubMesh loadPrimitive(const tinygltf::Primitive &primitive, std::shared_ptr<MeshData> modelData, const uint32_t indexCount,
+                                     const bool directVertices);
     void loadMesh(const tinygltf::Mesh& gltfMesh, entt::entity& nodeEntity);
+    // reorders the indices of each submesh for the vertex cache and overdraw, and the vertices for fetching
+    void optimizeMesh(const std::string& meshName, Mesh& mesh);
     void traverse(const uint32_t parent, uint32_t nodeIndex);
     std::shared_ptr<RenderSys::Material> createMaterial(int materialIndex);
 
@@ -74,6 +95,13 @@ private:
     Scene& m_sceneRef;
     std::unique_ptr<tinygltf::Model> m_gltfModel;
     std::filesystem::path m_modelFilePath;
+    bool m_generateLods = false;
+    MeshSimplifierSettings m_lodSettings;
+    bool m_generateMeshlets = false;
+    bool m_printOptimizationStats = false;
+    bool m_directVertices = false;
+    // their accessor ranges point into the buffers of the file, they get them in releaseSourceData()
+    std::vector<std::shared_ptr<MeshData>> m_directMeshData;
 
     std::vector<std::shared_ptr<RenderSys::Texture>> m_textures;
     std::vector<std::shared_ptr<RenderSys::Material>> m_materials;
@@ -82,6 +110,13 @@ private:
     std::vector<glm::mat4> m_jointMatrices;
     std::vector<glm::tvec4<uint16_t>> m_jointVec;
     std::vector<glm::vec4> m_weightVec;
+    SkinningInfluences m_skinningInfluences;
+    SkinningStreams m_bindPoseStreams;
+    SkinningStreams m_skinnedStreams;
+
+    std::shared_ptr<Skeleton> m_skeleton;
+    std::vector<std::shared_ptr<SkeletalAnimation>> m_animations;
+    std::vector<entt::entity> m_skinnedEntities;
 };
 
 }
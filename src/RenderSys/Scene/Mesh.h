@@ -1,6 +1,7 @@
 #pragma once
 #include <glm/ext.hpp>
 #include <RenderSys/Buffer.h>
+#include <RenderSys/VertexPacking.h>
 #include <RenderSys/Material.h>
 
 namespace RenderSys
@@ -17,6 +18,56 @@ struct ModelVertex {
     glm::vec3 tangent;
 };
 
+// per-vertex skinning inputs, laid out to match the std430 struct of the skinning compute shader
+struct alignas(16) SkinningVertex {
+    glm::uvec4 joints;
+    glm::vec4 weights;
+};
+
+static_assert(sizeof(SkinningVertex) == 32);
+
+// a cluster of triangles of a submesh, built by MeshletBuilder, its indices are contiguous in the index buffer.
+// Laid out to match the std430 struct of meshlet-cull-compute.glsl, the bounds are in the space of the mesh
+struct alignas(16) Meshlet {
+    glm::vec3 center{0.0f};
+    float radius = 0.0f;
+    // normal cone of the triangles, the meshlet is back facing when the viewer is behind all of their planes
+    glm::vec3 coneAxis{0.0f};
+    // sine of the half angle of the normal cone, 1 when the triangles face too many directions to be culled together
+    float coneCutoff = 1.0f;
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+};
+
+static_assert(sizeof(Meshlet) == 48);
+
+// the vertices of a primitive that are never copied into MeshData::vertices, they are converted from the
+// accessors of the file when the vertex buffer is written. Strides are in floats, missing attributes are zero
+struct VertexAccessorRange
+{
+    uint32_t firstVertex = 0;
+    uint32_t vertexCount = 0;
+    const float* positions = nullptr;
+    size_t positionStride = 0;
+    const float* normals = nullptr;
+    size_t normalStride = 0;
+    const float* uv0 = nullptr;
+    size_t uv0Stride = 0;
+    const float* tangents = nullptr;
+    size_t tangentStride = 0;
+
+    RenderSys::Vertex getVertex(const size_t v) const
+    {
+        RenderSys::Vertex vertex;
+        vertex.position = glm::make_vec3(positions + v * positionStride);
+        vertex.normal = normals ? glm::make_vec3(normals + v * normalStride) : glm::vec3(0.0f);
+        vertex.texcoord0 = uv0 ? glm::make_vec2(uv0 + v * uv0Stride) : glm::vec2(0.0f);
+        vertex.color = glm::vec3(0.0f);
+        vertex.tangent = tangents ? glm::make_vec3(tangents + v * tangentStride) : glm::vec3(0.0f);
+        return vertex;
+    }
+};
+
 struct MeshData 
 {
     MeshData() = default;
@@ -29,21 +80,107 @@ struct MeshData
     const RenderSys::VertexBuffer getVertexBufferForRenderer() const
     {
         RenderSys::VertexBuffer buffer;
-        buffer.resize(vertices.size());
-        for (size_t i = 0; i < buffer.size(); i++)
+        buffer.resize(getVertexCount());
+        writeVertexBufferForRenderer(buffer.vertices.data());
+        return buffer;
+    }
+
+    // the same vertices as getVertexBufferForRenderer() in the 28 byte PackedVertex, vertex colors included
+    const RenderSys::PackedVertexBuffer getPackedVertexBufferForRenderer(const PackedUvFormat uvFormat = PackedUvFormat::Float16) const
+    {
+        RenderSys::PackedVertexBuffer buffer;
+        buffer.uvFormat = uvFormat;
+        buffer.resize(getVertexCount());
+        writePackedVertexBufferForRenderer(buffer.vertices.data(), uvFormat);
+        return buffer;
+    }
+
+    // converts the vertices straight into destination, e.g. the mapped memory of a vertex buffer, every vertex
+    // is written once and as a whole, destination is never read, which write combined memory would make slow
+    void writeVertexBufferForRenderer(RenderSys::Vertex* destination) const
+    {
+        for (const auto& range : accessorRanges)
         {
-            buffer[i].position = vertices[i].pos;
-            buffer[i].normal = vertices[i].normal;
-            buffer[i].texcoord0 = vertices[i].uv0;
-            buffer[i].tangent = vertices[i].tangent;
+            for (size_t v = 0; v < range.vertexCount; v++)
+            {
+                destination[range.firstVertex + v] = range.getVertex(v);
+            }
         }
-        return buffer;
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            RenderSys::Vertex vertex;
+            vertex.position = vertices[i].pos;
+            vertex.normal = vertices[i].normal;
+            vertex.texcoord0 = vertices[i].uv0;
+            vertex.color = glm::vec3(0.0f);
+            vertex.tangent = vertices[i].tangent;
+            destination[i] = vertex;
+        }
+    }
+
+    void writePackedVertexBufferForRenderer(RenderSys::PackedVertex* destination, const PackedUvFormat uvFormat) const
+    {
+        for (const auto& range : accessorRanges)
+        {
+            for (size_t v = 0; v < range.vertexCount; v++)
+            {
+                destination[range.firstVertex + v] = VertexPacking::Pack(range.getVertex(v), uvFormat);
+            }
+        }
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            RenderSys::Vertex vertex;
+            vertex.position = vertices[i].pos;
+            vertex.normal = vertices[i].normal;
+            vertex.texcoord0 = vertices[i].uv0;
+            vertex.color = glm::vec3(vertices[i].color);
+            vertex.tangent = vertices[i].tangent;
+            destination[i] = VertexPacking::Pack(vertex, uvFormat);
+        }
+    }
+
+    std::vector<SkinningVertex> getSkinningDataForRenderer() const
+    {
+        std::vector<SkinningVertex> skinningData(vertices.size());
+        for (size_t i = 0; i < skinningData.size(); i++)
+        {
+            skinningData[i].joints = vertices[i].joint0;
+            skinningData[i].weights = vertices[i].weight0;
+        }
+        return skinningData;
+    }
+
+    // of vertices or of the accessor ranges, a mesh uses one of them
+    size_t getVertexCount() const { return vertices.empty() ? accessorVertexCount : vertices.size(); }
+
+    // once the vertex buffer is written, the buffers of the file can go
+    void releaseVertexAccessors()
+    {
+        accessorRanges.clear();
+        accessorSource.reset();
     }
 
     std::vector<ModelVertex> vertices;
+    // instead of vertices, see GLTFModel::setDirectVertices()
+    std::vector<VertexAccessorRange> accessorRanges;
+    size_t accessorVertexCount = 0;
+    // keeps the buffers alive the ranges point into
+    std::shared_ptr<const void> accessorSource;
     std::vector<uint32_t> indices;
+    // of all submeshes, each of them references its range
+    std::vector<Meshlet> meshlets;
+    bool hasSkinning = false; // joint0 and weight0 of the vertices are valid
 };
     
+// a coarser version of a submesh, its indices are stored behind the ones of the submeshes in the same index buffer
+struct SubMeshLod
+{
+    uint32_t m_FirstIndex = 0;
+    uint32_t m_IndexCount = 0;
+    // largest distance to the surface of the submesh, in the space of the mesh
+    float m_Error = 0.0f;
+};
+
 class Resource;
 struct SubMesh
 {
@@ -52,6 +189,15 @@ struct SubMesh
     uint32_t m_IndexCount = 0;
     uint32_t m_VertexCount = 0;
     uint32_t m_InstanceCount = 1;
+    // bind pose bounds in the space of the mesh, used for culling
+    glm::vec3 m_BoundsMin{0.0f};
+    glm::vec3 m_BoundsMax{0.0f};
+    bool m_HasBounds = false;
+    // from fine to coarse, see MeshSimplifier
+    std::vector<SubMeshLod> m_Lods;
+    // range of MeshData::meshlets covering the indices of the submesh, empty without meshlets
+    uint32_t m_FirstMeshlet = 0;
+    uint32_t m_MeshletCount = 0;
     std::shared_ptr<Material> m_Material = nullptr;
     std::shared_ptr<Resource> m_Resource = nullptr;
 };
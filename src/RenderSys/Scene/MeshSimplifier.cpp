@@ -0,0 +1,391 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+
+namespace RenderSys
+{
+
+namespace
+{
+
+// sum of the squared distances to a set of planes as a symmetric 4x4 matrix, in double because
+// the summed terms cancel each other when the quadric is evaluated near its minimum
+struct Quadric
+{
+    double m_XX = 0.0, m_XY = 0.0, m_XZ = 0.0, m_XW = 0.0;
+    double m_YY = 0.0, m_YZ = 0.0, m_YW = 0.0;
+    double m_ZZ = 0.0, m_ZW = 0.0;
+    double m_WW = 0.0;
+
+    void AddPlane(const glm::dvec3& normal, const double distance)
+    {
+        m_XX += normal.x * normal.x; m_XY += normal.x * normal.y; m_XZ += normal.x * normal.z; m_XW += normal.x * distance;
+        m_YY += normal.y * normal.y; m_YZ += normal.y * normal.z; m_YW += normal.y * distance;
+        m_ZZ += normal.z * normal.z; m_ZW += normal.z * distance;
+        m_WW += distance * distance;
+    }
+
+    void Add(const Quadric& other)
+    {
+        m_XX += other.m_XX; m_XY += other.m_XY; m_XZ += other.m_XZ; m_XW += other.m_XW;
+        m_YY += other.m_YY; m_YZ += other.m_YZ; m_YW += other.m_YW;
+        m_ZZ += other.m_ZZ; m_ZW += other.m_ZW;
+        m_WW += other.m_WW;
+    }
+
+    double Evaluate(const glm::dvec3& p) const
+    {
+        const double error = m_XX * p.x * p.x + 2.0 * m_XY * p.x * p.y + 2.0 * m_XZ * p.x * p.z + 2.0 * m_XW * p.x
+                            + m_YY * p.y * p.y + 2.0 * m_YZ * p.y * p.z + 2.0 * m_YW * p.y
+                            + m_ZZ * p.z * p.z + 2.0 * m_ZW * p.z
+                            + m_WW;
+        return std::max(error, 0.0);
+    }
+};
+
+// moves vertex m_From onto vertex m_To, stale when either vertex changed after it was queued
+struct Collapse
+{
+    double m_Cost = 0.0;
+    uint32_t m_From = 0;
+    uint32_t m_To = 0;
+    uint32_t m_FromVersion = 0;
+    uint32_t m_ToVersion = 0;
+
+    bool operator>(const Collapse& other) const { return m_Cost > other.m_Cost; }
+};
+
+uint64_t EdgeKey(const uint32_t a, const uint32_t b)
+{
+    return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+}
+
+bool Contains(const std::array<uint32_t, 3>& triangle, const uint32_t vertex)
+{
+    return triangle[0] == vertex || triangle[1] == vertex || triangle[2] == vertex;
+}
+
+glm::dvec3 TriangleNormal(const glm::dvec3& p0, const glm::dvec3& p1, const glm::dvec3& p2)
+{
+    return glm::cross(p1 - p0, p2 - p0);
+}
+
+} // namespace
+
+void MeshSimplifier::Simplify(const std::vector<ModelVertex>& vertices, const uint32_t* indices, const uint32_t indexCount,
+                            const std::vector<uint32_t>& targetIndexCounts, const float maxError, std::vector<Level>& levels)
+{
+    levels.clear();
+    if (indexCount < 3 || targetIndexCounts.empty())
+    {
+        return;
+    }
+
+    // the indices of a submesh cover a small range of the shared vertices
+    uint32_t minIndex = std::numeric_limits<uint32_t>::max();
+    uint32_t maxIndex = 0;
+    for (uint32_t i = 0; i < indexCount; ++i)
+    {
+        minIndex = std::min(minIndex, indices[i]);
+        maxIndex = std::max(maxIndex, indices[i]);
+    }
+    const uint32_t vertexCount = maxIndex - minIndex + 1;
+    std::vector<glm::dvec3> positions(vertexCount);
+    for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+    {
+        positions[vertex] = glm::dvec3(vertices[minIndex + vertex].pos);
+    }
+
+    std::vector<std::array<uint32_t, 3>> triangles;
+    triangles.reserve(indexCount / 3);
+    for (uint32_t i = 0; i + 2 < indexCount; i += 3)
+    {
+        const std::array<uint32_t, 3> triangle = { indices[i] - minIndex, indices[i + 1] - minIndex, indices[i + 2] - minIndex };
+        if (triangle[0] != triangle[1] && triangle[1] != triangle[2] && triangle[0] != triangle[2])
+        {
+            triangles.push_back(triangle);
+        }
+    }
+    std::vector<uint8_t> triangleAlive(triangles.size(), 1);
+    uint32_t aliveTriangles = static_cast<uint32_t>(triangles.size());
+
+    std::vector<Quadric> quadrics(vertexCount);
+    std::vector<std::vector<uint32_t>> vertexTriangles(vertexCount);
+    std::unordered_map<uint64_t, uint32_t> edgeUses;
+    edgeUses.reserve(triangles.size() * 3);
+    for (uint32_t triangleIndex = 0; triangleIndex < triangles.size(); ++triangleIndex)
+    {
+        const auto& triangle = triangles[triangleIndex];
+        glm::dvec3 normal = TriangleNormal(positions[triangle[0]], positions[triangle[1]], positions[triangle[2]]);
+        const double length = glm::length(normal);
+        if (length > 0.0)
+        {
+            normal /= length;
+            const double distance = -glm::dot(normal, positions[triangle[0]]);
+            for (const uint32_t vertex : triangle)
+            {
+                quadrics[vertex].AddPlane(normal, distance);
+            }
+        }
+        for (uint32_t corner = 0; corner < 3; ++corner)
+        {
+            vertexTriangles[triangle[corner]].push_back(triangleIndex);
+            edgeUses[EdgeKey(triangle[corner], triangle[(corner + 1) % 3])]++;
+        }
+    }
+
+    // edges of one triangle are open borders or seams, edges of more than two are not manifold
+    std::vector<uint8_t> locked(vertexCount, 0);
+    for (const auto& [edge, uses] : edgeUses)
+    {
+        if (uses != 2)
+        {
+            locked[edge >> 32] = 1;
+            locked[edge & 0xffffffffu] = 1;
+        }
+    }
+
+    std::vector<uint32_t> versions(vertexCount, 0);
+    std::vector<uint8_t> removed(vertexCount, 0);
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> collapses;
+    auto queueCollapse = [&](const uint32_t from, const uint32_t to)
+    {
+        if (locked[from])
+        {
+            return;
+        }
+        Quadric quadric = quadrics[from];
+        quadric.Add(quadrics[to]);
+        collapses.push({ quadric.Evaluate(positions[to]), from, to, versions[from], versions[to] });
+    };
+    for (const auto& [edge, uses] : edgeUses)
+    {
+        const uint32_t a = static_cast<uint32_t>(edge >> 32);
+        const uint32_t b = static_cast<uint32_t>(edge & 0xffffffffu);
+        queueCollapse(a, b);
+        queueCollapse(b, a);
+    }
+
+    double maxCost = 0.0;
+    auto addLevel = [&]()
+    {
+        Level& level = levels.emplace_back();
+        level.m_Indices.reserve(aliveTriangles * 3);
+        for (uint32_t triangleIndex = 0; triangleIndex < triangles.size(); ++triangleIndex)
+        {
+            if (triangleAlive[triangleIndex])
+            {
+                for (const uint32_t vertex : triangles[triangleIndex])
+                {
+                    level.m_Indices.push_back(vertex + minIndex);
+                }
+            }
+        }
+        level.m_Error = static_cast<float>(std::sqrt(maxCost));
+    };
+
+    const double maxCostAllowed = static_cast<double>(maxError) * static_cast<double>(maxError);
+    size_t nextTarget = 0;
+    std::vector<uint32_t> neighbours;
+    while (nextTarget < targetIndexCounts.size() && !collapses.empty())
+    {
+        const Collapse collapse = collapses.top();
+        collapses.pop();
+        const uint32_t from = collapse.m_From;
+        const uint32_t to = collapse.m_To;
+        if (removed[from] || removed[to] || versions[from] != collapse.m_FromVersion || versions[to] != collapse.m_ToVersion)
+        {
+            continue;
+        }
+        if (collapse.m_Cost > maxCostAllowed)
+        {
+            break;
+        }
+
+        // the remaining triangles around the vertex must neither flip nor collapse to a line
+        bool sharesEdge = false;
+        bool flips = false;
+        for (const uint32_t triangleIndex : vertexTriangles[from])
+        {
+            if (!triangleAlive[triangleIndex])
+            {
+                continue;
+            }
+            const auto& triangle = triangles[triangleIndex];
+            if (Contains(triangle, to))
+            {
+                sharesEdge = true;
+                continue;
+            }
+            std::array<glm::dvec3, 3> corners = { positions[triangle[0]], positions[triangle[1]], positions[triangle[2]] };
+            const glm::dvec3 normalBefore = TriangleNormal(corners[0], corners[1], corners[2]);
+            for (uint32_t corner = 0; corner < 3; ++corner)
+            {
+                if (triangle[corner] == from)
+                {
+                    corners[corner] = positions[to];
+                }
+            }
+            const glm::dvec3 normalAfter = TriangleNormal(corners[0], corners[1], corners[2]);
+            if (glm::dot(normalBefore, normalAfter) <= 0.0)
+            {
+                flips = true;
+                break;
+            }
+        }
+        if (!sharesEdge || flips)
+        {
+            continue;
+        }
+
+        maxCost = std::max(maxCost, collapse.m_Cost);
+        for (const uint32_t triangleIndex : vertexTriangles[from])
+        {
+            if (!triangleAlive[triangleIndex])
+            {
+                continue;
+            }
+            auto& triangle = triangles[triangleIndex];
+            if (Contains(triangle, to))
+            {
+                triangleAlive[triangleIndex] = 0;
+                aliveTriangles--;
+                continue;
+            }
+            for (auto& vertex : triangle)
+            {
+                if (vertex == from)
+                {
+                    vertex = to;
+                }
+            }
+            vertexTriangles[to].push_back(triangleIndex);
+        }
+        vertexTriangles[from].clear();
+        removed[from] = 1;
+        versions[from]++;
+        quadrics[to].Add(quadrics[from]);
+        versions[to]++;
+
+        // the cost of every edge around the merged vertex changed
+        auto& toTriangles = vertexTriangles[to];
+        toTriangles.erase(std::remove_if(toTriangles.begin(), toTriangles.end(),
+                            [&](const uint32_t triangleIndex) { return !triangleAlive[triangleIndex]; }), toTriangles.end());
+        neighbours.clear();
+        for (const uint32_t triangleIndex : toTriangles)
+        {
+            for (const uint32_t vertex : triangles[triangleIndex])
+            {
+                if (vertex != to)
+                {
+                    neighbours.push_back(vertex);
+                }
+            }
+        }
+        std::sort(neighbours.begin(), neighbours.end());
+        neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+        for (const uint32_t neighbour : neighbours)
+        {
+            queueCollapse(neighbour, to);
+            queueCollapse(to, neighbour);
+        }
+
+        if (aliveTriangles * 3 <= targetIndexCounts[nextTarget])
+        {
+            addLevel();
+            while (nextTarget < targetIndexCounts.size() && aliveTriangles * 3 <= targetIndexCounts[nextTarget])
+            {
+                nextTarget++;
+            }
+        }
+    }
+
+    // stopped by the error limit, what was reached so far is still a coarser level
+    const size_t previousIndexCount = levels.empty() ? triangles.size() * 3 : levels.back().m_Indices.size();
+    if (nextTarget < targetIndexCounts.size() && aliveTriangles * 3 < previousIndexCount)
+    {
+        addLevel();
+    }
+}
+
+void MeshSimplifier::BuildLodChain(MeshData& meshData, SubMesh& subMesh, const MeshSimplifierSettings& settings)
+{
+    subMesh.m_Lods.clear();
+    if (subMesh.m_IndexCount / 3 <= settings.m_MinTriangles)
+    {
+        return;
+    }
+
+    std::vector<uint32_t> targetIndexCounts;
+    uint32_t targetIndexCount = subMesh.m_IndexCount;
+    for (uint32_t lod = 0; lod < std::min(settings.m_LodCount, MAX_LODS); ++lod)
+    {
+        targetIndexCount = static_cast<uint32_t>(static_cast<float>(targetIndexCount) * settings.m_Reduction) / 3 * 3;
+        if (targetIndexCount / 3 < settings.m_MinTriangles)
+        {
+            break;
+        }
+        targetIndexCounts.push_back(targetIndexCount);
+    }
+    if (targetIndexCounts.empty())
+    {
+        return;
+    }
+
+    glm::vec3 boundsMin = subMesh.m_BoundsMin;
+    glm::vec3 boundsMax = subMesh.m_BoundsMax;
+    if (!subMesh.m_HasBounds)
+    {
+        boundsMin = glm::vec3(std::numeric_limits<float>::max());
+        boundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+        for (uint32_t i = 0; i < subMesh.m_IndexCount; ++i)
+        {
+            const glm::vec3& position = meshData.vertices[meshData.indices[subMesh.m_FirstIndex + i]].pos;
+            boundsMin = glm::min(boundsMin, position);
+            boundsMax = glm::max(boundsMax, position);
+        }
+    }
+    const float maxError = glm::distance(boundsMin, boundsMax) * settings.m_MaxRelativeError;
+
+    std::vector<Level> levels;
+    Simplify(meshData.vertices, meshData.indices.data() + subMesh.m_FirstIndex, subMesh.m_IndexCount, targetIndexCounts, maxError, levels);
+
+    uint32_t previousIndexCount = subMesh.m_IndexCount;
+    for (const auto& level : levels)
+    {
+        const auto levelIndexCount = static_cast<uint32_t>(level.m_Indices.size());
+        // a level which saves little is not worth its indices
+        if (levelIndexCount == 0 || levelIndexCount > previousIndexCount * 9 / 10)
+        {
+            continue;
+        }
+        SubMeshLod lod;
+        lod.m_FirstIndex = static_cast<uint32_t>(meshData.indices.size());
+        lod.m_IndexCount = levelIndexCount;
+        lod.m_Error = level.m_Error;
+        meshData.indices.insert(meshData.indices.end(), level.m_Indices.begin(), level.m_Indices.end());
+        subMesh.m_Lods.push_back(lod);
+        previousIndexCount = levelIndexCount;
+    }
+}
+
+void MeshSimplifier::BuildLodChains(Mesh& mesh, const MeshSimplifierSettings& settings)
+{
+    // skinned vertices move away from the surface the levels were simplified against
+    if (!mesh.m_meshData || mesh.m_meshData->hasSkinning)
+    {
+        return;
+    }
+    for (auto& subMesh : mesh.subMeshes)
+    {
+        BuildLodChain(*mesh.m_meshData, subMesh, settings);
+    }
+}
+
+} // namespace RenderSys
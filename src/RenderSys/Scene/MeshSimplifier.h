@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <RenderSys/Scene/Mesh.h>
+
+namespace RenderSys
+{
+
+struct MeshSimplifierSettings
+{
+    // coarser levels per submesh, at most MeshSimplifier::MAX_LODS
+    uint32_t m_LodCount = 4;
+    // index count of a level relative to the previous one
+    float m_Reduction = 0.5f;
+    // no level has fewer triangles
+    uint32_t m_MinTriangles = 32;
+    // largest error of a level relative to the diagonal of the submesh bounds
+    float m_MaxRelativeError = 0.05f;
+};
+
+// Quadric error metric simplification (Garland and Heckbert) by half edge collapses, a vertex is always
+// collapsed into one of its neighbours, so the simplified triangles index the vertices of the original
+// mesh and every level of detail shares its vertex buffer. Vertices on open borders and attribute seams
+// (where the vertices are split) stay in place, the silhouette and the texture mapping are kept.
+class MeshSimplifier
+{
+public:
+    // coarser levels per submesh, in addition to the submesh itself
+    static constexpr uint32_t MAX_LODS = 4;
+
+    struct Level
+    {
+        std::vector<uint32_t> m_Indices;
+        // upper bound of the distance between the simplified and the original surface
+        float m_Error = 0.0f;
+    };
+
+    // simplifies the triangle list and keeps a copy of its indices each time the index count falls
+    // below the next of the decreasing targets, stops at the first collapse with an error above maxError
+    static void Simplify(const std::vector<ModelVertex>& vertices, const uint32_t* indices, const uint32_t indexCount,
+                        const std::vector<uint32_t>& targetIndexCounts, const float maxError, std::vector<Level>& levels);
+
+    // appends the levels of the submesh to the index buffer of the mesh data and fills subMesh.m_Lods,
+    // has to run before the index buffer is uploaded
+    static void BuildLodChain(MeshData& meshData, SubMesh& subMesh, const MeshSimplifierSettings& settings = {});
+    // every submesh of the mesh, skinned meshes are left alone
+    static void BuildLodChains(Mesh& mesh, const MeshSimplifierSettings& settings = {});
+};
+
+} // namespace RenderSys
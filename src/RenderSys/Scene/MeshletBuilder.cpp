@@ -0,0 +1,263 @@
+#include "MeshletBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace RenderSys
+{
+
+namespace
+{
+
+constexpr uint32_t NO_TRIANGLE = ~0u;
+constexpr uint32_t NO_MESHLET = ~0u;
+// below this the normal cone opens wider than about 84 degrees and hardly any view direction culls it
+constexpr float MIN_CONE_DOT = 0.1f;
+
+} // namespace
+
+void MeshletBuilder::ComputeBounds(const std::vector<ModelVertex>& vertices, const uint32_t* indices, const uint32_t indexCount, Meshlet& meshlet)
+{
+    glm::vec3 boundsMin(std::numeric_limits<float>::max());
+    glm::vec3 boundsMax(std::numeric_limits<float>::lowest());
+    for (uint32_t i = 0; i < indexCount; ++i)
+    {
+        boundsMin = glm::min(boundsMin, vertices[indices[i]].pos);
+        boundsMax = glm::max(boundsMax, vertices[indices[i]].pos);
+    }
+    meshlet.center = (boundsMin + boundsMax) * 0.5f;
+    meshlet.radius = 0.0f;
+    for (uint32_t i = 0; i < indexCount; ++i)
+    {
+        meshlet.radius = std::max(meshlet.radius, glm::distance(meshlet.center, vertices[indices[i]].pos));
+    }
+
+    // every triangle counts the same, a large one would otherwise hide the directions of the small ones
+    glm::vec3 normalSum(0.0f);
+    for (uint32_t i = 0; i + 2 < indexCount; i += 3)
+    {
+        const glm::vec3& p0 = vertices[indices[i]].pos;
+        const glm::vec3 normal = glm::cross(vertices[indices[i + 1]].pos - p0, vertices[indices[i + 2]].pos - p0);
+        const float length = glm::length(normal);
+        if (length > 0.0f)
+        {
+            normalSum += normal / length;
+        }
+    }
+
+    meshlet.coneAxis = glm::vec3(0.0f);
+    meshlet.coneCutoff = 1.0f;
+    const float axisLength = glm::length(normalSum);
+    if (axisLength <= 0.0f)
+    {
+        return;
+    }
+    const glm::vec3 axis = normalSum / axisLength;
+    float minDot = 1.0f;
+    for (uint32_t i = 0; i + 2 < indexCount; i += 3)
+    {
+        const glm::vec3& p0 = vertices[indices[i]].pos;
+        const glm::vec3 normal = glm::cross(vertices[indices[i + 1]].pos - p0, vertices[indices[i + 2]].pos - p0);
+        const float length = glm::length(normal);
+        if (length > 0.0f)
+        {
+            minDot = std::min(minDot, glm::dot(normal / length, axis));
+        }
+    }
+    meshlet.coneAxis = axis;
+    if (minDot > MIN_CONE_DOT)
+    {
+        // the normals are within acos(minDot) of the axis, the view directions which see all of them from behind are
+        // within 90 - acos(minDot) degrees of the axis, whose cosine is sin(acos(minDot))
+        meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+    }
+}
+
+void MeshletBuilder::BuildMeshlets(MeshData& meshData, SubMesh& subMesh)
+{
+    subMesh.m_FirstMeshlet = static_cast<uint32_t>(meshData.meshlets.size());
+    subMesh.m_MeshletCount = 0;
+    const uint32_t triangleCount = subMesh.m_IndexCount / 3;
+    if (triangleCount == 0)
+    {
+        return;
+    }
+    uint32_t* indices = meshData.indices.data() + subMesh.m_FirstIndex;
+    const uint32_t indexCount = triangleCount * 3;
+
+    // the indices of a submesh cover a small range of the shared vertices
+    uint32_t minIndex = std::numeric_limits<uint32_t>::max();
+    uint32_t maxIndex = 0;
+    for (uint32_t i = 0; i < indexCount; ++i)
+    {
+        minIndex = std::min(minIndex, indices[i]);
+        maxIndex = std::max(maxIndex, indices[i]);
+    }
+    const uint32_t vertexCount = maxIndex - minIndex + 1;
+
+    // the triangles of each vertex, the ones of vertex v are at [offsets[v], offsets[v + 1])
+    std::vector<uint32_t> vertexTriangleOffsets(vertexCount + 1, 0);
+    for (uint32_t i = 0; i < indexCount; ++i)
+    {
+        vertexTriangleOffsets[indices[i] - minIndex + 1]++;
+    }
+    for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+    {
+        vertexTriangleOffsets[vertex + 1] += vertexTriangleOffsets[vertex];
+    }
+    std::vector<uint32_t> vertexTriangles(indexCount);
+    std::vector<uint32_t> vertexTriangleFill(vertexTriangleOffsets.begin(), vertexTriangleOffsets.end() - 1);
+    std::vector<glm::vec3> triangleCentroids(triangleCount);
+    for (uint32_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        glm::vec3 centroid(0.0f);
+        for (uint32_t corner = 0; corner < 3; ++corner)
+        {
+            const uint32_t vertex = indices[triangle * 3 + corner];
+            vertexTriangles[vertexTriangleFill[vertex - minIndex]++] = triangle;
+            centroid += meshData.vertices[vertex].pos;
+        }
+        triangleCentroids[triangle] = centroid / 3.0f;
+    }
+
+    std::vector<uint8_t> triangleUsed(triangleCount, 0);
+    // the meshlet a vertex or candidate triangle was last added to, for the duplicate tests without clearing
+    std::vector<uint32_t> vertexMeshlet(vertexCount, NO_MESHLET);
+    std::vector<uint32_t> triangleCandidateMeshlet(triangleCount, NO_MESHLET);
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> meshletIndices;
+    meshletIndices.reserve(indexCount);
+    std::vector<Meshlet> meshlets;
+    uint32_t seedTriangle = 0;
+
+    while (meshletIndices.size() < indexCount)
+    {
+        const uint32_t meshletID = static_cast<uint32_t>(meshlets.size());
+        Meshlet& meshlet = meshlets.emplace_back();
+        meshlet.firstIndex = static_cast<uint32_t>(meshletIndices.size());
+        uint32_t meshletVertexCount = 0;
+        uint32_t meshletTriangleCount = 0;
+        glm::vec3 centroidSum(0.0f);
+        candidates.clear();
+
+        const auto countNewVertices = [&](const uint32_t triangle)
+        {
+            const uint32_t* corners = indices + triangle * 3;
+            uint32_t newVertices = 0;
+            for (uint32_t corner = 0; corner < 3; ++corner)
+            {
+                const bool repeated = (corner > 0 && corners[corner] == corners[0]) || (corner > 1 && corners[corner] == corners[1]);
+                if (!repeated && vertexMeshlet[corners[corner] - minIndex] != meshletID)
+                {
+                    newVertices++;
+                }
+            }
+            return newVertices;
+        };
+
+        uint32_t nextTriangle = NO_TRIANGLE;
+        do
+        {
+            if (nextTriangle != NO_TRIANGLE)
+            {
+                const uint32_t* corners = indices + nextTriangle * 3;
+                triangleUsed[nextTriangle] = 1;
+                for (uint32_t corner = 0; corner < 3; ++corner)
+                {
+                    const uint32_t vertex = corners[corner] - minIndex;
+                    meshletIndices.push_back(corners[corner]);
+                    if (vertexMeshlet[vertex] == meshletID)
+                    {
+                        continue;
+                    }
+                    vertexMeshlet[vertex] = meshletID;
+                    meshletVertexCount++;
+                    for (uint32_t i = vertexTriangleOffsets[vertex]; i < vertexTriangleOffsets[vertex + 1]; ++i)
+                    {
+                        const uint32_t neighbour = vertexTriangles[i];
+                        if (!triangleUsed[neighbour] && triangleCandidateMeshlet[neighbour] != meshletID)
+                        {
+                            triangleCandidateMeshlet[neighbour] = meshletID;
+                            candidates.push_back(neighbour);
+                        }
+                    }
+                }
+                centroidSum += triangleCentroids[nextTriangle];
+                meshletTriangleCount++;
+                if (meshletTriangleCount == MAX_TRIANGLES)
+                {
+                    break;
+                }
+            }
+
+            nextTriangle = NO_TRIANGLE;
+            if (meshletTriangleCount == 0)
+            {
+                // the next triangle in the order of the vertex cache optimization seeds the meshlet
+                while (triangleUsed[seedTriangle])
+                {
+                    seedTriangle++;
+                }
+                nextTriangle = seedTriangle;
+                continue;
+            }
+
+            // the neighbour which adds the fewest vertices, the one nearest to the meshlet among those
+            const glm::vec3 meshletCentroid = centroidSum / static_cast<float>(meshletTriangleCount);
+            uint32_t bestNewVertices = std::numeric_limits<uint32_t>::max();
+            float bestDistance = std::numeric_limits<float>::max();
+            for (size_t candidate = 0; candidate < candidates.size();)
+            {
+                const uint32_t triangle = candidates[candidate];
+                if (triangleUsed[triangle])
+                {
+                    candidates[candidate] = candidates.back();
+                    candidates.pop_back();
+                    continue;
+                }
+                candidate++;
+                const uint32_t newVertices = countNewVertices(triangle);
+                if (meshletVertexCount + newVertices > MAX_VERTICES || newVertices > bestNewVertices)
+                {
+                    continue;
+                }
+                const glm::vec3 offset = triangleCentroids[triangle] - meshletCentroid;
+                const float distance = glm::dot(offset, offset);
+                if (newVertices < bestNewVertices || distance < bestDistance)
+                {
+                    bestNewVertices = newVertices;
+                    bestDistance = distance;
+                    nextTriangle = triangle;
+                }
+            }
+            // without a neighbour which fits the meshlet ends, a distant seed would only inflate its bounds
+        } while (nextTriangle != NO_TRIANGLE);
+
+        meshlet.indexCount = static_cast<uint32_t>(meshletIndices.size()) - meshlet.firstIndex;
+    }
+
+    std::copy(meshletIndices.begin(), meshletIndices.end(), indices);
+    for (auto& meshlet : meshlets)
+    {
+        ComputeBounds(meshData.vertices, indices + meshlet.firstIndex, meshlet.indexCount, meshlet);
+        meshlet.firstIndex += subMesh.m_FirstIndex;
+    }
+    meshData.meshlets.insert(meshData.meshlets.end(), meshlets.begin(), meshlets.end());
+    subMesh.m_MeshletCount = static_cast<uint32_t>(meshlets.size());
+}
+
+void MeshletBuilder::BuildMeshlets(Mesh& mesh)
+{
+    if (!mesh.m_meshData || mesh.m_meshData->hasSkinning)
+    {
+        return;
+    }
+    mesh.m_meshData->meshlets.clear();
+    for (auto& subMesh : mesh.subMeshes)
+    {
+        BuildMeshlets(*mesh.m_meshData, subMesh);
+    }
+}
+
+} // namespace RenderSys
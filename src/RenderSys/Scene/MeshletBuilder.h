@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <RenderSys/Scene/Mesh.h>
+
+namespace RenderSys
+{
+
+// Splits the triangles of a submesh into meshlets of at most MAX_VERTICES vertices and MAX_TRIANGLES triangles,
+// the limits of the common mesh shader implementations. A meshlet grows from a seed triangle over its neighbours,
+// preferring the triangles which add the fewest new vertices, so it stays compact and its bounding sphere and
+// normal cone are tight enough to cull it on its own (meshlet-cull-compute.glsl).
+class MeshletBuilder
+{
+public:
+    static constexpr uint32_t MAX_VERTICES = 64;
+    static constexpr uint32_t MAX_TRIANGLES = 124;
+
+    // reorders the triangles of the submesh so that each meshlet is a contiguous index range, appends the meshlets
+    // to meshData.meshlets and sets the meshlet range of the submesh. Runs after the vertex cache optimization,
+    // whose order is mostly kept, and before the level of detail chain is appended and the index buffer is uploaded
+    static void BuildMeshlets(MeshData& meshData, SubMesh& subMesh);
+    // every submesh of the mesh, skinned meshes are left alone as their triangles leave the bind pose bounds and cones
+    static void BuildMeshlets(Mesh& mesh);
+
+    // bounding sphere and normal cone of the triangles, in the space of the mesh
+    static void ComputeBounds(const std::vector<ModelVertex>& vertices, const uint32_t* indices, const uint32_t indexCount, Meshlet& meshlet);
+};
+
+} // namespace RenderSys
@@ -24,6 +24,27 @@ bool Model::load(const std::filesystem::path &filePath)
     return true;
 }
 
+bool Model::load(const std::filesystem::path &filePath, const MeshSimplifierSettings& lodSettings)
+{
+    m_model->setGenerateLods(true, lodSettings);
+    return load(filePath);
+}
+
+void Model::setGenerateMeshlets(const bool generateMeshlets)
+{
+    m_model->setGenerateMeshlets(generateMeshlets);
+}
+
+void Model::setPrintOptimizationStats(const bool printOptimizationStats)
+{
+    m_model->setPrintOptimizationStats(printOptimizationStats);
+}
+
+void Model::setDirectVertices(const bool directVertices)
+{
+    m_model->setDirectVertices(directVertices);
+}
+
 void Model::populate()
 {
     m_model->computeProps(); // just to print the number of vertices and indices
@@ -37,6 +58,8 @@ void Model::populate()
     m_model->loadSkeletons();
     m_model->loadAnimations();
     m_model->loadjointMatrices();
+    m_model->loadAnimationComponents();
+    m_model->releaseSourceData();
 }
 
 void Model::applyVertexSkinningOnCPU(RenderSys::VertexBuffer& vertexBuffer)
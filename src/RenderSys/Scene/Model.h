@@ -1,6 +1,7 @@
 #pragma once
 #include <filesystem>
 #include <RenderSys/Buffer.h>
+#include <RenderSys/Scene/MeshSimplifier.h>
 
 namespace RenderSys
 {
@@ -21,6 +22,15 @@ public:
     Model& operator=(Model&&) = default;
     
     bool load(const std::filesystem::path &filePath);
+    // also simplifies every submesh into a level of detail chain, see MeshSimplifier
+    bool load(const std::filesystem::path &filePath, const MeshSimplifierSettings& lodSettings);
+    // call it before load(), splits every submesh into meshlets for the culling of SubmitRenderQueueMeshletCulled()
+    void setGenerateMeshlets(const bool generateMeshlets);
+    // call it before load(), prints the vertex cache statistics of the mesh optimization
+    void setPrintOptimizationStats(const bool printOptimizationStats);
+    // call it before load(), the meshes that need no CPU copy of their vertices convert them from the file at upload,
+    // release the file with MeshData::releaseVertexAccessors() once the vertex buffer is written
+    void setDirectVertices(const bool directVertices);
     void populate();
     void applyVertexSkinningOnCPU(RenderSys::VertexBuffer& vertexBuffer);
     const std::vector<std::shared_ptr<Texture>>& getTextures() const;
@@ -5,6 +5,7 @@
 #include <RenderSys/Components/TransformComponent.h>
 #include <RenderSys/Components/LightComponents.h>
 #include <RenderSys/Components/CameraComponents.h>
+#include <RenderSys/Components/AnimationComponents.h>
 #include <iostream>
 
 namespace RenderSys
@@ -134,6 +135,29 @@ void Scene::AddMeshInstanceOfEntity(const uint32_t instanceIndex, entt::entity&
 
 		auto resource = std::make_shared<RenderSys::Resource>();
 		resource->SetBuffer(RenderSys::Resource::BufferIndices::INSTANCE_BUFFER_INDEX, instanceTag.GetInstanceBuffer()->GetBuffer());
+		if (m_Registry.all_of<SkeletonComponent>(entity))
+		{
+			auto& skeletonComponent = m_Registry.get<SkeletonComponent>(entity);
+			auto& skeleton = *skeletonComponent.m_Skeleton;
+			assert(skeleton.m_Joints.size() > 0);
+			// the meshes of one character share its joint buffer, the pose is written once for all of them
+			for (auto other : m_Registry.view<SkeletonComponent>())
+			{
+				const auto& otherSkeletonComponent = m_Registry.get<SkeletonComponent>(other);
+				if (otherSkeletonComponent.m_Skeleton == skeletonComponent.m_Skeleton && otherSkeletonComponent.m_JointMatricesBuffer)
+				{
+					skeletonComponent.m_JointMatricesBuffer = otherSkeletonComponent.m_JointMatricesBuffer;
+					break;
+				}
+			}
+			if (!skeletonComponent.m_JointMatricesBuffer)
+			{
+				skeleton.Update(); // fills the palette of the selected skinning method
+				skeletonComponent.m_JointMatricesBuffer = std::make_shared<RenderSys::JointMatricesBuffer>(skeleton.GetJointPaletteSize());
+				skeletonComponent.m_JointMatricesBuffer->WriteInitial(skeleton.GetJointPaletteData());
+			}
+			resource->SetBuffer(RenderSys::Resource::BufferIndices::SKELETAL_ANIMATION_BUFFER_INDEX, skeletonComponent.m_JointMatricesBuffer->m_Buffer);
+		}
 		resource->Init();
 		for (auto &subMesh : meshComponent.m_Mesh->subMeshes)
 		{
@@ -155,6 +179,8 @@ void Scene::AddMeshInstanceOfEntity(const uint32_t instanceIndex, entt::entity&
 	instanceTagComp.AddInstance(instanceEntity);
 	m_Registry.emplace<RenderSys::MeshComponent>(instanceEntity, "", meshComponent.m_Mesh);
 	instanceTagComp.GetInstanceBuffer()->Update();
+	// no skeleton of its own: the instances draw the vertices skinned for the entity with the InstanceTagComponent,
+	// so they share its pose and only that one is animated
 }
 
 void Scene::AddDirectionalLight(const glm::vec3 &direction, const glm::vec3 &color)
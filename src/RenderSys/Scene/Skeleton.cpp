@@ -3,6 +3,21 @@
 namespace RenderSys
 {
 
+DualQuaternion DualQuaternion::FromMatrix(const glm::mat4& matrix)
+{
+    // remove scale from the rotation part before extracting the quaternion
+    const glm::mat3 rotationMatrix(glm::normalize(glm::vec3(matrix[0])), 
+                                    glm::normalize(glm::vec3(matrix[1])), 
+                                    glm::normalize(glm::vec3(matrix[2])));
+    const glm::quat real = glm::normalize(glm::quat_cast(rotationMatrix));
+    const glm::vec3 translation(matrix[3]);
+    const glm::quat dual = glm::quat(0.0f, translation.x, translation.y, translation.z) * real * 0.5f;
+
+    DualQuaternion dualQuaternion;
+    dualQuaternion.m_Real = glm::vec4(real.x, real.y, real.z, real.w);
+    dualQuaternion.m_Dual = glm::vec4(dual.x, dual.y, dual.z, dual.w);
+    return dualQuaternion;
+}
 
 void Skeleton::Traverse()
 {
@@ -66,6 +81,33 @@ void Skeleton::Update()
                 m_ShaderData.m_FinalJointsMatrices[jointIndex] * m_Joints[jointIndex].m_InverseBindMatrix;
         }
     }
+
+    if (m_SkinningMethod == SkinningMethod::DUAL_QUATERNION)
+    {
+        m_ShaderData.m_FinalJointsDualQuaternions.resize(numberOfJoints);
+        for (int16_t jointIndex = 0; jointIndex < numberOfJoints; ++jointIndex)
+        {
+            m_ShaderData.m_FinalJointsDualQuaternions[jointIndex] = DualQuaternion::FromMatrix(m_ShaderData.m_FinalJointsMatrices[jointIndex]);
+        }
+    }
+}
+
+const void* Skeleton::GetJointPaletteData() const
+{
+    if (m_SkinningMethod == SkinningMethod::DUAL_QUATERNION)
+    {
+        return m_ShaderData.m_FinalJointsDualQuaternions.data();
+    }
+    return m_ShaderData.m_FinalJointsMatrices.data();
+}
+
+size_t Skeleton::GetJointPaletteSize() const
+{
+    if (m_SkinningMethod == SkinningMethod::DUAL_QUATERNION)
+    {
+        return m_Joints.size() * sizeof(DualQuaternion);
+    }
+    return m_Joints.size() * sizeof(glm::mat4);
 }
 
 void Skeleton::UpdateJoint(int16_t jointIndex)
@@ -9,9 +9,28 @@ namespace RenderSys
 static constexpr int NO_PARENT = -1;
 static constexpr int ROOT_JOINT = 0;
 
+enum class SkinningMethod
+{
+    LINEAR_BLEND = 0,
+    DUAL_QUATERNION
+};
+
+// unit dual quaternion, both parts stored as (x, y, z, w) to match the std430 layout of the skinning shader.
+// Only rotation and translation survive the conversion, scale of the joint matrix is dropped.
+struct DualQuaternion
+{
+    static DualQuaternion FromMatrix(const glm::mat4& matrix);
+
+    glm::vec4 m_Real{0.0f, 0.0f, 0.0f, 1.0f};
+    glm::vec4 m_Dual{0.0f};
+};
+
+static_assert(sizeof(DualQuaternion) * 2 == sizeof(glm::mat4));
+
 struct ShaderData
 {
     std::vector<glm::mat4> m_FinalJointsMatrices;
+    std::vector<DualQuaternion> m_FinalJointsDualQuaternions; // only updated for SkinningMethod::DUAL_QUATERNION
 };
 
 struct Joint
@@ -48,7 +67,13 @@ struct Skeleton
     void Update();
     void UpdateJoint(int16_t jointIndex); // signed because -1 maybe used for invalid joint
 
+    // joint palette of m_SkinningMethod as uploaded to the GPU
+    const void* GetJointPaletteData() const;
+    size_t GetJointPaletteSize() const; // in bytes
+
     bool m_IsAnimated = true;
+    // has to be chosen before the GPU joint buffer of the skeleton gets created, its size depends on the method
+    SkinningMethod m_SkinningMethod = SkinningMethod::LINEAR_BLEND;
     std::string m_Name;
     std::vector<Joint> m_Joints;
     std::map<int, int> m_GlobalNodeToJointIndex;
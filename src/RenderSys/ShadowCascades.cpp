@@ -0,0 +1,120 @@
+#include "ShadowCascades.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace RenderSys
+{
+
+ShadowCascades::ShadowCascades(const Settings& settings)
+{
+    SetSettings(settings);
+}
+
+void ShadowCascades::SetSettings(const Settings& settings)
+{
+    m_settings = settings;
+    m_settings.m_CascadeCount = std::clamp(m_settings.m_CascadeCount, 1u, MAX_CASCADES);
+    m_settings.m_Resolution = std::max(m_settings.m_Resolution, 1u);
+}
+
+void ShadowCascades::Update(const PerspectiveCamera& camera, const glm::vec3& lightDirection)
+{
+    const float nearClip = camera.GetNearClip();
+    const float farClip = std::max(std::min(camera.GetFarClip(), m_settings.m_MaxDistance), nearClip);
+    const float tanHalfFovY = std::tan(glm::radians(camera.GetFOV()) * 0.5f);
+    const float tanHalfFovX = tanHalfFovY * camera.GetAspectRatio();
+    const glm::vec3 position = camera.GetPosition();
+    const glm::vec3 forward = camera.GetForwardDirection();
+    const glm::vec3 right = camera.GetRightDirection();
+    const glm::vec3 up = camera.GetUpDirection();
+
+    const glm::vec3 toLight = glm::normalize(lightDirection);
+    const glm::vec3 lightUp = std::abs(toLight.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    const float resolution = static_cast<float>(m_settings.m_Resolution);
+
+    float splitNear = nearClip;
+    for (uint32_t cascadeIndex = 0; cascadeIndex < m_settings.m_CascadeCount; ++cascadeIndex)
+    {
+        // practical split scheme, the logarithmic split keeps the texel density constant over depth
+        // but gives the near cascades too little of the frustum, the uniform split does the opposite
+        const float ratio = static_cast<float>(cascadeIndex + 1) / static_cast<float>(m_settings.m_CascadeCount);
+        const float logSplit = nearClip * std::pow(farClip / nearClip, ratio);
+        const float uniformSplit = nearClip + (farClip - nearClip) * ratio;
+        const float splitFar = m_settings.m_SplitLambda * logSplit + (1.0f - m_settings.m_SplitLambda) * uniformSplit;
+
+        std::array<glm::vec3, 8> corners;
+        uint32_t cornerIndex = 0;
+        for (const float depth : {splitNear, splitFar})
+        {
+            const glm::vec3 center = position + forward * depth;
+            const glm::vec3 halfWidth = right * (depth * tanHalfFovX);
+            const glm::vec3 halfHeight = up * (depth * tanHalfFovY);
+            corners[cornerIndex++] = center - halfWidth - halfHeight;
+            corners[cornerIndex++] = center + halfWidth - halfHeight;
+            corners[cornerIndex++] = center - halfWidth + halfHeight;
+            corners[cornerIndex++] = center + halfWidth + halfHeight;
+        }
+
+        // a bounding sphere does not change its size when the camera rotates, so the shadow edges do not swim
+        glm::vec3 sphereCenter(0.0f);
+        for (const auto& corner : corners)
+        {
+            sphereCenter += corner;
+        }
+        sphereCenter /= static_cast<float>(corners.size());
+        float radius = 0.0f;
+        for (const auto& corner : corners)
+        {
+            radius = std::max(radius, glm::distance(corner, sphereCenter));
+        }
+        radius = std::ceil(radius * 16.0f) / 16.0f;
+
+        const float lightDistance = radius + m_settings.m_CasterDistance;
+        const glm::mat4 lightView = glm::lookAtLH(sphereCenter + toLight * lightDistance, sphereCenter, lightUp);
+        glm::mat4 lightProjection = glm::orthoLH_ZO(-radius, radius, -radius, radius, 0.0f, lightDistance + radius);
+
+        // snap the projection to whole texels, otherwise moving the camera moves the shadow edges over the texels
+        const glm::vec4 origin = lightProjection * lightView * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        const glm::vec2 originTexels = glm::vec2(origin) * (resolution * 0.5f);
+        const glm::vec2 snapOffset = (glm::round(originTexels) - originTexels) * (2.0f / resolution);
+        lightProjection[3][0] += snapOffset.x;
+        lightProjection[3][1] += snapOffset.y;
+
+        auto& cascade = m_cascades[cascadeIndex];
+        cascade.m_ViewProjection = lightProjection * lightView;
+        cascade.m_SplitDepth = splitFar;
+        cascade.m_TexelWorldSize = 2.0f * radius / resolution;
+        splitNear = splitFar;
+    }
+}
+
+bool ShadowCascades::IsCasterVisible(const uint32_t cascade, const glm::vec3& boundsMin, const glm::vec3& boundsMax) const
+{
+    const auto& shadowCascade = m_cascades[cascade];
+    // its shadow would cover only a few texels
+    if (glm::distance(boundsMin, boundsMax) < shadowCascade.m_TexelWorldSize * m_settings.m_MinCasterTexels)
+    {
+        return false;
+    }
+
+    // orthographic, no division by w
+    glm::vec3 clipMin(std::numeric_limits<float>::max());
+    glm::vec3 clipMax(std::numeric_limits<float>::lowest());
+    for (uint32_t corner = 0; corner < 8; ++corner)
+    {
+        const glm::vec3 worldCorner((corner & 1) ? boundsMax.x : boundsMin.x,
+                                    (corner & 2) ? boundsMax.y : boundsMin.y,
+                                    (corner & 4) ? boundsMax.z : boundsMin.z);
+        const glm::vec3 clipCorner = glm::vec3(shadowCascade.m_ViewProjection * glm::vec4(worldCorner, 1.0f));
+        clipMin = glm::min(clipMin, clipCorner);
+        clipMax = glm::max(clipMax, clipCorner);
+    }
+
+    return clipMax.x >= -1.0f && clipMin.x <= 1.0f &&
+            clipMax.y >= -1.0f && clipMin.y <= 1.0f &&
+            clipMax.z >= 0.0f && clipMin.z <= 1.0f;
+}
+
+} // namespace RenderSys
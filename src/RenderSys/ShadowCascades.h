@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stdint.h>
+#include <array>
+#include <glm/ext.hpp>
+#include <RenderSys/Camera/PerspectiveCamera.h>
+#include <resources/Shaders/ShaderResource.h>
+
+namespace RenderSys
+{
+
+// Splits the view frustum of a camera into cascades along its depth and fits an orthographic light frustum
+// around each of them, every cascade is rendered into its own layer of the shadow map.
+// Near cascades cover a small part of the frustum and get a fine shadow resolution, far cascades a coarse one.
+class ShadowCascades
+{
+public:
+    static constexpr uint32_t MAX_CASCADES = MAX_SHADOW_CASCADES;
+
+    struct Settings
+    {
+        uint32_t m_CascadeCount = MAX_CASCADES;
+        // width and height of each layer of the shadow map
+        uint32_t m_Resolution = 2048;
+        // blend between uniform (0) and logarithmic (1) split distances
+        float m_SplitLambda = 0.75f;
+        // shadows end here, or at the far clip of the camera when it is nearer
+        float m_MaxDistance = 100.0f;
+        // casters between the light and a cascade are kept up to this distance in front of it
+        float m_CasterDistance = 50.0f;
+        // casters smaller than this many texels of a cascade are skipped by it
+        float m_MinCasterTexels = 2.0f;
+    };
+
+    struct Cascade
+    {
+        glm::mat4 m_ViewProjection{1.0f};
+        // view space depth at which the cascade ends
+        float m_SplitDepth = 0.0f;
+        // world space size of one shadow map texel
+        float m_TexelWorldSize = 0.0f;
+    };
+
+    ShadowCascades() = default;
+    explicit ShadowCascades(const Settings& settings);
+
+    const Settings& GetSettings() const { return m_settings; }
+    void SetSettings(const Settings& settings);
+
+    // lightDirection points from the scene towards the light, as the direction of DirectionalLightComponent
+    void Update(const PerspectiveCamera& camera, const glm::vec3& lightDirection);
+
+    uint32_t GetCascadeCount() const { return m_settings.m_CascadeCount; }
+    const Cascade& GetCascade(const uint32_t cascade) const { return m_cascades[cascade]; }
+
+    // whether a caster with these world space bounds can throw a shadow into the cascade
+    bool IsCasterVisible(const uint32_t cascade, const glm::vec3& boundsMin, const glm::vec3& boundsMax) const;
+
+private:
+    Settings m_settings;
+    std::array<Cascade, MAX_CASCADES> m_cascades;
+};
+
+} // namespace RenderSys
@@ -0,0 +1,91 @@
+#include "ShadowCasterCache.h"
+
+namespace RenderSys
+{
+
+void ShadowCasterCache::Update(const RenderQueue& shadowRenderQueue)
+{
+    m_frame++;
+    m_staticCasters.Clear();
+    m_dynamicCasters.Clear();
+
+    bool staticCastersChanged = false;
+    for (const auto& packet : shadowRenderQueue.GetPackets())
+    {
+        if (!packet.m_HasBounds)
+        {
+            m_dynamicCasters.Submit(packet);
+            continue;
+        }
+
+        auto [casterIter, inserted] = m_casters.try_emplace(packet.m_SubMesh);
+        auto& caster = casterIter->second;
+        if (inserted)
+        {
+            // new casters are assumed to stay where they are
+            caster.m_Static = true;
+            caster.m_UnchangedFrames = STATIC_FRAMES;
+            staticCastersChanged = true;
+        }
+        else if (caster.m_BoundsMin != packet.m_BoundsMin || caster.m_BoundsMax != packet.m_BoundsMax)
+        {
+            staticCastersChanged |= caster.m_Static;
+            caster.m_Static = false;
+            caster.m_UnchangedFrames = 0;
+        }
+        else if (!caster.m_Static && ++caster.m_UnchangedFrames >= STATIC_FRAMES)
+        {
+            caster.m_Static = true;
+            staticCastersChanged = true;
+        }
+        caster.m_BoundsMin = packet.m_BoundsMin;
+        caster.m_BoundsMax = packet.m_BoundsMax;
+        caster.m_LastFrame = m_frame;
+
+        if (caster.m_Static)
+        {
+            m_staticCasters.Submit(packet);
+        }
+        else
+        {
+            m_dynamicCasters.Submit(packet);
+        }
+    }
+
+    // removed casters
+    for (auto casterIter = m_casters.begin(); casterIter != m_casters.end();)
+    {
+        if (casterIter->second.m_LastFrame != m_frame)
+        {
+            staticCastersChanged |= casterIter->second.m_Static;
+            casterIter = m_casters.erase(casterIter);
+        }
+        else
+        {
+            ++casterIter;
+        }
+    }
+
+    if (staticCastersChanged)
+    {
+        Invalidate();
+    }
+}
+
+bool ShadowCasterCache::IsCascadeCached(const uint32_t cascade, const glm::mat4& viewProjection) const
+{
+    return m_cascadeCached[cascade] && m_cascadeViewProjections[cascade] == viewProjection;
+}
+
+void ShadowCasterCache::SetCascadeCached(const uint32_t cascade, const glm::mat4& viewProjection)
+{
+    m_cascadeCached[cascade] = true;
+    m_cascadeViewProjections[cascade] = viewProjection;
+}
+
+void ShadowCasterCache::Invalidate()
+{
+    m_cascadeCached.fill(false);
+}
+
+} // namespace RenderSys
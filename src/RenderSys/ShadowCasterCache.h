@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdint.h>
+#include <array>
+#include <unordered_map>
+#include <glm/ext.hpp>
+#include <RenderSys/RenderQueue.h>
+#include <RenderSys/ShadowCascades.h>
+
+namespace RenderSys
+{
+
+// Splits the shadow casters into static ones, whose shadow is drawn once into a cached layer per cascade,
+// and dynamic ones, which are drawn on top of a copy of that layer every frame.
+// A caster is dynamic while its world bounds change and for a while after, casters without bounds
+// (skinned meshes) are always dynamic. The cached layer of a cascade is drawn again when the static
+// casters change or the light frustum of the cascade moves.
+class ShadowCasterCache
+{
+public:
+    // frames a moved caster has to stay in place before it is cached again
+    static constexpr uint32_t STATIC_FRAMES = 60;
+
+    ShadowCasterCache() = default;
+    ~ShadowCasterCache() = default;
+    ShadowCasterCache(const ShadowCasterCache&) = delete;
+    ShadowCasterCache& operator=(const ShadowCasterCache&) = delete;
+    ShadowCasterCache(ShadowCasterCache&&) = delete;
+    ShadowCasterCache& operator=(ShadowCasterCache&&) = delete;
+
+    // sorts the packets of a sorted shadow queue into the static and dynamic casters, both stay sorted
+    void Update(const RenderQueue& shadowRenderQueue);
+    const RenderQueue& GetStaticCasters() const { return m_staticCasters; }
+    const RenderQueue& GetDynamicCasters() const { return m_dynamicCasters; }
+
+    // whether the cached layer of the cascade still holds the static casters seen from this light frustum
+    bool IsCascadeCached(const uint32_t cascade, const glm::mat4& viewProjection) const;
+    void SetCascadeCached(const uint32_t cascade, const glm::mat4& viewProjection);
+    // the cached layers are lost, e.g. when the shadow maps are created again
+    void Invalidate();
+
+private:
+    struct Caster
+    {
+        glm::vec3 m_BoundsMin{0.0f};
+        glm::vec3 m_BoundsMax{0.0f};
+        uint32_t m_UnchangedFrames = 0;
+        uint64_t m_LastFrame = 0;
+        bool m_Static = false;
+    };
+
+    std::unordered_map<const SubMesh*, Caster> m_casters;
+    RenderQueue m_staticCasters;
+    RenderQueue m_dynamicCasters;
+    uint64_t m_frame = 0;
+
+    std::array<bool, ShadowCascades::MAX_CASCADES> m_cascadeCached{};
+    std::array<glm::mat4, ShadowCascades::MAX_CASCADES> m_cascadeViewProjections{};
+};
+
+} // namespace RenderSys
@@ -0,0 +1,83 @@
+#include "SpriteAtlas.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace RenderSys
+{
+
+namespace
+{
+
+constexpr uint32_t WHITE_BLOCK_SIZE = 4;
+
+} // namespace
+
+SpriteAtlas::SpriteAtlas(const uint32_t width, const uint32_t height)
+    : m_width(width)
+    , m_height(height)
+    , m_pixels(static_cast<size_t>(width) * height * 4, 0)
+{
+    const std::vector<uint8_t> white(WHITE_BLOCK_SIZE * WHITE_BLOCK_SIZE * 4, 0xFF);
+    SpriteRegion whiteBlock;
+    const bool added = Add(white.data(), WHITE_BLOCK_SIZE, WHITE_BLOCK_SIZE, whiteBlock);
+    assert(added);
+    // the center of the block, every filtered sample is white
+    const uint16_t u = static_cast<uint16_t>((whiteBlock.m_UvRect[0] + whiteBlock.m_UvRect[2]) / 2);
+    const uint16_t v = static_cast<uint16_t>((whiteBlock.m_UvRect[1] + whiteBlock.m_UvRect[3]) / 2);
+    m_whiteRegion.m_UvRect[0] = m_whiteRegion.m_UvRect[2] = u;
+    m_whiteRegion.m_UvRect[1] = m_whiteRegion.m_UvRect[3] = v;
+}
+
+bool SpriteAtlas::Add(const uint8_t* pixels, const uint32_t width, const uint32_t height, SpriteRegion& region)
+{
+    const uint32_t paddedWidth = width + 2 * BORDER;
+    const uint32_t paddedHeight = height + 2 * BORDER;
+    if (width == 0 || height == 0 || paddedWidth > m_width)
+    {
+        return false;
+    }
+    if (m_shelfX + paddedWidth > m_width)
+    {
+        // the next shelf starts below the tallest image of this one
+        m_shelfX = 0;
+        m_shelfY += m_shelfHeight;
+        m_shelfHeight = 0;
+    }
+    if (m_shelfY + paddedHeight > m_height)
+    {
+        return false;
+    }
+
+    const uint32_t left = m_shelfX + BORDER;
+    const uint32_t top = m_shelfY + BORDER;
+    for (uint32_t y = 0; y < paddedHeight; ++y)
+    {
+        // the border repeats the nearest row and column of the image
+        const uint32_t sourceY = std::min(std::max(y, BORDER) - BORDER, height - 1);
+        uint8_t* row = m_pixels.data() + (static_cast<size_t>(m_shelfY + y) * m_width + m_shelfX) * 4;
+        const uint8_t* sourceRow = pixels + static_cast<size_t>(sourceY) * width * 4;
+        std::memcpy(row + BORDER * 4, sourceRow, static_cast<size_t>(width) * 4);
+        for (uint32_t x = 0; x < BORDER; ++x)
+        {
+            std::memcpy(row + x * 4, sourceRow, 4);
+            std::memcpy(row + (BORDER + width + x) * 4, sourceRow + (width - 1) * 4, 4);
+        }
+    }
+
+    region.m_UvRect[0] = ToUnorm(left, m_width);
+    region.m_UvRect[1] = ToUnorm(top, m_height);
+    region.m_UvRect[2] = ToUnorm(left + width, m_width);
+    region.m_UvRect[3] = ToUnorm(top + height, m_height);
+    m_shelfX += paddedWidth;
+    m_shelfHeight = std::max(m_shelfHeight, paddedHeight);
+    return true;
+}
+
+uint16_t SpriteAtlas::ToUnorm(const uint32_t texel, const uint32_t size) const
+{
+    return static_cast<uint16_t>((static_cast<uint64_t>(texel) * 0xFFFF + size / 2) / size);
+}
+
+} // namespace RenderSys
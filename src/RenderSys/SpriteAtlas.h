@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "SpriteBatch.h"
+
+namespace RenderSys
+{
+
+// Packs the RGBA8 images of the sprites into one texture, shelf by shelf, so that a batch samples a single
+// texture and never splits into several draws. Every image gets a border of its repeated edge texels against
+// bleeding of the linear filter. A white block is packed first for the untextured quads and lines.
+class SpriteAtlas
+{
+public:
+    // one texel of border around every image
+    static constexpr uint32_t BORDER = 1;
+
+    SpriteAtlas(const uint32_t width, const uint32_t height);
+
+    // returns false when the image does not fit into the rest of the atlas
+    bool Add(const uint8_t* pixels, const uint32_t width, const uint32_t height, SpriteRegion& region);
+
+    const SpriteRegion& GetWhiteRegion() const { return m_whiteRegion; }
+    uint32_t GetWidth() const { return m_width; }
+    uint32_t GetHeight() const { return m_height; }
+    // RGBA8, row by row
+    const std::vector<uint8_t>& GetPixels() const { return m_pixels; }
+
+private:
+    uint16_t ToUnorm(const uint32_t texel, const uint32_t size) const;
+
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    std::vector<uint8_t> m_pixels;
+    uint32_t m_shelfX = 0;
+    uint32_t m_shelfY = 0;
+    uint32_t m_shelfHeight = 0;
+    SpriteRegion m_whiteRegion;
+};
+
+} // namespace RenderSys
@@ -0,0 +1,71 @@
+#include "SpriteBatch.h"
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <glm/gtc/packing.hpp>
+
+namespace RenderSys
+{
+
+void SpriteBatch::Begin(SpriteInstance* instances, const uint32_t capacity, const SpriteRegion& whiteRegion)
+{
+    assert(instances || capacity == 0);
+    m_instances = instances;
+    m_capacity = capacity;
+    m_count = 0;
+    m_droppedCount = 0;
+    m_whiteRegion = whiteRegion;
+}
+
+uint32_t SpriteBatch::End()
+{
+    if (m_droppedCount > 0)
+    {
+        std::cout << "Error: sprite buffer is full, " << m_droppedCount << " sprites were dropped!" << std::endl;
+        assert(false);
+    }
+    m_instances = nullptr;
+    m_capacity = 0;
+    return m_count;
+}
+
+void SpriteBatch::DrawQuad(const glm::vec2& center, const glm::vec2& size, const float rotation, const uint32_t color)
+{
+    DrawSprite(center, size, rotation, m_whiteRegion, color);
+}
+
+void SpriteBatch::DrawSprite(const glm::vec2& center, const glm::vec2& size, const float rotation, const SpriteRegion& region, const uint32_t color)
+{
+    SpriteInstance* instance = Allocate();
+    if (!instance)
+    {
+        return;
+    }
+    const float cosine = std::cos(rotation);
+    const float sine = std::sin(rotation);
+    const glm::vec2 axisX = glm::vec2(cosine, sine) * (size.x * 0.5f);
+    const glm::vec2 axisY = glm::vec2(-sine, cosine) * (size.y * 0.5f);
+    *instance = SpriteInstance{center, axisX, axisY, region, color};
+}
+
+void SpriteBatch::DrawLine(const glm::vec2& from, const glm::vec2& to, const float thickness, const uint32_t color)
+{
+    SpriteInstance* instance = Allocate();
+    if (!instance)
+    {
+        return;
+    }
+    // a quad along the line, as wide as the line is thick
+    const glm::vec2 axisX = (to - from) * 0.5f;
+    const float length = glm::length(axisX);
+    const glm::vec2 normal = length > 0.0f ? glm::vec2(-axisX.y, axisX.x) / length : glm::vec2(0.0f, 1.0f);
+    *instance = SpriteInstance{(from + to) * 0.5f, axisX, normal * (thickness * 0.5f), m_whiteRegion, color};
+}
+
+uint32_t SpriteBatch::PackColor(const glm::vec4& color)
+{
+    return glm::packUnorm4x8(color);
+}
+
+} // namespace RenderSys
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <stdint.h>
+#include <glm/ext.hpp>
+
+namespace RenderSys
+{
+
+// uv rectangle of an image in the sprite atlas, 16 bit unorm: u min, v min, u max, v max
+struct SpriteRegion
+{
+    uint16_t m_UvRect[4] = {0, 0, 0xFFFF, 0xFFFF};
+};
+
+// one quad of a batch, expanded into two triangles by sprite-batch-vertex.glsl
+struct SpriteInstance
+{
+    glm::vec2 m_Center;
+    // from the center to the right and to the bottom edge, rotation and size in one
+    glm::vec2 m_AxisX;
+    glm::vec2 m_AxisY;
+    SpriteRegion m_Region;
+    // RGBA8, multiplies the texel
+    uint32_t m_Color;
+};
+static_assert(sizeof(SpriteInstance) == 36);
+
+// Collects quads, sprites and lines straight into the mapped instance buffer of the renderer, 36 bytes per quad and
+// no index buffer, so a batch of any size is one draw call. Untextured quads and lines sample the white region of
+// the atlas, so all of them share the pipeline and the atlas bind group of the sprites.
+// Renderer2D::BeginSprites() begins a batch, Renderer2D::EndSprites() draws it.
+class SpriteBatch
+{
+public:
+    static constexpr uint32_t WHITE = 0xFFFFFFFF;
+    // instances of all batches of a frame, the size of the instance buffer of the renderer
+    static constexpr uint32_t MAX_SPRITES = 1 << 20;
+
+    SpriteBatch() = default;
+    SpriteBatch(const SpriteBatch&) = delete;
+    SpriteBatch& operator=(const SpriteBatch&) = delete;
+    SpriteBatch(SpriteBatch&&) = delete;
+    SpriteBatch& operator=(SpriteBatch&&) = delete;
+
+    // writes at most capacity instances, the ones beyond are dropped and counted
+    void Begin(SpriteInstance* instances, const uint32_t capacity, const SpriteRegion& whiteRegion);
+    // returns the number of written instances
+    uint32_t End();
+
+    void DrawQuad(const glm::vec2& center, const glm::vec2& size, const uint32_t color);
+    void DrawQuad(const glm::vec2& center, const glm::vec2& size, const float rotation, const uint32_t color);
+    void DrawSprite(const glm::vec2& center, const glm::vec2& size, const SpriteRegion& region, const uint32_t color = WHITE);
+    void DrawSprite(const glm::vec2& center, const glm::vec2& size, const float rotation, const SpriteRegion& region, const uint32_t color = WHITE);
+    void DrawLine(const glm::vec2& from, const glm::vec2& to, const float thickness, const uint32_t color);
+
+    uint32_t GetSpriteCount() const { return m_count; }
+    uint32_t GetDroppedSpriteCount() const { return m_droppedCount; }
+
+    // RGBA8 of a color with components in [0, 1]
+    static uint32_t PackColor(const glm::vec4& color);
+
+private:
+    SpriteInstance* Allocate();
+
+    SpriteInstance* m_instances = nullptr;
+    uint32_t m_capacity = 0;
+    uint32_t m_count = 0;
+    uint32_t m_droppedCount = 0;
+    SpriteRegion m_whiteRegion;
+};
+
+// the axis aligned draws are called up to a million times per frame, they stay inline
+
+inline SpriteInstance* SpriteBatch::Allocate()
+{
+    if (m_count < m_capacity)
+    {
+        return m_instances + m_count++;
+    }
+    m_droppedCount++;
+    return nullptr;
+}
+
+inline void SpriteBatch::DrawQuad(const glm::vec2& center, const glm::vec2& size, const uint32_t color)
+{
+    DrawSprite(center, size, m_whiteRegion, color);
+}
+
+inline void SpriteBatch::DrawSprite(const glm::vec2& center, const glm::vec2& size, const SpriteRegion& region, const uint32_t color)
+{
+    SpriteInstance* instance = Allocate();
+    if (!instance)
+    {
+        return;
+    }
+    // written as a whole, the mapped memory may be write-combined
+    *instance = SpriteInstance{center, glm::vec2(size.x * 0.5f, 0.0f), glm::vec2(0.0f, size.y * 0.5f), region, color};
+}
+
+} // namespace RenderSys
@@ -0,0 +1,182 @@
+#include "VertexPacking.h"
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+
+namespace RenderSys
+{
+
+namespace
+{
+
+constexpr float SNORM16_MAX = 32767.0f;
+constexpr float UNORM16_MAX = 65535.0f;
+constexpr float UNORM8_MAX = 255.0f;
+
+float SignNotZero(const float value)
+{
+    return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+// unit vector to the [-1, 1] square, the lower hemisphere is folded over the diagonals
+glm::vec2 OctahedralProject(const glm::vec3& direction)
+{
+    const float l1Norm = std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z);
+    if (l1Norm == 0.0f)
+    {
+        return glm::vec2(0.0f);
+    }
+    glm::vec2 projected = glm::vec2(direction.x, direction.y) / l1Norm;
+    if (direction.z < 0.0f)
+    {
+        projected = glm::vec2((1.0f - std::abs(projected.y)) * SignNotZero(projected.x),
+                              (1.0f - std::abs(projected.x)) * SignNotZero(projected.y));
+    }
+    return projected;
+}
+
+glm::vec3 OctahedralUnproject(const glm::vec2& projected)
+{
+    glm::vec3 direction(projected.x, projected.y, 1.0f - std::abs(projected.x) - std::abs(projected.y));
+    const float fold = std::max(-direction.z, 0.0f);
+    direction.x += direction.x >= 0.0f ? -fold : fold;
+    direction.y += direction.y >= 0.0f ? -fold : fold;
+    return glm::normalize(direction);
+}
+
+} // namespace
+
+glm::i16vec2 VertexPacking::EncodeOctahedral(const glm::vec3& direction)
+{
+    const glm::vec2 scaled = OctahedralProject(direction) * SNORM16_MAX;
+    const glm::vec3 unitDirection = glm::dot(direction, direction) > 0.0f ? glm::normalize(direction) : glm::vec3(0.0f, 0.0f, 1.0f);
+
+    // the nearest grid point of the square is not always the nearest on the sphere, try the four around it
+    glm::i16vec2 best(0);
+    float bestCos = -2.0f;
+    for (int corner = 0; corner < 4; ++corner)
+    {
+        const float x = (corner & 1) ? std::ceil(scaled.x) : std::floor(scaled.x);
+        const float y = (corner & 2) ? std::ceil(scaled.y) : std::floor(scaled.y);
+        const glm::i16vec2 candidate(static_cast<int16_t>(glm::clamp(x, -SNORM16_MAX, SNORM16_MAX)),
+                                     static_cast<int16_t>(glm::clamp(y, -SNORM16_MAX, SNORM16_MAX)));
+        const float candidateCos = glm::dot(DecodeOctahedral(candidate), unitDirection);
+        if (candidateCos > bestCos)
+        {
+            bestCos = candidateCos;
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+glm::vec3 VertexPacking::DecodeOctahedral(const glm::i16vec2& encoded)
+{
+    // snorm16 fetch, -32768 and -32767 both read as -1
+    const glm::vec2 projected = glm::max(glm::vec2(encoded) / SNORM16_MAX, glm::vec2(-1.0f));
+    return OctahedralUnproject(projected);
+}
+
+glm::u16vec2 VertexPacking::EncodeTexcoord(const glm::vec2& texcoord, const PackedUvFormat format)
+{
+    if (format == PackedUvFormat::Unorm16)
+    {
+        const glm::vec2 scaled = glm::round(glm::clamp(texcoord, glm::vec2(0.0f), glm::vec2(1.0f)) * UNORM16_MAX);
+        return glm::u16vec2(static_cast<uint16_t>(scaled.x), static_cast<uint16_t>(scaled.y));
+    }
+    return glm::u16vec2(glm::packHalf1x16(texcoord.x), glm::packHalf1x16(texcoord.y));
+}
+
+glm::vec2 VertexPacking::DecodeTexcoord(const glm::u16vec2& encoded, const PackedUvFormat format)
+{
+    if (format == PackedUvFormat::Unorm16)
+    {
+        return glm::vec2(encoded) / UNORM16_MAX;
+    }
+    return glm::vec2(glm::unpackHalf1x16(encoded.x), glm::unpackHalf1x16(encoded.y));
+}
+
+glm::u8vec4 VertexPacking::EncodeColor(const glm::vec3& color)
+{
+    const glm::vec3 scaled = glm::round(glm::clamp(color, glm::vec3(0.0f), glm::vec3(1.0f)) * UNORM8_MAX);
+    return glm::u8vec4(static_cast<uint8_t>(scaled.r), static_cast<uint8_t>(scaled.g), static_cast<uint8_t>(scaled.b), 255);
+}
+
+glm::vec3 VertexPacking::DecodeColor(const glm::u8vec4& encoded)
+{
+    return glm::vec3(encoded.r, encoded.g, encoded.b) / UNORM8_MAX;
+}
+
+PackedVertex VertexPacking::Pack(const Vertex& vertex, const PackedUvFormat uvFormat)
+{
+    PackedVertex packedVertex;
+    packedVertex.position = vertex.position;
+    packedVertex.normal = EncodeOctahedral(vertex.normal);
+    packedVertex.tangent = EncodeOctahedral(vertex.tangent);
+    packedVertex.texcoord0 = EncodeTexcoord(vertex.texcoord0, uvFormat);
+    packedVertex.color = EncodeColor(vertex.color);
+    return packedVertex;
+}
+
+Vertex VertexPacking::Unpack(const PackedVertex& packedVertex, const PackedUvFormat uvFormat)
+{
+    Vertex vertex;
+    vertex.position = packedVertex.position;
+    vertex.normal = DecodeOctahedral(packedVertex.normal);
+    vertex.tangent = DecodeOctahedral(packedVertex.tangent);
+    vertex.texcoord0 = DecodeTexcoord(packedVertex.texcoord0, uvFormat);
+    vertex.color = DecodeColor(packedVertex.color);
+    return vertex;
+}
+
+uint32_t VertexPacking::Pack(const VertexBuffer& vertices, PackedVertexBuffer& packedVertices)
+{
+    packedVertices.resize(vertices.size());
+    uint32_t clampedVertices = 0;
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        const glm::vec2& texcoord = vertices[i].texcoord0;
+        if (packedVertices.uvFormat == PackedUvFormat::Unorm16 &&
+            (glm::any(glm::lessThan(texcoord, glm::vec2(0.0f))) || glm::any(glm::greaterThan(texcoord, glm::vec2(1.0f)))))
+        {
+            ++clampedVertices;
+        }
+        packedVertices[i] = Pack(vertices[i], packedVertices.uvFormat);
+    }
+    if (clampedVertices > 0)
+    {
+        std::cout << "Warning: " << clampedVertices << " of " << vertices.size()
+                  << " vertices have texture coordinates outside [0, 1], use PackedUvFormat::Float16 for them" << std::endl;
+    }
+    return clampedVertices;
+}
+
+std::vector<VertexAttribute> VertexPacking::GetVertexAttributes(const PackedUvFormat uvFormat)
+{
+    std::vector<VertexAttribute> vertexAttribs(5);
+
+    vertexAttribs[0].location = 0;
+    vertexAttribs[0].format = VertexFormat::Float32x3;
+    vertexAttribs[0].offset = offsetof(PackedVertex, position);
+
+    vertexAttribs[1].location = 1;
+    vertexAttribs[1].format = VertexFormat::Snorm16x2;
+    vertexAttribs[1].offset = offsetof(PackedVertex, normal);
+
+    vertexAttribs[2].location = 2;
+    vertexAttribs[2].format = uvFormat == PackedUvFormat::Unorm16 ? VertexFormat::Unorm16x2 : VertexFormat::Float16x2;
+    vertexAttribs[2].offset = offsetof(PackedVertex, texcoord0);
+
+    vertexAttribs[3].location = 3;
+    vertexAttribs[3].format = VertexFormat::Unorm8x4;
+    vertexAttribs[3].offset = offsetof(PackedVertex, color);
+
+    vertexAttribs[4].location = 4;
+    vertexAttribs[4].format = VertexFormat::Snorm16x2;
+    vertexAttribs[4].offset = offsetof(PackedVertex, tangent);
+
+    return vertexAttribs;
+}
+
+} // namespace RenderSys
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "Buffer.h"
+#include "RenderUtil.h"
+
+namespace RenderSys
+{
+
+// Quantization of Vertex into PackedVertex and back. Normals and tangents are mapped onto an octahedron
+// (Cigolle et al., A Survey of Efficient Representations for Independent Unit Vectors), the encoder picks
+// the rounding of the two components with the smallest angular error, below 0.01 degrees at 16 bits.
+class VertexPacking
+{
+public:
+    static glm::i16vec2 EncodeOctahedral(const glm::vec3& direction);
+    // same as the snorm16 vertex fetch and octDecode() of vertex-packing.glsl
+    static glm::vec3 DecodeOctahedral(const glm::i16vec2& encoded);
+    static glm::u16vec2 EncodeTexcoord(const glm::vec2& texcoord, const PackedUvFormat format);
+    static glm::vec2 DecodeTexcoord(const glm::u16vec2& encoded, const PackedUvFormat format);
+    static glm::u8vec4 EncodeColor(const glm::vec3& color);
+    static glm::vec3 DecodeColor(const glm::u8vec4& encoded);
+
+    static PackedVertex Pack(const Vertex& vertex, const PackedUvFormat uvFormat);
+    static Vertex Unpack(const PackedVertex& packedVertex, const PackedUvFormat uvFormat);
+    // packs in the uvFormat of the packed buffer, returns the number of vertices with clamped texture coordinates
+    static uint32_t Pack(const VertexBuffer& vertices, PackedVertexBuffer& packedVertices);
+
+    // the attributes of PackedVertex at the locations of the Vertex attributes: position 0, normal 1,
+    // texcoord0 2, color 3 and tangent 4, the vertex buffer layout of a PackedVertexBuffer points to them
+    static std::vector<VertexAttribute> GetVertexAttributes(const PackedUvFormat uvFormat);
+};
+
+} // namespace RenderSys
@@ -0,0 +1,486 @@
+#include "VulkanHzbCullingPipeline.h"
+#include <RenderSys/Vulkan/VulkanDevice.h>
+
+#include <RenderSys/Vulkan/VulkanMemAlloc.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace RenderSys {
+
+namespace Vulkan {
+
+namespace
+{
+constexpr uint32_t maxNumOfPyramidLevels = 16;
+constexpr uint32_t numOfCullBindings = 5;
+}
+
+HzbCullingPipeline::HzbCullingPipeline(const VkPipelineShaderStageCreateInfo& reduceShaderStageInfo,
+                                        const VkPipelineShaderStageCreateInfo& cullShaderStageInfo,
+                                        VkBuffer indirectCommandBuffer)
+    : m_reduceShaderStageInfo(reduceShaderStageInfo)
+    , m_cullShaderStageInfo(cullShaderStageInfo)
+{
+    assert(m_reduceShaderStageInfo.stage == VK_SHADER_STAGE_COMPUTE_BIT);
+    assert(m_cullShaderStageInfo.stage == VK_SHADER_STAGE_COMPUTE_BIT);
+    CreateBindGroupLayouts();
+    CreatePipelines();
+    CreateBuffers(indirectCommandBuffer);
+}
+
+HzbCullingPipeline::~HzbCullingPipeline()
+{
+    DestroyDepthPyramid();
+
+    for (auto pipeline : {&m_reducePipeline, &m_cullPipeline})
+    {
+        if (*pipeline)
+        {
+            vkDestroyPipeline(RenderSys::Vulkan::GetDevice(), *pipeline, nullptr);
+            *pipeline = VK_NULL_HANDLE;
+        }
+    }
+
+    for (auto pipelineLayout : {&m_reducePipelineLayout, &m_cullPipelineLayout})
+    {
+        if (*pipelineLayout)
+        {
+            vkDestroyPipelineLayout(RenderSys::Vulkan::GetDevice(), *pipelineLayout, nullptr);
+            *pipelineLayout = VK_NULL_HANDLE;
+        }
+    }
+
+    if (m_bindGroupPool)
+    {
+        vkDestroyDescriptorPool(RenderSys::Vulkan::GetDevice(), m_bindGroupPool, nullptr);
+        m_bindGroupPool = VK_NULL_HANDLE;
+    }
+
+    for (auto bindGroupLayout : {&m_reduceBindGroupLayout, &m_cullBindGroupLayout})
+    {
+        if (*bindGroupLayout)
+        {
+            vkDestroyDescriptorSetLayout(RenderSys::Vulkan::GetDevice(), *bindGroupLayout, nullptr);
+            *bindGroupLayout = VK_NULL_HANDLE;
+        }
+    }
+
+    if (m_drawBoundsBuffer)
+    {
+        vmaDestroyBuffer(RenderSys::Vulkan::GetMemoryAllocator(), m_drawBoundsBuffer, m_drawBoundsBufferMemory);
+        vmaDestroyBuffer(RenderSys::Vulkan::GetMemoryAllocator(), m_visibilityBuffer, m_visibilityBufferMemory);
+        vmaDestroyBuffer(RenderSys::Vulkan::GetMemoryAllocator(), m_counterBuffer, m_counterBufferMemory);
+        m_drawBoundsBuffer = VK_NULL_HANDLE;
+        m_visibilityBuffer = VK_NULL_HANDLE;
+        m_counterBuffer = VK_NULL_HANDLE;
+        m_drawBounds = nullptr;
+        m_visibility = nullptr;
+        m_counters = nullptr;
+    }
+
+    for (auto shaderStageInfo : {&m_reduceShaderStageInfo, &m_cullShaderStageInfo})
+    {
+        if (shaderStageInfo->module != VK_NULL_HANDLE)
+        {
+            vkDestroyShaderModule(RenderSys::Vulkan::GetDevice(), shaderStageInfo->module, nullptr);
+            shaderStageInfo->module = VK_NULL_HANDLE;
+        }
+    }
+}
+
+void HzbCullingPipeline::CreateBindGroupLayouts()
+{
+    std::array<VkDescriptorSetLayoutBinding, 2> reduceBindings
+    {
+        VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr}, // depth image or previous level
+        VkDescriptorSetLayoutBinding{1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr}           // level
+    };
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = reduceBindings.size();
+    layoutInfo.pBindings = reduceBindings.data();
+    if (vkCreateDescriptorSetLayout(RenderSys::Vulkan::GetDevice(), &layoutInfo, nullptr, &m_reduceBindGroupLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor set layout!");
+    }
+
+    std::array<VkDescriptorSetLayoutBinding, numOfCullBindings> cullBindings
+    {
+        VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr},        // draw bounds
+        VkDescriptorSetLayoutBinding{1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr},        // indirect commands
+        VkDescriptorSetLayoutBinding{2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr},        // visibility
+        VkDescriptorSetLayoutBinding{3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr},        // counters
+        VkDescriptorSetLayoutBinding{4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr} // depth pyramid
+    };
+    layoutInfo.bindingCount = cullBindings.size();
+    layoutInfo.pBindings = cullBindings.data();
+    if (vkCreateDescriptorSetLayout(RenderSys::Vulkan::GetDevice(), &layoutInfo, nullptr, &m_cullBindGroupLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor set layout!");
+    }
+
+    // every bind group points into the pyramid, the pool is reset when the pyramid is destroyed
+    std::array<VkDescriptorPoolSize, 3> poolSizes
+    {
+        VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, maxNumOfPyramidLevels + 1},
+        VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, maxNumOfPyramidLevels},
+        VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, numOfCullBindings - 1}
+    };
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = poolSizes.size();
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = maxNumOfPyramidLevels + 1;
+    if (vkCreateDescriptorPool(RenderSys::Vulkan::GetDevice(), &poolInfo, nullptr, &m_bindGroupPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor pool!");
+    }
+}
+
+void HzbCullingPipeline::CreatePipelines()
+{
+    auto createPipeline = [](VkDescriptorSetLayout bindGroupLayout, const uint32_t pushConstantSize,
+                                const VkPipelineShaderStageCreateInfo& shaderStageInfo,
+                                VkPipelineLayout& pipelineLayout, VkPipeline& pipeline)
+    {
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = pushConstantSize;
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &bindGroupLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+        auto result = vkCreatePipelineLayout(RenderSys::Vulkan::GetDevice(), &pipelineLayoutInfo, nullptr, &pipelineLayout);
+        if (result != VK_SUCCESS)
+        {
+            GraphicsAPI::Vulkan::check_vk_result(result);
+        }
+
+        VkComputePipelineCreateInfo pipelineCreateInfo{};
+        pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineCreateInfo.stage = shaderStageInfo;
+        pipelineCreateInfo.layout = pipelineLayout;
+        if (vkCreateComputePipelines(RenderSys::Vulkan::GetDevice(), VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &pipeline) != VK_SUCCESS) {
+            std::cout << "error: could not create HZB culling pipeline" << std::endl;
+        }
+        assert(pipeline != VK_NULL_HANDLE);
+    };
+
+    std::cout << "Creating HZB culling pipelines..." << std::endl;
+    createPipeline(m_reduceBindGroupLayout, sizeof(ReducePushConstants), m_reduceShaderStageInfo, m_reducePipelineLayout, m_reducePipeline);
+    createPipeline(m_cullBindGroupLayout, sizeof(CullPushConstants), m_cullShaderStageInfo, m_cullPipelineLayout, m_cullPipeline);
+    std::cout << "HZB culling pipelines: " << m_reducePipeline << ", " << m_cullPipeline << std::endl;
+}
+
+void HzbCullingPipeline::CreateBuffers(VkBuffer indirectCommandBuffer)
+{
+    assert(indirectCommandBuffer != VK_NULL_HANDLE);
+    VmaAllocationCreateInfo vmaAllocInfo{};
+    vmaAllocInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+    vmaAllocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    VmaAllocationInfo mappedInfo{};
+
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = sizeof(DrawBounds) * MAX_INDIRECT_DRAWS;
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (vmaCreateBuffer(RenderSys::Vulkan::GetMemoryAllocator(), &bufferInfo, &vmaAllocInfo,
+                        &m_drawBoundsBuffer, &m_drawBoundsBufferMemory, &mappedInfo) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create draw bounds buffer!");
+    }
+    m_drawBounds = static_cast<DrawBounds*>(mappedInfo.pMappedData);
+
+    bufferInfo.size = sizeof(uint32_t) * MAX_VISIBILITY_SLOTS;
+    if (vmaCreateBuffer(RenderSys::Vulkan::GetMemoryAllocator(), &bufferInfo, &vmaAllocInfo,
+                        &m_visibilityBuffer, &m_visibilityBufferMemory, &mappedInfo) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create visibility buffer!");
+    }
+    m_visibility = static_cast<uint32_t*>(mappedInfo.pMappedData);
+    std::memset(m_visibility, 0, sizeof(uint32_t) * MAX_VISIBILITY_SLOTS);
+
+    // read back by the CPU, cleared on the GPU before each late phase
+    vmaAllocInfo.usage = VMA_MEMORY_USAGE_GPU_TO_CPU;
+    bufferInfo.size = sizeof(Counters);
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    if (vmaCreateBuffer(RenderSys::Vulkan::GetMemoryAllocator(), &bufferInfo, &vmaAllocInfo,
+                        &m_counterBuffer, &m_counterBufferMemory, &mappedInfo) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create culling counter buffer!");
+    }
+    m_counters = static_cast<Counters*>(mappedInfo.pMappedData);
+    *m_counters = {};
+
+    m_indirectCommandBuffer = indirectCommandBuffer;
+}
+
+void HzbCullingPipeline::CreateDepthPyramid(VkImageView depthImageView, uint32_t width, uint32_t height)
+{
+    DestroyDepthPyramid();
+    assert(depthImageView != VK_NULL_HANDLE && width > 0 && height > 0);
+    m_depthWidth = width;
+    m_depthHeight = height;
+    m_pyramidWidth = std::max(width / 2, 1u);
+    m_pyramidHeight = std::max(height / 2, 1u);
+    m_pyramidLevelCount = 1;
+    while ((std::max(m_pyramidWidth, m_pyramidHeight) >> m_pyramidLevelCount) > 0 && m_pyramidLevelCount < maxNumOfPyramidLevels)
+    {
+        m_pyramidLevelCount++;
+    }
+
+    VkImageCreateInfo pyramidImageInfo{};
+    pyramidImageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    pyramidImageInfo.imageType = VK_IMAGE_TYPE_2D;
+    pyramidImageInfo.format = VK_FORMAT_R32_SFLOAT;
+    pyramidImageInfo.extent = VkExtent3D{m_pyramidWidth, m_pyramidHeight, 1};
+    pyramidImageInfo.mipLevels = m_pyramidLevelCount;
+    pyramidImageInfo.arrayLayers = 1;
+    pyramidImageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    pyramidImageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    pyramidImageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    pyramidImageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    pyramidImageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+    allocInfo.requiredFlags = VkMemoryPropertyFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (vmaCreateImage(RenderSys::Vulkan::GetMemoryAllocator(), &pyramidImageInfo, &allocInfo, &m_pyramidImage, &m_pyramidImageMemory, nullptr) != VK_SUCCESS)
+    {
+        assert(false);
+    }
+
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = m_pyramidImage;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = VK_FORMAT_R32_SFLOAT;
+    viewInfo.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, m_pyramidLevelCount, 0, 1};
+    if (vkCreateImageView(RenderSys::Vulkan::GetDevice(), &viewInfo, nullptr, &m_pyramidView) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create image view!");
+    }
+    m_pyramidLevelViews.resize(m_pyramidLevelCount);
+    for (uint32_t level = 0; level < m_pyramidLevelCount; ++level)
+    {
+        viewInfo.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, level, 1, 0, 1};
+        if (vkCreateImageView(RenderSys::Vulkan::GetDevice(), &viewInfo, nullptr, &m_pyramidLevelViews[level]) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create image view!");
+        }
+    }
+
+    // only read with texelFetch(), the sampler has to cover every level
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_NEAREST;
+    samplerInfo.minFilter = VK_FILTER_NEAREST;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = static_cast<float>(m_pyramidLevelCount);
+    if (vkCreateSampler(RenderSys::Vulkan::GetDevice(), &samplerInfo, nullptr, &m_pyramidSampler) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create texture sampler!");
+    }
+
+    std::vector<VkDescriptorSetLayout> layouts(m_pyramidLevelCount, m_reduceBindGroupLayout);
+    layouts.push_back(m_cullBindGroupLayout);
+    std::vector<VkDescriptorSet> bindGroups(layouts.size());
+    VkDescriptorSetAllocateInfo allocSetInfo{};
+    allocSetInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocSetInfo.descriptorPool = m_bindGroupPool;
+    allocSetInfo.descriptorSetCount = static_cast<uint32_t>(layouts.size());
+    allocSetInfo.pSetLayouts = layouts.data();
+    if (vkAllocateDescriptorSets(RenderSys::Vulkan::GetDevice(), &allocSetInfo, bindGroups.data()) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate descriptor sets!");
+    }
+    m_cullBindGroup = bindGroups.back();
+    bindGroups.pop_back();
+    m_reduceBindGroups = std::move(bindGroups);
+
+    std::vector<VkDescriptorImageInfo> imageInfos;
+    imageInfos.reserve(m_pyramidLevelCount * 2 + 1);
+    std::vector<VkWriteDescriptorSet> writes;
+    auto addImageWrite = [&](VkDescriptorSet bindGroup, uint32_t binding, VkDescriptorType type, const VkDescriptorImageInfo& imageInfo)
+    {
+        imageInfos.push_back(imageInfo);
+        VkWriteDescriptorSet write{};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = bindGroup;
+        write.dstBinding = binding;
+        write.descriptorType = type;
+        write.descriptorCount = 1;
+        write.pImageInfo = &imageInfos.back();
+        writes.push_back(write);
+    };
+
+    for (uint32_t level = 0; level < m_pyramidLevelCount; ++level)
+    {
+        const VkDescriptorImageInfo sourceInfo = level == 0 ?
+                VkDescriptorImageInfo{m_pyramidSampler, depthImageView, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL} :
+                VkDescriptorImageInfo{m_pyramidSampler, m_pyramidLevelViews[level - 1], VK_IMAGE_LAYOUT_GENERAL};
+        addImageWrite(m_reduceBindGroups[level], 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, sourceInfo);
+        addImageWrite(m_reduceBindGroups[level], 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                        VkDescriptorImageInfo{VK_NULL_HANDLE, m_pyramidLevelViews[level], VK_IMAGE_LAYOUT_GENERAL});
+    }
+    addImageWrite(m_cullBindGroup, 4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                    VkDescriptorImageInfo{m_pyramidSampler, m_pyramidView, VK_IMAGE_LAYOUT_GENERAL});
+
+    std::array<VkDescriptorBufferInfo, numOfCullBindings - 1> bufferInfos
+    {
+        VkDescriptorBufferInfo{m_drawBoundsBuffer, 0, VK_WHOLE_SIZE},
+        VkDescriptorBufferInfo{m_indirectCommandBuffer, 0, VK_WHOLE_SIZE},
+        VkDescriptorBufferInfo{m_visibilityBuffer, 0, VK_WHOLE_SIZE},
+        VkDescriptorBufferInfo{m_counterBuffer, 0, VK_WHOLE_SIZE}
+    };
+    for (uint32_t binding = 0; binding < bufferInfos.size(); binding++)
+    {
+        VkWriteDescriptorSet write{};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = m_cullBindGroup;
+        write.dstBinding = binding;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        write.descriptorCount = 1;
+        write.pBufferInfo = &bufferInfos[binding];
+        writes.push_back(write);
+    }
+
+    vkUpdateDescriptorSets(RenderSys::Vulkan::GetDevice(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+}
+
+void HzbCullingPipeline::DestroyDepthPyramid()
+{
+    if (m_pyramidImage == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    vkDeviceWaitIdle(RenderSys::Vulkan::GetDevice());
+    vkResetDescriptorPool(RenderSys::Vulkan::GetDevice(), m_bindGroupPool, 0);
+    m_reduceBindGroups.clear();
+    m_cullBindGroup = VK_NULL_HANDLE;
+
+    vkDestroySampler(RenderSys::Vulkan::GetDevice(), m_pyramidSampler, nullptr);
+    m_pyramidSampler = VK_NULL_HANDLE;
+    for (auto levelView : m_pyramidLevelViews)
+    {
+        vkDestroyImageView(RenderSys::Vulkan::GetDevice(), levelView, nullptr);
+    }
+    m_pyramidLevelViews.clear();
+    vkDestroyImageView(RenderSys::Vulkan::GetDevice(), m_pyramidView, nullptr);
+    m_pyramidView = VK_NULL_HANDLE;
+    vmaDestroyImage(RenderSys::Vulkan::GetMemoryAllocator(), m_pyramidImage, m_pyramidImageMemory);
+    m_pyramidImage = VK_NULL_HANDLE;
+    m_pyramidLevelCount = 0;
+}
+
+uint32_t HzbCullingPipeline::GetVisibilitySlot(const void* draw)
+{
+    auto slotIter = m_visibilitySlots.find(draw);
+    if (slotIter != m_visibilitySlots.end())
+    {
+        return slotIter->second;
+    }
+
+    if (m_visibilitySlots.size() >= MAX_VISIBILITY_SLOTS)
+    {
+        // slots of draws which are gone are never given back, start over and let the late phase test everything again
+        // the command buffer of the last frame has completed, nothing reads the visibility now
+        m_visibilitySlots.clear();
+        std::memset(m_visibility, 0, sizeof(uint32_t) * MAX_VISIBILITY_SLOTS);
+    }
+    const uint32_t slot = static_cast<uint32_t>(m_visibilitySlots.size());
+    m_visibilitySlots.emplace(draw, slot);
+    return slot;
+}
+
+uint32_t HzbCullingPipeline::Cull(VkCommandBuffer commandBuffer, const Phase phase, const glm::mat4& viewProjection, const uint32_t drawCount)
+{
+    assert(HasDepthPyramid());
+    if (phase == Phase::LATE)
+    {
+        vkCmdFillBuffer(commandBuffer, m_counterBuffer, 0, sizeof(Counters), 0);
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    if (drawCount == 0)
+    {
+        return 0;
+    }
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipelineLayout, 0
+                                , 1, &m_cullBindGroup
+                                , 0, nullptr);
+
+    const CullPushConstants pushConstants{viewProjection,
+                                            glm::vec2(static_cast<float>(m_depthWidth), static_cast<float>(m_depthHeight)),
+                                            drawCount, static_cast<uint32_t>(phase), m_pyramidLevelCount};
+    vkCmdPushConstants(commandBuffer, m_cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+    vkCmdDispatch(commandBuffer, (drawCount + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE, 1, 1);
+    return 1;
+}
+
+uint32_t HzbCullingPipeline::BuildDepthPyramid(VkCommandBuffer commandBuffer)
+{
+    assert(HasDepthPyramid());
+
+    // the content of the last frame is not needed, every level is written again
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = m_pyramidImage;
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, m_pyramidLevelCount, 0, 1};
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                            0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_reducePipeline);
+    glm::ivec2 sourceSize(static_cast<int>(m_depthWidth), static_cast<int>(m_depthHeight));
+    for (uint32_t level = 0; level < m_pyramidLevelCount; ++level)
+    {
+        const glm::ivec2 destinationSize(std::max(static_cast<int>(m_pyramidWidth >> level), 1),
+                                            std::max(static_cast<int>(m_pyramidHeight >> level), 1));
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_reducePipelineLayout, 0
+                                    , 1, &m_reduceBindGroups[level]
+                                    , 0, nullptr);
+        const ReducePushConstants pushConstants{sourceSize, destinationSize};
+        vkCmdPushConstants(commandBuffer, m_reducePipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+        vkCmdDispatch(commandBuffer, (destinationSize.x + REDUCE_WORKGROUP_SIZE - 1) / REDUCE_WORKGROUP_SIZE,
+                        (destinationSize.y + REDUCE_WORKGROUP_SIZE - 1) / REDUCE_WORKGROUP_SIZE, 1);
+
+        // the next level reads this one, the late phase reads all of them
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+        barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, level, 1, 0, 1};
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                0, 0, nullptr, 0, nullptr, 1, &barrier);
+        sourceSize = destinationSize;
+    }
+    return m_pyramidLevelCount;
+}
+
+HzbCullingPipeline::Counters HzbCullingPipeline::ReadCounters() const
+{
+    vmaInvalidateAllocation(RenderSys::Vulkan::GetMemoryAllocator(), m_counterBufferMemory, 0, VK_WHOLE_SIZE);
+    return *m_counters;
+}
+
+} // namespace Vulkan
+
+} // namespace RenderSys
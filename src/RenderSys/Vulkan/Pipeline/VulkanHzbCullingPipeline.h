@@ -0,0 +1,140 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include <unordered_map>
+#include <glm/ext.hpp>
+#include <vk_mem_alloc.h>
+#include <Walnut/GraphicsAPI/VulkanGraphics.h>
+#include <resources/Shaders/ShaderResource.h>
+
+namespace RenderSys
+{
+namespace Vulkan
+{
+
+// Two phase occlusion culling of indirect draws against a hierarchical depth buffer (hzb-cull-compute.glsl).
+// The early phase keeps the draws which were visible last frame, they are drawn and their depth is reduced
+// into the depth pyramid (hzb-reduce-compute.glsl, farthest depth of each 2x2 texels). The late phase tests the
+// bounds of every draw against the pyramid, draws what became visible and stores the visibility for the next frame.
+// Both phases only write the instance count of the indirect commands.
+class HzbCullingPipeline
+{
+
+public:
+    static constexpr uint32_t CULL_WORKGROUP_SIZE = HZB_CULL_WORKGROUP_SIZE;
+    static constexpr uint32_t REDUCE_WORKGROUP_SIZE = HZB_REDUCE_WORKGROUP_SIZE;
+    static constexpr uint32_t MAX_VISIBILITY_SLOTS = MAX_INDIRECT_DRAWS;
+
+    enum class Phase : uint32_t
+    {
+        EARLY = 0,
+        LATE
+    };
+
+    // one per indirect command, matches hzb-cull-compute.glsl
+    struct DrawBounds
+    {
+        glm::vec4 m_BoundsMin;
+        glm::vec4 m_BoundsMax;
+        uint32_t m_CommandIndex;
+        uint32_t m_VisibilitySlot;
+        uint32_t m_InstanceCount;
+        uint32_t m_AlwaysVisible; // no bounds, never culled
+    };
+
+    struct CullPushConstants
+    {
+        glm::mat4 m_ViewProjection;
+        glm::vec2 m_DepthSize;
+        uint32_t m_DrawCount;
+        uint32_t m_Phase;
+        uint32_t m_PyramidLevelCount;
+    };
+
+    struct ReducePushConstants
+    {
+        glm::ivec2 m_SourceSize;
+        glm::ivec2 m_DestinationSize;
+    };
+
+    // results of the late phase
+    struct Counters
+    {
+        uint32_t m_Visible = 0;
+        uint32_t m_Occluded = 0;
+        uint32_t m_FrustumCulled = 0;
+        uint32_t m_Padding = 0;
+    };
+
+    HzbCullingPipeline(const VkPipelineShaderStageCreateInfo& reduceShaderStageInfo,
+                        const VkPipelineShaderStageCreateInfo& cullShaderStageInfo,
+                        VkBuffer indirectCommandBuffer);
+    ~HzbCullingPipeline();
+
+    HzbCullingPipeline(const HzbCullingPipeline&) = delete;
+    HzbCullingPipeline& operator=(const HzbCullingPipeline&) = delete;
+    HzbCullingPipeline(HzbCullingPipeline&&) = delete;
+    HzbCullingPipeline& operator=(HzbCullingPipeline&&) = delete;
+
+    // the pyramid follows the depth image, it has to be created again whenever the depth image is
+    void CreateDepthPyramid(VkImageView depthImageView, uint32_t width, uint32_t height);
+    void DestroyDepthPyramid();
+    bool HasDepthPyramid() const { return m_pyramidImage != VK_NULL_HANDLE; }
+
+    // the slot keeps the visibility of a draw over frames
+    uint32_t GetVisibilitySlot(const void* draw);
+    // persistently mapped, written while recording the draws of a frame
+    DrawBounds* GetDrawBounds() { return m_drawBounds; }
+
+    // records the culling of drawCount draws, their indirect commands can be drawn after a barrier. Returns the dispatch count
+    uint32_t Cull(VkCommandBuffer commandBuffer, const Phase phase, const glm::mat4& viewProjection, const uint32_t drawCount);
+    // the depth image has to be in the DEPTH_STENCIL_READ_ONLY_OPTIMAL layout, returns the dispatch count
+    uint32_t BuildDepthPyramid(VkCommandBuffer commandBuffer);
+    // counters of the last recorded late phase, only valid once its command buffer has completed
+    Counters ReadCounters() const;
+
+private:
+    void CreateBindGroupLayouts();
+    void CreatePipelines();
+    void CreateBuffers(VkBuffer indirectCommandBuffer);
+
+    VkPipelineShaderStageCreateInfo m_reduceShaderStageInfo;
+    VkPipelineShaderStageCreateInfo m_cullShaderStageInfo;
+    VkDescriptorSetLayout m_reduceBindGroupLayout = VK_NULL_HANDLE;
+    VkDescriptorSetLayout m_cullBindGroupLayout = VK_NULL_HANDLE;
+    VkDescriptorPool m_bindGroupPool = VK_NULL_HANDLE;
+    VkPipelineLayout m_reducePipelineLayout = VK_NULL_HANDLE;
+    VkPipelineLayout m_cullPipelineLayout = VK_NULL_HANDLE;
+    VkPipeline m_reducePipeline = VK_NULL_HANDLE;
+    VkPipeline m_cullPipeline = VK_NULL_HANDLE;
+
+    VkBuffer m_indirectCommandBuffer = VK_NULL_HANDLE; // owned by the renderer
+    VkBuffer m_drawBoundsBuffer = VK_NULL_HANDLE;
+    VmaAllocation m_drawBoundsBufferMemory = VK_NULL_HANDLE;
+    DrawBounds* m_drawBounds = nullptr;
+    VkBuffer m_visibilityBuffer = VK_NULL_HANDLE;
+    VmaAllocation m_visibilityBufferMemory = VK_NULL_HANDLE;
+    uint32_t* m_visibility = nullptr;
+    VkBuffer m_counterBuffer = VK_NULL_HANDLE;
+    VmaAllocation m_counterBufferMemory = VK_NULL_HANDLE;
+    Counters* m_counters = nullptr;
+    std::unordered_map<const void*, uint32_t> m_visibilitySlots;
+
+    // R32_SFLOAT, its first level has half the size of the depth image
+    VkImage m_pyramidImage = VK_NULL_HANDLE;
+    VmaAllocation m_pyramidImageMemory = VK_NULL_HANDLE;
+    VkImageView m_pyramidView = VK_NULL_HANDLE;
+    std::vector<VkImageView> m_pyramidLevelViews;
+    std::vector<VkDescriptorSet> m_reduceBindGroups; // one per level
+    VkSampler m_pyramidSampler = VK_NULL_HANDLE;
+    VkDescriptorSet m_cullBindGroup = VK_NULL_HANDLE;
+    uint32_t m_depthWidth = 0;
+    uint32_t m_depthHeight = 0;
+    uint32_t m_pyramidWidth = 0;
+    uint32_t m_pyramidHeight = 0;
+    uint32_t m_pyramidLevelCount = 0;
+};
+
+
+} // namespace Vulkan
+} // namespace RenderSys
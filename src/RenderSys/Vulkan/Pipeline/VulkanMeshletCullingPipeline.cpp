@@ -0,0 +1,392 @@
+#include "VulkanMeshletCullingPipeline.h"
+#include <RenderSys/Vulkan/VulkanDevice.h>
+
+#include <RenderSys/Vulkan/VulkanMemAlloc.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+namespace RenderSys {
+
+namespace Vulkan {
+
+namespace
+{
+constexpr uint32_t maxNumOfMeshletMeshes = 1024;
+constexpr uint32_t numOfFrameBindings = 4;
+constexpr uint32_t numOfMeshBindings = 3;
+// relative difference of the axis lengths up to which a transform counts as a uniform scale
+constexpr float maxScaleDifference = 1e-3f;
+
+// Gribb and Hartmann, the rows of the matrix combined into the planes of the clip volume, the near plane is
+// the one of -w <= z <= w which keeps a bit more than the 0 <= z <= w of Vulkan
+std::array<glm::vec4, 6> ExtractFrustumPlanes(const glm::mat4& viewProjection)
+{
+    const glm::mat4 rows = glm::transpose(viewProjection);
+    std::array<glm::vec4, 6> planes
+    {
+        rows[3] + rows[0], rows[3] - rows[0],
+        rows[3] + rows[1], rows[3] - rows[1],
+        rows[3] + rows[2], rows[3] - rows[2]
+    };
+    for (auto& plane : planes)
+    {
+        plane /= glm::length(glm::vec3(plane));
+    }
+    return planes;
+}
+
+// a rotation with a uniform scale keeps the normals of the triangles in their cone
+bool KeepsNormalCones(const glm::mat4& transform)
+{
+    const glm::mat3 linear(transform);
+    const float scaleX = glm::length(linear[0]);
+    const float scaleY = glm::length(linear[1]);
+    const float scaleZ = glm::length(linear[2]);
+    const float maxScale = std::max({scaleX, scaleY, scaleZ});
+    const float minScale = std::min({scaleX, scaleY, scaleZ});
+    return glm::determinant(linear) > 0.0f && maxScale - minScale <= maxScale * maxScaleDifference;
+}
+}
+
+MeshletCullingPipeline::MeshletCullingPipeline(const VkPipelineShaderStageCreateInfo& shaderStageInfo, VkBuffer indirectCommandBuffer)
+    : m_shaderStageInfo(shaderStageInfo)
+{
+    assert(m_shaderStageInfo.stage == VK_SHADER_STAGE_COMPUTE_BIT);
+    CreateBindGroupLayouts();
+    CreatePipeline();
+    CreateBuffers(indirectCommandBuffer);
+}
+
+MeshletCullingPipeline::~MeshletCullingPipeline()
+{
+    if (m_Pipeline)
+    {
+        vkDestroyPipeline(RenderSys::Vulkan::GetDevice(), m_Pipeline, nullptr);
+        m_Pipeline = VK_NULL_HANDLE;
+    }
+
+    if (m_PipelineLayout)
+    {
+        vkDestroyPipelineLayout(RenderSys::Vulkan::GetDevice(), m_PipelineLayout, nullptr);
+        m_PipelineLayout = VK_NULL_HANDLE;
+    }
+
+    if (m_bindGroupPool)
+    {
+        vkDeviceWaitIdle(RenderSys::Vulkan::GetDevice());
+        // when you destroy a descriptor pool, all descriptor sets allocated from that pool are automatically destroyed
+        vkDestroyDescriptorPool(RenderSys::Vulkan::GetDevice(), m_bindGroupPool, nullptr);
+        m_bindGroupPool = VK_NULL_HANDLE;
+        m_frameBindGroup = VK_NULL_HANDLE;
+    }
+
+    for (auto bindGroupLayout : {&m_frameBindGroupLayout, &m_meshBindGroupLayout})
+    {
+        if (*bindGroupLayout)
+        {
+            vkDestroyDescriptorSetLayout(RenderSys::Vulkan::GetDevice(), *bindGroupLayout, nullptr);
+            *bindGroupLayout = VK_NULL_HANDLE;
+        }
+    }
+
+    if (m_drawBuffer)
+    {
+        vmaDestroyBuffer(RenderSys::Vulkan::GetMemoryAllocator(), m_drawBuffer, m_drawBufferMemory);
+        vmaDestroyBuffer(RenderSys::Vulkan::GetMemoryAllocator(), m_transformBuffer, m_transformBufferMemory);
+        vmaDestroyBuffer(RenderSys::Vulkan::GetMemoryAllocator(), m_counterBuffer, m_counterBufferMemory);
+        m_drawBuffer = VK_NULL_HANDLE;
+        m_transformBuffer = VK_NULL_HANDLE;
+        m_counterBuffer = VK_NULL_HANDLE;
+        m_mappedDraws = nullptr;
+        m_transforms = nullptr;
+        m_counters = nullptr;
+    }
+
+    if (m_shaderStageInfo.module != VK_NULL_HANDLE)
+    {
+        vkDestroyShaderModule(RenderSys::Vulkan::GetDevice(), m_shaderStageInfo.module, nullptr);
+        m_shaderStageInfo.module = VK_NULL_HANDLE;
+    }
+}
+
+void MeshletCullingPipeline::CreateBindGroupLayouts()
+{
+    std::array<VkDescriptorSetLayoutBinding, numOfFrameBindings> frameBindings
+    {
+        VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr}, // draws
+        VkDescriptorSetLayoutBinding{1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr}, // transforms
+        VkDescriptorSetLayoutBinding{2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr}, // indirect commands
+        VkDescriptorSetLayoutBinding{3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr}  // counters
+    };
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = frameBindings.size();
+    layoutInfo.pBindings = frameBindings.data();
+    if (vkCreateDescriptorSetLayout(RenderSys::Vulkan::GetDevice(), &layoutInfo, nullptr, &m_frameBindGroupLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor set layout!");
+    }
+
+    std::array<VkDescriptorSetLayoutBinding, numOfMeshBindings> meshBindings
+    {
+        VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr}, // meshlets
+        VkDescriptorSetLayoutBinding{1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr}, // indices
+        VkDescriptorSetLayoutBinding{2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr}  // culled indices
+    };
+    layoutInfo.bindingCount = meshBindings.size();
+    layoutInfo.pBindings = meshBindings.data();
+    if (vkCreateDescriptorSetLayout(RenderSys::Vulkan::GetDevice(), &layoutInfo, nullptr, &m_meshBindGroupLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor set layout!");
+    }
+
+    VkDescriptorPoolSize poolSize{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, numOfFrameBindings + numOfMeshBindings * maxNumOfMeshletMeshes};
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = maxNumOfMeshletMeshes + 1;
+    if (vkCreateDescriptorPool(RenderSys::Vulkan::GetDevice(), &poolInfo, nullptr, &m_bindGroupPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor pool!");
+    }
+}
+
+void MeshletCullingPipeline::CreatePipeline()
+{
+    std::array<VkDescriptorSetLayout, 2> descriptorSetLayouts{m_frameBindGroupLayout, m_meshBindGroupLayout};
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(PushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    auto result = vkCreatePipelineLayout(RenderSys::Vulkan::GetDevice(), &pipelineLayoutInfo, nullptr, &m_PipelineLayout);
+    if (result != VK_SUCCESS)
+    {
+        GraphicsAPI::Vulkan::check_vk_result(result);
+    }
+
+    std::cout << "Creating meshlet culling pipeline..." << std::endl;
+    VkComputePipelineCreateInfo pipelineCreateInfo{};
+    pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineCreateInfo.stage = m_shaderStageInfo;
+    pipelineCreateInfo.layout = m_PipelineLayout;
+    if (vkCreateComputePipelines(RenderSys::Vulkan::GetDevice(), VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_Pipeline) != VK_SUCCESS) {
+        std::cout << "error: could not create meshlet culling pipeline" << std::endl;
+    }
+
+    assert(m_Pipeline != VK_NULL_HANDLE);
+    std::cout << "Meshlet culling pipeline: " << m_Pipeline << std::endl;
+}
+
+void MeshletCullingPipeline::CreateBuffers(VkBuffer indirectCommandBuffer)
+{
+    assert(indirectCommandBuffer != VK_NULL_HANDLE);
+    VmaAllocationCreateInfo vmaAllocInfo{};
+    vmaAllocInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+    vmaAllocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    VmaAllocationInfo mappedInfo{};
+
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = sizeof(MeshletDraw) * MAX_INDIRECT_DRAWS;
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (vmaCreateBuffer(RenderSys::Vulkan::GetMemoryAllocator(), &bufferInfo, &vmaAllocInfo,
+                        &m_drawBuffer, &m_drawBufferMemory, &mappedInfo) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create meshlet draw buffer!");
+    }
+    m_mappedDraws = static_cast<MeshletDraw*>(mappedInfo.pMappedData);
+
+    bufferInfo.size = sizeof(glm::mat4) * MAX_TRANSFORMS;
+    if (vmaCreateBuffer(RenderSys::Vulkan::GetMemoryAllocator(), &bufferInfo, &vmaAllocInfo,
+                        &m_transformBuffer, &m_transformBufferMemory, &mappedInfo) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create meshlet transform buffer!");
+    }
+    m_transforms = static_cast<glm::mat4*>(mappedInfo.pMappedData);
+
+    // read back by the CPU, cleared on the GPU before each culling
+    vmaAllocInfo.usage = VMA_MEMORY_USAGE_GPU_TO_CPU;
+    bufferInfo.size = sizeof(Counters);
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    if (vmaCreateBuffer(RenderSys::Vulkan::GetMemoryAllocator(), &bufferInfo, &vmaAllocInfo,
+                        &m_counterBuffer, &m_counterBufferMemory, &mappedInfo) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create meshlet counter buffer!");
+    }
+    m_counters = static_cast<Counters*>(mappedInfo.pMappedData);
+    *m_counters = {};
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_bindGroupPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &m_frameBindGroupLayout;
+    if (vkAllocateDescriptorSets(RenderSys::Vulkan::GetDevice(), &allocInfo, &m_frameBindGroup) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate descriptor sets!");
+    }
+
+    std::array<VkDescriptorBufferInfo, numOfFrameBindings> bufferInfos
+    {
+        VkDescriptorBufferInfo{m_drawBuffer, 0, VK_WHOLE_SIZE},
+        VkDescriptorBufferInfo{m_transformBuffer, 0, VK_WHOLE_SIZE},
+        VkDescriptorBufferInfo{indirectCommandBuffer, 0, VK_WHOLE_SIZE},
+        VkDescriptorBufferInfo{m_counterBuffer, 0, VK_WHOLE_SIZE}
+    };
+
+    std::array<VkWriteDescriptorSet, numOfFrameBindings> writes{};
+    for (uint32_t binding = 0; binding < numOfFrameBindings; binding++)
+    {
+        writes[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[binding].dstSet = m_frameBindGroup;
+        writes[binding].dstBinding = binding;
+        writes[binding].dstArrayElement = 0;
+        writes[binding].descriptorCount = 1;
+        writes[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[binding].pBufferInfo = &bufferInfos[binding];
+    }
+    vkUpdateDescriptorSets(RenderSys::Vulkan::GetDevice(), writes.size(), writes.data(), 0, nullptr);
+}
+
+VkDescriptorSet MeshletCullingPipeline::CreateBindGroup(VkBuffer meshletBuffer, VkBuffer indexBuffer, VkBuffer culledIndexBuffer)
+{
+    VkDescriptorSet bindGroup = VK_NULL_HANDLE;
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_bindGroupPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &m_meshBindGroupLayout;
+    if (vkAllocateDescriptorSets(RenderSys::Vulkan::GetDevice(), &allocInfo, &bindGroup) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate descriptor sets!");
+    }
+
+    std::array<VkDescriptorBufferInfo, numOfMeshBindings> bufferInfos
+    {
+        VkDescriptorBufferInfo{meshletBuffer, 0, VK_WHOLE_SIZE},
+        VkDescriptorBufferInfo{indexBuffer, 0, VK_WHOLE_SIZE},
+        VkDescriptorBufferInfo{culledIndexBuffer, 0, VK_WHOLE_SIZE}
+    };
+
+    std::array<VkWriteDescriptorSet, numOfMeshBindings> writes{};
+    for (uint32_t binding = 0; binding < numOfMeshBindings; binding++)
+    {
+        writes[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[binding].dstSet = bindGroup;
+        writes[binding].dstBinding = binding;
+        writes[binding].dstArrayElement = 0;
+        writes[binding].descriptorCount = 1;
+        writes[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[binding].pBufferInfo = &bufferInfos[binding];
+    }
+
+    vkUpdateDescriptorSets(RenderSys::Vulkan::GetDevice(), writes.size(), writes.data(), 0, nullptr);
+    return bindGroup;
+}
+
+void MeshletCullingPipeline::ResetDraws()
+{
+    m_draws.clear();
+    m_transformCount = 0;
+}
+
+bool MeshletCullingPipeline::AddDraw(VkDescriptorSet meshBindGroup, const uint32_t commandIndex, const uint32_t firstMeshlet, const uint32_t meshletCount,
+                                        const glm::mat4* transforms, const uint32_t transformCount)
+{
+    assert(meshBindGroup != VK_NULL_HANDLE && transformCount > 0);
+    if (m_draws.size() >= MAX_INDIRECT_DRAWS || m_transformCount + transformCount > MAX_TRANSFORMS)
+    {
+        std::cout << "Error: meshlet culling buffers are full!" << std::endl;
+        return false;
+    }
+
+    MeshletDraw draw{};
+    draw.m_FirstMeshlet = firstMeshlet;
+    draw.m_MeshletCount = meshletCount;
+    draw.m_CommandIndex = commandIndex;
+    draw.m_FirstTransform = m_transformCount;
+    draw.m_TransformCount = transformCount;
+    draw.m_ConeCulling = 1;
+    for (uint32_t transform = 0; transform < transformCount; ++transform)
+    {
+        m_transforms[m_transformCount++] = transforms[transform];
+        if (!KeepsNormalCones(transforms[transform]))
+        {
+            draw.m_ConeCulling = 0;
+        }
+    }
+    m_draws.push_back({meshBindGroup, draw});
+    return true;
+}
+
+uint32_t MeshletCullingPipeline::Cull(VkCommandBuffer commandBuffer, const glm::mat4& viewProjection, const glm::vec3& viewPosition)
+{
+    vkCmdFillBuffer(commandBuffer, m_counterBuffer, 0, sizeof(Counters), 0);
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                            0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    if (m_draws.empty())
+    {
+        return 0;
+    }
+
+    std::stable_sort(m_draws.begin(), m_draws.end(), [](const PendingDraw& a, const PendingDraw& b)
+    {
+        return a.m_meshBindGroup < b.m_meshBindGroup;
+    });
+    for (size_t draw = 0; draw < m_draws.size(); ++draw)
+    {
+        m_mappedDraws[draw] = m_draws[draw].m_draw;
+    }
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_Pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_PipelineLayout, 0
+                                , 1, &m_frameBindGroup
+                                , 0, nullptr);
+
+    PushConstants pushConstants{};
+    pushConstants.m_FrustumPlanes = ExtractFrustumPlanes(viewProjection);
+    pushConstants.m_ViewPosition = glm::vec4(viewPosition, 1.0f);
+    // one dispatch per mesh, one workgroup per draw
+    uint32_t dispatchCount = 0;
+    for (size_t firstDraw = 0; firstDraw < m_draws.size();)
+    {
+        const VkDescriptorSet meshBindGroup = m_draws[firstDraw].m_meshBindGroup;
+        size_t lastDraw = firstDraw + 1;
+        while (lastDraw < m_draws.size() && m_draws[lastDraw].m_meshBindGroup == meshBindGroup)
+        {
+            lastDraw++;
+        }
+
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_PipelineLayout, 1
+                                    , 1, &meshBindGroup
+                                    , 0, nullptr);
+        pushConstants.m_FirstDraw = static_cast<uint32_t>(firstDraw);
+        pushConstants.m_DrawCount = static_cast<uint32_t>(lastDraw - firstDraw);
+        vkCmdPushConstants(commandBuffer, m_PipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+        vkCmdDispatch(commandBuffer, pushConstants.m_DrawCount, 1, 1);
+        dispatchCount++;
+        firstDraw = lastDraw;
+    }
+    return dispatchCount;
+}
+
+MeshletCullingPipeline::Counters MeshletCullingPipeline::ReadCounters() const
+{
+    vmaInvalidateAllocation(RenderSys::Vulkan::GetMemoryAllocator(), m_counterBufferMemory, 0, VK_WHOLE_SIZE);
+    return *m_counters;
+}
+
+} // namespace Vulkan
+
+} // namespace RenderSys
@@ -0,0 +1,117 @@
+#pragma once
+#include <stdint.h>
+#include <array>
+#include <vector>
+#include <glm/ext.hpp>
+#include <vk_mem_alloc.h>
+#include <Walnut/GraphicsAPI/VulkanGraphics.h>
+#include <resources/Shaders/ShaderResource.h>
+
+namespace RenderSys
+{
+namespace Vulkan
+{
+
+// Culls the meshlets of indirect draws against the view frustum and by their normal cones (meshlet-cull-compute.glsl)
+// and copies the indices of the visible ones into the culled index buffer of the mesh, at the first index of the draw.
+// The GPU adds up the index count of each indirect command, which is then drawn from the culled index buffer, so it
+// needs neither mesh shaders nor any feature beyond compute and multi-draw indirect.
+// set 0 : the draws, transforms, indirect commands and counters of the frame
+// set 1 : per mesh bind group (meshlets, indices, culled indices)
+class MeshletCullingPipeline
+{
+
+public:
+    static constexpr uint32_t WORKGROUP_SIZE = MESHLET_CULL_WORKGROUP_SIZE;
+    static constexpr uint32_t MAX_TRANSFORMS = MAX_INDIRECT_DRAW_INSTANCES;
+
+    // one per culled indirect command, matches meshlet-cull-compute.glsl
+    struct MeshletDraw
+    {
+        uint32_t m_FirstMeshlet;
+        uint32_t m_MeshletCount;
+        uint32_t m_CommandIndex;
+        uint32_t m_FirstTransform;
+        uint32_t m_TransformCount;
+        uint32_t m_ConeCulling; // 0 when a transform mirrors or scales non-uniformly, the cones would not follow it
+        uint32_t m_Padding[2];
+    };
+
+    struct PushConstants
+    {
+        // world space, the normals point into the frustum
+        std::array<glm::vec4, 6> m_FrustumPlanes;
+        glm::vec4 m_ViewPosition;
+        uint32_t m_FirstDraw;
+        uint32_t m_DrawCount;
+    };
+
+    struct Counters
+    {
+        uint32_t m_Visible = 0;
+        uint32_t m_FrustumCulled = 0;
+        uint32_t m_ConeCulled = 0;
+        uint32_t m_Padding = 0;
+    };
+
+    MeshletCullingPipeline(const VkPipelineShaderStageCreateInfo& shaderStageInfo, VkBuffer indirectCommandBuffer);
+    ~MeshletCullingPipeline();
+
+    MeshletCullingPipeline(const MeshletCullingPipeline&) = delete;
+    MeshletCullingPipeline& operator=(const MeshletCullingPipeline&) = delete;
+    MeshletCullingPipeline(MeshletCullingPipeline&&) = delete;
+    MeshletCullingPipeline& operator=(MeshletCullingPipeline&&) = delete;
+
+    // the index buffer and the culled index buffer have the same size and need the storage usage
+    VkDescriptorSet CreateBindGroup(VkBuffer meshletBuffer, VkBuffer indexBuffer, VkBuffer culledIndexBuffer);
+
+    // the draws of the next Cull(), the indirect command has to be written with an index count of zero
+    void ResetDraws();
+    // the meshlets are visible when one of the transforms sees them, returns false when the draw or transform buffer is full
+    bool AddDraw(VkDescriptorSet meshBindGroup, const uint32_t commandIndex, const uint32_t firstMeshlet, const uint32_t meshletCount,
+                    const glm::mat4* transforms, const uint32_t transformCount);
+    uint32_t GetDrawCount() const { return static_cast<uint32_t>(m_draws.size()); }
+
+    // records the culling of the added draws, the indirect commands and culled indices can be read after a barrier.
+    // Returns the dispatch count
+    uint32_t Cull(VkCommandBuffer commandBuffer, const glm::mat4& viewProjection, const glm::vec3& viewPosition);
+    // counters of the last recorded Cull(), only valid once its command buffer has completed
+    Counters ReadCounters() const;
+
+private:
+    struct PendingDraw
+    {
+        VkDescriptorSet m_meshBindGroup;
+        MeshletDraw m_draw;
+    };
+
+    void CreateBindGroupLayouts();
+    void CreatePipeline();
+    void CreateBuffers(VkBuffer indirectCommandBuffer);
+
+    VkPipelineShaderStageCreateInfo m_shaderStageInfo;
+    VkDescriptorSetLayout m_frameBindGroupLayout = VK_NULL_HANDLE;
+    VkDescriptorSetLayout m_meshBindGroupLayout = VK_NULL_HANDLE;
+    VkDescriptorPool m_bindGroupPool = VK_NULL_HANDLE;
+    VkDescriptorSet m_frameBindGroup = VK_NULL_HANDLE;
+    VkPipelineLayout m_PipelineLayout = VK_NULL_HANDLE;
+    VkPipeline m_Pipeline = VK_NULL_HANDLE;
+
+    // both persistently mapped, written by Cull() and AddDraw()
+    VkBuffer m_drawBuffer = VK_NULL_HANDLE;
+    VmaAllocation m_drawBufferMemory = VK_NULL_HANDLE;
+    MeshletDraw* m_mappedDraws = nullptr;
+    VkBuffer m_transformBuffer = VK_NULL_HANDLE;
+    VmaAllocation m_transformBufferMemory = VK_NULL_HANDLE;
+    glm::mat4* m_transforms = nullptr;
+    uint32_t m_transformCount = 0;
+    VkBuffer m_counterBuffer = VK_NULL_HANDLE;
+    VmaAllocation m_counterBufferMemory = VK_NULL_HANDLE;
+    Counters* m_counters = nullptr;
+    // sorted by mesh in Cull(), every mesh is one dispatch
+    std::vector<PendingDraw> m_draws;
+};
+
+
+} // namespace Vulkan
+} // namespace RenderSys
@@ -1,4 +1,5 @@
 #include "VulkanPbrRenderPipeline.h"
+#include <RenderSys/Vulkan/VulkanDevice.h>
 
 #include <RenderSys/Material.h>
 #include <RenderSys/MaterialFeatures.h>
@@ -14,9 +15,10 @@ namespace Vulkan {
 PbrRenderPipeline::PbrRenderPipeline(VkRenderPass renderPass,
     std::vector<VkDescriptorSetLayout> &descriptorSetLayouts,
     const Vulkan::VertexInputLayout& vertexInputLayout, 
-    const std::vector<VkPipelineShaderStageCreateInfo>& shaderStageInfos) 
+    const std::vector<VkPipelineShaderStageCreateInfo>& shaderStageInfos,
+    const uint32_t pushConstantSize) 
 {
-    CreatePipelineLayout(descriptorSetLayouts);
+    CreatePipelineLayout(descriptorSetLayouts, pushConstantSize);
     CreatePipeline(renderPass, vertexInputLayout, shaderStageInfos);
 }
 
@@ -24,18 +26,18 @@ PbrRenderPipeline::~PbrRenderPipeline()
 {
     if (m_Pipeline)
     {
-        vkDestroyPipeline(GraphicsAPI::Vulkan::GetDevice(), m_Pipeline, nullptr);
+        vkDestroyPipeline(RenderSys::Vulkan::GetDevice(), m_Pipeline, nullptr);
         m_Pipeline = VK_NULL_HANDLE;
     }
 
     if (m_PipelineLayout)
     {
-        vkDestroyPipelineLayout(GraphicsAPI::Vulkan::GetDevice(), m_PipelineLayout, nullptr);
+        vkDestroyPipelineLayout(RenderSys::Vulkan::GetDevice(), m_PipelineLayout, nullptr);
         m_PipelineLayout = VK_NULL_HANDLE;
     }
 }
 
-void PbrRenderPipeline::CreatePipelineLayout(const std::vector<VkDescriptorSetLayout> &descriptorSetLayouts)
+void PbrRenderPipeline::CreatePipelineLayout(const std::vector<VkDescriptorSetLayout> &descriptorSetLayouts, const uint32_t pushConstantSize)
 {
     // VkPushConstantRange pushConstantRange0{};
     // pushConstantRange0.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
@@ -50,7 +52,7 @@ void PbrRenderPipeline::CreatePipelineLayout(const std::vector<VkDescriptorSetLa
     VkPushConstantRange pushConstantRange{};
     pushConstantRange.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
     pushConstantRange.offset = 0;
-    pushConstantRange.size = sizeof(RenderSys::MaterialProperties);
+    pushConstantRange.size = pushConstantSize; // MaterialProperties, or the material index with bindless materials
 
     std::array<VkPushConstantRange, 1> pushConstantRanges = {pushConstantRange}; //{pushConstantRange0, pushConstantRange1};
 
@@ -60,7 +62,7 @@ void PbrRenderPipeline::CreatePipelineLayout(const std::vector<VkDescriptorSetLa
     pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
     pipelineLayoutInfo.pushConstantRangeCount = pushConstantRanges.size();
     pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
-    auto result = vkCreatePipelineLayout(GraphicsAPI::Vulkan::GetDevice(), &pipelineLayoutInfo, nullptr, &m_PipelineLayout);
+    auto result = vkCreatePipelineLayout(RenderSys::Vulkan::GetDevice(), &pipelineLayoutInfo, nullptr, &m_PipelineLayout);
     if (result != VK_SUCCESS)
     {
         GraphicsAPI::Vulkan::check_vk_result(result);
@@ -157,7 +159,7 @@ void PbrRenderPipeline::CreatePipeline(VkRenderPass renderPass, const Vulkan::Ve
     pipelineCreateInfo.subpass = 0;
     pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-    if (vkCreateGraphicsPipelines(GraphicsAPI::Vulkan::GetDevice(), VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_Pipeline) != VK_SUCCESS) {
+    if (vkCreateGraphicsPipelines(RenderSys::Vulkan::GetDevice(), VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_Pipeline) != VK_SUCCESS) {
         std::cout << "error: could not create rendering pipeline" << std::endl;
     }
 
@@ -14,7 +14,8 @@ public:
     PbrRenderPipeline(VkRenderPass renderPass, 
                         std::vector<VkDescriptorSetLayout>& descriptorSetLayouts,
                         const Vulkan::VertexInputLayout& vertexInputLayout, 
-                        const std::vector<VkPipelineShaderStageCreateInfo>& shaderStageInfos);
+                        const std::vector<VkPipelineShaderStageCreateInfo>& shaderStageInfos,
+                        const uint32_t pushConstantSize);
     ~PbrRenderPipeline();
 
     PbrRenderPipeline(const PbrRenderPipeline&) = delete;
@@ -26,7 +27,7 @@ public:
     VkPipelineLayout GetPipelineLayout() const { return m_PipelineLayout; }
 
 private:
-    void CreatePipelineLayout(const std::vector<VkDescriptorSetLayout>& descriptorSetLayouts);
+    void CreatePipelineLayout(const std::vector<VkDescriptorSetLayout>& descriptorSetLayouts, const uint32_t pushConstantSize);
     void CreatePipeline(VkRenderPass renderPass, const Vulkan::VertexInputLayout &vertexInputLayout,
                         const std::vector<VkPipelineShaderStageCreateInfo> &shaderStageInfos);
 
@@ -1,4 +1,5 @@
 #include "VulkanShadowRenderPipeline.h"
+#include <RenderSys/Vulkan/VulkanDevice.h>
 
 #include <RenderSys/Vulkan/Pipeline/VulkanPipeline.h>
 #include <iostream>
@@ -23,13 +24,13 @@ ShadowRenderPipeline::~ShadowRenderPipeline()
 {
     if (m_Pipeline)
     {
-        vkDestroyPipeline(GraphicsAPI::Vulkan::GetDevice(), m_Pipeline, nullptr);
+        vkDestroyPipeline(RenderSys::Vulkan::GetDevice(), m_Pipeline, nullptr);
         m_Pipeline = VK_NULL_HANDLE;
     }
 
     if (m_PipelineLayout)
     {
-        vkDestroyPipelineLayout(GraphicsAPI::Vulkan::GetDevice(), m_PipelineLayout, nullptr);
+        vkDestroyPipelineLayout(RenderSys::Vulkan::GetDevice(), m_PipelineLayout, nullptr);
         m_PipelineLayout = VK_NULL_HANDLE;
     }
 
@@ -37,7 +38,7 @@ ShadowRenderPipeline::~ShadowRenderPipeline()
     {
         if (shaderStageInfo.module != VK_NULL_HANDLE)
         {
-            vkDestroyShaderModule(GraphicsAPI::Vulkan::GetDevice(), shaderStageInfo.module, nullptr);
+            vkDestroyShaderModule(RenderSys::Vulkan::GetDevice(), shaderStageInfo.module, nullptr);
             shaderStageInfo.module = VK_NULL_HANDLE;
         }
     }
@@ -49,7 +50,13 @@ void ShadowRenderPipeline::CreatePipelineLayout(const std::vector<VkDescriptorSe
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
     pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
-    auto result = vkCreatePipelineLayout(GraphicsAPI::Vulkan::GetDevice(), &pipelineLayoutInfo, nullptr, &m_PipelineLayout);
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(PushConstants);
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    auto result = vkCreatePipelineLayout(RenderSys::Vulkan::GetDevice(), &pipelineLayoutInfo, nullptr, &m_PipelineLayout);
     if (result != VK_SUCCESS)
     {
         GraphicsAPI::Vulkan::check_vk_result(result);
@@ -149,7 +156,7 @@ void ShadowRenderPipeline::CreatePipeline(VkRenderPass renderPass, const Vulkan:
     pipelineCreateInfo.subpass = 0;
     pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-    if (vkCreateGraphicsPipelines(GraphicsAPI::Vulkan::GetDevice(), VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_Pipeline) != VK_SUCCESS) {
+    if (vkCreateGraphicsPipelines(RenderSys::Vulkan::GetDevice(), VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_Pipeline) != VK_SUCCESS) {
         std::cout << "error: could not create rendering pipeline" << std::endl;
     }
 
@@ -1,4 +1,5 @@
 #pragma once
+#include <glm/ext.hpp>
 #include <Walnut/GraphicsAPI/VulkanGraphics.h>
 #include <RenderSys/Vulkan/VulkanVertex.h>
 
@@ -11,6 +12,12 @@ class ShadowRenderPipeline
 {
 
 public:
+    // matches shadow-vertex.glsl, pushed once per cascade
+    struct PushConstants
+    {
+        glm::mat4 m_LightViewProjection;
+    };
+
     ShadowRenderPipeline(VkRenderPass renderPass, 
                         std::vector<VkDescriptorSetLayout>& descriptorSetLayouts,
                         const Vulkan::VertexInputLayout& vertexInputLayout, 
@@ -0,0 +1,185 @@
+#include "VulkanSkinningComputePipeline.h"
+#include <RenderSys/Vulkan/VulkanDevice.h>
+
+#include <array>
+#include <iostream>
+#include <stdexcept>
+
+namespace RenderSys {
+
+namespace Vulkan {
+
+namespace
+{
+constexpr uint32_t numOfSkinnedMeshesPerPool = 64;
+constexpr uint32_t numOfSkinningBindings = 3;
+}
+
+SkinningComputePipeline::SkinningComputePipeline(VkDescriptorSetLayout resourceBindGroupLayout, 
+                                                const VkPipelineShaderStageCreateInfo& shaderStageInfo)
+    : m_shaderStageInfo(shaderStageInfo)
+{
+    assert(m_shaderStageInfo.stage == VK_SHADER_STAGE_COMPUTE_BIT);
+    CreateBindGroupLayout();
+    CreatePipelineLayout(resourceBindGroupLayout);
+    CreatePipeline();
+}
+
+SkinningComputePipeline::~SkinningComputePipeline()
+{
+    if (m_Pipeline)
+    {
+        vkDestroyPipeline(RenderSys::Vulkan::GetDevice(), m_Pipeline, nullptr);
+        m_Pipeline = VK_NULL_HANDLE;
+    }
+
+    if (m_PipelineLayout)
+    {
+        vkDestroyPipelineLayout(RenderSys::Vulkan::GetDevice(), m_PipelineLayout, nullptr);
+        m_PipelineLayout = VK_NULL_HANDLE;
+    }
+
+    if (!m_bindGroupPools.empty())
+    {
+        vkDeviceWaitIdle(RenderSys::Vulkan::GetDevice());
+        // when you destroy a descriptor pool, all descriptor sets allocated from that pool are automatically destroyed
+        for (VkDescriptorPool bindGroupPool : m_bindGroupPools)
+        {
+            vkDestroyDescriptorPool(RenderSys::Vulkan::GetDevice(), bindGroupPool, nullptr);
+        }
+        m_bindGroupPools.clear();
+    }
+
+    if (m_bindGroupLayout)
+    {
+        vkDestroyDescriptorSetLayout(RenderSys::Vulkan::GetDevice(), m_bindGroupLayout, nullptr);
+        m_bindGroupLayout = VK_NULL_HANDLE;
+    }
+
+    if (m_shaderStageInfo.module != VK_NULL_HANDLE)
+    {
+        vkDestroyShaderModule(RenderSys::Vulkan::GetDevice(), m_shaderStageInfo.module, nullptr);
+        m_shaderStageInfo.module = VK_NULL_HANDLE;
+    }
+}
+
+void SkinningComputePipeline::CreateBindGroupLayout()
+{
+    std::array<VkDescriptorSetLayoutBinding, numOfSkinningBindings> bindings
+    {
+        VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr}, // bind pose vertices
+        VkDescriptorSetLayoutBinding{1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr}, // joints and weights
+        VkDescriptorSetLayoutBinding{2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr}  // skinned vertices
+    };
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = bindings.size();
+    layoutInfo.pBindings = bindings.data();
+    if (vkCreateDescriptorSetLayout(RenderSys::Vulkan::GetDevice(), &layoutInfo, nullptr, &m_bindGroupLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor set layout!");
+    }
+    CreateBindGroupPool();
+}
+
+void SkinningComputePipeline::CreateBindGroupPool()
+{
+    VkDescriptorPoolSize poolSize{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, numOfSkinningBindings * numOfSkinnedMeshesPerPool};
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = numOfSkinnedMeshesPerPool;
+    VkDescriptorPool bindGroupPool = VK_NULL_HANDLE;
+    if (vkCreateDescriptorPool(RenderSys::Vulkan::GetDevice(), &poolInfo, nullptr, &bindGroupPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor pool!");
+    }
+    m_bindGroupPools.push_back(bindGroupPool);
+}
+
+void SkinningComputePipeline::CreatePipelineLayout(VkDescriptorSetLayout resourceBindGroupLayout)
+{
+    std::array<VkDescriptorSetLayout, 2> descriptorSetLayouts{m_bindGroupLayout, resourceBindGroupLayout};
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(PushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    auto result = vkCreatePipelineLayout(RenderSys::Vulkan::GetDevice(), &pipelineLayoutInfo, nullptr, &m_PipelineLayout);
+    if (result != VK_SUCCESS)
+    {
+        GraphicsAPI::Vulkan::check_vk_result(result);
+    }
+}
+
+void SkinningComputePipeline::CreatePipeline()
+{
+    assert(m_PipelineLayout != VK_NULL_HANDLE);
+
+    std::cout << "Creating skinning pipeline..." << std::endl;
+    VkComputePipelineCreateInfo pipelineCreateInfo{};
+    pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineCreateInfo.stage = m_shaderStageInfo;
+    pipelineCreateInfo.layout = m_PipelineLayout;
+
+    if (vkCreateComputePipelines(RenderSys::Vulkan::GetDevice(), VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_Pipeline) != VK_SUCCESS) {
+        std::cout << "error: could not create skinning pipeline" << std::endl;
+    }
+
+    assert(m_Pipeline != VK_NULL_HANDLE);
+    std::cout << "Skinning pipeline: " << m_Pipeline << std::endl;
+}
+
+VkDescriptorSet SkinningComputePipeline::CreateBindGroup(VkBuffer bindPoseVertexBuffer, VkBuffer skinningDataBuffer, VkBuffer skinnedVertexBuffer)
+{
+    VkDescriptorSet bindGroup = VK_NULL_HANDLE;
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_bindGroupPools.back();
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &m_bindGroupLayout;
+    VkResult result = vkAllocateDescriptorSets(RenderSys::Vulkan::GetDevice(), &allocInfo, &bindGroup);
+    if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL)
+    {
+        // the last pool is full, the scene has more skinned meshes than one pool holds
+        CreateBindGroupPool();
+        allocInfo.descriptorPool = m_bindGroupPools.back();
+        result = vkAllocateDescriptorSets(RenderSys::Vulkan::GetDevice(), &allocInfo, &bindGroup);
+    }
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate descriptor sets!");
+    }
+
+    std::array<VkDescriptorBufferInfo, numOfSkinningBindings> bufferInfos
+    {
+        VkDescriptorBufferInfo{bindPoseVertexBuffer, 0, VK_WHOLE_SIZE},
+        VkDescriptorBufferInfo{skinningDataBuffer, 0, VK_WHOLE_SIZE},
+        VkDescriptorBufferInfo{skinnedVertexBuffer, 0, VK_WHOLE_SIZE}
+    };
+
+    std::array<VkWriteDescriptorSet, numOfSkinningBindings> writes{};
+    for (uint32_t binding = 0; binding < numOfSkinningBindings; binding++)
+    {
+        writes[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[binding].dstSet = bindGroup;
+        writes[binding].dstBinding = binding;
+        writes[binding].dstArrayElement = 0;
+        writes[binding].descriptorCount = 1;
+        writes[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[binding].pBufferInfo = &bufferInfos[binding];
+    }
+
+    vkUpdateDescriptorSets(RenderSys::Vulkan::GetDevice(), writes.size(), writes.data(), 0, nullptr);
+    return bindGroup;
+}
+
+} // namespace Vulkan
+
+} // namespace RenderSys
@@ -0,0 +1,55 @@
+#pragma once
+#include <vector>
+#include <Walnut/GraphicsAPI/VulkanGraphics.h>
+#include <resources/Shaders/ShaderResource.h>
+
+namespace RenderSys
+{
+namespace Vulkan 
+{
+
+// Compute pipeline that skins a bind pose vertex buffer into a vertex buffer used by every render pass.
+// set 0 : per mesh bind group (bind pose vertices, joints and weights, skinned vertices)
+// set 1 : the resource bind group, joint palette (matrices or dual quaternions) at Resource::SKELETAL_ANIMATION_BUFFER_INDEX
+class SkinningComputePipeline
+{
+
+public:
+    static constexpr uint32_t WORKGROUP_SIZE = SKINNING_WORKGROUP_SIZE;
+
+    struct PushConstants
+    {
+        uint32_t m_VertexCount;
+        uint32_t m_SkinningMethod; // RenderSys::SkinningMethod of the skeleton
+    };
+
+    SkinningComputePipeline(VkDescriptorSetLayout resourceBindGroupLayout, 
+                            const VkPipelineShaderStageCreateInfo& shaderStageInfo);
+    ~SkinningComputePipeline();
+
+    SkinningComputePipeline(const SkinningComputePipeline&) = delete;
+    SkinningComputePipeline& operator=(const SkinningComputePipeline&) = delete;
+    SkinningComputePipeline(SkinningComputePipeline&&) = delete;
+    SkinningComputePipeline& operator=(SkinningComputePipeline&&) = delete;
+
+    VkDescriptorSet CreateBindGroup(VkBuffer bindPoseVertexBuffer, VkBuffer skinningDataBuffer, VkBuffer skinnedVertexBuffer);
+    VkPipeline GetPipeline() const { return m_Pipeline; }
+    VkPipelineLayout GetPipelineLayout() const { return m_PipelineLayout; }
+
+private:
+    void CreateBindGroupLayout();
+    void CreateBindGroupPool();
+    void CreatePipelineLayout(VkDescriptorSetLayout resourceBindGroupLayout);
+    void CreatePipeline();
+
+    VkPipelineShaderStageCreateInfo m_shaderStageInfo;
+    VkDescriptorSetLayout m_bindGroupLayout = VK_NULL_HANDLE;
+    // a new pool is added whenever the last one is full, the bind groups live as long as the pipeline
+    std::vector<VkDescriptorPool> m_bindGroupPools;
+    VkPipelineLayout m_PipelineLayout = VK_NULL_HANDLE;
+    VkPipeline m_Pipeline = VK_NULL_HANDLE;
+};
+
+
+} // namespace Vulkan
+} // namespace RenderSys
@@ -19,7 +19,8 @@ VulkanBuffer::VulkanBuffer(size_t byteSize, RenderSys::BufferUsage bufferUsage)
     } 
     else if (bufferUsage == RenderSys::BufferUsage::STORAGE_BUFFER_VISIBLE_TO_CPU) 
     {
-        bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+        // or filled by a copy in the command buffer, e.g. JointMatricesBuffer
+        bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
         allocInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
     } 
     else if (bufferUsage == RenderSys::BufferUsage::TRANSFER_SRC_VISIBLE_TO_GPU) 
@@ -1,7 +1,9 @@
 #include "VulkanCompute.h"
+#include "VulkanDevice.h"
 
 #include "VulkanRendererUtils.h"
 #include "VulkanMemAlloc.h"
+#include "VulkanQueryProfiler.h"
 
 namespace GraphicsAPI
 {
@@ -9,21 +11,22 @@ namespace GraphicsAPI
 VulkanCompute::VulkanCompute()
 {
     VkPhysicalDeviceProperties deviceProperties;
-    vkGetPhysicalDeviceProperties(Vulkan::GetPhysicalDevice(), &deviceProperties);
+    vkGetPhysicalDeviceProperties(RenderSys::Vulkan::GetPhysicalDevice(), &deviceProperties);
     VkPhysicalDeviceLimits deviceLimits = deviceProperties.limits;
 	std::cout << "Max Compute Shared Memory Size: " << deviceLimits.maxComputeSharedMemorySize / 1024 << " KB" << std::endl;
-    std::cout << "Compute Queue Family Index: " << Vulkan::GetQueueFamilyIndex() << std::endl;
+    std::cout << "Compute Queue Family Index: " << RenderSys::Vulkan::GetQueueFamilyIndex() << std::endl;
 
     if (!m_vma)
     {
         VmaAllocatorCreateInfo allocatorInfo{};
-        allocatorInfo.physicalDevice = Vulkan::GetPhysicalDevice();
-        allocatorInfo.device = Vulkan::GetDevice();
-        allocatorInfo.instance = Vulkan::GetInstance();
+        allocatorInfo.physicalDevice = RenderSys::Vulkan::GetPhysicalDevice();
+        allocatorInfo.device = RenderSys::Vulkan::GetDevice();
+        allocatorInfo.instance = RenderSys::Vulkan::GetInstance();
         if (vmaCreateAllocator(&allocatorInfo, &m_vma) != VK_SUCCESS) {
             std::cout << "error: could not init VMA" << std::endl;
         }
     }
+    m_profiler = std::make_unique<RenderSys::Vulkan::QueryProfiler>("Compute");
 }
 
 VulkanCompute::~VulkanCompute()
@@ -31,7 +34,7 @@ VulkanCompute::~VulkanCompute()
     // Destroy Shaders
     for (auto& shaderStageInfo : m_shaderStageInfos)
     {
-        vkDestroyShaderModule(Vulkan::GetDevice(), shaderStageInfo.module, nullptr);
+        vkDestroyShaderModule(RenderSys::Vulkan::GetDevice(), shaderStageInfo.module, nullptr);
     }
 
     m_shaderStageInfos.clear();
@@ -39,45 +42,56 @@ VulkanCompute::~VulkanCompute()
     // Destroy Bind Group
     if (m_bindGroup && m_bindGroupPool)
     {
-        vkDeviceWaitIdle(Vulkan::GetDevice());
+        vkDeviceWaitIdle(RenderSys::Vulkan::GetDevice());
         // when you destroy a descriptor pool, all descriptor sets allocated from that pool are automatically destroyed
-        vkDestroyDescriptorPool(Vulkan::GetDevice(), m_bindGroupPool, nullptr);
+        vkDestroyDescriptorPool(RenderSys::Vulkan::GetDevice(), m_bindGroupPool, nullptr);
         m_bindGroup = VK_NULL_HANDLE;
         m_bindGroupPool = VK_NULL_HANDLE;
     }
 
     if (m_bindGroupLayout)
     {
-        vkDestroyDescriptorSetLayout(Vulkan::GetDevice(), m_bindGroupLayout, nullptr);
+        vkDestroyDescriptorSetLayout(RenderSys::Vulkan::GetDevice(), m_bindGroupLayout, nullptr);
         m_bindGroupLayout = VK_NULL_HANDLE;
     }
 
     m_bindGroupBindings.clear();
 
-    // Destroy Pipeline
-    if (m_pipeline)
+    // Destroy Pipelines
+    WaitForAllSubmissions();
+    m_profiler.reset();
+    for (VkPipeline pipeline : m_pipelines)
     {
-        vkDestroyPipeline(Vulkan::GetDevice(), m_pipeline, nullptr);
-        m_pipeline = VK_NULL_HANDLE;
+        vkDestroyPipeline(RenderSys::Vulkan::GetDevice(), pipeline, nullptr);
     }
+    m_pipelines.clear();
 
     if (m_pipelineLayout)
     {
-        vkDestroyPipelineLayout(Vulkan::GetDevice(), m_pipelineLayout, nullptr);
+        vkDestroyPipelineLayout(RenderSys::Vulkan::GetDevice(), m_pipelineLayout, nullptr);
         m_pipelineLayout = VK_NULL_HANDLE;
     }
 
     Destroy();
 
-    if (m_commandBuffer && m_commandPool)
+    if (m_commandPool)
     {
-        vkDeviceWaitIdle(Vulkan::GetDevice());
+        vkDeviceWaitIdle(RenderSys::Vulkan::GetDevice());
         // when you destroy a command pool, all command buffers allocated from that pool are automatically destroyed
-        vkDestroyCommandPool(Vulkan::GetDevice(), m_commandPool, nullptr);
-        m_commandBuffer = VK_NULL_HANDLE;
+        vkDestroyCommandPool(RenderSys::Vulkan::GetDevice(), m_commandPool, nullptr);
         m_commandPool = VK_NULL_HANDLE;
     }   
 
+    for (ComputeSubmission& submission : m_submissions)
+    {
+        submission.commandBuffer = VK_NULL_HANDLE;
+        if (submission.fence)
+        {
+            vkDestroyFence(RenderSys::Vulkan::GetDevice(), submission.fence, nullptr);
+            submission.fence = VK_NULL_HANDLE;
+        }
+    }
+
     // Destroy VMA instance
     vmaDestroyAllocator(m_vma);
 }
@@ -117,7 +131,7 @@ void VulkanCompute::CreateBindGroup(const std::vector<RenderSys::BindGroupLayout
         layoutInfo.bindingCount = m_bindGroupBindings.size();
         layoutInfo.pBindings = m_bindGroupBindings.data();
     
-        if (vkCreateDescriptorSetLayout(Vulkan::GetDevice(), &layoutInfo, nullptr, &m_bindGroupLayout) != VK_SUCCESS) {
+        if (vkCreateDescriptorSetLayout(RenderSys::Vulkan::GetDevice(), &layoutInfo, nullptr, &m_bindGroupLayout) != VK_SUCCESS) {
             throw std::runtime_error("failed to create descriptor set layout!");
         }
     }
@@ -136,7 +150,7 @@ void VulkanCompute::CreateBindGroup(const std::vector<RenderSys::BindGroupLayout
         poolInfo.pPoolSizes = poolSizes.data();
         poolInfo.maxSets = 1;
     
-        if (vkCreateDescriptorPool(Vulkan::GetDevice(), &poolInfo, nullptr, &m_bindGroupPool) != VK_SUCCESS) {
+        if (vkCreateDescriptorPool(RenderSys::Vulkan::GetDevice(), &poolInfo, nullptr, &m_bindGroupPool) != VK_SUCCESS) {
             throw std::runtime_error("failed to create descriptor pool!");
         }
     }
@@ -149,7 +163,7 @@ void VulkanCompute::CreateBindGroup(const std::vector<RenderSys::BindGroupLayout
         allocInfo.descriptorSetCount = 1;
         allocInfo.pSetLayouts = &m_bindGroupLayout;
     
-        if (vkAllocateDescriptorSets(Vulkan::GetDevice(), &allocInfo, &m_bindGroup) != VK_SUCCESS) {
+        if (vkAllocateDescriptorSets(RenderSys::Vulkan::GetDevice(), &allocInfo, &m_bindGroup) != VK_SUCCESS) {
             throw std::runtime_error("failed to allocate descriptor sets!");
         }
     }
@@ -179,7 +193,7 @@ void VulkanCompute::CreateShaders(RenderSys::Shader &shader)
     shaderCreateInfo.pCode = compiledShader.data();
 
     VkShaderModule shaderModule = 0;
-    if (vkCreateShaderModule(Vulkan::GetDevice(), &shaderCreateInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+    if (vkCreateShaderModule(RenderSys::Vulkan::GetDevice(), &shaderCreateInfo, nullptr, &shaderModule) != VK_SUCCESS) {
         std::cout << "could not load shader" << std::endl;
         return;
     }
@@ -212,28 +226,41 @@ void VulkanCompute::CreatePipeline()
         assert(m_bindGroupLayout != VK_NULL_HANDLE);
         pipelineLayoutCreateInfo.setLayoutCount = 1;
         pipelineLayoutCreateInfo.pSetLayouts = &m_bindGroupLayout;
-        pipelineLayoutCreateInfo.pushConstantRangeCount = 0;
-
-        if (vkCreatePipelineLayout(Vulkan::GetDevice(), &pipelineLayoutCreateInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
+        // kernels without push constants are compatible with the range
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = RenderSys::Compute::MAX_PUSH_CONSTANT_SIZE;
+        pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+        pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+
+        if (vkCreatePipelineLayout(RenderSys::Vulkan::GetDevice(), &pipelineLayoutCreateInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
             std::cout << "error: could not create pipeline layout" << std::endl;
         }        
     }
 
-    VkComputePipelineCreateInfo pipelineInfo{};
-    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
-    pipelineInfo.layout = m_pipelineLayout;
-    assert(m_shaderStageInfos.size() == 1);
-    pipelineInfo.stage = m_shaderStageInfos[0];
+    // the kernels added since the last call
+    assert(m_shaderStageInfos.size() > m_pipelines.size());
+    for (size_t kernel = m_pipelines.size(); kernel < m_shaderStageInfos.size(); kernel++)
+    {
+        VkComputePipelineCreateInfo pipelineInfo{};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.layout = m_pipelineLayout;
+        pipelineInfo.stage = m_shaderStageInfos[kernel];
+
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        if (vkCreateComputePipelines(RenderSys::Vulkan::GetDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create compute pipeline!");
+        }
+        m_pipelines.push_back(pipeline);
 
-    if (vkCreateComputePipelines(Vulkan::GetDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipeline) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create compute pipeline!");
+        std::cout << "Compute pipeline " << kernel << ": " << pipeline << std::endl;
     }
-
-    std::cout << "Compute pipeline: " << m_pipeline << std::endl;
 }
 
 void VulkanCompute::CreateBuffer(uint32_t binding, uint32_t bufferLength, RenderSys::ComputeBuf::BufferType type)
 {
+    m_bindGroupDirty = true;
     switch (type)
     {
         case RenderSys::ComputeBuf::BufferType::Input:
@@ -246,7 +273,7 @@ void VulkanCompute::CreateBuffer(uint32_t binding, uint32_t bufferLength, Render
             inputBufferDesc.size = bufferLength;
             inputBufferDesc.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
             inputBufferDesc.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
-            auto queueFamilyIndex = Vulkan::GetQueueFamilyIndex();
+            auto queueFamilyIndex = RenderSys::Vulkan::GetQueueFamilyIndex();
             inputBufferDesc.queueFamilyIndexCount = 1;
             inputBufferDesc.pQueueFamilyIndices = &queueFamilyIndex;
 
@@ -353,20 +380,56 @@ void VulkanCompute::CreateBuffer(uint32_t binding, uint32_t bufferLength, Render
                 << ", size=" << Iter->second.bufferInfo.range << std::endl;
             break;
         }
+        case RenderSys::ComputeBuf::BufferType::Storage:
+        {
+            VkBufferCreateInfo storageBufferDesc{};
+            storageBufferDesc.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            storageBufferDesc.size = bufferLength;
+            std::cout << "Creating storage buffer..." << std::endl;
+            storageBufferDesc.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            storageBufferDesc.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+            VmaAllocationCreateInfo vmaAllocInfo{};
+            vmaAllocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VmaAllocation bufferMemory = VK_NULL_HANDLE;
+            auto res = vmaCreateBuffer(m_vma, &storageBufferDesc, &vmaAllocInfo, &buffer, &bufferMemory, nullptr);
+            if (res != VK_SUCCESS) {
+                std::cout << "vkCreateBuffer() failed!" << std::endl;
+                return;
+            }
+
+            CreateCommandPool();
+            auto commandBuffer = RenderSys::Vulkan::BeginSingleTimeCommands(m_commandPool);
+            vkCmdFillBuffer(commandBuffer, buffer, 0, VK_WHOLE_SIZE, 0);
+            RenderSys::Vulkan::EndSingleTimeCommands(commandBuffer, m_commandPool);
+
+            auto [Iter, inserted] = m_buffersAccessibleToShader.insert({binding, VulkanComputeBuffer{}});
+            assert(inserted == true);
+            Iter->second.bufferInfo = VkDescriptorBufferInfo{buffer, 0, bufferLength};
+            Iter->second.bufferMemory = bufferMemory;
+            Iter->second.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            std::cout << "storage buffer: " << Iter->second.bufferInfo.buffer
+                << ", size=" << Iter->second.bufferInfo.range << std::endl;
+            break;
+        }
     }
 }
 
-void VulkanCompute::SetBufferData(uint32_t binding, const void *bufferData, uint32_t bufferLength)
+void VulkanCompute::SetBufferData(uint32_t binding, const void *bufferData, uint32_t bufferLength, uint32_t offset)
 {
     auto it = m_buffersAccessibleToShader.find(binding);
     assert(it != m_buffersAccessibleToShader.end());
     const VkDescriptorBufferInfo& bufferInfo = it->second.bufferInfo;
+    assert(offset + bufferLength <= bufferInfo.range);
     const VmaAllocation& bufferAlloc = it->second.bufferMemory;
     void *buf;
     auto res = vmaMapMemory(m_vma, bufferAlloc, &buf);
     if (res == VK_SUCCESS) 
     {
-        memcpy(buf, bufferData, bufferLength);
+        memcpy(static_cast<uint8_t*>(buf) + offset, bufferData, bufferLength);
+        // CPU_TO_GPU memory is not necessarily coherent
+        vmaFlushAllocation(m_vma, bufferAlloc, offset, bufferLength);
         vmaUnmapMemory(m_vma, bufferAlloc);
     }
     else
@@ -375,44 +438,94 @@ void VulkanCompute::SetBufferData(uint32_t binding, const void *bufferData, uint
     }
 }
 
-void VulkanCompute::BeginComputePass()
+void VulkanCompute::CreateCommandPool()
 {
-    // TODO: move commandpool/commandbuffer creation to constructor
     if (!m_commandPool)
     {
-        auto queueFamilyIndices = Vulkan::FindQueueFamilies();
         VkCommandPoolCreateInfo poolInfo{};
         poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
         poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-        poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
-        auto err = vkCreateCommandPool(Vulkan::GetDevice(), &poolInfo, nullptr, &m_commandPool);
+        poolInfo.queueFamilyIndex = RenderSys::Vulkan::GetQueueFamilyIndex();
+        auto err = vkCreateCommandPool(RenderSys::Vulkan::GetDevice(), &poolInfo, nullptr, &m_commandPool);
         Vulkan::check_vk_result(err);
     }
-    
-    if (!m_commandBuffer)
+}
+
+void VulkanCompute::WaitForSubmission(ComputeSubmission& submission)
+{
+    if (submission.submitted)
+    {
+        auto err = vkWaitForFences(RenderSys::Vulkan::GetDevice(), 1, &submission.fence, VK_TRUE, UINT64_MAX);
+        Vulkan::check_vk_result(err);
+        submission.submitted = false;
+    }
+}
+
+void VulkanCompute::WaitForAllSubmissions()
+{
+    for (ComputeSubmission& submission : m_submissions)
+    {
+        WaitForSubmission(submission);
+    }
+}
+
+VulkanCompute::ComputeSubmission* VulkanCompute::FindSubmission(uint64_t ticket)
+{
+    if (ticket == 0)
+    {
+        return nullptr;
+    }
+    for (ComputeSubmission& submission : m_submissions)
+    {
+        if (submission.ticket == ticket)
+        {
+            return &submission;
+        }
+    }
+    return nullptr;
+}
+
+void VulkanCompute::BeginComputePass()
+{
+    CreateCommandPool();
+
+    // the oldest submission, it may still be running while the newer ones are
+    m_currentSubmission = (m_currentSubmission + 1) % m_submissions.size();
+    ComputeSubmission& submission = m_submissions[m_currentSubmission];
+    if (!submission.commandBuffer)
     {
         VkCommandBufferAllocateInfo cmdBufAllocateInfo{};
         cmdBufAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
         cmdBufAllocateInfo.commandPool = m_commandPool;
         cmdBufAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
         cmdBufAllocateInfo.commandBufferCount = 1;
-        auto err = vkAllocateCommandBuffers(Vulkan::GetDevice(), &cmdBufAllocateInfo, &m_commandBuffer);
+        auto err = vkAllocateCommandBuffers(RenderSys::Vulkan::GetDevice(), &cmdBufAllocateInfo, &submission.commandBuffer);
         Vulkan::check_vk_result(err);
     }
     else
     {
-        auto err = vkResetCommandBuffer(m_commandBuffer, 0);
+        WaitForSubmission(submission);
+        auto err = vkResetCommandBuffer(submission.commandBuffer, 0);
         Vulkan::check_vk_result(err);
     }
+    // its readbacks are gone from now on
+    submission.ticket = 0;
+    submission.readbackCount = 0;
 
     VkCommandBufferBeginInfo begin_info{};
     begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     begin_info.flags |= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-    auto err = vkBeginCommandBuffer(m_commandBuffer, &begin_info);
+    auto err = vkBeginCommandBuffer(submission.commandBuffer, &begin_info);
     Vulkan::check_vk_result(err);
+    m_dispatchCount = 0;
+    // the pass QueryProfiler::FRAME_LATENCY passes before has completed, its timestamps are read without waiting
+    static_assert(RenderSys::Vulkan::QueryProfiler::FRAME_LATENCY > RenderSys::Compute::MAX_PASSES_IN_FLIGHT,
+                  "the queries of a pass are reset before the pass has completed");
+    m_profiler->BeginFrame(submission.commandBuffer);
+    BeginProfileScope("Compute pass");
 }
 
-void VulkanCompute::Compute(const uint32_t workgroupCountX, const uint32_t workgroupCountY)
+void VulkanCompute::WriteBindGroup()
 {
     std::vector<VkWriteDescriptorSet> descriptorWrites;
     for (auto& [binding, computeBuffer] : m_buffersAccessibleToShader)
@@ -439,24 +552,195 @@ void VulkanCompute::Compute(const uint32_t workgroupCountX, const uint32_t workg
         descriptorWrite.pBufferInfo = &mappedBufferPair->gpuBuffer.bufferInfo;
         descriptorWrites.push_back(descriptorWrite);
     }
-    vkUpdateDescriptorSets(Vulkan::GetDevice(), descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
+    vkUpdateDescriptorSets(RenderSys::Vulkan::GetDevice(), descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
+    m_bindGroupDirty = false;
+}
 
-    vkCmdBindPipeline(m_commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline);
+void VulkanCompute::Compute(const uint32_t workgroupCountX, const uint32_t workgroupCountY)
+{
+    Compute(0, workgroupCountX, workgroupCountY, 1, nullptr, 0, true);
+}
+
+void VulkanCompute::Compute(const uint32_t kernel, const uint32_t workgroupCountX, const uint32_t workgroupCountY, const uint32_t workgroupCountZ,
+                            const void* pushConstants, const uint32_t pushConstantSize, const bool barrier)
+{
+    assert(kernel < m_pipelines.size());
     assert(m_bindGroup != VK_NULL_HANDLE);
-    vkCmdBindDescriptorSets(m_commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, 1, &m_bindGroup, 0, nullptr);
-    vkCmdDispatch(m_commandBuffer, workgroupCountX, workgroupCountY, 1);
+    VkCommandBuffer commandBuffer = m_submissions[m_currentSubmission].commandBuffer;
+    if (m_bindGroupDirty)
+    {
+        // a descriptor set must not change once it is bound, the first dispatch of a pass binds it
+        // and the passes in flight must be done with it
+        assert(m_dispatchCount == 0);
+        WaitForAllSubmissions();
+        WriteBindGroup();
+    }
+
+    if (barrier)
+    {
+        // in submission order, so it also covers the passes submitted before
+        VkMemoryBarrier memoryBarrier{};
+        memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+    }
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelines[kernel]);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, 1, &m_bindGroup, 0, nullptr);
+    if (pushConstantSize > 0)
+    {
+        vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, pushConstantSize, pushConstants);
+    }
+    vkCmdDispatch(commandBuffer, workgroupCountX, workgroupCountY, workgroupCountZ);
+    m_dispatchCount++;
 }
 
-void VulkanCompute::EndComputePass()
+uint32_t VulkanCompute::RequestReadback(uint32_t binding, uint32_t offset, uint32_t size)
+{
+    auto it = m_buffersAccessibleToShader.find(binding);
+    assert(it != m_buffersAccessibleToShader.end());
+    assert(offset + size <= it->second.bufferInfo.range);
+
+    ComputeSubmission& submission = m_submissions[m_currentSubmission];
+    const uint32_t readback = submission.readbackCount++;
+    if (readback == submission.readbacks.size())
+    {
+        submission.readbacks.emplace_back();
+    }
+    StagingReadback& staging = submission.readbacks[readback];
+    if (staging.buffer.bufferInfo.range < size)
+    {
+        // grows only, the staging buffers of a submission are reused by every pass that runs in it
+        if (staging.buffer.bufferInfo.buffer)
+        {
+            vmaUnmapMemory(m_vma, staging.buffer.bufferMemory);
+            vmaDestroyBuffer(m_vma, staging.buffer.bufferInfo.buffer, staging.buffer.bufferMemory);
+            staging = StagingReadback{};
+        }
+
+        VkBufferCreateInfo stagingBufferDesc{};
+        stagingBufferDesc.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        stagingBufferDesc.size = size;
+        stagingBufferDesc.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        stagingBufferDesc.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        VmaAllocationCreateInfo vmaAllocInfo{};
+        vmaAllocInfo.usage = VMA_MEMORY_USAGE_GPU_TO_CPU;
+        if (vmaCreateBuffer(m_vma, &stagingBufferDesc, &vmaAllocInfo, &staging.buffer.bufferInfo.buffer, &staging.buffer.bufferMemory, nullptr) != VK_SUCCESS
+            || vmaMapMemory(m_vma, staging.buffer.bufferMemory, &staging.mapped) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create readback buffer!");
+        }
+        staging.buffer.bufferInfo.range = size;
+    }
+    staging.binding = binding;
+    staging.offset = offset;
+    staging.size = size;
+    return readback;
+}
+
+uint64_t VulkanCompute::Submit()
 {
-    auto err = vkEndCommandBuffer(m_commandBuffer);
+    ComputeSubmission& submission = m_submissions[m_currentSubmission];
+    if (submission.readbackCount > 0)
+    {
+        BeginProfileScope("Readbacks");
+        VkMemoryBarrier memoryBarrier{};
+        memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        memoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        vkCmdPipelineBarrier(submission.commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+        for (uint32_t readback = 0; readback < submission.readbackCount; readback++)
+        {
+            const StagingReadback& staging = submission.readbacks[readback];
+            const VkDescriptorBufferInfo& bufferInfo = m_buffersAccessibleToShader.find(staging.binding)->second.bufferInfo;
+            VkBufferCopy copyRegion{};
+            copyRegion.srcOffset = bufferInfo.offset + staging.offset;
+            copyRegion.dstOffset = 0;
+            copyRegion.size = staging.size;
+            vkCmdCopyBuffer(submission.commandBuffer, bufferInfo.buffer, staging.buffer.bufferInfo.buffer, 1, &copyRegion);
+        }
+
+        // and the host reads them once the fence is signaled. The dispatches of the next passes that skip their
+        // barrier must not overwrite the ranges before they are copied
+        memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        memoryBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(submission.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+        EndProfileScope();
+    }
+    EndProfileScope();
+    m_profiler->EndFrame();
+
+    auto err = vkEndCommandBuffer(submission.commandBuffer);
     Vulkan::check_vk_result(err);
 
+    if (!submission.fence)
+    {
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        err = vkCreateFence(RenderSys::Vulkan::GetDevice(), &fenceInfo, nullptr, &submission.fence);
+        Vulkan::check_vk_result(err);
+    }
+    else
+    {
+        err = vkResetFences(RenderSys::Vulkan::GetDevice(), 1, &submission.fence);
+        Vulkan::check_vk_result(err);
+    }
+
     VkSubmitInfo end_info{};
     end_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
     end_info.commandBufferCount = 1;
-    end_info.pCommandBuffers = &m_commandBuffer;
-    GraphicsAPI::Vulkan::QueueSubmit(end_info);
+    end_info.pCommandBuffers = &submission.commandBuffer;
+    err = vkQueueSubmit(RenderSys::Vulkan::GetDeviceQueue(), 1, &end_info, submission.fence);
+    Vulkan::check_vk_result(err);
+    submission.submitted = true;
+    submission.ticket = m_nextTicket++;
+    return submission.ticket;
+}
+
+void VulkanCompute::EndComputePass()
+{
+    Submit();
+}
+
+bool VulkanCompute::IsComplete(uint64_t ticket)
+{
+    ComputeSubmission* submission = FindSubmission(ticket);
+    // a submission is reused only after its pass has completed
+    if (!submission || !submission->submitted)
+    {
+        return true;
+    }
+    return vkGetFenceStatus(RenderSys::Vulkan::GetDevice(), submission->fence) == VK_SUCCESS;
+}
+
+void VulkanCompute::Wait(uint64_t ticket)
+{
+    ComputeSubmission* submission = FindSubmission(ticket);
+    if (submission)
+    {
+        WaitForSubmission(*submission);
+    }
+}
+
+const void* VulkanCompute::GetReadback(uint64_t ticket, uint32_t readback)
+{
+    ComputeSubmission* submission = FindSubmission(ticket);
+    if (!submission || readback >= submission->readbackCount)
+    {
+        std::cout << "Error: the readback " << readback << " of compute pass " << ticket << " is gone!" << std::endl;
+        assert(false);
+        return nullptr;
+    }
+    WaitForSubmission(*submission);
+    const StagingReadback& staging = submission->readbacks[readback];
+    // GPU_TO_CPU memory may be cached and not coherent
+    vmaInvalidateAllocation(m_vma, staging.buffer.bufferMemory, 0, staging.size);
+    return staging.mapped;
 }
 
 std::vector<uint8_t>& VulkanCompute::GetMappedResult(uint32_t binding)
@@ -489,8 +773,155 @@ std::vector<uint8_t>& VulkanCompute::GetMappedResult(uint32_t binding)
     return mappedBufferStruct->mappedData;
 }
 
+void VulkanCompute::ReadBuffer(uint32_t binding, void* data, uint32_t offset, uint32_t size)
+{
+    auto it = m_buffersAccessibleToShader.find(binding);
+    assert(it != m_buffersAccessibleToShader.end());
+    const VkDescriptorBufferInfo& bufferInfo = it->second.bufferInfo;
+    assert(offset + size <= bufferInfo.range);
+
+    VkBufferCreateInfo stagingBufferDesc{};
+    stagingBufferDesc.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    stagingBufferDesc.size = size;
+    stagingBufferDesc.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    stagingBufferDesc.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    VmaAllocationCreateInfo vmaAllocInfo{};
+    vmaAllocInfo.usage = VMA_MEMORY_USAGE_GPU_TO_CPU;
+
+    VkBuffer stagingBuffer = VK_NULL_HANDLE;
+    VmaAllocation stagingBufferMemory = VK_NULL_HANDLE;
+    if (vmaCreateBuffer(m_vma, &stagingBufferDesc, &vmaAllocInfo, &stagingBuffer, &stagingBufferMemory, nullptr) != VK_SUCCESS) {
+        std::cout << "vkCreateBuffer() failed!" << std::endl;
+        return;
+    }
+
+    CreateCommandPool();
+    auto commandBuffer = RenderSys::Vulkan::BeginSingleTimeCommands(m_commandPool);
+
+    // the writes of the passes submitted before
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                            0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    VkBufferCopy copyRegion{};
+    copyRegion.srcOffset = bufferInfo.offset + offset;
+    copyRegion.dstOffset = 0;
+    copyRegion.size = size;
+    vkCmdCopyBuffer(commandBuffer, bufferInfo.buffer, stagingBuffer, 1, &copyRegion);
+
+    RenderSys::Vulkan::EndSingleTimeCommands(commandBuffer, m_commandPool);
+
+    void *buf;
+    if (vmaMapMemory(m_vma, stagingBufferMemory, &buf) == VK_SUCCESS)
+    {
+        std::memcpy(data, buf, size);
+        vmaUnmapMemory(m_vma, stagingBufferMemory);
+    }
+    else
+    {
+        std::cout << "vkMapMemory() failed" << std::endl;
+    }
+    vmaDestroyBuffer(m_vma, stagingBuffer, stagingBufferMemory);
+}
+
+void VulkanCompute::WriteBuffer(uint32_t binding, const void* data, uint32_t offset, uint32_t size)
+{
+    auto it = m_buffersAccessibleToShader.find(binding);
+    assert(it != m_buffersAccessibleToShader.end());
+    const VkDescriptorBufferInfo& bufferInfo = it->second.bufferInfo;
+    assert(offset + size <= bufferInfo.range);
+
+    VkBufferCreateInfo stagingBufferDesc{};
+    stagingBufferDesc.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    stagingBufferDesc.size = size;
+    stagingBufferDesc.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    stagingBufferDesc.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    VmaAllocationCreateInfo vmaAllocInfo{};
+    vmaAllocInfo.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+
+    VkBuffer stagingBuffer = VK_NULL_HANDLE;
+    VmaAllocation stagingBufferMemory = VK_NULL_HANDLE;
+    if (vmaCreateBuffer(m_vma, &stagingBufferDesc, &vmaAllocInfo, &stagingBuffer, &stagingBufferMemory, nullptr) != VK_SUCCESS) {
+        std::cout << "vkCreateBuffer() failed!" << std::endl;
+        return;
+    }
+
+    void *buf;
+    if (vmaMapMemory(m_vma, stagingBufferMemory, &buf) != VK_SUCCESS)
+    {
+        std::cout << "vkMapMemory() failed" << std::endl;
+        vmaDestroyBuffer(m_vma, stagingBuffer, stagingBufferMemory);
+        return;
+    }
+    std::memcpy(buf, data, size);
+    vmaUnmapMemory(m_vma, stagingBufferMemory);
+
+    CreateCommandPool();
+    auto commandBuffer = RenderSys::Vulkan::BeginSingleTimeCommands(m_commandPool);
+
+    // the kernels and the readback copies submitted before are done with the range
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                            0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    VkBufferCopy copyRegion{};
+    copyRegion.srcOffset = 0;
+    copyRegion.dstOffset = bufferInfo.offset + offset;
+    copyRegion.size = size;
+    vkCmdCopyBuffer(commandBuffer, stagingBuffer, bufferInfo.buffer, 1, &copyRegion);
+
+    // and the kernels submitted after see the upload
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                            0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    RenderSys::Vulkan::EndSingleTimeCommands(commandBuffer, m_commandPool);
+    vmaDestroyBuffer(m_vma, stagingBuffer, stagingBufferMemory);
+}
+
+void VulkanCompute::BeginProfileScope(const std::string& name)
+{
+    if (m_profiler && m_profiler->IsInFrame())
+    {
+        m_profiler->BeginScope(m_submissions[m_currentSubmission].commandBuffer, name, {0, 0, m_dispatchCount});
+    }
+}
+
+void VulkanCompute::EndProfileScope()
+{
+    if (m_profiler && m_profiler->IsInFrame())
+    {
+        m_profiler->EndScope(m_submissions[m_currentSubmission].commandBuffer, {0, 0, m_dispatchCount});
+    }
+}
+
+RenderSys::GpuProfiler* VulkanCompute::GetGpuProfiler()
+{
+    return m_profiler ? &m_profiler->GetProfiler() : nullptr;
+}
+
 void VulkanCompute::Destroy()
 {
+    WaitForAllSubmissions();
+    for (ComputeSubmission& submission : m_submissions)
+    {
+        for (StagingReadback& staging : submission.readbacks)
+        {
+            vmaUnmapMemory(m_vma, staging.buffer.bufferMemory);
+            vmaDestroyBuffer(m_vma, staging.buffer.bufferInfo.buffer, staging.buffer.bufferMemory);
+        }
+        submission.readbacks.clear();
+        submission.readbackCount = 0;
+        submission.ticket = 0;
+    }
+
     // Destroy Buffers
     for (auto& [binding, computeBuffer] : m_buffersAccessibleToShader)
     {
@@ -505,6 +936,7 @@ void VulkanCompute::Destroy()
 
     m_buffersAccessibleToShader.clear();
     m_shaderOutputBuffers.clear();
+    m_bindGroupDirty = true;
 }
 
 }
@@ -1,13 +1,25 @@
 #pragma once
 
+#include <array>
+#include <memory>
 #include <vector>
 #include <vk_mem_alloc.h>
 #include <Walnut/GraphicsAPI/VulkanGraphics.h>
 
 #include <RenderSys/Buffer.h>
+#include <RenderSys/Compute.h>
+#include <RenderSys/GpuProfiler.h>
 #include <RenderSys/RenderUtil.h>
 #include <RenderSys/Shader.h>
 
+namespace RenderSys
+{
+namespace Vulkan
+{
+class QueryProfiler;
+}
+}
+
 namespace GraphicsAPI
 {
     struct VulkanComputeBuffer
@@ -34,20 +46,69 @@ namespace GraphicsAPI
         void CreateShaders(RenderSys::Shader& shader);
         void CreatePipeline();
         void CreateBuffer(uint32_t binding, uint32_t bufferLength, RenderSys::ComputeBuf::BufferType type);
-        void SetBufferData(uint32_t binding, const void *bufferData, uint32_t bufferLength);
+        void SetBufferData(uint32_t binding, const void *bufferData, uint32_t bufferLength, uint32_t offset = 0);
         void BeginComputePass();
         void Compute(const uint32_t workgroupCountX, const uint32_t workgroupCountY);
+        void Compute(const uint32_t kernel, const uint32_t workgroupCountX, const uint32_t workgroupCountY, const uint32_t workgroupCountZ,
+                        const void* pushConstants, const uint32_t pushConstantSize, const bool barrier);
+        uint32_t RequestReadback(uint32_t binding, uint32_t offset, uint32_t size);
+        uint64_t Submit();
         void EndComputePass();
+        bool IsComplete(uint64_t ticket);
+        void Wait(uint64_t ticket);
+        const void* GetReadback(uint64_t ticket, uint32_t readback);
         std::vector<uint8_t>& GetMappedResult(uint32_t binding);
+        void ReadBuffer(uint32_t binding, void* data, uint32_t offset, uint32_t size);
+        void WriteBuffer(uint32_t binding, const void* data, uint32_t offset, uint32_t size);
+        void BeginProfileScope(const std::string& name);
+        void EndProfileScope();
+        RenderSys::GpuProfiler* GetGpuProfiler();
         void Destroy();
     private:
+        // a range of a Storage buffer copied at the end of a pass into persistently mapped memory
+        struct StagingReadback
+        {
+            VulkanComputeBuffer buffer;
+            void* mapped = nullptr;
+            uint32_t binding = 0;
+            uint32_t offset = 0;
+            uint32_t size = 0;
+        };
+        // a pass in flight, the readbacks stay valid until the next pass that runs in it begins
+        struct ComputeSubmission
+        {
+            VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+            VkFence fence = VK_NULL_HANDLE;
+            bool submitted = false;
+            // 0 before the first submit and while recording
+            uint64_t ticket = 0;
+            std::vector<StagingReadback> readbacks;
+            uint32_t readbackCount = 0;
+        };
+
+        void CreateCommandPool();
+        void WriteBindGroup();
+        void WaitForSubmission(ComputeSubmission& submission);
+        void WaitForAllSubmissions();
+        ComputeSubmission* FindSubmission(uint64_t ticket);
+
         std::vector<VkPipelineShaderStageCreateInfo> m_shaderStageInfos;
         std::unordered_map<std::string, std::vector<uint32_t>> m_shaderMap;
 
         VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
-        VkPipeline m_pipeline = VK_NULL_HANDLE;
+        // one per kernel, in the order of the shaders
+        std::vector<VkPipeline> m_pipelines;
         VkCommandPool m_commandPool = VK_NULL_HANDLE;
-        VkCommandBuffer m_commandBuffer = VK_NULL_HANDLE;
+        // used round robin, a pass begins once the pass MAX_PASSES_IN_FLIGHT before it has completed
+        std::array<ComputeSubmission, RenderSys::Compute::MAX_PASSES_IN_FLIGHT> m_submissions;
+        uint32_t m_currentSubmission = RenderSys::Compute::MAX_PASSES_IN_FLIGHT - 1;
+        uint64_t m_nextTicket = 1;
+        // dispatches recorded in the current pass
+        uint32_t m_dispatchCount = 0;
+        // one frame per pass, with a scope around the whole pass
+        std::unique_ptr<RenderSys::Vulkan::QueryProfiler> m_profiler;
+        // the descriptors are written before the first dispatch after a buffer was created, never while recording
+        bool m_bindGroupDirty = true;
 
         VkDescriptorSetLayout m_bindGroupLayout = VK_NULL_HANDLE;
         VkDescriptorPool m_bindGroupPool = VK_NULL_HANDLE;
@@ -0,0 +1,315 @@
+#include "VulkanDevice.h"
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace RenderSys
+{
+namespace Vulkan
+{
+
+namespace
+{
+
+struct HeadlessDevice
+{
+    VkInstance instance = VK_NULL_HANDLE;
+    VkDebugUtilsMessengerEXT messenger = VK_NULL_HANDLE;
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    VkQueue queue = VK_NULL_HANDLE;
+    uint32_t queueFamilyIndex = 0;
+    uint32_t validationErrors = 0;
+    uint32_t validationWarnings = 0;
+};
+
+HeadlessDevice g_headless;
+// of the device in use, the headless one or the one of the application
+VkPhysicalDeviceFeatures g_enabledFeatures{};
+
+VKAPI_ATTR VkBool32 VKAPI_CALL OnValidationMessage(VkDebugUtilsMessageSeverityFlagBitsEXT severity, VkDebugUtilsMessageTypeFlagsEXT,
+                                                    const VkDebugUtilsMessengerCallbackDataEXT* callbackData, void*)
+{
+    if (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT)
+    {
+        ++g_headless.validationErrors;
+        std::cout << "Validation error: " << callbackData->pMessage << std::endl;
+    }
+    else if (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT)
+    {
+        ++g_headless.validationWarnings;
+        std::cout << "Validation warning: " << callbackData->pMessage << std::endl;
+    }
+    return VK_FALSE;
+}
+
+bool HasInstanceLayer(const char* layerName)
+{
+    uint32_t layerCount = 0;
+    vkEnumerateInstanceLayerProperties(&layerCount, nullptr);
+    std::vector<VkLayerProperties> layers(layerCount);
+    vkEnumerateInstanceLayerProperties(&layerCount, layers.data());
+    for (const auto& layer : layers)
+    {
+        if (strcmp(layer.layerName, layerName) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// prefers a discrete GPU, every device with a queue for graphics and compute will do
+bool PickPhysicalDevice(VkPhysicalDevice& physicalDevice, uint32_t& queueFamilyIndex)
+{
+    uint32_t deviceCount = 0;
+    vkEnumeratePhysicalDevices(g_headless.instance, &deviceCount, nullptr);
+    std::vector<VkPhysicalDevice> devices(deviceCount);
+    vkEnumeratePhysicalDevices(g_headless.instance, &deviceCount, devices.data());
+
+    bool found = false;
+    for (const auto& device : devices)
+    {
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
+        for (uint32_t family = 0; family < queueFamilyCount; family++)
+        {
+            const VkQueueFlags flags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT;
+            if ((queueFamilies[family].queueFlags & flags) != flags)
+            {
+                continue;
+            }
+            VkPhysicalDeviceProperties properties;
+            vkGetPhysicalDeviceProperties(device, &properties);
+            if (!found || properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
+            {
+                physicalDevice = device;
+                queueFamilyIndex = family;
+                found = true;
+            }
+            break;
+        }
+    }
+    return found;
+}
+
+} // namespace
+
+VkInstance GetInstance()
+{
+    return g_headless.instance != VK_NULL_HANDLE ? g_headless.instance : GraphicsAPI::Vulkan::GetInstance();
+}
+
+VkPhysicalDevice GetPhysicalDevice()
+{
+    return g_headless.physicalDevice != VK_NULL_HANDLE ? g_headless.physicalDevice : GraphicsAPI::Vulkan::GetPhysicalDevice();
+}
+
+VkDevice GetDevice()
+{
+    return g_headless.device != VK_NULL_HANDLE ? g_headless.device : GraphicsAPI::Vulkan::GetDevice();
+}
+
+VkQueue GetDeviceQueue()
+{
+    return g_headless.queue != VK_NULL_HANDLE ? g_headless.queue : GraphicsAPI::Vulkan::GetDeviceQueue();
+}
+
+uint32_t GetQueueFamilyIndex()
+{
+    return g_headless.device != VK_NULL_HANDLE ? g_headless.queueFamilyIndex : GraphicsAPI::Vulkan::GetQueueFamilyIndex();
+}
+
+bool IsHeadless()
+{
+    return g_headless.device != VK_NULL_HANDLE;
+}
+
+VkPhysicalDeviceFeatures GetRequestedDeviceFeatures(VkPhysicalDevice physicalDevice)
+{
+    VkPhysicalDeviceFeatures supported{};
+    vkGetPhysicalDeviceFeatures(physicalDevice, &supported);
+    VkPhysicalDeviceFeatures requested{};
+    requested.shaderSampledImageArrayDynamicIndexing = supported.shaderSampledImageArrayDynamicIndexing;
+    requested.drawIndirectFirstInstance = supported.drawIndirectFirstInstance;
+    requested.multiDrawIndirect = supported.multiDrawIndirect;
+    return requested;
+}
+
+void SetEnabledDeviceFeatures(const VkPhysicalDeviceFeatures& features)
+{
+    g_enabledFeatures = features;
+}
+
+const VkPhysicalDeviceFeatures& GetEnabledDeviceFeatures()
+{
+    return g_enabledFeatures;
+}
+
+bool CreateHeadlessDevice(const RenderSys::HeadlessDeviceSpecification& spec)
+{
+    if (g_headless.device != VK_NULL_HANDLE)
+    {
+        std::cout << "Error: the headless device exists already" << std::endl;
+        return false;
+    }
+
+    const char* validationLayer = "VK_LAYER_KHRONOS_validation";
+    const bool validation = (spec.m_Validation || spec.m_SynchronizationValidation) && HasInstanceLayer(validationLayer);
+    if ((spec.m_Validation || spec.m_SynchronizationValidation) && !validation)
+    {
+        std::cout << "Error: " << validationLayer << " is not installed, running without validation" << std::endl;
+    }
+
+    VkApplicationInfo appInfo{};
+    appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    appInfo.pApplicationName = spec.m_ApplicationName.c_str();
+    appInfo.pEngineName = "RenderSys";
+    appInfo.apiVersion = VK_API_VERSION_1_2;
+
+    std::vector<const char*> layers;
+    std::vector<const char*> extensions;
+    if (validation)
+    {
+        layers.push_back(validationLayer);
+        extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+    }
+
+    VkInstanceCreateInfo instanceInfo{};
+    instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instanceInfo.pApplicationInfo = &appInfo;
+    instanceInfo.enabledLayerCount = static_cast<uint32_t>(layers.size());
+    instanceInfo.ppEnabledLayerNames = layers.data();
+
+    // the extension is implemented by the layer
+    const VkValidationFeatureEnableEXT synchronizationValidation = VK_VALIDATION_FEATURE_ENABLE_SYNCHRONIZATION_VALIDATION_EXT;
+    VkValidationFeaturesEXT validationFeatures{};
+    validationFeatures.sType = VK_STRUCTURE_TYPE_VALIDATION_FEATURES_EXT;
+    validationFeatures.enabledValidationFeatureCount = 1;
+    validationFeatures.pEnabledValidationFeatures = &synchronizationValidation;
+    if (validation && spec.m_SynchronizationValidation)
+    {
+        extensions.push_back(VK_EXT_VALIDATION_FEATURES_EXTENSION_NAME);
+        instanceInfo.pNext = &validationFeatures;
+    }
+    instanceInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+    instanceInfo.ppEnabledExtensionNames = extensions.data();
+
+    auto err = vkCreateInstance(&instanceInfo, nullptr, &g_headless.instance);
+    if (err != VK_SUCCESS)
+    {
+        std::cout << "Error: vkCreateInstance failed with " << err << std::endl;
+        g_headless = HeadlessDevice{};
+        return false;
+    }
+
+    if (validation)
+    {
+        VkDebugUtilsMessengerCreateInfoEXT messengerInfo{};
+        messengerInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
+        messengerInfo.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+        messengerInfo.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
+                                    VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
+        messengerInfo.pfnUserCallback = OnValidationMessage;
+        auto createMessenger = reinterpret_cast<PFN_vkCreateDebugUtilsMessengerEXT>(
+                                    vkGetInstanceProcAddr(g_headless.instance, "vkCreateDebugUtilsMessengerEXT"));
+        if (createMessenger)
+        {
+            createMessenger(g_headless.instance, &messengerInfo, nullptr, &g_headless.messenger);
+        }
+    }
+
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    uint32_t queueFamilyIndex = 0;
+    if (!PickPhysicalDevice(physicalDevice, queueFamilyIndex))
+    {
+        std::cout << "Error: no Vulkan device with a graphics and compute queue" << std::endl;
+        DestroyHeadlessDevice();
+        return false;
+    }
+
+    const float queuePriority = 1.0f;
+    VkDeviceQueueCreateInfo queueInfo{};
+    queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    queueInfo.queueFamilyIndex = queueFamilyIndex;
+    queueInfo.queueCount = 1;
+    queueInfo.pQueuePriorities = &queuePriority;
+
+    VkDeviceCreateInfo deviceInfo{};
+    deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    deviceInfo.queueCreateInfoCount = 1;
+    deviceInfo.pQueueCreateInfos = &queueInfo;
+    deviceInfo.enabledLayerCount = static_cast<uint32_t>(layers.size());
+    deviceInfo.ppEnabledLayerNames = layers.data();
+    const VkPhysicalDeviceFeatures features = GetRequestedDeviceFeatures(physicalDevice);
+    deviceInfo.pEnabledFeatures = &features;
+
+    VkDevice device = VK_NULL_HANDLE;
+    err = vkCreateDevice(physicalDevice, &deviceInfo, nullptr, &device);
+    if (err != VK_SUCCESS)
+    {
+        std::cout << "Error: vkCreateDevice failed with " << err << std::endl;
+        DestroyHeadlessDevice();
+        return false;
+    }
+
+    g_headless.physicalDevice = physicalDevice;
+    g_headless.queueFamilyIndex = queueFamilyIndex;
+    g_headless.device = device;
+    g_enabledFeatures = features;
+    vkGetDeviceQueue(device, queueFamilyIndex, 0, &g_headless.queue);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    std::cout << "Headless device: " << properties.deviceName << (validation ? ", validation" : "")
+                << (validation && spec.m_SynchronizationValidation ? ", synchronization validation" : "") << std::endl;
+    std::cout << "Enabled features: shaderSampledImageArrayDynamicIndexing " << features.shaderSampledImageArrayDynamicIndexing
+                << ", drawIndirectFirstInstance " << features.drawIndirectFirstInstance
+                << ", multiDrawIndirect " << features.multiDrawIndirect << std::endl;
+    return true;
+}
+
+void DestroyHeadlessDevice()
+{
+    if (g_headless.device != VK_NULL_HANDLE)
+    {
+        vkDeviceWaitIdle(g_headless.device);
+        vkDestroyDevice(g_headless.device, nullptr);
+    }
+    if (g_headless.messenger != VK_NULL_HANDLE)
+    {
+        auto destroyMessenger = reinterpret_cast<PFN_vkDestroyDebugUtilsMessengerEXT>(
+                                    vkGetInstanceProcAddr(g_headless.instance, "vkDestroyDebugUtilsMessengerEXT"));
+        if (destroyMessenger)
+        {
+            destroyMessenger(g_headless.instance, g_headless.messenger, nullptr);
+        }
+    }
+    if (g_headless.instance != VK_NULL_HANDLE)
+    {
+        vkDestroyInstance(g_headless.instance, nullptr);
+    }
+    // the counts stay readable after the device is gone
+    const uint32_t validationErrors = g_headless.validationErrors;
+    const uint32_t validationWarnings = g_headless.validationWarnings;
+    g_headless = HeadlessDevice{};
+    g_enabledFeatures = VkPhysicalDeviceFeatures{};
+    g_headless.validationErrors = validationErrors;
+    g_headless.validationWarnings = validationWarnings;
+}
+
+uint32_t GetValidationErrorCount()
+{
+    return g_headless.validationErrors;
+}
+
+uint32_t GetValidationWarningCount()
+{
+    return g_headless.validationWarnings;
+}
+
+} // namespace Vulkan
+} // namespace RenderSys
@@ -0,0 +1,37 @@
+#pragma once
+#include <Walnut/GraphicsAPI/VulkanGraphics.h>
+#include <RenderSys/HeadlessDevice.h>
+
+namespace RenderSys
+{
+namespace Vulkan
+{
+
+// The device all Vulkan code of RenderSys uses. That is the one of the Walnut application, or the headless one
+// once CreateHeadlessDevice() succeeded
+VkInstance GetInstance();
+VkPhysicalDevice GetPhysicalDevice();
+VkDevice GetDevice();
+// the family of GetDeviceQueue(), graphics and compute
+VkQueue GetDeviceQueue();
+uint32_t GetQueueFamilyIndex();
+// there is no ImGui and no window, the rendered images are only read back
+bool IsHeadless();
+
+// The optional features RenderSys uses, as far as the physical device supports them: dynamic indexing of the
+// bindless texture array, the first instance and the draw count of indirect draws. Whoever creates the device
+// passes them as pEnabledFeatures, the headless device does, an application creating its own device afterwards
+// hands them to SetEnabledDeviceFeatures()
+VkPhysicalDeviceFeatures GetRequestedDeviceFeatures(VkPhysicalDevice physicalDevice);
+void SetEnabledDeviceFeatures(const VkPhysicalDeviceFeatures& features);
+// the optional features the device was created with, which can be less than vkGetPhysicalDeviceFeatures() reports.
+// None for a device created without telling SetEnabledDeviceFeatures(), e.g. the one of an unmodified Walnut
+const VkPhysicalDeviceFeatures& GetEnabledDeviceFeatures();
+
+bool CreateHeadlessDevice(const RenderSys::HeadlessDeviceSpecification& spec);
+void DestroyHeadlessDevice();
+uint32_t GetValidationErrorCount();
+uint32_t GetValidationWarningCount();
+
+} // namespace Vulkan
+} // namespace RenderSys
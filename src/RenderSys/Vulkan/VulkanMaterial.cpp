@@ -1,6 +1,15 @@
 #include "VulkanMaterial.h"
+#include "VulkanDevice.h"
 #include "VulkanTexture.h"
+#include "VulkanMemAlloc.h"
 #include "VulkanRenderer3D.h"
+#include "VulkanRendererUtils.h"
+
+#include <array>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+#include <RenderSys/MaterialFeatures.h>
 
 namespace RenderSys
 {
@@ -40,7 +49,7 @@ void CreateMaterialBindGroupPool()
     poolInfo.pPoolSizes = poolSizes.data();
     poolInfo.maxSets = maxMaterialsPerModel * maxNumOfModels;
 
-    if (vkCreateDescriptorPool(GraphicsAPI::Vulkan::GetDevice(), &poolInfo, nullptr, &g_materialBindGroupPool) != VK_SUCCESS) {
+    if (vkCreateDescriptorPool(RenderSys::Vulkan::GetDevice(), &poolInfo, nullptr, &g_materialBindGroupPool) != VK_SUCCESS) {
         throw std::runtime_error("failed to create descriptor pool!");
     }
 }
@@ -54,9 +63,9 @@ VkDescriptorPool GetMaterialBindGroupPool()
 void DestroyMaterialBindGroupPool()
 {
     assert(g_materialBindGroupPool != VK_NULL_HANDLE); 
-    vkDeviceWaitIdle(GraphicsAPI::Vulkan::GetDevice());
+    vkDeviceWaitIdle(RenderSys::Vulkan::GetDevice());
     // when you destroy a descriptor pool, all descriptor sets allocated from that pool are automatically destroyed
-    vkDestroyDescriptorPool(GraphicsAPI::Vulkan::GetDevice(), g_materialBindGroupPool, nullptr);
+    vkDestroyDescriptorPool(RenderSys::Vulkan::GetDevice(), g_materialBindGroupPool, nullptr);
     g_materialBindGroupPool = VK_NULL_HANDLE;
 }
 
@@ -70,7 +79,7 @@ void CreateMaterialBindGroupLayout()
     layoutInfo.bindingCount = bindings.size();
     layoutInfo.pBindings = bindings.data();
 
-    if (vkCreateDescriptorSetLayout(GraphicsAPI::Vulkan::GetDevice(), &layoutInfo, nullptr, &g_materialBindGroupLayout) != VK_SUCCESS) {
+    if (vkCreateDescriptorSetLayout(RenderSys::Vulkan::GetDevice(), &layoutInfo, nullptr, &g_materialBindGroupLayout) != VK_SUCCESS) {
         throw std::runtime_error("failed to create descriptor set layout!");
     }
 }
@@ -84,11 +93,189 @@ VkDescriptorSetLayout GetMaterialBindGroupLayout()
 void DestroyMaterialBindGroupLayout()
 {
     assert(g_materialBindGroupLayout != VK_NULL_HANDLE);
-    vkDestroyDescriptorSetLayout(GraphicsAPI::Vulkan::GetDevice(), g_materialBindGroupLayout, nullptr);
+    vkDestroyDescriptorSetLayout(RenderSys::Vulkan::GetDevice(), g_materialBindGroupLayout, nullptr);
     g_materialBindGroupLayout = VK_NULL_HANDLE;
 }
 
-VulkanMaterialDescriptor::VulkanMaterialDescriptor(MaterialTextures& textures)
+// has to match the std430 layout of the shaders
+static_assert(sizeof(BindlessMaterial) == 80);
+
+VkDescriptorSetLayout g_bindlessMaterialBindGroupLayout = VK_NULL_HANDLE;
+VkDescriptorPool g_bindlessMaterialBindGroupPool = VK_NULL_HANDLE;
+VkDescriptorSet g_bindlessMaterialBindGroup = VK_NULL_HANDLE;
+VkBuffer g_bindlessMaterialBuffer = VK_NULL_HANDLE;
+VmaAllocation g_bindlessMaterialBufferMemory = VK_NULL_HANDLE;
+BindlessMaterial* g_bindlessMaterials = nullptr; // persistently mapped
+uint32_t g_bindlessMaterialCount = 0;
+// a texture shared by several materials takes one slot, slot 0 is a dummy texture
+std::unordered_map<VkImageView, int> g_bindlessTextureSlots;
+std::shared_ptr<Texture> g_bindlessDummyTexture;
+
+bool IsBindlessMaterialSupported()
+{
+    // indexing the texture array with a material index needs the feature enabled on the device, not just supported
+    const VkPhysicalDeviceFeatures& features = Vulkan::GetEnabledDeviceFeatures();
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(RenderSys::Vulkan::GetPhysicalDevice(), &properties);
+    const auto& limits = properties.limits;
+    return features.shaderSampledImageArrayDynamicIndexing == VK_TRUE
+        && limits.maxPerStageDescriptorSamplers >= GLSL_MAX_BINDLESS_TEXTURES
+        && limits.maxPerStageDescriptorSampledImages >= GLSL_MAX_BINDLESS_TEXTURES
+        && limits.maxDescriptorSetSamplers >= GLSL_MAX_BINDLESS_TEXTURES
+        && limits.maxDescriptorSetSampledImages >= GLSL_MAX_BINDLESS_TEXTURES;
+}
+
+void CreateBindlessMaterialBindGroup()
+{
+    assert(g_bindlessMaterialBindGroupLayout == VK_NULL_HANDLE);
+    const std::array<VkDescriptorSetLayoutBinding, 2> bindings
+    {
+        VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, nullptr}, // materials
+        VkDescriptorSetLayoutBinding{1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, GLSL_MAX_BINDLESS_TEXTURES, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr} // textures
+    };
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = bindings.size();
+    layoutInfo.pBindings = bindings.data();
+    if (vkCreateDescriptorSetLayout(RenderSys::Vulkan::GetDevice(), &layoutInfo, nullptr, &g_bindlessMaterialBindGroupLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor set layout!");
+    }
+
+    const std::array<VkDescriptorPoolSize, 2> poolSizes
+    {
+        VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1},
+        VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, GLSL_MAX_BINDLESS_TEXTURES}
+    };
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = poolSizes.size();
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = 1;
+    if (vkCreateDescriptorPool(RenderSys::Vulkan::GetDevice(), &poolInfo, nullptr, &g_bindlessMaterialBindGroupPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor pool!");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = g_bindlessMaterialBindGroupPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &g_bindlessMaterialBindGroupLayout;
+    if (vkAllocateDescriptorSets(RenderSys::Vulkan::GetDevice(), &allocInfo, &g_bindlessMaterialBindGroup) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate descriptor sets!");
+    }
+
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = sizeof(BindlessMaterial) * GLSL_MAX_BINDLESS_MATERIALS;
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    VmaAllocationCreateInfo vmaAllocInfo{};
+    vmaAllocInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+    if (vmaCreateBuffer(Vulkan::GetMemoryAllocator(), &bufferInfo, &vmaAllocInfo, &g_bindlessMaterialBuffer, &g_bindlessMaterialBufferMemory, nullptr) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create bindless material buffer!");
+    }
+    void* mappedBuffer = nullptr;
+    if (vmaMapMemory(Vulkan::GetMemoryAllocator(), g_bindlessMaterialBufferMemory, &mappedBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to map bindless material buffer!");
+    }
+    g_bindlessMaterials = static_cast<BindlessMaterial*>(mappedBuffer);
+    g_bindlessMaterialCount = 0;
+
+    // every slot has to hold a valid descriptor, the unused ones point to the dummy texture
+    g_bindlessDummyTexture = Texture::createDummy(1, 1);
+    const auto* dummyImageInfo = g_bindlessDummyTexture->GetPlatformTexture()->GetDescriptorImageInfoAddr();
+    const std::vector<VkDescriptorImageInfo> imageInfos(GLSL_MAX_BINDLESS_TEXTURES, *dummyImageInfo);
+    g_bindlessTextureSlots.clear();
+    g_bindlessTextureSlots.emplace(dummyImageInfo->imageView, 0);
+
+    const VkDescriptorBufferInfo materialBufferInfo{g_bindlessMaterialBuffer, 0, bufferInfo.size};
+    std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+    descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrites[0].dstSet = g_bindlessMaterialBindGroup;
+    descriptorWrites[0].dstBinding = 0;
+    descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptorWrites[0].descriptorCount = 1;
+    descriptorWrites[0].pBufferInfo = &materialBufferInfo;
+    descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrites[1].dstSet = g_bindlessMaterialBindGroup;
+    descriptorWrites[1].dstBinding = 1;
+    descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    descriptorWrites[1].descriptorCount = GLSL_MAX_BINDLESS_TEXTURES;
+    descriptorWrites[1].pImageInfo = imageInfos.data();
+    vkUpdateDescriptorSets(RenderSys::Vulkan::GetDevice(), descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
+}
+
+bool HasBindlessMaterialBindGroup()
+{
+    return g_bindlessMaterialBindGroup != VK_NULL_HANDLE;
+}
+
+VkDescriptorSetLayout GetBindlessMaterialBindGroupLayout()
+{
+    assert(g_bindlessMaterialBindGroupLayout != VK_NULL_HANDLE);
+    return g_bindlessMaterialBindGroupLayout;
+}
+
+VkDescriptorSet GetBindlessMaterialBindGroup()
+{
+    assert(g_bindlessMaterialBindGroup != VK_NULL_HANDLE);
+    return g_bindlessMaterialBindGroup;
+}
+
+void DestroyBindlessMaterialBindGroup()
+{
+    if (g_bindlessMaterialBindGroupLayout == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    vkDeviceWaitIdle(RenderSys::Vulkan::GetDevice());
+    vkDestroyDescriptorPool(RenderSys::Vulkan::GetDevice(), g_bindlessMaterialBindGroupPool, nullptr);
+    vkDestroyDescriptorSetLayout(RenderSys::Vulkan::GetDevice(), g_bindlessMaterialBindGroupLayout, nullptr);
+    vmaUnmapMemory(Vulkan::GetMemoryAllocator(), g_bindlessMaterialBufferMemory);
+    vmaDestroyBuffer(Vulkan::GetMemoryAllocator(), g_bindlessMaterialBuffer, g_bindlessMaterialBufferMemory);
+    g_bindlessMaterialBindGroupPool = VK_NULL_HANDLE;
+    g_bindlessMaterialBindGroupLayout = VK_NULL_HANDLE;
+    g_bindlessMaterialBindGroup = VK_NULL_HANDLE;
+    g_bindlessMaterialBuffer = VK_NULL_HANDLE;
+    g_bindlessMaterialBufferMemory = VK_NULL_HANDLE;
+    g_bindlessMaterials = nullptr;
+    g_bindlessMaterialCount = 0;
+    g_bindlessTextureSlots.clear();
+    g_bindlessDummyTexture.reset();
+}
+
+int GetBindlessTextureSlot(const VkDescriptorImageInfo& imageInfo)
+{
+    auto slotIter = g_bindlessTextureSlots.find(imageInfo.imageView);
+    if (slotIter != g_bindlessTextureSlots.end())
+    {
+        return slotIter->second;
+    }
+
+    const int slot = static_cast<int>(g_bindlessTextureSlots.size());
+    if (slot >= GLSL_MAX_BINDLESS_TEXTURES)
+    {
+        std::cout << "Error: bindless texture array is full!" << std::endl;
+        assert(false);
+        return 0;
+    }
+
+    VkWriteDescriptorSet textureWrite{};
+    textureWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    textureWrite.dstSet = g_bindlessMaterialBindGroup;
+    textureWrite.dstBinding = 1;
+    textureWrite.dstArrayElement = slot;
+    textureWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    textureWrite.descriptorCount = 1;
+    textureWrite.pImageInfo = &imageInfo;
+    vkUpdateDescriptorSets(RenderSys::Vulkan::GetDevice(), 1, &textureWrite, 0, nullptr);
+    g_bindlessTextureSlots.emplace(imageInfo.imageView, slot);
+    return slot;
+}
+
+VulkanMaterialDescriptor::VulkanMaterialDescriptor(MaterialTextures& textures, const MaterialProperties& properties)
 {
     VkDescriptorSetAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
@@ -97,7 +284,7 @@ VulkanMaterialDescriptor::VulkanMaterialDescriptor(MaterialTextures& textures)
     auto materialBindGroupLayout = GetMaterialBindGroupLayout();
     allocInfo.pSetLayouts = &materialBindGroupLayout;
 
-    if (vkAllocateDescriptorSets(GraphicsAPI::Vulkan::GetDevice(), &allocInfo, &m_bindGroup) != VK_SUCCESS) {
+    if (vkAllocateDescriptorSets(RenderSys::Vulkan::GetDevice(), &allocInfo, &m_bindGroup) != VK_SUCCESS) {
         throw std::runtime_error("failed to allocate descriptor sets!");
     }
 
@@ -187,8 +374,35 @@ VulkanMaterialDescriptor::VulkanMaterialDescriptor(MaterialTextures& textures)
         descriptorWrites[4].pImageInfo = metallicRoughnessTextureImageInfo;
     }
 
-    vkUpdateDescriptorSets(GraphicsAPI::Vulkan::GetDevice(), descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
-    
+    vkUpdateDescriptorSets(RenderSys::Vulkan::GetDevice(), descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
+
+    if (HasBindlessMaterialBindGroup())
+    {
+        if (g_bindlessMaterialCount >= GLSL_MAX_BINDLESS_MATERIALS)
+        {
+            std::cout << "Error: bindless material buffer is full!" << std::endl;
+            assert(false);
+            return;
+        }
+
+        // same texture fallbacks as the bind group above, in the order of its bindings
+        m_bindlessIndex = g_bindlessMaterialCount++;
+        auto& bindlessMaterial = g_bindlessMaterials[m_bindlessIndex];
+        bindlessMaterial.m_baseColorTexture = GetBindlessTextureSlot(*descriptorWrites[0].pImageInfo);
+        bindlessMaterial.m_normalTexture = GetBindlessTextureSlot(*descriptorWrites[1].pImageInfo);
+        bindlessMaterial.m_metallicTexture = GetBindlessTextureSlot(*descriptorWrites[2].pImageInfo);
+        bindlessMaterial.m_roughnessTexture = GetBindlessTextureSlot(*descriptorWrites[3].pImageInfo);
+        bindlessMaterial.m_metallicRoughnessTexture = GetBindlessTextureSlot(*descriptorWrites[4].pImageInfo);
+        SetMaterialProperties(properties);
+    }
+}
+
+void VulkanMaterialDescriptor::SetMaterialProperties(const MaterialProperties& properties)
+{
+    if (m_bindlessIndex != NO_BINDLESS_INDEX)
+    {
+        std::memcpy(&g_bindlessMaterials[m_bindlessIndex].m_properties, &properties, sizeof(MaterialProperties));
+    }
 }
 
 VulkanMaterialDescriptor::~VulkanMaterialDescriptor()
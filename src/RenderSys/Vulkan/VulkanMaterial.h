@@ -15,14 +15,30 @@ void CreateMaterialBindGroupLayout();
 VkDescriptorSetLayout GetMaterialBindGroupLayout();
 void DestroyMaterialBindGroupLayout();
 
+// Bindless materials: one bind group holds the textures of all materials in one array (binding 1) and the
+// BindlessMaterial entries in a storage buffer (binding 0), so a draw only needs the index of its material.
+// Textures are indexed with a dynamically uniform index, which needs shaderSampledImageArrayDynamicIndexing.
+bool IsBindlessMaterialSupported();
+void CreateBindlessMaterialBindGroup();
+bool HasBindlessMaterialBindGroup();
+VkDescriptorSetLayout GetBindlessMaterialBindGroupLayout();
+VkDescriptorSet GetBindlessMaterialBindGroup();
+void DestroyBindlessMaterialBindGroup();
+
 class VulkanMaterialDescriptor
 {
 public:
-    VulkanMaterialDescriptor(MaterialTextures& textures);
+    static constexpr uint32_t NO_BINDLESS_INDEX = ~0u;
+
+    VulkanMaterialDescriptor(MaterialTextures& textures, const MaterialProperties& properties);
     ~VulkanMaterialDescriptor();
 
+    void SetMaterialProperties(const MaterialProperties& properties);
+
     // 1 bind group for different texture types of one material (baseColor/normal/metallic-roughness)
     VkDescriptorSet m_bindGroup = VK_NULL_HANDLE; 
+    // entry in the bindless material buffer, NO_BINDLESS_INDEX without bindless bind group
+    uint32_t m_bindlessIndex = NO_BINDLESS_INDEX;
 };
 
 
@@ -1,4 +1,5 @@
 #include "VulkanMemAlloc.h"
+#include "VulkanDevice.h"
 #include <Walnut/GraphicsAPI/VulkanGraphics.h>
 
 #define VMA_IMPLEMENTATION
@@ -18,9 +19,9 @@ VmaAllocator GetMemoryAllocator()
     if (g_allocator == VK_NULL_HANDLE)
     {
         VmaAllocatorCreateInfo allocatorInfo{};
-        allocatorInfo.physicalDevice = GraphicsAPI::Vulkan::GetPhysicalDevice();
-        allocatorInfo.device = GraphicsAPI::Vulkan::GetDevice();
-        allocatorInfo.instance = GraphicsAPI::Vulkan::GetInstance();
+        allocatorInfo.physicalDevice = RenderSys::Vulkan::GetPhysicalDevice();
+        allocatorInfo.device = RenderSys::Vulkan::GetDevice();
+        allocatorInfo.instance = RenderSys::Vulkan::GetInstance();
         if (vmaCreateAllocator(&allocatorInfo, &g_allocator) != VK_SUCCESS) {
             std::cout << "error: could not init VMA" << std::endl;
             assert(false);
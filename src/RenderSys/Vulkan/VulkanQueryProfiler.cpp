@@ -0,0 +1,173 @@
+#include "VulkanQueryProfiler.h"
+#include "VulkanDevice.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+
+namespace RenderSys
+{
+namespace Vulkan
+{
+
+namespace
+{
+
+double ToMilliseconds(const std::chrono::steady_clock::duration duration)
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+} // namespace
+
+QueryProfiler::QueryProfiler(const std::string& name)
+    : m_profiler(name)
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(RenderSys::Vulkan::GetPhysicalDevice(), &properties);
+    m_timestampPeriod = properties.limits.timestampPeriod;
+
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(RenderSys::Vulkan::GetPhysicalDevice(), &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(RenderSys::Vulkan::GetPhysicalDevice(), &queueFamilyCount, queueFamilies.data());
+    // the renderer and the compute passes both submit to the graphics queue
+    const uint32_t queueFamily = RenderSys::Vulkan::GetQueueFamilyIndex();
+    const uint32_t validBits = queueFamily < queueFamilyCount ? queueFamilies[queueFamily].timestampValidBits : 0;
+    if (validBits == 0)
+    {
+        std::cout << "GPU profiler " << name << ": the queue has no timestamps, only CPU times are recorded" << std::endl;
+        return;
+    }
+    m_timestampMask = validBits >= 64 ? ~uint64_t(0) : (uint64_t(1) << validBits) - 1;
+
+    VkQueryPoolCreateInfo queryPoolInfo{};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount = GetFirstQuery(FRAME_LATENCY);
+    if (vkCreateQueryPool(RenderSys::Vulkan::GetDevice(), &queryPoolInfo, nullptr, &m_queryPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create timestamp query pool!");
+    }
+}
+
+QueryProfiler::~QueryProfiler()
+{
+    // the owner has waited for its command buffers
+    if (m_queryPool)
+    {
+        vkDestroyQueryPool(RenderSys::Vulkan::GetDevice(), m_queryPool, nullptr);
+        m_queryPool = VK_NULL_HANDLE;
+    }
+}
+
+void QueryProfiler::BeginFrame(VkCommandBuffer commandBuffer)
+{
+    assert(!m_inFrame);
+    m_currentFrame = (m_currentFrame + 1) % FRAME_LATENCY;
+    FrameQueries& queries = m_frames[m_currentFrame];
+    if (queries.m_recorded)
+    {
+        Resolve(m_currentFrame);
+    }
+
+    m_frameBegin = std::chrono::steady_clock::now();
+    queries.m_frame = RenderSys::GpuProfileFrame{};
+    queries.m_frame.m_Frame = m_frameCount++;
+    queries.m_frame.m_CpuBeginMs = ToMilliseconds(m_frameBegin.time_since_epoch());
+    queries.m_recorded = false;
+    if (m_queryPool)
+    {
+        // in the command buffer, after the results of the frame before in this range were read
+        vkCmdResetQueryPool(commandBuffer, m_queryPool, GetFirstQuery(m_currentFrame), MAX_SCOPES * 2);
+    }
+    m_inFrame = true;
+}
+
+void QueryProfiler::EndFrame()
+{
+    assert(m_inFrame && m_openScopes.empty());
+    FrameQueries& queries = m_frames[m_currentFrame];
+    queries.m_frame.m_CpuTimeMs = static_cast<float>(ToMilliseconds(std::chrono::steady_clock::now() - m_frameBegin));
+    queries.m_recorded = true;
+    m_inFrame = false;
+}
+
+void QueryProfiler::BeginScope(VkCommandBuffer commandBuffer, const std::string& name, const RenderSys::GpuProfileCounters& counters)
+{
+    assert(m_inFrame);
+    auto& scopes = m_frames[m_currentFrame].m_frame.m_Scopes;
+    const uint32_t scope = static_cast<uint32_t>(scopes.size());
+    const auto now = std::chrono::steady_clock::now();
+    RenderSys::GpuProfileScope& profileScope = scopes.emplace_back();
+    profileScope.m_Name = name;
+    profileScope.m_Depth = static_cast<uint32_t>(m_openScopes.size());
+    profileScope.m_CpuBeginMs = ToMilliseconds(now - m_frameBegin);
+    if (m_queryPool && scope < MAX_SCOPES)
+    {
+        // the begin is written once the commands before it have started, the end once everything before it has completed
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_queryPool, GetFirstQuery(m_currentFrame) + scope * 2);
+    }
+    m_openScopes.push_back({scope, counters, now});
+}
+
+void QueryProfiler::EndScope(VkCommandBuffer commandBuffer, const RenderSys::GpuProfileCounters& counters)
+{
+    assert(m_inFrame && !m_openScopes.empty());
+    const OpenScope openScope = m_openScopes.back();
+    m_openScopes.pop_back();
+
+    RenderSys::GpuProfileScope& profileScope = m_frames[m_currentFrame].m_frame.m_Scopes[openScope.m_scope];
+    profileScope.m_CpuTimeMs = static_cast<float>(ToMilliseconds(std::chrono::steady_clock::now() - openScope.m_begin));
+    profileScope.m_Counters.m_Draws = counters.m_Draws - openScope.m_counters.m_Draws;
+    profileScope.m_Counters.m_Triangles = counters.m_Triangles - openScope.m_counters.m_Triangles;
+    profileScope.m_Counters.m_Dispatches = counters.m_Dispatches - openScope.m_counters.m_Dispatches;
+    if (m_queryPool && openScope.m_scope < MAX_SCOPES)
+    {
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_queryPool,
+                            GetFirstQuery(m_currentFrame) + openScope.m_scope * 2 + 1);
+    }
+}
+
+void QueryProfiler::Resolve(const uint32_t frame)
+{
+    FrameQueries& queries = m_frames[frame];
+    queries.m_recorded = false;
+    RenderSys::GpuProfileFrame& profileFrame = queries.m_frame;
+    const uint32_t scopeCount = std::min(static_cast<uint32_t>(profileFrame.m_Scopes.size()), MAX_SCOPES);
+    if (m_queryPool && scopeCount > 0)
+    {
+        const uint32_t queryCount = scopeCount * 2;
+        m_results.resize(queryCount * 2);
+        const VkResult result = vkGetQueryPoolResults(RenderSys::Vulkan::GetDevice(), m_queryPool, GetFirstQuery(frame), queryCount,
+                                                        m_results.size() * sizeof(uint64_t), m_results.data(), 2 * sizeof(uint64_t),
+                                                        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+        if (result != VK_SUCCESS)
+        {
+            // VK_NOT_READY, the GPU is more than FRAME_LATENCY frames behind
+            m_profiler.DropFrame();
+            return;
+        }
+
+        // the first scope began first, the differences are masked in case the counter wrapped
+        const uint64_t firstTimestamp = m_results[0] & m_timestampMask;
+        const double millisecondsPerTick = m_timestampPeriod / 1e6;
+        uint64_t lastTick = 0;
+        for (uint32_t scope = 0; scope < scopeCount; ++scope)
+        {
+            const uint64_t beginTick = ((m_results[scope * 4] & m_timestampMask) - firstTimestamp) & m_timestampMask;
+            const uint64_t endTick = ((m_results[scope * 4 + 2] & m_timestampMask) - firstTimestamp) & m_timestampMask;
+            RenderSys::GpuProfileScope& profileScope = profileFrame.m_Scopes[scope];
+            profileScope.m_GpuBeginMs = static_cast<double>(beginTick) * millisecondsPerTick;
+            profileScope.m_GpuTimeMs = static_cast<float>(static_cast<double>(std::max(endTick, beginTick) - beginTick) * millisecondsPerTick);
+            lastTick = std::max(lastTick, endTick);
+        }
+        profileFrame.m_GpuTimeMs = static_cast<float>(static_cast<double>(lastTick) * millisecondsPerTick);
+        profileFrame.m_HasGpuTimes = true;
+    }
+    m_profiler.AddFrame(std::move(profileFrame));
+}
+
+} // namespace Vulkan
+} // namespace RenderSys
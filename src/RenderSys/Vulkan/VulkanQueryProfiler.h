@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <Walnut/GraphicsAPI/VulkanGraphics.h>
+#include <RenderSys/GpuProfiler.h>
+
+namespace RenderSys
+{
+namespace Vulkan
+{
+
+// Timestamp queries around the scopes of the command buffers of one timeline, one command buffer per frame.
+// Each frame owns a range of the query pool and is read when its range is needed again, FRAME_LATENCY frames
+// later, without waiting: a frame whose queries are not available by then is dropped.
+class QueryProfiler
+{
+public:
+    static constexpr uint32_t FRAME_LATENCY = 3;
+    // per frame, the scopes after them have CPU times only
+    static constexpr uint32_t MAX_SCOPES = 64;
+
+    explicit QueryProfiler(const std::string& name);
+    ~QueryProfiler();
+
+    QueryProfiler(const QueryProfiler&) = delete;
+    QueryProfiler& operator=(const QueryProfiler&) = delete;
+
+    // after vkBeginCommandBuffer() and outside of a render pass, resets the queries of the frame
+    void BeginFrame(VkCommandBuffer commandBuffer);
+    // before vkEndCommandBuffer(), with every scope ended
+    void EndFrame();
+    bool IsInFrame() const { return m_inFrame; }
+    // the counters are the totals of the frame so far, a scope gets what was counted between its begin and end
+    void BeginScope(VkCommandBuffer commandBuffer, const std::string& name, const RenderSys::GpuProfileCounters& counters);
+    void EndScope(VkCommandBuffer commandBuffer, const RenderSys::GpuProfileCounters& counters);
+    // false when the queue has no timestamps
+    bool HasTimestamps() const { return m_queryPool != VK_NULL_HANDLE; }
+    RenderSys::GpuProfiler& GetProfiler() { return m_profiler; }
+
+private:
+    struct OpenScope
+    {
+        uint32_t m_scope = 0;
+        RenderSys::GpuProfileCounters m_counters;
+        std::chrono::steady_clock::time_point m_begin;
+    };
+
+    struct FrameQueries
+    {
+        RenderSys::GpuProfileFrame m_frame;
+        // ended and not resolved yet
+        bool m_recorded = false;
+    };
+
+    uint32_t GetFirstQuery(const uint32_t frame) const { return frame * MAX_SCOPES * 2; }
+    void Resolve(const uint32_t frame);
+
+    VkQueryPool m_queryPool = VK_NULL_HANDLE;
+    // nanoseconds per tick
+    double m_timestampPeriod = 1.0;
+    uint64_t m_timestampMask = ~uint64_t(0);
+    std::array<FrameQueries, FRAME_LATENCY> m_frames;
+    uint32_t m_currentFrame = FRAME_LATENCY - 1;
+    uint64_t m_frameCount = 0;
+    bool m_inFrame = false;
+    std::chrono::steady_clock::time_point m_frameBegin;
+    std::vector<OpenScope> m_openScopes;
+    // a value and its availability per query
+    std::vector<uint64_t> m_results;
+    RenderSys::GpuProfiler m_profiler;
+};
+
+} // namespace Vulkan
+} // namespace RenderSys
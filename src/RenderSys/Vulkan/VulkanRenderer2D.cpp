@@ -1,6 +1,10 @@
 #include "VulkanRenderer2D.h"
+#include "VulkanDevice.h"
 #include "VulkanRendererUtils.h"
 
+#include <array>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 
 #define VMA_IMPLEMENTATION
@@ -14,9 +18,9 @@ bool VulkanRenderer2D::Init()
     if (!m_vma)
     {
         VmaAllocatorCreateInfo allocatorInfo{};
-        allocatorInfo.physicalDevice = Vulkan::GetPhysicalDevice();
-        allocatorInfo.device = Vulkan::GetDevice();
-        allocatorInfo.instance = Vulkan::GetInstance();
+        allocatorInfo.physicalDevice = RenderSys::Vulkan::GetPhysicalDevice();
+        allocatorInfo.device = RenderSys::Vulkan::GetDevice();
+        allocatorInfo.instance = RenderSys::Vulkan::GetInstance();
         if (vmaCreateAllocator(&allocatorInfo, &m_vma) != VK_SUCCESS) {
             std::cout << "error: could not init VMA" << std::endl;
             return false;
@@ -51,23 +55,27 @@ void VulkanRenderer2D::CreateTextureToRenderInto(uint32_t width, uint32_t height
     info.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
     info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
     info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    VkResult err = vkCreateImage(Vulkan::GetDevice(), &info, nullptr, &m_ImageToRenderInto);
+    VkResult err = vkCreateImage(RenderSys::Vulkan::GetDevice(), &info, nullptr, &m_ImageToRenderInto);
     Vulkan::check_vk_result(err);
     VkMemoryRequirements req;
-    vkGetImageMemoryRequirements(Vulkan::GetDevice(), m_ImageToRenderInto, &req);
+    vkGetImageMemoryRequirements(RenderSys::Vulkan::GetDevice(), m_ImageToRenderInto, &req);
     VkMemoryAllocateInfo alloc_info = {};
     alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
     alloc_info.allocationSize = req.size;
-    alloc_info.memoryTypeIndex = Utils::GetVulkanMemoryType(Vulkan::GetPhysicalDevice(), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, req.memoryTypeBits);
-    err = vkAllocateMemory(Vulkan::GetDevice(), &alloc_info, nullptr, &m_Memory);
+    alloc_info.memoryTypeIndex = Utils::GetVulkanMemoryType(RenderSys::Vulkan::GetPhysicalDevice(), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, req.memoryTypeBits);
+    err = vkAllocateMemory(RenderSys::Vulkan::GetDevice(), &alloc_info, nullptr, &m_Memory);
     Vulkan::check_vk_result(err);
-    err = vkBindImageMemory(Vulkan::GetDevice(), m_ImageToRenderInto, m_Memory, 0);
+    err = vkBindImageMemory(RenderSys::Vulkan::GetDevice(), m_ImageToRenderInto, m_Memory, 0);
     Vulkan::check_vk_result(err);
 
     m_imageViewToRenderInto = RenderSys::Vulkan::CreateImageView(m_ImageToRenderInto, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT);
 
     CreateTextureSampler();
-    m_descriptorSet = (VkDescriptorSet)ImGui_ImplVulkan_AddTexture(m_textureSampler, m_imageViewToRenderInto, VK_IMAGE_LAYOUT_GENERAL);
+    // a headless device has no ImGui
+    if (!RenderSys::Vulkan::IsHeadless())
+    {
+        m_descriptorSet = (VkDescriptorSet)ImGui_ImplVulkan_AddTexture(m_textureSampler, m_imageViewToRenderInto, VK_IMAGE_LAYOUT_GENERAL);
+    }
 
 
     CreateFrameBuffer();
@@ -96,7 +104,7 @@ void VulkanRenderer2D::CreateShaders(RenderSys::Shader& shader)
     shaderCreateInfo.pCode = compiledShader.data();
 
     VkShaderModule shaderModule = 0;
-    if (vkCreateShaderModule(Vulkan::GetDevice(), &shaderCreateInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+    if (vkCreateShaderModule(RenderSys::Vulkan::GetDevice(), &shaderCreateInfo, nullptr, &shaderModule) != VK_SUCCESS) {
         std::cout << "could not load vertex shader" << std::endl;
         return;
     }
@@ -147,7 +155,7 @@ void VulkanRenderer2D::DestroyShaders()
 {
     for (auto& shaderStageInfo : m_shaderStageInfos)
     {
-        vkDestroyShaderModule(Vulkan::GetDevice(), shaderStageInfo.module, nullptr);
+        vkDestroyShaderModule(RenderSys::Vulkan::GetDevice(), shaderStageInfo.module, nullptr);
     }
 
     m_shaderStageInfos.clear();
@@ -183,7 +191,7 @@ void VulkanRenderer2D::CreateBindGroup(RenderSys::BindGroupLayoutEntry bindGroup
         layoutInfo.bindingCount = 1;
         layoutInfo.pBindings = &uboLayoutBinding;
 
-        if (vkCreateDescriptorSetLayout(Vulkan::GetDevice(), &layoutInfo, nullptr, &m_bindGroupLayout) != VK_SUCCESS) {
+        if (vkCreateDescriptorSetLayout(RenderSys::Vulkan::GetDevice(), &layoutInfo, nullptr, &m_bindGroupLayout) != VK_SUCCESS) {
             throw std::runtime_error("failed to create descriptor set layout!");
         }
 
@@ -197,7 +205,7 @@ void VulkanRenderer2D::CreateBindGroup(RenderSys::BindGroupLayoutEntry bindGroup
         poolInfo.pPoolSizes = &poolSize;
         poolInfo.maxSets = 1;
 
-        if (vkCreateDescriptorPool(Vulkan::GetDevice(), &poolInfo, nullptr, &m_bindGroupPool) != VK_SUCCESS) {
+        if (vkCreateDescriptorPool(RenderSys::Vulkan::GetDevice(), &poolInfo, nullptr, &m_bindGroupPool) != VK_SUCCESS) {
             throw std::runtime_error("failed to create descriptor pool!");
         }
 
@@ -213,7 +221,7 @@ void VulkanRenderer2D::CreateBindGroup()
     allocInfo.descriptorSetCount = 1;
     allocInfo.pSetLayouts = &m_bindGroupLayout;
 
-    if (vkAllocateDescriptorSets(Vulkan::GetDevice(), &allocInfo, &m_bindGroup) != VK_SUCCESS) {
+    if (vkAllocateDescriptorSets(RenderSys::Vulkan::GetDevice(), &allocInfo, &m_bindGroup) != VK_SUCCESS) {
         throw std::runtime_error("failed to allocate descriptor sets!");
     }
 }
@@ -236,7 +244,7 @@ void VulkanRenderer2D::CreatePipelineLayout()
         }
         pipelineLayoutCreateInfo.pushConstantRangeCount = 0;
 
-        if (vkCreatePipelineLayout(Vulkan::GetDevice(), &pipelineLayoutCreateInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
+        if (vkCreatePipelineLayout(RenderSys::Vulkan::GetDevice(), &pipelineLayoutCreateInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
             std::cout << "error: could not create pipeline layout" << std::endl;
         }        
     }
@@ -310,7 +318,7 @@ bool VulkanRenderer2D::CreateRenderPass()
     //   renderPassInfo.dependencyCount = 2;
     //   renderPassInfo.pDependencies = dependencies;
 
-    if (vkCreateRenderPass(Vulkan::GetDevice(), &renderPassInfo, nullptr, &m_renderpass) != VK_SUCCESS)
+    if (vkCreateRenderPass(RenderSys::Vulkan::GetDevice(), &renderPassInfo, nullptr, &m_renderpass) != VK_SUCCESS)
     {
         std::cout << "error; could not create renderpass" << std::endl;
         return false;
@@ -423,9 +431,9 @@ void VulkanRenderer2D::CreatePipeline()
     pipelineCreateInfo.subpass = 0;
     pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-    if (vkCreateGraphicsPipelines(Vulkan::GetDevice(), VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_pipeline) != VK_SUCCESS) {
+    if (vkCreateGraphicsPipelines(RenderSys::Vulkan::GetDevice(), VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_pipeline) != VK_SUCCESS) {
         std::cout << "error: could not create rendering pipeline" << std::endl;
-        vkDestroyPipelineLayout(Vulkan::GetDevice(), m_pipelineLayout, nullptr);
+        vkDestroyPipelineLayout(RenderSys::Vulkan::GetDevice(), m_pipelineLayout, nullptr);
     }
 
     /* it is save to destroy the shader modules after pipeline has been created */
@@ -438,7 +446,7 @@ void VulkanRenderer2D::CreateFrameBuffer()
 {
     if (m_frameBuffer)
     {
-        vkDestroyFramebuffer(Vulkan::GetDevice(), m_frameBuffer, nullptr);
+        vkDestroyFramebuffer(RenderSys::Vulkan::GetDevice(), m_frameBuffer, nullptr);
     }
 
     VkImageView frameBufferAttachments[] = { m_imageViewToRenderInto };
@@ -451,7 +459,7 @@ void VulkanRenderer2D::CreateFrameBuffer()
     FboInfo.height = m_height;
     FboInfo.layers = 1;
 
-    if (vkCreateFramebuffer(Vulkan::GetDevice(), &FboInfo, nullptr, &m_frameBuffer) != VK_SUCCESS) {
+    if (vkCreateFramebuffer(RenderSys::Vulkan::GetDevice(), &FboInfo, nullptr, &m_frameBuffer) != VK_SUCCESS) {
         std::cout << "error: failed to create framebuffer" << std::endl;
         return ;
     }
@@ -621,7 +629,7 @@ void VulkanRenderer2D::SetUniformData(const void* bufferData, uint32_t uniformIn
     descriptorWrite.pImageInfo = nullptr; // Optional
     descriptorWrite.pTexelBufferView = nullptr; // Optional
 
-    vkUpdateDescriptorSets(Vulkan::GetDevice(), 1, &descriptorWrite, 0, nullptr);
+    vkUpdateDescriptorSets(RenderSys::Vulkan::GetDevice(), 1, &descriptorWrite, 0, nullptr);
 }
 
 void VulkanRenderer2D::SimpleRender()
@@ -723,7 +731,7 @@ void VulkanRenderer2D::CreateTextureSampler()
     texSamplerInfo.anisotropyEnable = VK_FALSE;
     texSamplerInfo.maxAnisotropy = 1.0f;
 
-    if (vkCreateSampler(Vulkan::GetDevice(), &texSamplerInfo, nullptr, &m_textureSampler) != VK_SUCCESS) {
+    if (vkCreateSampler(RenderSys::Vulkan::GetDevice(), &texSamplerInfo, nullptr, &m_textureSampler) != VK_SUCCESS) {
         std::cout << "error: could not create sampler for texture" << std::endl;
     }
 }
@@ -742,16 +750,7 @@ void VulkanRenderer2D::BeginRenderPass()
     VkClearValue clearValues[] = { colorClearValue, depthValue };
 
     // TODO: move commandpool/commandbuffer creation to constructor
-    if (!m_commandPool)
-    {
-        auto queueFamilyIndices = Vulkan::FindQueueFamilies();
-        VkCommandPoolCreateInfo poolInfo{};
-        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-        poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-        poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
-        auto err = vkCreateCommandPool(Vulkan::GetDevice(), &poolInfo, nullptr, &m_commandPool);
-        Vulkan::check_vk_result(err);
-    }
+    CreateCommandPool();
     
     if (!m_commandBuffer)
     {
@@ -760,7 +759,7 @@ void VulkanRenderer2D::BeginRenderPass()
         cmdBufAllocateInfo.commandPool = m_commandPool;
         cmdBufAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
         cmdBufAllocateInfo.commandBufferCount = 1;
-        auto err = vkAllocateCommandBuffers(Vulkan::GetDevice(), &cmdBufAllocateInfo, &m_commandBuffer);
+        auto err = vkAllocateCommandBuffers(RenderSys::Vulkan::GetDevice(), &cmdBufAllocateInfo, &m_commandBuffer);
         Vulkan::check_vk_result(err);
     }
     else
@@ -787,6 +786,24 @@ void VulkanRenderer2D::BeginRenderPass()
     rpInfo.pClearValues = clearValues;
 
     vkCmdBeginRenderPass(m_commandBuffer, &rpInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+    // the sprites of this frame go to the oldest buffer, once the frame that drew from it has completed
+    m_spriteFrame = (m_spriteFrame + 1) % SPRITE_BUFFER_FRAMES;
+    WaitForSpriteFrame();
+    m_spriteCount = 0;
+}
+
+void VulkanRenderer2D::CreateCommandPool()
+{
+    if (!m_commandPool)
+    {
+        VkCommandPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        poolInfo.queueFamilyIndex = RenderSys::Vulkan::GetQueueFamilyIndex();
+        auto err = vkCreateCommandPool(RenderSys::Vulkan::GetDevice(), &poolInfo, nullptr, &m_commandPool);
+        Vulkan::check_vk_result(err);
+    }
 }
 
 void VulkanRenderer2D::EndRenderPass()
@@ -798,6 +815,7 @@ void VulkanRenderer2D::EndRenderPass()
 void VulkanRenderer2D::Destroy()
 {
     DestroyBuffers();
+    DestroySprites();
 
     // Destroy VMA instance
     vmaDestroyAllocator(m_vma);
@@ -812,7 +830,472 @@ void VulkanRenderer2D::SubmitCommandBuffer()
     end_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
     end_info.commandBufferCount = 1;
     end_info.pCommandBuffers = &m_commandBuffer;
-    GraphicsAPI::Vulkan::QueueSubmit(end_info);
+    // submitted here and not with Vulkan::QueueSubmit(), the fence has to signal with this command buffer and
+    // the submission happens before the one of the frame of the application, which samples the rendered image
+    err = vkQueueSubmit(RenderSys::Vulkan::GetDeviceQueue(), 1, &end_info, m_spriteFences[m_spriteFrame]);
+    Vulkan::check_vk_result(err);
+    if (m_spriteFences[m_spriteFrame] != VK_NULL_HANDLE)
+    {
+        m_spriteFrameSubmitted[m_spriteFrame] = true;
+    }
+}
+
+void VulkanRenderer2D::CreateSpriteAtlas(const uint8_t* pixels, uint32_t width, uint32_t height)
+{
+    std::cout << "Creating sprite atlas..." << std::endl;
+    assert(pixels && width > 0 && height > 0);
+    assert(m_spriteAtlasImage == VK_NULL_HANDLE);
+    CreateCommandPool();
+
+    VkImageCreateInfo imageInfo = {};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    // the colors of the sprites are written unchanged into the UNORM image to render into
+    imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+    imageInfo.extent = {width, height, 1};
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VmaAllocationCreateInfo imageAllocInfo{};
+    imageAllocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+    if (vmaCreateImage(m_vma, &imageInfo, &imageAllocInfo, &m_spriteAtlasImage, &m_spriteAtlasMemory, nullptr) != VK_SUCCESS) {
+        std::cout << "vmaCreateImage() failed!" << std::endl;
+        return;
+    }
+
+    VkBufferCreateInfo stagingInfo = {};
+    stagingInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    stagingInfo.size = static_cast<VkDeviceSize>(width) * height * 4;
+    stagingInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    stagingInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    VmaAllocationCreateInfo stagingAllocInfo{};
+    stagingAllocInfo.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+    VkBuffer stagingBuffer = VK_NULL_HANDLE;
+    VmaAllocation stagingBufferMemory = VK_NULL_HANDLE;
+    if (vmaCreateBuffer(m_vma, &stagingInfo, &stagingAllocInfo, &stagingBuffer, &stagingBufferMemory, nullptr) != VK_SUCCESS) {
+        std::cout << "vkCreateBuffer() failed!" << std::endl;
+        return;
+    }
+
+    void *buf;
+    if (vmaMapMemory(m_vma, stagingBufferMemory, &buf) != VK_SUCCESS) {
+        std::cout << "vkMapMemory() failed" << std::endl;
+        vmaDestroyBuffer(m_vma, stagingBuffer, stagingBufferMemory);
+        return;
+    }
+    std::memcpy(buf, pixels, stagingInfo.size);
+    vmaUnmapMemory(m_vma, stagingBufferMemory);
+
+    RenderSys::Vulkan::TransitionImageLayout(m_spriteAtlasImage, imageInfo.format, 
+                                                VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, m_commandPool);
+    auto commandBuffer = RenderSys::Vulkan::BeginSingleTimeCommands(m_commandPool);
+    VkBufferImageCopy region{};
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = {width, height, 1};
+    vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, m_spriteAtlasImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    RenderSys::Vulkan::EndSingleTimeCommands(commandBuffer, m_commandPool);
+    RenderSys::Vulkan::TransitionImageLayout(m_spriteAtlasImage, imageInfo.format, 
+                                                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1, m_commandPool);
+    vmaDestroyBuffer(m_vma, stagingBuffer, stagingBufferMemory);
+
+    m_spriteAtlasView = RenderSys::Vulkan::CreateImageView(m_spriteAtlasImage, imageInfo.format, VK_IMAGE_ASPECT_COLOR_BIT);
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.maxAnisotropy = 1.0f;
+    if (vkCreateSampler(RenderSys::Vulkan::GetDevice(), &samplerInfo, nullptr, &m_spriteAtlasSampler) != VK_SUCCESS) {
+        std::cout << "error: could not create sampler for the sprite atlas" << std::endl;
+        return;
+    }
+
+    if (!m_spritePipeline)
+    {
+        CreateSpritePipeline();
+        CreateSpriteBuffer();
+    }
+
+    VkDescriptorImageInfo atlasInfo{};
+    atlasInfo.sampler = m_spriteAtlasSampler;
+    atlasInfo.imageView = m_spriteAtlasView;
+    atlasInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkWriteDescriptorSet descriptorWrite{};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = m_spriteBindGroup;
+    descriptorWrite.dstBinding = 0;
+    descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.pImageInfo = &atlasInfo;
+    vkUpdateDescriptorSets(RenderSys::Vulkan::GetDevice(), 1, &descriptorWrite, 0, nullptr);
+
+    std::cout << "Sprite atlas: " << m_spriteAtlasImage << ", " << width << "x" << height << std::endl;
+}
+
+void VulkanRenderer2D::CreateSpritePipeline()
+{
+    std::cout << "Creating sprite pipeline..." << std::endl;
+
+    VkDescriptorSetLayoutBinding atlasBinding{};
+    atlasBinding.binding = 0;
+    atlasBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    atlasBinding.descriptorCount = 1;
+    atlasBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &atlasBinding;
+    if (vkCreateDescriptorSetLayout(RenderSys::Vulkan::GetDevice(), &layoutInfo, nullptr, &m_spriteBindGroupLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor set layout!");
+    }
+
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSize.descriptorCount = 1;
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = 1;
+    if (vkCreateDescriptorPool(RenderSys::Vulkan::GetDevice(), &poolInfo, nullptr, &m_spriteBindGroupPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor pool!");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_spriteBindGroupPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &m_spriteBindGroupLayout;
+    if (vkAllocateDescriptorSets(RenderSys::Vulkan::GetDevice(), &allocInfo, &m_spriteBindGroup) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate descriptor sets!");
+    }
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(glm::mat4);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
+    pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutCreateInfo.setLayoutCount = 1;
+    pipelineLayoutCreateInfo.pSetLayouts = &m_spriteBindGroupLayout;
+    pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+    pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+    if (vkCreatePipelineLayout(RenderSys::Vulkan::GetDevice(), &pipelineLayoutCreateInfo, nullptr, &m_spritePipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline layout!");
+    }
+
+    // one RenderSys::SpriteInstance per instance
+    VkVertexInputBindingDescription instanceBinding{};
+    instanceBinding.binding = 0;
+    instanceBinding.stride = sizeof(RenderSys::SpriteInstance);
+    instanceBinding.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+    const std::array<VkVertexInputAttributeDescription, 5> instanceAttributes{
+        VkVertexInputAttributeDescription{0, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(RenderSys::SpriteInstance, m_Center)},
+        VkVertexInputAttributeDescription{1, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(RenderSys::SpriteInstance, m_AxisX)},
+        VkVertexInputAttributeDescription{2, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(RenderSys::SpriteInstance, m_AxisY)},
+        VkVertexInputAttributeDescription{3, 0, VK_FORMAT_R16G16B16A16_UNORM, offsetof(RenderSys::SpriteInstance, m_Region)},
+        VkVertexInputAttributeDescription{4, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(RenderSys::SpriteInstance, m_Color)}
+    };
+
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInputInfo.vertexBindingDescriptionCount = 1;
+    vertexInputInfo.pVertexBindingDescriptions = &instanceBinding;
+    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(instanceAttributes.size());
+    vertexInputInfo.pVertexAttributeDescriptions = instanceAttributes.data();
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssemblyInfo{};
+    inputAssemblyInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssemblyInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    inputAssemblyInfo.primitiveRestartEnable = VK_FALSE;
+
+    VkPipelineViewportStateCreateInfo viewportStateInfo{};
+    viewportStateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportStateInfo.viewportCount = 1;
+    viewportStateInfo.scissorCount = 1;
+
+    VkPipelineRasterizationStateCreateInfo rasterizerInfo{};
+    rasterizerInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizerInfo.depthClampEnable = VK_FALSE;
+    rasterizerInfo.rasterizerDiscardEnable = VK_FALSE;
+    rasterizerInfo.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizerInfo.lineWidth = 1.0f;
+    // mirrored sprites and lines in either direction flip the winding
+    rasterizerInfo.cullMode = VK_CULL_MODE_NONE;
+    rasterizerInfo.frontFace = VK_FRONT_FACE_CLOCKWISE;
+    rasterizerInfo.depthBiasEnable = VK_FALSE;
+
+    VkPipelineMultisampleStateCreateInfo multisamplingInfo{};
+    multisamplingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisamplingInfo.sampleShadingEnable = VK_FALSE;
+    multisamplingInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    // drawn in submission order, later sprites blend over the earlier ones
+    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                                            VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    colorBlendAttachment.blendEnable = VK_TRUE;
+    colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+    VkPipelineColorBlendStateCreateInfo colorBlendingInfo{};
+    colorBlendingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlendingInfo.logicOpEnable = VK_FALSE;
+    colorBlendingInfo.logicOp = VK_LOGIC_OP_COPY;
+    colorBlendingInfo.attachmentCount = 1;
+    colorBlendingInfo.pAttachments = &colorBlendAttachment;
+
+    std::vector<VkDynamicState> dynStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+    VkPipelineDynamicStateCreateInfo dynStatesInfo{};
+    dynStatesInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynStatesInfo.dynamicStateCount = static_cast<uint32_t>(dynStates.size());
+    dynStatesInfo.pDynamicStates = dynStates.data();
+
+    std::array<VkPipelineShaderStageCreateInfo, 2> shaderStageInfos{};
+    shaderStageInfos[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStageInfos[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    shaderStageInfos[0].module = LoadShader("sprite-batch-vertex.glsl", RenderSys::ShaderStage::Vertex);
+    shaderStageInfos[0].pName = "main";
+    shaderStageInfos[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStageInfos[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    shaderStageInfos[1].module = LoadShader("sprite-batch-fragment.glsl", RenderSys::ShaderStage::Fragment);
+    shaderStageInfos[1].pName = "main";
+    assert(shaderStageInfos[0].module != VK_NULL_HANDLE && shaderStageInfos[1].module != VK_NULL_HANDLE);
+
+    // the render pass has no depth attachment
+    VkGraphicsPipelineCreateInfo pipelineCreateInfo{};
+    pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineCreateInfo.stageCount = static_cast<uint32_t>(shaderStageInfos.size());
+    pipelineCreateInfo.pStages = shaderStageInfos.data();
+    pipelineCreateInfo.pVertexInputState = &vertexInputInfo;
+    pipelineCreateInfo.pInputAssemblyState = &inputAssemblyInfo;
+    pipelineCreateInfo.pViewportState = &viewportStateInfo;
+    pipelineCreateInfo.pRasterizationState = &rasterizerInfo;
+    pipelineCreateInfo.pMultisampleState = &multisamplingInfo;
+    pipelineCreateInfo.pColorBlendState = &colorBlendingInfo;
+    pipelineCreateInfo.pDepthStencilState = nullptr;
+    pipelineCreateInfo.pDynamicState = &dynStatesInfo;
+    pipelineCreateInfo.layout = m_spritePipelineLayout;
+    pipelineCreateInfo.renderPass = m_renderpass;
+    pipelineCreateInfo.subpass = 0;
+    pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+    if (vkCreateGraphicsPipelines(RenderSys::Vulkan::GetDevice(), VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_spritePipeline) != VK_SUCCESS) {
+        std::cout << "error: could not create sprite pipeline" << std::endl;
+    }
+
+    for (auto& shaderStageInfo : shaderStageInfos)
+    {
+        vkDestroyShaderModule(RenderSys::Vulkan::GetDevice(), shaderStageInfo.module, nullptr);
+    }
+
+    std::cout << "Sprite pipeline: " << m_spritePipeline << std::endl;
+}
+
+void VulkanRenderer2D::CreateSpriteBuffer()
+{
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = static_cast<VkDeviceSize>(RenderSys::SpriteBatch::MAX_SPRITES) * sizeof(RenderSys::SpriteInstance);
+    bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    VmaAllocationCreateInfo vmaAllocInfo{};
+    vmaAllocInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    // the batches of a frame write into one buffer while the GPU may still draw from the buffers of the frames before
+    for (uint32_t frame = 0; frame < SPRITE_BUFFER_FRAMES; frame++)
+    {
+        if (vmaCreateBuffer(m_vma, &bufferInfo, &vmaAllocInfo, &m_spriteBuffers[frame], &m_spriteBufferMemory[frame], nullptr) != VK_SUCCESS) {
+            std::cout << "vkCreateBuffer() failed!" << std::endl;
+            return;
+        }
+
+        // persistently mapped, the batches write their instances straight into it
+        void *buf;
+        if (vmaMapMemory(m_vma, m_spriteBufferMemory[frame], &buf) != VK_SUCCESS) {
+            std::cout << "vkMapMemory() failed" << std::endl;
+            return;
+        }
+        m_mappedSprites[frame] = static_cast<RenderSys::SpriteInstance*>(buf);
+
+        auto err = vkCreateFence(RenderSys::Vulkan::GetDevice(), &fenceInfo, nullptr, &m_spriteFences[frame]);
+        Vulkan::check_vk_result(err);
+    }
+    std::cout << "Sprite buffers: " << SPRITE_BUFFER_FRAMES << " x " << RenderSys::SpriteBatch::MAX_SPRITES << " sprites" << std::endl;
+}
+
+void VulkanRenderer2D::WaitForSpriteFrame()
+{
+    if (!m_spriteFrameSubmitted[m_spriteFrame])
+    {
+        return;
+    }
+    auto err = vkWaitForFences(RenderSys::Vulkan::GetDevice(), 1, &m_spriteFences[m_spriteFrame], VK_TRUE, UINT64_MAX);
+    Vulkan::check_vk_result(err);
+    err = vkResetFences(RenderSys::Vulkan::GetDevice(), 1, &m_spriteFences[m_spriteFrame]);
+    Vulkan::check_vk_result(err);
+    m_spriteFrameSubmitted[m_spriteFrame] = false;
+}
+
+VkShaderModule VulkanRenderer2D::LoadShader(const std::string& fileName, const RenderSys::ShaderStage& stage)
+{
+    const auto shaderDir = std::string(RENDERSYS_SHADER_DIR);
+    std::ifstream file(shaderDir + "/" + fileName, std::ios::binary);
+    std::vector<char> content((std::istreambuf_iterator<char>(file)),
+                                std::istreambuf_iterator<char>());
+    if (!file.is_open()) {
+        std::cerr << "Unable to open file - " << fileName << std::endl;
+        return VK_NULL_HANDLE;
+    }
+
+    RenderSys::Shader shader(fileName, std::string(content.data(), content.size()));
+    shader.type = RenderSys::ShaderType::SPIRV;
+    shader.stage = stage;
+    shader.SetIncludeDirectory(shaderDir);
+    const bool compiled = shader.Compile();
+    assert(compiled);
+    const auto& compiledShader = shader.GetCompiledShader();
+
+    VkShaderModuleCreateInfo shaderCreateInfo{};
+    shaderCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    shaderCreateInfo.codeSize = sizeof(uint32_t) * compiledShader.size();
+    shaderCreateInfo.pCode = compiledShader.data();
+
+    VkShaderModule shaderModule = VK_NULL_HANDLE;
+    if (vkCreateShaderModule(RenderSys::Vulkan::GetDevice(), &shaderCreateInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+        std::cout << "could not load shader " << fileName << std::endl;
+        return VK_NULL_HANDLE;
+    }
+    return shaderModule;
+}
+
+RenderSys::SpriteInstance* VulkanRenderer2D::MapSprites(uint32_t& capacity)
+{
+    if (!m_mappedSprites[m_spriteFrame])
+    {
+        // without an atlas every sprite is dropped
+        capacity = 0;
+        return nullptr;
+    }
+    capacity = RenderSys::SpriteBatch::MAX_SPRITES - m_spriteCount;
+    return m_mappedSprites[m_spriteFrame] + m_spriteCount;
+}
+
+void VulkanRenderer2D::DrawSprites(uint32_t spriteCount, const glm::mat4& viewProjection)
+{
+    if (spriteCount == 0)
+    {
+        return;
+    }
+    assert(m_spritePipeline != VK_NULL_HANDLE);
+    assert(m_spriteCount + spriteCount <= RenderSys::SpriteBatch::MAX_SPRITES);
+
+    vkCmdBindPipeline(m_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_spritePipeline);
+
+    VkViewport viewport{};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = static_cast<float>(m_width);
+    viewport.height = static_cast<float>(m_height);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(m_commandBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor{};
+    scissor.offset = { 0, 0 };
+    scissor.extent = { m_width, m_height };
+    vkCmdSetScissor(m_commandBuffer, 0, 1, &scissor);
+
+    vkCmdBindDescriptorSets(m_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_spritePipelineLayout, 0, 1, &m_spriteBindGroup, 0, nullptr);
+    vkCmdPushConstants(m_commandBuffer, m_spritePipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &viewProjection);
+
+    // the instances of the batch follow the ones of the earlier batches of the frame
+    VkDeviceSize offset = 0;
+    vkCmdBindVertexBuffers(m_commandBuffer, 0, 1, &m_spriteBuffers[m_spriteFrame], &offset);
+    vkCmdDraw(m_commandBuffer, 6, spriteCount, 0, m_spriteCount);
+    m_spriteCount += spriteCount;
+}
+
+void VulkanRenderer2D::DestroySprites()
+{
+    for (uint32_t frame = 0; frame < SPRITE_BUFFER_FRAMES; frame++)
+    {
+        m_spriteFrame = frame;
+        WaitForSpriteFrame();
+        if (m_spriteFences[frame] != VK_NULL_HANDLE)
+        {
+            vkDestroyFence(RenderSys::Vulkan::GetDevice(), m_spriteFences[frame], nullptr);
+            m_spriteFences[frame] = VK_NULL_HANDLE;
+        }
+        if (m_spriteBuffers[frame] != VK_NULL_HANDLE && m_spriteBufferMemory[frame] != VK_NULL_HANDLE)
+        {
+            vmaUnmapMemory(m_vma, m_spriteBufferMemory[frame]);
+            vmaDestroyBuffer(m_vma, m_spriteBuffers[frame], m_spriteBufferMemory[frame]);
+            m_spriteBuffers[frame] = VK_NULL_HANDLE;
+            m_spriteBufferMemory[frame] = VK_NULL_HANDLE;
+            m_mappedSprites[frame] = nullptr;
+        }
+    }
+    m_spriteFrame = 0;
+    if (m_spritePipeline != VK_NULL_HANDLE)
+    {
+        vkDestroyPipeline(RenderSys::Vulkan::GetDevice(), m_spritePipeline, nullptr);
+        m_spritePipeline = VK_NULL_HANDLE;
+    }
+    if (m_spritePipelineLayout != VK_NULL_HANDLE)
+    {
+        vkDestroyPipelineLayout(RenderSys::Vulkan::GetDevice(), m_spritePipelineLayout, nullptr);
+        m_spritePipelineLayout = VK_NULL_HANDLE;
+    }
+    if (m_spriteBindGroupPool != VK_NULL_HANDLE)
+    {
+        // frees m_spriteBindGroup
+        vkDestroyDescriptorPool(RenderSys::Vulkan::GetDevice(), m_spriteBindGroupPool, nullptr);
+        m_spriteBindGroupPool = VK_NULL_HANDLE;
+        m_spriteBindGroup = VK_NULL_HANDLE;
+    }
+    if (m_spriteBindGroupLayout != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorSetLayout(RenderSys::Vulkan::GetDevice(), m_spriteBindGroupLayout, nullptr);
+        m_spriteBindGroupLayout = VK_NULL_HANDLE;
+    }
+    if (m_spriteAtlasSampler != VK_NULL_HANDLE)
+    {
+        vkDestroySampler(RenderSys::Vulkan::GetDevice(), m_spriteAtlasSampler, nullptr);
+        m_spriteAtlasSampler = VK_NULL_HANDLE;
+    }
+    if (m_spriteAtlasView != VK_NULL_HANDLE)
+    {
+        vkDestroyImageView(RenderSys::Vulkan::GetDevice(), m_spriteAtlasView, nullptr);
+        m_spriteAtlasView = VK_NULL_HANDLE;
+    }
+    if (m_spriteAtlasImage != VK_NULL_HANDLE)
+    {
+        vmaDestroyImage(m_vma, m_spriteAtlasImage, m_spriteAtlasMemory);
+        m_spriteAtlasImage = VK_NULL_HANDLE;
+        m_spriteAtlasMemory = VK_NULL_HANDLE;
+    }
 }
 
 } // namespace GraphicsAPI
\ No newline at end of file
@@ -2,12 +2,14 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <array>
 #include <glm/ext.hpp>
 #include <vk_mem_alloc.h>
 #include <Walnut/GraphicsAPI/VulkanGraphics.h>
 
 #include <RenderSys/RenderUtil.h>
 #include <RenderSys/Shader.h>
+#include <RenderSys/SpriteBatch.h>
 
 namespace GraphicsAPI
 {
@@ -36,12 +38,25 @@ namespace GraphicsAPI
         void BeginRenderPass();
         void EndRenderPass();
         void Destroy();
+
+        // uploads the RGBA8 atlas of the sprites, creates the sprite pipeline and instance buffer the first time
+        void CreateSpriteAtlas(const uint8_t* pixels, uint32_t width, uint32_t height);
+        // the free part of the persistently mapped instance buffer of this frame
+        RenderSys::SpriteInstance* MapSprites(uint32_t& capacity);
+        // draws the spriteCount instances written since the last call with one draw call
+        void DrawSprites(uint32_t spriteCount, const glm::mat4& viewProjection);
     private:
         void CreateBindGroup();
         void CreatePipelineLayout();
         bool CreateRenderPass();
+        void CreateCommandPool();
+        void CreateSpritePipeline();
+        void CreateSpriteBuffer();
+        void WaitForSpriteFrame();
+        VkShaderModule LoadShader(const std::string& fileName, const RenderSys::ShaderStage& stage);
         void DestroyBuffers();
         void DestroyShaders();
+        void DestroySprites();
         void SubmitCommandBuffer();
 
         uint32_t m_width = 0;
@@ -79,6 +94,27 @@ namespace GraphicsAPI
         std::vector<VmaAllocation> m_uniformBuffersMemory;
         std::vector<void*> m_uniformBuffersMapped;
 
+        // sprites, one atlas and one instance buffer per frame in flight shared by all batches of a frame
+        static constexpr uint32_t SPRITE_BUFFER_FRAMES = 3;
+        VkImage m_spriteAtlasImage = VK_NULL_HANDLE;
+        VmaAllocation m_spriteAtlasMemory = VK_NULL_HANDLE;
+        VkImageView m_spriteAtlasView = VK_NULL_HANDLE;
+        VkSampler m_spriteAtlasSampler = VK_NULL_HANDLE;
+        VkDescriptorSetLayout m_spriteBindGroupLayout = VK_NULL_HANDLE;
+        VkDescriptorPool m_spriteBindGroupPool = VK_NULL_HANDLE;
+        VkDescriptorSet m_spriteBindGroup = VK_NULL_HANDLE;
+        VkPipelineLayout m_spritePipelineLayout = VK_NULL_HANDLE;
+        VkPipeline m_spritePipeline = VK_NULL_HANDLE;
+        std::array<VkBuffer, SPRITE_BUFFER_FRAMES> m_spriteBuffers{};
+        std::array<VmaAllocation, SPRITE_BUFFER_FRAMES> m_spriteBufferMemory{};
+        std::array<RenderSys::SpriteInstance*, SPRITE_BUFFER_FRAMES> m_mappedSprites{};
+        // signaled once the frame that drew from the buffer of the same index has completed
+        std::array<VkFence, SPRITE_BUFFER_FRAMES> m_spriteFences{};
+        std::array<bool, SPRITE_BUFFER_FRAMES> m_spriteFrameSubmitted{};
+        uint32_t m_spriteFrame = 0;
+        // instances written to the buffer of this frame
+        uint32_t m_spriteCount = 0;
+
         VmaAllocator m_vma = VK_NULL_HANDLE;
     };
 }
\ No newline at end of file
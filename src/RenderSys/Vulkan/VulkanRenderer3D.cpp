@@ -1,4 +1,5 @@
 #include "VulkanRenderer3D.h"
+#include "VulkanDevice.h"
 
 #include "VulkanRendererUtils.h"
 #include "VulkanMemAlloc.h"
@@ -6,16 +7,24 @@
 #include "VulkanMaterial.h"
 #include "VulkanResource.h"
 #include "VulkanShadowMap.h"
+#include "VulkanQueryProfiler.h"
 #include "Pipeline/VulkanPbrRenderPipeline.h"
 #include "Pipeline/VulkanShadowRenderPipeline.h"
+#include "Pipeline/VulkanSkinningComputePipeline.h"
+#include "Pipeline/VulkanHzbCullingPipeline.h"
+#include "Pipeline/VulkanMeshletCullingPipeline.h"
 
 #include <RenderSys/Components/MeshComponent.h>
 #include <RenderSys/Components/TransformComponent.h>
 #include <RenderSys/Components/TagAndIDComponents.h>
+#include <RenderSys/Components/AnimationComponents.h>
 #include <RenderSys/Material.h>
 #include <RenderSys/MaterialFeatures.h>
 
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <fstream>
 #include <iostream>
 
 namespace RenderSys
@@ -33,9 +42,15 @@ bool VulkanRenderer3D::Init()
 {
     CreateRenderPass();
     CreateCommandBuffers();
+    m_queryProfiler = std::make_unique<Vulkan::QueryProfiler>("Renderer3D");
     CreateDefaultTextureSampler();
     RenderSys::CreateMaterialBindGroupPool();
     RenderSys::CreateMaterialBindGroupLayout();
+    if (RenderSys::IsBindlessMaterialSupported())
+    {
+        // every material is added to it as well, so it has to exist before the first one is created
+        RenderSys::CreateBindlessMaterialBindGroup();
+    }
     RenderSys::CreateResourceBindGroupPool();
     RenderSys::CreateResourceBindGroupLayout();
     return true;
@@ -55,7 +70,9 @@ void VulkanRenderer3D::CreateImageToRender(uint32_t width, uint32_t height)
     renderImageInfo.arrayLayers = 1;
     renderImageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
     renderImageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-    renderImageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    // copied to the CPU side by the readbacks
+    renderImageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT 
+                            | VK_IMAGE_USAGE_SAMPLED_BIT;
     renderImageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
     renderImageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
@@ -69,10 +86,15 @@ void VulkanRenderer3D::CreateImageToRender(uint32_t width, uint32_t height)
     }
 
     m_imageViewToRenderInto = RenderSys::Vulkan::CreateImageView(m_ImageToRenderInto, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT);
-    m_finalImageDescriptorSet = (VkDescriptorSet)ImGui_ImplVulkan_AddTexture(m_defaultTextureSampler, m_imageViewToRenderInto, VK_IMAGE_LAYOUT_GENERAL);
+    // a headless device has no ImGui, the image is only read back
+    if (!RenderSys::Vulkan::IsHeadless())
+    {
+        m_finalImageDescriptorSet = (VkDescriptorSet)ImGui_ImplVulkan_AddTexture(m_defaultTextureSampler, m_imageViewToRenderInto, VK_IMAGE_LAYOUT_GENERAL);
+    }
 
     // create image copy staging buffer for cpu image copy
     CreateImageCopyBuffers();
+    CreateImageReadbacks();
 }
 
 void VulkanRenderer3D::CreateDepthImage()
@@ -86,7 +108,8 @@ void VulkanRenderer3D::CreateDepthImage()
     depthImageInfo.arrayLayers = 1;
     depthImageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
     depthImageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-    depthImageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+    // sampled by the reduction into the depth pyramid of the occlusion culling
+    depthImageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
     depthImageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
     depthImageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
@@ -100,6 +123,10 @@ void VulkanRenderer3D::CreateDepthImage()
     }
 
     m_depthimageView = RenderSys::Vulkan::CreateImageView(m_depthimage, Vulkan::GetDepthFormat(), VK_IMAGE_ASPECT_DEPTH_BIT);
+    if (m_hzbCullingPipeline)
+    {
+        m_hzbCullingPipeline->CreateDepthPyramid(m_depthimageView, m_width, m_height);
+    }
 }
 
 void VulkanRenderer3D::CreateShader(RenderSys::Shader& shader)
@@ -139,7 +166,7 @@ void VulkanRenderer3D::CreateShader(RenderSys::Shader& shader)
 std::shared_ptr<VkPipelineShaderStageCreateInfo> VulkanRenderer3D::CreateShaderModule(const VkShaderModuleCreateInfo& shaderModuleCreateInfo, const RenderSys::ShaderStage& stage)
 {
     VkShaderModule shaderModule = VK_NULL_HANDLE;
-    if (vkCreateShaderModule(GraphicsAPI::Vulkan::GetDevice(), &shaderModuleCreateInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+    if (vkCreateShaderModule(RenderSys::Vulkan::GetDevice(), &shaderModuleCreateInfo, nullptr, &shaderModule) != VK_SUCCESS) {
         std::cout << "could not load vertex shader" << std::endl;
         return nullptr;
     }
@@ -156,6 +183,9 @@ std::shared_ptr<VkPipelineShaderStageCreateInfo> VulkanRenderer3D::CreateShaderM
     else if (stage == RenderSys::ShaderStage::Fragment) {
         shaderStageBits = VK_SHADER_STAGE_FRAGMENT_BIT;
     }
+    else if (stage == RenderSys::ShaderStage::Compute) {
+        shaderStageBits = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
     else {
         return nullptr;
     }
@@ -170,23 +200,27 @@ std::shared_ptr<VkPipelineShaderStageCreateInfo> VulkanRenderer3D::CreateShaderM
 
 void VulkanRenderer3D::DestroyImages()
 {
+    // the readbacks of submitted frames are still delivered, the rendered image is about to change its size
+    WaitRenderedImages();
+    DestroyImageReadbacks();
+
     if (m_finalImageDescriptorSet)
     {
-        vkQueueWaitIdle(GraphicsAPI::Vulkan::GetDeviceQueue());
+        vkQueueWaitIdle(RenderSys::Vulkan::GetDeviceQueue());
         ImGui_ImplVulkan_RemoveTexture(m_finalImageDescriptorSet);
         m_finalImageDescriptorSet = VK_NULL_HANDLE;
     }
 
     if (m_frameBuffer)
     {
-        vkDeviceWaitIdle(GraphicsAPI::Vulkan::GetDevice());
-        vkDestroyFramebuffer(GraphicsAPI::Vulkan::GetDevice(), m_frameBuffer, nullptr);
+        vkDeviceWaitIdle(RenderSys::Vulkan::GetDevice());
+        vkDestroyFramebuffer(RenderSys::Vulkan::GetDevice(), m_frameBuffer, nullptr);
         m_frameBuffer = VK_NULL_HANDLE;
     }
     
     if (m_imageViewToRenderInto != VK_NULL_HANDLE)
     {
-        vkDestroyImageView(GraphicsAPI::Vulkan::GetDevice(), m_imageViewToRenderInto, nullptr);
+        vkDestroyImageView(RenderSys::Vulkan::GetDevice(), m_imageViewToRenderInto, nullptr);
         m_imageViewToRenderInto = VK_NULL_HANDLE;
     }
     if (m_ImageToRenderInto != VK_NULL_HANDLE)
@@ -195,9 +229,13 @@ void VulkanRenderer3D::DestroyImages()
         m_ImageToRenderInto = VK_NULL_HANDLE;
     }
 
+    if (m_hzbCullingPipeline)
+    {
+        m_hzbCullingPipeline->DestroyDepthPyramid();
+    }
     if (m_depthimageView != VK_NULL_HANDLE)
     {
-        vkDestroyImageView(GraphicsAPI::Vulkan::GetDevice(), m_depthimageView, nullptr);
+        vkDestroyImageView(RenderSys::Vulkan::GetDevice(), m_depthimageView, nullptr);
         m_depthimageView = VK_NULL_HANDLE;
     }
     if (m_depthimage != VK_NULL_HANDLE)
@@ -217,18 +255,19 @@ void VulkanRenderer3D::DestroyBindGroup()
 {
     if (m_mainBindGroup && m_bindGroupPool)
     {
-        vkDeviceWaitIdle(GraphicsAPI::Vulkan::GetDevice());
+        vkDeviceWaitIdle(RenderSys::Vulkan::GetDevice());
         // when you destroy a descriptor pool, all descriptor sets allocated from that pool are automatically destroyed
-        vkDestroyDescriptorPool(GraphicsAPI::Vulkan::GetDevice(), m_bindGroupPool, nullptr);
+        vkDestroyDescriptorPool(RenderSys::Vulkan::GetDevice(), m_bindGroupPool, nullptr);
         m_mainBindGroup = VK_NULL_HANDLE;
         m_bindGroupPool = VK_NULL_HANDLE;
     }
 
     if (m_mainBindGroupLayout)
     {
-        vkDestroyDescriptorSetLayout(GraphicsAPI::Vulkan::GetDevice(), m_mainBindGroupLayout, nullptr);
+        vkDestroyDescriptorSetLayout(RenderSys::Vulkan::GetDevice(), m_mainBindGroupLayout, nullptr);
         m_mainBindGroupLayout = VK_NULL_HANDLE;
     }
+    m_shadowMapBinding = NO_SHADOW_MAP_BINDING;
 }
 
 void VulkanRenderer3D::DestroyBuffers()
@@ -248,6 +287,38 @@ void VulkanRenderer3D::DestroyBuffers()
             vertexIndexBufferInfo->m_indexBuffer = VK_NULL_HANDLE;
             vertexIndexBufferInfo->m_indexBufferMemory = VK_NULL_HANDLE;
         }
+
+        if (vertexIndexBufferInfo->m_skinningDataBuffer != VK_NULL_HANDLE && vertexIndexBufferInfo->m_skinningDataBufferMemory != VK_NULL_HANDLE)
+        {
+            vmaDestroyBuffer(RenderSys::Vulkan::GetMemoryAllocator(), vertexIndexBufferInfo->m_skinningDataBuffer, vertexIndexBufferInfo->m_skinningDataBufferMemory);
+            vertexIndexBufferInfo->m_skinningDataBuffer = VK_NULL_HANDLE;
+            vertexIndexBufferInfo->m_skinningDataBufferMemory = VK_NULL_HANDLE;
+        }
+
+        if (vertexIndexBufferInfo->m_skinnedVertexBuffer != VK_NULL_HANDLE && vertexIndexBufferInfo->m_skinnedVertexBufferMemory != VK_NULL_HANDLE)
+        {
+            vmaDestroyBuffer(RenderSys::Vulkan::GetMemoryAllocator(), vertexIndexBufferInfo->m_skinnedVertexBuffer, vertexIndexBufferInfo->m_skinnedVertexBufferMemory);
+            vertexIndexBufferInfo->m_skinnedVertexBuffer = VK_NULL_HANDLE;
+            vertexIndexBufferInfo->m_skinnedVertexBufferMemory = VK_NULL_HANDLE;
+        }
+        // freed together with the descriptor pool of the skinning pipeline
+        vertexIndexBufferInfo->m_skinningBindGroup = VK_NULL_HANDLE;
+
+        if (vertexIndexBufferInfo->m_meshletBuffer != VK_NULL_HANDLE && vertexIndexBufferInfo->m_meshletBufferMemory != VK_NULL_HANDLE)
+        {
+            vmaDestroyBuffer(RenderSys::Vulkan::GetMemoryAllocator(), vertexIndexBufferInfo->m_meshletBuffer, vertexIndexBufferInfo->m_meshletBufferMemory);
+            vertexIndexBufferInfo->m_meshletBuffer = VK_NULL_HANDLE;
+            vertexIndexBufferInfo->m_meshletBufferMemory = VK_NULL_HANDLE;
+        }
+
+        if (vertexIndexBufferInfo->m_culledIndexBuffer != VK_NULL_HANDLE && vertexIndexBufferInfo->m_culledIndexBufferMemory != VK_NULL_HANDLE)
+        {
+            vmaDestroyBuffer(RenderSys::Vulkan::GetMemoryAllocator(), vertexIndexBufferInfo->m_culledIndexBuffer, vertexIndexBufferInfo->m_culledIndexBufferMemory);
+            vertexIndexBufferInfo->m_culledIndexBuffer = VK_NULL_HANDLE;
+            vertexIndexBufferInfo->m_culledIndexBufferMemory = VK_NULL_HANDLE;
+        }
+        // freed together with the descriptor pool of the meshlet culling pipeline
+        vertexIndexBufferInfo->m_meshletBindGroup = VK_NULL_HANDLE;
     }
     m_vertexIndexBufferInfoMap.clear();
 
@@ -265,13 +336,19 @@ void VulkanRenderer3D::DestroyBuffers()
         RenderSys::Vulkan::DestroyCommandPool();
     }   
     m_commandBuffer = VK_NULL_HANDLE; 
+    if (m_frameFence != VK_NULL_HANDLE)
+    {
+        vkDestroyFence(RenderSys::Vulkan::GetDevice(), m_frameFence, nullptr);
+        m_frameFence = VK_NULL_HANDLE;
+        m_frameSubmitted = false;
+    }
 }
 
 void VulkanRenderer3D::DestroyShaders()
 {
     for (auto& shaderStageInfo : m_shaderStageInfos)
     {
-        vkDestroyShaderModule(GraphicsAPI::Vulkan::GetDevice(), shaderStageInfo.module, nullptr);
+        vkDestroyShaderModule(RenderSys::Vulkan::GetDevice(), shaderStageInfo.module, nullptr);
     }
 
     m_shaderStageInfos.clear();
@@ -288,6 +365,11 @@ void VulkanRenderer3D::CreateBindGroup(const std::vector<RenderSys::BindGroupLay
     {
         auto vkBinding = RenderSys::Vulkan::GetVulkanBindGroupLayoutEntry(bindGroupLayoutEntry);
         mainBindGroupBindings.push_back(vkBinding);
+        if (bindGroupLayoutEntry.texture.sampleType == RenderSys::TextureSampleType::Depth &&
+            bindGroupLayoutEntry.texture.viewDimension == RenderSys::TextureViewDimension::_2DArray)
+        {
+            m_shadowMapBinding = bindGroupLayoutEntry.binding;
+        }
 
         auto mapIter = descriptorTypeCountMap.find(vkBinding.descriptorType);
         if (mapIter != descriptorTypeCountMap.end())
@@ -305,7 +387,7 @@ void VulkanRenderer3D::CreateBindGroup(const std::vector<RenderSys::BindGroupLay
     layoutInfo.bindingCount = mainBindGroupBindings.size();
     layoutInfo.pBindings = mainBindGroupBindings.data();
 
-    if (vkCreateDescriptorSetLayout(GraphicsAPI::Vulkan::GetDevice(), &layoutInfo, nullptr, &m_mainBindGroupLayout) != VK_SUCCESS) {
+    if (vkCreateDescriptorSetLayout(RenderSys::Vulkan::GetDevice(), &layoutInfo, nullptr, &m_mainBindGroupLayout) != VK_SUCCESS) {
         throw std::runtime_error("failed to create descriptor set layout!");
     }
 
@@ -321,7 +403,7 @@ void VulkanRenderer3D::CreateBindGroup(const std::vector<RenderSys::BindGroupLay
     poolInfo.pPoolSizes = poolSizes.data();
     poolInfo.maxSets = 1;
 
-    if (vkCreateDescriptorPool(GraphicsAPI::Vulkan::GetDevice(), &poolInfo, nullptr, &m_bindGroupPool) != VK_SUCCESS) {
+    if (vkCreateDescriptorPool(RenderSys::Vulkan::GetDevice(), &poolInfo, nullptr, &m_bindGroupPool) != VK_SUCCESS) {
         throw std::runtime_error("failed to create descriptor pool!");
     }
 
@@ -331,12 +413,17 @@ void VulkanRenderer3D::CreateBindGroup(const std::vector<RenderSys::BindGroupLay
     allocInfo.descriptorSetCount = 1;
     allocInfo.pSetLayouts = &m_mainBindGroupLayout;
 
-    if (vkAllocateDescriptorSets(GraphicsAPI::Vulkan::GetDevice(), &allocInfo, &m_mainBindGroup) != VK_SUCCESS) {
+    if (vkAllocateDescriptorSets(RenderSys::Vulkan::GetDevice(), &allocInfo, &m_mainBindGroup) != VK_SUCCESS) {
         throw std::runtime_error("failed to allocate descriptor sets!");
     }
 
     for (auto& bindGroupBinding : mainBindGroupBindings)
     {
+        if (bindGroupBinding.binding == m_shadowMapBinding)
+        {
+            continue;
+        }
+
         VkWriteDescriptorSet descriptorWrite{};
         descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
         descriptorWrite.dstSet = m_mainBindGroup;
@@ -375,20 +462,27 @@ void VulkanRenderer3D::CreateBindGroup(const std::vector<RenderSys::BindGroupLay
             descriptorWrite.pImageInfo = &imageInfo;
         }
         
-        vkUpdateDescriptorSets(GraphicsAPI::Vulkan::GetDevice(), 1, &descriptorWrite, 0, nullptr);
+        vkUpdateDescriptorSets(RenderSys::Vulkan::GetDevice(), 1, &descriptorWrite, 0, nullptr);
     }
+    WriteShadowMapBinding();
 }
 
 void VulkanRenderer3D::CreateRenderPass()
+{
+    m_renderpass = CreateMainRenderPass(false);
+    m_loadRenderpass = CreateMainRenderPass(true);
+}
+
+VkRenderPass VulkanRenderer3D::CreateMainRenderPass(const bool loadAttachments)
 {
     VkAttachmentDescription colorAtt{};
     colorAtt.format = VK_FORMAT_R8G8B8A8_UNORM;
     colorAtt.samples = VK_SAMPLE_COUNT_1_BIT;
-    colorAtt.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    colorAtt.loadOp = loadAttachments ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
     colorAtt.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
     colorAtt.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAtt.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    colorAtt.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    colorAtt.initialLayout = loadAttachments ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_UNDEFINED;
     colorAtt.finalLayout = VK_IMAGE_LAYOUT_GENERAL;
 
     VkAttachmentReference colorAttRef{};
@@ -399,11 +493,12 @@ void VulkanRenderer3D::CreateRenderPass()
     depthAtt.flags = 0;
     depthAtt.format = Vulkan::GetDepthFormat();
     depthAtt.samples = VK_SAMPLE_COUNT_1_BIT;
-    depthAtt.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    depthAtt.loadOp = loadAttachments ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
     depthAtt.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    depthAtt.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    depthAtt.stencilLoadOp = loadAttachments ? VK_ATTACHMENT_LOAD_OP_DONT_CARE : VK_ATTACHMENT_LOAD_OP_CLEAR;
     depthAtt.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    depthAtt.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    // the loading pass follows the depth pyramid build, which reads the depth
+    depthAtt.initialLayout = loadAttachments ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
     depthAtt.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
     VkAttachmentReference depthAttRef{};
@@ -420,17 +515,19 @@ void VulkanRenderer3D::CreateRenderPass()
     subpassDep.srcSubpass = VK_SUBPASS_EXTERNAL;
     subpassDep.dstSubpass = 0;
     subpassDep.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    subpassDep.srcAccessMask = 0;
+    subpassDep.srcAccessMask = loadAttachments ? VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT : 0;
     subpassDep.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
     subpassDep.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
 
     VkSubpassDependency depthDep{};
     depthDep.srcSubpass = VK_SUBPASS_EXTERNAL;
     depthDep.dstSubpass = 0;
-    depthDep.srcStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    depthDep.srcStageMask = loadAttachments ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT 
+                                            : VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
     depthDep.srcAccessMask = 0;
     depthDep.dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-    depthDep.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    depthDep.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | 
+                                (loadAttachments ? VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT : 0);
 
     VkSubpassDependency dependencies[] = {subpassDep, depthDep};
     VkAttachmentDescription attachments[] = {colorAtt, depthAtt};
@@ -444,11 +541,13 @@ void VulkanRenderer3D::CreateRenderPass()
     renderPassInfo.dependencyCount = 2;
     renderPassInfo.pDependencies = dependencies;
 
-    if (vkCreateRenderPass(GraphicsAPI::Vulkan::GetDevice(), &renderPassInfo, nullptr, &m_renderpass) != VK_SUCCESS)
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+    if (vkCreateRenderPass(RenderSys::Vulkan::GetDevice(), &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS)
     {
         std::cout << "error; could not create renderpass" << std::endl;
         assert(false);
     }
+    return renderPass;
 }
 
 void VulkanRenderer3D::CreateCommandBuffers()
@@ -460,22 +559,46 @@ void VulkanRenderer3D::CreateCommandBuffers()
     cmdBufAllocateInfo.commandPool = RenderSys::Vulkan::GetCommandPool();
     cmdBufAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
     cmdBufAllocateInfo.commandBufferCount = 1;
-    auto err = vkAllocateCommandBuffers(GraphicsAPI::Vulkan::GetDevice(), &cmdBufAllocateInfo, &m_commandBuffer);
+    auto err = vkAllocateCommandBuffers(RenderSys::Vulkan::GetDevice(), &cmdBufAllocateInfo, &m_commandBuffer);
     GraphicsAPI::Vulkan::check_vk_result(err);
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    err = vkCreateFence(RenderSys::Vulkan::GetDevice(), &fenceInfo, nullptr, &m_frameFence);
+    GraphicsAPI::Vulkan::check_vk_result(err);
+}
+
+void VulkanRenderer3D::WaitForFrame()
+{
+    if (!m_frameSubmitted)
+    {
+        return;
+    }
+    auto err = vkWaitForFences(RenderSys::Vulkan::GetDevice(), 1, &m_frameFence, VK_TRUE, UINT64_MAX);
+    GraphicsAPI::Vulkan::check_vk_result(err);
+    err = vkResetFences(RenderSys::Vulkan::GetDevice(), 1, &m_frameFence);
+    GraphicsAPI::Vulkan::check_vk_result(err);
+    m_frameSubmitted = false;
 }
 
 void VulkanRenderer3D::DestroyRenderPass()
 {
-    vkDeviceWaitIdle(GraphicsAPI::Vulkan::GetDevice());
-    vkDestroyRenderPass(GraphicsAPI::Vulkan::GetDevice(), m_renderpass, nullptr);
+    vkDeviceWaitIdle(RenderSys::Vulkan::GetDevice());
+    vkDestroyRenderPass(RenderSys::Vulkan::GetDevice(), m_renderpass, nullptr);
+    vkDestroyRenderPass(RenderSys::Vulkan::GetDevice(), m_loadRenderpass, nullptr);
 }
 
 void VulkanRenderer3D::CreatePipeline()
 {
     std::vector<VkDescriptorSetLayout> layouts{m_mainBindGroupLayout, 
-                                                    RenderSys::GetMaterialBindGroupLayout(),
+                                                    GetMaterialBindGroupLayout(),
                                                     RenderSys::GetResourceBindGroupLayout()};
-    m_pbrRenderPipeline = std::make_unique<RenderSys::Vulkan::PbrRenderPipeline>(m_renderpass, layouts, m_vertexInputLayout, m_shaderStageInfos);
+    if (m_multiDrawIndirect)
+    {
+        layouts.push_back(m_drawInstanceBindGroupLayout);
+    }
+    const uint32_t pushConstantSize = m_bindlessMaterials ? sizeof(uint32_t) : sizeof(RenderSys::MaterialProperties);
+    m_pbrRenderPipeline = std::make_unique<RenderSys::Vulkan::PbrRenderPipeline>(m_renderpass, layouts, m_vertexInputLayout, m_shaderStageInfos, pushConstantSize);
     if (m_pbrRenderPipeline->GetPipeline() == VK_NULL_HANDLE || m_pbrRenderPipeline->GetPipelineLayout() == VK_NULL_HANDLE){
         std::cout << "error: could not create pipeline" << std::endl;
         assert(false);
@@ -497,16 +620,28 @@ void VulkanRenderer3D::CreateFrameBuffer()
     FboInfo.height = m_height;
     FboInfo.layers = 1;
 
-    if (vkCreateFramebuffer(GraphicsAPI::Vulkan::GetDevice(), &FboInfo, nullptr, &m_frameBuffer) != VK_SUCCESS) {
+    if (vkCreateFramebuffer(RenderSys::Vulkan::GetDevice(), &FboInfo, nullptr, &m_frameBuffer) != VK_SUCCESS) {
         std::cout << "error: failed to create framebuffer" << std::endl;
         return ;
     }
 }
 
 uint32_t VulkanRenderer3D::CreateVertexBuffer(const RenderSys::VertexBuffer& bufferData, RenderSys::VertexBufferLayout bufferLayout)
+{
+    return CreateVertexBuffer(bufferData.vertices.data(), bufferData.vertices.size() * sizeof(RenderSys::Vertex), bufferLayout);
+}
+
+uint32_t VulkanRenderer3D::CreateVertexBuffer(const void* bufferData, size_t bufferLength, RenderSys::VertexBufferLayout bufferLayout)
+{
+    return CreateVertexBuffer(bufferLength, bufferLayout, [bufferData, bufferLength](void* mappedVertices)
+    {
+        std::memcpy(mappedVertices, bufferData, bufferLength);
+    });
+}
+
+uint32_t VulkanRenderer3D::CreateVertexBuffer(size_t bufferLength, RenderSys::VertexBufferLayout bufferLayout, const std::function<void(void*)>& writeVertices)
 {
     std::cout << "Creating vertex buffer..." << std::endl;
-    const auto bufferLength = bufferData.vertices.size() * sizeof(RenderSys::Vertex);
     assert(bufferLength > 0);
     assert(bufferLayout.arrayStride > 0);
     const uint64_t vertexCount = bufferLength/bufferLayout.arrayStride;
@@ -528,13 +663,22 @@ uint32_t VulkanRenderer3D::CreateVertexBuffer(const RenderSys::VertexBuffer& buf
             m_vertexInputLayout.m_vertexAttribDescs.push_back(vkAttribute);
         }
     }
+    else if (m_vertexInputLayout.m_vertexBindingDescs.stride != bufferLayout.arrayStride)
+    {
+        // one vertex input layout for all pipelines, the vertex buffers cannot mix Vertex and PackedVertex
+        std::cout << "Error: vertex buffer stride " << bufferLayout.arrayStride << " differs from the stride " 
+                  << m_vertexInputLayout.m_vertexBindingDescs.stride << " of the vertex input layout!" << std::endl;
+        assert(false);
+        return 0;
+    }
     
     auto vertexIndexBufferInfo = std::make_shared<Vulkan::VertexIndexBufferInfo>();
     vertexIndexBufferInfo->m_vertexCount = vertexCount;
+    vertexIndexBufferInfo->m_vertexStride = bufferLayout.arrayStride;
     VkBufferCreateInfo bufferInfo = {};
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
     bufferInfo.size = bufferLength;
-    bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT; // storage for the skinning input
     bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
     VmaAllocationCreateInfo vmaAllocInfo{};
     vmaAllocInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
@@ -545,7 +689,7 @@ uint32_t VulkanRenderer3D::CreateVertexBuffer(const RenderSys::VertexBuffer& buf
         return 0;
     }
 
-    // copy data to the buffer
+    // the vertices are written straight into the host visible memory of the buffer
     void *buf;
     auto res = vmaMapMemory(RenderSys::Vulkan::GetMemoryAllocator(), vertexIndexBufferInfo->m_vertexBufferMemory, &buf);
     if (res != VK_SUCCESS) {
@@ -553,7 +697,7 @@ uint32_t VulkanRenderer3D::CreateVertexBuffer(const RenderSys::VertexBuffer& buf
         return 0;
     }
 
-    std::memcpy(buf, bufferData.vertices.data(), bufferLength);
+    writeVertices(buf);
     vmaUnmapMemory(RenderSys::Vulkan::GetMemoryAllocator(), vertexIndexBufferInfo->m_vertexBufferMemory);
 
     std::cout << "Vertex buffer: " << vertexIndexBufferInfo->m_vertexBuffer << std::endl;
@@ -581,7 +725,8 @@ void VulkanRenderer3D::CreateIndexBuffer(uint32_t vertexBufferID, const std::vec
     VkBufferCreateInfo bufferInfo = {};
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
     bufferInfo.size = vertexIndexBufferInfo->m_indexCount * 4;
-    bufferInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+    // also read by the meshlet culling
+    bufferInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
     bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
     VmaAllocationCreateInfo vmaAllocInfo{};
     vmaAllocInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
@@ -605,6 +750,220 @@ void VulkanRenderer3D::CreateIndexBuffer(uint32_t vertexBufferID, const std::vec
     std::cout << "Index buffer: " << vertexIndexBufferInfo->m_indexBuffer << std::endl;
 }
 
+void VulkanRenderer3D::CreateSkinningBuffer(uint32_t vertexBufferID, const std::vector<RenderSys::SkinningVertex>& skinningData)
+{
+    std::cout << "Creating skinning buffers..." << std::endl;
+    const auto& vertexIndexBufferInfoIter = m_vertexIndexBufferInfoMap.find(vertexBufferID);
+    if (vertexIndexBufferInfoIter == m_vertexIndexBufferInfoMap.end())
+    {
+        std::cout << "Error: could not find vertexIndexBufferInfo!" << std::endl;
+        assert(false);
+        return;
+    }
+    auto vertexIndexBufferInfo = vertexIndexBufferInfoIter->second;
+    assert(skinningData.size() == vertexIndexBufferInfo->m_vertexCount);
+    assert(vertexIndexBufferInfo->m_skinnedVertexBuffer == VK_NULL_HANDLE);
+    if (vertexIndexBufferInfo->m_vertexStride != sizeof(RenderSys::Vertex))
+    {
+        // skinning-compute.glsl reads and writes the full Vertex
+        std::cout << "Error: skinned meshes need a vertex buffer of RenderSys::Vertex!" << std::endl;
+        assert(false);
+        return;
+    }
+
+    if (!m_skinningPipeline)
+    {
+        CreateSkinningPipeline();
+    }
+
+    // joints and weights, written once
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = skinningData.size() * sizeof(RenderSys::SkinningVertex);
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    VmaAllocationCreateInfo vmaAllocInfo{};
+    vmaAllocInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+
+    auto res = vmaCreateBuffer(RenderSys::Vulkan::GetMemoryAllocator(), &bufferInfo, &vmaAllocInfo, 
+                                &vertexIndexBufferInfo->m_skinningDataBuffer, &vertexIndexBufferInfo->m_skinningDataBufferMemory, nullptr);
+    if (res != VK_SUCCESS) {
+        std::cout << "vkCreateBuffer() failed!" << std::endl;
+        return;
+    }
+
+    void *buf;
+    res = vmaMapMemory(RenderSys::Vulkan::GetMemoryAllocator(), vertexIndexBufferInfo->m_skinningDataBufferMemory, &buf);
+    if (res != VK_SUCCESS) {
+        std::cout << "vkMapMemory() failed" << std::endl;
+        return;
+    }
+
+    std::memcpy(buf, skinningData.data(), bufferInfo.size);
+    vmaUnmapMemory(RenderSys::Vulkan::GetMemoryAllocator(), vertexIndexBufferInfo->m_skinningDataBufferMemory);
+
+    // skinned vertices, written by the GPU every frame and never touched by the CPU
+    VkBufferCreateInfo skinnedBufferInfo = {};
+    skinnedBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    skinnedBufferInfo.size = vertexIndexBufferInfo->m_vertexCount * sizeof(RenderSys::Vertex);
+    skinnedBufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    skinnedBufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    VmaAllocationCreateInfo skinnedVmaAllocInfo{};
+    skinnedVmaAllocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+    res = vmaCreateBuffer(RenderSys::Vulkan::GetMemoryAllocator(), &skinnedBufferInfo, &skinnedVmaAllocInfo, 
+                            &vertexIndexBufferInfo->m_skinnedVertexBuffer, &vertexIndexBufferInfo->m_skinnedVertexBufferMemory, nullptr);
+    if (res != VK_SUCCESS) {
+        std::cout << "vkCreateBuffer() failed!" << std::endl;
+        return;
+    }
+
+    vertexIndexBufferInfo->m_skinningBindGroup = m_skinningPipeline->CreateBindGroup(vertexIndexBufferInfo->m_vertexBuffer, 
+                                                                                    vertexIndexBufferInfo->m_skinningDataBuffer, 
+                                                                                    vertexIndexBufferInfo->m_skinnedVertexBuffer);
+    std::cout << "Skinned vertex buffer: " << vertexIndexBufferInfo->m_skinnedVertexBuffer << std::endl;
+}
+
+void VulkanRenderer3D::CreateMeshletBuffer(uint32_t vertexBufferID, const std::vector<RenderSys::Meshlet>& meshlets)
+{
+    std::cout << "Creating meshlet buffers..." << std::endl;
+    auto vertexIndexBufferInfo = GetVertexIndexBufferInfo(vertexBufferID);
+    if (!vertexIndexBufferInfo)
+    {
+        return;
+    }
+    assert(!meshlets.empty());
+    assert(vertexIndexBufferInfo->m_meshletBuffer == VK_NULL_HANDLE);
+    if (vertexIndexBufferInfo->m_indexBuffer == VK_NULL_HANDLE || !m_multiDrawIndirect)
+    {
+        // the culled meshlets are drawn by the indirect commands from a copy of the index buffer
+        std::cout << "Error: meshlet culling needs an index buffer and multi-draw indirect!" << std::endl;
+        assert(false);
+        return;
+    }
+
+    if (!m_meshletCullingPipeline)
+    {
+        CreateMeshletCullingPipeline();
+    }
+
+    // bounds and index ranges, written once
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = meshlets.size() * sizeof(RenderSys::Meshlet);
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    VmaAllocationCreateInfo vmaAllocInfo{};
+    vmaAllocInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+
+    auto res = vmaCreateBuffer(RenderSys::Vulkan::GetMemoryAllocator(), &bufferInfo, &vmaAllocInfo, 
+                                &vertexIndexBufferInfo->m_meshletBuffer, &vertexIndexBufferInfo->m_meshletBufferMemory, nullptr);
+    if (res != VK_SUCCESS) {
+        std::cout << "vkCreateBuffer() failed!" << std::endl;
+        return;
+    }
+
+    void *buf;
+    res = vmaMapMemory(RenderSys::Vulkan::GetMemoryAllocator(), vertexIndexBufferInfo->m_meshletBufferMemory, &buf);
+    if (res != VK_SUCCESS) {
+        std::cout << "vkMapMemory() failed" << std::endl;
+        return;
+    }
+
+    std::memcpy(buf, meshlets.data(), bufferInfo.size);
+    vmaUnmapMemory(RenderSys::Vulkan::GetMemoryAllocator(), vertexIndexBufferInfo->m_meshletBufferMemory);
+
+    // the visible indices, written by the GPU every frame at the same offsets as in the index buffer
+    VkBufferCreateInfo culledBufferInfo = {};
+    culledBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    culledBufferInfo.size = vertexIndexBufferInfo->m_indexCount * sizeof(uint32_t);
+    culledBufferInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    culledBufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    VmaAllocationCreateInfo culledVmaAllocInfo{};
+    culledVmaAllocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+    res = vmaCreateBuffer(RenderSys::Vulkan::GetMemoryAllocator(), &culledBufferInfo, &culledVmaAllocInfo, 
+                            &vertexIndexBufferInfo->m_culledIndexBuffer, &vertexIndexBufferInfo->m_culledIndexBufferMemory, nullptr);
+    if (res != VK_SUCCESS) {
+        std::cout << "vkCreateBuffer() failed!" << std::endl;
+        return;
+    }
+
+    vertexIndexBufferInfo->m_meshletBindGroup = m_meshletCullingPipeline->CreateBindGroup(vertexIndexBufferInfo->m_meshletBuffer, 
+                                                                                        vertexIndexBufferInfo->m_indexBuffer, 
+                                                                                        vertexIndexBufferInfo->m_culledIndexBuffer);
+    std::cout << "Meshlet buffer: " << vertexIndexBufferInfo->m_meshletBuffer << ", " << meshlets.size() << " meshlets" << std::endl;
+}
+
+void VulkanRenderer3D::CreateSkinningPipeline()
+{
+    auto stageInfo = LoadShader("skinning-compute.glsl", RenderSys::ShaderStage::Compute);
+    if (!stageInfo)
+    {
+        assert(false);
+        return;
+    }
+
+    m_skinningPipeline = std::make_unique<Vulkan::SkinningComputePipeline>(RenderSys::GetResourceBindGroupLayout(), *stageInfo);
+}
+
+void VulkanRenderer3D::CreateHzbCullingPipeline()
+{
+    assert(m_indirectCommandBuffer != VK_NULL_HANDLE);
+    auto reduceStageInfo = LoadShader("hzb-reduce-compute.glsl", RenderSys::ShaderStage::Compute);
+    auto cullStageInfo = LoadShader("hzb-cull-compute.glsl", RenderSys::ShaderStage::Compute);
+    if (!reduceStageInfo || !cullStageInfo)
+    {
+        assert(false);
+        return;
+    }
+
+    m_hzbCullingPipeline = std::make_unique<Vulkan::HzbCullingPipeline>(*reduceStageInfo, *cullStageInfo, m_indirectCommandBuffer);
+    if (m_depthimageView != VK_NULL_HANDLE)
+    {
+        m_hzbCullingPipeline->CreateDepthPyramid(m_depthimageView, m_width, m_height);
+    }
+}
+
+void VulkanRenderer3D::CreateMeshletCullingPipeline()
+{
+    assert(m_indirectCommandBuffer != VK_NULL_HANDLE);
+    auto stageInfo = LoadShader("meshlet-cull-compute.glsl", RenderSys::ShaderStage::Compute);
+    if (!stageInfo)
+    {
+        assert(false);
+        return;
+    }
+
+    m_meshletCullingPipeline = std::make_unique<Vulkan::MeshletCullingPipeline>(*stageInfo, m_indirectCommandBuffer);
+}
+
+std::shared_ptr<VkPipelineShaderStageCreateInfo> VulkanRenderer3D::LoadShader(const std::string& fileName, const RenderSys::ShaderStage& stage)
+{
+    const auto shaderDir = std::string(RENDERSYS_SHADER_DIR);
+    std::ifstream file(shaderDir + "/" + fileName, std::ios::binary);
+    std::vector<char> content((std::istreambuf_iterator<char>(file)),
+                                std::istreambuf_iterator<char>());
+    if (!file.is_open()) {
+        std::cerr << "Unable to open file - " << fileName << std::endl;
+        return nullptr;
+    }
+
+    RenderSys::Shader shader(fileName, std::string(content.data(), content.size()));
+    shader.type = RenderSys::ShaderType::SPIRV;
+    shader.stage = stage;
+    shader.SetIncludeDirectory(shaderDir);
+    const bool compiled = shader.Compile();
+    assert(compiled);
+    const auto& compiledShader = shader.GetCompiledShader();
+
+    VkShaderModuleCreateInfo shaderCreateInfo{};
+    shaderCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    shaderCreateInfo.codeSize = sizeof(uint32_t) * compiledShader.size();
+    shaderCreateInfo.pCode = compiledShader.data();
+    return CreateShaderModule(shaderCreateInfo, shader.stage);
+}
+
 void VulkanRenderer3D::SetClearColor(glm::vec4 clearColor)
 {
     m_clearColor = {clearColor.x, clearColor.y, clearColor.z, clearColor.w};
@@ -685,7 +1044,7 @@ void VulkanRenderer3D::SetUniformData(uint32_t binding, const void* bufferData)
     descriptorWrite.pTexelBufferView = nullptr; // Optional
     
 
-    vkUpdateDescriptorSets(GraphicsAPI::Vulkan::GetDevice(), 1, &descriptorWrite, 0, nullptr);
+    vkUpdateDescriptorSets(RenderSys::Vulkan::GetDevice(), 1, &descriptorWrite, 0, nullptr);
 }
 
 void VulkanRenderer3D::BindResources()
@@ -733,7 +1092,10 @@ void VulkanRenderer3D::RenderMesh(const RenderSys::Mesh& mesh, const bool shadow
     assert(vertexIndexBufferInfoIter != m_vertexIndexBufferInfoMap.end());
     const auto& vertexIndexBufferInfo = vertexIndexBufferInfoIter->second;
     VkDeviceSize offset = 0;
-    vkCmdBindVertexBuffers(m_commandBuffer, 0, 1, &vertexIndexBufferInfo->m_vertexBuffer, &offset);
+    // skinned meshes are drawn from the output of RenderSkinning(), shared by the shadow and the main pass
+    const VkBuffer vertexBuffer = vertexIndexBufferInfo->m_skinnedVertexBuffer != VK_NULL_HANDLE ? 
+                                    vertexIndexBufferInfo->m_skinnedVertexBuffer : vertexIndexBufferInfo->m_vertexBuffer;
+    vkCmdBindVertexBuffers(m_commandBuffer, 0, 1, &vertexBuffer, &offset);
     if (vertexIndexBufferInfo->m_indexCount > 0)
     {
         assert(vertexIndexBufferInfo->m_indexBuffer != VK_NULL_HANDLE);
@@ -751,81 +1113,693 @@ void VulkanRenderer3D::RenderMesh(const RenderSys::Mesh& mesh, const bool shadow
     }
 }
 
-void VulkanRenderer3D::RenderSubMesh(const uint32_t vertexBufferID, const RenderSys::SubMesh& subMesh, VkPipelineLayout pipelineLayout)
+void VulkanRenderer3D::SubmitRenderQueue(const RenderSys::RenderQueue& renderQueue)
 {
-    auto materialBindGroup = subMesh.m_Material->GetDescriptor()->GetPlatformDescriptor()->m_bindGroup;
-    assert(materialBindGroup != VK_NULL_HANDLE);
-    auto resourceBindGroup = subMesh.m_Resource->GetDescriptor()->GetPlatformDescriptor()->m_bindGroup;
-    assert(resourceBindGroup != VK_NULL_HANDLE);
-    std::vector<VkDescriptorSet> descriptorsets{m_mainBindGroup, materialBindGroup, resourceBindGroup};
-
-    vkCmdBindDescriptorSets(m_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0
-                                , descriptorsets.size(), descriptorsets.data()
-                                , 0, nullptr);
-    if (pipelineLayout == m_pbrRenderPipeline->GetPipelineLayout())
+    assert(m_mainBindGroup != VK_NULL_HANDLE);
+    const auto startTime = std::chrono::high_resolution_clock::now();
+    // nothing is assumed to be bound when the queue starts, the first packet binds all of its state
+    bool pipelineBound = false;
+    RenderSys::RenderPipeline boundPipeline = RenderSys::RenderPipeline::PBR;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    std::array<VkDescriptorSet, 3> boundDescriptorSets{};
+    const RenderSys::Material* pushedMaterial = nullptr;
+    uint32_t boundVertexBufferID = 0; // vertex buffer ids start at 1
+    Vulkan::VertexIndexBufferInfo* vertexIndexBufferInfo = nullptr;
+
+    for (const auto& packet : renderQueue.GetPackets())
     {
-        vkCmdPushConstants(m_commandBuffer, pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, 
-                        sizeof(RenderSys::MaterialProperties), &subMesh.m_Material->GetMaterialProperties());
-    }
+        const auto& subMesh = *packet.m_SubMesh;
+        if (!pipelineBound || packet.m_Pipeline != boundPipeline)
+        {
+            const bool shadowPipeline = packet.m_Pipeline == RenderSys::RenderPipeline::SHADOW;
+            vkCmdBindPipeline(m_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, 
+                                shadowPipeline ? m_shadowRenderPipeline->GetPipeline() : m_pbrRenderPipeline->GetPipeline());
+            pipelineLayout = shadowPipeline ? m_shadowRenderPipeline->GetPipelineLayout() : m_pbrRenderPipeline->GetPipelineLayout();
+            pipelineBound = true;
+            boundPipeline = packet.m_Pipeline;
+            boundDescriptorSets = {};
+            pushedMaterial = nullptr;
+            m_renderQueueStats.m_PipelineBinds++;
+            if (!shadowPipeline && m_multiDrawIndirect)
+            {
+                vkCmdBindDescriptorSets(m_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 3
+                                            , 1, &m_drawInstanceBindGroup
+                                            , 0, nullptr);
+                m_renderQueueStats.m_DescriptorSetBinds++;
+            }
+        }
 
-    assert(vertexBufferID >= 1);
-    const auto& vertexIndexBufferInfoIter = m_vertexIndexBufferInfoMap.find(vertexBufferID);
-    if (vertexIndexBufferInfoIter == m_vertexIndexBufferInfoMap.end())
-    {
-        std::cout << "Error: could not find vertexIndexBufferInfo!" << std::endl;
-        assert(false);
-        return;
-    }
+        const std::array<VkDescriptorSet, 3> descriptorSets{m_mainBindGroup,
+                                                            GetMaterialBindGroup(*subMesh.m_Material),
+                                                            subMesh.m_Resource->GetDescriptor()->GetPlatformDescriptor()->m_bindGroup};
+        assert(descriptorSets[1] != VK_NULL_HANDLE && descriptorSets[2] != VK_NULL_HANDLE);
+        // sets below the first changed one stay bound
+        uint32_t firstSet = 0;
+        while (firstSet < descriptorSets.size() && descriptorSets[firstSet] == boundDescriptorSets[firstSet])
+        {
+            firstSet++;
+        }
+        if (firstSet < descriptorSets.size())
+        {
+            const uint32_t setCount = static_cast<uint32_t>(descriptorSets.size()) - firstSet;
+            vkCmdBindDescriptorSets(m_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, firstSet
+                                        , setCount, descriptorSets.data() + firstSet
+                                        , 0, nullptr);
+            boundDescriptorSets = descriptorSets;
+            m_renderQueueStats.m_DescriptorSetBinds++;
+        }
 
-    auto vertexIndexBufferInfo = vertexIndexBufferInfoIter->second;
-    if (vertexIndexBufferInfo->m_indexCount > 0)
-    {
-        assert(subMesh.m_InstanceCount > 0);
-        if (subMesh.m_IndexCount > 0)
+        if (packet.m_Pipeline == RenderSys::RenderPipeline::PBR && subMesh.m_Material.get() != pushedMaterial)
         {
-            vkCmdDrawIndexed(m_commandBuffer, subMesh.m_IndexCount, subMesh.m_InstanceCount, subMesh.m_FirstIndex, 0, 0);
+            PushMaterialConstants(*subMesh.m_Material, pipelineLayout);
+            pushedMaterial = subMesh.m_Material.get();
+            m_renderQueueStats.m_PushConstantUpdates++;
+        }
+
+        if (packet.m_Mesh->vertexBufferID != boundVertexBufferID)
+        {
+            vertexIndexBufferInfo = GetVertexIndexBufferInfo(packet.m_Mesh->vertexBufferID);
+            if (!vertexIndexBufferInfo)
+            {
+                continue;
+            }
+            BindVertexIndexBuffers(*vertexIndexBufferInfo);
+            boundVertexBufferID = packet.m_Mesh->vertexBufferID;
+        }
+
+        // the instances of the PBR pipeline are read through the draw instances when it draws indirect
+        uint32_t firstInstance = 0;
+        if (packet.m_Pipeline == RenderSys::RenderPipeline::PBR && m_multiDrawIndirect)
+        {
+            firstInstance = AddDrawInstances(subMesh);
+            if (firstInstance == NO_DRAW_INSTANCES)
+            {
+                continue;
+            }
+        }
+
+        if (vertexIndexBufferInfo->m_indexCount > 0)
+        {
+            assert(subMesh.m_InstanceCount > 0);
+            const uint32_t indexCount = packet.m_IndexCount > 0 ? packet.m_IndexCount : vertexIndexBufferInfo->m_indexCount;
+            vkCmdDrawIndexed(m_commandBuffer, indexCount, subMesh.m_InstanceCount, packet.m_IndexCount > 0 ? packet.m_FirstIndex : 0, 0, firstInstance);
+            m_renderQueueStats.m_Triangles += indexCount / 3 * subMesh.m_InstanceCount;
         }
         else
         {
-            vkCmdDrawIndexed(m_commandBuffer, vertexIndexBufferInfo->m_indexCount, subMesh.m_InstanceCount, 0, 0, 0);
+            vkCmdDraw(m_commandBuffer, vertexIndexBufferInfo->m_vertexCount, 1, 0, firstInstance);
         }
+        m_renderQueueStats.m_Draws++;
     }
-    else
-    {
-        vkCmdDraw(m_commandBuffer, vertexIndexBufferInfo->m_vertexCount, 1, 0, 0);
-    }
-}
 
-void VulkanRenderer3D::DrawPlane()
-{
+    const auto endTime = std::chrono::high_resolution_clock::now();
+    m_renderQueueStats.m_RecordTimeMs += std::chrono::duration<float, std::milli>(endTime - startTime).count();
 }
 
-void VulkanRenderer3D::DrawCube()
+void VulkanRenderer3D::SubmitRenderQueueIndirect(const RenderSys::RenderQueue& renderQueue)
 {
+    assert(m_multiDrawIndirect && m_mainBindGroup != VK_NULL_HANDLE);
+    const auto startTime = std::chrono::high_resolution_clock::now();
+    BuildIndirectBatches(renderQueue, false);
+    DrawIndirectBatches(true);
+    const auto endTime = std::chrono::high_resolution_clock::now();
+    m_renderQueueStats.m_RecordTimeMs += std::chrono::duration<float, std::milli>(endTime - startTime).count();
 }
 
-ImTextureID VulkanRenderer3D::GetDescriptorSet()
+void VulkanRenderer3D::SubmitRenderQueueOcclusionCulled(const RenderSys::RenderQueue& renderQueue, const glm::mat4& viewProjection)
 {
-    return m_finalImageDescriptorSet;
+    assert(m_multiDrawIndirect && m_mainBindGroup != VK_NULL_HANDLE);
+    // the draw bounds are written while recording, a second queue in the same frame would overwrite them
+    assert(!m_occlusionCulled);
+    const auto startTime = std::chrono::high_resolution_clock::now();
+    if (!m_hzbCullingPipeline)
+    {
+        CreateHzbCullingPipeline();
+    }
+
+    BeginProfileScope("Occlusion culled pass");
+    const uint32_t firstCommand = m_indirectCommandCount;
+    BuildIndirectBatches(renderQueue, true);
+    const uint32_t drawCount = m_indirectCommandCount - firstCommand;
+
+    VkMemoryBarrier commandBarrier{};
+    commandBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    commandBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    commandBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+
+    // early phase, what was visible last frame
+    BeginProfileScope("Early cull");
+    m_renderQueueStats.m_Dispatches += m_hzbCullingPipeline->Cull(m_commandBuffer, Vulkan::HzbCullingPipeline::Phase::EARLY, viewProjection, drawCount);
+    EndProfileScope();
+    vkCmdPipelineBarrier(m_commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 
+                            0, 1, &commandBarrier, 0, nullptr, 0, nullptr);
+    BeginProfileScope("Early draws");
+    BeginMainRenderPass(m_renderpass);
+    DrawIndirectBatches(true);
+    EndMainRenderPass();
+    EndProfileScope();
+
+    VkImageMemoryBarrier depthBarrier{};
+    depthBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    depthBarrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    depthBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    depthBarrier.oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depthBarrier.newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+    depthBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    depthBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    depthBarrier.image = m_depthimage;
+    depthBarrier.subresourceRange = {VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, 1};
+    vkCmdPipelineBarrier(m_commandBuffer, VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 
+                            0, 0, nullptr, 0, nullptr, 1, &depthBarrier);
+    BeginProfileScope("Depth pyramid");
+    m_renderQueueStats.m_Dispatches += m_hzbCullingPipeline->BuildDepthPyramid(m_commandBuffer);
+    EndProfileScope();
+
+    // late phase, the commands are written again once the early draws have read them
+    VkMemoryBarrier rewriteBarrier{};
+    rewriteBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    rewriteBarrier.srcAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    rewriteBarrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(m_commandBuffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 
+                            0, 1, &rewriteBarrier, 0, nullptr, 0, nullptr);
+    BeginProfileScope("Late cull");
+    m_renderQueueStats.m_Dispatches += m_hzbCullingPipeline->Cull(m_commandBuffer, Vulkan::HzbCullingPipeline::Phase::LATE, viewProjection, drawCount);
+    EndProfileScope();
+    vkCmdPipelineBarrier(m_commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 
+                            0, 1, &commandBarrier, 0, nullptr, 0, nullptr);
+    BeginProfileScope("Late draws");
+    BeginMainRenderPass(m_loadRenderpass);
+    DrawIndirectBatches(false);
+    EndMainRenderPass();
+    EndProfileScope();
+    EndProfileScope();
+    m_occlusionCulled = true;
+
+    const auto endTime = std::chrono::high_resolution_clock::now();
+    m_renderQueueStats.m_RecordTimeMs += std::chrono::duration<float, std::milli>(endTime - startTime).count();
 }
 
-void VulkanRenderer3D::BeginRenderPass()
+void VulkanRenderer3D::SubmitRenderQueueMeshletCulled(const RenderSys::RenderQueue& renderQueue, const glm::mat4& viewProjection, const glm::vec3& viewPosition)
 {
-    std::array<VkClearValue, 2> clearValues{};
-    clearValues[0].color = m_clearColor;
-    clearValues[1].depthStencil = {1.0f, 0};
+    assert(m_multiDrawIndirect && m_mainBindGroup != VK_NULL_HANDLE);
+    // every culled submesh owns its range of the culled index buffer for the whole frame
+    assert(!m_meshletCulled);
+    const auto startTime = std::chrono::high_resolution_clock::now();
+    if (!m_meshletCullingPipeline)
+    {
+        CreateMeshletCullingPipeline();
+    }
 
-    assert(m_frameBuffer);
-    VkRenderPassBeginInfo rpInfo{};
-    rpInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    rpInfo.renderPass = m_renderpass;
-    rpInfo.renderArea.offset = {0, 0};
-    rpInfo.renderArea.extent = { m_width, m_height };
-    rpInfo.framebuffer = m_frameBuffer;
-    rpInfo.clearValueCount = 2;
-    rpInfo.pClearValues = clearValues.data();
+    BeginProfileScope("Meshlet culled pass");
+    m_meshletCullingPipeline->ResetDraws();
+    BuildIndirectBatches(renderQueue, false, true);
+    BeginProfileScope("Meshlet cull");
+    m_renderQueueStats.m_Dispatches += m_meshletCullingPipeline->Cull(m_commandBuffer, viewProjection, viewPosition);
+    EndProfileScope();
+
+    VkMemoryBarrier cullBarrier{};
+    cullBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    cullBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    cullBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+    vkCmdPipelineBarrier(m_commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 
+                            0, 1, &cullBarrier, 0, nullptr, 0, nullptr);
+    BeginProfileScope("Draws");
+    BeginMainRenderPass(m_renderpass);
+    DrawIndirectBatches(true);
+    EndMainRenderPass();
+    EndProfileScope();
+    EndProfileScope();
+    m_meshletCulled = true;
+
+    const auto endTime = std::chrono::high_resolution_clock::now();
+    m_renderQueueStats.m_RecordTimeMs += std::chrono::duration<float, std::milli>(endTime - startTime).count();
+}
 
-    vkCmdBeginRenderPass(m_commandBuffer, &rpInfo, VK_SUBPASS_CONTENTS_INLINE);
+bool VulkanRenderer3D::CanCullMeshlets(const RenderSys::DrawPacket& packet)
+{
+    // the coarser levels are drawn whole, and without the instance buffer the transforms are unknown
+    if (packet.m_Lod != 0 || packet.m_SubMesh->m_MeshletCount == 0 || !packet.m_InstanceBuffer || 
+        packet.m_SubMesh->m_InstanceCount > MAX_INSTANCE)
+    {
+        return false;
+    }
+    const auto vertexIndexBufferInfo = GetVertexIndexBufferInfo(packet.m_Mesh->vertexBufferID);
+    return vertexIndexBufferInfo && vertexIndexBufferInfo->m_meshletBindGroup != VK_NULL_HANDLE && 
+            m_meshletCulledSubMeshes.insert(packet.m_SubMesh).second;
+}
+
+void VulkanRenderer3D::BuildIndirectBatches(const RenderSys::RenderQueue& renderQueue, const bool occlusionCulled, const bool meshletCulled)
+{
+    m_indirectBatches.clear();
+    m_meshletCulledSubMeshes.clear();
+    const uint32_t firstCommand = m_indirectCommandCount;
+    IndirectBatch* batch = nullptr;
+    for (const auto& packet : renderQueue.GetPackets())
+    {
+        assert(packet.m_Pipeline == RenderSys::RenderPipeline::PBR);
+        const auto& subMesh = *packet.m_SubMesh;
+        const VkDescriptorSet resourceBindGroup = subMesh.m_Resource->GetDescriptor()->GetPlatformDescriptor()->m_bindGroup;
+        assert(resourceBindGroup != VK_NULL_HANDLE);
+        const bool cullMeshlets = meshletCulled && CanCullMeshlets(packet);
+        if (!batch || resourceBindGroup != batch->m_resourceBindGroup || 
+            packet.m_Mesh->vertexBufferID != batch->m_vertexBufferID || cullMeshlets != batch->m_meshletCulled)
+        {
+            auto vertexIndexBufferInfo = GetVertexIndexBufferInfo(packet.m_Mesh->vertexBufferID);
+            if (!vertexIndexBufferInfo)
+            {
+                continue;
+            }
+            batch = &m_indirectBatches.emplace_back();
+            batch->m_resourceBindGroup = resourceBindGroup;
+            batch->m_vertexBufferID = packet.m_Mesh->vertexBufferID;
+            batch->m_vertexIndexBufferInfo = vertexIndexBufferInfo;
+            batch->m_firstCommand = m_indirectCommandCount;
+            batch->m_meshletCulled = cullMeshlets;
+        }
+
+        const uint32_t firstInstance = AddDrawInstances(subMesh);
+        if (firstInstance == NO_DRAW_INSTANCES)
+        {
+            continue;
+        }
+
+        const auto& vertexIndexBufferInfo = *batch->m_vertexIndexBufferInfo;
+        if (vertexIndexBufferInfo.m_indexCount == 0)
+        {
+            // not indexed, drawn directly between the batches
+            IndirectBatch directBatch = *batch;
+            directBatch.m_direct = true;
+            directBatch.m_directFirstInstance = firstInstance;
+            m_indirectBatches.push_back(directBatch);
+            batch = nullptr;
+            m_renderQueueStats.m_Draws++;
+            continue;
+        }
+
+        if (m_indirectCommandCount >= MAX_INDIRECT_DRAWS)
+        {
+            std::cout << "Error: indirect command buffer is full!" << std::endl;
+            assert(false);
+            continue;
+        }
+        assert(subMesh.m_InstanceCount > 0);
+        const uint32_t commandIndex = m_indirectCommandCount++;
+        auto& command = m_indirectCommands[commandIndex];
+        command.indexCount = packet.m_IndexCount > 0 ? packet.m_IndexCount : vertexIndexBufferInfo.m_indexCount;
+        command.instanceCount = subMesh.m_InstanceCount;
+        command.firstIndex = packet.m_IndexCount > 0 ? packet.m_FirstIndex : 0;
+        command.vertexOffset = 0;
+        command.firstInstance = firstInstance;
+        batch->m_commandCount++;
+        m_renderQueueStats.m_Draws++;
+        m_renderQueueStats.m_Triangles += command.indexCount / 3 * command.instanceCount;
+
+        if (cullMeshlets)
+        {
+            std::array<glm::mat4, MAX_INSTANCE> transforms;
+            const uint32_t transformCount = std::min<uint32_t>(subMesh.m_InstanceCount, MAX_INSTANCE);
+            for (uint32_t instance = 0; instance < transformCount; ++instance)
+            {
+                transforms[instance] = packet.m_InstanceBuffer->GetModelMatrix(instance);
+            }
+            // the visible meshlets add their indices on the GPU
+            command.indexCount = 0;
+            command.firstIndex = subMesh.m_FirstIndex;
+            if (!m_meshletCullingPipeline->AddDraw(vertexIndexBufferInfo.m_meshletBindGroup, commandIndex, subMesh.m_FirstMeshlet, 
+                                                    subMesh.m_MeshletCount, transforms.data(), transformCount))
+            {
+                // sized like the indirect commands and draw instances, which are full before it
+                std::cout << "Error: meshlet draw buffer is full!" << std::endl;
+                assert(false);
+            }
+        }
+
+        if (occlusionCulled)
+        {
+            auto& drawBounds = m_hzbCullingPipeline->GetDrawBounds()[commandIndex - firstCommand];
+            drawBounds.m_BoundsMin = glm::vec4(packet.m_BoundsMin, 1.0f);
+            drawBounds.m_BoundsMax = glm::vec4(packet.m_BoundsMax, 1.0f);
+            drawBounds.m_CommandIndex = commandIndex;
+            drawBounds.m_VisibilitySlot = m_hzbCullingPipeline->GetVisibilitySlot(packet.m_SubMesh);
+            drawBounds.m_InstanceCount = subMesh.m_InstanceCount;
+            drawBounds.m_AlwaysVisible = packet.m_HasBounds ? 0 : 1;
+        }
+    }
+}
+
+void VulkanRenderer3D::DrawIndirectBatches(const bool drawDirect)
+{
+    // the pipeline and every bind group but the resources of the meshes are bound once for the whole queue
+    const VkPipelineLayout pipelineLayout = m_pbrRenderPipeline->GetPipelineLayout();
+    vkCmdBindPipeline(m_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pbrRenderPipeline->GetPipeline());
+    const std::array<VkDescriptorSet, 2> sharedDescriptorSets{m_mainBindGroup, RenderSys::GetBindlessMaterialBindGroup()};
+    vkCmdBindDescriptorSets(m_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0
+                                , sharedDescriptorSets.size(), sharedDescriptorSets.data()
+                                , 0, nullptr);
+    vkCmdBindDescriptorSets(m_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 3
+                                , 1, &m_drawInstanceBindGroup
+                                , 0, nullptr);
+    m_renderQueueStats.m_PipelineBinds++;
+    m_renderQueueStats.m_DescriptorSetBinds += 2;
+
+    VkDescriptorSet boundResourceBindGroup = VK_NULL_HANDLE;
+    const Vulkan::VertexIndexBufferInfo* boundVertexIndexBufferInfo = nullptr;
+    bool boundCulledIndices = false;
+    for (const auto& batch : m_indirectBatches)
+    {
+        if (batch.m_direct ? !drawDirect : batch.m_commandCount == 0)
+        {
+            continue;
+        }
+
+        if (batch.m_resourceBindGroup != boundResourceBindGroup)
+        {
+            vkCmdBindDescriptorSets(m_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 2
+                                        , 1, &batch.m_resourceBindGroup
+                                        , 0, nullptr);
+            boundResourceBindGroup = batch.m_resourceBindGroup;
+            m_renderQueueStats.m_DescriptorSetBinds++;
+        }
+        if (batch.m_vertexIndexBufferInfo != boundVertexIndexBufferInfo || batch.m_meshletCulled != boundCulledIndices)
+        {
+            BindVertexIndexBuffers(*batch.m_vertexIndexBufferInfo, batch.m_meshletCulled);
+            boundVertexIndexBufferInfo = batch.m_vertexIndexBufferInfo;
+            boundCulledIndices = batch.m_meshletCulled;
+        }
+
+        if (batch.m_direct)
+        {
+            vkCmdDraw(m_commandBuffer, batch.m_vertexIndexBufferInfo->m_vertexCount, 1, 0, batch.m_directFirstInstance);
+            continue;
+        }
+
+        const uint32_t lastCommand = batch.m_firstCommand + batch.m_commandCount;
+        for (uint32_t command = batch.m_firstCommand; command < lastCommand; command += m_maxDrawIndirectCount)
+        {
+            const uint32_t drawCount = std::min(lastCommand - command, m_maxDrawIndirectCount);
+            vkCmdDrawIndexedIndirect(m_commandBuffer, m_indirectCommandBuffer, command * sizeof(VkDrawIndexedIndirectCommand), 
+                                        drawCount, sizeof(VkDrawIndexedIndirectCommand));
+            m_renderQueueStats.m_IndirectDraws++;
+        }
+    }
+}
+
+uint32_t VulkanRenderer3D::AddDrawInstances(const RenderSys::SubMesh& subMesh)
+{
+    const uint32_t instanceCount = std::max(subMesh.m_InstanceCount, 1u);
+    if (m_drawInstanceCount + instanceCount > MAX_INDIRECT_DRAW_INSTANCES)
+    {
+        std::cout << "Error: draw instance buffer is full!" << std::endl;
+        assert(false);
+        return NO_DRAW_INSTANCES;
+    }
+
+    const uint32_t materialIndex = subMesh.m_Material->GetDescriptor()->GetPlatformDescriptor()->m_bindlessIndex;
+    assert(materialIndex != RenderSys::VulkanMaterialDescriptor::NO_BINDLESS_INDEX);
+    const uint32_t firstInstance = m_drawInstanceCount;
+    for (uint32_t instance = 0; instance < instanceCount; ++instance)
+    {
+        m_drawInstances[m_drawInstanceCount++] = {instance, materialIndex};
+    }
+    return firstInstance;
+}
+
+Vulkan::VertexIndexBufferInfo* VulkanRenderer3D::GetVertexIndexBufferInfo(const uint32_t vertexBufferID)
+{
+    auto vertexIndexBufferInfoIter = m_vertexIndexBufferInfoMap.find(vertexBufferID);
+    if (vertexIndexBufferInfoIter == m_vertexIndexBufferInfoMap.end())
+    {
+        std::cout << "Error: could not find vertexIndexBufferInfo!" << std::endl;
+        assert(false);
+        return nullptr;
+    }
+    return vertexIndexBufferInfoIter->second.get();
+}
+
+void VulkanRenderer3D::BindVertexIndexBuffers(const Vulkan::VertexIndexBufferInfo& vertexIndexBufferInfo, const bool culledIndices)
+{
+    VkDeviceSize offset = 0;
+    // skinned meshes are drawn from the output of RenderSkinning(), shared by the shadow and the main pass
+    const VkBuffer vertexBuffer = vertexIndexBufferInfo.m_skinnedVertexBuffer != VK_NULL_HANDLE ? 
+                                    vertexIndexBufferInfo.m_skinnedVertexBuffer : vertexIndexBufferInfo.m_vertexBuffer;
+    vkCmdBindVertexBuffers(m_commandBuffer, 0, 1, &vertexBuffer, &offset);
+    if (vertexIndexBufferInfo.m_indexCount > 0)
+    {
+        assert(vertexIndexBufferInfo.m_indexBuffer != VK_NULL_HANDLE);
+        assert(!culledIndices || vertexIndexBufferInfo.m_culledIndexBuffer != VK_NULL_HANDLE);
+        const VkBuffer indexBuffer = culledIndices ? vertexIndexBufferInfo.m_culledIndexBuffer : vertexIndexBufferInfo.m_indexBuffer;
+        vkCmdBindIndexBuffer(m_commandBuffer, indexBuffer, offset, VK_INDEX_TYPE_UINT32);
+    }
+    m_renderQueueStats.m_VertexBufferBinds++;
+}
+
+bool VulkanRenderer3D::SupportsBindlessMaterials() const
+{
+    return RenderSys::HasBindlessMaterialBindGroup();
+}
+
+void VulkanRenderer3D::SetBindlessMaterials(const bool bindlessMaterials)
+{
+    // the pipelines are created with the layout of the material bind group
+    assert(!m_pbrRenderPipeline && !m_shadowRenderPipeline);
+    assert(!bindlessMaterials || SupportsBindlessMaterials());
+    m_bindlessMaterials = bindlessMaterials && SupportsBindlessMaterials();
+}
+
+bool VulkanRenderer3D::SupportsMultiDrawIndirect() const
+{
+    // the draw instances are addressed by the first instance of the indirect commands, which the device has to enable
+    const VkPhysicalDeviceFeatures& features = Vulkan::GetEnabledDeviceFeatures();
+    return SupportsBindlessMaterials() && features.drawIndirectFirstInstance == VK_TRUE;
+}
+
+bool VulkanRenderer3D::SupportsOcclusionCulling() const
+{
+    // the depth pyramid is reduced from the sampled depth image
+    VkFormatProperties formatProperties{};
+    vkGetPhysicalDeviceFormatProperties(RenderSys::Vulkan::GetPhysicalDevice(), Vulkan::GetDepthFormat(), &formatProperties);
+    return SupportsMultiDrawIndirect() && (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT);
+}
+
+bool VulkanRenderer3D::SupportsMeshletCulling() const
+{
+    // plain compute and indexed indirect draws, no mesh shaders
+    return SupportsMultiDrawIndirect();
+}
+
+void VulkanRenderer3D::SetMultiDrawIndirect(const bool multiDrawIndirect)
+{
+    assert(!m_pbrRenderPipeline && !m_shadowRenderPipeline);
+    assert(!multiDrawIndirect || (m_bindlessMaterials && SupportsMultiDrawIndirect()));
+    m_multiDrawIndirect = multiDrawIndirect && m_bindlessMaterials && SupportsMultiDrawIndirect();
+    if (m_multiDrawIndirect && m_drawInstanceBindGroup == VK_NULL_HANDLE)
+    {
+        CreateDrawInstanceBindGroup();
+    }
+}
+
+void VulkanRenderer3D::CreateDrawInstanceBindGroup()
+{
+    // without the enabled feature every indirect draw takes a single command
+    const VkPhysicalDeviceFeatures& features = Vulkan::GetEnabledDeviceFeatures();
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(RenderSys::Vulkan::GetPhysicalDevice(), &properties);
+    m_maxDrawIndirectCount = features.multiDrawIndirect == VK_TRUE ? std::max(properties.limits.maxDrawIndirectCount, 1u) : 1;
+
+    VkDescriptorSetLayoutBinding drawInstanceBinding{0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr};
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &drawInstanceBinding;
+    if (vkCreateDescriptorSetLayout(RenderSys::Vulkan::GetDevice(), &layoutInfo, nullptr, &m_drawInstanceBindGroupLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor set layout!");
+    }
+
+    VkDescriptorPoolSize poolSize{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1};
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = 1;
+    if (vkCreateDescriptorPool(RenderSys::Vulkan::GetDevice(), &poolInfo, nullptr, &m_drawInstanceBindGroupPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor pool!");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_drawInstanceBindGroupPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &m_drawInstanceBindGroupLayout;
+    if (vkAllocateDescriptorSets(RenderSys::Vulkan::GetDevice(), &allocInfo, &m_drawInstanceBindGroup) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate descriptor sets!");
+    }
+
+    VmaAllocationCreateInfo vmaAllocInfo{};
+    vmaAllocInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+    vmaAllocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    VmaAllocationInfo mappedInfo{};
+
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = sizeof(DrawInstance) * MAX_INDIRECT_DRAW_INSTANCES;
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (vmaCreateBuffer(RenderSys::Vulkan::GetMemoryAllocator(), &bufferInfo, &vmaAllocInfo, 
+                        &m_drawInstanceBuffer, &m_drawInstanceBufferMemory, &mappedInfo) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create draw instance buffer!");
+    }
+    m_drawInstances = static_cast<DrawInstance*>(mappedInfo.pMappedData);
+
+    bufferInfo.size = sizeof(VkDrawIndexedIndirectCommand) * MAX_INDIRECT_DRAWS;
+    // the instance counts are written by the occlusion culling
+    bufferInfo.usage = VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    if (vmaCreateBuffer(RenderSys::Vulkan::GetMemoryAllocator(), &bufferInfo, &vmaAllocInfo, 
+                        &m_indirectCommandBuffer, &m_indirectCommandBufferMemory, &mappedInfo) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create indirect command buffer!");
+    }
+    m_indirectCommands = static_cast<VkDrawIndexedIndirectCommand*>(mappedInfo.pMappedData);
+
+    const VkDescriptorBufferInfo drawInstanceBufferInfo{m_drawInstanceBuffer, 0, sizeof(DrawInstance) * MAX_INDIRECT_DRAW_INSTANCES};
+    VkWriteDescriptorSet descriptorWrite{};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = m_drawInstanceBindGroup;
+    descriptorWrite.dstBinding = 0;
+    descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.pBufferInfo = &drawInstanceBufferInfo;
+    vkUpdateDescriptorSets(RenderSys::Vulkan::GetDevice(), 1, &descriptorWrite, 0, nullptr);
+}
+
+void VulkanRenderer3D::DestroyDrawInstanceBindGroup()
+{
+    if (m_drawInstanceBindGroupLayout == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    vkDeviceWaitIdle(RenderSys::Vulkan::GetDevice());
+    vkDestroyDescriptorPool(RenderSys::Vulkan::GetDevice(), m_drawInstanceBindGroupPool, nullptr);
+    vkDestroyDescriptorSetLayout(RenderSys::Vulkan::GetDevice(), m_drawInstanceBindGroupLayout, nullptr);
+    vmaDestroyBuffer(RenderSys::Vulkan::GetMemoryAllocator(), m_drawInstanceBuffer, m_drawInstanceBufferMemory);
+    vmaDestroyBuffer(RenderSys::Vulkan::GetMemoryAllocator(), m_indirectCommandBuffer, m_indirectCommandBufferMemory);
+    m_drawInstanceBindGroupPool = VK_NULL_HANDLE;
+    m_drawInstanceBindGroupLayout = VK_NULL_HANDLE;
+    m_drawInstanceBindGroup = VK_NULL_HANDLE;
+    m_drawInstanceBuffer = VK_NULL_HANDLE;
+    m_drawInstanceBufferMemory = VK_NULL_HANDLE;
+    m_drawInstances = nullptr;
+    m_indirectCommandBuffer = VK_NULL_HANDLE;
+    m_indirectCommandBufferMemory = VK_NULL_HANDLE;
+    m_indirectCommands = nullptr;
+}
+
+VkDescriptorSetLayout VulkanRenderer3D::GetMaterialBindGroupLayout() const
+{
+    return m_bindlessMaterials ? RenderSys::GetBindlessMaterialBindGroupLayout() : RenderSys::GetMaterialBindGroupLayout();
+}
+
+VkDescriptorSet VulkanRenderer3D::GetMaterialBindGroup(const RenderSys::Material& material) const
+{
+    return m_bindlessMaterials ? RenderSys::GetBindlessMaterialBindGroup() : material.GetDescriptor()->GetPlatformDescriptor()->m_bindGroup;
+}
+
+void VulkanRenderer3D::PushMaterialConstants(const RenderSys::Material& material, VkPipelineLayout pipelineLayout)
+{
+    if (m_bindlessMaterials)
+    {
+        const uint32_t materialIndex = material.GetDescriptor()->GetPlatformDescriptor()->m_bindlessIndex;
+        assert(materialIndex != RenderSys::VulkanMaterialDescriptor::NO_BINDLESS_INDEX);
+        vkCmdPushConstants(m_commandBuffer, pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(materialIndex), &materialIndex);
+    }
+    else
+    {
+        vkCmdPushConstants(m_commandBuffer, pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, 
+                        sizeof(RenderSys::MaterialProperties), &material.GetMaterialProperties());
+    }
+}
+
+void VulkanRenderer3D::RenderSubMesh(const uint32_t vertexBufferID, const RenderSys::SubMesh& subMesh, VkPipelineLayout pipelineLayout)
+{
+    auto materialBindGroup = GetMaterialBindGroup(*subMesh.m_Material);
+    assert(materialBindGroup != VK_NULL_HANDLE);
+    auto resourceBindGroup = subMesh.m_Resource->GetDescriptor()->GetPlatformDescriptor()->m_bindGroup;
+    assert(resourceBindGroup != VK_NULL_HANDLE);
+    const std::array<VkDescriptorSet, 3> descriptorsets{m_mainBindGroup, materialBindGroup, resourceBindGroup};
+
+    vkCmdBindDescriptorSets(m_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0
+                                , descriptorsets.size(), descriptorsets.data()
+                                , 0, nullptr);
+    if (pipelineLayout == m_pbrRenderPipeline->GetPipelineLayout())
+    {
+        // the indirect PBR pipeline reads its instances through the draw instances of a render queue
+        assert(!m_multiDrawIndirect);
+        PushMaterialConstants(*subMesh.m_Material, pipelineLayout);
+    }
+
+    assert(vertexBufferID >= 1);
+    const auto& vertexIndexBufferInfoIter = m_vertexIndexBufferInfoMap.find(vertexBufferID);
+    if (vertexIndexBufferInfoIter == m_vertexIndexBufferInfoMap.end())
+    {
+        std::cout << "Error: could not find vertexIndexBufferInfo!" << std::endl;
+        assert(false);
+        return;
+    }
+
+    auto vertexIndexBufferInfo = vertexIndexBufferInfoIter->second;
+    if (vertexIndexBufferInfo->m_indexCount > 0)
+    {
+        assert(subMesh.m_InstanceCount > 0);
+        if (subMesh.m_IndexCount > 0)
+        {
+            vkCmdDrawIndexed(m_commandBuffer, subMesh.m_IndexCount, subMesh.m_InstanceCount, subMesh.m_FirstIndex, 0, 0);
+        }
+        else
+        {
+            vkCmdDrawIndexed(m_commandBuffer, vertexIndexBufferInfo->m_indexCount, subMesh.m_InstanceCount, 0, 0, 0);
+        }
+    }
+    else
+    {
+        vkCmdDraw(m_commandBuffer, vertexIndexBufferInfo->m_vertexCount, 1, 0, 0);
+    }
+}
+
+void VulkanRenderer3D::DrawPlane()
+{
+}
+
+void VulkanRenderer3D::DrawCube()
+{
+}
+
+ImTextureID VulkanRenderer3D::GetDescriptorSet()
+{
+    return m_finalImageDescriptorSet;
+}
+
+void VulkanRenderer3D::BeginRenderPass()
+{
+    BeginProfileScope("Main pass");
+    BeginMainRenderPass(m_renderpass);
+}
+
+void VulkanRenderer3D::BeginMainRenderPass(VkRenderPass renderPass)
+{
+    std::array<VkClearValue, 2> clearValues{};
+    clearValues[0].color = m_clearColor;
+    clearValues[1].depthStencil = {1.0f, 0};
+
+    assert(m_frameBuffer);
+    VkRenderPassBeginInfo rpInfo{};
+    rpInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    rpInfo.renderPass = renderPass;
+    rpInfo.renderArea.offset = {0, 0};
+    rpInfo.renderArea.extent = { m_width, m_height };
+    rpInfo.framebuffer = m_frameBuffer; // both render passes are compatible with it
+    rpInfo.clearValueCount = 2;
+    rpInfo.pClearValues = clearValues.data();
+
+    vkCmdBeginRenderPass(m_commandBuffer, &rpInfo, VK_SUBPASS_CONTENTS_INLINE);
 
     VkViewport viewport{};
     viewport.x = 0.0f;
@@ -841,72 +1815,83 @@ void VulkanRenderer3D::BeginRenderPass()
 }
 
 void VulkanRenderer3D::EndRenderPass()
+{
+    EndMainRenderPass();
+    EndProfileScope();
+}
+
+void VulkanRenderer3D::EndMainRenderPass()
 {
     vkCmdEndRenderPass(m_commandBuffer);
 }
 
-void VulkanRenderer3D::BeginShadowMapPass()
+void VulkanRenderer3D::CreateShadowMap(const uint32_t resolution, const uint32_t cascadeCount)
 {
-    if (!m_shadowMap && !m_shadowRenderPipeline)
+    for (const auto& shadowMap : {m_shadowMap, m_staticShadowMap})
+    {
+        if (shadowMap)
+        {
+            m_retiredShadowMaps.push_back(shadowMap);
+        }
+    }
+    m_shadowMap = std::make_shared<RenderSys::Vulkan::ShadowMap>(static_cast<int>(resolution), cascadeCount);
+    m_staticShadowMap = std::make_shared<RenderSys::Vulkan::ShadowMap>(static_cast<int>(resolution), cascadeCount);
+    m_shadowCasterCache.Invalidate();
+    WriteShadowMapBinding();
+    // the render passes of all shadow maps are compatible, the pipeline is kept when the cascades change
+    if (m_shadowRenderPipeline)
     {
-        constexpr int shadowMapResolution = 2048;
-        m_shadowMap = std::make_shared<RenderSys::Vulkan::ShadowMap>(shadowMapResolution);
+        return;
+    }
 
-        std::vector<VkDescriptorSetLayout> layouts{m_mainBindGroupLayout, 
-                                                    RenderSys::GetMaterialBindGroupLayout(),
-                                                    RenderSys::GetResourceBindGroupLayout()};
+    std::vector<VkDescriptorSetLayout> layouts{m_mainBindGroupLayout, 
+                                                GetMaterialBindGroupLayout(),
+                                                RenderSys::GetResourceBindGroupLayout()};
 
-        std::vector<VkPipelineShaderStageCreateInfo> shadowShaderStageInfos;
-        {
-// TODO : remove this macro usage 
-#define SHADOW_SHADER_DIR "C:/develop/cpp/RenderSys/example/3D/Advanced/4.ShadowMapping/"
-            RenderSys::Shader vertexShader(std::string(SHADOW_SHADER_DIR) + std::string("shadow-vert.glsl"));
-            vertexShader.type = RenderSys::ShaderType::SPIRV;
-            vertexShader.stage = RenderSys::ShaderStage::Vertex;
-            assert(vertexShader.Compile());
-            auto compiledShaderVert = vertexShader.GetCompiledShader();
-
-            VkShaderModuleCreateInfo shaderCreateInfo{};
-            shaderCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-            shaderCreateInfo.codeSize = sizeof(uint32_t) * compiledShaderVert.size();
-            shaderCreateInfo.pCode = compiledShaderVert.data();
-            auto shadowShaderStageInfo = CreateShaderModule(shaderCreateInfo, vertexShader.stage);
-            if (shadowShaderStageInfo)
-            {
-                shadowShaderStageInfos.push_back(*shadowShaderStageInfo);
-            }
+    // depth only, no fragment shader
+    auto shadowShaderStageInfo = LoadShader("shadow-vertex.glsl", RenderSys::ShaderStage::Vertex);
+    if (!shadowShaderStageInfo)
+    {
+        assert(false);
+        return;
+    }
+    std::vector<VkPipelineShaderStageCreateInfo> shadowShaderStageInfos{*shadowShaderStageInfo};
 
-            RenderSys::Shader fragmentShader(std::string(SHADOW_SHADER_DIR) + std::string("shadow-frag.glsl"));
-            fragmentShader.type = RenderSys::ShaderType::SPIRV;
-            fragmentShader.stage = RenderSys::ShaderStage::Fragment;
-            assert(fragmentShader.Compile());
-            auto compiledShaderFrag = fragmentShader.GetCompiledShader();
-
-            VkShaderModuleCreateInfo shaderCreateInfoFrag{};
-            shaderCreateInfoFrag.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-            shaderCreateInfoFrag.codeSize = sizeof(uint32_t) * compiledShaderFrag.size();
-            shaderCreateInfoFrag.pCode = compiledShaderFrag.data();
-            auto shadowShaderStageInfoFrag = CreateShaderModule(shaderCreateInfoFrag, fragmentShader.stage);
-            if (shadowShaderStageInfoFrag)
-            {
-                shadowShaderStageInfos.push_back(*shadowShaderStageInfoFrag);
-            }
-        }
+    m_shadowRenderPipeline = std::make_unique<Vulkan::ShadowRenderPipeline>(
+        m_shadowMap->GetShadowRenderPass(), layouts, m_vertexInputLayout, shadowShaderStageInfos);
+}
 
-        m_shadowRenderPipeline = std::make_unique<Vulkan::ShadowRenderPipeline>(
-            m_shadowMap->GetShadowRenderPass(), layouts, m_vertexInputLayout, shadowShaderStageInfos);
+void VulkanRenderer3D::WriteShadowMapBinding()
+{
+    if (!m_shadowMap || m_mainBindGroup == VK_NULL_HANDLE || m_shadowMapBinding == NO_SHADOW_MAP_BINDING)
+    {
+        return;
     }
 
+    // before the main bind group is bound in the command buffer of the frame, the frame before has completed
+    VkWriteDescriptorSet descriptorWrite{};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = m_mainBindGroup;
+    descriptorWrite.dstBinding = m_shadowMapBinding;
+    descriptorWrite.dstArrayElement = 0;
+    descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.pImageInfo = &m_shadowMap->GetDescriptorImageInfo();
+    vkUpdateDescriptorSets(RenderSys::Vulkan::GetDevice(), 1, &descriptorWrite, 0, nullptr);
+}
+
+void VulkanRenderer3D::BeginShadowMapPass(Vulkan::ShadowMap& shadowMap, const uint32_t cascade, const bool loadDepth)
+{
     if (!m_commandBuffer)
         return;
 
     VkRenderPassBeginInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass = m_shadowMap->GetShadowRenderPass();
-    renderPassInfo.framebuffer = m_shadowMap->GetShadowFrameBuffer();
+    renderPassInfo.renderPass = loadDepth ? shadowMap.GetShadowLoadRenderPass() : shadowMap.GetShadowRenderPass();
+    renderPassInfo.framebuffer = shadowMap.GetShadowFrameBuffer(cascade);
 
     renderPassInfo.renderArea.offset = {0, 0};
-    renderPassInfo.renderArea.extent = m_shadowMap->GetShadowMapExtent();
+    renderPassInfo.renderArea.extent = shadowMap.GetShadowMapExtent();
 
     std::array<VkClearValue, static_cast<uint32_t>(Vulkan::ShadowMap::ShadowRenderTargets::NUMBER_OF_ATTACHMENTS)> clearValues{};
     clearValues[0].depthStencil = {1.0f, 0};
@@ -918,30 +1903,96 @@ void VulkanRenderer3D::BeginShadowMapPass()
     VkViewport viewport{};
     viewport.x = 0.0f;
     viewport.y = 0.0f;
-    viewport.width = static_cast<float>(m_shadowMap->GetShadowMapExtent().width);
-    viewport.height = static_cast<float>(m_shadowMap->GetShadowMapExtent().height);
+    viewport.width = static_cast<float>(shadowMap.GetShadowMapExtent().width);
+    viewport.height = static_cast<float>(shadowMap.GetShadowMapExtent().height);
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
-    VkRect2D scissor{{0, 0}, m_shadowMap->GetShadowMapExtent()};
+    VkRect2D scissor{{0, 0}, shadowMap.GetShadowMapExtent()};
     vkCmdSetViewport(m_commandBuffer, 0, 1, &viewport);
     vkCmdSetScissor(m_commandBuffer, 0, 1, &scissor);
 }
 
-void VulkanRenderer3D::RenderShadowMap(entt::registry& entityRegistry)
+void VulkanRenderer3D::FilterShadowCasters(const RenderSys::RenderQueue& casters, const RenderSys::ShadowCascades& shadowCascades, const uint32_t cascade)
 {
-    vkCmdBindPipeline(m_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_shadowRenderPipeline->GetPipeline());
+    // filtering keeps the sorted order, packets without bounds are drawn into every cascade
+    m_cascadeRenderQueue.Clear();
+    for (const auto& packet : casters.GetPackets())
+    {
+        if (!packet.m_HasBounds || shadowCascades.IsCasterVisible(cascade, packet.m_BoundsMin, packet.m_BoundsMax))
+        {
+            m_cascadeRenderQueue.Submit(packet);
+        }
+        else
+        {
+            m_renderQueueStats.m_CulledShadowCasters++;
+        }
+    }
+}
 
-    auto view = entityRegistry.view<RenderSys::MeshComponent,
-                                                RenderSys::TransformComponent,
-                                                RenderSys::InstanceTagComponent>();
-    for (auto entity : view)
+void VulkanRenderer3D::DrawShadowCascade(Vulkan::ShadowMap& shadowMap, const uint32_t cascade, const bool loadDepth, const glm::mat4& viewProjection)
+{
+    // the dynamic casters are drawn over the copied static ones
+    BeginProfileScope((loadDepth ? "Dynamic casters, cascade " : "Static casters, cascade ") + std::to_string(cascade));
+    BeginShadowMapPass(shadowMap, cascade, loadDepth);
+    // push constants stay valid when SubmitRenderQueue() binds the shadow pipeline, it has the same layout
+    Vulkan::ShadowRenderPipeline::PushConstants pushConstants{viewProjection};
+    vkCmdPushConstants(m_commandBuffer, m_shadowRenderPipeline->GetPipelineLayout(), VK_SHADER_STAGE_VERTEX_BIT, 
+                        0, sizeof(pushConstants), &pushConstants);
+    m_renderQueueStats.m_PushConstantUpdates++;
+    SubmitRenderQueue(m_cascadeRenderQueue);
+    EndShadowMapPass();
+    EndProfileScope();
+}
+
+void VulkanRenderer3D::RenderShadowMap(entt::registry& entityRegistry, const RenderSys::ShadowCascades& shadowCascades)
+{
+    const auto& settings = shadowCascades.GetSettings();
+    if (!m_shadowMap || m_shadowMap->GetCascadeCount() != settings.m_CascadeCount 
+        || m_shadowMap->GetShadowMapExtent().width != settings.m_Resolution)
     {
-        auto& meshComponent = view.get<RenderSys::MeshComponent>(entity);
-        auto& instanceTagComponent = view.get<RenderSys::InstanceTagComponent>(entity);
-        instanceTagComponent.GetInstanceBuffer()->Update();
-        auto mesh = meshComponent.m_Mesh;
-        RenderMesh(*mesh, true);
+        CreateShadowMap(settings.m_Resolution, settings.m_CascadeCount);
+    }
+
+    if (!m_commandBuffer)
+        return;
+
+    BeginProfileScope("Shadow pass");
+    // depth does not matter for a depth only pass, the queue just groups the draws by state
+    m_shadowRenderQueue.Clear();
+    m_shadowRenderQueue.SubmitRegistry(entityRegistry, glm::vec3(0.0f), RenderSys::RenderPipeline::SHADOW);
+    m_shadowRenderQueue.Sort();
+    m_shadowCasterCache.Update(m_shadowRenderQueue);
+
+    for (uint32_t cascade = 0; cascade < shadowCascades.GetCascadeCount(); ++cascade)
+    {
+        const auto& viewProjection = shadowCascades.GetCascade(cascade).m_ViewProjection;
+        bool staticLayerDrawn = false;
+        if (!m_shadowCasterCache.IsCascadeCached(cascade, viewProjection))
+        {
+            FilterShadowCasters(m_shadowCasterCache.GetStaticCasters(), shadowCascades, cascade);
+            DrawShadowCascade(*m_staticShadowMap, cascade, false, viewProjection);
+            m_shadowCasterCache.SetCascadeCached(cascade, viewProjection);
+            staticLayerDrawn = true;
+        }
+        else
+        {
+            m_renderQueueStats.m_CachedShadowCascades++;
+        }
+
+        FilterShadowCasters(m_shadowCasterCache.GetDynamicCasters(), shadowCascades, cascade);
+        const bool drawDynamicCasters = m_cascadeRenderQueue.GetPacketCount() > 0;
+        // without changes the layer still holds the static casters alone, nothing is recorded for it
+        if (drawDynamicCasters || staticLayerDrawn || m_shadowLayerHasDynamicCasters[cascade])
+        {
+            m_shadowMap->CopyLayer(m_commandBuffer, *m_staticShadowMap, cascade, drawDynamicCasters);
+        }
+        if (drawDynamicCasters)
+        {
+            DrawShadowCascade(*m_shadowMap, cascade, true, viewProjection);
+        }
+        m_shadowLayerHasDynamicCasters[cascade] = drawDynamicCasters;
     }
+    EndProfileScope();
 }
 
 void VulkanRenderer3D::EndShadowMapPass()
@@ -952,23 +2003,126 @@ void VulkanRenderer3D::EndShadowMapPass()
     vkCmdEndRenderPass(m_commandBuffer);
 }
 
+void VulkanRenderer3D::RenderSkinning(entt::registry& entityRegistry)
+{
+    if (!m_skinningPipeline || !m_commandBuffer)
+        return;
+
+    BeginProfileScope("Skinning");
+    // instances share the vertex buffers of the entity holding the InstanceTagComponent, so only that one is skinned
+    auto view = entityRegistry.view<RenderSys::MeshComponent,
+                                    RenderSys::SkeletonComponent,
+                                    RenderSys::InstanceTagComponent>();
+
+    // the poses written since the last frame, the skinning of the frame before has read the joint buffers by then
+    VkMemoryBarrier uploadBarrier{};
+    uploadBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    uploadBarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    uploadBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    bool uploaded = false;
+    for (auto entity : view)
+    {
+        // shared by the meshes of one character, the first of them copies it
+        const auto& jointMatrices = view.get<RenderSys::SkeletonComponent>(entity).m_JointMatricesBuffer;
+        if (!jointMatrices || !jointMatrices->m_UploadPending)
+        {
+            continue;
+        }
+        if (!uploaded)
+        {
+            vkCmdPipelineBarrier(m_commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 
+                                    0, 1, &uploadBarrier, 0, nullptr, 0, nullptr);
+            uploaded = true;
+        }
+        const VkDescriptorBufferInfo& source = jointMatrices->m_Uploads[jointMatrices->m_CurrentUpload]->GetPlatformBuffer()->GetBufferInfo();
+        const VkDescriptorBufferInfo& destination = jointMatrices->m_Buffer->GetPlatformBuffer()->GetBufferInfo();
+        const VkBufferCopy region{0, 0, destination.range};
+        vkCmdCopyBuffer(m_commandBuffer, source.buffer, destination.buffer, 1, &region);
+        jointMatrices->m_UploadPending = false;
+    }
+    if (uploaded)
+    {
+        uploadBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        uploadBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(m_commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 
+                                0, 1, &uploadBarrier, 0, nullptr, 0, nullptr);
+    }
+
+    bool dispatched = false;
+    for (auto entity : view)
+    {
+        const auto& mesh = view.get<RenderSys::MeshComponent>(entity).m_Mesh;
+        const auto& skeleton = view.get<RenderSys::SkeletonComponent>(entity).m_Skeleton;
+        auto vertexIndexBufferInfoIter = m_vertexIndexBufferInfoMap.find(mesh->vertexBufferID);
+        if (vertexIndexBufferInfoIter == m_vertexIndexBufferInfoMap.end() || 
+            vertexIndexBufferInfoIter->second->m_skinningBindGroup == VK_NULL_HANDLE)
+        {
+            continue;
+        }
+        const auto& vertexIndexBufferInfo = vertexIndexBufferInfoIter->second;
+
+        assert(mesh->subMeshes.size() > 0 && mesh->subMeshes[0].m_Resource);
+        auto resourceBindGroup = mesh->subMeshes[0].m_Resource->GetDescriptor()->GetPlatformDescriptor()->m_bindGroup;
+        assert(resourceBindGroup != VK_NULL_HANDLE);
+        std::array<VkDescriptorSet, 2> descriptorsets{vertexIndexBufferInfo->m_skinningBindGroup, resourceBindGroup};
+
+        if (!dispatched)
+        {
+            vkCmdBindPipeline(m_commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_skinningPipeline->GetPipeline());
+            dispatched = true;
+        }
+        vkCmdBindDescriptorSets(m_commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_skinningPipeline->GetPipelineLayout(), 0
+                                    , descriptorsets.size(), descriptorsets.data()
+                                    , 0, nullptr);
+
+        const Vulkan::SkinningComputePipeline::PushConstants pushConstants{vertexIndexBufferInfo->m_vertexCount, 
+                                                                            static_cast<uint32_t>(skeleton->m_SkinningMethod)};
+        vkCmdPushConstants(m_commandBuffer, m_skinningPipeline->GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, 
+                            sizeof(pushConstants), &pushConstants);
+
+        const uint32_t workgroupCount = (vertexIndexBufferInfo->m_vertexCount + Vulkan::SkinningComputePipeline::WORKGROUP_SIZE - 1) 
+                                            / Vulkan::SkinningComputePipeline::WORKGROUP_SIZE;
+        vkCmdDispatch(m_commandBuffer, workgroupCount, 1, 1);
+        m_renderQueueStats.m_Dispatches++;
+    }
+
+    if (!dispatched)
+    {
+        EndProfileScope();
+        return;
+    }
+
+    // one barrier for all skinned meshes, every following pass only reads the skinned vertices
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+    vkCmdPipelineBarrier(m_commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 
+                            0, 1, &barrier, 0, nullptr, 0, nullptr);
+    EndProfileScope();
+}
+
 void VulkanRenderer3D::DestroyTextures()
 {
     m_textures.clear();
     
     if (m_defaultTextureSampler)
     {
-        vkDestroySampler(GraphicsAPI::Vulkan::GetDevice(), m_defaultTextureSampler, nullptr);
+        vkDestroySampler(RenderSys::Vulkan::GetDevice(), m_defaultTextureSampler, nullptr);
         m_defaultTextureSampler = VK_NULL_HANDLE;
     }
 }
 
 void VulkanRenderer3D::Destroy()
 {
+    // the frame submitted last may still use everything destroyed below
+    WaitForFrame();
     RenderSys::DestroyResourceBindGroupLayout();
     RenderSys::DestroyResourceBindGroupPool();
     RenderSys::DestroyMaterialBindGroupLayout();
     RenderSys::DestroyMaterialBindGroupPool();
+    RenderSys::DestroyBindlessMaterialBindGroup();
+    DestroyDrawInstanceBindGroup();
 
     DestroyShaders();
     DestroyBindGroup();
@@ -980,12 +2134,43 @@ void VulkanRenderer3D::Destroy()
     m_pbrRenderPipeline.reset();
     m_shadowRenderPipeline.reset();
     m_shadowMap.reset();
+    m_staticShadowMap.reset();
+    m_retiredShadowMaps.clear();
+    m_skinningPipeline.reset();
+    m_hzbCullingPipeline.reset();
+    m_meshletCullingPipeline.reset();
+    m_queryProfiler.reset();
 
     RenderSys::Vulkan::DestroyMemoryAllocator();
 }
 
 void VulkanRenderer3D::ResetCommandBuffer()
 {
+    // the command buffer and the culling counters are reused, the frame recorded into them last has to be complete
+    WaitForFrame();
+    m_retiredShadowMaps.clear();
+    PollRenderedImages();
+    m_renderQueueStats = {};
+    if (m_occlusionCulled)
+    {
+        // the last frame has completed, its culling results can be read
+        const auto counters = m_hzbCullingPipeline->ReadCounters();
+        m_renderQueueStats.m_VisibleDraws = counters.m_Visible;
+        m_renderQueueStats.m_OccludedDraws = counters.m_Occluded;
+        m_renderQueueStats.m_FrustumCulledDraws = counters.m_FrustumCulled;
+        m_occlusionCulled = false;
+    }
+    if (m_meshletCulled)
+    {
+        const auto counters = m_meshletCullingPipeline->ReadCounters();
+        m_renderQueueStats.m_VisibleMeshlets = counters.m_Visible;
+        m_renderQueueStats.m_FrustumCulledMeshlets = counters.m_FrustumCulled;
+        m_renderQueueStats.m_ConeCulledMeshlets = counters.m_ConeCulled;
+        m_meshletCulled = false;
+    }
+    m_drawInstanceCount = 0;
+    m_indirectCommandCount = 0;
+
     auto err = vkResetCommandBuffer(m_commandBuffer, 0);
     GraphicsAPI::Vulkan::check_vk_result(err);
 
@@ -994,10 +2179,17 @@ void VulkanRenderer3D::ResetCommandBuffer()
     begin_info.flags |= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
     err = vkBeginCommandBuffer(m_commandBuffer, &begin_info);
     GraphicsAPI::Vulkan::check_vk_result(err);
+
+    // resolves the frame recorded QueryProfiler::FRAME_LATENCY frames before
+    m_queryProfiler->BeginFrame(m_commandBuffer);
+    BeginProfileScope("Frame");
 }
 
 void VulkanRenderer3D::SubmitCommandBuffer()
 {
+    EndProfileScope();
+    m_queryProfiler->EndFrame();
+
     auto err = vkEndCommandBuffer(m_commandBuffer);
     GraphicsAPI::Vulkan::check_vk_result(err);
 
@@ -1005,7 +2197,51 @@ void VulkanRenderer3D::SubmitCommandBuffer()
     end_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
     end_info.commandBufferCount = 1;
     end_info.pCommandBuffers = &m_commandBuffer;
-    GraphicsAPI::Vulkan::QueueSubmit(end_info);
+    // submitted here and not with QueueSubmit(), the fence has to signal with this command buffer and the
+    // submission happens before the one of the frame of the application, which samples the rendered image
+    err = vkQueueSubmit(RenderSys::Vulkan::GetDeviceQueue(), 1, &end_info, m_frameFence);
+    GraphicsAPI::Vulkan::check_vk_result(err);
+    m_frameSubmitted = true;
+    // an empty submission signals its fence once everything submitted before it has completed
+    for (auto& readback : m_imageReadbacks)
+    {
+        if (readback.m_pending && !readback.m_submitted)
+        {
+            err = vkQueueSubmit(RenderSys::Vulkan::GetDeviceQueue(), 0, nullptr, readback.m_fence);
+            GraphicsAPI::Vulkan::check_vk_result(err);
+            readback.m_submitted = true;
+        }
+    }
+}
+
+void VulkanRenderer3D::BeginProfileScope(const std::string& name)
+{
+    if (m_queryProfiler && m_queryProfiler->IsInFrame())
+    {
+        m_queryProfiler->BeginScope(m_commandBuffer, name, GetProfileCounters());
+    }
+}
+
+void VulkanRenderer3D::EndProfileScope()
+{
+    if (m_queryProfiler && m_queryProfiler->IsInFrame())
+    {
+        m_queryProfiler->EndScope(m_commandBuffer, GetProfileCounters());
+    }
+}
+
+RenderSys::GpuProfiler* VulkanRenderer3D::GetGpuProfiler()
+{
+    return m_queryProfiler ? &m_queryProfiler->GetProfiler() : nullptr;
+}
+
+RenderSys::GpuProfileCounters VulkanRenderer3D::GetProfileCounters() const
+{
+    RenderSys::GpuProfileCounters counters;
+    counters.m_Draws = m_renderQueueStats.m_Draws;
+    counters.m_Triangles = m_renderQueueStats.m_Triangles;
+    counters.m_Dispatches = m_renderQueueStats.m_Dispatches;
+    return counters;
 }
 
 VkImageView createImguiImageView(const std::shared_ptr<RenderSys::Vulkan::ShadowMap>& shadowMap)
@@ -1035,7 +2271,7 @@ VkImageView createImguiImageView(const std::shared_ptr<RenderSys::Vulkan::Shadow
     };
     viewInfo.components = componentMapping;
 
-    if (vkCreateImageView(GraphicsAPI::Vulkan::GetDevice(), &viewInfo, nullptr, &m_imguiView) != VK_SUCCESS) {
+    if (vkCreateImageView(RenderSys::Vulkan::GetDevice(), &viewInfo, nullptr, &m_imguiView) != VK_SUCCESS) {
         assert(false);
     }
 
@@ -1154,6 +2390,190 @@ std::vector<uint8_t>& VulkanRenderer3D::GetRenderedImageDataToCPUSide()
     return m_cpuImageData->imageData;
 }
 
+void VulkanRenderer3D::CreateImageReadbacks()
+{
+    const VkDeviceSize imageSize = m_width * m_height * 4; // R8G8B8A8_UNORM
+    for (auto& readback : m_imageReadbacks)
+    {
+        assert(readback.m_stagingBuffer == VK_NULL_HANDLE);
+        VkBufferCreateInfo bufferInfo{};
+        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInfo.size = imageSize;
+        bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+        VmaAllocationCreateInfo allocInfo{};
+        allocInfo.usage = VMA_MEMORY_USAGE_GPU_TO_CPU;
+        allocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+        VmaAllocationInfo allocationInfo{};
+        if (vmaCreateBuffer(RenderSys::Vulkan::GetMemoryAllocator(), &bufferInfo, &allocInfo, &readback.m_stagingBuffer, 
+                            &readback.m_stagingBufferMemory, &allocationInfo) != VK_SUCCESS)
+        {
+            std::cout << "Failed to create readback staging buffer!" << std::endl;
+            assert(false);
+            return;
+        }
+        readback.m_mappedData = static_cast<const uint8_t*>(allocationInfo.pMappedData);
+        readback.m_size = static_cast<size_t>(imageSize);
+        readback.m_width = m_width;
+        readback.m_height = m_height;
+
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        auto err = vkCreateFence(RenderSys::Vulkan::GetDevice(), &fenceInfo, nullptr, &readback.m_fence);
+        GraphicsAPI::Vulkan::check_vk_result(err);
+    }
+}
+
+void VulkanRenderer3D::DestroyImageReadbacks()
+{
+    for (auto& readback : m_imageReadbacks)
+    {
+        if (readback.m_fence != VK_NULL_HANDLE)
+        {
+            vkDestroyFence(RenderSys::Vulkan::GetDevice(), readback.m_fence, nullptr);
+        }
+        if (readback.m_stagingBuffer != VK_NULL_HANDLE)
+        {
+            vmaDestroyBuffer(RenderSys::Vulkan::GetMemoryAllocator(), readback.m_stagingBuffer, readback.m_stagingBufferMemory);
+        }
+        // requests of a frame which was never submitted are dropped
+        readback = ImageReadback{};
+    }
+}
+
+uint64_t VulkanRenderer3D::RequestRenderedImage(RenderSys::RenderedImageCallback callback)
+{
+    assert(m_commandBuffer && m_ImageToRenderInto);
+    auto findFreeReadback = [this]() -> ImageReadback*
+    {
+        for (auto& readback : m_imageReadbacks)
+        {
+            if (!readback.m_pending)
+            {
+                return &readback;
+            }
+        }
+        return nullptr;
+    };
+
+    auto* readback = findFreeReadback();
+    // all staging buffers are in flight, the oldest one is needed again
+    if (!readback && DeliverOldestImageReadback(true))
+    {
+        readback = findFreeReadback();
+    }
+    if (!readback)
+    {
+        std::cout << "error: more than " << IMAGE_READBACK_COUNT << " readbacks requested in one frame" << std::endl;
+        assert(false);
+        return 0;
+    }
+
+    auto err = vkResetFences(RenderSys::Vulkan::GetDevice(), 1, &readback->m_fence);
+    GraphicsAPI::Vulkan::check_vk_result(err);
+    readback->m_callback = std::move(callback);
+    readback->m_ticket = m_nextReadbackTicket++;
+    readback->m_pending = true;
+    readback->m_submitted = false;
+
+    VkImageMemoryBarrier imageBarrier{};
+    imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    imageBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    imageBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    imageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.image = m_ImageToRenderInto;
+    imageBarrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    vkCmdPipelineBarrier(m_commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 
+                            0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+
+    VkBufferImageCopy region{};
+    region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    region.imageExtent = {readback->m_width, readback->m_height, 1};
+    vkCmdCopyImageToBuffer(m_commandBuffer, m_ImageToRenderInto, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, 
+                            readback->m_stagingBuffer, 1, &region);
+
+    // back to the layout the render pass and ImGui expect
+    imageBarrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    imageBarrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT;
+    imageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    imageBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    VkBufferMemoryBarrier bufferBarrier{};
+    bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    bufferBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.buffer = readback->m_stagingBuffer;
+    bufferBarrier.offset = 0;
+    bufferBarrier.size = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(m_commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, 
+                            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_HOST_BIT, 
+                            0, 0, nullptr, 1, &bufferBarrier, 1, &imageBarrier);
+    return readback->m_ticket;
+}
+
+void VulkanRenderer3D::PollRenderedImages()
+{
+    while (DeliverOldestImageReadback(false))
+    {
+    }
+}
+
+void VulkanRenderer3D::WaitRenderedImages()
+{
+    while (DeliverOldestImageReadback(true))
+    {
+    }
+}
+
+bool VulkanRenderer3D::DeliverOldestImageReadback(const bool wait)
+{
+    ImageReadback* oldest = nullptr;
+    for (auto& readback : m_imageReadbacks)
+    {
+        if (readback.m_pending && readback.m_submitted && (!oldest || readback.m_ticket < oldest->m_ticket))
+        {
+            oldest = &readback;
+        }
+    }
+    if (!oldest)
+    {
+        return false;
+    }
+
+    if (wait)
+    {
+        auto err = vkWaitForFences(RenderSys::Vulkan::GetDevice(), 1, &oldest->m_fence, VK_TRUE, UINT64_MAX);
+        GraphicsAPI::Vulkan::check_vk_result(err);
+    }
+    else if (vkGetFenceStatus(RenderSys::Vulkan::GetDevice(), oldest->m_fence) != VK_SUCCESS)
+    {
+        // later readbacks wait for this one, they are delivered in the order of their requests
+        return false;
+    }
+
+    vmaInvalidateAllocation(RenderSys::Vulkan::GetMemoryAllocator(), oldest->m_stagingBufferMemory, 0, VK_WHOLE_SIZE);
+    oldest->m_pending = false;
+    oldest->m_submitted = false;
+    auto callback = std::move(oldest->m_callback);
+    oldest->m_callback = nullptr;
+    if (callback)
+    {
+        RenderSys::RenderedImageView view;
+        view.pixels = oldest->m_mappedData;
+        view.size = oldest->m_size;
+        view.width = oldest->m_width;
+        view.height = oldest->m_height;
+        view.ticket = oldest->m_ticket;
+        callback(view);
+    }
+    return true;
+}
+
 void VulkanRenderer3D::CreateTexture(uint32_t binding, const std::shared_ptr<RenderSys::Texture> texture)
 {
     const auto& [textureIter, inserted] = m_textures.insert(
@@ -1191,7 +2611,7 @@ void VulkanRenderer3D::CreateDefaultTextureSampler()
     texSamplerInfo.anisotropyEnable = VK_FALSE;
     texSamplerInfo.maxAnisotropy = 1.0f;
 
-    if (vkCreateSampler(GraphicsAPI::Vulkan::GetDevice(), &texSamplerInfo, nullptr, &m_defaultTextureSampler) != VK_SUCCESS) {
+    if (vkCreateSampler(RenderSys::Vulkan::GetDevice(), &texSamplerInfo, nullptr, &m_defaultTextureSampler) != VK_SUCCESS) {
         std::cout << "error: could not create sampler for texture" << std::endl;
     }
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <array>
+#include <functional>
+#include <unordered_set>
 #include <stdint.h>
 #include <stddef.h>
 #include <glm/ext.hpp>
@@ -12,7 +14,12 @@
 #include <RenderSys/Buffer.h>
 #include <RenderSys/Texture.h>
 #include <RenderSys/Scene/Mesh.h>
+#include <RenderSys/RenderQueue.h>
+#include <RenderSys/ShadowCascades.h>
+#include <RenderSys/ShadowCasterCache.h>
+#include <RenderSys/GpuProfiler.h>
 #include <RenderSys/Vulkan/VulkanVertex.h>
+#include <resources/Shaders/ShaderResource.h>
 #include <entt/entt.hpp>
 
 
@@ -24,9 +31,20 @@ namespace Vulkan
 class ShadowMap;
 class PbrRenderPipeline;
 class ShadowRenderPipeline;
+class SkinningComputePipeline;
+class HzbCullingPipeline;
+class MeshletCullingPipeline;
+class QueryProfiler;
 
 } // namespace Vulkan
 
+// per instance data of the indirect draws, matches pbr-indirect-vertex.glsl
+struct DrawInstance
+{
+    uint32_t m_instance = 0;
+    uint32_t m_material = 0;
+};
+
 struct VulkanCPUImageCopyData
 {
     VkBuffer stagingBuffer = VK_NULL_HANDLE;
@@ -48,7 +66,13 @@ public:
     void CreatePipeline();
     void CreateFrameBuffer();
     uint32_t CreateVertexBuffer(const RenderSys::VertexBuffer& bufferData, RenderSys::VertexBufferLayout bufferLayout);
+    uint32_t CreateVertexBuffer(const void* bufferData, size_t bufferLength, RenderSys::VertexBufferLayout bufferLayout);
+    // writeVertices fills the bufferLength bytes of the mapped buffer
+    uint32_t CreateVertexBuffer(size_t bufferLength, RenderSys::VertexBufferLayout bufferLayout, const std::function<void(void*)>& writeVertices);
     void CreateIndexBuffer(uint32_t vertexBufferID, const std::vector<uint32_t> &bufferData);
+    void CreateSkinningBuffer(uint32_t vertexBufferID, const std::vector<RenderSys::SkinningVertex>& skinningData);
+    // after CreateIndexBuffer(), needs multi-draw indirect
+    void CreateMeshletBuffer(uint32_t vertexBufferID, const std::vector<RenderSys::Meshlet>& meshlets);
     void SetClearColor(glm::vec4 clearColor);
     void CreateBindGroup(const std::vector<RenderSys::BindGroupLayoutEntry>& bindGroupLayoutEntries);
     void CreateUniformBuffer(uint32_t binding, uint32_t sizeOfOneUniform);
@@ -59,15 +83,40 @@ public:
     void Render();
     void RenderIndexed();
     void RenderMesh(const RenderSys::Mesh& mesh, const bool shadowPass = false);
+    // draws a sorted queue, binding only the pipeline, descriptor sets, buffers and push constants which change
+    void SubmitRenderQueue(const RenderSys::RenderQueue& renderQueue);
+    const RenderSys::RenderQueueStats& GetRenderQueueStats() const { return m_renderQueueStats; }
+    bool SupportsBindlessMaterials() const;
+    // has to be set before the pipelines are created, the material bind group is then shared by all draws
+    void SetBindlessMaterials(const bool bindlessMaterials);
+    bool SupportsMultiDrawIndirect() const;
+    // needs bindless materials and has to be set before the pipelines are created, the PBR pipeline then reads
+    // its instances and materials through the draw instances at set 3 (pbr-indirect-vertex.glsl)
+    void SetMultiDrawIndirect(const bool multiDrawIndirect);
+    // same result as SubmitRenderQueue(), but the submeshes sharing a vertex buffer and resource bind group are
+    // drawn by one indirect draw call
+    void SubmitRenderQueueIndirect(const RenderSys::RenderQueue& renderQueue);
+    bool SupportsOcclusionCulling() const;
+    // replaces BeginRenderPass(), SubmitRenderQueueIndirect() and EndRenderPass(), once per frame: draws what was visible
+    // last frame, builds a depth pyramid from its depth and draws the rest of the queue which is not occluded by it
+    void SubmitRenderQueueOcclusionCulled(const RenderSys::RenderQueue& renderQueue, const glm::mat4& viewProjection);
+    bool SupportsMeshletCulling() const;
+    // replaces BeginRenderPass(), SubmitRenderQueueIndirect() and EndRenderPass(), once per frame: a compute pass culls
+    // the meshlets of the full detail submeshes with meshlets and compacts the indices of the visible ones, the other
+    // packets are drawn as they are
+    void SubmitRenderQueueMeshletCulled(const RenderSys::RenderQueue& renderQueue, const glm::mat4& viewProjection, const glm::vec3& viewPosition);
     void DrawPlane();
     void DrawCube();
     ImTextureID GetDescriptorSet();
     void BeginRenderPass();
     void EndRenderPass();
 
-    void BeginShadowMapPass();
-    void RenderShadowMap(entt::registry& entityRegistry);
-    void EndShadowMapPass();
+    // one depth pass per cascade into its layer of the shadow map, each draws only the casters of its light frustum
+    // the static casters are drawn into a cached shadow map, which is copied before the dynamic casters are drawn
+    void RenderShadowMap(entt::registry& entityRegistry, const RenderSys::ShadowCascades& shadowCascades);
+
+    // has to be recorded outside of any render pass, before the passes which draw the skinned meshes
+    void RenderSkinning(entt::registry& entityRegistry);
 
     void DestroyImages();
     void Destroy();
@@ -75,15 +124,104 @@ public:
     void SubmitCommandBuffer();
 
     void OnImGuiRender();
+    // copies through a single time command buffer and waits for it
     std::vector<uint8_t>& GetRenderedImageDataToCPUSide();
+    // records a copy of the rendered image into the command buffer of the frame, after its last render pass.
+    // The callback gets the image once the frame has completed, from PollRenderedImages(), WaitRenderedImages()
+    // or a later request which needs its staging buffer. Returns the ticket of the view, 0 when nothing was recorded.
+    uint64_t RequestRenderedImage(RenderSys::RenderedImageCallback callback);
+    // delivers the completed readbacks without waiting, also done by ResetCommandBuffer()
+    void PollRenderedImages();
+    // waits for the readbacks of the submitted frames and delivers them
+    void WaitRenderedImages();
+
+    // a named scope with timestamp queries in the command buffer of the frame, the shadow, skinning and main passes
+    // have their own. Scopes nest, outside of ResetCommandBuffer() and SubmitCommandBuffer() they are ignored
+    void BeginProfileScope(const std::string& name);
+    void EndProfileScope();
+    // the frames are resolved QueryProfiler::FRAME_LATENCY frames late, nullptr before Init()
+    RenderSys::GpuProfiler* GetGpuProfiler();
 
 private:
+    static constexpr uint32_t IMAGE_READBACK_COUNT = 3;
+
+    // staging buffer of an asynchronous readback, its fence is signaled by SubmitCommandBuffer()
+    struct ImageReadback
+    {
+        VkBuffer m_stagingBuffer = VK_NULL_HANDLE;
+        VmaAllocation m_stagingBufferMemory = VK_NULL_HANDLE;
+        const uint8_t* m_mappedData = nullptr;
+        size_t m_size = 0;
+        uint32_t m_width = 0;
+        uint32_t m_height = 0;
+        VkFence m_fence = VK_NULL_HANDLE;
+        RenderSys::RenderedImageCallback m_callback;
+        uint64_t m_ticket = 0;
+        // requested and not delivered yet
+        bool m_pending = false;
+        bool m_submitted = false;
+    };
+
+    // the commands of one batch share the vertex buffer and resource bind group
+    struct IndirectBatch
+    {
+        VkDescriptorSet m_resourceBindGroup = VK_NULL_HANDLE;
+        uint32_t m_vertexBufferID = 0;
+        Vulkan::VertexIndexBufferInfo* m_vertexIndexBufferInfo = nullptr;
+        uint32_t m_firstCommand = 0;
+        uint32_t m_commandCount = 0;
+        // not indexed, drawn directly instead of the commands
+        bool m_direct = false;
+        uint32_t m_directFirstInstance = 0;
+        // drawn from the culled index buffer
+        bool m_meshletCulled = false;
+    };
+
+    void BeginMainRenderPass(VkRenderPass renderPass);
+    void EndMainRenderPass();
+    // the totals of the frame so far
+    RenderSys::GpuProfileCounters GetProfileCounters() const;
+    VkRenderPass CreateMainRenderPass(const bool loadAttachments);
+    // writes the indirect commands of the queue, and with culling their bounds or meshlet draws
+    void BuildIndirectBatches(const RenderSys::RenderQueue& renderQueue, const bool occlusionCulled, const bool meshletCulled = false);
+    // whether the meshlets of the packet can be culled, each submesh is culled once per frame as it has one culled index range
+    bool CanCullMeshlets(const RenderSys::DrawPacket& packet);
+    void DrawIndirectBatches(const bool drawDirect);
+    void CreateHzbCullingPipeline();
+    void CreateMeshletCullingPipeline();
+    // the shadow map is created again when the cascade count or resolution changes
+    void CreateShadowMap(const uint32_t resolution, const uint32_t cascadeCount);
+    // into the shadow map binding of the main bind group, if it has one
+    void WriteShadowMapBinding();
+    void BeginShadowMapPass(Vulkan::ShadowMap& shadowMap, const uint32_t cascade, const bool loadDepth);
+    void EndShadowMapPass();
+    // fills m_cascadeRenderQueue with the casters visible to the cascade
+    void FilterShadowCasters(const RenderSys::RenderQueue& casters, const RenderSys::ShadowCascades& shadowCascades, const uint32_t cascade);
+    void DrawShadowCascade(Vulkan::ShadowMap& shadowMap, const uint32_t cascade, const bool loadDepth, const glm::mat4& viewProjection);
+    // from RENDERSYS_SHADER_DIR
+    std::shared_ptr<VkPipelineShaderStageCreateInfo> LoadShader(const std::string& fileName, const RenderSys::ShaderStage& stage);
     void RenderSubMesh(const uint32_t vertexBufferID, const RenderSys::SubMesh& subMesh, VkPipelineLayout pipelineLayout);
+    VkDescriptorSetLayout GetMaterialBindGroupLayout() const;
+    VkDescriptorSet GetMaterialBindGroup(const RenderSys::Material& material) const;
+    void PushMaterialConstants(const RenderSys::Material& material, VkPipelineLayout pipelineLayout);
+    void CreateDrawInstanceBindGroup();
+    void DestroyDrawInstanceBindGroup();
+    // returns the first instance of the draw, or NO_DRAW_INSTANCES when the draw instance buffer is full
+    uint32_t AddDrawInstances(const RenderSys::SubMesh& subMesh);
+    Vulkan::VertexIndexBufferInfo* GetVertexIndexBufferInfo(const uint32_t vertexBufferID);
+    void BindVertexIndexBuffers(const Vulkan::VertexIndexBufferInfo& vertexIndexBufferInfo, const bool culledIndices = false);
     void CreateDefaultTextureSampler();
+    void CreateSkinningPipeline();
     void CreateRenderPass();
     void CreateCommandBuffers();
+    // blocks until the frame submitted last has completed
+    void WaitForFrame();
     std::shared_ptr<VkPipelineShaderStageCreateInfo> CreateShaderModule(const VkShaderModuleCreateInfo& shaderModuleCreateInfo, const RenderSys::ShaderStage& stage);
     void CreateImageCopyBuffers();
+    void CreateImageReadbacks();
+    void DestroyImageReadbacks();
+    // readbacks are delivered in the order of their tickets, returns false when the oldest one is not complete
+    bool DeliverOldestImageReadback(const bool wait);
     void DestroyRenderPass();
     void DestroyBuffers();
     void DestroyShaders();
@@ -108,7 +246,12 @@ private:
 
     VkFramebuffer m_frameBuffer = VK_NULL_HANDLE;
     VkRenderPass m_renderpass = VK_NULL_HANDLE;
+    // same attachments, loaded instead of cleared, starts with the depth in the DEPTH_STENCIL_READ_ONLY_OPTIMAL layout
+    VkRenderPass m_loadRenderpass = VK_NULL_HANDLE;
     VkCommandBuffer m_commandBuffer = VK_NULL_HANDLE;
+    // signaled once the last submitted frame has completed, ResetCommandBuffer() waits for it before recording again
+    VkFence m_frameFence = VK_NULL_HANDLE;
+    bool m_frameSubmitted = false;
 
     Vulkan::VertexInputLayout m_vertexInputLayout;
     std::unordered_map<uint32_t, std::shared_ptr<Vulkan::VertexIndexBufferInfo>> m_vertexIndexBufferInfoMap;
@@ -122,9 +265,57 @@ private:
     std::unordered_map<uint32_t, std::tuple<VkDescriptorBufferInfo, VmaAllocation, void*>> m_uniformBuffers;
     VkClearColorValue m_clearColor = { 0.0f, 0.0f, 0.0f, 1.0f };
 
+    static constexpr uint32_t NO_SHADOW_MAP_BINDING = ~0u;
+    // of the main bind group, sampled by the main pass
+    uint32_t m_shadowMapBinding = NO_SHADOW_MAP_BINDING;
     std::shared_ptr<RenderSys::Vulkan::ShadowMap> m_shadowMap;
+    // only the static casters, drawn again when they or the light frustum of a cascade change
+    std::shared_ptr<RenderSys::Vulkan::ShadowMap> m_staticShadowMap;
+    // replaced by CreateShadowMap(), released once the frame which may still use them has completed
+    std::vector<std::shared_ptr<RenderSys::Vulkan::ShadowMap>> m_retiredShadowMaps;
     std::unique_ptr<Vulkan::ShadowRenderPipeline> m_shadowRenderPipeline;
+    std::unique_ptr<Vulkan::SkinningComputePipeline> m_skinningPipeline;
     std::unique_ptr<VulkanCPUImageCopyData> m_cpuImageData;
+    std::array<ImageReadback, IMAGE_READBACK_COUNT> m_imageReadbacks;
+    uint64_t m_nextReadbackTicket = 1;
+
+    bool m_bindlessMaterials = false;
+
+    static constexpr uint32_t NO_DRAW_INSTANCES = ~0u;
+    bool m_multiDrawIndirect = false;
+    // without the multiDrawIndirect feature every indirect command is drawn on its own
+    uint32_t m_maxDrawIndirectCount = 1;
+    VkDescriptorSetLayout m_drawInstanceBindGroupLayout = VK_NULL_HANDLE;
+    VkDescriptorPool m_drawInstanceBindGroupPool = VK_NULL_HANDLE;
+    VkDescriptorSet m_drawInstanceBindGroup = VK_NULL_HANDLE;
+    // both persistently mapped, filled while recording and reset by ResetCommandBuffer()
+    VkBuffer m_drawInstanceBuffer = VK_NULL_HANDLE;
+    VmaAllocation m_drawInstanceBufferMemory = VK_NULL_HANDLE;
+    DrawInstance* m_drawInstances = nullptr;
+    uint32_t m_drawInstanceCount = 0;
+    VkBuffer m_indirectCommandBuffer = VK_NULL_HANDLE;
+    VmaAllocation m_indirectCommandBufferMemory = VK_NULL_HANDLE;
+    VkDrawIndexedIndirectCommand* m_indirectCommands = nullptr;
+    uint32_t m_indirectCommandCount = 0;
+    std::vector<IndirectBatch> m_indirectBatches;
+
+    std::unique_ptr<Vulkan::HzbCullingPipeline> m_hzbCullingPipeline;
+    // its counters are read when the next frame begins
+    bool m_occlusionCulled = false;
+
+    std::unique_ptr<Vulkan::MeshletCullingPipeline> m_meshletCullingPipeline;
+    std::unordered_set<const RenderSys::SubMesh*> m_meshletCulledSubMeshes;
+    // its counters are read when the next frame begins
+    bool m_meshletCulled = false;
+
+    RenderSys::RenderQueue m_shadowRenderQueue;
+    // the casters of m_shadowRenderQueue which are visible to one cascade
+    RenderSys::RenderQueue m_cascadeRenderQueue;
+    RenderSys::ShadowCasterCache m_shadowCasterCache;
+    // the layer differs from the static one, it has to be copied again even without dynamic casters
+    std::array<bool, RenderSys::ShadowCascades::MAX_CASCADES> m_shadowLayerHasDynamicCasters{};
+    RenderSys::RenderQueueStats m_renderQueueStats;
+    std::unique_ptr<Vulkan::QueryProfiler> m_queryProfiler;
 };
 
 }
\ No newline at end of file
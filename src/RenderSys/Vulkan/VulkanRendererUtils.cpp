@@ -1,4 +1,5 @@
 #include "VulkanRendererUtils.h"
+#include "VulkanDevice.h"
 #include <stdexcept>
 
 namespace RenderSys
@@ -9,12 +10,11 @@ namespace Vulkan
 VkCommandPool g_commandPool = VK_NULL_HANDLE;
 void CreateCommandPool()
 {
-    auto queueFamilyIndices = GraphicsAPI::Vulkan::FindQueueFamilies();
     VkCommandPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
     poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-    poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
-    auto err = vkCreateCommandPool(GraphicsAPI::Vulkan::GetDevice(), &poolInfo, nullptr, &g_commandPool);
+    poolInfo.queueFamilyIndex = RenderSys::Vulkan::GetQueueFamilyIndex();
+    auto err = vkCreateCommandPool(RenderSys::Vulkan::GetDevice(), &poolInfo, nullptr, &g_commandPool);
     GraphicsAPI::Vulkan::check_vk_result(err);
 }
 
@@ -25,9 +25,9 @@ VkCommandPool GetCommandPool()
 
 void DestroyCommandPool()
 {
-    vkDeviceWaitIdle(GraphicsAPI::Vulkan::GetDevice());
+    vkDeviceWaitIdle(RenderSys::Vulkan::GetDevice());
     // when you destroy a command pool, all command buffers allocated from that pool are automatically destroyed
-    vkDestroyCommandPool(GraphicsAPI::Vulkan::GetDevice(), g_commandPool, nullptr);
+    vkDestroyCommandPool(RenderSys::Vulkan::GetDevice(), g_commandPool, nullptr);
     g_commandPool = VK_NULL_HANDLE;
 }
 
@@ -36,8 +36,36 @@ VkFormat RenderSysFormatToVulkanFormat(RenderSys::VertexFormat format)
 {
     switch (format)
     {
+    case RenderSys::VertexFormat::Uint8x2: return VK_FORMAT_R8G8_UINT;
+    case RenderSys::VertexFormat::Uint8x4: return VK_FORMAT_R8G8B8A8_UINT;
+    case RenderSys::VertexFormat::Sint8x2: return VK_FORMAT_R8G8_SINT;
+    case RenderSys::VertexFormat::Sint8x4: return VK_FORMAT_R8G8B8A8_SINT;
+    case RenderSys::VertexFormat::Unorm8x2: return VK_FORMAT_R8G8_UNORM;
+    case RenderSys::VertexFormat::Unorm8x4: return VK_FORMAT_R8G8B8A8_UNORM;
+    case RenderSys::VertexFormat::Snorm8x2: return VK_FORMAT_R8G8_SNORM;
+    case RenderSys::VertexFormat::Snorm8x4: return VK_FORMAT_R8G8B8A8_SNORM;
+    case RenderSys::VertexFormat::Uint16x2: return VK_FORMAT_R16G16_UINT;
+    case RenderSys::VertexFormat::Uint16x4: return VK_FORMAT_R16G16B16A16_UINT;
+    case RenderSys::VertexFormat::Sint16x2: return VK_FORMAT_R16G16_SINT;
+    case RenderSys::VertexFormat::Sint16x4: return VK_FORMAT_R16G16B16A16_SINT;
+    case RenderSys::VertexFormat::Unorm16x2: return VK_FORMAT_R16G16_UNORM;
+    case RenderSys::VertexFormat::Unorm16x4: return VK_FORMAT_R16G16B16A16_UNORM;
+    case RenderSys::VertexFormat::Snorm16x2: return VK_FORMAT_R16G16_SNORM;
+    case RenderSys::VertexFormat::Snorm16x4: return VK_FORMAT_R16G16B16A16_SNORM;
+    case RenderSys::VertexFormat::Float16x2: return VK_FORMAT_R16G16_SFLOAT;
+    case RenderSys::VertexFormat::Float16x4: return VK_FORMAT_R16G16B16A16_SFLOAT;
+    case RenderSys::VertexFormat::Float32: return VK_FORMAT_R32_SFLOAT;
     case RenderSys::VertexFormat::Float32x2: return VK_FORMAT_R32G32_SFLOAT;
     case RenderSys::VertexFormat::Float32x3: return VK_FORMAT_R32G32B32_SFLOAT;
+    case RenderSys::VertexFormat::Float32x4: return VK_FORMAT_R32G32B32A32_SFLOAT;
+    case RenderSys::VertexFormat::Uint32: return VK_FORMAT_R32_UINT;
+    case RenderSys::VertexFormat::Uint32x2: return VK_FORMAT_R32G32_UINT;
+    case RenderSys::VertexFormat::Uint32x3: return VK_FORMAT_R32G32B32_UINT;
+    case RenderSys::VertexFormat::Uint32x4: return VK_FORMAT_R32G32B32A32_UINT;
+    case RenderSys::VertexFormat::Sint32: return VK_FORMAT_R32_SINT;
+    case RenderSys::VertexFormat::Sint32x2: return VK_FORMAT_R32G32_SINT;
+    case RenderSys::VertexFormat::Sint32x3: return VK_FORMAT_R32G32B32_SINT;
+    case RenderSys::VertexFormat::Sint32x4: return VK_FORMAT_R32G32B32A32_SINT;
     default: assert(false);
     }
     return (VkFormat)0;
@@ -46,10 +74,10 @@ VkFormat RenderSysFormatToVulkanFormat(RenderSys::VertexFormat format)
 std::pair<int, VkDeviceSize> FindAppropriateMemoryType(const VkBuffer& buffer, unsigned int flags)
 {
     VkMemoryRequirements mem_reqs;
-    vkGetBufferMemoryRequirements(GraphicsAPI::Vulkan::GetDevice(), buffer, &mem_reqs);
+    vkGetBufferMemoryRequirements(RenderSys::Vulkan::GetDevice(), buffer, &mem_reqs);
 
     VkPhysicalDeviceMemoryProperties gpu_mem;
-    vkGetPhysicalDeviceMemoryProperties(GraphicsAPI::Vulkan::GetPhysicalDevice(), &gpu_mem);
+    vkGetPhysicalDeviceMemoryProperties(RenderSys::Vulkan::GetPhysicalDevice(), &gpu_mem);
 
     int mem_type_idx = -1;
     for (int j = 0; j < gpu_mem.memoryTypeCount; j++) {
@@ -105,7 +133,7 @@ VkImageView CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags a
     viewInfo.subresourceRange.layerCount = 1;
 
     VkImageView imageView;
-    if (vkCreateImageView(GraphicsAPI::Vulkan::GetDevice(), &viewInfo, nullptr, &imageView) != VK_SUCCESS) 
+    if (vkCreateImageView(RenderSys::Vulkan::GetDevice(), &viewInfo, nullptr, &imageView) != VK_SUCCESS) 
     {
         throw std::runtime_error("failed to create image view!");
     }
@@ -169,7 +197,7 @@ VkCommandBuffer BeginSingleTimeCommands(VkCommandPool commandPool)
     allocInfo.commandBufferCount = 1;
 
     VkCommandBuffer commandBuffer;
-    vkAllocateCommandBuffers(GraphicsAPI::Vulkan::GetDevice(), &allocInfo, &commandBuffer);
+    vkAllocateCommandBuffers(RenderSys::Vulkan::GetDevice(), &allocInfo, &commandBuffer);
 
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -189,10 +217,10 @@ void EndSingleTimeCommands(VkCommandBuffer commandBuffer, VkCommandPool commandP
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &commandBuffer;
 
-    vkQueueSubmit(GraphicsAPI::Vulkan::GetDeviceQueue(), 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(GraphicsAPI::Vulkan::GetDeviceQueue()); // Wait for the command buffer to finish
+    vkQueueSubmit(RenderSys::Vulkan::GetDeviceQueue(), 1, &submitInfo, VK_NULL_HANDLE);
+    vkQueueWaitIdle(RenderSys::Vulkan::GetDeviceQueue()); // Wait for the command buffer to finish
 
-    vkFreeCommandBuffers(GraphicsAPI::Vulkan::GetDevice(), commandPool, 1, &commandBuffer);
+    vkFreeCommandBuffers(RenderSys::Vulkan::GetDevice(), commandPool, 1, &commandBuffer);
 }
 
 void TransitionImageLayout(VkImage image, VkFormat format, 
@@ -250,7 +278,7 @@ uint32_t GetUniformStride(const uint32_t sizeOfUniform)
     if (minUniformBufferOffsetAlignment == 0)
     {
         VkPhysicalDeviceProperties deviceProperties;
-        vkGetPhysicalDeviceProperties(GraphicsAPI::Vulkan::GetPhysicalDevice(), &deviceProperties);
+        vkGetPhysicalDeviceProperties(RenderSys::Vulkan::GetPhysicalDevice(), &deviceProperties);
         minUniformBufferOffsetAlignment = deviceProperties.limits.minUniformBufferOffsetAlignment;
         //std::cout << "maxMemoryAllocationCount : " << deviceProperties.limits.maxMemoryAllocationCount << std::endl;
         //std::cout << "maxDrawIndexedIndexValue : " << deviceProperties.limits.maxDrawIndexedIndexValue << std::endl;
@@ -12,6 +12,20 @@ inline VkFormat GetDepthFormat()
     return VK_FORMAT_D32_SFLOAT;
 }
 
+// the barriers and copies of a depth-stencil image have to name both aspects
+inline VkImageAspectFlags GetDepthAspectMask(VkFormat format)
+{
+    switch (format)
+    {
+    case VK_FORMAT_D16_UNORM_S8_UINT:
+    case VK_FORMAT_D24_UNORM_S8_UINT:
+    case VK_FORMAT_D32_SFLOAT_S8_UINT:
+        return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+    default:
+        return VK_IMAGE_ASPECT_DEPTH_BIT;
+    }
+}
+
 void CreateCommandPool();
 VkCommandPool GetCommandPool();
 void DestroyCommandPool();
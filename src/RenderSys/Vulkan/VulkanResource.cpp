@@ -1,4 +1,5 @@
 #include "VulkanResource.h"
+#include "VulkanDevice.h"
 #include <stdexcept>
 
 namespace RenderSys
@@ -8,7 +9,8 @@ std::vector<VkDescriptorSetLayoutBinding> GetResourceBindGroupBindings()
 {
     static std::vector<VkDescriptorSetLayoutBinding> resourceBindGroupBindings
     {
-        VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr} // baseColor texture
+        VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr}, // instance buffer
+        VkDescriptorSetLayoutBinding{1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT, nullptr} // joint matrices
         // VkDescriptorSetLayoutBinding{1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr}, // normal texture
         // VkDescriptorSetLayoutBinding{2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr}  // metallic-roughness texture
     };
@@ -37,7 +39,7 @@ void CreateResourceBindGroupPool()
     poolInfo.pPoolSizes = poolSizes.data();
     poolInfo.maxSets = maxMaterialsPerModel * maxNumOfModels;
 
-    if (vkCreateDescriptorPool(GraphicsAPI::Vulkan::GetDevice(), &poolInfo, nullptr, &g_resourceBindGroupPool) != VK_SUCCESS) {
+    if (vkCreateDescriptorPool(RenderSys::Vulkan::GetDevice(), &poolInfo, nullptr, &g_resourceBindGroupPool) != VK_SUCCESS) {
         throw std::runtime_error("failed to create descriptor pool!");
     }
 }
@@ -51,9 +53,9 @@ VkDescriptorPool GetResourceBindGroupPool()
 void DestroyResourceBindGroupPool()
 {
     assert(g_resourceBindGroupPool != VK_NULL_HANDLE); 
-    vkDeviceWaitIdle(GraphicsAPI::Vulkan::GetDevice());
+    vkDeviceWaitIdle(RenderSys::Vulkan::GetDevice());
     // when you destroy a descriptor pool, all descriptor sets allocated from that pool are automatically destroyed
-    vkDestroyDescriptorPool(GraphicsAPI::Vulkan::GetDevice(), g_resourceBindGroupPool, nullptr);
+    vkDestroyDescriptorPool(RenderSys::Vulkan::GetDevice(), g_resourceBindGroupPool, nullptr);
     g_resourceBindGroupPool = VK_NULL_HANDLE;
 }
 
@@ -67,7 +69,7 @@ void CreateResourceBindGroupLayout()
     layoutInfo.bindingCount = bindings.size();
     layoutInfo.pBindings = bindings.data();
 
-    if (vkCreateDescriptorSetLayout(GraphicsAPI::Vulkan::GetDevice(), &layoutInfo, nullptr, &g_resourceBindGroupLayout) != VK_SUCCESS) {
+    if (vkCreateDescriptorSetLayout(RenderSys::Vulkan::GetDevice(), &layoutInfo, nullptr, &g_resourceBindGroupLayout) != VK_SUCCESS) {
         throw std::runtime_error("failed to create descriptor set layout!");
     }
 }
@@ -81,7 +83,7 @@ VkDescriptorSetLayout GetResourceBindGroupLayout()
 void DestroyResourceBindGroupLayout()
 {
     assert(g_resourceBindGroupLayout != VK_NULL_HANDLE);
-    vkDestroyDescriptorSetLayout(GraphicsAPI::Vulkan::GetDevice(), g_resourceBindGroupLayout, nullptr);
+    vkDestroyDescriptorSetLayout(RenderSys::Vulkan::GetDevice(), g_resourceBindGroupLayout, nullptr);
     g_resourceBindGroupLayout = VK_NULL_HANDLE;
 }
 
@@ -94,7 +96,7 @@ VulkanResourceDescriptor::VulkanResourceDescriptor()
     auto resourceBindGroupLayout = GetResourceBindGroupLayout();
     allocInfo.pSetLayouts = &resourceBindGroupLayout;
 
-    if (vkAllocateDescriptorSets(GraphicsAPI::Vulkan::GetDevice(), &allocInfo, &m_bindGroup) != VK_SUCCESS) {
+    if (vkAllocateDescriptorSets(RenderSys::Vulkan::GetDevice(), &allocInfo, &m_bindGroup) != VK_SUCCESS) {
         throw std::runtime_error("failed to allocate descriptor sets!");
     }
 }
@@ -124,7 +126,7 @@ void VulkanResourceDescriptor::AttachBuffer(uint32_t binding, const std::shared_
 
 void VulkanResourceDescriptor::Init()
 {
-    vkUpdateDescriptorSets(GraphicsAPI::Vulkan::GetDevice(), m_Writes.size(), m_Writes.data(), 0, nullptr);
+    vkUpdateDescriptorSets(RenderSys::Vulkan::GetDevice(), m_Writes.size(), m_Writes.data(), 0, nullptr);
 }
 
 } // namespace RenderSys
\ No newline at end of file
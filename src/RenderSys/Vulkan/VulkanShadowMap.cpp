@@ -1,8 +1,10 @@
 #include "VulkanShadowMap.h"
+#include "VulkanDevice.h"
 
 #include "VulkanRendererUtils.h"
 #include "VulkanMemAlloc.h"
 
+#include <algorithm>
 #include <array>
 #include <iostream>
 
@@ -11,27 +13,37 @@ namespace RenderSys
 namespace Vulkan
 {
 
-ShadowMap::ShadowMap(int width)
+ShadowMap::ShadowMap(int width, uint32_t cascadeCount)
 {
     m_ShadowMapExtent.width = width;
     m_ShadowMapExtent.height = width;
+    m_CascadeCount = std::max(cascadeCount, 1u);
     m_DepthFormat = Vulkan::GetDepthFormat();
 
-    CreateShadowRenderPass();
+    m_ShadowRenderPass = CreateShadowRenderPass(false);
+    m_ShadowLoadRenderPass = CreateShadowRenderPass(true);
     CreateShadowDepthResources();
     CreateShadowFramebuffer();
 }
 
 ShadowMap::~ShadowMap()
 {
-    vkDestroyImageView(GraphicsAPI::Vulkan::GetDevice(), m_ShadowDepthImageView, nullptr);
-    // vkDestroyImage(GraphicsAPI::Vulkan::GetDevice(), m_ShadowDepthImage, nullptr);
-    // vkFreeMemory(GraphicsAPI::Vulkan::GetDevice(), m_ShadowDepthImageMemory, nullptr);
+    vkDestroyImageView(RenderSys::Vulkan::GetDevice(), m_ShadowDepthImageView, nullptr);
+    for (auto layerImageView : m_ShadowLayerImageViews)
+    {
+        vkDestroyImageView(RenderSys::Vulkan::GetDevice(), layerImageView, nullptr);
+    }
+    // vkDestroyImage(RenderSys::Vulkan::GetDevice(), m_ShadowDepthImage, nullptr);
+    // vkFreeMemory(RenderSys::Vulkan::GetDevice(), m_ShadowDepthImageMemory, nullptr);
     vmaDestroyImage(RenderSys::Vulkan::GetMemoryAllocator(), m_ShadowDepthImage, m_ShadowDepthImageMemory);
 
-    vkDestroySampler(GraphicsAPI::Vulkan::GetDevice(), m_ShadowDepthSampler, nullptr);
-    vkDestroyRenderPass(GraphicsAPI::Vulkan::GetDevice(), m_ShadowRenderPass, nullptr);
-    vkDestroyFramebuffer(GraphicsAPI::Vulkan::GetDevice(), m_ShadowFramebuffer, nullptr);
+    vkDestroySampler(RenderSys::Vulkan::GetDevice(), m_ShadowDepthSampler, nullptr);
+    vkDestroyRenderPass(RenderSys::Vulkan::GetDevice(), m_ShadowRenderPass, nullptr);
+    vkDestroyRenderPass(RenderSys::Vulkan::GetDevice(), m_ShadowLoadRenderPass, nullptr);
+    for (auto framebuffer : m_ShadowFramebuffers)
+    {
+        vkDestroyFramebuffer(RenderSys::Vulkan::GetDevice(), framebuffer, nullptr);
+    }
 }
 
 void ShadowMap::CreateShadowDepthResources()
@@ -44,11 +56,13 @@ void ShadowMap::CreateShadowDepthResources()
     imageInfo.extent.height = m_ShadowMapExtent.height;
     imageInfo.extent.depth = 1;
     imageInfo.mipLevels = 1;
-    imageInfo.arrayLayers = 1;
+    imageInfo.arrayLayers = m_CascadeCount;
     imageInfo.format = m_DepthFormat;
     imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
     imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    // layers are copied between the cached static shadow map and the one drawn each frame
+    imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT
+                        | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
     imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
     imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
     imageInfo.flags = 0;
@@ -69,16 +83,16 @@ void ShadowMap::CreateShadowDepthResources()
     VkImageViewCreateInfo viewInfo{};
     viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     viewInfo.image = m_ShadowDepthImage;
-    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
     viewInfo.format = m_DepthFormat;
     viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
     viewInfo.subresourceRange.baseMipLevel = 0;
     viewInfo.subresourceRange.levelCount = 1;
     viewInfo.subresourceRange.baseArrayLayer = 0;
-    viewInfo.subresourceRange.layerCount = 1;
+    viewInfo.subresourceRange.layerCount = m_CascadeCount;
 
     {
-        auto result = vkCreateImageView(GraphicsAPI::Vulkan::GetDevice(), &viewInfo, nullptr, &m_ShadowDepthImageView);
+        auto result = vkCreateImageView(RenderSys::Vulkan::GetDevice(), &viewInfo, nullptr, &m_ShadowDepthImageView);
         if (result != VK_SUCCESS)
         {
             std::cout << "error: failed to create texture image view!" << std::endl;
@@ -86,6 +100,21 @@ void ShadowMap::CreateShadowDepthResources()
         }
     }
 
+    // one view per layer for the framebuffers
+    m_ShadowLayerImageViews.resize(m_CascadeCount, VK_NULL_HANDLE);
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.subresourceRange.layerCount = 1;
+    for (uint32_t layer = 0; layer < m_CascadeCount; ++layer)
+    {
+        viewInfo.subresourceRange.baseArrayLayer = layer;
+        auto result = vkCreateImageView(RenderSys::Vulkan::GetDevice(), &viewInfo, nullptr, &m_ShadowLayerImageViews[layer]);
+        if (result != VK_SUCCESS)
+        {
+            std::cout << "error: failed to create shadow map layer image view!" << std::endl;
+            assert(false);
+        }
+    }
+
     // sampler
     VkSamplerCreateInfo samplerCreateInfo{};
     samplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
@@ -104,7 +133,7 @@ void ShadowMap::CreateShadowDepthResources()
     samplerCreateInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
 
     {
-        auto result = vkCreateSampler(GraphicsAPI::Vulkan::GetDevice(), &samplerCreateInfo, nullptr, &m_ShadowDepthSampler);
+        auto result = vkCreateSampler(RenderSys::Vulkan::GetDevice(), &samplerCreateInfo, nullptr, &m_ShadowDepthSampler);
         if (result != VK_SUCCESS)
         {
             std::cout << "error: failed to create sampler!" << std::endl;
@@ -117,17 +146,17 @@ void ShadowMap::CreateShadowDepthResources()
     m_DescriptorImageInfo.imageLayout = m_ImageLayout;
 }
 
-void ShadowMap::CreateShadowRenderPass()
+VkRenderPass ShadowMap::CreateShadowRenderPass(bool loadDepth)
 {
     // ATTACHMENT_DEPTH
     VkAttachmentDescription depthAttachment{};
     depthAttachment.format = m_DepthFormat;
     depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-    depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    depthAttachment.loadOp = loadDepth ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
     depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
     depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    depthAttachment.initialLayout = loadDepth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
     m_ImageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
     depthAttachment.finalLayout = m_ImageLayout;
 
@@ -182,30 +211,92 @@ void ShadowMap::CreateShadowRenderPass()
     renderPassInfo.dependencyCount = NUMBER_OF_DEPENDENCIES;
     renderPassInfo.pDependencies = dependencies.data();
 
-    auto result = vkCreateRenderPass(GraphicsAPI::Vulkan::GetDevice(), &renderPassInfo, nullptr, &m_ShadowRenderPass);
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+    auto result = vkCreateRenderPass(RenderSys::Vulkan::GetDevice(), &renderPassInfo, nullptr, &renderPass);
     if (result != VK_SUCCESS)
     {
         std::cout << "error: failed to create render pass!" << std::endl;
         assert(false);
     }
+    return renderPass;
 }
 
 void ShadowMap::CreateShadowFramebuffer()
 {
-    VkFramebufferCreateInfo framebufferInfo = {};
-    framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-    framebufferInfo.renderPass = m_ShadowRenderPass;
-    framebufferInfo.attachmentCount = static_cast<uint32_t>(ShadowRenderTargets::NUMBER_OF_ATTACHMENTS);
-    framebufferInfo.pAttachments = &m_ShadowDepthImageView;
-    framebufferInfo.width = m_ShadowMapExtent.width;
-    framebufferInfo.height = m_ShadowMapExtent.height;
-    framebufferInfo.layers = 1;
-
-    if (vkCreateFramebuffer(GraphicsAPI::Vulkan::GetDevice(), &framebufferInfo, nullptr, &m_ShadowFramebuffer) != VK_SUCCESS)
+    m_ShadowFramebuffers.resize(m_CascadeCount, VK_NULL_HANDLE);
+    for (uint32_t layer = 0; layer < m_CascadeCount; ++layer)
     {
-        std::cout << "error: failed to create framebuffer" << std::endl;
-        assert(false);
+        VkFramebufferCreateInfo framebufferInfo = {};
+        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebufferInfo.renderPass = m_ShadowRenderPass;
+        framebufferInfo.attachmentCount = static_cast<uint32_t>(ShadowRenderTargets::NUMBER_OF_ATTACHMENTS);
+        framebufferInfo.pAttachments = &m_ShadowLayerImageViews[layer];
+        framebufferInfo.width = m_ShadowMapExtent.width;
+        framebufferInfo.height = m_ShadowMapExtent.height;
+        framebufferInfo.layers = 1;
+
+        if (vkCreateFramebuffer(RenderSys::Vulkan::GetDevice(), &framebufferInfo, nullptr, &m_ShadowFramebuffers[layer]) != VK_SUCCESS)
+        {
+            std::cout << "error: failed to create framebuffer" << std::endl;
+            assert(false);
+        }
+    }
+}
+
+void ShadowMap::CopyLayer(VkCommandBuffer commandBuffer, const ShadowMap& source, uint32_t layer, bool drawAfterCopy)
+{
+    assert(source.m_ShadowMapExtent.width == m_ShadowMapExtent.width && layer < source.m_CascadeCount && layer < m_CascadeCount);
+
+    const VkImageAspectFlags aspectMask = GetDepthAspectMask(m_DepthFormat);
+    std::array<VkImageMemoryBarrier, 2> barriers{};
+    for (auto& barrier : barriers)
+    {
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.subresourceRange = {aspectMask, 0, 1, layer, 1};
+    }
+    barriers[0].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barriers[0].oldLayout = source.m_ImageLayout;
+    barriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barriers[0].image = source.m_ShadowDepthImage;
+    // the content of the destination is replaced
+    barriers[1].srcAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    barriers[1].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barriers[1].image = m_ShadowDepthImage;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 
+                            VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 
+                            static_cast<uint32_t>(barriers.size()), barriers.data());
+
+    VkImageCopy region{};
+    region.srcSubresource = {aspectMask, 0, layer, 1};
+    region.dstSubresource = {aspectMask, 0, layer, 1};
+    region.extent = {m_ShadowMapExtent.width, m_ShadowMapExtent.height, 1};
+    vkCmdCopyImage(commandBuffer, source.m_ShadowDepthImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, 
+                    m_ShadowDepthImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+    barriers[0].srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barriers[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+    barriers[0].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barriers[0].newLayout = source.m_ImageLayout;
+    barriers[1].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barriers[1].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    if (drawAfterCopy)
+    {
+        barriers[1].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        barriers[1].newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    }
+    else
+    {
+        barriers[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barriers[1].newLayout = m_ImageLayout;
     }
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, 
+                            VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, 
+                            0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
 }
 
 } // namespace Vulkan
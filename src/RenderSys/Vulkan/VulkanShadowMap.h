@@ -1,4 +1,6 @@
 #pragma once
+#include <stdint.h>
+#include <vector>
 #include <Walnut/GraphicsAPI/VulkanGraphics.h>
 #include <vk_mem_alloc.h>
 
@@ -7,6 +9,8 @@ namespace RenderSys
 namespace Vulkan
 {
 
+// Layered depth image, one layer per shadow cascade. Each layer has its own framebuffer,
+// the descriptor samples all of them through a 2D array view.
 class ShadowMap
 {
 public:
@@ -21,31 +25,41 @@ public:
         NUMBER_OF_ATTACHMENTS
     };
 
-    ShadowMap(int width);
+    ShadowMap(int width, uint32_t cascadeCount = 1);
     ~ShadowMap();
 
     ShadowMap(const ShadowMap&) = delete;
     ShadowMap& operator=(const ShadowMap&) = delete;
 
-    VkFramebuffer GetShadowFrameBuffer() { return m_ShadowFramebuffer; }
+    VkFramebuffer GetShadowFrameBuffer(uint32_t cascade = 0) { return m_ShadowFramebuffers[cascade]; }
+    uint32_t GetCascadeCount() const { return m_CascadeCount; }
     VkRenderPass GetShadowRenderPass() { return m_ShadowRenderPass; }
+    // compatible with the shadow render pass, keeps the depth of the layer, which has to be in the
+    // DEPTH_STENCIL_ATTACHMENT_OPTIMAL layout
+    VkRenderPass GetShadowLoadRenderPass() { return m_ShadowLoadRenderPass; }
     VkExtent2D GetShadowMapExtent() { return m_ShadowMapExtent; }
     const VkDescriptorImageInfo& GetDescriptorImageInfo() const { return m_DescriptorImageInfo; }
     const VkImage GetShadowDepthImage() const { return m_ShadowDepthImage; }
+    // copies a layer of a shadow map of the same size, both layers have to be in the DEPTH_STENCIL_READ_ONLY_OPTIMAL
+    // layout or the destination undefined, the destination ends in the attachment layout when it is drawn into next
+    void CopyLayer(VkCommandBuffer commandBuffer, const ShadowMap& source, uint32_t layer, bool drawAfterCopy);
 
 private:
     void CreateShadowDepthResources();
-    void CreateShadowRenderPass();
+    VkRenderPass CreateShadowRenderPass(bool loadDepth);
     void CreateShadowFramebuffer();
 
     VkFormat m_DepthFormat{VkFormat::VK_FORMAT_UNDEFINED};
     VkExtent2D m_ShadowMapExtent{};
-    VkFramebuffer m_ShadowFramebuffer{nullptr};
+    uint32_t m_CascadeCount{1};
+    std::vector<VkFramebuffer> m_ShadowFramebuffers;
     VkRenderPass m_ShadowRenderPass{nullptr};
+    VkRenderPass m_ShadowLoadRenderPass{nullptr};
 
     VkImage m_ShadowDepthImage{nullptr};
     VkImageLayout m_ImageLayout{};
-    VkImageView m_ShadowDepthImageView{nullptr};
+    VkImageView m_ShadowDepthImageView{nullptr}; // all layers
+    std::vector<VkImageView> m_ShadowLayerImageViews;
     VmaAllocation m_ShadowDepthImageMemory{nullptr};
     VkSampler m_ShadowDepthSampler{nullptr};
 
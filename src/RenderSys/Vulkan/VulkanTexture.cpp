@@ -1,4 +1,5 @@
 #include "VulkanTexture.h"
+#include "VulkanDevice.h"
 
 #include "VulkanMemAlloc.h"
 #include "VulkanRendererUtils.h"
@@ -45,12 +46,12 @@ VulkanTexture::~VulkanTexture()
 {
     if (m_descriptorImageInfo.sampler != VK_NULL_HANDLE)
     {
-        vkDestroySampler(GraphicsAPI::Vulkan::GetDevice(), m_descriptorImageInfo.sampler, nullptr);
+        vkDestroySampler(RenderSys::Vulkan::GetDevice(), m_descriptorImageInfo.sampler, nullptr);
         m_descriptorImageInfo.sampler = VK_NULL_HANDLE;
     }
     if (m_descriptorImageInfo.imageView != VK_NULL_HANDLE)
     {
-        vkDestroyImageView(GraphicsAPI::Vulkan::GetDevice(), m_descriptorImageInfo.imageView, nullptr);
+        vkDestroyImageView(RenderSys::Vulkan::GetDevice(), m_descriptorImageInfo.imageView, nullptr);
         m_descriptorImageInfo.imageView = VK_NULL_HANDLE;
     }
     if (m_image != VK_NULL_HANDLE)
@@ -156,7 +157,7 @@ void VulkanTexture::SetSampler(RenderSys::TextureSampler sampler)
     texSamplerInfo.maxAnisotropy = 1.0f;
 
     assert(m_descriptorImageInfo.sampler == VK_NULL_HANDLE);
-    if (vkCreateSampler(GraphicsAPI::Vulkan::GetDevice(), &texSamplerInfo, nullptr, &m_descriptorImageInfo.sampler) != VK_SUCCESS) {
+    if (vkCreateSampler(RenderSys::Vulkan::GetDevice(), &texSamplerInfo, nullptr, &m_descriptorImageInfo.sampler) != VK_SUCCESS) {
         std::cout << "error: could not create sampler for texture" << std::endl;
     }
 }
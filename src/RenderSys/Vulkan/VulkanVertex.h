@@ -23,9 +23,24 @@ struct VertexIndexBufferInfo
     VkBuffer m_vertexBuffer = VK_NULL_HANDLE;
     VmaAllocation m_vertexBufferMemory = VK_NULL_HANDLE;
     uint32_t m_vertexCount = 0;
+    uint32_t m_vertexStride = 0;
     VkBuffer m_indexBuffer = VK_NULL_HANDLE;
     VmaAllocation m_indexBufferMemory = VK_NULL_HANDLE;
     uint32_t m_indexCount = 0;
+
+    // compute skinning, the skinned buffer replaces m_vertexBuffer in every pass once it exists
+    VkBuffer m_skinningDataBuffer = VK_NULL_HANDLE;
+    VmaAllocation m_skinningDataBufferMemory = VK_NULL_HANDLE;
+    VkBuffer m_skinnedVertexBuffer = VK_NULL_HANDLE;
+    VmaAllocation m_skinnedVertexBufferMemory = VK_NULL_HANDLE;
+    VkDescriptorSet m_skinningBindGroup = VK_NULL_HANDLE;
+
+    // meshlet culling, the visible meshlets of each draw are compacted into the culled index buffer, drawn instead of m_indexBuffer
+    VkBuffer m_meshletBuffer = VK_NULL_HANDLE;
+    VmaAllocation m_meshletBufferMemory = VK_NULL_HANDLE;
+    VkBuffer m_culledIndexBuffer = VK_NULL_HANDLE;
+    VmaAllocation m_culledIndexBufferMemory = VK_NULL_HANDLE;
+    VkDescriptorSet m_meshletBindGroup = VK_NULL_HANDLE;
 };
 
 } // namespace Vulkan
@@ -162,18 +162,39 @@ void WebGPUCompute::CreateBuffer(uint32_t binding, uint32_t bufferLength, Render
             std::cout << "uniform buffer: " << m_buffersAccessibleToShader.find(binding)->second << std::endl;
             break;
         }
+        case RenderSys::ComputeBuf::BufferType::Storage:
+        {
+            wgpu::BufferDescriptor storageBufferDesc;
+            storageBufferDesc.mappedAtCreation = false;
+            storageBufferDesc.size = bufferLength;
+            storageBufferDesc.label = ("Storage Buffer bound to binding " + std::to_string(binding)).c_str();
+            std::cout << "Creating storage buffer..." << std::endl;
+            // zero initialized by WebGPU
+            storageBufferDesc.usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopySrc | wgpu::BufferUsage::CopyDst;
+            m_buffersAccessibleToShader[binding] = WebGPU::GetDevice().createBuffer(storageBufferDesc);
+            std::cout << "storage buffer: " << m_buffersAccessibleToShader.find(binding)->second << std::endl;
+            break;
+        }
     }
 }
 
-void WebGPUCompute::SetBufferData(uint32_t binding, const void *bufferData, uint32_t bufferLength)
+void WebGPUCompute::SetBufferData(uint32_t binding, const void *bufferData, uint32_t bufferLength, uint32_t offset)
 {
     auto it = m_buffersAccessibleToShader.find(binding);
     assert(it != m_buffersAccessibleToShader.end());
-    WebGPU::GetQueue().writeBuffer(it->second, 0, bufferData, bufferLength);
+    WebGPU::GetQueue().writeBuffer(it->second, offset, bufferData, bufferLength);
 }
 
 void WebGPUCompute::BeginComputePass()
 {
+    // the oldest submission, its readbacks are unmapped before the pass copies into them again
+    m_currentSubmission = (m_currentSubmission + 1) % m_submissions.size();
+    ComputeSubmission& submission = m_submissions[m_currentSubmission];
+    WaitForSubmission(submission);
+    UnmapReadbacks(submission);
+    submission.ticket = 0;
+    submission.readbackCount = 0;
+
     wgpu::CommandEncoderDescriptor commandEncoderDesc;
     commandEncoderDesc.label = "Compute Command Encoder";
     m_commandEncoder = WebGPU::GetDevice().createCommandEncoder(commandEncoderDesc);
@@ -193,6 +214,21 @@ void WebGPUCompute::Compute(const uint32_t workgroupCountX, const uint32_t workg
 	m_computePass.dispatchWorkgroups(workgroupCountX, workgroupCountY, 1);
 }
 
+void WebGPUCompute::Compute(const uint32_t kernel, const uint32_t workgroupCountX, const uint32_t workgroupCountY, const uint32_t workgroupCountZ,
+                            const void* pushConstants, const uint32_t pushConstantSize, const bool barrier)
+{
+    // WebGPU orders the dispatches of a pass that share a writable buffer by itself
+    if (kernel != 0 || pushConstantSize > 0)
+    {
+        std::cout << "Error: WebGPU compute supports one kernel without push constants!" << std::endl;
+        assert(false);
+        return;
+    }
+    m_computePass.setPipeline(m_pipeline);
+    m_computePass.setBindGroup(0, m_bindGroup, 0, nullptr);
+	m_computePass.dispatchWorkgroups(workgroupCountX, workgroupCountY, workgroupCountZ);
+}
+
 void WebGPUCompute::BufferMapCallback(WGPUMapAsyncStatus status, char const * message, uint32_t binding)
 {
     if (status == wgpu::MapAsyncStatus::Success)
@@ -224,6 +260,7 @@ void WebGPUCompute::BufferMapCallback(WGPUMapAsyncStatus status, char const * me
 void WebGPUCompute::EndComputePass()
 {
     m_computePass.end();
+    CopyReadbacks(m_submissions[m_currentSubmission]);
 
     // Have to copy buffers before encoder.finish
     // Copy the memory from the output buffer that lies in the storage part of the
@@ -240,6 +277,192 @@ void WebGPUCompute::EndComputePass()
     WebGPU::GetQueue().submit(commands);
 }
 
+uint32_t WebGPUCompute::RequestReadback(uint32_t binding, uint32_t offset, uint32_t size)
+{
+    auto it = m_buffersAccessibleToShader.find(binding);
+    assert(it != m_buffersAccessibleToShader.end());
+    // copyBufferToBuffer() needs multiples of 4
+    assert(offset % 4 == 0 && size % 4 == 0);
+    assert(offset + size <= it->second.getSize());
+
+    ComputeSubmission& submission = m_submissions[m_currentSubmission];
+    const uint32_t readback = submission.readbackCount++;
+    if (readback == submission.readbacks.size())
+    {
+        submission.readbacks.push_back(std::make_unique<StagingReadback>());
+    }
+    StagingReadback& staging = *submission.readbacks[readback];
+    if (staging.capacity < size)
+    {
+        // grows only, the map buffers of a submission are reused by every pass that runs in it
+        if (staging.mapBuffer)
+        {
+            staging.mapBuffer.destroy();
+            staging.mapBuffer.release();
+        }
+        wgpu::BufferDescriptor mapBufferDesc;
+        mapBufferDesc.mappedAtCreation = false;
+        mapBufferDesc.size = size;
+        mapBufferDesc.label = "Readback Buffer";
+        mapBufferDesc.usage = wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::MapRead;
+        staging.mapBuffer = WebGPU::GetDevice().createBuffer(mapBufferDesc);
+        staging.capacity = size;
+    }
+    staging.binding = binding;
+    staging.offset = offset;
+    staging.size = size;
+    staging.mapped.store(false);
+    staging.failed.store(false);
+    return readback;
+}
+
+uint64_t WebGPUCompute::Submit()
+{
+    EndComputePass();
+    ComputeSubmission& submission = m_submissions[m_currentSubmission];
+    MapReadbacks(submission);
+    submission.ticket = m_nextTicket++;
+    return submission.ticket;
+}
+
+bool WebGPUCompute::IsComplete(uint64_t ticket)
+{
+    const ComputeSubmission* submission = FindSubmission(ticket);
+    if (!submission)
+    {
+        return true;
+    }
+    // without readbacks there is nothing to map, GetMappedResult() waits for the queue
+    ProcessEvents();
+    return IsMapped(*submission);
+}
+
+void WebGPUCompute::Wait(uint64_t ticket)
+{
+    ComputeSubmission* submission = FindSubmission(ticket);
+    if (submission)
+    {
+        WaitForSubmission(*submission);
+    }
+}
+
+const void* WebGPUCompute::GetReadback(uint64_t ticket, uint32_t readback)
+{
+    ComputeSubmission* submission = FindSubmission(ticket);
+    if (!submission || readback >= submission->readbackCount)
+    {
+        std::cout << "Error: the readback " << readback << " of compute pass " << ticket << " is gone!" << std::endl;
+        assert(false);
+        return nullptr;
+    }
+    WaitForSubmission(*submission);
+    StagingReadback& staging = *submission->readbacks[readback];
+    if (staging.failed.load())
+    {
+        std::cout << "Error: the readback " << readback << " of compute pass " << ticket << " could not be mapped!" << std::endl;
+        return nullptr;
+    }
+    return staging.mapBuffer.getConstMappedRange(0, staging.size);
+}
+
+void WebGPUCompute::CopyReadbacks(ComputeSubmission& submission)
+{
+    // after the compute pass, WebGPU orders the copies after its dispatches
+    for (uint32_t readback = 0; readback < submission.readbackCount; readback++)
+    {
+        const StagingReadback& staging = *submission.readbacks[readback];
+        const wgpu::Buffer& buffer = m_buffersAccessibleToShader.find(staging.binding)->second;
+        m_commandEncoder.copyBufferToBuffer(buffer, staging.offset, staging.mapBuffer, 0, staging.size);
+    }
+}
+
+void WebGPUCompute::MapReadbacks(ComputeSubmission& submission)
+{
+    for (uint32_t readback = 0; readback < submission.readbackCount; readback++)
+    {
+        StagingReadback& staging = *submission.readbacks[readback];
+        wgpu::BufferMapCallbackInfo2 callbackInfo;
+        callbackInfo.callback = [](WGPUMapAsyncStatus status, char const * message, void* userdata1, void* userdata2) 
+        {
+            StagingReadback* staging = static_cast<StagingReadback*>(userdata1);
+            if (status != wgpu::MapAsyncStatus::Success)
+            {
+                std::cout << "Error: failed to map the readback buffer!" << std::endl;
+                staging->failed.store(true);
+            }
+            staging->mapped.store(true);
+        };
+        callbackInfo.mode = WGPUCallbackMode_AllowSpontaneous;
+        callbackInfo.userdata1 = static_cast<void*>(&staging);
+        callbackInfo.userdata2 = nullptr;
+        // resolves once the submitted copy has completed
+        staging.mapBuffer.mapAsync2(wgpu::MapMode::Read, 0, staging.size, callbackInfo);
+    }
+}
+
+bool WebGPUCompute::IsMapped(const ComputeSubmission& submission) const
+{
+    for (uint32_t readback = 0; readback < submission.readbackCount; readback++)
+    {
+        if (!submission.readbacks[readback]->mapped.load())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void WebGPUCompute::WaitForSubmission(ComputeSubmission& submission)
+{
+    if (submission.ticket == 0)
+    {
+        return;
+    }
+    while (!IsMapped(submission))
+    {
+        ProcessEvents();
+    }
+}
+
+void WebGPUCompute::UnmapReadbacks(ComputeSubmission& submission)
+{
+    for (uint32_t readback = 0; readback < submission.readbackCount; readback++)
+    {
+        StagingReadback& staging = *submission.readbacks[readback];
+        if (staging.mapped.load() && !staging.failed.load())
+        {
+            staging.mapBuffer.unmap();
+        }
+        staging.mapped.store(false);
+    }
+}
+
+WebGPUCompute::ComputeSubmission* WebGPUCompute::FindSubmission(uint64_t ticket)
+{
+    if (ticket == 0)
+    {
+        return nullptr;
+    }
+    for (ComputeSubmission& submission : m_submissions)
+    {
+        if (submission.ticket == ticket)
+        {
+            return &submission;
+        }
+    }
+    return nullptr;
+}
+
+void WebGPUCompute::ProcessEvents()
+{
+#ifdef WEBGPU_BACKEND_WGPU
+    WebGPU::GetQueue().submit(0, nullptr);
+#else
+    WebGPU::GetInstance().processEvents();
+    WebGPU::GetDevice().tick();
+#endif
+}
+
 std::vector<uint8_t>& WebGPUCompute::GetMappedResult(uint32_t binding)
 {
     // Copy output
@@ -277,8 +500,33 @@ std::vector<uint8_t>& WebGPUCompute::GetMappedResult(uint32_t binding)
     return mapperBufferStruct->mappedData;
 }
 
+void WebGPUCompute::ReadBuffer(uint32_t binding, void* data, uint32_t offset, uint32_t size)
+{
+    std::cout << "Error: WebGPU compute reads back Output buffers only, use GetMappedResult()!" << std::endl;
+    assert(false);
+}
+
+void WebGPUCompute::WriteBuffer(uint32_t binding, const void* data, uint32_t offset, uint32_t size)
+{
+    auto it = m_buffersAccessibleToShader.find(binding);
+    assert(it != m_buffersAccessibleToShader.end());
+    WebGPU::GetQueue().writeBuffer(it->second, offset, data, size);
+}
+
 void WebGPUCompute::Destroy()
 {
+    for (ComputeSubmission& submission : m_submissions)
+    {
+        WaitForSubmission(submission);
+        UnmapReadbacks(submission);
+        for (auto& staging : submission.readbacks)
+        {
+            staging->mapBuffer.destroy();
+            staging->mapBuffer.release();
+        }
+        submission = ComputeSubmission{};
+    }
+
     for (auto& [binding, buffer] : m_buffersAccessibleToShader)
     {
         buffer.destroy();
@@ -2,9 +2,13 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <array>
+#include <memory>
 #include <Walnut/GraphicsAPI/WebGPUGraphics.h>
 
 #include <RenderSys/Buffer.h>
+#include <RenderSys/Compute.h>
+#include <RenderSys/GpuProfiler.h>
 #include <RenderSys/RenderUtil.h>
 #include <RenderSys/Shader.h>
 
@@ -29,20 +33,68 @@ namespace GraphicsAPI
         void CreateShaders(RenderSys::Shader& shader);
         void CreatePipeline();
         void CreateBuffer(uint32_t binding, uint32_t bufferLength, RenderSys::ComputeBuf::BufferType type);
-        void SetBufferData(uint32_t binding, const void *bufferData, uint32_t bufferLength);
+        void SetBufferData(uint32_t binding, const void *bufferData, uint32_t bufferLength, uint32_t offset = 0);
         void BeginComputePass();
         void Compute(const uint32_t workgroupCountX, const uint32_t workgroupCountY);
+        // one kernel and no push constants, WebGPU has neither several pipelines per bind group here nor push constants
+        void Compute(const uint32_t kernel, const uint32_t workgroupCountX, const uint32_t workgroupCountY, const uint32_t workgroupCountZ,
+                        const void* pushConstants, const uint32_t pushConstantSize, const bool barrier);
         void BufferMapCallback(WGPUMapAsyncStatus status, char const * message, uint32_t binding);
+        // copies the range into a MapRead buffer at the end of the pass, which Submit() maps with mapAsync
+        uint32_t RequestReadback(uint32_t binding, uint32_t offset, uint32_t size);
+        uint64_t Submit();
         void EndComputePass();
+        bool IsComplete(uint64_t ticket);
+        void Wait(uint64_t ticket);
+        const void* GetReadback(uint64_t ticket, uint32_t readback);
         std::vector<uint8_t>& GetMappedResult(uint32_t binding);
+        void ReadBuffer(uint32_t binding, void* data, uint32_t offset, uint32_t size);
+        void WriteBuffer(uint32_t binding, const void* data, uint32_t offset, uint32_t size);
+        // no timestamp queries yet
+        void BeginProfileScope(const std::string& name) {}
+        void EndProfileScope() {}
+        RenderSys::GpuProfiler* GetGpuProfiler() { return nullptr; }
         void Destroy();
     private:
+        // a range of a Storage buffer copied at the end of a pass, mapped once the pass has completed
+        struct StagingReadback
+        {
+            wgpu::Buffer mapBuffer = nullptr;
+            uint64_t capacity = 0;
+            uint32_t binding = 0;
+            uint32_t offset = 0;
+            uint32_t size = 0;
+            // set by the mapAsync callback
+            std::atomic<bool> mapped = false;
+            std::atomic<bool> failed = false;
+        };
+        // a pass in flight, the readbacks stay mapped until the next pass that runs in it begins
+        struct ComputeSubmission
+        {
+            // 0 before the first submit and while recording
+            uint64_t ticket = 0;
+            std::vector<std::unique_ptr<StagingReadback>> readbacks;
+            uint32_t readbackCount = 0;
+        };
+
+        void CopyReadbacks(ComputeSubmission& submission);
+        void MapReadbacks(ComputeSubmission& submission);
+        bool IsMapped(const ComputeSubmission& submission) const;
+        void WaitForSubmission(ComputeSubmission& submission);
+        void UnmapReadbacks(ComputeSubmission& submission);
+        ComputeSubmission* FindSubmission(uint64_t ticket);
+        // runs the callbacks of the finished asynchronous operations
+        void ProcessEvents();
+
         wgpu::BindGroupLayout m_bindGroupLayout = nullptr;
         wgpu::BindGroup m_bindGroup = nullptr;
         wgpu::ShaderModule m_shaderModule = nullptr;
         wgpu::ComputePipeline m_pipeline = nullptr;
         wgpu::CommandEncoder m_commandEncoder = nullptr;
         wgpu::ComputePassEncoder m_computePass = nullptr;
+        std::array<ComputeSubmission, RenderSys::Compute::MAX_PASSES_IN_FLIGHT> m_submissions;
+        uint32_t m_currentSubmission = RenderSys::Compute::MAX_PASSES_IN_FLIGHT - 1;
+        uint64_t m_nextTicket = 1;
 
         std::unordered_map<uint32_t, wgpu::Buffer> m_buffersAccessibleToShader;
         std::unordered_map<uint32_t, std::shared_ptr<MappedBuffer>> m_shaderOutputBuffers;
@@ -9,9 +9,11 @@ namespace RenderSys
 class WebGPUMaterialDescriptor
 {
 public:
-    WebGPUMaterialDescriptor(MaterialTextures& textures);
+    WebGPUMaterialDescriptor(MaterialTextures& textures, const MaterialProperties& properties);
     ~WebGPUMaterialDescriptor();
 
+    void SetMaterialProperties(const MaterialProperties& properties) {}
+
 };
 
 
@@ -375,6 +375,27 @@ void WebGPURenderer2D::Destroy()
 {
 }
 
+void WebGPURenderer2D::CreateSpriteAtlas(const uint8_t* pixels, uint32_t width, uint32_t height)
+{
+    std::cout << "Error: WebGPU renderer does not support sprites yet!" << std::endl;
+}
+
+RenderSys::SpriteInstance* WebGPURenderer2D::MapSprites(uint32_t& capacity)
+{
+    if (!m_spriteErrorReported)
+    {
+        std::cout << "Error: WebGPU renderer does not support sprites yet, the sprites are dropped!" << std::endl;
+        m_spriteErrorReported = true;
+    }
+    capacity = 0;
+    return nullptr;
+}
+
+void WebGPURenderer2D::DrawSprites(uint32_t spriteCount, const glm::mat4& viewProjection)
+{
+    std::cout << "Error: WebGPU renderer does not support sprites yet!" << std::endl;
+}
+
 void WebGPURenderer2D::SubmitCommandBuffer()
 {
     wgpu::CommandBufferDescriptor cmdBufferDescriptor;
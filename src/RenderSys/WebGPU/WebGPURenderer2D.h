@@ -7,6 +7,7 @@
 
 #include <RenderSys/RenderUtil.h>
 #include <RenderSys/Shader.h>
+#include <RenderSys/SpriteBatch.h>
 
 namespace GraphicsAPI
 {
@@ -33,6 +34,10 @@ namespace GraphicsAPI
         void BeginRenderPass();
         void EndRenderPass();
         void Destroy();
+        // sprites are not supported by the WebGPU backend yet, every sprite of a batch is dropped
+        void CreateSpriteAtlas(const uint8_t* pixels, uint32_t width, uint32_t height);
+        RenderSys::SpriteInstance* MapSprites(uint32_t& capacity);
+        void DrawSprites(uint32_t spriteCount, const glm::mat4& viewProjection);
         
     private:
         void SubmitCommandBuffer();
@@ -60,5 +65,6 @@ namespace GraphicsAPI
         wgpu::RenderPassEncoder m_renderPass = nullptr;
 
         uint32_t m_width, m_height;
+        bool m_spriteErrorReported = false;
     };
 }
\ No newline at end of file
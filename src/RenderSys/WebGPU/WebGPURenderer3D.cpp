@@ -2,6 +2,8 @@
 #include "WebGPURendererUtils.h"
 #include "WebGPUTexture.h"
 
+#include <cstring>
+
 namespace RenderSys
 {
 
@@ -205,21 +207,43 @@ void WebGPURenderer3D::CreateFrameBuffer()
 }
 
 uint32_t WebGPURenderer3D::CreateVertexBuffer(const RenderSys::VertexBuffer& bufferData, RenderSys::VertexBufferLayout bufferLayout)
+{
+    return CreateVertexBuffer(bufferData.vertices.data(), bufferData.vertices.size() * sizeof(RenderSys::Vertex), bufferLayout);
+}
+
+uint32_t WebGPURenderer3D::CreateVertexBuffer(const void* bufferData, size_t bufferLength, RenderSys::VertexBufferLayout bufferLayout)
+{
+    return CreateVertexBuffer(bufferLength, bufferLayout, [bufferData, bufferLength](void* mappedVertices)
+    {
+        std::memcpy(mappedVertices, bufferData, bufferLength);
+    });
+}
+
+uint32_t WebGPURenderer3D::CreateVertexBuffer(size_t bufferLength, RenderSys::VertexBufferLayout bufferLayout, const std::function<void(void*)>& writeVertices)
 {
     std::cout << "Creating vertex buffer..." << std::endl;
     auto vertexIndexBufferInfo = std::make_shared<WebGPUVertexIndexBufferInfo>();
-    const auto vertexBufferSize = bufferData.vertices.size() * sizeof(RenderSys::Vertex);
+    const auto vertexBufferSize = bufferLength;
     vertexIndexBufferInfo->m_vertexCount = vertexBufferSize / bufferLayout.arrayStride;
+    vertexIndexBufferInfo->m_vertexBufferSize = vertexBufferSize;
     m_vertexBufferLayout = GraphicsAPI::GetWebGPUVertexBufferLayout(bufferLayout);
     wgpu::BufferDescriptor bufferDesc;
     bufferDesc.size = vertexBufferSize;
     bufferDesc.usage = wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::Vertex;
-    bufferDesc.mappedAtCreation = false;
+    // the vertices are written into the mapped buffer, writeBuffer() would need them in a copy first
+    bufferDesc.mappedAtCreation = true;
     bufferDesc.label = "Vertex Buffer";
     vertexIndexBufferInfo->m_vertexBuffer = GraphicsAPI::WebGPU::GetDevice().createBuffer(bufferDesc);
 
-    // Upload vertex data to the buffer
-    GraphicsAPI::WebGPU::GetQueue().writeBuffer(vertexIndexBufferInfo->m_vertexBuffer, 0, bufferData.vertices.data(), bufferDesc.size);
+    void* mappedVertices = vertexIndexBufferInfo->m_vertexBuffer.getMappedRange(0, bufferDesc.size);
+    if (mappedVertices == nullptr)
+    {
+        std::cout << "Error: could not map the vertex buffer!" << std::endl;
+        assert(false);
+        return 0;
+    }
+    writeVertices(mappedVertices);
+    vertexIndexBufferInfo->m_vertexBuffer.unmap();
     std::cout << "Vertex buffer: " << vertexIndexBufferInfo->m_vertexBuffer << std::endl;
     const uint32_t key = m_vertexIndexBufferInfoMap.size() + 1;
     auto res2 = m_vertexIndexBufferInfoMap.insert({key, vertexIndexBufferInfo});
@@ -419,7 +443,7 @@ void WebGPURenderer3D::Render()
     assert(m_vertexIndexBufferInfoMap.size() > 0);
     for (const auto &vertexIndexBufferInfo : m_vertexIndexBufferInfoMap)
     {
-        m_renderPass.setVertexBuffer(0, vertexIndexBufferInfo.second->m_vertexBuffer, 0, vertexIndexBufferInfo.second->m_vertexCount * sizeof(RenderSys::Vertex));
+        m_renderPass.setVertexBuffer(0, vertexIndexBufferInfo.second->m_vertexBuffer, 0, vertexIndexBufferInfo.second->m_vertexBufferSize);
         if (vertexIndexBufferInfo.second->m_indexCount > 0)
         {
             m_renderPass.setIndexBuffer(vertexIndexBufferInfo.second->m_indexBuffer, wgpu::IndexFormat::Uint16, 0, vertexIndexBufferInfo.second->m_indexCount * sizeof(uint16_t));
@@ -442,7 +466,7 @@ void WebGPURenderer3D::RenderIndexed()
     assert(m_vertexIndexBufferInfoMap.size() > 0);
     for (const auto &vertexIndexBufferInfo : m_vertexIndexBufferInfoMap)
     {
-        m_renderPass.setVertexBuffer(0, vertexIndexBufferInfo.second->m_vertexBuffer, 0, vertexIndexBufferInfo.second->m_vertexCount * sizeof(RenderSys::Vertex));
+        m_renderPass.setVertexBuffer(0, vertexIndexBufferInfo.second->m_vertexBuffer, 0, vertexIndexBufferInfo.second->m_vertexBufferSize);
         m_renderPass.setIndexBuffer(vertexIndexBufferInfo.second->m_indexBuffer, wgpu::IndexFormat::Uint32, 0, vertexIndexBufferInfo.second->m_indexCount * sizeof(uint32_t));
         m_renderPass.drawIndexed(vertexIndexBufferInfo.second->m_indexCount, 1, 0, 0, 0);
 
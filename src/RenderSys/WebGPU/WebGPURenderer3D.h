@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <stdint.h>
 #include <stddef.h>
 #include <glm/ext.hpp>
@@ -11,6 +12,9 @@
 #include <RenderSys/Buffer.h>
 #include <RenderSys/Texture.h>
 #include <RenderSys/Scene/Mesh.h>
+#include <RenderSys/RenderQueue.h>
+#include <RenderSys/ShadowCascades.h>
+#include <RenderSys/GpuProfiler.h>
 #include <entt/entt.hpp>
 
 namespace RenderSys
@@ -26,6 +30,7 @@ struct WebGPUVertexIndexBufferInfo
 
     wgpu::Buffer m_vertexBuffer = nullptr;
     uint32_t m_vertexCount = 0;
+    uint64_t m_vertexBufferSize = 0;
     wgpu::Buffer m_indexBuffer = nullptr;
     uint32_t m_indexCount = 0;
 };
@@ -43,7 +48,12 @@ public:
     void CreatePipeline();
     void CreateFrameBuffer();
     uint32_t CreateVertexBuffer(const RenderSys::VertexBuffer& bufferData, RenderSys::VertexBufferLayout bufferLayout);
+    uint32_t CreateVertexBuffer(const void* bufferData, size_t bufferLength, RenderSys::VertexBufferLayout bufferLayout);
+    // writeVertices fills the bufferLength bytes of the mapped buffer
+    uint32_t CreateVertexBuffer(size_t bufferLength, RenderSys::VertexBufferLayout bufferLayout, const std::function<void(void*)>& writeVertices);
     void CreateIndexBuffer(uint32_t vertexBufferID, const std::vector<uint32_t> &bufferData);
+    void CreateSkinningBuffer(uint32_t vertexBufferID, const std::vector<RenderSys::SkinningVertex>& skinningData) {}
+    void CreateMeshletBuffer(uint32_t vertexBufferID, const std::vector<RenderSys::Meshlet>& meshlets) {}
     void SetClearColor(glm::vec4 clearColor);
     void CreateBindGroup(const std::vector<RenderSys::BindGroupLayoutEntry>& bindGroupLayoutEntries);
     void CreateUniformBuffer(uint32_t binding, uint32_t sizeOfOneUniform);
@@ -56,12 +66,24 @@ public:
     void Render();
     void RenderIndexed();
     void RenderMesh(const RenderSys::Mesh& mesh);
+    void SubmitRenderQueue(const RenderSys::RenderQueue& renderQueue) {}
+    const RenderSys::RenderQueueStats& GetRenderQueueStats() const { return m_renderQueueStats; }
+    bool SupportsBindlessMaterials() const { return false; }
+    void SetBindlessMaterials(const bool bindlessMaterials) {}
+    bool SupportsMultiDrawIndirect() const { return false; }
+    void SetMultiDrawIndirect(const bool multiDrawIndirect) {}
+    void SubmitRenderQueueIndirect(const RenderSys::RenderQueue& renderQueue) {}
+    bool SupportsOcclusionCulling() const { return false; }
+    void SubmitRenderQueueOcclusionCulled(const RenderSys::RenderQueue& renderQueue, const glm::mat4& viewProjection) {}
+    bool SupportsMeshletCulling() const { return false; }
+    void SubmitRenderQueueMeshletCulled(const RenderSys::RenderQueue& renderQueue, const glm::mat4& viewProjection, const glm::vec3& viewPosition) {}
     ImTextureID GetDescriptorSet();
     void BeginRenderPass();
     void EndRenderPass();
     void BeginShadowMapPass();
-    void RenderShadowMap(entt::registry& entityRegistry) {}
+    void RenderShadowMap(entt::registry& entityRegistry, const RenderSys::ShadowCascades& shadowCascades) {}
     void EndShadowMapPass();
+    void RenderSkinning(entt::registry& entityRegistry) {}
     void DestroyImages();
     void DestroyPipeline();
     void DestroyBindGroup();
@@ -72,6 +94,13 @@ public:
 
     void OnImGuiRender();
     std::vector<uint8_t>& GetRenderedImageDataToCPUSide();
+    uint64_t RequestRenderedImage(RenderSys::RenderedImageCallback callback) { return 0; }
+    void PollRenderedImages() {}
+    void WaitRenderedImages() {}
+    // no timestamp queries yet
+    void BeginProfileScope(const std::string& name) {}
+    void EndProfileScope() {}
+    RenderSys::GpuProfiler* GetGpuProfiler() { return nullptr; }
 private:
     void CreateDefaultTextureSampler();
     uint32_t GetUniformStride(const uint32_t& uniformIndex, const uint32_t& sizeOfUniform);
@@ -103,6 +132,8 @@ private:
     wgpu::Sampler m_defaultTextureSampler = nullptr;
 
     uint32_t m_width, m_height;
+
+    RenderSys::RenderQueueStats m_renderQueueStats;
 };
 
 } // namespace RenderSys
\ No newline at end of file
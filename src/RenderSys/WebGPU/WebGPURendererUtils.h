@@ -21,6 +21,22 @@ wgpu::VertexFormat GetWebGPUVertexFormat(RenderSys::VertexFormat renderSysFormat
     {
         return wgpu::VertexFormat::Snorm16x4;
     }
+    else if (renderSysFormat == RenderSys::VertexFormat::Snorm16x2)
+    {
+        return wgpu::VertexFormat::Snorm16x2;
+    }
+    else if (renderSysFormat == RenderSys::VertexFormat::Unorm16x2)
+    {
+        return wgpu::VertexFormat::Unorm16x2;
+    }
+    else if (renderSysFormat == RenderSys::VertexFormat::Float16x2)
+    {
+        return wgpu::VertexFormat::Float16x2;
+    }
+    else if (renderSysFormat == RenderSys::VertexFormat::Unorm8x4)
+    {
+        return wgpu::VertexFormat::Unorm8x4;
+    }
     else
     {
         assert(false);
@@ -37,4 +37,23 @@ struct MaterialProperties
     float m_EmissiveStrength;
 };
 
+// bindless materials, every material texture of the scene lives in one array
+#define GLSL_MAX_BINDLESS_TEXTURES 1024
+#define GLSL_MAX_BINDLESS_MATERIALS 1024
+
+struct BindlessMaterial
+{
+    MaterialProperties m_properties;
+
+    // byte 48 to 79, indices into the bindless texture array
+    int m_baseColorTexture;
+    int m_normalTexture;
+    int m_metallicTexture;
+    int m_roughnessTexture;
+    int m_metallicRoughnessTexture;
+    int m_padding0;
+    int m_padding1;
+    int m_padding2;
+};
+
 #endif // SHADERMATERIAL_H
\ No newline at end of file
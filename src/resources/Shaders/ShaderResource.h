@@ -4,4 +4,21 @@
 #define GLSL_HAS_SKELETAL_ANIMATION (0x1 << 0x1)
 #define GLSL_HAS_HEIGHTMAP (0x1 << 0x2)
 
-#define MAX_INSTANCE 64
\ No newline at end of file
+#define MAX_INSTANCE 64
+#define SKINNING_WORKGROUP_SIZE 64
+
+// multi-draw indirect, the first instance of a draw command points into the draw instances
+#define MAX_INDIRECT_DRAWS 4096
+#define MAX_INDIRECT_DRAW_INSTANCES 65536
+
+// hierarchical depth occlusion culling
+#define HZB_REDUCE_WORKGROUP_SIZE 8
+#define HZB_CULL_WORKGROUP_SIZE 64
+// meshlet culling, one workgroup per draw
+#define MESHLET_CULL_WORKGROUP_SIZE 64
+// the fluid kernels run on tiles of FLUID_WORKGROUP_SIZE x FLUID_WORKGROUP_SIZE cells
+#define FLUID_WORKGROUP_SIZE 8
+// the sources of a fluid step, one per invocation
+#define FLUID_SPLAT_WORKGROUP_SIZE 64
+// cascaded shadow maps, one layer of the shadow map per cascade
+#define MAX_SHADOW_CASCADES 4
@@ -0,0 +1,71 @@
+#version 460
+
+#include "fluid-common.glsl"
+
+layout(local_size_x = FLUID_WORKGROUP_SIZE, local_size_y = FLUID_WORKGROUP_SIZE) in;
+
+// semi-Lagrangian advection of d0 along the velocity into d, bilinear in 2D and trilinear in 3D
+layout(push_constant) uniform AdvectParameters
+{
+    ivec3 m_Size;
+    // dt times the size of the grid
+    float m_Dt0;
+    uint m_D;
+    uint m_D0;
+    uint m_VelocityX;
+    uint m_VelocityY;
+    uint m_VelocityZ;
+} params;
+
+float D0(ivec3 cell)
+{
+    return fields.m_Values[params.m_D0 + CellIndex(cell, params.m_Size)];
+}
+
+void main()
+{
+    const ivec3 size = params.m_Size;
+    const ivec3 cell = InnerCell(size);
+    if (!IsInnerCell(cell, size))
+    {
+        return;
+    }
+
+    const uint index = CellIndex(cell, size);
+    // the inner cells, so that the footprint stays on the grid
+    const float innerSize = float(size.x - 2);
+    const float x = clamp(float(cell.x) - params.m_Dt0 * fields.m_Values[params.m_VelocityX + index], 0.5, innerSize + 0.5);
+    const float y = clamp(float(cell.y) - params.m_Dt0 * fields.m_Values[params.m_VelocityY + index], 0.5, innerSize + 0.5);
+
+    const float i0 = floor(x);
+    const float j0 = floor(y);
+    const float s1 = x - i0;
+    const float s0 = 1.0 - s1;
+    const float t1 = y - j0;
+    const float t0 = 1.0 - t1;
+    const int i0i = int(i0);
+    const int i1i = i0i + 1;
+    const int j0i = int(j0);
+    const int j1i = j0i + 1;
+
+    float value;
+    if (size.z == 1)
+    {
+        value =   s0 * (t0 * D0(ivec3(i0i, j0i, 0)) + t1 * D0(ivec3(i0i, j1i, 0)))
+                + s1 * (t0 * D0(ivec3(i1i, j0i, 0)) + t1 * D0(ivec3(i1i, j1i, 0)));
+    }
+    else
+    {
+        const float z = clamp(float(cell.z) - params.m_Dt0 * fields.m_Values[params.m_VelocityZ + index], 0.5, innerSize + 0.5);
+        const float k0 = floor(z);
+        const float u1 = z - k0;
+        const float u0 = 1.0 - u1;
+        const int k0i = int(k0);
+        const int k1i = k0i + 1;
+        value =   s0 * (  t0 * (u0 * D0(ivec3(i0i, j0i, k0i)) + u1 * D0(ivec3(i0i, j0i, k1i)))
+                        + t1 * (u0 * D0(ivec3(i0i, j1i, k0i)) + u1 * D0(ivec3(i0i, j1i, k1i))))
+                + s1 * (  t0 * (u0 * D0(ivec3(i1i, j0i, k0i)) + u1 * D0(ivec3(i1i, j0i, k1i)))
+                        + t1 * (u0 * D0(ivec3(i1i, j1i, k0i)) + u1 * D0(ivec3(i1i, j1i, k1i))));
+    }
+    fields.m_Values[params.m_D + index] = value;
+}
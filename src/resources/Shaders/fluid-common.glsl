@@ -0,0 +1,26 @@
+// shared by the fluid-*-compute.glsl kernels of RenderSys::GpuFluidSolver
+
+#include "ShaderResource.h"
+
+// all fields of the grid one after the other, the push constants of a kernel hold the offsets of its fields
+layout(std430, set = 0, binding = 0) buffer FluidFields
+{
+    float m_Values[];
+} fields;
+
+// the size includes the boundary cells, a 2D grid has a depth of 1
+uint CellIndex(ivec3 cell, ivec3 size)
+{
+    return uint(cell.x + size.x * (cell.y + size.y * cell.z));
+}
+
+// the cell of an invocation of a dispatch over the inner cells, the boundary is one cell thick
+ivec3 InnerCell(ivec3 size)
+{
+    return ivec3(gl_GlobalInvocationID) + ivec3(1, 1, size.z > 1 ? 1 : 0);
+}
+
+bool IsInnerCell(ivec3 cell, ivec3 size)
+{
+    return cell.x < size.x - 1 && cell.y < size.y - 1 && (size.z == 1 || cell.z < size.z - 1);
+}
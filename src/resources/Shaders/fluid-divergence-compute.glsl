@@ -0,0 +1,45 @@
+#version 460
+
+#include "fluid-common.glsl"
+
+layout(local_size_x = FLUID_WORKGROUP_SIZE, local_size_y = FLUID_WORKGROUP_SIZE) in;
+
+// the first part of the projection: the divergence of the velocity, and p = 0 as the first guess of the solver
+layout(push_constant) uniform DivergenceParameters
+{
+    ivec3 m_Size;
+    // the size of a cell, 1 / size
+    float m_H;
+    uint m_VelocityX;
+    uint m_VelocityY;
+    uint m_VelocityZ;
+    uint m_P;
+    uint m_Div;
+} params;
+
+void main()
+{
+    const ivec3 size = params.m_Size;
+    const ivec3 cell = InnerCell(size);
+    if (!IsInnerCell(cell, size))
+    {
+        return;
+    }
+
+    const uint index = CellIndex(cell, size);
+    const uint strideY = uint(size.x);
+    const uint velocityX = params.m_VelocityX + index;
+    const uint velocityY = params.m_VelocityY + index;
+    float divergence = fields.m_Values[velocityX + 1]
+                      -fields.m_Values[velocityX - 1]
+                      +fields.m_Values[velocityY + strideY]
+                      -fields.m_Values[velocityY - strideY];
+    if (size.z > 1)
+    {
+        const uint strideZ = uint(size.x * size.y);
+        const uint velocityZ = params.m_VelocityZ + index;
+        divergence += fields.m_Values[velocityZ + strideZ] - fields.m_Values[velocityZ - strideZ];
+    }
+    fields.m_Values[params.m_Div + index] = -0.5 * params.m_H * divergence;
+    fields.m_Values[params.m_P + index] = 0.0;
+}
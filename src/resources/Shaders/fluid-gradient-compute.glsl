@@ -0,0 +1,37 @@
+#version 460
+
+#include "fluid-common.glsl"
+
+layout(local_size_x = FLUID_WORKGROUP_SIZE, local_size_y = FLUID_WORKGROUP_SIZE) in;
+
+// the last part of the projection: subtracts the gradient of p, which leaves the velocity free of divergence
+layout(push_constant) uniform GradientParameters
+{
+    ivec3 m_Size;
+    uint m_P;
+    uint m_VelocityX;
+    uint m_VelocityY;
+    uint m_VelocityZ;
+} params;
+
+void main()
+{
+    const ivec3 size = params.m_Size;
+    const ivec3 cell = InnerCell(size);
+    if (!IsInnerCell(cell, size))
+    {
+        return;
+    }
+
+    const uint index = CellIndex(cell, size);
+    const uint p = params.m_P + index;
+    const uint strideY = uint(size.x);
+    const float scale = float(size.x);
+    fields.m_Values[params.m_VelocityX + index] -= 0.5 * (fields.m_Values[p + 1] - fields.m_Values[p - 1]) * scale;
+    fields.m_Values[params.m_VelocityY + index] -= 0.5 * (fields.m_Values[p + strideY] - fields.m_Values[p - strideY]) * scale;
+    if (size.z > 1)
+    {
+        const uint strideZ = uint(size.x * size.y);
+        fields.m_Values[params.m_VelocityZ + index] -= 0.5 * (fields.m_Values[p + strideZ] - fields.m_Values[p - strideZ]) * scale;
+    }
+}
@@ -0,0 +1,40 @@
+#version 460
+
+#include "fluid-common.glsl"
+
+layout(local_size_x = FLUID_WORKGROUP_SIZE, local_size_y = FLUID_WORKGROUP_SIZE) in;
+
+// one color of a red-black Gauss-Seidel iteration, the cells with (x + y + z) % 2 == color are updated in place
+// and only read cells of the other color. The same update as red_black_row() of FluidSolver2D
+layout(push_constant) uniform LinearSolveParameters
+{
+    ivec3 m_Size;
+    int m_Color;
+    uint m_X;
+    uint m_X0;
+    float m_A;
+    float m_CRecip;
+} params;
+
+void main()
+{
+    const ivec3 size = params.m_Size;
+    // x runs over every second cell, the first inner cell of the color in the row
+    ivec3 cell = InnerCell(size);
+    cell.x = 2 * int(gl_GlobalInvocationID.x) + 1 + ((1 + cell.y + cell.z + params.m_Color) & 1);
+    if (!IsInnerCell(cell, size))
+    {
+        return;
+    }
+
+    const uint index = CellIndex(cell, size);
+    const uint x = params.m_X + index;
+    const uint strideY = uint(size.x);
+    float neighbours = (fields.m_Values[x + 1] + fields.m_Values[x - 1]) + (fields.m_Values[x + strideY] + fields.m_Values[x - strideY]);
+    if (size.z > 1)
+    {
+        const uint strideZ = uint(size.x * size.y);
+        neighbours += fields.m_Values[x + strideZ] + fields.m_Values[x - strideZ];
+    }
+    fields.m_Values[x] = (fields.m_Values[params.m_X0 + index] + params.m_A * neighbours) * params.m_CRecip;
+}
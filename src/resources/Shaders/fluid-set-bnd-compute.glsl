@@ -0,0 +1,83 @@
+#version 460
+
+#include "fluid-common.glsl"
+
+layout(local_size_x = FLUID_WORKGROUP_SIZE, local_size_y = FLUID_WORKGROUP_SIZE) in;
+
+// set_bnd() of FluidSolver2D for 2D and 3D grids. A dispatch covers the cells on the boundary of as many axes as
+// m_BoundaryAxes: 1 the walls, 2 the edges of a cube and the corners of a square, 3 the corners of a cube.
+// A wall cell takes the value of its inner neighbour, negated for the velocity across the wall, the others the
+// average of their neighbours towards the inside, which the previous dispatch has written.
+layout(push_constant) uniform BoundaryParameters
+{
+    ivec3 m_Size;
+    // 1, 2 or 3 negate the velocity along x, y or z at the walls across that axis, 0 copies
+    int m_Boundary;
+    uint m_X;
+    int m_BoundaryAxes;
+} params;
+
+bool IsBoundary(ivec3 cell, ivec3 size, int axis)
+{
+    return cell[axis] == 0 || cell[axis] == size[axis] - 1;
+}
+
+void main()
+{
+    const ivec3 size = params.m_Size;
+    const int dimensions = size.z > 1 ? 3 : 2;
+    // gl_GlobalInvocationID.z is the wall: x = 0, x = max, y = 0, y = max, z = 0, z = max
+    const int wall = int(gl_GlobalInvocationID.z);
+    const int axis = wall / 2;
+    // the two axes along the wall
+    const int axisU = axis == 0 ? 1 : 0;
+    const int axisV = axis == 2 ? 1 : 2;
+    const ivec2 uv = ivec2(gl_GlobalInvocationID.xy);
+    if (axis >= dimensions || uv.x >= size[axisU] || uv.y >= size[axisV])
+    {
+        return;
+    }
+
+    ivec3 cell;
+    cell[axis] = (wall & 1) == 0 ? 0 : size[axis] - 1;
+    cell[axisU] = uv.x;
+    cell[axisV] = uv.y;
+
+    int boundaryAxes = 0;
+    for (int other = 0; other < dimensions; other++)
+    {
+        if (IsBoundary(cell, size, other))
+        {
+            // a cell on several walls is written by the first of them
+            if (other < axis)
+            {
+                return;
+            }
+            boundaryAxes++;
+        }
+    }
+    if (boundaryAxes != params.m_BoundaryAxes)
+    {
+        return;
+    }
+
+    float value = 0.0;
+    for (int other = 0; other < dimensions; other++)
+    {
+        if (IsBoundary(cell, size, other))
+        {
+            ivec3 inner = cell;
+            inner[other] += cell[other] == 0 ? 1 : -1;
+            value += fields.m_Values[params.m_X + CellIndex(inner, size)];
+        }
+    }
+    if (boundaryAxes == 1)
+    {
+        value = params.m_Boundary == axis + 1 ? -value : value;
+    }
+    else
+    {
+        value = value / float(boundaryAxes);
+    }
+    fields.m_Values[params.m_X + CellIndex(cell, size)] = value;
+}
@@ -0,0 +1,35 @@
+#version 460
+
+#include "fluid-common.glsl"
+
+layout(local_size_x = FLUID_SPLAT_WORKGROUP_SIZE) in;
+
+// the sources of a step, at most one per cell of a field, so the invocations never add to the same value
+struct Source
+{
+    uint m_Index;
+    float m_Amount;
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer FluidSources
+{
+    Source m_Sources[];
+} sources;
+
+// adds m_Count sources from m_First on to their cells
+layout(push_constant) uniform SplatParameters
+{
+    uint m_First;
+    uint m_Count;
+} params;
+
+void main()
+{
+    const uint source = gl_GlobalInvocationID.x;
+    if (source >= params.m_Count)
+    {
+        return;
+    }
+    const Source splat = sources.m_Sources[params.m_First + source];
+    fields.m_Values[splat.m_Index] += splat.m_Amount;
+}
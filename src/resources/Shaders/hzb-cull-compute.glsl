@@ -0,0 +1,145 @@
+#version 460
+
+#include "ShaderResource.h"
+
+layout(local_size_x = HZB_CULL_WORKGROUP_SIZE) in;
+
+// RenderSys::Vulkan::HzbCullingPipeline::Phase
+#define PHASE_EARLY 0
+#define PHASE_LATE 1
+
+#define RESULT_VISIBLE 0
+#define RESULT_OCCLUDED 1
+#define RESULT_FRUSTUM_CULLED 2
+
+struct DrawBounds
+{
+    vec4 m_BoundsMin;
+    vec4 m_BoundsMax;
+    uint m_CommandIndex;
+    uint m_VisibilitySlot;
+    uint m_InstanceCount;
+    uint m_AlwaysVisible;
+};
+
+// VkDrawIndexedIndirectCommand
+struct DrawIndexedIndirectCommand
+{
+    uint m_IndexCount;
+    uint m_InstanceCount;
+    uint m_FirstIndex;
+    int m_VertexOffset;
+    uint m_FirstInstance;
+};
+
+layout(set = 0, binding = 0) readonly buffer DrawBoundsBuffer
+{
+    DrawBounds m_Data[];
+} drawBounds;
+
+layout(set = 0, binding = 1) buffer IndirectCommandBuffer
+{
+    DrawIndexedIndirectCommand m_Data[];
+} indirectCommands;
+
+// visibility of the last frame, kept per draw over frames
+layout(set = 0, binding = 2) buffer VisibilityBuffer
+{
+    uint m_Data[];
+} visibility;
+
+layout(set = 0, binding = 3) buffer CounterBuffer
+{
+    uint m_Visible;
+    uint m_Occluded;
+    uint m_FrustumCulled;
+    uint m_Padding;
+} counters;
+
+// farthest depth, the first level has half the resolution of the depth image
+layout(set = 0, binding = 4) uniform sampler2D depthPyramid;
+
+layout(push_constant) uniform PushConstants
+{
+    mat4 m_ViewProjection;
+    vec2 m_DepthSize;
+    uint m_DrawCount;
+    uint m_Phase;
+    uint m_PyramidLevelCount;
+} pushConstants;
+
+uint TestBounds(vec3 boundsMin, vec3 boundsMax)
+{
+    vec3 ndcMin = vec3(1e30);
+    vec3 ndcMax = vec3(-1e30);
+    for (int corner = 0; corner < 8; ++corner)
+    {
+        vec3 position = mix(boundsMin, boundsMax, vec3(corner & 1, (corner >> 1) & 1, (corner >> 2) & 1));
+        vec4 clip = pushConstants.m_ViewProjection * vec4(position, 1.0);
+        if (clip.w <= 0.0)
+        {
+            // reaches behind the camera, the projected rectangle would be wrong
+            return RESULT_VISIBLE;
+        }
+        vec3 ndc = clip.xyz / clip.w;
+        ndcMin = min(ndcMin, ndc);
+        ndcMax = max(ndcMax, ndc);
+    }
+
+    if (any(lessThan(ndcMax.xy, vec2(-1.0))) || any(greaterThan(ndcMin.xy, vec2(1.0))) || ndcMin.z > 1.0)
+    {
+        return RESULT_FRUSTUM_CULLED;
+    }
+
+    // pick the level on which the rectangle covers at most 2x2 texels
+    vec2 pixelMin = clamp(ndcMin.xy * 0.5 + 0.5, 0.0, 1.0) * pushConstants.m_DepthSize;
+    vec2 pixelMax = clamp(ndcMax.xy * 0.5 + 0.5, 0.0, 1.0) * pushConstants.m_DepthSize;
+    vec2 extent = pixelMax - pixelMin;
+    float level = max(ceil(log2(max(max(extent.x, extent.y), 1.0))) - 1.0, 0.0);
+    level = min(level, float(pushConstants.m_PyramidLevelCount - 1));
+    float texelSize = exp2(level + 1.0);
+    ivec2 levelSize = textureSize(depthPyramid, int(level));
+    ivec2 texelMin = clamp(ivec2(pixelMin / texelSize), ivec2(0), levelSize - 1);
+    ivec2 texelMax = clamp(ivec2(pixelMax / texelSize), ivec2(0), levelSize - 1);
+
+    float occluderDepth = 0.0;
+    for (int y = texelMin.y; y <= texelMax.y; ++y)
+    {
+        for (int x = texelMin.x; x <= texelMax.x; ++x)
+        {
+            occluderDepth = max(occluderDepth, texelFetch(depthPyramid, ivec2(x, y), int(level)).r);
+        }
+    }
+    return ndcMin.z > occluderDepth ? RESULT_OCCLUDED : RESULT_VISIBLE;
+}
+
+void main()
+{
+    uint drawIndex = gl_GlobalInvocationID.x;
+    if (drawIndex >= pushConstants.m_DrawCount)
+    {
+        return;
+    }
+
+    DrawBounds bounds = drawBounds.m_Data[drawIndex];
+    bool wasVisible = visibility.m_Data[bounds.m_VisibilitySlot] != 0;
+    if (pushConstants.m_Phase == PHASE_EARLY)
+    {
+        // what was visible last frame is drawn first, its depth is the occluder of the late phase
+        indirectCommands.m_Data[bounds.m_CommandIndex].m_InstanceCount = wasVisible ? bounds.m_InstanceCount : 0;
+        return;
+    }
+
+    uint result = bounds.m_AlwaysVisible != 0 ? RESULT_VISIBLE : TestBounds(bounds.m_BoundsMin.xyz, bounds.m_BoundsMax.xyz);
+    bool visible = result == RESULT_VISIBLE;
+    // the early phase has drawn it already
+    indirectCommands.m_Data[bounds.m_CommandIndex].m_InstanceCount = (visible && !wasVisible) ? bounds.m_InstanceCount : 0;
+    visibility.m_Data[bounds.m_VisibilitySlot] = visible ? 1 : 0;
+
+    if (result == RESULT_VISIBLE)
+        atomicAdd(counters.m_Visible, 1);
+    else if (result == RESULT_OCCLUDED)
+        atomicAdd(counters.m_Occluded, 1);
+    else
+        atomicAdd(counters.m_FrustumCulled, 1);
+}
@@ -0,0 +1,39 @@
+#version 460
+
+#include "ShaderResource.h"
+
+layout(local_size_x = HZB_REDUCE_WORKGROUP_SIZE, local_size_y = HZB_REDUCE_WORKGROUP_SIZE) in;
+
+// the depth image for the first level of the pyramid, the previous level for all others
+layout(set = 0, binding = 0) uniform sampler2D sourceImage;
+layout(set = 0, binding = 1, r32f) uniform writeonly image2D destinationImage;
+
+layout(push_constant) uniform PushConstants
+{
+    ivec2 m_SourceSize;
+    ivec2 m_DestinationSize;
+} pushConstants;
+
+void main()
+{
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(texel, pushConstants.m_DestinationSize)))
+    {
+        return;
+    }
+
+    // farthest depth of the 2x2 source texels, the last texel of a row or column of an odd sized source takes 3
+    ivec2 sourceMin = texel * 2;
+    ivec2 oddEdge = ivec2(equal(texel, pushConstants.m_DestinationSize - 1)) * (pushConstants.m_SourceSize & 1);
+    ivec2 sourceMax = min(sourceMin + 1 + oddEdge, pushConstants.m_SourceSize - 1);
+
+    float depth = 0.0;
+    for (int y = sourceMin.y; y <= sourceMax.y; ++y)
+    {
+        for (int x = sourceMin.x; x <= sourceMax.x; ++x)
+        {
+            depth = max(depth, texelFetch(sourceImage, ivec2(x, y), 0).r);
+        }
+    }
+    imageStore(destinationImage, texel, vec4(depth));
+}
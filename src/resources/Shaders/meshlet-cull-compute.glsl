@@ -0,0 +1,149 @@
+#version 460
+
+#include "ShaderResource.h"
+
+layout(local_size_x = MESHLET_CULL_WORKGROUP_SIZE) in;
+
+#define RESULT_VISIBLE 0
+#define RESULT_CONE_CULLED 1
+#define RESULT_FRUSTUM_CULLED 2
+
+// RenderSys::Meshlet, in the space of the mesh
+struct Meshlet
+{
+    vec3 m_Center;
+    float m_Radius;
+    vec3 m_ConeAxis;
+    float m_ConeCutoff;
+    uint m_FirstIndex;
+    uint m_IndexCount;
+};
+
+struct MeshletDraw
+{
+    uint m_FirstMeshlet;
+    uint m_MeshletCount;
+    uint m_CommandIndex;
+    uint m_FirstTransform;
+    uint m_TransformCount;
+    uint m_ConeCulling;
+    uint m_Padding0;
+    uint m_Padding1;
+};
+
+// VkDrawIndexedIndirectCommand
+struct DrawIndexedIndirectCommand
+{
+    uint m_IndexCount;
+    uint m_InstanceCount;
+    uint m_FirstIndex;
+    int m_VertexOffset;
+    uint m_FirstInstance;
+};
+
+layout(set = 0, binding = 0) readonly buffer MeshletDrawBuffer
+{
+    MeshletDraw m_Data[];
+} draws;
+
+// the model matrices of the instances of each draw
+layout(set = 0, binding = 1) readonly buffer TransformBuffer
+{
+    mat4 m_Data[];
+} transforms;
+
+// the index count of the culled commands is zero until the visible meshlets add theirs
+layout(set = 0, binding = 2) buffer IndirectCommandBuffer
+{
+    DrawIndexedIndirectCommand m_Data[];
+} indirectCommands;
+
+layout(set = 0, binding = 3) buffer CounterBuffer
+{
+    uint m_Visible;
+    uint m_FrustumCulled;
+    uint m_ConeCulled;
+    uint m_Padding;
+} counters;
+
+layout(set = 1, binding = 0) readonly buffer MeshletBuffer
+{
+    Meshlet m_Data[];
+} meshlets;
+
+layout(set = 1, binding = 1) readonly buffer IndexBuffer
+{
+    uint m_Data[];
+} indices;
+
+// drawn instead of the index buffer, the visible meshlets of a draw are packed behind its first index
+layout(set = 1, binding = 2) writeonly buffer CulledIndexBuffer
+{
+    uint m_Data[];
+} culledIndices;
+
+layout(push_constant) uniform PushConstants
+{
+    vec4 m_FrustumPlanes[6];
+    vec4 m_ViewPosition;
+    uint m_FirstDraw;
+    uint m_DrawCount;
+} pushConstants;
+
+uint TestMeshlet(Meshlet meshlet, mat4 modelMatrix, bool coneCulling)
+{
+    vec3 center = (modelMatrix * vec4(meshlet.m_Center, 1.0)).xyz;
+    float scale = max(length(modelMatrix[0].xyz), max(length(modelMatrix[1].xyz), length(modelMatrix[2].xyz)));
+    float radius = meshlet.m_Radius * scale;
+    for (int plane = 0; plane < 6; ++plane)
+    {
+        if (dot(pushConstants.m_FrustumPlanes[plane].xyz, center) + pushConstants.m_FrustumPlanes[plane].w < -radius)
+        {
+            return RESULT_FRUSTUM_CULLED;
+        }
+    }
+
+    // every triangle faces away when the viewer is inside the cone opposite to the normals, widened by the sphere
+    if (coneCulling && meshlet.m_ConeCutoff < 1.0)
+    {
+        vec3 coneAxis = normalize(mat3(modelMatrix) * meshlet.m_ConeAxis);
+        vec3 viewDirection = center - pushConstants.m_ViewPosition.xyz;
+        if (dot(viewDirection, coneAxis) >= meshlet.m_ConeCutoff * length(viewDirection) + radius)
+        {
+            return RESULT_CONE_CULLED;
+        }
+    }
+    return RESULT_VISIBLE;
+}
+
+void main()
+{
+    uint drawIndex = pushConstants.m_FirstDraw + gl_WorkGroupID.x;
+    MeshletDraw draw = draws.m_Data[drawIndex];
+    uint firstIndex = indirectCommands.m_Data[draw.m_CommandIndex].m_FirstIndex;
+
+    for (uint meshletIndex = gl_LocalInvocationID.x; meshletIndex < draw.m_MeshletCount; meshletIndex += MESHLET_CULL_WORKGROUP_SIZE)
+    {
+        Meshlet meshlet = meshlets.m_Data[draw.m_FirstMeshlet + meshletIndex];
+        // the instances share the culled indices, a meshlet is drawn when one of them sees it
+        uint result = RESULT_FRUSTUM_CULLED;
+        for (uint transform = 0; transform < draw.m_TransformCount && result != RESULT_VISIBLE; ++transform)
+        {
+            result = min(result, TestMeshlet(meshlet, transforms.m_Data[draw.m_FirstTransform + transform], draw.m_ConeCulling != 0));
+        }
+
+        if (result == RESULT_VISIBLE)
+        {
+            uint offset = atomicAdd(indirectCommands.m_Data[draw.m_CommandIndex].m_IndexCount, meshlet.m_IndexCount);
+            for (uint index = 0; index < meshlet.m_IndexCount; ++index)
+            {
+                culledIndices.m_Data[firstIndex + offset + index] = indices.m_Data[meshlet.m_FirstIndex + index];
+            }
+            atomicAdd(counters.m_Visible, 1);
+        }
+        else if (result == RESULT_CONE_CULLED)
+            atomicAdd(counters.m_ConeCulled, 1);
+        else
+            atomicAdd(counters.m_FrustumCulled, 1);
+    }
+}
@@ -0,0 +1,15 @@
+#version 460
+
+#include "pbr-bindless.glsl"
+
+layout (push_constant, std430) uniform PushFragment
+{
+    uint m_materialIndex;
+} pushConstants;
+
+layout (location = 0) out vec4 out_color;
+
+void main()
+{
+    out_color = shadeBindlessMaterial(pushConstants.m_materialIndex);
+}
@@ -0,0 +1,113 @@
+// PBR shading of one of the bindless materials, shared by the fragment shaders which read the
+// materials from the bindless bind group
+
+#include "ShaderMaterial.h"
+#include "metallic-roughness.glsl"
+
+layout(set = 0, binding = 0) uniform UniformBufferObject {
+    mat4 projectionMatrix;
+    mat4 viewMatrix;
+    mat4 modelMatrix;
+    float time;
+} ubo;
+
+layout(set = 0, binding = 1) uniform LightingUniforms {
+    vec4 directions[2];
+    vec4 colors[2];
+} lightingUbo;
+
+// all materials of the scene, every draw selects one by its index
+layout(set = 1, binding = 0) readonly buffer BindlessMaterials {
+    BindlessMaterial m_materials[];
+} materialBuffer;
+layout(set = 1, binding = 1) uniform sampler2D textures[GLSL_MAX_BINDLESS_TEXTURES];
+
+layout (location = 0) in vec3 in_viewDirection;
+layout (location = 1) in vec2 in_uv;
+layout (location = 2) in vec3 in_normal;
+layout (location = 3) in vec3 in_tangent;
+
+// the index has to be dynamically uniform, the same for the whole draw, to index the texture array
+vec4 shadeBindlessMaterial(uint materialIndex)
+{
+    BindlessMaterial material = materialBuffer.m_materials[materialIndex];
+
+    vec3 N = normalize(in_normal);
+    vec3 V = normalize(in_viewDirection);
+
+    // color
+    vec4 col;
+    float alpha = 1.0; // Default to opaque
+    if (bool(material.m_properties.m_features & GLSL_HAS_DIFFUSE_MAP))
+    {
+        col = texture(textures[material.m_baseColorTexture], in_uv) * material.m_properties.m_baseColor;
+        alpha = col.a; // <-- Store the alpha here
+    }
+    else
+    {
+        col = material.m_properties.m_baseColor;
+        alpha = col.a; // <-- Store the alpha here
+    }
+
+    vec3 texNormal = texture(textures[material.m_normalTexture], in_uv).xyz * 2.0 - 1.0;
+    N = (bool(material.m_properties.m_features & GLSL_HAS_NORMAL_MAP)) ? getNormalFromNormalMaps(texNormal, in_normal, in_tangent) : N;
+    vec3 albedo = col.rgb;
+
+    float metallic = material.m_properties.m_metallic;
+    float roughness = material.m_properties.m_roughness;
+
+    if (bool(material.m_properties.m_features & GLSL_HAS_ROUGHNESS_METALLIC_MAP))
+    {
+        vec2 mr = texture(textures[material.m_metallicRoughnessTexture], in_uv).bg;
+        metallic = mr.x;
+        roughness = mr.y;
+    }
+    else
+    {
+        if (bool(material.m_properties.m_features & GLSL_HAS_METALLIC_MAP))
+        {
+            metallic = texture(textures[material.m_metallicTexture], in_uv).r;
+        }
+        if (bool(material.m_properties.m_features & GLSL_HAS_ROUGHNESS_MAP))
+        {
+            roughness = texture(textures[material.m_roughnessTexture], in_uv).r;
+        }
+    }
+
+    vec3 F0 = vec3(0.04); 
+    F0 = mix(F0, albedo, metallic);
+
+    vec3 total_diffuse = vec3(0.0);
+    vec3 total_specular = vec3(0.0);
+    for (int i = 0; i < 2; ++i) 
+    {
+        vec3 L = normalize(lightingUbo.directions[i].xyz);
+        vec3 H = normalize(V + L);
+
+        float NdotV = max(dot(N, V), 0.0);
+        float NdotL = max(dot(N, L), 0.0);
+        float NdotH = max(dot(N, H), 0.0);
+        float LdotH = max(dot(L, H), 0.0);
+        float D = distributionGGX(N, H, roughness);        
+        float G = geometrySmith(N, V, L, roughness);      
+        vec3 F = fresnelSchlick(LdotH, F0);  // F is now per-light 
+
+        vec3 numerator = D * G * F;
+        float denominator = 4.0 * NdotV * NdotL;
+        vec3 specular = numerator / max(denominator, 0.001);      
+
+        vec3 kS = F;
+        vec3 kD = vec3(1.0) - kS;
+        kD *= 1.0 - metallic;	  
+ 
+        vec3 radiance = lightingUbo.colors[i].rgb;
+        total_diffuse += kD * radiance * albedo * NdotL;  // Use kD here
+        total_specular += radiance * specular * NdotL;             
+    }
+
+    vec3 ambient = albedo * 0.03;
+
+    vec3 color = (total_diffuse + total_specular + ambient); // No kD here
+
+    return pow(vec4(color, alpha), vec4(1.0/2.2));
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+#version 460
+
+#include "pbr-bindless.glsl"
+
+// written per draw by pbr-indirect-vertex.glsl, so it is the same for every fragment of a draw
+layout (location = 4) flat in uint in_materialIndex;
+
+layout (location = 0) out vec4 out_color;
+
+void main()
+{
+    out_color = shadeBindlessMaterial(in_materialIndex);
+}
@@ -0,0 +1,27 @@
+#version 460
+
+#include "ShaderResource.h"
+
+// depth only, one cascade of the shadow map per pass
+layout(push_constant) uniform ShadowPushConstants
+{
+    mat4 lightViewProjection;
+} pushConstants;
+
+struct InstanceData
+{
+    mat4 m_ModelMatrix;
+};
+
+layout(set = 2, binding = 0) readonly buffer InstanceBuffer
+{
+    InstanceData m_InstanceData[MAX_INSTANCE];
+} uboInstanced;
+
+layout (location = 0) in vec3 aPos;
+
+void main()
+{
+    mat4 modelMatrix = uboInstanced.m_InstanceData[gl_InstanceIndex].m_ModelMatrix;
+    gl_Position = pushConstants.lightViewProjection * modelMatrix * vec4(aPos, 1.0);
+}
@@ -0,0 +1,157 @@
+#version 460
+
+#include "ShaderResource.h"
+
+layout(local_size_x = SKINNING_WORKGROUP_SIZE) in;
+
+// RenderSys::Vertex is 16 floats : position 0-2, normal 3-5, uv 6-7, color 8-10, tangent 11-13
+#define VERTEX_STRIDE 16
+#define NORMAL_OFFSET 3
+#define TANGENT_OFFSET 11
+
+// RenderSys::SkinningMethod
+#define SKINNING_METHOD_LINEAR_BLEND 0
+#define SKINNING_METHOD_DUAL_QUATERNION 1
+
+struct SkinningVertex
+{
+    uvec4 m_Joints;
+    vec4 m_Weights;
+};
+
+layout(set = 0, binding = 0) readonly buffer BindPoseVertices
+{
+    float m_Data[];
+} bindPoseVertices;
+
+layout(set = 0, binding = 1) readonly buffer SkinningVertices
+{
+    SkinningVertex m_Data[];
+} skinningVertices;
+
+layout(set = 0, binding = 2) writeonly buffer SkinnedVertices
+{
+    float m_Data[];
+} skinnedVertices;
+
+// the joint palette holds either matrices or dual quaternions, depending on the skinning method of the skeleton
+layout(set = 1, binding = 1) readonly buffer JointMatrices
+{
+    mat4 m_FinalJointsMatrices[];
+} jointMatrices;
+
+struct DualQuaternion
+{
+    vec4 m_Real;
+    vec4 m_Dual;
+};
+
+layout(set = 1, binding = 1) readonly buffer JointDualQuaternions
+{
+    DualQuaternion m_FinalJointsDualQuaternions[];
+} jointDualQuaternions;
+
+layout(push_constant) uniform PushConstants
+{
+    uint m_VertexCount;
+    uint m_SkinningMethod;
+} pushConstants;
+
+vec3 readBindPose(uint index)
+{
+    return vec3(bindPoseVertices.m_Data[index], bindPoseVertices.m_Data[index + 1], bindPoseVertices.m_Data[index + 2]);
+}
+
+void writeSkinned(uint index, vec3 value)
+{
+    skinnedVertices.m_Data[index] = value.x;
+    skinnedVertices.m_Data[index + 1] = value.y;
+    skinnedVertices.m_Data[index + 2] = value.z;
+}
+
+vec3 safeNormalize(vec3 v)
+{
+    float len = length(v);
+    return len > 0.0 ? v / len : v;
+}
+
+vec3 rotate(vec4 q, vec3 v)
+{
+    return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
+
+DualQuaternion blendDualQuaternions(SkinningVertex skinning)
+{
+    DualQuaternion pivot = jointDualQuaternions.m_FinalJointsDualQuaternions[skinning.m_Joints.x];
+    DualQuaternion blended = DualQuaternion(vec4(0.0), vec4(0.0));
+    for (int i = 0; i < 4; i++)
+    {
+        DualQuaternion joint = jointDualQuaternions.m_FinalJointsDualQuaternions[skinning.m_Joints[i]];
+        // q and -q are the same rotation, blend every influence in the hemisphere of the first one
+        float weight = dot(joint.m_Real, pivot.m_Real) < 0.0 ? -skinning.m_Weights[i] : skinning.m_Weights[i];
+        blended.m_Real += weight * joint.m_Real;
+        blended.m_Dual += weight * joint.m_Dual;
+    }
+
+    float len = length(blended.m_Real);
+    // vertices which are not influenced by any joint keep their bind pose
+    if (dot(skinning.m_Weights, vec4(1.0)) <= 0.0 || len <= 0.0)
+    {
+        return DualQuaternion(vec4(0.0, 0.0, 0.0, 1.0), vec4(0.0));
+    }
+    return DualQuaternion(blended.m_Real / len, blended.m_Dual / len);
+}
+
+void skinDualQuaternion(uint base, SkinningVertex skinning)
+{
+    DualQuaternion dq = blendDualQuaternions(skinning);
+    vec3 translation = 2.0 * (dq.m_Real.w * dq.m_Dual.xyz - dq.m_Dual.w * dq.m_Real.xyz + cross(dq.m_Real.xyz, dq.m_Dual.xyz));
+    writeSkinned(base, rotate(dq.m_Real, readBindPose(base)) + translation);
+    writeSkinned(base + NORMAL_OFFSET, safeNormalize(rotate(dq.m_Real, readBindPose(base + NORMAL_OFFSET))));
+    writeSkinned(base + TANGENT_OFFSET, safeNormalize(rotate(dq.m_Real, readBindPose(base + TANGENT_OFFSET))));
+}
+
+void skinLinearBlend(uint base, SkinningVertex skinning)
+{
+    mat4 skinMatrix = 
+        skinning.m_Weights.x * jointMatrices.m_FinalJointsMatrices[skinning.m_Joints.x] +
+        skinning.m_Weights.y * jointMatrices.m_FinalJointsMatrices[skinning.m_Joints.y] +
+        skinning.m_Weights.z * jointMatrices.m_FinalJointsMatrices[skinning.m_Joints.z] +
+        skinning.m_Weights.w * jointMatrices.m_FinalJointsMatrices[skinning.m_Joints.w];
+
+    // vertices which are not influenced by any joint keep their bind pose
+    if (dot(skinning.m_Weights, vec4(1.0)) <= 0.0)
+    {
+        skinMatrix = mat4(1.0);
+    }
+
+    mat3 skinRotation = mat3(skinMatrix);
+    writeSkinned(base, (skinMatrix * vec4(readBindPose(base), 1.0)).xyz);
+    writeSkinned(base + NORMAL_OFFSET, safeNormalize(skinRotation * readBindPose(base + NORMAL_OFFSET)));
+    writeSkinned(base + TANGENT_OFFSET, safeNormalize(skinRotation * readBindPose(base + TANGENT_OFFSET)));
+}
+
+void main() 
+{
+    uint vertexIndex = gl_GlobalInvocationID.x;
+    if (vertexIndex >= pushConstants.m_VertexCount)
+    {
+        return;
+    }
+
+    SkinningVertex skinning = skinningVertices.m_Data[vertexIndex];
+    uint base = vertexIndex * VERTEX_STRIDE;
+    for (uint i = 0; i < VERTEX_STRIDE; i++)
+    {
+        skinnedVertices.m_Data[base + i] = bindPoseVertices.m_Data[base + i];
+    }
+
+    if (pushConstants.m_SkinningMethod == SKINNING_METHOD_DUAL_QUATERNION)
+    {
+        skinDualQuaternion(base, skinning);
+    }
+    else
+    {
+        skinLinearBlend(base, skinning);
+    }
+}
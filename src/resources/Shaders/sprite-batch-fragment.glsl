@@ -0,0 +1,14 @@
+#version 460
+
+// RenderSys::SpriteAtlas, the untextured quads sample its white block
+layout(set = 0, binding = 0) uniform sampler2D spriteAtlas;
+
+layout (location = 0) in vec2 in_uv;
+layout (location = 1) in vec4 in_color;
+
+layout (location = 0) out vec4 out_color;
+
+void main()
+{
+    out_color = texture(spriteAtlas, in_uv) * in_color;
+}
@@ -0,0 +1,30 @@
+#version 460
+
+// one RenderSys::SpriteInstance per instance, six vertices per instance without an index buffer
+layout(push_constant) uniform SpritePushConstants
+{
+    mat4 viewProjection;
+} pushConstants;
+
+layout (location = 0) in vec2 in_center;
+layout (location = 1) in vec2 in_axisX;
+layout (location = 2) in vec2 in_axisY;
+// u min, v min, u max, v max
+layout (location = 3) in vec4 in_uvRect;
+layout (location = 4) in vec4 in_color;
+
+layout (location = 0) out vec2 out_uv;
+layout (location = 1) out vec4 out_color;
+
+// two triangles, the corners along the axes of the quad
+const vec2 corners[6] = vec2[](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0),
+                               vec2(1.0, 1.0), vec2(-1.0, 1.0), vec2(-1.0, -1.0));
+
+void main()
+{
+    const vec2 corner = corners[gl_VertexIndex];
+    const vec2 position = in_center + corner.x * in_axisX + corner.y * in_axisY;
+    gl_Position = pushConstants.viewProjection * vec4(position, 0.0, 1.0);
+    out_uv = mix(in_uvRect.xy, in_uvRect.zw, corner * 0.5 + 0.5);
+    out_color = in_color;
+}
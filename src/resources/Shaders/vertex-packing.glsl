@@ -0,0 +1,11 @@
+// decoding of RenderSys::PackedVertex, the snorm16 and unorm formats are converted by the vertex fetch
+
+// octahedral normal or tangent in [-1, 1]^2 to a unit vector, matches RenderSys::VertexPacking::DecodeOctahedral()
+vec3 octDecode(vec2 encoded)
+{
+    vec3 direction = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float fold = max(-direction.z, 0.0);
+    direction.x += direction.x >= 0.0 ? -fold : fold;
+    direction.y += direction.y >= 0.0 ? -fold : fold;
+    return normalize(direction);
+}